@@ -26,50 +26,17 @@ using namespace degate;
 using namespace boost::filesystem;
 
 std::string get_date_and_time_as_file_prefix() {
-  time_t tim = time(NULL);
-  tm *now = localtime(&tim);
-
-  boost::format f("%4d-%02d-%02d_%02d%02d_");
-  f
-    % (now->tm_year+1900)
-    % (now->tm_mon+1)
-    % now->tm_mday
-    % now->tm_hour
-    % now->tm_min;
-  return f.str();
+  return Autosaver::get_prefix(time(NULL));
 }
 
-bool autosave_project(Project_shptr project, time_t interval) {
+bool autosave_project(Project_shptr project, Autosaver & autosaver, time_t interval) {
 
   if(project->is_changed() &&
      project->get_time_since_last_save() >= interval) {
 
-    std::string prefix(get_date_and_time_as_file_prefix());
-
-    std::string project_file = "project.xml";
-    std::string lmodel_file = "lmodel.xml";
-    std::string gatelib_file = "gate_library.xml";
-    std::string rcvbl_file = "rc_blacklist.xml";
-
-    ProjectExporter exporter;
-    exporter.export_all(project->get_project_directory(),
-			project, false,
-			prefix + project_file,
-			prefix + lmodel_file,
-			prefix + gatelib_file,
-			prefix + rcvbl_file);
-
-    path project_dir(project->get_project_directory());
-
-    if(exists(project_dir / path("." + project_file))) remove(project_dir / path("." + project_file));
-    if(exists(project_dir / path("." + gatelib_file))) remove(project_dir / path("." + gatelib_file));
-    if(exists(project_dir / path("." + lmodel_file))) remove(project_dir / path("." + lmodel_file));
-    if(exists(project_dir / path("." + rcvbl_file))) remove(project_dir / path("." + rcvbl_file));
-
-    create_symlink(path(prefix + project_file), project_dir / path("." + project_file));
-    create_symlink(path(prefix + lmodel_file), project_dir / path("." + lmodel_file));
-    create_symlink(path(prefix + gatelib_file), project_dir / path("." + gatelib_file));
-    create_symlink(path(prefix + rcvbl_file), project_dir / path("." + rcvbl_file));
+    // If the previous autosave is still running, the changes are saved
+    // with the next call.
+    if(!autosaver.start(project)) return false;
 
     project->reset_last_saved_counter();
 
@@ -30,6 +30,7 @@
 #include <ctime>
 #include <Project.h>
 #include <ProjectExporter.h>
+#include <Autosaver.h>
 #include <Editor.h>
 #include <DegateRenderer.h>
 #include <gtkmm.h>
@@ -42,14 +43,18 @@ std::string get_date_and_time_as_file_prefix();
 
 
 /**
- * Autosave a project.
+ * Autosave a project. The project is exported immediately and written
+ * in the background.
  * @param project Shared pointer to the project.
+ * @param autosaver The autosaver, that writes the files.
  * @parem interval Minimum time in seconds. If you pass a zero, autosave is enforced.
- * @return Returns true if the project was saved. Returns false, if there
- *   is nothing to save.
+ * @return Returns true if an autosave was started. Returns false, if there
+ *   is nothing to save or if the previous autosave is still running.
+ * @see degate::Autosaver
  */
 
-bool autosave_project(degate::Project_shptr project, time_t interval = 5 * 60);
+bool autosave_project(degate::Project_shptr project, degate::Autosaver & autosaver,
+		      time_t interval = 5 * 60);
 
 /**
  * Add file filter for background images to a Gtk::FileChooserDialog.
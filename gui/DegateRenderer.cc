@@ -20,6 +20,7 @@
 */
 
 #include <DegateRenderer.h>
+#include <Configuration.h>
 
 #include <GL/gl.h>
 #include <GL/glu.h>
@@ -33,35 +34,7 @@
 
 using namespace degate;
 
-static inline uint32_t highlight_color(uint32_t col) {
-  uint8_t r = MASK_R(col);
-  uint8_t g = MASK_G(col);
-  uint8_t b = MASK_B(col);
-  uint8_t a = MASK_A(col);
-
-  return MERGE_CHANNELS((((255-r)>>1) + r),
-			(((255-g)>>1) + g),
-			(((255-b)>>1) + b), (a < 128 ? 128 : a));
-}
-
-
-static inline uint32_t highlight_color_by_state(uint32_t col,
-						PlacedLogicModelObject::HIGHLIGHTING_STATE state) {
-
-  switch(state) {
-  case PlacedLogicModelObject::HLIGHTSTATE_DIRECT:
-    return highlight_color(highlight_color(col));
-  case PlacedLogicModelObject::HLIGHTSTATE_ADJACENT:
-    return highlight_color(col);
-  case PlacedLogicModelObject::HLIGHTSTATE_NOT:
-  default:
-    return col;
-  }
-}
-
-
-
-DegateRenderer::DegateRenderer() : last_scaling(0), realized(false),
+DegateRenderer::DegateRenderer() : tile_poll_enabled(false), realized(false),
 				   idle_hook_enabled(false), is_idle(true), lock_state(false),
 				   corridor_size(0) {
 
@@ -99,13 +72,7 @@ void DegateRenderer::on_realize() {
   gate_details_dlist = glGenLists(1);
   assert(error_check());
 
-  vias_dlist = glGenLists(1);
-  assert(error_check());
-
-  emarkers_dlist = glGenLists(1);
-  assert(error_check());
-
-  wires_dlist = glGenLists(1);
+  connections_dlist = glGenLists(1);
   assert(error_check());
 
   annotations_dlist = glGenLists(1);
@@ -145,21 +112,29 @@ void DegateRenderer::update_screen() {
 				       Glib::PRIORITY_LOW);
     }
 
-    if(is_idle || should_update_gates) {
+    // Recompile, if the viewport left the compiled region, e.g. while panning.
+    if(is_idle || should_update_gates || !get_viewport().in_bounding_box(compiled_region)) {
+
+      // Compile with a margin of half the viewport size on each side.
+      int margin_x = get_viewport_width() / 2;
+      int margin_y = get_viewport_height() / 2;
+      compiled_region = BoundingBox(get_viewport_min_x() - margin_x, get_viewport_max_x() + margin_x,
+				    get_viewport_min_y() - margin_y, get_viewport_max_y() + margin_y);
+
       render_background();
 
       // render gates with and without details into two different display lists
+      // Details are only shown for small scalings.
+      bool with_details = get_scaling() <= 2;
       render_gates(false);
-      render_gates(true);
+      if(with_details) render_gates(true);
       should_update_gates = false;
       
       // same with annotations
       render_annotations(false);
-      render_annotations(true);
+      if(with_details) render_annotations(true);
       
-      render_vias();
-      render_emarkers();
-      render_wires();
+      render_connections();
       
       render_grid();
       
@@ -206,13 +181,7 @@ void DegateRenderer::update_screen() {
       }
       
       if(is_idle) {
-	glCallList(wires_dlist);
-	assert(error_check());
-	
-	glCallList(vias_dlist);
-	assert(error_check());
-
-	glCallList(emarkers_dlist);
+	glCallList(connections_dlist);
 	assert(error_check());
       }
 
@@ -266,29 +235,11 @@ void DegateRenderer::update_viewport_dimension() {
 }
 
 
-GLuint DegateRenderer::create_and_add_tile(degate::BackgroundImage_shptr img,
-					   unsigned int x, unsigned int y,
-					   unsigned int tile_width,
-					   unsigned int pre_scaling) {
-
-  assert(img != NULL); // checked with if outside this method
-
-  // real pixel coordinates
-  unsigned int min_x = x * pre_scaling;
-  unsigned int min_y = y * pre_scaling;
-  unsigned int max_x = min_x + tile_width * pre_scaling;
-  unsigned int max_y = min_y + tile_width * pre_scaling;
-
-  guint32 * data = new guint32[tile_width * tile_width];
-  assert(data != NULL);
-  if(data == NULL) throw "Failed to allocate memory";
-
-  memset(data, 0, tile_width * tile_width * sizeof(guint32));
-  img->raw_copy(data, x, y);
+GLuint DegateRenderer::upload_tile(degate::TileStreamer::StagedTile const& tile) {
 
+  unsigned int tile_width = tile_streamer->get_tile_size();
   GLuint texture = 0;
 
-
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
   assert(error_check());
 
@@ -328,87 +279,17 @@ GLuint DegateRenderer::create_and_add_tile(degate::BackgroundImage_shptr img,
 	       0, // border
 	       GL_RGBA,
 	       GL_UNSIGNED_BYTE,
-	       data);
-  assert(glGetError() == GL_NO_ERROR);
-
-  delete[] data;
-
-
-  //glBindTexture(GL_TEXTURE_2D, texture);
-  //assert(error_check());
-
-  glBegin(GL_QUADS);
-  assert(error_check());
-
-  glTexCoord2i(0, 0);
-  glVertex3i(min_x, min_y, 0);
-
-  glTexCoord2i(1, 0);
-  glVertex3i(max_x, min_y, 0);
-
-  glTexCoord2i(1, 1);
-  glVertex3i(max_x, max_y, 0);
-
-  glTexCoord2i(0, 1);
-  glVertex3i(min_x, max_y, 0);
-  glEnd();
-  assert(error_check());
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-  assert(glGetError() == GL_NO_ERROR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+	       tile.data);
   assert(glGetError() == GL_NO_ERROR);
 
   return texture;
 }
 
-void DegateRenderer::render_vias() {
-  if(lmodel == NULL) return;
-
-  glNewList(vias_dlist, GL_COMPILE);
-
-  for(Layer::object_iterator iter = layer->objects_begin();
-      iter != layer->objects_end(); ++iter) {
-
-    if(Via_shptr via = std::tr1::dynamic_pointer_cast<Via>(*iter)) {
-      unsigned int diameter = via->get_diameter();
-      uint32_t col = via->get_direction() == Via::DIRECTION_UP ?
-	default_colors[DEFAULT_COLOR_VIA_UP] : default_colors[DEFAULT_COLOR_VIA_DOWN];
-
-      if(via->is_highlighted()) {
-	col = highlight_color_by_state(col, via->get_highlighted());
-	diameter <<= 2;
-      }
-
-      draw_square(via->get_x(), via->get_y(), diameter, col,
-		  via->is_connected());
-    }
-
-  }
-  glEndList();
-}
-
-void DegateRenderer::render_emarkers() {
+void DegateRenderer::render_connections() {
   if(lmodel == NULL) return;
 
-  glNewList(emarkers_dlist, GL_COMPILE);
-
-  for(Layer::object_iterator iter = layer->objects_begin();
-      iter != layer->objects_end(); ++iter) {
-
-    if(EMarker_shptr emarker = std::tr1::dynamic_pointer_cast<EMarker>(*iter)) {
-      unsigned int diameter = emarker->get_diameter();
-      uint32_t col = default_colors[DEFAULT_COLOR_EMARKER];
-
-      if(emarker->is_highlighted()) {
-	col = highlight_color_by_state(col, emarker->get_highlighted());
-	diameter <<= 2;
-      }
-
-      draw_circle(emarker->get_x(), emarker->get_y(), diameter, col);
-    }
-
-  }
+  glNewList(connections_dlist, GL_COMPILE);
+  render_chunks(layer, RenderBatchBuilder::GROUP_CONNECTIONS);
   glEndList();
 }
 
@@ -443,40 +324,6 @@ void DegateRenderer::render_grid(degate::Grid_shptr grid) {
   }
 }
 
-void DegateRenderer::render_wires() {
-  if(lmodel == NULL) return;
-
-  glNewList(wires_dlist, GL_COMPILE);
-  for(Layer::object_iterator iter = layer->objects_begin();
-      iter != layer->objects_end(); ++iter) {
-
-    if(Wire_shptr wire = std::tr1::dynamic_pointer_cast<Wire>(*iter)) {
-      color_t col = wire->has_frame_color() ? wire->get_frame_color() : default_colors[DEFAULT_COLOR_WIRE];
-
-      set_color(highlight_color_by_state(col, wire->get_highlighted()));
-
-      glLineWidth((double)wire->get_diameter() / get_scaling());
-      glBegin(GL_LINES);
-      glVertex2i(wire->get_from_x(), wire->get_from_y());
-      glVertex2i(wire->get_to_x(), wire->get_to_y());
-      glEnd();
-
-
-      /*
-      int radius = wire->get_diameter() >> 1;
-
-      glBegin(GL_POLYGON);
-      glVertex2i((int)wire->get_from_x() - radius, (int)wire->get_from_y() - radius);
-      glVertex2i((int)wire->get_to_x() + radius, (int)wire->get_from_y() - radius);
-      glVertex2i((int)wire->get_to_x() + radius, (int)wire->get_to_y() + radius);
-      glVertex2i((int)wire->get_from_x() - radius, (int)wire->get_to_y() + radius);
-      glEnd();
-      */
-    }
-  }
-  glEndList();
-}
-
 void DegateRenderer::render_annotations(bool render_into_details_list) {
 
   if(lmodel == NULL) return;
@@ -484,43 +331,19 @@ void DegateRenderer::render_annotations(bool render_into_details_list) {
   glNewList(render_into_details_list ? annotation_details_dlist :
 	    annotations_dlist, GL_COMPILE);
 
-  for(Layer::object_iterator iter = layer->objects_begin();
-      iter != layer->objects_end(); ++iter) {
-
-    if(Annotation_shptr a = std::tr1::dynamic_pointer_cast<Annotation>(*iter)) {
-      color_t fill_col = a->get_fill_color();
-      color_t frame_col = a->get_frame_color();
-
-      if(fill_col == 0) fill_col = default_colors[DEFAULT_COLOR_ANNOTATION];
-      if(frame_col == 0) frame_col = fill_col;
-
-      if(!render_into_details_list) {
-	set_color(highlight_color_by_state(fill_col, a->get_highlighted()));
-	glLineWidth(1);
-	glBegin(GL_QUADS);
-	glVertex2i(a->get_min_x(), a->get_min_y());
-	glVertex2i(a->get_max_x(), a->get_min_y());
-	glVertex2i(a->get_max_x(), a->get_max_y());
-	glVertex2i(a->get_min_x(), a->get_max_y());
-	glEnd();
-
-	set_color(highlight_color_by_state(frame_col, a->get_highlighted()));
-	glBegin(GL_LINE_LOOP);
-	glVertex2i(a->get_min_x(), a->get_min_y());
-	glVertex2i(a->get_max_x(), a->get_min_y());
-	glVertex2i(a->get_max_x(), a->get_max_y());
-	glVertex2i(a->get_min_x(), a->get_max_y());
-	glEnd();
-      }
-      else {
-	if(a->has_name())
-	  draw_string(a->get_min_x()+2,
-		      a->get_min_y()+2 + get_font_height(),
-		      default_colors[DEFAULT_COLOR_TEXT],
-		      a->get_name(),
-		      a->get_width() > 4 ? a->get_width() - 4 : a->get_width());
-      }
-
+  if(!render_into_details_list)
+    render_chunks(layer, RenderBatchBuilder::GROUP_ANNOTATIONS);
+  else {
+    for(Layer::qt_region_iterator iter = layer->region_begin(get_viewport());
+	iter != layer->region_end(); ++iter) {
+
+      Annotation_shptr a = std::tr1::dynamic_pointer_cast<Annotation>(*iter);
+      if(a != NULL && a->has_name())
+	draw_string(a->get_min_x()+2,
+		    a->get_min_y()+2 + get_font_height(),
+		    default_colors[DEFAULT_COLOR_TEXT],
+		    a->get_name(),
+		    a->get_width() > 4 ? a->get_width() - 4 : a->get_width());
     }
   }
   glEndList();
@@ -534,46 +357,27 @@ void DegateRenderer::render_gates(bool render_into_details_list) {
   glNewList(render_into_details_list ?
 	    gate_details_dlist : gates_dlist, GL_COMPILE);
 
-  for(LogicModel::gate_collection::iterator iter = lmodel->gates_begin();
-      iter != lmodel->gates_end(); ++iter) {
-    render_gate(iter->second, render_into_details_list);
+  // Gates are visible on all layers.
+  for(LogicModel::layer_collection::iterator l_iter = lmodel->layers_begin();
+      l_iter != lmodel->layers_end(); ++l_iter) {
+
+    if(!render_into_details_list)
+      render_chunks(*l_iter, RenderBatchBuilder::GROUP_GATES);
+    else {
+      for(Layer::qt_region_iterator iter = (*l_iter)->region_begin(get_viewport());
+	  iter != (*l_iter)->region_end(); ++iter) {
+	if(Gate_shptr gate = std::tr1::dynamic_pointer_cast<Gate>(*iter))
+	  render_gate_details(gate);
+      }
+    }
   }
 
   glEndList();
 }
 
-void DegateRenderer::render_gate(degate::Gate_shptr gate,
-				 bool render_into_details_list) {
+void DegateRenderer::render_gate_details(degate::Gate_shptr gate) {
 
-  if(!render_into_details_list) {
-    color_t fill_col = gate->has_template() ?
-      gate->get_gate_template()->get_fill_color() : 0;
-    color_t frame_col = gate->has_template() ?
-      gate->get_gate_template()->get_frame_color() : 0;
-
-    if(fill_col == 0) fill_col = default_colors[DEFAULT_COLOR_GATE];
-    if(frame_col == 0) frame_col = fill_col;
-
-    set_color(highlight_color_by_state(fill_col, gate->get_highlighted()));
-    glLineWidth(1);
-    glBegin(GL_QUADS);
-    glVertex2i(gate->get_min_x(), gate->get_min_y());
-    glVertex2i(gate->get_max_x(), gate->get_min_y());
-    glVertex2i(gate->get_max_x(), gate->get_max_y());
-    glVertex2i(gate->get_min_x(), gate->get_max_y());
-    glEnd();
-
-    set_color(highlight_color_by_state(frame_col, gate->get_highlighted()));
-    glBegin(GL_LINE_LOOP);
-    glVertex2i(gate->get_min_x(), gate->get_min_y());
-    glVertex2i(gate->get_max_x(), gate->get_min_y());
-    glVertex2i(gate->get_max_x(), gate->get_max_y());
-    glVertex2i(gate->get_min_x(), gate->get_max_y());
-    glEnd();
-
-  }
-
-  if(render_into_details_list && gate->has_name())
+  if(gate->has_name())
     draw_string(gate->get_min_x() + 2,
 		gate->get_min_y() + 2 + get_font_height() + 1,
 		default_colors[DEFAULT_COLOR_TEXT],
@@ -586,7 +390,7 @@ void DegateRenderer::render_gate(degate::Gate_shptr gate,
     GateTemplate_shptr tmpl = gate->get_gate_template();
 
     // render names for type and instance
-    if(render_into_details_list && gate->get_gate_template()->has_name())
+    if(tmpl->has_name())
       draw_string(gate->get_min_x() + 2,
 		  gate->get_min_y() + 2,
 		  default_colors[DEFAULT_COLOR_TEXT],
@@ -600,45 +404,10 @@ void DegateRenderer::render_gate(degate::Gate_shptr gate,
 	GatePort_shptr port = *iter;
 	GateTemplatePort_shptr tmpl_port = port->get_template_port();
 
-	if(tmpl_port && tmpl_port->get_x() != 0 && tmpl_port->get_y() != 0) {
-	  unsigned int x = port->get_x(), y = port->get_y();
-	  unsigned int port_size = port->get_diameter();
-	  color_t port_color = tmpl_port->get_fill_color() == 0 ?
-	    default_colors[DEFAULT_COLOR_GATE_PORT] :
-	    tmpl_port->get_fill_color();
-
-	  if(!render_into_details_list) {
-
-	    if(port->is_highlighted()) {
-	      port_color = highlight_color_by_state(port_color,
-						    port->get_highlighted());
-	      port_size *= 2;
-	    }
-
-	    
-	    switch(tmpl_port->get_port_type()) {
-	    case GateTemplatePort::PORT_TYPE_UNDEFINED:
-	      draw_square(x, y, port_size, port_color, port->is_connected());
-	      break;
-	    case GateTemplatePort::PORT_TYPE_IN:
-	      draw_square_with_nose_left(x, y, port_size, port_color, port->is_connected());
-	      break;
-	    case GateTemplatePort::PORT_TYPE_OUT:
-	      draw_square_with_nose_right(x, y, port_size, port_color, port->is_connected());
-	      break;
-	    case GateTemplatePort::PORT_TYPE_INOUT:
-	      draw_square_with_noses(x, y, port_size, port_color, port->is_connected());
-	      break;
-	    }
-	    
-	  }
-	  else { // render_into_details_list
-	    if(tmpl_port->has_name())
-	      draw_string(x+2, y+2,
-			  default_colors[DEFAULT_COLOR_TEXT], tmpl_port->get_name());
-	  }
-
-	}
+	if(tmpl_port && tmpl_port->get_x() != 0 && tmpl_port->get_y() != 0 &&
+	   tmpl_port->has_name())
+	  draw_string(port->get_x() + 2, port->get_y() + 2,
+		      default_colors[DEFAULT_COLOR_TEXT], tmpl_port->get_name());
       }
     }
   }
@@ -646,81 +415,154 @@ void DegateRenderer::render_gate(degate::Gate_shptr gate,
 }
 
 
+RenderBatchBuilder_shptr DegateRenderer::get_batch_builder(degate::Layer_shptr layer) {
+
+  batch_builder_map::iterator found = batch_builders.find(layer->get_layer_id());
+  if(found != batch_builders.end() && found->second->get_layer() == layer)
+    return found->second;
+
+  RenderBatchBuilder_shptr builder(new RenderBatchBuilder(layer));
+  builder->set_default_colors(default_colors);
+  builder->set_highlight_overlay(highlight_overlay);
+  batch_builders[layer->get_layer_id()] = builder;
+  return builder;
+}
+
+void DegateRenderer::render_chunks(degate::Layer_shptr layer,
+				   RenderBatchBuilder::RENDER_GROUP group) {
+
+  if(layer == NULL) return;
+
+  // Above the threshold, objects are smaller than a few screen pixel.
+  // Render aggregates, so that the number of primitives does not depend
+  // on the number of objects.
+  RenderBatchBuilder_shptr builder = get_batch_builder(layer);
+  unsigned int lod_cell_size =
+    builder->get_lod_cell_size(get_scaling(), Configuration::get_instance().get_lod_scaling_threshold());
+
+  RenderBatchBuilder::chunk_list chunks;
+  builder->get_chunks(compiled_region, chunks, lod_cell_size);
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * chunk, chunks) {
+    RenderBatchBuilder::PrimitiveSet const& p = chunk->get_primitives(group, lod_cell_size);
+
+    glLineWidth(1);
+    render_vertex_array(p.triangles, GL_TRIANGLES);
+    render_vertex_array(p.lines, GL_LINES);
+
+    for(std::map<diameter_t, RenderBatchBuilder::vertex_array>::const_iterator
+	  iter = p.wide_lines.begin(); iter != p.wide_lines.end(); ++iter) {
+      glLineWidth((double)iter->first / get_scaling());
+      render_vertex_array(iter->second, GL_LINES);
+    }
+  }
+
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glLineWidth(1);
+  assert(error_check());
+}
+
+void DegateRenderer::render_vertex_array(degate::RenderBatchBuilder::vertex_array const& v,
+					 GLenum mode) {
+  if(v.empty()) return;
+
+  // Vertex arrays are dereferenced when compiling the display list.
+  glVertexPointer(2, GL_FLOAT, sizeof(RenderBatchBuilder::Vertex), &v[0].x);
+  glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(RenderBatchBuilder::Vertex), &v[0].color);
+  glDrawArrays(mode, 0, v.size());
+}
 
 
 void DegateRenderer::render_background() {
 
-  if(layer == NULL || !layer->has_background_image()) return;
+  if(layer == NULL || !layer->has_background_image()) {
+    glNewList(background_dlist, GL_COMPILE);
+    glEndList();
+    return;
+  }
 
   degate::ScalingManager_shptr smgr = layer->get_scaling_manager();
   assert(smgr != NULL);
 
+  if(tile_streamer == NULL) {
+    TileSource_shptr source(new BackgroundImageTileSource(smgr));
+    tile_streamer = TileStreamer_shptr(new TileStreamer(source));
+  }
 
-  degate::ScalingManager<degate::BackgroundImage>::image_map_element elem =
-    smgr->get_image(get_scaling());
+  unsigned int level = lrint(smgr->get_image(get_scaling()).first);
+  tile_streamer->update(get_viewport(), level);
 
-  if(last_scaling != elem.first ||
-     !background_bbox.complete_within(get_viewport()) || rendered_bg_tiles.empty()) {
+  // Upload only a few tiles per frame to keep the GUI responsive.
+  const unsigned int max_uploads_per_frame = 4;
 
-    drop_tiles();
-    last_scaling = elem.first;
+  std::list<TileStreamer::StagedTile> staged;
+  tile_streamer->collect(max_uploads_per_frame, staged);
 
-    unsigned int pre_scaling = elem.first;
-    degate::BackgroundImage_shptr img = elem.second;
-    if(img == NULL) return;
+  BOOST_FOREACH(TileStreamer::StagedTile const& t, staged) {
+    std::list<TileStreamer::resident_handle_t> evicted;
+    tile_streamer->make_resident(t, upload_tile(t), evicted);
+    free_textures.splice(free_textures.end(), evicted);
+  }
 
-    unsigned int tile_width = img->get_tile_size();
+  glNewList(background_dlist, GL_COMPILE);
+  assert(error_check());
 
-    unsigned int // scaled coordinates
+  glColor4ub(0, 0, 0, 0xff);
 
-      min_x = to_lower_tile_offset(std::max(get_viewport_min_x()  / pre_scaling, (unsigned int)0), tile_width),
+  // Draw visible tiles. Tiles that are not loaded yet are covered by a coarser tile.
+  BOOST_FOREACH(TileKey const& key, tile_streamer->get_tiles(get_viewport(), level)) {
 
-      max_x = to_upper_tile_offset(std::min(std::max(get_viewport_max_x() / pre_scaling, (unsigned int)0),
-					    get_virtual_width() / pre_scaling), tile_width),
-      min_y = to_lower_tile_offset(std::max(get_viewport_min_y()  / pre_scaling, (unsigned int)0), tile_width),
-      max_y = to_upper_tile_offset(std::min(std::max(get_viewport_max_y() / pre_scaling, (unsigned int)0),
-					    get_virtual_height() / pre_scaling), tile_width);
+    TileStreamer::ResidentTile r;
+    if(tile_streamer->find_resident(key, r)) {
+      BoundingBox bbox = tile_streamer->get_tile_bbox(key);
 
-    /*
-    debug(TM, "render tiles for area: %d..%d, %d..%d",
-	  get_viewport_min_x(), get_viewport_max_x(), get_viewport_min_y(), get_viewport_max_y());
-    debug(TM, "render tiles for area: %d..%d, %d..%d", min_x, max_x, min_y, max_y);
-    */
+      glBindTexture(GL_TEXTURE_2D, r.handle);
+      glBegin(GL_QUADS);
 
-    // screen coordinates
-    background_bbox.set(min_x * pre_scaling,
-			max_x * pre_scaling,
-			min_y * pre_scaling,
-			max_y * pre_scaling);
+      glTexCoord2f(r.tex_min_x, r.tex_min_y);
+      glVertex3i(bbox.get_min_x(), bbox.get_min_y(), 0);
 
-    glNewList(background_dlist, GL_COMPILE);
-    assert(error_check());
+      glTexCoord2f(r.tex_max_x, r.tex_min_y);
+      glVertex3i(bbox.get_max_x(), bbox.get_min_y(), 0);
 
-    glColor4ub(0, 0, 0, 0xff);
+      glTexCoord2f(r.tex_max_x, r.tex_max_y);
+      glVertex3i(bbox.get_max_x(), bbox.get_max_y(), 0);
 
-    // iterate over possible tile positions
-    for(unsigned int x = min_x; x < max_x; x+=tile_width)
+      glTexCoord2f(r.tex_min_x, r.tex_max_y);
+      glVertex3i(bbox.get_min_x(), bbox.get_max_y(), 0);
+      glEnd();
+    }
+  }
 
-      for(unsigned int y = min_y; y < max_y; y+=tile_width) {
-	GLuint texture = create_and_add_tile(img, x, y, tile_width, elem.first);
-	rendered_bg_tiles.push_back(boost::make_tuple(x, y, texture));
-      }
+  glEndList();
+  assert(error_check());
 
-    glEndList();
+  if(!tile_poll_enabled && tile_streamer->has_pending_work()) {
+    tile_poll_enabled = true;
+    Glib::signal_timeout().connect(sigc::mem_fun(*this, &DegateRenderer::on_tile_poll), 20);
+  }
+}
 
+bool DegateRenderer::on_tile_poll() {
+  if(realized && tile_streamer != NULL) {
+    render_background();
+    update_screen();
   }
+
+  tile_poll_enabled = tile_streamer != NULL && tile_streamer->has_pending_work();
+  return tile_poll_enabled;
 }
 
 void DegateRenderer::drop_tiles() {
 
-  BOOST_FOREACH(bg_tiles_type const & t, rendered_bg_tiles) {
-    GLuint i = t.get<2>();
-    std::cout << "delete texture with id " << i << std::endl;
-    //glDeleteTextures(1, &i);
-    assert(error_check());
-    free_textures.push_back(i);
+  if(tile_streamer != NULL) {
+    std::list<TileStreamer::resident_handle_t> textures;
+    tile_streamer->clear_resident(textures);
+    free_textures.splice(free_textures.end(), textures);
+    tile_streamer.reset();
   }
-
-  rendered_bg_tiles.clear();
 }
-
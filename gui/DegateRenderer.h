@@ -27,12 +27,13 @@
 #include <Layer.h>
 #include <LogicModelHelper.h>
 #include <ScalingManager.h>
+#include <RenderBatchBuilder.h>
+#include <TileStreamer.h>
 
 #include <list>
 #include <set>
 #include <map>
 #include <algorithm>
-#include <boost/tuple/tuple.hpp>
 #include <boost/foreach.hpp>
 
 #include <Editor.h>
@@ -52,20 +53,16 @@ public:
 
   degate::LogicModel_shptr lmodel;
   degate::Layer_shptr layer;
-  double last_scaling;
 
-
-  typedef boost::tuple<unsigned int, unsigned int, GLuint> bg_tiles_type;
-  std::list<bg_tiles_type> rendered_bg_tiles;
-
-  degate::BoundingBox background_bbox;
+  // Background tiles are loaded in worker threads. Uploaded textures are
+  // tracked by the tile streamer.
+  degate::TileStreamer_shptr tile_streamer;
+  bool tile_poll_enabled;
 
   bool realized;
 
   GLuint background_dlist, gates_dlist, gate_details_dlist,
-    vias_dlist, 
-    emarkers_dlist,
-    wires_dlist,
+    connections_dlist,
     annotations_dlist, annotation_details_dlist,
     grid_dlist,
     tool_dlist;
@@ -73,6 +70,11 @@ public:
   bool should_update_gates;
   bool render_details;
 
+  // The region, that the object display lists were compiled for. It is
+  // larger than the viewport, so that panning does not show empty areas
+  // until the lists are recompiled.
+  degate::BoundingBox compiled_region;
+
   bool idle_hook_enabled;
   bool is_idle;
   bool lock_state;
@@ -89,6 +91,11 @@ public:
   std::map<INFO_LAYER, bool> info_layers;
   int corridor_size;
 
+  typedef std::map<degate::layer_id_t, degate::RenderBatchBuilder_shptr> batch_builder_map;
+  batch_builder_map batch_builders;
+
+  degate::HighlightOverlay_shptr highlight_overlay;
+
 protected:
 
   void on_realize();
@@ -122,6 +129,7 @@ public:
 
   void set_logic_model(degate::LogicModel_shptr lmodel) {
     this->lmodel = lmodel;
+    batch_builders.clear();
     should_update_gates = true;
   }
 
@@ -163,13 +171,36 @@ public:
   virtual void update_screen();
 
 
-  void render_vias();
-  void render_emarkers();
-  void render_wires();
+  /**
+   * Render wires, vias and emarkers of the current layer.
+   */
+  void render_connections();
   void render_grid();
 
   void set_default_colors(degate::default_colors_t const& c) {
     default_colors = c;
+    BOOST_FOREACH(batch_builder_map::value_type & p, batch_builders)
+      p.second->set_default_colors(c);
+  }
+
+  /**
+   * Set the overlay, that defines which objects are rendered highlighted.
+   */
+  void set_highlight_overlay(degate::HighlightOverlay_shptr overlay) {
+    highlight_overlay = overlay;
+    BOOST_FOREACH(batch_builder_map::value_type & p, batch_builders)
+      p.second->set_highlight_overlay(overlay);
+  }
+
+  /**
+   * Drop all prepared vertex arrays. Call this method, if the appearance
+   * of objects changed without a notification from the layer, e.g. if
+   * gate template colors or gate orientations were modified.
+   */
+  void invalidate_render_cache() {
+    BOOST_FOREACH(batch_builder_map::value_type & p, batch_builders)
+      p.second->invalidate_all();
+    should_update_gates = true;
   }
   
 
@@ -186,45 +217,37 @@ public:
  private:
 
   /**
-   * Calculate the lower offset to top or left for a tile.
-   */
-  unsigned int to_lower_tile_offset(unsigned int pos, unsigned int tile_width) const {
-    return (pos & ~(tile_width - 1));
-  }
-
-  /**
-   * Calculate the upper offset to top or left for a tile.
+   * Upload a staged background tile into a texture.
+   * @return Returns the texture name.
    */
-  unsigned int to_upper_tile_offset(unsigned int pos, unsigned int tile_width) const {
-    return (pos & ~(tile_width - 1)) + (tile_width - 1);
-  }
+  GLuint upload_tile(degate::TileStreamer::StagedTile const& tile);
 
   /**
-   * Check if a tile is present for the upper/left position given by x,y.
+   * Called periodically as long as background tiles are loaded.
    */
+  bool on_tile_poll();
 
-  bool check_tile_is_present(unsigned int x, unsigned int y) const {
-
-    BOOST_FOREACH(bg_tiles_type const & t, rendered_bg_tiles) {
-      if(x == t.get<0>() && y == t.get<1>()) return true;
-    }
-
-    return false;
-  }
-
+  void drop_tiles();
 
-  GLuint create_and_add_tile(degate::BackgroundImage_shptr img,
-			     unsigned int x, unsigned int y,
-			     unsigned int tile_width,
-			     unsigned int pre_scaling);
+  void render_background();
 
+  /**
+   * Get the render batch builder for a layer. The builder is created on demand.
+   */
+  degate::RenderBatchBuilder_shptr get_batch_builder(degate::Layer_shptr layer);
 
-  void drop_tiles();
+  /**
+   * Submit the vertex arrays of a render group for all chunks of a layer,
+   * that intersect the viewport.
+   */
+  void render_chunks(degate::Layer_shptr layer,
+		     degate::RenderBatchBuilder::RENDER_GROUP group);
 
-  void render_background();
+  void render_vertex_array(degate::RenderBatchBuilder::vertex_array const& v,
+			   GLenum mode);
 
   void render_gates(bool render_into_details_list = false);
-  void render_gate(degate::Gate_shptr gate, bool render_into_details_list);
+  void render_gate_details(degate::Gate_shptr gate);
 
   void render_annotations(bool render_into_details_list = false);
 
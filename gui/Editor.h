@@ -460,14 +460,14 @@ protected:
 	  signal_via_added_(stop_x, stop_y,
 			    shift_state ? degate::Via::DIRECTION_UP :
 			    degate::Via::DIRECTION_DOWN);
-	  GfxEditorTool<RendererType>::get_renderer().render_vias();
+	  GfxEditorTool<RendererType>::get_renderer().render_connections();
 	}
 
 	if(stop_x != start_x || stop_y != start_y) {
 
 	  if(!signal_wire_added_.empty()) {
 	    signal_wire_added_(start_x, start_y, stop_x, stop_y);
-	    GfxEditorTool<RendererType>::get_renderer().render_wires();
+	    GfxEditorTool<RendererType>::get_renderer().render_connections();
 	  }
 
 	}
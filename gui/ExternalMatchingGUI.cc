@@ -80,8 +80,12 @@ bool ExternalMatchingGUI::before_dialog() {
   return false;
 }
 
-void ExternalMatchingGUI::run() {
+void ExternalMatchingGUI::prepare(degate::Project_shptr project) {
+  RecognitionGUIBase::prepare(project);
   matching->init(bounding_box, project);
+}
+
+void ExternalMatchingGUI::run() {
   matching->run();
 }
 
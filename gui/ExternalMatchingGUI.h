@@ -58,6 +58,8 @@ class ExternalMatchingGUI : public RecognitionGUIBase {
 
   virtual bool before_dialog();
 
+  virtual void prepare(degate::Project_shptr project);
+
   virtual void run();
 
   virtual void after_dialog();
@@ -575,6 +575,8 @@ void GateConfigWin::on_ok_button_clicked() {
   BOOST_FOREACH(code_text_map_type::value_type &p, code_text)
     gate_template->set_implementation(p.first, p.second);
 
+  lmodel->update_template(gate_template);
+
   get_dialog()->hide();
   result = true;
 }
@@ -47,11 +47,12 @@ void InProgressWin::init(Gtk::Window *parent, const Glib::ustring& title, const
   m_ProgressBar.set_pulse_step(0.02);
   m_Box.pack_start(m_ProgressBar, Gtk::PACK_SHRINK, 10);
 
+  // Reading the progress is cheap, the workers do not wait for it.
   unsigned int mseconds = 100;
-  if(pc) {
+  if(tracker) {
     cancel_button.signal_clicked().connect(sigc::mem_fun(*this, &InProgressWin::on_cancel_button_clicked));
     m_Box.pack_start(cancel_button, Gtk::PACK_SHRINK, 10);
-    mseconds = 1000;
+    mseconds = 250;
   }
 
   Glib::signal_timeout().connect( sigc::mem_fun(*this, &InProgressWin::update_progress_bar), mseconds);
@@ -64,7 +65,7 @@ InProgressWin::InProgressWin(Gtk::Window *parent,
 			     const Glib::ustring& title,
 			     const Glib::ustring& message,
 			     degate::ProgressControl_shptr pc) : cancel_button(Gtk::Stock::CANCEL) {
-  this->pc = pc;
+  if(pc) tracker = pc->get_progress_tracker();
 
   init(parent, title, message);
 }
@@ -85,13 +86,13 @@ void InProgressWin::close() {
 
 bool InProgressWin::update_progress_bar() {
 
-  if(pc) {
-    double progress = pc->get_progress();
+  if(tracker) {
+    double progress = tracker->get_progress();
     if(progress > 0) {
       m_ProgressBar.set_fraction(progress);
-      m_ProgressBar.set_text(pc->get_time_left_as_string());
-      if(pc->has_log_message())
-	m_Label_Message.set_label(pc->get_log_message());
+      m_ProgressBar.set_text(tracker->get_time_left_as_string());
+      if(tracker->has_log_message())
+	m_Label_Message.set_label(tracker->get_log_message());
 
     }
     else {
@@ -107,5 +108,5 @@ bool InProgressWin::update_progress_bar() {
 
 
 void InProgressWin::on_cancel_button_clicked() {
-  if(pc) pc->cancel();
+  if(tracker) tracker->get_cancellation_token()->cancel();
 }
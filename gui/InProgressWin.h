@@ -35,7 +35,7 @@ class InProgressWin : public Gtk::Window {
 
  private:
 
-  degate::ProgressControl_shptr pc;
+  degate::ProgressTracker_shptr tracker;
 
   bool running;
 
@@ -64,7 +64,12 @@ along with degate. If not, see <http://www.gnu.org/licenses/>.
 
 using namespace degate;
 
-MainWin::MainWin() : render_window(editor), is_fullscreen(false) {
+MainWin::MainWin() :
+  render_window(editor),
+  is_fullscreen(false),
+  algorithm_thread(NULL),
+  algorithm_slot_pos(0),
+  algorithm_canceled_notifications(0) {
 
   // setup window
   set_default_size(1024, 700);
@@ -72,6 +77,8 @@ MainWin::MainWin() : render_window(editor), is_fullscreen(false) {
   snprintf(path, PATH_MAX, "%s/icons/degate_logo.png", getenv("DEGATE_HOME"));
   set_icon_from_file(path);
 
+  editor.set_highlight_overlay(highlighted_objects.get_overlay());
+
   add(m_Box);
 
 
@@ -126,9 +133,11 @@ MainWin::MainWin() : render_window(editor), is_fullscreen(false) {
   signal_key_release_event().connect(sigc::mem_fun(*this,&MainWin::on_key_release_event_received), false);
   signal_hide().connect(sigc::mem_fun(*this, &MainWin::on_menu_project_close), false);
 
+  signal_algorithm_finished_.connect(sigc::mem_fun(*this, &MainWin::on_algorithm_finished));
 }
 
 MainWin::~MainWin() {
+  stop_algorithm();
 }
 
 
@@ -161,8 +170,10 @@ bool MainWin::on_timer() {
 
   if(main_project != NULL) {
     try {
-      if(autosave_project(main_project))
+      if(autosaver.finish())
 	m_statusbar.push("Autosaving project data ... done.");
+      if(autosave_project(main_project, autosaver))
+	m_statusbar.push("Autosaving project data ...");
     }
     catch(DegateRuntimeException const& ex) {
       error_dialog("Error", "Can't save project.");
@@ -291,6 +302,9 @@ void MainWin::create_new_project(std::string const& project_dir) {
 void MainWin::on_menu_project_close() {
   if(main_project) {
 
+    // The worker reads from the project.
+    stop_algorithm();
+
     if(main_project->is_changed() &&
        yes_no_dialog("Warning", "Project data was modified. Should it be saved?"))
       on_menu_project_save();
@@ -299,6 +313,13 @@ void MainWin::on_menu_project_close() {
 
     clear_selection();
 
+    try {
+      autosaver.wait();
+    }
+    catch(DegateRuntimeException const& ex) {
+      error_dialog("Error", ex.what());
+    }
+
     main_project.reset();
     editor.update_screen();
 
@@ -417,6 +438,9 @@ void MainWin::on_menu_project_save() {
       LogicModelDOTExporter ee(rewriter);
       ee.export_data("myfile.dot", main_project->get_logic_model());
     try {
+      // The autosave shares the template images with the project.
+      autosaver.wait();
+
       ProjectExporter exporter;
       exporter.export_all(main_project->get_project_directory(), main_project, false);
       main_project->set_changed(false);
@@ -462,8 +486,11 @@ void MainWin::open_project(Glib::ustring project_dir) {
       restore_autosaved_project(project_dir.c_str());
   }
 
+  project_importer = ProjectImporter_shptr(new ProjectImporter());
+
   ipWin = std::tr1::shared_ptr<InProgressWin>
-    (new InProgressWin(this, "Opening Project", "Please wait while opening project."));
+    (new InProgressWin(this, "Opening Project", "Please wait while opening project.",
+		       project_importer));
   ipWin->show();
 
 
@@ -479,8 +506,7 @@ void MainWin::project_open_thread(Glib::ustring project_dir) {
   assert(main_project == NULL);
 
   try {
-    ProjectImporter importer;
-    main_project = importer.import_all(project_dir);
+    main_project = project_importer->import_all(project_dir);
     debug(TM, "in project_open_thread(): project loaded");
   }
   catch(std::runtime_error const& ex) {
@@ -501,6 +527,8 @@ void MainWin::on_project_load_finished() {
     ipWin.reset();
   }
 
+  project_importer.reset();
+
   if(main_project == NULL) {
     Gtk::MessageDialog err_dialog(*this, thread_error_msg,
 				  false, Gtk::MESSAGE_ERROR, Gtk::BUTTONS_OK, true);
@@ -792,28 +820,52 @@ void MainWin::on_menu_tools_via(degate::Via::DIRECTION dir) {
 }
 
 
-void MainWin::on_algorithm_finished(int slot_pos) {
+void MainWin::on_algorithm_finished() {
 
-
-  if(ipWin) {
-    ipWin->close();
-    ipWin.reset();
+  if(algorithm_canceled_notifications > 0) {
+    algorithm_canceled_notifications--;
+    return;
   }
 
-  editor.update_screen();
+  assert(algorithm_thread != NULL);
+  algorithm_thread->join();
+  algorithm_thread = NULL;
+
+  int slot_pos = algorithm_slot_pos;
+
+  if(algorithm_win) {
+    algorithm_win->close();
+    algorithm_win.reset();
+  }
 
   debug(TM, "Algorithm finished.");
 
   RecognitionManager & rm = RecognitionManager::get_instance();
+
+  // The algorithm worked on a snapshot. Apply its results in the GUI thread.
+  try {
+    unsigned int n = rm.commit(slot_pos, algorithm_project);
+    debug(TM, "Inserted %d objects.", n);
+  }
+  catch(DegateRuntimeException const& ex) {
+    error_dialog("Error", ex.what());
+  }
+  catch(DegateLogicException const& ex) {
+    error_dialog("Error", ex.what());
+  }
+
+  editor.update_screen();
+
   rm.after_dialog(slot_pos);
 
-  signal_algorithm_finished_.reset();
+  menu_manager->set_algorithm_running(false);
 
-  project_changed();
+  if(algorithm_project == main_project) project_changed();
+  algorithm_project.reset();
 
   /*
   try {
-    if(autosave_project(main_project, 0))
+    if(autosave_project(main_project, autosaver, 0))
       m_statusbar.push("Autosaving project data ... done.");
   }
   catch(DegateRuntimeException const& ex) {
@@ -830,7 +882,32 @@ void MainWin::algorithm_calc_thread(int slot_pos) {
 
   rm.run(slot_pos);
 
-  signal_algorithm_finished_->emit();
+  signal_algorithm_finished_();
+}
+
+void MainWin::stop_algorithm() {
+
+  if(algorithm_thread == NULL) return;
+
+  debug(TM, "Cancel algorithm.");
+  RecognitionManager & rm = RecognitionManager::get_instance();
+
+  rm.get_progress_control(algorithm_slot_pos)->cancel();
+  algorithm_thread->join();
+  algorithm_thread = NULL;
+
+  // The worker notified the GUI thread before it terminated.
+  algorithm_canceled_notifications++;
+
+  rm.discard(algorithm_slot_pos);
+  algorithm_project.reset();
+
+  if(algorithm_win) {
+    algorithm_win->close();
+    algorithm_win.reset();
+  }
+
+  menu_manager->set_algorithm_running(false);
 }
 
 void MainWin::on_algorithms_func_clicked(int slot_pos) {
@@ -840,6 +917,11 @@ void MainWin::on_algorithms_func_clicked(int slot_pos) {
     return;
   }
 
+  if(algorithm_thread != NULL) {
+    error_dialog("Error", "There is already an algorithm running.");
+    return;
+  }
+
   RecognitionManager & rm = RecognitionManager::get_instance();
 
   std::tr1::shared_ptr<GfxEditorToolSelection<DegateRenderer> > selection_tool =
@@ -852,18 +934,30 @@ void MainWin::on_algorithms_func_clicked(int slot_pos) {
 
   if(rm.before_dialog(slot_pos)) {
 
-    ipWin = std::tr1::shared_ptr<InProgressWin>
-      (new InProgressWin(this, "Calculating", "Please wait while calculating.", rm.get_progress_control(slot_pos)));
-    ipWin->show();
+    // The algorithm reads from a snapshot and does not change the logic
+    // model until it is finished. So the editor stays usable.
+    algorithm_project = main_project;
+    try {
+      rm.prepare(slot_pos, algorithm_project);
+    }
+    catch(DegateRuntimeException const& ex) {
+      algorithm_project.reset();
+      error_dialog("Error", ex.what());
+      return;
+    }
 
-    signal_algorithm_finished_ = std::tr1::shared_ptr<Glib::Dispatcher>(new Glib::Dispatcher);
+    algorithm_win = std::tr1::shared_ptr<InProgressWin>
+      (new InProgressWin(this, "Calculating", "Please wait while calculating.", rm.get_progress_control(slot_pos)));
+    algorithm_win->set_modal(false);
+    algorithm_win->show();
 
-    signal_algorithm_finished_->connect(sigc::bind(sigc::mem_fun(*this,
-								 &MainWin::on_algorithm_finished),
-						   slot_pos));
+    // The worker reads the templates, the layers and the background
+    // images. Don't let the user change them meanwhile.
+    menu_manager->set_algorithm_running(true);
 
-    thread = Glib::Thread::create(sigc::bind(sigc::mem_fun(*this, &MainWin::algorithm_calc_thread),
-					     slot_pos), false);
+    algorithm_slot_pos = slot_pos;
+    algorithm_thread = Glib::Thread::create(sigc::bind(sigc::mem_fun(*this, &MainWin::algorithm_calc_thread),
+						       slot_pos), true);
   }
 }
 
@@ -915,6 +1009,7 @@ void MainWin::on_menu_gate_port_colors() {
     apply_port_color_settings(main_project->get_logic_model(),
 			      main_project->get_port_color_manager());
 
+    editor.invalidate_render_cache();
     editor.update_screen();
     project_changed();
   }
@@ -922,6 +1017,13 @@ void MainWin::on_menu_gate_port_colors() {
 
 
 void MainWin::on_menu_gate_list() {
+
+  // The menu item is disabled, but the accelerator is still active.
+  if(algorithm_thread != NULL) {
+    error_dialog("Error", "The gate library can't be edited while an algorithm is running.");
+    return;
+  }
+
   if(main_project != NULL) {
     GateListWin glWin(this, main_project->get_logic_model(),
 		      main_project->get_default_color(DEFAULT_COLOR_GATE_FRAME),
@@ -931,11 +1033,12 @@ void MainWin::on_menu_gate_list() {
     apply_port_color_settings(main_project->get_logic_model(),
 			      main_project->get_port_color_manager());
 
-    project_changed();
-    editor.update_screen();
-
     apply_colors_to_gate_ports(main_project->get_logic_model(),
 			       main_project->get_port_color_manager());
+
+    project_changed();
+    editor.invalidate_render_cache();
+    editor.update_screen();
   }
 }
 
@@ -952,6 +1055,7 @@ void MainWin::on_menu_gate_orientation() {
       if(new_ori != gate->get_orientation()) {
 	gate->set_orientation(new_ori);
 	main_project->get_logic_model()->update_ports(gate);
+	editor.invalidate_render_cache();
       }
       else {
 	editor.update_screen();
@@ -40,6 +40,8 @@ along with degate. If not, see <http://www.gnu.org/licenses/>.
 #include <EMarker.h>
 #include <degate.h>
 #include <AutoNameGates.h>
+#include <ProjectImporter.h>
+#include <Autosaver.h>
 #include <BoundingBox.h>
 
 #include <set>
@@ -186,6 +188,10 @@ class MainWin : public Gtk::Window  {
 
 
   std::tr1::shared_ptr<InProgressWin> ipWin;
+
+  // The progress window of a running algorithm. It is not modal, so it
+  // is kept apart from ipWin.
+  std::tr1::shared_ptr<InProgressWin> algorithm_win;
   std::tr1::shared_ptr<ConnectionInspectorWin> ciWin;
   std::tr1::shared_ptr<RCViolationsWin> rcWin;
   std::tr1::shared_ptr<ModuleWin> modWin;
@@ -199,6 +205,13 @@ class MainWin : public Gtk::Window  {
 
   degate::Project_shptr main_project;
 
+  // The importer of a project, that is being opened. The progress
+  // window reads its progress.
+  degate::ProjectImporter_shptr project_importer;
+
+  // Writes autosaved versions of the main project in the background.
+  degate::Autosaver autosaver;
+
  private:
 
   bool shift_key_pressed;
@@ -232,16 +245,34 @@ class MainWin : public Gtk::Window  {
 
   void algorithm_calc_thread(int slot_pos);
 
+  /**
+   * Cancel a running algorithm, wait for its worker thread and drop its
+   * results. Call this before the project is closed or replaced.
+   */
+  void stop_algorithm();
+
   void project_export_thread(std::string project_dir, std::string dst_file);
 
   void on_project_load_finished();
   void on_background_import_finished();
-  void on_algorithm_finished(int slot_pos);
+  void on_algorithm_finished();
   void on_export_finished(bool success);
 
   Glib::Dispatcher signal_project_open_finished_;
   Glib::Dispatcher signal_bg_import_finished_;
-  std::tr1::shared_ptr<Glib::Dispatcher> signal_algorithm_finished_;
+  Glib::Dispatcher signal_algorithm_finished_;
+
+  // The worker thread of a running algorithm. It is NULL, if no
+  // algorithm is running.
+  Glib::Thread * algorithm_thread;
+  int algorithm_slot_pos;
+
+  // The number of notifications from canceled workers, that are still
+  // queued in signal_algorithm_finished_ and must be ignored.
+  unsigned int algorithm_canceled_notifications;
+
+  // The project, that a running algorithm reads from and commits to.
+  degate::Project_shptr algorithm_project;
   sigc::signal<void, bool> signal_export_finished_;
 
   void update_gui_for_loaded_project();
@@ -799,6 +799,23 @@ void MenuManager::set_widget_sensitivity(bool state) {
 
 }
 
+void MenuManager::set_algorithm_running(bool state) {
+
+  set_toolbar_item_sensitivity("/ToolBar/GateList", !state);
+
+  set_menu_item_sensitivity("/MenuBar/ProjectMenu/ProjectSettings", !state);
+  set_menu_item_sensitivity("/MenuBar/ProjectMenu/ProjectPullChanges", !state);
+
+  set_menu_item_sensitivity("/MenuBar/LayerMenu/LayerImportBackground", !state);
+  set_menu_item_sensitivity("/MenuBar/LayerMenu/LayerClearBackgroundImage", !state);
+  set_menu_item_sensitivity("/MenuBar/LayerMenu/LayerConfiguration", !state);
+
+  set_menu_item_sensitivity("/MenuBar/GateMenu/GateList", !state);
+  set_menu_item_sensitivity("/MenuBar/GateMenu/GateCreateBySelection", !state);
+  set_menu_item_sensitivity("/MenuBar/GateMenu/GateSetAsMaster", !state);
+  set_menu_item_sensitivity("/MenuBar/GateMenu/GateRemoveGateByType", !state);
+}
+
 void MenuManager::set_menu_item_sensitivity(const Glib::ustring& widget_path, bool state) {
   Gtk::MenuItem * pItem = dynamic_cast<Gtk::MenuItem*>(m_refUIManager->get_widget(widget_path));
 #ifdef DEBUG
@@ -64,6 +64,12 @@ class MenuManager {
 
   void set_widget_sensitivity(bool state);
 
+  /**
+   * Disable the menu items, that change gate templates, layers or
+   * background images, while an algorithm reads them in a worker thread.
+   */
+  void set_algorithm_running(bool state);
+
   std::string get_recent_project_uri();
 
   void toggle_select_move_tool();
@@ -32,6 +32,7 @@
 #include <string.h>
 
 #include <iostream>
+#include <fstream>
 #include <set>
 
 #include <globals.h>
@@ -435,9 +436,24 @@ void ModuleWin::on_export_button_clicked() {
 
     if(result == Gtk::RESPONSE_OK) {
       // create a new generator
+      // and write the code directly into the file
       VerilogModuleGenerator codegen(mod);
-      std::string impl = codegen.generate();
-      write_string_to_file(dialog.get_filename(), impl);
+      try {
+	std::ofstream file(dialog.get_filename().c_str(), std::ios::trunc | std::ios::out);
+	if(!file)
+	  throw FileSystemException(std::string("Can't open file ") + dialog.get_filename());
+
+	codegen.generate(file);
+	file.close();
+	if(file.fail())
+	  throw FileSystemException(std::string("Can't write file ") + dialog.get_filename());
+      }
+      catch(DegateRuntimeException const& ex) {
+	Gtk::MessageDialog err_dialog(*this, "Can't export module.", true, Gtk::MESSAGE_ERROR);
+	err_dialog.set_title("Error");
+	err_dialog.set_secondary_text(ex.what());
+	err_dialog.run();
+      }
     }
 
   }
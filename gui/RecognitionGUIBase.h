@@ -29,63 +29,67 @@
 #include <BoundingBox.h>
 #include <Project.h>
 #include <ProgressControl.h>
+#include <TemplateMatching.h>
 
 class RecognitionGUIBase : public degate::ProgressControl {
 private:
 
   std::string name;
   degate::ProgressControl_shptr pc;
+  degate::Matching_shptr matching;
 
 public:
+  /**
+   * The GUI object shares the progress tracker of the underlying object
+   * from degate lib. So the GUI code can work with the progress and the
+   * cancellation without knowing the underlying object.
+   */
   RecognitionGUIBase(std::string const& _name, degate::ProgressControl_shptr _pc) :
-    name(_name), pc(_pc) {}
+    name(_name), pc(_pc),
+    matching(std::tr1::dynamic_pointer_cast<degate::Matching>(_pc)) {
+    if(pc) share_progress(*pc);
+  }
 
   virtual ~RecognitionGUIBase() {}
   virtual void init(Gtk::Window *parent, degate::BoundingBox const& bouding_box,
 		    degate::Project_shptr project) = 0;
   virtual bool before_dialog() = 0;
-  virtual void run() = 0;
-  virtual void after_dialog() = 0;
-  virtual std::string get_name() const { return name; }
 
-
-  /*
-    Here we wrap methods of ProgressControl. So the GUI code can work with
-    underlying objects from degate lib without knowing them.
+  /**
+   * Prepare run() for a worker thread. This method is called in the GUI
+   * thread. The default implementation passes a snapshot of the logic model
+   * to the matching algorithm and defers the commit of its results. Derived
+   * classes initialize the matching algorithm here, because the
+   * initialization reads from the project.
    */
-
-  virtual double get_progress() const {
-    return pc ? pc->get_progress() : 0;
-  }
-
-  virtual time_t get_time_passed() const {
-    return pc ? pc->get_time_passed() : 0;
-  }
-
-  virtual time_t get_time_left() const {
-    return pc ? pc->get_time_left() : 0;
-  }
-
-  virtual std::string get_time_left_as_string() const {
-    return pc ? pc->get_time_left_as_string() : std::string("-");
+  virtual void prepare(degate::Project_shptr project) {
+    if(matching) {
+      matching->set_snapshot(degate::LogicModelSnapshot_shptr
+			     (new degate::LogicModelSnapshot(project->get_logic_model())));
+      matching->set_deferred_commit(true);
+    }
   }
 
-  virtual std::string get_log_message() const {
-    return pc ? pc->get_log_message() : std::string("");
-  }
+  virtual void run() = 0;
 
-  virtual bool has_log_message() const {
-    return pc ? pc->has_log_message() : false;
+  /**
+   * Apply the results of run() to the logic model. This method is called
+   * in the GUI thread, after the worker thread finished.
+   * @return Returns the number of objects inserted into the logic model.
+   */
+  virtual unsigned int commit(degate::Project_shptr project) {
+    return matching ? matching->commit(project->get_logic_model()) : 0;
   }
 
-  virtual void cancel() {
-    if(pc) pc->cancel();
+  /**
+   * Drop the results of a canceled run().
+   */
+  virtual void discard() {
+    if(matching) matching->discard_pending_changes();
   }
 
-  virtual bool is_canceled() const {
-    if(pc) return pc->is_canceled();
-    else return false;
-  }
+  virtual void after_dialog() = 0;
+  virtual std::string get_name() const { return name; }
 
 };
 
@@ -60,11 +60,26 @@ class RecognitionManager : public degate::SingletonBase<RecognitionManager> {
     return plugins[slot]->before_dialog();
   }
 
+  void prepare(unsigned int slot, degate::Project_shptr project) {
+    assert(slot < plugins.size());
+    plugins[slot]->prepare(project);
+  }
+
   void run(unsigned int slot) {
     assert(slot < plugins.size());
     return plugins[slot]->run();
   }
 
+  unsigned int commit(unsigned int slot, degate::Project_shptr project) {
+    assert(slot < plugins.size());
+    return plugins[slot]->commit(project);
+  }
+
+  void discard(unsigned int slot) {
+    assert(slot < plugins.size());
+    plugins[slot]->discard();
+  }
+
   void after_dialog(unsigned int slot) {
     assert(slot < plugins.size());
     plugins[slot]->after_dialog();
@@ -186,9 +186,12 @@ bool TemplateMatchingGUI::check_template_selection(std::list<GateTemplate_shptr>
 }
 
 
-void TemplateMatchingGUI::run() {
-
+void TemplateMatchingGUI::prepare(degate::Project_shptr project) {
+  RecognitionGUIBase::prepare(project);
   matching->init(bounding_box, project);
+}
+
+void TemplateMatchingGUI::run() {
   matching->run();
 }
 
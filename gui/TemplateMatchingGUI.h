@@ -82,6 +82,7 @@ class TemplateMatchingGUI : public RecognitionGUIBase {
 		    degate::BoundingBox const& bounding_box,
 		    degate::Project_shptr project);
   virtual bool before_dialog();
+  virtual void prepare(degate::Project_shptr project);
   virtual void run();
   virtual void after_dialog();
 
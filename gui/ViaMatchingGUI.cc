@@ -103,8 +103,12 @@ bool ViaMatchingGUI::before_dialog() {
   else return false;
 }
 
-void ViaMatchingGUI::run() {
+void ViaMatchingGUI::prepare(degate::Project_shptr project) {
+  RecognitionGUIBase::prepare(project);
   matching->init(bounding_box, project);
+}
+
+void ViaMatchingGUI::run() {
   matching->run();
 }
 
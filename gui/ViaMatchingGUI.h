@@ -60,6 +60,8 @@ public:
 
   virtual bool before_dialog();
 
+  virtual void prepare(degate::Project_shptr project);
+
   virtual void run();
 
   virtual void after_dialog();
@@ -101,8 +101,12 @@ bool WireMatchingGUI::before_dialog() {
   else return false;
 }
 
-void WireMatchingGUI::run() {
+void WireMatchingGUI::prepare(degate::Project_shptr project) {
+  RecognitionGUIBase::prepare(project);
   matching->init(bounding_box, project);
+}
+
+void WireMatchingGUI::run() {
   matching->run();
 }
 
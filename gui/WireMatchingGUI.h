@@ -66,6 +66,8 @@ class WireMatchingGUI : public RecognitionGUIBase {
 
   virtual bool before_dialog();
 
+  virtual void prepare(degate::Project_shptr project);
+
   virtual void run();
 
   virtual void after_dialog();
@@ -0,0 +1,258 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <Autosaver.h>
+#include <ProjectExporter.h>
+#include <FileSystem.h>
+#include <DegateHelper.h>
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <set>
+
+using namespace degate;
+
+namespace {
+
+  const char * const artefact_names[] = {
+    "project.xml", "lmodel.xml", "gate_library.xml", "rc_blacklist.xml"
+  };
+
+  const unsigned int num_artefacts = sizeof(artefact_names) / sizeof(artefact_names[0]);
+
+  uint64_t get_content_hash(std::string const& content) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(std::string::const_iterator iter = content.begin(); iter != content.end(); ++iter)
+      hash = (hash ^ (unsigned char)*iter) * 0x100000001b3ULL;
+    return hash;
+  }
+
+  bool read_file(std::string const& path, std::string & content) {
+    std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+    if(!file) return false;
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+  }
+}
+
+
+Autosaver::Autosaver(unsigned int _history_size) :
+  history_size(std::max(_history_size, 1U)),
+  running(false) {
+}
+
+Autosaver::~Autosaver() {
+  if(thread != NULL) thread->join();
+}
+
+void Autosaver::set_history_size(unsigned int _history_size) {
+  boost::lock_guard<boost::mutex> lock(mtx);
+  history_size = std::max(_history_size, 1U);
+}
+
+unsigned int Autosaver::get_history_size() const {
+  boost::lock_guard<boost::mutex> lock(mtx);
+  return history_size;
+}
+
+bool Autosaver::start(Project_shptr project, time_t t) {
+
+  if(project == NULL) throw InvalidPointerException("Invalid project.");
+
+  if(is_running()) return false;
+  finish();
+
+  ExportBuffer_shptr b(new ExportBuffer());
+  std::string p = get_prefix(t);
+
+  ProjectExporter exporter;
+  exporter.set_export_buffer(b);
+  exporter.export_all(project->get_project_directory(), project, false,
+		      p + artefact_names[0], p + artefact_names[1],
+		      p + artefact_names[2], p + artefact_names[3]);
+
+  buffer = b;
+  project_dir = project->get_project_directory();
+  prefix = p;
+
+  running = true;
+  thread = std::tr1::shared_ptr<boost::thread>(new boost::thread(boost::bind(&Autosaver::run, this)));
+  return true;
+}
+
+bool Autosaver::is_running() const {
+  boost::lock_guard<boost::mutex> lock(mtx);
+  return running;
+}
+
+bool Autosaver::finish() {
+
+  if(is_running() || buffer == NULL) return false;
+
+  thread->join();
+  thread.reset();
+
+  buffer->apply_image_states();
+  buffer.reset();
+
+  if(!error.empty()) {
+    std::string msg = "Autosave failed: " + error;
+    error.clear();
+    throw DegateRuntimeException(msg);
+  }
+
+  return true;
+}
+
+void Autosaver::wait() {
+  if(thread != NULL) thread->join();
+  finish();
+}
+
+void Autosaver::run() {
+
+  try {
+    buffer->serialize_documents();
+
+    // Images first, because the documents refer to them.
+    buffer->write_images();
+    write_artefacts();
+    remove_old_versions();
+  }
+  catch(std::exception const& ex) {
+    boost::lock_guard<boost::mutex> lock(mtx);
+    error = ex.what();
+  }
+
+  boost::lock_guard<boost::mutex> lock(mtx);
+  running = false;
+}
+
+void Autosaver::write_artefacts() {
+
+  std::vector<std::pair<std::string, std::string> > links;
+
+  BOOST_FOREACH(ExportBuffer::File const& f, buffer->get_files()) {
+
+    std::string filename = get_filename_from_path(f.path);
+    assert(filename.compare(0, prefix.size(), prefix) == 0);
+    std::string link_path = join_pathes(project_dir, "." + filename.substr(prefix.size()));
+    std::string real_path = join_pathes(get_realpath(project_dir), filename);
+
+    uint64_t hash = get_content_hash(f.content);
+
+    // In a new session, compare with the latest version from disk.
+    if(last_artefacts.find(link_path) == last_artefacts.end()) {
+      std::string content;
+      if(is_symlink(link_path) && read_file(link_path, content)) {
+	Artefact a;
+	a.path = get_realpath(link_path);
+	a.hash = get_content_hash(content);
+	last_artefacts[link_path] = a;
+      }
+    }
+
+    std::map<std::string, Artefact>::const_iterator last = last_artefacts.find(link_path);
+    bool unchanged = last != last_artefacts.end() && last->second.hash == hash &&
+      file_exists(last->second.path);
+
+    if(unchanged && last->second.path == real_path) {
+      // The latest version has the same name and content.
+    }
+    else if(unchanged && create_hard_link(last->second.path, f.path + ".tmp")) {
+      rename_file(f.path + ".tmp", f.path);
+    }
+    else {
+      write_string_to_file_atomically(f.path, f.content);
+    }
+
+    Artefact a;
+    a.path = real_path;
+    a.hash = hash;
+    last_artefacts[link_path] = a;
+
+    links.push_back(std::make_pair(filename, link_path));
+  }
+
+  // Switch to the new version after all files are written.
+  for(size_t i = 0; i < links.size(); i++)
+    replace_symlink(links[i].first, links[i].second);
+}
+
+void Autosaver::remove_old_versions() {
+
+  unsigned int versions_to_keep = get_history_size();
+
+  std::list<std::string> entries = read_directory(project_dir);
+  std::set<std::string> prefixes;
+
+  BOOST_FOREACH(std::string const& entry, entries)
+    for(unsigned int i = 0; i < num_artefacts; i++) {
+      std::string name(artefact_names[i]);
+      if(entry.size() > name.size() &&
+	 entry.compare(entry.size() - name.size(), name.size(), name) == 0 &&
+	 is_prefix(entry.substr(0, entry.size() - name.size())))
+	prefixes.insert(entry.substr(0, entry.size() - name.size()));
+    }
+
+  // Prefixes sort in chronological order.
+  while(prefixes.size() > versions_to_keep) {
+    std::string const& oldest = *prefixes.begin();
+    assert(oldest != prefix);
+
+    for(unsigned int i = 0; i < num_artefacts; i++) {
+      std::string path = join_pathes(project_dir, oldest + artefact_names[i]);
+      if(file_exists(path)) remove_file(path);
+    }
+
+    prefixes.erase(prefixes.begin());
+  }
+}
+
+std::string Autosaver::get_prefix(time_t t) {
+  tm now;
+  localtime_r(&t, &now);
+
+  boost::format f("%4d-%02d-%02d_%02d%02d_");
+  f
+    % (now.tm_year+1900)
+    % (now.tm_mon+1)
+    % now.tm_mday
+    % now.tm_hour
+    % now.tm_min;
+  return f.str();
+}
+
+bool Autosaver::is_prefix(std::string const& prefix) {
+  const char pattern[] = "dddd-dd-dd_dddd_";
+  if(prefix.size() != sizeof(pattern) - 1) return false;
+
+  for(size_t i = 0; i < prefix.size(); i++)
+    if(pattern[i] == 'd' ? !isdigit(prefix[i]) : prefix[i] != pattern[i]) return false;
+
+  return true;
+}
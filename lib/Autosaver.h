@@ -0,0 +1,161 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __AUTOSAVER_H__
+#define __AUTOSAVER_H__
+
+#include <globals.h>
+#include <Project.h>
+#include <ExportBuffer.h>
+#include <Configuration.h>
+
+#include <boost/thread.hpp>
+
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include <tr1/memory>
+
+namespace degate {
+
+  /**
+   * The Autosaver writes autosaved versions of a project in a background thread.
+   *
+   * An autosaved version consists of the project files with a date and time
+   * prefix, e.g. "2010-05-23_1742_lmodel.xml". Hidden symlinks, e.g.
+   * ".lmodel.xml", point to the latest version.
+   *
+   * An autosave runs in two steps. start() exports the project into an
+   * ExportBuffer. It must be called from the thread, that owns the logic
+   * model. The buffer is a consistent snapshot of the project. A background
+   * thread then serializes the documents and writes the buffer. Files are written via temp files and
+   * renamed. The symlinks are switched after all files are written.
+   *
+   * If an autosave is requested, while the previous one is still written,
+   * start() returns false. The caller keeps its changed state and retries
+   * later, so that pending changes are coalesced into the next autosave.
+   *
+   * Files, that did not change since the previous version, are hard linked
+   * instead of written again. Template images are shared by all versions and
+   * only written, if they changed. Only the latest autosaved versions are
+   * kept, older ones are removed.
+   */
+
+  class Autosaver {
+
+  private:
+
+    struct Artefact {
+      std::string path;
+      uint64_t hash;
+    };
+
+    // The symlink path of an artefact -> the artefact of the latest version.
+    std::map<std::string, Artefact> last_artefacts;
+
+    unsigned int history_size;
+
+    ExportBuffer_shptr buffer;
+    std::string project_dir;
+    std::string prefix;
+
+    std::tr1::shared_ptr<boost::thread> thread;
+    mutable boost::mutex mtx;
+    bool running;
+    std::string error;
+
+    void run();
+    void write_artefacts();
+    void remove_old_versions();
+
+  public:
+
+    /**
+     * Create an Autosaver.
+     * @param history_size The number of autosaved versions, that are kept.
+     */
+    Autosaver(unsigned int history_size = Configuration::get_instance().get_autosave_history_size());
+
+    /**
+     * Wait for a running autosave.
+     */
+    ~Autosaver();
+
+    /**
+     * Set the number of autosaved versions, that are kept. It is at least one.
+     */
+    void set_history_size(unsigned int history_size);
+
+    /**
+     * Get the number of autosaved versions, that are kept.
+     */
+    unsigned int get_history_size() const;
+
+    /**
+     * Start an autosave. Call it from the thread, that owns the project.
+     * @param project The project.
+     * @param t The time, that is used for the file name prefix.
+     * @return Returns false, if the previous autosave is still running.
+     * @exception DegateRuntimeException This exception is thrown, if the
+     *   project cannot be exported or if the previous autosave failed.
+     */
+    bool start(Project_shptr project, time_t t = time(NULL));
+
+    /**
+     * Check if an autosave is written in the background.
+     */
+    bool is_running() const;
+
+    /**
+     * Finish a completed autosave. The state of written template images
+     * is recorded in the templates. Call it from the thread, that owns
+     * the project.
+     * @return Returns true, if an autosave was finished. Returns false, if
+     *   there is no autosave or if it is still running.
+     * @exception DegateRuntimeException This exception is thrown, if the
+     *   autosave failed.
+     */
+    bool finish();
+
+    /**
+     * Wait for a running autosave and finish it.
+     * @exception DegateRuntimeException This exception is thrown, if the
+     *   autosave failed.
+     */
+    void wait();
+
+    /**
+     * Get the file name prefix for autosaved versions, e.g. "2010-05-23_1742_".
+     */
+    static std::string get_prefix(time_t t);
+
+    /**
+     * Check if a string is a file name prefix for autosaved versions.
+     */
+    static bool is_prefix(std::string const& prefix);
+  };
+
+  typedef std::tr1::shared_ptr<Autosaver> Autosaver_shptr;
+
+}
+
+#endif
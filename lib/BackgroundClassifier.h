@@ -34,6 +34,7 @@
 
 #include <list>
 #include <vector>
+#include <map>
 #include <adaboost.hpp>
 
 namespace degate {
@@ -55,6 +56,19 @@ namespace degate {
 
 
 
+  /**
+   * A weak classifier, that decides if a coordinate is foreground or background.
+   *
+   * A pixel votes for foreground, if its feature value is more frequent in
+   * the foreground histogram than in the background histogram. Because both
+   * histograms have the same classes, the decision is precomputed for each
+   * class. A coordinate is foreground, if at least \p threshold pixels in the
+   * window around the coordinate vote for foreground.
+   *
+   * The votes are counted with summed-area tables over the per-pixel decisions.
+   * The tables are computed for square blocks of the image and cached, so that
+   * training, that classifies many samples, reads each pixel only once.
+   */
   template<class ImageType, typename HistogramType>
   class BackgroundClassifier : public BackgroundClassifierBase {
 
@@ -66,6 +80,88 @@ namespace degate {
     const unsigned int threshold;
     const std::string cl_name;
 
+    const static unsigned int block_size = 128;
+
+    // decision per histogram class, 1 for foreground
+    std::vector<unsigned char> decisions;
+
+    // block index -> summed-area table
+    typedef std::map<std::pair<unsigned int, unsigned int>, std::vector<unsigned int> > block_cache_type;
+    block_cache_type block_cache;
+
+  private:
+
+    void update_decisions() {
+      if(!decisions.empty()) return;
+      decisions.resize(hist_fg.get_num_classes());
+      for(unsigned int c = 0; c < decisions.size(); c++)
+	decisions[c] = hist_fg.get_class_frequency(c) > hist_bg.get_class_frequency(c) ? 1 : 0;
+    }
+
+    /**
+     * Calculate the summed-area table of the pixel decisions for the region, that starts
+     * at min_x, min_y and has the size w x h. Entry (x, y) of the table is the number of
+     * foreground votes in [min_x, min_x + x) x [min_y, min_y + y). Pixels outside of
+     * the image do not vote.
+     */
+    void calculate_summed_area_table(int min_x, int min_y, unsigned int w, unsigned int h,
+				     std::vector<unsigned int> & table) {
+      update_decisions();
+
+      const unsigned int stride = w + 1;
+      table.assign(stride * (h + 1), 0);
+
+      for(unsigned int y = 0; y < h; y++) {
+	const int img_y = min_y + (int)y;
+	unsigned int const * above = &table[y * stride];
+	unsigned int * row = &table[(y + 1) * stride];
+	unsigned int row_sum = 0;
+
+	for(unsigned int x = 0; x < w; x++) {
+	  const int img_x = min_x + (int)x;
+	  if(img_y >= 0 && img_y < (int)img->get_height() && img_x >= 0 && img_x < (int)img->get_width())
+	    row_sum += decisions[hist_fg.get_class_for_rgb(img->get_pixel(img_x, img_y))];
+	  row[x + 1] = above[x + 1] + row_sum;
+	}
+      }
+    }
+
+    /**
+     * Get the summed-area table for a block. The table covers the block
+     * and a margin of the window radius.
+     */
+    std::vector<unsigned int> const& get_block_table(unsigned int bx, unsigned int by) {
+      std::pair<typename block_cache_type::iterator, bool> found =
+	block_cache.insert(std::make_pair(std::make_pair(bx, by), std::vector<unsigned int>()));
+      if(found.second) {
+	const int radius = width >> 1;
+	calculate_summed_area_table((int)(bx * block_size) - radius, (int)(by * block_size) - radius,
+				    block_size + 2 * radius, block_size + 2 * radius,
+				    found.first->second);
+      }
+      return found.first->second;
+    }
+
+    /**
+     * Count the votes in the window around x, y, where (x, y) is relative
+     * to the origin of a summed-area table.
+     */
+    inline unsigned int count_votes(std::vector<unsigned int> const& table, unsigned int stride,
+				    unsigned int x, unsigned int y) const {
+      const unsigned int radius = width >> 1;
+      const unsigned int x0 = x - radius, x1 = x + radius, y0 = y - radius, y1 = y + radius;
+      return table[y1 * stride + x1] - table[y1 * stride + x0] - table[y0 * stride + x1] + table[y0 * stride + x0];
+    }
+
+    /**
+     * Check if the window around a coordinate is within the image.
+     */
+    inline bool has_full_window(int x, int y) const {
+      const int radius = width >> 1;
+      return (x > radius && x < (int)img->get_width() - radius) &&
+	(y > radius && y < (int)img->get_height() - radius);
+    }
+
   public:
 
 
@@ -91,6 +187,7 @@ namespace degate {
 	  iter != bg_areas.end(); ++iter) {
 	hist_bg.add_area(img, *iter);
       }
+      clear_cache();
     }
 
 
@@ -101,32 +198,75 @@ namespace degate {
 	  iter != fg_areas.end(); ++iter) {
 	hist_fg.add_area(img, *iter);
       }
+      clear_cache();
     }
 
-
     /**
-     * @todo Cache data
+     * Drop the cached decisions. Call this method, if the image was modified.
      */
+    void clear_cache() {
+      decisions.clear();
+      block_cache.clear();
+    }
+
+
     int recognize(coord_type & v) {
       unsigned int sum = 0;
 
-      int radius = width >> 1;
       int x = v.first, y = v.second;
 
-      if((x > radius && x < (int)img->get_width() - radius) &&
-	 (y > radius && y < (int)img->get_height() - radius)) {
-
-	for(int _y = -radius; _y < radius; _y++)
-	  for(int _x = -radius; _x < radius; _x++) {
-	    rgba_pixel_t p = img->get_pixel(x + _x, y + _y);
-	    if(hist_fg.get_for_rgb(p) > hist_bg.get_for_rgb(p)) sum++;
-	  }
+      if(has_full_window(x, y)) {
+	const unsigned int radius = width >> 1;
+	const unsigned int bx = x / block_size, by = y / block_size;
+	sum = count_votes(get_block_table(bx, by), block_size + 2 * radius + 1,
+			  x - bx * block_size + radius, y - by * block_size + radius);
       }
 
-
       if(sum >= threshold) return 1;
       else return -1;
     }
+
+    /**
+     * Classify all pixels of the image. This is the same as calling recognize()
+     * for each pixel. The image is processed block by block and the
+     * summed-area tables are not cached.
+     * @param dst The image for the results. Foreground pixels are set to
+     *   \p fg_value, background pixels to \p bg_value. The image must have
+     *   the size of the classified image.
+     */
+    template<class DstImageType>
+    void classify(std::tr1::shared_ptr<DstImageType> dst,
+		  typename DstImageType::pixel_type fg_value = 1,
+		  typename DstImageType::pixel_type bg_value = 0) {
+
+      if(dst == NULL) throw InvalidPointerException("Invalid image passed to classify().");
+      if(dst->get_width() != img->get_width() || dst->get_height() != img->get_height())
+	throw DegateRuntimeException("The image for the classification result has the wrong size.");
+
+      const unsigned int radius = width >> 1;
+      const unsigned int stride = block_size + 2 * radius + 1;
+      const bool empty_window_is_foreground = threshold == 0;
+      std::vector<unsigned int> table;
+
+      for(unsigned int by = 0; by * block_size < img->get_height(); by++)
+	for(unsigned int bx = 0; bx * block_size < img->get_width(); bx++) {
+
+	  const unsigned int min_x = bx * block_size, min_y = by * block_size;
+	  const unsigned int max_x = std::min(min_x + block_size, img->get_width());
+	  const unsigned int max_y = std::min(min_y + block_size, img->get_height());
+
+	  calculate_summed_area_table((int)min_x - (int)radius, (int)min_y - (int)radius,
+				      block_size + 2 * radius, block_size + 2 * radius, table);
+
+	  for(unsigned int y = min_y; y < max_y; y++)
+	    for(unsigned int x = min_x; x < max_x; x++) {
+	      bool fg = has_full_window(x, y) ?
+		count_votes(table, stride, x - min_x + radius, y - min_y + radius) >= threshold :
+		empty_window_is_foreground;
+	      dst->set_pixel(x, y, fg ? fg_value : bg_value);
+	    }
+	}
+    }
   };
 
 
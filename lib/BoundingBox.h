@@ -39,7 +39,9 @@ class BoundingBox {
   BoundingBox(int width, int height);
   BoundingBox(const BoundingBox&);
 
-  virtual ~BoundingBox();
+  // Not virtual: a bounding box is part of every placed object and
+  // a vtable pointer would add to its size.
+  ~BoundingBox();
 
   BoundingBox const& get_bounding_box() const;
   bool in_shape(int x, int y, int max_distance = 0) const;
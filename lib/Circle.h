@@ -24,6 +24,7 @@
 
 #include "Shape.h"
 #include "BoundingBox.h"
+#include "Geometry.h"
 
 namespace degate {
 
@@ -56,6 +57,11 @@ namespace degate {
     virtual int get_y() const;
     virtual unsigned int get_diameter() const;
 
+    /**
+     * Get the circle as a record for the geometry kernel.
+     */
+    GeoCircle get_geo_circle() const { return make_geo_circle(x, y, diameter); }
+
     virtual void set_x(int x);
     virtual void set_y(int y);
     virtual void set_diameter(unsigned int diameter);
@@ -23,6 +23,7 @@
 #include <FileSystem.h>
 
 #include <boost/lexical_cast.hpp>
+#include <string.h>
 
 using namespace degate;
 
@@ -46,6 +47,40 @@ size_t Configuration::get_max_tile_cache_size() const {
   return boost::lexical_cast<size_t>(cs);
 }
 
+bool Configuration::use_packed_tile_store() const {
+  char * ts = getenv("DEGATE_TILE_STORE");
+  return ts == NULL || strcmp(ts, "files") != 0;
+}
+
+bool Configuration::use_tile_compression() const {
+  char * tc = getenv("DEGATE_TILE_COMPRESSION");
+  return tc == NULL || strcmp(tc, "0") != 0;
+}
+
+size_t Configuration::get_temp_image_spill_threshold() const {
+  char * th = getenv("DEGATE_TEMP_IMAGE_THRESHOLD");
+  if(th == NULL) return 64;
+  return boost::lexical_cast<size_t>(th);
+}
+
+size_t Configuration::get_temp_image_pool_size() const {
+  char * ps = getenv("DEGATE_TEMP_IMAGE_POOL_SIZE");
+  if(ps == NULL) return 128;
+  return boost::lexical_cast<size_t>(ps);
+}
+
+unsigned int Configuration::get_autosave_history_size() const {
+  char * hs = getenv("DEGATE_AUTOSAVE_HISTORY");
+  if(hs == NULL) return 5;
+  return boost::lexical_cast<unsigned int>(hs);
+}
+
+double Configuration::get_lod_scaling_threshold() const {
+  char * lod = getenv("DEGATE_LOD_SCALING");
+  if(lod == NULL) return 8;
+  return boost::lexical_cast<double>(lod);
+}
+
 std::string Configuration::get_servers_uri_pattern() const {
   char * uri_pattern = getenv("DEGATE_SERVER_URI_PATTERN");
   if(uri_pattern == NULL) return "http://localhost/cgi-bin/test.pl?channel=%1%";
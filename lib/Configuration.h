@@ -62,6 +62,52 @@ namespace degate {
      */
     size_t get_max_tile_cache_size() const;
 
+    /**
+     * Check if new tile based images should store their tiles in a single
+     * pack file. Existing images keep their layout.
+     * @return Returns false, if the environment variable DEGATE_TILE_STORE
+     *   is set to "files". Else true is returned.
+     */
+    bool use_packed_tile_store() const;
+
+    /**
+     * Check if imported background images should be compressed.
+     * @return Returns false, if the environment variable DEGATE_TILE_COMPRESSION
+     *   is set to "0". Else true is returned.
+     */
+    bool use_tile_compression() const;
+
+    /**
+     * Get the size limit for temporary images, that are kept in memory, in MB.
+     * Larger temporary images are stored in temp files.
+     * @return If the environment variable DEGATE_TEMP_IMAGE_THRESHOLD is set,
+     *   its value. Else the default limit is returned. That is 64 MB.
+     */
+    size_t get_temp_image_spill_threshold() const;
+
+    /**
+     * Get the amount of memory for temporary images in MB, that is kept
+     * for reuse after the images were destroyed.
+     * @return If the environment variable DEGATE_TEMP_IMAGE_POOL_SIZE is set,
+     *   its value. Else the default size is returned. That is 128 MB.
+     */
+    size_t get_temp_image_pool_size() const;
+
+    /**
+     * Get the number of autosaved versions, that are kept in a project directory.
+     * @return If the environment variable DEGATE_AUTOSAVE_HISTORY is set,
+     *   its value. Else the default number is returned. That is 5.
+     */
+    unsigned int get_autosave_history_size() const;
+
+    /**
+     * Get the scaling, above which logic model objects are rendered as
+     * aggregates instead of individual objects.
+     * @return If the environment variable DEGATE_LOD_SCALING is set,
+     *   its value. Else the default scaling is returned. That is 8.
+     */
+    double get_lod_scaling_threshold() const;
+
 
     /**
      * Get the URI address pattern for the collaboration server.
@@ -43,12 +43,14 @@ void ConnectedLogicModelObject::set_net(Net_shptr net) {
   }
   this->net = net;
   this->net->add_object(get_object_id());
+  notify_appearance_change();
 }
 
 void ConnectedLogicModelObject::remove_net() {
   if(net != NULL) {
     net->remove_object(get_object_id());
     net.reset();
+    notify_appearance_change();
   }
 }
 
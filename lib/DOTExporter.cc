@@ -62,49 +62,72 @@ void DOTExporter::dump_to_file(std::string const& filename) const
 
     dot_file.open(filename.c_str(), std::ios::trunc | std:: ios::out);
 
-    // write header
+    write_header(dot_file);
 
+    // nodes
     for(std::list<std::string>::const_iterator
-        iter = header_lines.begin()
-        ; iter != header_lines.end()
+        iter = node_lines.begin()
+        ; iter != node_lines.end()
         ; ++iter
     ) {
-        dot_file << *iter << std::endl;
+        dot_file << *iter << '\n';
     }
 
-    dot_file << "digraph LogicModel {" << std::endl;
-
+    // edges
     for(std::list<std::string>::const_iterator
-        iter = graph_setting_lines.begin()
-        ; iter != graph_setting_lines.end()
+        iter = edge_lines.begin()
+        ; iter != edge_lines.end()
         ; ++iter
     ) {
-        dot_file << "\t" << *iter << std::endl;
+        dot_file << *iter << '\n';
     }
 
+    write_footer(dot_file);
 
-    // nodes
+    dot_file.close();
+}
+
+void DOTExporter::write_header(std::ostream & os) const
+{
     for(std::list<std::string>::const_iterator
-        iter = node_lines.begin()
-        ; iter != node_lines.end()
+        iter = header_lines.begin()
+        ; iter != header_lines.end()
         ; ++iter
     ) {
-        dot_file << *iter << std::endl;
+        os << *iter << '\n';
     }
 
-    // edges
+    os << "digraph LogicModel {" << '\n';
+
     for(std::list<std::string>::const_iterator
-        iter = edge_lines.begin()
-        ; iter != edge_lines.end()
+        iter = graph_setting_lines.begin()
+        ; iter != graph_setting_lines.end()
         ; ++iter
     ) {
-        dot_file << *iter << std::endl;
+        os << "\t" << *iter << '\n';
     }
+}
 
+void DOTExporter::write_footer(std::ostream & os) const
+{
+    os << "}" << std::endl;
+}
 
-    dot_file << "}" << std::endl;
+void DOTExporter::write_node(
+    std::ostream & os,
+    std::string const& node_id,
+    std::string const& node_params
+) {
+    os << node_id << node_params << '\n';
+}
 
-    dot_file.close();
+void DOTExporter::write_edge(
+    std::ostream & os,
+    std::string const& from_node_id,
+    std::string const& to_node_id,
+    std::string const& edge_params
+) {
+    os << from_node_id << " -> " << to_node_id << edge_params << '\n';
 }
 
 void DOTExporter::clear()
@@ -91,6 +91,34 @@ namespace degate {
 
     void dump_to_file(std::string const& filename) const;
 
+    /**
+     * Write the header lines, the opening of the graph and the graph settings
+     * into a stream. Exporters, that stream nodes and edges instead of adding
+     * them, call this method first, then write_node() and write_edge() and
+     * finally write_footer().
+     */
+    void write_header(std::ostream & os) const;
+
+    /**
+     * Write the closing of the graph into a stream.
+     */
+    void write_footer(std::ostream & os) const;
+
+    /**
+     * Write a node into a stream.
+     */
+    static void write_node(std::ostream & os,
+			   std::string const& node_id,
+			   std::string const& node_params);
+
+    /**
+     * Write an edge into a stream.
+     */
+    static void write_edge(std::ostream & os,
+			   std::string const& from_node_id,
+			   std::string const& to_node_id,
+			   std::string const& edge_params);
+
     /**
      * Clear any internally stored data.
      */
@@ -66,6 +66,24 @@ void degate::write_string_to_file(std::string const& path,
   file.close();
 }
 
+void degate::write_string_to_file_atomically(std::string const& path,
+					     std::string const& content) {
+
+  std::string tmp_path = path + ".tmp";
+
+  std::ofstream file;
+  file.open(tmp_path.c_str(), std::ios::trunc | std::ios::out | std::ios::binary);
+  file << content;
+  file.close();
+
+  if(file.fail()) {
+    unlink(tmp_path.c_str());
+    throw FileSystemException("Can't write file " + tmp_path + ".");
+  }
+
+  rename_file(tmp_path, path);
+}
+
 int degate::execute_command(std::string const& command, std::list<std::string> const& params) {
 
   pid_t pid = fork();
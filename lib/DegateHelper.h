@@ -62,6 +62,18 @@ namespace degate {
   void write_string_to_file(std::string const& path,
 			    std::string const& content);
 
+  /**
+   * Write a string to a file. The content is written to a temp file
+   * first, which then replaces the file. Readers see either the old or
+   * the new content, but never a partially written file.
+   * @param path Path to file.
+   * @param content The file content.
+   * @exception FileSystemException This exception is thrown, if the file
+   *   cannot be written.
+   */
+  void write_string_to_file_atomically(std::string const& path,
+				       std::string const& content);
+
 
   /**
    * Execute a command.
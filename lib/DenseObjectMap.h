@@ -0,0 +1,251 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __DENSEOBJECTMAP_H__
+#define __DENSEOBJECTMAP_H__
+
+#include "globals.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace degate {
+
+  /**
+   * A hash map from object IDs to values, that is used as object
+   * storage in the LogicModel and in Layer.
+   *
+   * Entries are stored densely in a vector, so that iterating over all
+   * entries is a linear walk over memory. An open-addressing table
+   * with linear probing maps object IDs to positions in the vector.
+   * Lookups, insertions and removals are O(1) on average.
+   *
+   * The interface mimics the subset of std::map, that was used for
+   * the logic model collections: iterators dereference to a pair of
+   * object ID and value.
+   *
+   * There are two important differences to std::map:
+   * - Iteration order is not sorted by object ID. If you need a
+   *   stable order, e.g. for exporters, use get_ordered_keys().
+   * - Removing an entry moves the last entry into the freed position and
+   *   inserting may reallocate. Therefore insert() and erase() invalidate
+   *   iterators. erase(iterator) returns an iterator to the entry, that
+   *   took the place of the removed one.
+   */
+
+  template<typename ValueType>
+  class DenseObjectMap {
+
+  public:
+
+    typedef object_id_t key_type;
+    typedef ValueType mapped_type;
+    typedef std::pair<object_id_t, ValueType> value_type;
+    typedef std::vector<value_type> storage_type;
+    typedef typename storage_type::iterator iterator;
+    typedef typename storage_type::const_iterator const_iterator;
+    typedef typename storage_type::size_type size_type;
+
+  private:
+
+    // 0 marks an empty slot, otherwise the slot stores position + 1.
+    // 32 bit positions halve the size of the index. A map can hold
+    // 2^32 - 1 entries, which exceeds the size of any logic model.
+    typedef std::vector<uint32_t> index_type;
+
+    storage_type entries;
+    index_type index;
+    unsigned int index_bits;
+
+    const static unsigned int min_index_bits = 4;
+
+    size_type home_slot(object_id_t key) const {
+      // Fibonacci hashing. Object IDs are mostly sequential, this spreads them.
+      return (size_type)((key * 0x9E3779B97F4A7C15ULL) >> (64 - index_bits));
+    }
+
+    size_type mask() const {
+      return index.size() - 1;
+    }
+
+    /**
+     * Find the slot for a key. Returns the slot that holds the key or
+     * the empty slot, where the key would be inserted.
+     */
+    size_type find_slot(object_id_t key) const {
+      size_type slot = home_slot(key);
+      while(index[slot] != 0 && entries[index[slot] - 1].first != key)
+	slot = (slot + 1) & mask();
+      return slot;
+    }
+
+    void rehash(unsigned int new_bits) {
+      index_bits = new_bits;
+      index.assign(size_type(1) << index_bits, 0);
+      for(size_type pos = 0; pos < entries.size(); pos++)
+	index[find_slot(entries[pos].first)] = (uint32_t)(pos + 1);
+    }
+
+    void grow_if_needed() {
+      // keep the load factor at or below 1/2
+      if(2 * (entries.size() + 1) > index.size())
+	rehash(index_bits + 1);
+    }
+
+    /**
+     * Clear a slot and shift following entries of the probe sequence
+     * backwards, so that lookups do not need tombstones.
+     */
+    void clear_slot(size_type hole) {
+      size_type slot = hole;
+      for(;;) {
+	slot = (slot + 1) & mask();
+	if(index[slot] == 0) break;
+	size_type home = home_slot(entries[index[slot] - 1].first);
+
+	// Leave the entry in place, if its home is cyclically in (hole, slot].
+	bool stays = hole <= slot ?
+	  (hole < home && home <= slot) :
+	  (hole < home || home <= slot);
+
+	if(!stays) {
+	  index[hole] = index[slot];
+	  hole = slot;
+	}
+      }
+      index[hole] = 0;
+    }
+
+  public:
+
+    DenseObjectMap() : index_bits(min_index_bits) {
+      index.assign(size_type(1) << index_bits, 0);
+    }
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+    size_type size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    /**
+     * Reserve space for \p n entries to avoid rehashing during bulk inserts.
+     */
+    void reserve(size_type n) {
+      entries.reserve(n);
+      unsigned int bits = index_bits;
+      while((size_type(1) << bits) < 2 * n) bits++;
+      if(bits != index_bits) rehash(bits);
+    }
+
+    void clear() {
+      entries.clear();
+      index_bits = min_index_bits;
+      index.assign(size_type(1) << index_bits, 0);
+    }
+
+    iterator find(object_id_t key) {
+      size_type slot = find_slot(key);
+      return index[slot] == 0 ? entries.end() : entries.begin() + (index[slot] - 1);
+    }
+
+    const_iterator find(object_id_t key) const {
+      size_type slot = find_slot(key);
+      return index[slot] == 0 ? entries.end() : entries.begin() + (index[slot] - 1);
+    }
+
+    size_type count(object_id_t key) const {
+      return index[find_slot(key)] == 0 ? 0 : 1;
+    }
+
+    /**
+     * Insert an entry, if there is no entry with the same key.
+     * @return Returns an iterator to the entry with that key and a flag,
+     *   that indicates if the entry was inserted.
+     */
+    std::pair<iterator, bool> insert(value_type const& v) {
+      size_type slot = find_slot(v.first);
+      if(index[slot] != 0)
+	return std::make_pair(entries.begin() + (index[slot] - 1), false);
+
+      grow_if_needed();
+      slot = find_slot(v.first);
+      entries.push_back(v);
+      index[slot] = (uint32_t)entries.size();
+      return std::make_pair(entries.end() - 1, true);
+    }
+
+    ValueType & operator[](object_id_t key) {
+      return insert(value_type(key, ValueType())).first->second;
+    }
+
+    /**
+     * Remove an entry.
+     * @return Returns the number of removed entries.
+     */
+    size_type erase(object_id_t key) {
+      size_type slot = find_slot(key);
+      if(index[slot] == 0) return 0;
+
+      size_type pos = index[slot] - 1;
+      clear_slot(slot);
+
+      size_type last = entries.size() - 1;
+      if(pos != last) {
+	entries[pos] = entries[last];
+	index[find_slot(entries[pos].first)] = (uint32_t)(pos + 1);
+      }
+      entries.pop_back();
+      return 1;
+    }
+
+    /**
+     * Remove the entry an iterator points to.
+     * @return Returns an iterator to the entry, that was moved into the place
+     *   of the removed entry, or end().
+     */
+    iterator erase(iterator iter) {
+      size_type pos = iter - entries.begin();
+      erase(iter->first);
+      return entries.begin() + pos;
+    }
+
+    /**
+     * Get all keys in ascending order. Use this, if the iteration order
+     * must be deterministic, e.g. for exporting data.
+     */
+    std::vector<object_id_t> get_ordered_keys() const {
+      std::vector<object_id_t> keys;
+      keys.reserve(entries.size());
+      for(const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
+	keys.push_back(iter->first);
+      std::sort(keys.begin(), keys.end());
+      return keys;
+    }
+
+  };
+
+}
+
+#endif
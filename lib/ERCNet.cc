@@ -27,92 +27,66 @@ ERCNet::ERCNet() :
   RCBase("net", "Check for unusual net configs.", RC_ERROR) {
 }
 
-void ERCNet::run(LogicModel_shptr lmodel) {
-  clear_rc_violations();
-
-  if(lmodel == NULL) return;
-
-  // iterate over nets
-  for(LogicModel::net_collection::iterator net_iter = lmodel->nets_begin();
-      net_iter != lmodel->nets_end(); ++net_iter) {
-
-    check_net(lmodel, (*net_iter).second);
-  }
-
-}
-
-void ERCNet::check_net(LogicModel_shptr lmodel, Net_shptr net) {
+void ERCNet::check(NetlistGraph const& graph, NetlistGraph::index_t n,
+		   container_type & violations) const {
 
   unsigned int
     in_ports = 0,
     out_ports = 0,
     inout_ports = 0;
 
-  // iterate over all objects from a net
-  for(Net::connection_iterator c_iter = net->begin();
-      c_iter != net->end(); ++c_iter) {
-
-    object_id_t oid = *c_iter;
-
-    PlacedLogicModelObject_shptr plo = lmodel->get_object(oid);
-
-    if(GatePort_shptr gate_port = std::tr1::dynamic_pointer_cast<GatePort>(plo)) {
-
-      assert(gate_port->has_template_port() == true); // can't happen
-
-      if(gate_port->has_template_port()) {
-
-	GateTemplatePort_shptr tmpl_port = gate_port->get_template_port();
-	// Count in- and out-ports. Inout-ports must be counted first, because is_*port() will return true
-	// for inout-ports.
-	if(tmpl_port->is_inoutport()) inout_ports++;
-	if(tmpl_port->is_inport()) in_ports++;
-	else if(tmpl_port->is_outport()) out_ports++;
-	else {
-	  boost::format f("For the corresponding gate template port of %1% the port "
-			  "direction is undefined.");
-	  f % gate_port->get_descriptive_identifier();
-	  add_rc_violation(RCViolation_shptr(new RCViolation(gate_port, f.str(),
-							     "undef_port_dir")));
-
-	}
-
+  NetlistGraph::index_range net_ports = graph.get_net_ports(n);
+
+  // iterate over all gate ports from a net
+  for(NetlistGraph::index_t const * p = net_ports.first; p != net_ports.second; ++p) {
+
+    GatePort_shptr const& gate_port = graph.get_port(*p);
+    assert(gate_port->has_template_port() == true); // can't happen
+
+    if(gate_port->has_template_port()) {
+
+      // Count in- and out-ports. Inout-ports are counted as in-ports, too.
+      switch(graph.get_port_type(*p)) {
+      case GateTemplatePort::PORT_TYPE_INOUT:
+	inout_ports++;
+	in_ports++;
+	break;
+      case GateTemplatePort::PORT_TYPE_IN:
+	in_ports++;
+	break;
+      case GateTemplatePort::PORT_TYPE_OUT:
+	out_ports++;
+	break;
+      default:
+	violations.push_back(RCViolation_shptr
+			     (new RCViolation(gate_port,
+					      "For the corresponding gate template port of %1% the port "
+					      "direction is undefined.", 0,
+					      "undef_port_dir")));
       }
-
     }
   }
 
   if((in_ports > 0 && out_ports == 0) || (out_ports > 1)) {
 
-    for(Net::connection_iterator c_iter = net->begin();
-	c_iter != net->end(); ++c_iter) {
-
-      object_id_t oid = *c_iter;
-      PlacedLogicModelObject_shptr plo = lmodel->get_object(oid);
-      if(GatePort_shptr gate_port = std::tr1::dynamic_pointer_cast<GatePort>(plo)) {
-
-	GateTemplatePort_shptr tmpl_port = gate_port->get_template_port();
-	std::string error_msg;
-	std::string rc_class;
-
-	if(in_ports > 0 && out_ports == 0) {
-	  boost::format f("In-Port %1% is not feeded. It is only connected "
-			  "with %2% other in-ports.");
-	  f % gate_port->get_descriptive_identifier() % (in_ports - 1);
-	  error_msg = f.str();
-	  rc_class = "net.not_feeded";
-	  add_rc_violation(RCViolation_shptr(new RCViolation(gate_port, error_msg, rc_class)));
-	}
-	else if(out_ports > 1) {
-	  if(tmpl_port->is_outport()) {
-	    boost::format f("Out-Port %1% is connected with %2% other out-ports.");
-	    f % gate_port->get_descriptive_identifier() % (out_ports - 1);
-	    error_msg = f.str();
-	    rc_class = "net.outputs_connected";
-	    add_rc_violation(RCViolation_shptr(new RCViolation(gate_port, error_msg, rc_class)));
-	  }
-	}
+    for(NetlistGraph::index_t const * p = net_ports.first; p != net_ports.second; ++p) {
 
+      GatePort_shptr const& gate_port = graph.get_port(*p);
+
+      if(in_ports > 0 && out_ports == 0) {
+	violations.push_back(RCViolation_shptr
+			     (new RCViolation(gate_port,
+					      "In-Port %1% is not feeded. It is only connected "
+					      "with %2% other in-ports.", in_ports - 1,
+					      "net.not_feeded")));
+      }
+      else if(out_ports > 1) {
+	if(graph.is_driver(*p))
+	  violations.push_back(RCViolation_shptr
+			       (new RCViolation(gate_port,
+						"Out-Port %1% is connected with %2% other out-ports.",
+						out_ports - 1,
+						"net.outputs_connected")));
       }
     }
   }
@@ -26,6 +26,7 @@
 #include <tr1/memory>
 #include <list>
 #include <LogicModel.h>
+#include <NetlistGraph.h>
 #include <RCBase.h>
 
 namespace degate {
@@ -54,11 +55,10 @@ namespace degate {
 
     ERCNet();
 
-    void run(LogicModel_shptr lmodel);
+    RC_SCOPE get_scope() const { return RC_SCOPE_NET; }
 
-  private:
-
-    void check_net(LogicModel_shptr lmodel, Net_shptr net);
+    void check(NetlistGraph const& graph, NetlistGraph::index_t n,
+	       container_type & violations) const;
 
   };
 
@@ -28,36 +28,14 @@ ERCOpenPorts::ERCOpenPorts() :
   RCBase("open_port", "Check for unconnected ports.", RC_WARNING) {
 }
 
-void ERCOpenPorts::run(LogicModel_shptr lmodel) {
-  clear_rc_violations();
-
-  if(lmodel == NULL) return;
-
-  // iterate over Gates
-  debug(TM, "\tRC: iterate over gates.");
-
-  for(LogicModel::gate_collection::iterator g_iter = lmodel->gates_begin();
-      g_iter != lmodel->gates_end(); ++g_iter) {
-
-    Gate_shptr gate = g_iter->second;
-    
-    for(Gate::port_const_iterator p_iter = gate->ports_begin();
-	p_iter != gate->ports_end(); ++p_iter) {
-      
-      GatePort_shptr port = *p_iter;
-      assert(port != NULL);
-      
-      Net_shptr net = port->get_net();
-      if(net == NULL || net->size() <= 1) {
-	
-	boost::format f("Port %1% is unconnected.");
-	f % port->get_descriptive_identifier();
-
-	debug(TM, "\tRC: found a vioation.");
-	add_rc_violation(RCViolation_shptr(new RCViolation(port, f.str(),
-							   get_rc_class_name())));
-      }
-    }
+void ERCOpenPorts::check(NetlistGraph const& graph, NetlistGraph::index_t g,
+			 container_type & violations) const {
+
+  for(NetlistGraph::index_t p = graph.get_first_port(g); p != graph.get_end_port(g); p++) {
+
+    if(!graph.is_connected(p))
+      violations.push_back(RCViolation_shptr(new RCViolation(graph.get_port(p),
+							     "Port %1% is unconnected.", 0,
+							     get_rc_class_name())));
   }
 }
-
@@ -38,7 +38,10 @@ namespace degate {
 
     ERCOpenPorts();
 
-    void run(LogicModel_shptr lmodel);
+    RC_SCOPE get_scope() const { return RC_SCOPE_GATE; }
+
+    void check(NetlistGraph const& graph, NetlistGraph::index_t g,
+	       container_type & violations) const;
 
   };
 
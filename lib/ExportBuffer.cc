@@ -0,0 +1,126 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <ExportBuffer.h>
+#include <ImageHelper.h>
+#include <DegateHelper.h>
+#include <FileSystem.h>
+
+#include <libxml++/libxml++.h>
+#include <boost/thread.hpp>
+#include <boost/foreach.hpp>
+
+#include <algorithm>
+
+using namespace degate;
+
+namespace {
+
+  struct ImageWriter {
+
+    ExportBuffer::image_job_list * jobs;
+    unsigned int first, step;
+    std::string * error;
+
+    void operator()() {
+      try {
+	for(unsigned int i = first; i < jobs->size(); i += step)
+	  ExportBuffer::write_image((*jobs)[i]);
+      }
+      catch(std::exception const& ex) {
+	*error = ex.what();
+      }
+    }
+  };
+}
+
+void ExportBuffer::add_file(std::string const& path, std::string const& content) {
+  File f;
+  f.path = path;
+  f.content = content;
+  files.push_back(f);
+}
+
+void ExportBuffer::add_document(std::string const& path, XMLDocument_shptr doc) {
+  if(doc == NULL) throw InvalidPointerException("Invalid document pointer.");
+  File f;
+  f.path = path;
+  f.document = doc;
+  files.push_back(f);
+}
+
+void ExportBuffer::serialize_documents() {
+  BOOST_FOREACH(File & f, files)
+    if(f.document != NULL) {
+      f.content = f.document->write_to_string_formatted("ISO-8859-1");
+      f.document.reset();
+    }
+}
+
+void ExportBuffer::add_image(ImageJob const& job) {
+  if(job.image == NULL) throw InvalidPointerException("Invalid image pointer.");
+  images.push_back(job);
+}
+
+void ExportBuffer::write_files() {
+  serialize_documents();
+  BOOST_FOREACH(File const& f, files)
+    write_string_to_file_atomically(f.path, f.content);
+}
+
+void ExportBuffer::write_images(unsigned int num_threads) {
+
+  if(num_threads == 0) num_threads = std::max(boost::thread::hardware_concurrency(), 1U);
+
+  std::vector<std::string> errors(num_threads);
+  boost::thread_group threads;
+
+  for(unsigned int t = 0; t < num_threads && t < images.size(); t++) {
+    ImageWriter w;
+    w.jobs = &images;
+    w.first = t;
+    w.step = num_threads;
+    w.error = &errors[t];
+    threads.create_thread(w);
+  }
+  threads.join_all();
+
+  BOOST_FOREACH(std::string const& e, errors)
+    if(!e.empty()) throw DegateRuntimeException(e);
+}
+
+void ExportBuffer::apply_image_states() const {
+  BOOST_FOREACH(ImageJob const& job, images)
+    if(job.written) job.gate_template->set_image_file(job.layer_type, job.file);
+}
+
+void ExportBuffer::write_image(ImageJob & job) {
+
+  std::string tmp_path = job.path + ".tmp";
+  save_image<GateTemplateImage>(tmp_path, job.image);
+  rename_file(tmp_path, job.path);
+
+  job.file.path = job.path;
+  if(!get_file_status(job.path, job.file.size, job.file.mtime))
+    throw DegateRuntimeException("Can't stat the written image " + job.path + ".");
+
+  job.written = true;
+}
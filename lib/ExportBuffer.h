@@ -0,0 +1,159 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __EXPORTBUFFER_H__
+#define __EXPORTBUFFER_H__
+
+#include <globals.h>
+#include <Layer.h>
+#include <GateTemplate.h>
+
+#include <string>
+#include <vector>
+#include <tr1/memory>
+
+namespace xmlpp {
+  class Document;
+}
+
+namespace degate {
+
+  typedef std::tr1::shared_ptr<xmlpp::Document> XMLDocument_shptr;
+
+  /**
+   * An ExportBuffer collects the output of exporters in memory instead of
+   * writing it to files.
+   *
+   * Exporting data requires access to the logic model, which is not
+   * thread-safe. Writing files does not. If an exporter has a buffer, it
+   * serializes its documents and copies the template images it would write
+   * into the buffer. The buffer is a consistent snapshot of the project,
+   * that can be written by a background thread, while the logic model is
+   * changed.
+   *
+   * Documents are kept as DOM trees, because the trees do not refer to the
+   * logic model. Serializing them is left to the thread, that writes the
+   * buffer.
+   *
+   * All files are written atomically via a temp file and a rename.
+   */
+
+  class ExportBuffer {
+
+  public:
+
+    /**
+     * A serialized document.
+     */
+    struct File {
+      std::string path;
+      std::string content;
+      XMLDocument_shptr document; // not serialized yet
+    };
+
+    /**
+     * A gate template image, that must be written.
+     */
+    struct ImageJob {
+      GateTemplate_shptr gate_template;
+      Layer::LAYER_TYPE layer_type;
+      std::string path;
+      GateTemplateImage_shptr image;
+      GateTemplate::ImageFile file;
+      bool written;
+    };
+
+    typedef std::vector<File> file_list;
+    typedef std::vector<ImageJob> image_job_list;
+
+  private:
+
+    file_list files;
+    image_job_list images;
+
+  public:
+
+    /**
+     * Add a serialized document.
+     */
+    void add_file(std::string const& path, std::string const& content);
+
+    /**
+     * Add a document, that is serialized later. The document must not be
+     * changed afterwards.
+     */
+    void add_document(std::string const& path, XMLDocument_shptr doc);
+
+    /**
+     * Serialize the documents added with add_document() and release
+     * them. This method does not access the logic model and can be called
+     * from any thread.
+     */
+    void serialize_documents();
+
+    /**
+     * Add a template image. The image must not be changed afterwards,
+     * therefore exporters add copies.
+     */
+    void add_image(ImageJob const& job);
+
+    file_list const& get_files() const { return files; }
+
+    image_job_list & get_images() { return images; }
+
+    /**
+     * Serialize and write all documents.
+     * @exception FileSystemException This exception is thrown, if a file
+     *   cannot be written.
+     */
+    void write_files();
+
+    /**
+     * Write all template images. This method does not access the templates
+     * and can be called from any thread.
+     * @param num_threads The number of threads. Use 0 for the number of
+     *   available processors.
+     * @exception DegateRuntimeException This exception is thrown, if an image
+     *   cannot be written.
+     */
+    void write_images(unsigned int num_threads = 0);
+
+    /**
+     * Record the file state of written images in their templates, so that
+     * the next export can skip them. Call it from the thread, that owns the
+     * logic model.
+     */
+    void apply_image_states() const;
+
+    /**
+     * Write a single template image via a temp file and record the
+     * file state in the job.
+     * @exception DegateRuntimeException This exception is thrown, if the
+     *   image cannot be written.
+     */
+    static void write_image(ImageJob & job);
+  };
+
+  typedef std::tr1::shared_ptr<ExportBuffer> ExportBuffer_shptr;
+
+}
+
+#endif
@@ -19,17 +19,170 @@
 
 */
 
+
 #include <ExternalMatching.h>
 #include <BoundingBox.h>
 #include <ImageHelper.h>
 #include <DegateHelper.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <iostream>
 #include <fstream>
 
+#include <boost/thread.hpp>
+
 using namespace degate;
 
-ExternalMatching::ExternalMatching() {}
+namespace {
+
+  /**
+   * Parse a result line without copying tokens.
+   * @return Returns false, if the line is neither empty nor a comment
+   *   nor a valid object description.
+   */
+  bool parse_result_line(char const * line, PlacedLogicModelObject_shptr & plo) {
+
+    plo.reset();
+
+    char const * p = line;
+    while(isspace(*p)) p++;
+    if(*p == 0 || *p == '#') return true;
+
+    char const * word = p;
+    while(*p != 0 && !isspace(*p)) p++;
+    size_t word_len = p - word;
+
+    long v[5];
+    unsigned int num_values = 0;
+
+    bool is_wire = word_len == 4 && strncmp(word, "wire", 4) == 0;
+    bool is_via = word_len == 3 && strncmp(word, "via", 3) == 0;
+    if(!is_wire && !is_via) return false;
+
+    unsigned int expected = is_wire ? 5 : 3;
+    while(num_values < expected) {
+      char * end;
+      v[num_values] = strtol(p, &end, 10);
+      if(end == p) return false;
+      p = end;
+      num_values++;
+    }
+
+    if(v[expected - 1] < 0) return false; // the diameter
+
+    if(is_wire) {
+      plo = Wire_shptr(new Wire(v[0], v[1], v[2], v[3], v[4]));
+      return true;
+    }
+
+    while(isspace(*p)) p++;
+    if(*p == 0) return false;
+
+    Via::DIRECTION dir = strncmp(p, "up", 2) == 0 && (p[2] == 0 || isspace(p[2])) ?
+      Via::DIRECTION_UP : Via::DIRECTION_DOWN;
+
+    plo = Via_shptr(new Via(v[0], v[1], v[2], dir));
+    return true;
+  }
+
+
+  /**
+   * A part of the region, that is analyzed by a program instance.
+   */
+  struct ExternalTile {
+    BoundingBox core;      // the part of the region, that this tile owns
+    BoundingBox extended;  // the core including the overlap
+    std::vector<PlacedLogicModelObject_shptr> objects;
+    int exit_code;
+    std::string error;
+  };
+
+
+  /**
+   * Check if the center of an object is within a tile core. Centers outside of
+   * the region are moved onto the border of the region, so that each object
+   * belongs to exactly one tile.
+   */
+  bool is_owned_by(ExternalTile const& tile, BoundingBox const& region,
+		   PlacedLogicModelObject_shptr plo) {
+
+    BoundingBox const& bbox = plo->get_bounding_box();
+    int cx = (bbox.get_min_x() + bbox.get_max_x()) / 2;
+    int cy = (bbox.get_min_y() + bbox.get_max_y()) / 2;
+
+    cx = std::max(region.get_min_x(), std::min(region.get_max_x() - 1, cx));
+    cy = std::max(region.get_min_y(), std::min(region.get_max_y() - 1, cy));
+
+    return
+      tile.core.get_min_x() <= cx && cx < tile.core.get_max_x() &&
+      tile.core.get_min_y() <= cy && cy < tile.core.get_max_y();
+  }
+
+
+  /**
+   * Runs the program for a part of the tiles in a worker thread. Worker i handles
+   * the tiles i, i + step, i + 2 * step, ...
+   */
+  struct ExternalWorker {
+    std::vector<ExternalTile> * tiles;
+    std::string const * cmd;
+    std::string const * buffer_file;
+    BoundingBox const * region;
+    unsigned int first, step;
+
+    void run_tile(ExternalTile & tile) {
+
+      boost::format f("%1% --protocol 2 --buffer %2% "
+		      "--start-x %3% --start-y %4% --width %5% --height %6%");
+      f % *cmd
+	% *buffer_file
+	% tile.extended.get_min_x()
+	% tile.extended.get_min_y()
+	% tile.extended.get_width()
+	% tile.extended.get_height();
+
+      FILE * pipe = popen(f.str().c_str(), "r");
+      if(pipe == NULL) {
+	tile.exit_code = -1;
+	return;
+      }
+
+      char * line = NULL;
+      size_t line_size = 0;
+      PlacedLogicModelObject_shptr plo;
+
+      while(getline(&line, &line_size, pipe) != -1) {
+	if(!tile.error.empty()) continue; // drain the pipe
+	if(!parse_result_line(line, plo))
+	  tile.error = std::string("Can't parse line: ") + line;
+	else if(plo != NULL && is_owned_by(tile, *region, plo))
+	  tile.objects.push_back(plo);
+      }
+
+      free(line);
+      tile.exit_code = pclose(pipe);
+    }
+
+    void operator()() {
+      for(size_t t = first; t < tiles->size(); t += step) run_tile((*tiles)[t]);
+    }
+  };
+
+}
+
+
+ExternalMatching::ExternalMatching() :
+  exit_code(0),
+  protocol_version(PROTOCOL_V1),
+  num_workers(0),
+  tile_size(1024),
+  tile_overlap(32),
+  greyscale(false) {
+}
 
 
 void ExternalMatching::init(BoundingBox const& bounding_box, Project_shptr project) {
@@ -51,6 +204,8 @@ void ExternalMatching::init(BoundingBox const& bounding_box, Project_shptr proje
 
   img = sm->get_image(1).second;
   assert(img != NULL);
+
+  begin_transaction(lmodel);
 }
 
 
@@ -62,7 +217,18 @@ std::string ExternalMatching::get_command() const {
   return cmd;
 }
 
+void ExternalMatching::set_tile_size(unsigned int size, unsigned int overlap) {
+  if(size == 0) throw DegateLogicException("The tile size must not be zero.");
+  tile_size = size;
+  tile_overlap = overlap;
+}
+
 void ExternalMatching::run() {
+  if(protocol_version == PROTOCOL_V2) run_v2();
+  else run_v1();
+}
+
+void ExternalMatching::run_v1() {
 
   // create a temp dir
   std::string dir = create_temp_directory();
@@ -95,12 +261,147 @@ void ExternalMatching::run() {
   else {
     BOOST_FOREACH(PlacedLogicModelObject_shptr plo,
 		  parse_file(results_file)) {
-      lmodel->add_object(layer, plo);
+      get_transaction()->add_object(layer->get_layer_pos(), plo);
     }
   }
 
   // cleanup
   remove_directory(dir);
+
+  end_transaction(lmodel);
+}
+
+void ExternalMatching::run_v2() {
+
+  if(bounding_box.get_width() == 0 || bounding_box.get_height() == 0)
+    throw DegateRuntimeException("The region for the external matching is empty.");
+
+  std::string dir = create_temp_directory();
+  assert(is_directory(dir));
+
+  std::string buffer_file = dir;
+  buffer_file.append("/region.raw");
+
+  // split the region into tiles
+  std::vector<ExternalTile> tiles;
+  for(int y = bounding_box.get_min_y(); y < bounding_box.get_max_y(); y += tile_size)
+    for(int x = bounding_box.get_min_x(); x < bounding_box.get_max_x(); x += tile_size) {
+      ExternalTile tile;
+      tile.core = BoundingBox(x, std::min<int>(x + tile_size, bounding_box.get_max_x()),
+			      y, std::min<int>(y + tile_size, bounding_box.get_max_y()));
+      tile.extended = BoundingBox(std::max<int>(x - tile_overlap, bounding_box.get_min_x()),
+				  std::min<int>(tile.core.get_max_x() + tile_overlap, bounding_box.get_max_x()),
+				  std::max<int>(y - tile_overlap, bounding_box.get_min_y()),
+				  std::min<int>(tile.core.get_max_y() + tile_overlap, bounding_box.get_max_y()));
+      tile.exit_code = 0;
+      tiles.push_back(tile);
+    }
+
+  try {
+    write_region_buffer(buffer_file);
+  }
+  catch(...) {
+    remove_directory(dir);
+    throw;
+  }
+
+  unsigned int threads_to_use = num_workers;
+  if(threads_to_use == 0) threads_to_use = std::max(boost::thread::hardware_concurrency(), 1U);
+  threads_to_use = std::min<unsigned int>(threads_to_use, tiles.size());
+
+  debug(TM, "start external command for %d tiles with %d instances: %s",
+	(int)tiles.size(), threads_to_use, cmd.c_str());
+
+  boost::thread_group threads;
+  for(unsigned int t = 0; t < threads_to_use; t++) {
+    ExternalWorker w;
+    w.tiles = &tiles;
+    w.cmd = &cmd;
+    w.buffer_file = &buffer_file;
+    w.region = &bounding_box;
+    w.first = t;
+    w.step = threads_to_use;
+    threads.create_thread(w);
+  }
+  threads.join_all();
+
+  remove_directory(dir);
+
+  exit_code = 0;
+  BOOST_FOREACH(ExternalTile const& tile, tiles) {
+    if(!tile.error.empty()) throw DegateRuntimeException(tile.error);
+    if(exit_code == 0) exit_code = tile.exit_code;
+  }
+
+  // Insert the objects in tile order, so that the result does not
+  // depend on the scheduling of the program instances.
+  BOOST_FOREACH(ExternalTile const& tile, tiles)
+    BOOST_FOREACH(PlacedLogicModelObject_shptr plo, tile.objects)
+      get_transaction()->add_object(layer->get_layer_pos(), plo);
+
+  end_transaction(lmodel);
+}
+
+void ExternalMatching::write_region_buffer(std::string const& path) const {
+
+  if(img == NULL) throw InvalidPointerException("There is no image for the external matching.");
+
+  BufferHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "DGREGION", sizeof(header.magic));
+  header.header_size = 64;
+  header.width = bounding_box.get_width();
+  header.height = bounding_box.get_height();
+  header.channels = greyscale ? 1 : 4;
+  header.row_stride = header.width * header.channels;
+  header.origin_x = bounding_box.get_min_x();
+  header.origin_y = bounding_box.get_min_y();
+
+  size_t size = header.header_size + (size_t)header.row_stride * header.height;
+
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if(fd == -1) throw FileSystemException(std::string("Can't create file ") + path + ".");
+
+  if(ftruncate(fd, size) == -1) {
+    close(fd);
+    throw FileSystemException(std::string("Can't resize file ") + path + ".");
+  }
+
+  char * mem = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(mem == MAP_FAILED) throw FileSystemException(std::string("Can't map file ") + path + ".");
+
+  memcpy(mem, &header, sizeof(header));
+  char * pixels = mem + header.header_size;
+
+  // Copy the image tile by tile. Pixels outside of the image stay zero.
+  const int ts = img->get_tile_size();
+  const int max_x = std::min<int>(bounding_box.get_max_x(), img->get_width());
+  const int max_y = std::min<int>(bounding_box.get_max_y(), img->get_height());
+  std::vector<rgba_pixel_t> tile(ts * ts);
+
+  for(int ty = bounding_box.get_min_y() - bounding_box.get_min_y() % ts; ty < max_y; ty += ts) {
+    for(int tx = bounding_box.get_min_x() - bounding_box.get_min_x() % ts; tx < max_x; tx += ts) {
+
+      img->raw_copy(&tile[0], tx, ty);
+
+      const int x0 = std::max(tx, bounding_box.get_min_x()), x1 = std::min(tx + ts, max_x);
+      const int y0 = std::max(ty, bounding_box.get_min_y()), y1 = std::min(ty + ts, max_y);
+
+      for(int y = y0; y < y1; y++) {
+	rgba_pixel_t const * src = &tile[(y - ty) * ts + (x0 - tx)];
+	char * dst = pixels + (size_t)(y - header.origin_y) * header.row_stride
+	  + (size_t)(x0 - header.origin_x) * header.channels;
+
+	if(greyscale)
+	  for(int x = x0; x < x1; x++, src++) *dst++ = RGBA_TO_GS_BY_PTR(src);
+	else
+	  memcpy(dst, src, (x1 - x0) * sizeof(rgba_pixel_t));
+      }
+    }
+  }
+
+  munmap(mem, size);
 }
 
 int ExternalMatching::get_exit_code() const {
@@ -130,40 +431,12 @@ std::list<PlacedLogicModelObject_shptr> ExternalMatching::parse_file(std::string
 
 PlacedLogicModelObject_shptr ExternalMatching::parse_line(std::string const& line) const {
 
-  std::vector<std::string> tokens = tokenize(line);
-
   PlacedLogicModelObject_shptr plo;
 
-  if(tokens.size() == 0) return plo;
-  else if(tokens[0].at(0) == '#') return plo;
-  else if(tokens[0] == "wire" and tokens.size() >= 6) {
-
-    int
-      x1 = boost::lexical_cast<int>(tokens[1]),
-      y1 = boost::lexical_cast<int>(tokens[2]),
-      x2 = boost::lexical_cast<int>(tokens[3]),
-      y2 = boost::lexical_cast<int>(tokens[4]),
-      diameter = boost::lexical_cast<unsigned int>(tokens[5]);
-
-    return Wire_shptr(new Wire(x1, y1, x2, y2, diameter));
-  }
-  else if(tokens[0] == "via" and tokens.size() >= 6) {
-
-    int
-      x = boost::lexical_cast<int>(tokens[1]),
-      y = boost::lexical_cast<int>(tokens[2]),
-      diameter = boost::lexical_cast<unsigned int>(tokens[3]);
-
-    Via::DIRECTION dir = tokens[4] == "up" ?
-      Via::DIRECTION_UP : Via::DIRECTION_DOWN;
-
-    return Via_shptr(new Via(x, y, diameter, dir));
-  }
-
-  else {
+  if(!parse_result_line(line.c_str(), plo)) {
     std::string err("Can't parse line: ");
     throw DegateRuntimeException(err + line);
   }
-}
-
 
+  return plo;
+}
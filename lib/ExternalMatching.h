@@ -52,9 +52,52 @@ namespace degate {
    * The direction is either "up" or "down"
    *
    * Strings are case sensitive.
+   *
+   * There are two versions of the protocol between degate and the program:
+   *
+   * Version 1 stores the region as TIFF image and runs the program once:
+   *
+   *   cmd --image <file> --results <file> --start-x <x> --start-y <y> --width <w> --height <h>
+   *
+   * Version 2 stores the region as raw pixel buffer in a file, that
+   * programs should memory map. The file starts with a BufferHeader. The
+   * pixels follow at offset header_size, row by row. A pixel is either a
+   * greyscale byte or four bytes in the order R, G, B, A. The region is split
+   * into tiles, that overlap each other. For each tile a program instance is
+   * started, several instances run concurrently:
+   *
+   *   cmd --protocol 2 --buffer <file> --start-x <x> --start-y <y> --width <w> --height <h>
+   *
+   * The parameters describe the tile in image coordinates. Pixel (x, y) of
+   * the image is stored at position (x - origin_x, y - origin_y) of the buffer.
+   * The program writes the results in the format above to its standard output.
+   * Objects, that were found in more than one tile, are added only once: each
+   * tile owns the objects, whose center is in the tile without its overlap.
    */
   class ExternalMatching : public Matching {
 
+  public:
+
+    enum PROTOCOL_VERSION {
+      PROTOCOL_V1 = 1,
+      PROTOCOL_V2 = 2
+    };
+
+    /**
+     * The header of the pixel buffer of protocol version 2. All fields
+     * are stored in host byte order.
+     */
+    struct BufferHeader {
+      char magic[8];          /**< "DGREGION" */
+      uint32_t header_size;   /**< offset of the pixel data */
+      uint32_t width;         /**< width of the region */
+      uint32_t height;        /**< height of the region */
+      uint32_t channels;      /**< 1 for greyscale, 4 for RGBA */
+      uint32_t row_stride;    /**< number of bytes per row */
+      int32_t origin_x;       /**< image coordinate of the first column */
+      int32_t origin_y;       /**< image coordinate of the first row */
+    };
+
   private:
 
     Layer_shptr layer;
@@ -65,6 +108,11 @@ namespace degate {
     std::string cmd;
     int exit_code;
 
+    PROTOCOL_VERSION protocol_version;
+    unsigned int num_workers;
+    unsigned int tile_size, tile_overlap;
+    bool greyscale;
+
   private:
 
     std::list<PlacedLogicModelObject_shptr> parse_file(std::string const& filename) const;
@@ -80,6 +128,14 @@ namespace degate {
 
     PlacedLogicModelObject_shptr parse_line(std::string const& line) const;
 
+    void run_v1();
+    void run_v2();
+
+    /**
+     * Store the region into a pixel buffer file for protocol version 2.
+     */
+    void write_region_buffer(std::string const& path) const;
+
 
   public:
 
@@ -92,12 +148,44 @@ namespace degate {
      */
     virtual void init(BoundingBox const& bounding_box, Project_shptr project);
 
+    /**
+     * Run the external program and add the objects into the logic model.
+     * @exception DegateRuntimeException This exception is thrown, if the
+     *   results cannot be parsed.
+     */
     virtual void run();
 
     void set_command(std::string const& cmd);
     std::string get_command() const;
 
+    /**
+     * Get the exit code of the program. For protocol version 2 this is
+     * the first non-zero exit code of the program instances.
+     */
     int get_exit_code() const;
+
+    /**
+     * Set the protocol version. The default is version 1.
+     */
+    void set_protocol_version(PROTOCOL_VERSION version) { protocol_version = version; }
+    PROTOCOL_VERSION get_protocol_version() const { return protocol_version; }
+
+    /**
+     * Set the number of program instances, that run concurrently. Use 0
+     * for the number of available processors. Only used by version 2.
+     */
+    void set_num_workers(unsigned int n) { num_workers = n; }
+
+    /**
+     * Set the edge length of the tiles without overlap and the width of
+     * the overlap. Only used by version 2.
+     */
+    void set_tile_size(unsigned int size, unsigned int overlap);
+
+    /**
+     * Store the pixel buffer as greyscale instead of RGBA. Only used by version 2.
+     */
+    void set_greyscale(bool state) { greyscale = state; }
   };
 
   typedef std::tr1::shared_ptr<ExternalMatching> ExternalMatching_shptr;
@@ -64,7 +64,7 @@ bool degate::is_file(std::string const & path) {
 
 bool degate::is_symlink(std::string const & path) {
   struct stat stat_buf;
-  if(stat(path.c_str(), &stat_buf) == 0) {
+  if(lstat(path.c_str(), &stat_buf) == 0) {
     return S_ISLNK(stat_buf.st_mode) ? true : false;
   }
   return false;
@@ -75,6 +75,14 @@ bool degate::file_exists(std::string const & path) {
   return stat(path.c_str(), &stat_buf) == 0 ? true : false;
 }
 
+bool degate::get_file_status(std::string const & path, off_t & size, time_t & mtime) {
+  struct stat stat_buf;
+  if(stat(path.c_str(), &stat_buf) != 0) return false;
+  size = stat_buf.st_size;
+  mtime = stat_buf.st_mtime;
+  return true;
+}
+
 std::string degate::get_basedir(std::string const & path) {
 
   std::string resolved_path;
@@ -124,6 +132,25 @@ void degate::remove_file(std::string const& path) {
   }
 }
 
+void degate::rename_file(std::string const& old_path, std::string const& new_path) {
+  if(rename(old_path.c_str(), new_path.c_str()) != 0) {
+    throw degate::FileSystemException(strerror(errno));
+  }
+}
+
+bool degate::create_hard_link(std::string const& existing_path, std::string const& new_path) {
+  return link(existing_path.c_str(), new_path.c_str()) == 0;
+}
+
+void degate::replace_symlink(std::string const& target, std::string const& link_path) {
+  std::string tmp_path = link_path + ".tmp";
+  unlink(tmp_path.c_str());
+  if(symlink(target.c_str(), tmp_path.c_str()) != 0) {
+    throw degate::FileSystemException(strerror(errno));
+  }
+  rename_file(tmp_path, link_path);
+}
+
 void degate::remove_directory(std::string const& path) {
   boost::filesystem::path p(path);
   boost::filesystem::remove_all(path);
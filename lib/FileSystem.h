@@ -67,6 +67,13 @@ namespace degate{
 
   bool file_exists(std::string const & path);
 
+  /**
+   * Get the size and the time of the last modification of a file.
+   * @returns Returns false, if the file does not exist.
+   */
+
+  bool get_file_status(std::string const & path, off_t & size, time_t & mtime);
+
 
   /**
    * Get the base directory for file or directory.
@@ -121,6 +128,29 @@ namespace degate{
    */
   void remove_file(std::string const& filename);
 
+  /**
+   * Rename a file. If \p new_path exists, it is replaced atomically.
+   * @exception FileSystemException This exception is thrown, if the file
+   *   cannot be renamed.
+   */
+  void rename_file(std::string const& old_path, std::string const& new_path);
+
+  /**
+   * Create a hard link.
+   * @return Returns false, if the link cannot be created, e.g. because
+   *   \p new_path exists or the file system does not support hard links.
+   */
+  bool create_hard_link(std::string const& existing_path, std::string const& new_path);
+
+  /**
+   * Create a symbolic link or replace an existing one atomically.
+   * @param target The content of the link.
+   * @param link_path The path of the link.
+   * @exception FileSystemException This exception is thrown, if the link
+   *   cannot be created.
+   */
+  void replace_symlink(std::string const& target, std::string const& link_path);
+
   /**
    * Unlink a directory with all files in it.
    * Because this function is only for degate. We make some sanity checks.
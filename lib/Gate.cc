@@ -118,6 +118,8 @@ void Gate::set_gate_template(std::tr1::shared_ptr<GateTemplate> gate_template) {
       set_max_x(get_min_x() + gate_template->get_width());
       set_max_y(get_min_y() + gate_template->get_height());
     }
+
+    notify_appearance_change();
   }
 }
 
@@ -140,6 +142,7 @@ void Gate::remove_template() {
     gate_template->decrement_reference_counter();
     gate_template.reset();
   }
+  notify_appearance_change();
 }
 
 bool Gate::has_template_port(GateTemplatePort_shptr template_port) const {
@@ -23,8 +23,12 @@
 #include <GateLibraryExporter.h>
 #include <FileSystem.h>
 #include <ImageHelper.h>
+#include <ImageManipulation.h>
 #include <DegateHelper.h>
 
+#include <boost/thread.hpp>
+#include <boost/foreach.hpp>
+
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -36,12 +40,54 @@
 #include <fstream>
 #include <stdexcept>
 #include <list>
+#include <algorithm>
 #include <tr1/memory>
 
 
 using namespace std;
 using namespace degate;
 
+namespace {
+
+  /**
+   * Check if an image file on disk is the one, that was recorded for the template.
+   */
+  bool is_image_file_unchanged(GateLibraryExporter::ImageJob const& job) {
+
+    GateTemplate::ImageFile recorded;
+    if(!job.gate_template->get_image_file(job.layer_type, recorded)) return false;
+    if(recorded.path != job.path || recorded.hash != job.file.hash) return false;
+
+    off_t size;
+    time_t mtime;
+    return get_file_status(job.path, size, mtime) &&
+      size == recorded.size && mtime == recorded.mtime;
+  }
+
+  struct ImageWorker {
+
+    std::vector<GateLibraryExporter::ImageJob> * jobs;
+    unsigned int first, step;
+    std::string * error;
+
+    void operator()() {
+      try {
+	for(unsigned int i = first; i < jobs->size(); i += step) {
+	  GateLibraryExporter::ImageJob & job = (*jobs)[i];
+
+	  job.file.path = job.path;
+	  job.file.hash = get_image_hash<GateTemplateImage>(job.image);
+
+	  if(!is_image_file_unchanged(job)) ExportBuffer::write_image(job);
+	}
+      }
+      catch(std::exception const& ex) {
+	*error = ex.what();
+      }
+    }
+  };
+}
+
 void GateLibraryExporter::export_data(std::string const& filename, GateLibrary_shptr gate_lib) {
 
   if(gate_lib == NULL) throw InvalidPointerException("Gate library pointer is NULL.");
@@ -50,17 +96,19 @@ void GateLibraryExporter::export_data(std::string const& filename, GateLibrary_s
 
   try {
 
-    xmlpp::Document doc;
+    XMLDocument_shptr doc(new xmlpp::Document());
 
-    xmlpp::Element * root_elem = doc.create_root_node("gate-library");
+    xmlpp::Element * root_elem = doc->create_root_node("gate-library");
     assert(root_elem != NULL);
 
     xmlpp::Element* templates_elem = root_elem->add_child("gate-templates");
     if(templates_elem == NULL) throw(std::runtime_error("Failed to create node."));
 
+    image_jobs.clear();
     add_gates(templates_elem, gate_lib, directory);
+    write_images();
 
-    doc.write_to_file_formatted(filename, "ISO-8859-1");
+    write_document(doc, filename);
 
   }
   catch(const std::exception& ex) {
@@ -130,9 +178,73 @@ void GateLibraryExporter::add_images(xmlpp::Element* gate_elem,
 
     img_elem->set_attribute("image", filename);
 
-    save_image<GateTemplateImage>(join_pathes(directory, filename), img);
+    ImageJob job;
+    job.gate_template = gate_tmpl;
+    job.layer_type = layer_type;
+    job.path = join_pathes(directory, filename);
+    job.image = img;
+    job.written = false;
+    image_jobs.push_back(job);
+  }
+
+}
+
+void GateLibraryExporter::write_images() {
+
+  ExportBuffer_shptr buffer = get_export_buffer();
+
+  if(buffer != NULL) {
+    num_images_written = num_images_skipped = 0;
+
+    BOOST_FOREACH(ImageJob & job, image_jobs) {
+      job.file.path = job.path;
+      job.file.hash = get_image_hash<GateTemplateImage>(job.image);
+
+      if(is_image_file_unchanged(job)) num_images_skipped++;
+      else {
+	GateTemplateImage_shptr copy(new GateTemplateImage(job.image->get_width(),
+							   job.image->get_height()));
+	copy_image(copy, job.image);
+	job.image = copy;
+	buffer->add_image(job);
+	num_images_written++;
+      }
+    }
+
+    image_jobs.clear();
+    return;
+  }
+
+  unsigned int threads_to_use = num_threads;
+  if(threads_to_use == 0) threads_to_use = std::max(boost::thread::hardware_concurrency(), 1U);
+
+  std::vector<std::string> errors(threads_to_use);
+  boost::thread_group threads;
+
+  for(unsigned int t = 0; t < threads_to_use && t < image_jobs.size(); t++) {
+    ImageWorker w;
+    w.jobs = &image_jobs;
+    w.first = t;
+    w.step = threads_to_use;
+    w.error = &errors[t];
+    threads.create_thread(w);
+  }
+  threads.join_all();
+
+  BOOST_FOREACH(std::string const& e, errors)
+    if(!e.empty()) throw DegateRuntimeException(e);
+
+  // Templates are not thread-safe, therefore the file states are set here.
+  num_images_written = num_images_skipped = 0;
+  BOOST_FOREACH(ImageJob const& job, image_jobs) {
+    if(job.written) {
+      job.gate_template->set_image_file(job.layer_type, job.file);
+      num_images_written++;
+    }
+    else num_images_skipped++;
   }
 
+  image_jobs.clear();
 }
 
 void GateLibraryExporter::add_ports(xmlpp::Element* gate_elem,
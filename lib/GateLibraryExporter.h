@@ -28,16 +28,26 @@
 #include "ObjectIDRewriter.h"
 
 #include <stdexcept>
+#include <vector>
 
 namespace degate {
 
 /**
  * The GateLibraryExporter exports a gate library. That is the file
  * gate_library.xml from your degate project.
+ *
+ * Template images are written in parallel. An image is not written again, if
+ * its content hash matches the hash recorded for the template and the file
+ * on disk still has the recorded size and modification time. If the exporter
+ * has an export buffer, copies of the changed images are added to the buffer.
  */
 
 class GateLibraryExporter : public XMLExporter {
 
+public:
+
+  typedef ExportBuffer::ImageJob ImageJob;
+
 private:
 
   void add_gates(xmlpp::Element* templates_elem, GateLibrary_shptr gate_lib,
@@ -51,10 +61,26 @@ private:
 
   void add_ports(xmlpp::Element* gate_elem, GateTemplate_shptr gate_tmpl);
 
+  void write_images();
+
   ObjectIDRewriter_shptr oid_rewriter;
+  unsigned int num_threads;
+
+  std::vector<ImageJob> image_jobs;
+  unsigned int num_images_written;
+  unsigned int num_images_skipped;
 
 public:
-  GateLibraryExporter(ObjectIDRewriter_shptr _oid_rewriter) : oid_rewriter(_oid_rewriter) {}
+
+  /**
+   * Create an exporter.
+   * @param num_threads The number of threads, that write template images.
+   *   Use 0 for the number of available processors.
+   */
+  GateLibraryExporter(ObjectIDRewriter_shptr _oid_rewriter, unsigned int _num_threads = 0) :
+    oid_rewriter(_oid_rewriter), num_threads(_num_threads),
+    num_images_written(0), num_images_skipped(0) {}
+
   ~GateLibraryExporter() {}
 
   /**
@@ -64,6 +90,18 @@ public:
    */
   void export_data(std::string const& filename, GateLibrary_shptr gate_lib);
 
+  /**
+   * Get the number of template images, that were written by the last export.
+   * With an export buffer, it is the number of images added to the buffer.
+   */
+  unsigned int get_num_images_written() const { return num_images_written; }
+
+  /**
+   * Get the number of template images, that were unchanged and therefore
+   * not written by the last export.
+   */
+  unsigned int get_num_images_skipped() const { return num_images_skipped; }
+
 };
 
 }
@@ -165,16 +165,39 @@ void GateLibraryImporter::parse_template_images_element(const xmlpp::Element * c
       const std::string layer_type_str(image_elem->get_attribute_value("layer-type"));
       const std::string image_file(image_elem->get_attribute_value("image"));
 
-      Layer::LAYER_TYPE layer_type = Layer::get_layer_type_from_string(layer_type_str);
-      GateTemplateImage_shptr img = load_image<GateTemplateImage>(join_pathes(directory, image_file));
-
-      assert(img != NULL);
-      gate_tmpl->set_image(layer_type, img);
+      TemplateImage tmpl_image;
+      tmpl_image.gate_template = gate_tmpl;
+      tmpl_image.layer_type = Layer::get_layer_type_from_string(layer_type_str);
+      tmpl_image.path = join_pathes(directory, image_file);
+
+      if(load_images) {
+	load_template_image(tmpl_image);
+	apply_template_image(tmpl_image);
+      }
+      else deferred_images.push_back(tmpl_image);
     }
   }
 
 }
 
+void GateLibraryImporter::load_template_image(TemplateImage & tmpl_image) {
+  tmpl_image.image = load_image<GateTemplateImage>(tmpl_image.path);
+  assert(tmpl_image.image != NULL);
+
+  // Remember the file state, so that saving the library again can skip the image.
+  tmpl_image.file.path = tmpl_image.path;
+  tmpl_image.file.hash = get_image_hash<GateTemplateImage>(tmpl_image.image);
+  if(!get_file_status(tmpl_image.path, tmpl_image.file.size, tmpl_image.file.mtime))
+    tmpl_image.file.path.clear();
+}
+
+void GateLibraryImporter::apply_template_image(TemplateImage const& tmpl_image) {
+  if(tmpl_image.image == NULL) throw InvalidPointerException("The template image is not loaded.");
+  tmpl_image.gate_template->set_image(tmpl_image.layer_type, tmpl_image.image);
+  if(!tmpl_image.file.path.empty())
+    tmpl_image.gate_template->set_image_file(tmpl_image.layer_type, tmpl_image.file);
+}
+
 void GateLibraryImporter::parse_template_implementations_element(const xmlpp::Element * const implementations_element,
 								 GateTemplate_shptr gate_tmpl,
 								 std::string const& directory) {
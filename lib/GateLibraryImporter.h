@@ -27,6 +27,7 @@
 #include "XMLImporter.h"
 
 #include <stdexcept>
+#include <vector>
 
 namespace degate {
 
@@ -36,8 +37,27 @@ namespace degate {
  */
 
 class GateLibraryImporter : public XMLImporter {
+
+public:
+
+  /**
+   * A template image, that is loaded apart from parsing the gate library.
+   */
+  struct TemplateImage {
+    GateTemplate_shptr gate_template;
+    Layer::LAYER_TYPE layer_type;
+    std::string path;
+    GateTemplateImage_shptr image;
+    GateTemplate::ImageFile file;
+  };
+
+  typedef std::vector<TemplateImage> template_image_list;
+
 private:
 
+  bool load_images;
+  template_image_list deferred_images;
+
   GateLibrary_shptr parse_gate_library_element(const xmlpp::Element * const gl_element,
 					       std::string const& directory);
 
@@ -60,11 +80,34 @@ private:
 				    GateLibrary_shptr gate_lib);
 
 public:
-  GateLibraryImporter() {}
+
+  /**
+   * Create an importer.
+   * @param load_images If false, template images are not loaded during
+   *   the import. They are collected instead and can be loaded later,
+   *   e.g. in several threads. See get_deferred_images().
+   */
+  GateLibraryImporter(bool _load_images = true) : load_images(_load_images) {}
   ~GateLibraryImporter() {}
 
   GateLibrary_shptr import(std::string const& filename);
 
+  /**
+   * Get the template images, that were not loaded during the import.
+   */
+  template_image_list & get_deferred_images() { return deferred_images; }
+
+  /**
+   * Load a template image from its file and record the state of the file.
+   * The image is not set to the template. This function is thread-safe.
+   */
+  static void load_template_image(TemplateImage & tmpl_image);
+
+  /**
+   * Set a loaded image and its file state to its template.
+   */
+  static void apply_template_image(TemplateImage const& tmpl_image);
+
 };
 
 }
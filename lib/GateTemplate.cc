@@ -88,6 +88,17 @@ bool GateTemplate::has_image(Layer::LAYER_TYPE layer_type) const {
   return images.find(layer_type) != images.end();
 }
 
+void GateTemplate::set_image_file(Layer::LAYER_TYPE layer_type, ImageFile const& file) {
+  image_files[layer_type] = file;
+}
+
+bool GateTemplate::get_image_file(Layer::LAYER_TYPE layer_type, ImageFile & file) const {
+  std::map<Layer::LAYER_TYPE, ImageFile>::const_iterator found = image_files.find(layer_type);
+  if(found == image_files.end()) return false;
+  file = found->second;
+  return true;
+}
+
 void GateTemplate::add_template_port(GateTemplatePort_shptr template_port) {
   if(!template_port->has_valid_object_id())
     throw InvalidObjectIDException("Error in GateTemplate::add_template_port(). "
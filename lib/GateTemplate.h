@@ -62,6 +62,17 @@ namespace degate {
     typedef std::map<Layer::LAYER_TYPE, GateTemplateImage_shptr> image_collection;
     typedef image_collection::iterator image_iterator;
 
+    /**
+     * The state of a file, that a template image was read from or written to.
+     * An exporter uses it to check if an image must be written again.
+     */
+    struct ImageFile {
+      std::string path;
+      uint64_t hash;  /**< The content hash, see get_image_hash(). */
+      off_t size;
+      time_t mtime;
+    };
+
   private:
 
     BoundingBox bounding_box;
@@ -71,6 +82,7 @@ namespace degate {
 
     implementation_collection implementations;
     image_collection images;
+    std::map<Layer::LAYER_TYPE, ImageFile> image_files;
 
     std::string logic_class; // e.g. nand, xor, flipflop, buffer, oai
 
@@ -184,6 +196,19 @@ namespace degate {
 
     virtual bool has_image(Layer::LAYER_TYPE layer_type) const;
 
+    /**
+     * Remember the file state for the reference image of a layer.
+     */
+
+    virtual void set_image_file(Layer::LAYER_TYPE layer_type, ImageFile const& file);
+
+    /**
+     * Get the file state for the reference image of a layer.
+     * @return Returns false, if no file state was recorded.
+     */
+
+    virtual bool get_image_file(Layer::LAYER_TYPE layer_type, ImageFile & file) const;
+
     /**
      * Add a template port to a gate template.
      * This is an isolated function. The port is just added to the gate template.
@@ -0,0 +1,59 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <Geometry.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace degate;
+
+void degate::geo_find_touching(GeoCircle const& probe, GeoCircleBatch const& candidates,
+			       std::vector<unsigned int> & hits) {
+
+  double const * x = candidates.get_x();
+  double const * y = candidates.get_y();
+  double const * radius = candidates.get_radius();
+  size_t n = candidates.size();
+  size_t i = 0;
+
+  double px = probe.x, py = probe.y, pr = probe.diameter / 2.0;
+
+#ifdef __SSE2__
+  __m128d vx = _mm_set1_pd(px), vy = _mm_set1_pd(py), vr = _mm_set1_pd(pr);
+
+  for(; i + 2 <= n; i += 2) {
+    __m128d dx = _mm_sub_pd(_mm_loadu_pd(x + i), vx);
+    __m128d dy = _mm_sub_pd(_mm_loadu_pd(y + i), vy);
+    __m128d r = _mm_add_pd(_mm_loadu_pd(radius + i), vr);
+    __m128d d = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+
+    int mask = _mm_movemask_pd(_mm_cmple_pd(d, _mm_mul_pd(r, r)));
+    if(mask & 1) hits.push_back(i);
+    if(mask & 2) hits.push_back(i + 1);
+  }
+#endif
+
+  for(; i < n; i++)
+    if(geo_distance_sq(px, py, x[i], y[i]) <= geo_sqr(pr + radius[i])) hits.push_back(i);
+}
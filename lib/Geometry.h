@@ -0,0 +1,329 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef __GEOMETRY_H__
+#define __GEOMETRY_H__
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace degate {
+
+  /**
+   * The geometry kernel works on plain old data records. Unlike the shape
+   * classes, the records have no virtual methods and are never allocated on
+   * the heap, so the tests below can be inlined into tight loops. The shape
+   * classes Circle, Line and Rectangle convert themselves into records and
+   * dispatch into the kernel.
+   *
+   * Circles and segments have a diameter. A segment is a wire: it covers all
+   * points with a distance of at most diameter / 2 to its center line.
+   */
+
+  struct GeoCircle {
+    int x, y;
+    unsigned int diameter;
+  };
+
+  struct GeoSegment {
+    int from_x, from_y, to_x, to_y;
+    unsigned int diameter;
+  };
+
+  struct GeoRect {
+    int min_x, max_x, min_y, max_y;
+  };
+
+  /**
+   * A record for any of the shapes.
+   */
+  struct GeoShape {
+
+    enum GEO_SHAPE_TYPE {
+      GEO_NONE = 0,
+      GEO_CIRCLE = 1,
+      GEO_SEGMENT = 2,
+      GEO_RECT = 3
+    };
+
+    GEO_SHAPE_TYPE type;
+
+    union {
+      GeoCircle circle;
+      GeoSegment segment;
+      GeoRect rect;
+    };
+  };
+
+
+  inline GeoCircle make_geo_circle(int x, int y, unsigned int diameter) {
+    GeoCircle c = { x, y, diameter };
+    return c;
+  }
+
+  inline GeoSegment make_geo_segment(int from_x, int from_y, int to_x, int to_y,
+				     unsigned int diameter) {
+    GeoSegment s = { from_x, from_y, to_x, to_y, diameter };
+    return s;
+  }
+
+  inline GeoRect make_geo_rect(int min_x, int max_x, int min_y, int max_y) {
+    GeoRect r = { min_x, max_x, min_y, max_y };
+    return r;
+  }
+
+
+  /*
+   * Distances
+   *
+   * Distances are calculated as squared distances in double precision.
+   * For pixel coordinates this is exact, so there is no need for sqrt().
+   */
+
+  template<typename T>
+  inline T geo_sqr(T v) { return v * v; }
+
+  inline double geo_distance_sq(double x1, double y1, double x2, double y2) {
+    return geo_sqr(x2 - x1) + geo_sqr(y2 - y1);
+  }
+
+  /**
+   * Get the squared distance between a point and the center line of a segment.
+   */
+  inline double geo_distance_sq(GeoSegment const& s, double x, double y) {
+    double dx = (double)s.to_x - s.from_x;
+    double dy = (double)s.to_y - s.from_y;
+    double len_sq = dx * dx + dy * dy;
+    if(len_sq == 0) return geo_distance_sq(s.from_x, s.from_y, x, y);
+
+    double t = ((x - s.from_x) * dx + (y - s.from_y) * dy) / len_sq;
+    t = std::max(0.0, std::min(1.0, t));
+    return geo_distance_sq(s.from_x + t * dx, s.from_y + t * dy, x, y);
+  }
+
+  /**
+   * Get the squared distance between a point and a rectangle. It is 0 for
+   * points in the rectangle.
+   */
+  inline double geo_distance_sq(GeoRect const& r, double x, double y) {
+    double dx = std::max(0.0, std::max(r.min_x - x, x - r.max_x));
+    double dy = std::max(0.0, std::max(r.min_y - y, y - r.max_y));
+    return dx * dx + dy * dy;
+  }
+
+  inline bool geo_in_rect(GeoRect const& r, int x, int y) {
+    return x >= r.min_x && x <= r.max_x && y >= r.min_y && y <= r.max_y;
+  }
+
+  inline bool geo_intersects(GeoRect const& r1, GeoRect const& r2) {
+    return !(r2.min_x > r1.max_x || r2.max_x < r1.min_x ||
+	     r2.min_y > r1.max_y || r2.max_y < r1.min_y);
+  }
+
+  /**
+   * Check on which side of the line through (x1, y1) and (x2, y2) a point is.
+   * The calculation is exact.
+   * @return Returns a positive value for the left side, a negative value for
+   *   the right side and 0 for points on the line.
+   */
+  inline long long geo_orientation(int x1, int y1, int x2, int y2, int x, int y) {
+    return (long long)(x2 - x1) * (y - y1) - (long long)(y2 - y1) * (x - x1);
+  }
+
+  /**
+   * Check if the center lines of two segments intersect.
+   */
+  inline bool geo_intersects(GeoSegment const& s1, GeoSegment const& s2) {
+
+    long long o1 = geo_orientation(s1.from_x, s1.from_y, s1.to_x, s1.to_y, s2.from_x, s2.from_y);
+    long long o2 = geo_orientation(s1.from_x, s1.from_y, s1.to_x, s1.to_y, s2.to_x, s2.to_y);
+    long long o3 = geo_orientation(s2.from_x, s2.from_y, s2.to_x, s2.to_y, s1.from_x, s1.from_y);
+    long long o4 = geo_orientation(s2.from_x, s2.from_y, s2.to_x, s2.to_y, s1.to_x, s1.to_y);
+
+    if(((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0)) &&
+       ((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0))) return true;
+
+    // An end point is on the other segment's line. It is on the segment, if
+    // it is within the segment's bounding box.
+    GeoRect b1 = make_geo_rect(std::min(s1.from_x, s1.to_x), std::max(s1.from_x, s1.to_x),
+			       std::min(s1.from_y, s1.to_y), std::max(s1.from_y, s1.to_y));
+    GeoRect b2 = make_geo_rect(std::min(s2.from_x, s2.to_x), std::max(s2.from_x, s2.to_x),
+			       std::min(s2.from_y, s2.to_y), std::max(s2.from_y, s2.to_y));
+
+    return
+      (o1 == 0 && geo_in_rect(b1, s2.from_x, s2.from_y)) ||
+      (o2 == 0 && geo_in_rect(b1, s2.to_x, s2.to_y)) ||
+      (o3 == 0 && geo_in_rect(b2, s1.from_x, s1.from_y)) ||
+      (o4 == 0 && geo_in_rect(b2, s1.to_x, s1.to_y));
+  }
+
+  /**
+   * Get the squared distance between the center lines of two segments.
+   */
+  inline double geo_distance_sq(GeoSegment const& s1, GeoSegment const& s2) {
+    if(geo_intersects(s1, s2)) return 0;
+    return std::min(std::min(geo_distance_sq(s1, s2.from_x, s2.from_y),
+			     geo_distance_sq(s1, s2.to_x, s2.to_y)),
+		    std::min(geo_distance_sq(s2, s1.from_x, s1.from_y),
+			     geo_distance_sq(s2, s1.to_x, s1.to_y)));
+  }
+
+  /**
+   * Get the squared distance between the center line of a segment and a rectangle.
+   */
+  inline double geo_distance_sq(GeoSegment const& s, GeoRect const& r) {
+
+    if(geo_in_rect(r, s.from_x, s.from_y) || geo_in_rect(r, s.to_x, s.to_y)) return 0;
+
+    // The segment crosses the rectangle, if it crosses a diagonal.
+    GeoSegment d1 = make_geo_segment(r.min_x, r.min_y, r.max_x, r.max_y, 0);
+    GeoSegment d2 = make_geo_segment(r.min_x, r.max_y, r.max_x, r.min_y, 0);
+    if(geo_intersects(s, d1) || geo_intersects(s, d2)) return 0;
+
+    return std::min(std::min(std::min(geo_distance_sq(r, s.from_x, s.from_y),
+				      geo_distance_sq(r, s.to_x, s.to_y)),
+			     std::min(geo_distance_sq(s, r.min_x, r.min_y),
+				      geo_distance_sq(s, r.min_x, r.max_y))),
+		    std::min(geo_distance_sq(s, r.max_x, r.min_y),
+			     geo_distance_sq(s, r.max_x, r.max_y)));
+  }
+
+
+  /*
+   * Tangency tests. Two shapes are tangent, if they touch or overlap.
+   */
+
+  inline bool geo_touches(GeoCircle const& c1, GeoCircle const& c2) {
+    return geo_distance_sq(c1.x, c1.y, c2.x, c2.y) <= geo_sqr((c1.diameter + c2.diameter) / 2.0);
+  }
+
+  inline bool geo_touches(GeoSegment const& s1, GeoSegment const& s2) {
+    return geo_distance_sq(s1, s2) <= geo_sqr((s1.diameter + s2.diameter) / 2.0);
+  }
+
+  inline bool geo_touches(GeoRect const& r1, GeoRect const& r2) {
+    return geo_intersects(r1, r2);
+  }
+
+  inline bool geo_touches(GeoCircle const& c, GeoSegment const& s) {
+    return geo_distance_sq(s, c.x, c.y) <= geo_sqr((c.diameter + s.diameter) / 2.0);
+  }
+
+  inline bool geo_touches(GeoCircle const& c, GeoRect const& r) {
+    return geo_distance_sq(r, c.x, c.y) <= geo_sqr(c.diameter / 2.0);
+  }
+
+  inline bool geo_touches(GeoSegment const& s, GeoRect const& r) {
+    return geo_distance_sq(s, r) <= geo_sqr(s.diameter / 2.0);
+  }
+
+  inline bool geo_touches(GeoSegment const& s, GeoCircle const& c) { return geo_touches(c, s); }
+  inline bool geo_touches(GeoRect const& r, GeoCircle const& c) { return geo_touches(c, r); }
+  inline bool geo_touches(GeoRect const& r, GeoSegment const& s) { return geo_touches(s, r); }
+
+  template<typename ShapeType>
+  inline bool geo_touches(ShapeType const& s1, GeoShape const& s2) {
+    switch(s2.type) {
+    case GeoShape::GEO_CIRCLE: return geo_touches(s1, s2.circle);
+    case GeoShape::GEO_SEGMENT: return geo_touches(s1, s2.segment);
+    case GeoShape::GEO_RECT: return geo_touches(s1, s2.rect);
+    default: return false;
+    }
+  }
+
+  inline bool geo_touches(GeoShape const& s1, GeoShape const& s2) {
+    switch(s1.type) {
+    case GeoShape::GEO_CIRCLE: return geo_touches(s1.circle, s2);
+    case GeoShape::GEO_SEGMENT: return geo_touches(s1.segment, s2);
+    case GeoShape::GEO_RECT: return geo_touches(s1.rect, s2);
+    default: return false;
+    }
+  }
+
+
+  /**
+   * Circles in a structure of arrays layout, that can be tested in a batch.
+   * Coordinates are stored as doubles, because that is what the tests
+   * work with.
+   */
+  class GeoCircleBatch {
+
+  private:
+
+    std::vector<double> x, y, radius;
+
+  public:
+
+    void clear() {
+      x.clear();
+      y.clear();
+      radius.clear();
+    }
+
+    void reserve(size_t n) {
+      x.reserve(n);
+      y.reserve(n);
+      radius.reserve(n);
+    }
+
+    void push_back(GeoCircle const& c) {
+      x.push_back(c.x);
+      y.push_back(c.y);
+      radius.push_back(c.diameter / 2.0);
+    }
+
+    size_t size() const { return x.size(); }
+
+    GeoCircle get(size_t i) const {
+      return make_geo_circle((int)x[i], (int)y[i], (unsigned int)(radius[i] * 2));
+    }
+
+    double const * get_x() const { return x.empty() ? NULL : &x[0]; }
+    double const * get_y() const { return y.empty() ? NULL : &y[0]; }
+    double const * get_radius() const { return radius.empty() ? NULL : &radius[0]; }
+  };
+
+  /**
+   * Find the circles in a batch, that are tangent to a shape.
+   * @param probe The shape.
+   * @param candidates The circles.
+   * @param hits The indices of the tangent circles are appended in
+   *   ascending order.
+   */
+  template<typename ShapeType>
+  void geo_find_touching(ShapeType const& probe, GeoCircleBatch const& candidates,
+			 std::vector<unsigned int> & hits) {
+    for(size_t i = 0; i < candidates.size(); i++)
+      if(geo_touches(probe, candidates.get(i))) hits.push_back(i);
+  }
+
+  /**
+   * Find the circles in a batch, that are tangent to a circle. This
+   * test is vectorized.
+   */
+  void geo_find_touching(GeoCircle const& probe, GeoCircleBatch const& candidates,
+			 std::vector<unsigned int> & hits);
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <degate.h>
+#include <HighlightOverlay.h>
+
+using namespace degate;
+
+HighlightOverlay::HighlightOverlay() : epoch(0), log_epoch(0) {
+}
+
+void HighlightOverlay::log_change(CHANGE_TYPE type, object_id_t id) {
+  changes.push_back(Change(type, id));
+  epoch++;
+
+  if(changes.size() > max_logged_changes) {
+    changes.pop_front();
+    log_epoch++;
+  }
+}
+
+void HighlightOverlay::add_object(object_id_t oid) {
+  if(objects.insert(std::make_pair(oid, 0U)).second) log_change(CHANGE_OBJECT, oid);
+}
+
+void HighlightOverlay::remove_object(object_id_t oid) {
+  if(objects.erase(oid) > 0) log_change(CHANGE_OBJECT, oid);
+}
+
+void HighlightOverlay::add_net(object_id_t net_id) {
+  if(nets[net_id].refs++ == 0) log_change(CHANGE_NET, net_id);
+}
+
+void HighlightOverlay::remove_net(object_id_t net_id) {
+  DenseObjectMap<NetEntry>::iterator found = nets.find(net_id);
+  if(found == nets.end()) return;
+
+  if(--found->second.refs == 0) {
+    nets.erase(found);
+    log_change(CHANGE_NET, net_id);
+  }
+}
+
+void HighlightOverlay::clear() {
+  if(empty()) return;
+
+  // The entries are plain values. Clearing the maps does not walk them.
+  objects.clear();
+  nets.clear();
+  log_change(CHANGE_CLEAR);
+}
+
+bool HighlightOverlay::get_changes(unsigned int since,
+				   std::vector<object_id_t> & oids,
+				   std::vector<object_id_t> & net_ids,
+				   bool & cleared) const {
+
+  if(since < log_epoch || since > epoch) return false;
+
+  cleared = false;
+
+  for(std::deque<Change>::const_iterator iter = changes.begin() + (since - log_epoch);
+      iter != changes.end(); ++iter) {
+
+    switch(iter->type) {
+    case CHANGE_OBJECT: oids.push_back(iter->id); break;
+    case CHANGE_NET: net_ids.push_back(iter->id); break;
+    case CHANGE_CLEAR: cleared = true; break;
+    }
+  }
+
+  return true;
+}
+
+PlacedLogicModelObject::HIGHLIGHTING_STATE
+HighlightOverlay::get_state(PlacedLogicModelObject_shptr o) const {
+
+  if(o == NULL || empty()) return PlacedLogicModelObject::HLIGHTSTATE_NOT;
+
+  if(o->has_valid_object_id() && is_object_highlighted(o->get_object_id()))
+    return PlacedLogicModelObject::HLIGHTSTATE_DIRECT;
+
+  if(!nets.empty()) {
+    if(ConnectedLogicModelObject * clo = dynamic_cast<ConnectedLogicModelObject *>(o.get())) {
+      Net_shptr net = clo->get_net();
+      if(net != NULL && is_net_highlighted(net->get_object_id()))
+	return PlacedLogicModelObject::HLIGHTSTATE_ADJACENT;
+    }
+  }
+
+  return PlacedLogicModelObject::HLIGHTSTATE_NOT;
+}
@@ -0,0 +1,173 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __HIGHLIGHTOVERLAY_H__
+#define __HIGHLIGHTOVERLAY_H__
+
+#include <globals.h>
+#include <PlacedLogicModelObject.h>
+#include <DenseObjectMap.h>
+
+#include <tr1/memory>
+#include <deque>
+#include <vector>
+
+namespace degate {
+
+  /**
+   * The HighlightOverlay stores which objects and nets are highlighted.
+   *
+   * Highlighting is not written into the objects. Instead the overlay keeps
+   * a set of directly highlighted object IDs and a set of highlighted net IDs.
+   * An object, that is connected to a highlighted net, is adjacent-highlighted.
+   * Highlighting a net is therefore O(1), independent of the net size, and
+   * so is clearing the overlay.
+   *
+   * Each modification increments an epoch counter. Renderers, that cache
+   * primitives, remember the epoch they rendered and re-query the overlay
+   * only if the epoch changed. The recent modifications are logged, so that
+   * a renderer can ask which objects and nets changed since its epoch and
+   * update only the affected primitives.
+   */
+
+  class HighlightOverlay {
+
+  private:
+
+    struct NetEntry {
+      // The number of add_net() calls, that were not yet undone.
+      unsigned int refs;
+      NetEntry() : refs(0) {}
+    };
+
+    enum CHANGE_TYPE {
+      CHANGE_OBJECT,
+      CHANGE_NET,
+      CHANGE_CLEAR
+    };
+
+    struct Change {
+      CHANGE_TYPE type;
+      object_id_t id;
+      Change(CHANGE_TYPE _type, object_id_t _id) : type(_type), id(_id) {}
+    };
+
+    const static size_t max_logged_changes = 4096;
+
+    unsigned int epoch;
+
+    // changes[i] increased the epoch from log_epoch + i to log_epoch + i + 1.
+    std::deque<Change> changes;
+    unsigned int log_epoch;
+
+    DenseObjectMap<unsigned int> objects;
+    DenseObjectMap<NetEntry> nets;
+
+    void log_change(CHANGE_TYPE type, object_id_t id = 0);
+
+  public:
+
+    /**
+     * Create an empty overlay.
+     */
+    HighlightOverlay();
+
+    /**
+     * Highlight an object directly.
+     */
+    void add_object(object_id_t oid);
+
+    /**
+     * Remove the direct highlighting of an object.
+     */
+    void remove_object(object_id_t oid);
+
+    /**
+     * Highlight all objects of a net. A net can be added multiple times, e.g.
+     * for multiple selected objects on the same net. It stays highlighted
+     * until remove_net() was called as often as add_net().
+     */
+    void add_net(object_id_t net_id);
+
+    /**
+     * Undo an add_net() call.
+     */
+    void remove_net(object_id_t net_id);
+
+    /**
+     * Remove all highlighting.
+     */
+    void clear();
+
+    /**
+     * Check if an object is highlighted directly.
+     */
+    bool is_object_highlighted(object_id_t oid) const {
+      return objects.count(oid) > 0;
+    }
+
+    /**
+     * Check if a net is highlighted.
+     */
+    bool is_net_highlighted(object_id_t net_id) const {
+      return nets.count(net_id) > 0;
+    }
+
+    /**
+     * Check if there is any highlighting at all.
+     */
+    bool empty() const { return objects.empty() && nets.empty(); }
+
+    /**
+     * Get the highlighting state of an object. Directly highlighted objects
+     * are reported as HLIGHTSTATE_DIRECT, connected objects, whose net is
+     * highlighted, as HLIGHTSTATE_ADJACENT.
+     */
+    PlacedLogicModelObject::HIGHLIGHTING_STATE get_state(PlacedLogicModelObject_shptr o) const;
+
+    /**
+     * Get the epoch. The epoch is incremented on every modification.
+     */
+    unsigned int get_epoch() const { return epoch; }
+
+    /**
+     * Get the modifications after an epoch.
+     * @param since An epoch, that was returned by get_epoch().
+     * @param oids The IDs of objects, that were highlighted or unhighlighted
+     *   directly, are appended to this list.
+     * @param net_ids The IDs of nets, that were highlighted or unhighlighted,
+     *   are appended to this list.
+     * @param cleared Is set to true, if clear() removed highlighting after
+     *   \p since. The cleared objects and nets are not reported.
+     * @return Returns false, if the log does not reach back to \p since.
+     *   Then the lists are not modified and the caller has to assume, that
+     *   every object changed.
+     */
+    bool get_changes(unsigned int since,
+		     std::vector<object_id_t> & oids,
+		     std::vector<object_id_t> & net_ids,
+		     bool & cleared) const;
+  };
+
+  typedef std::tr1::shared_ptr<HighlightOverlay> HighlightOverlay_shptr;
+}
+
+#endif
@@ -20,35 +20,24 @@
  */
 
 #include "HlObjectSet.h"
-#include <algorithm>
 #include <tr1/memory>
 
 using namespace std;
 using namespace degate;
 
 
-void HlObjectSet::clear() {
-  highlight(PlacedLogicModelObject::HLIGHTSTATE_NOT);
-
-  
-  for(adjacent_objects_t::iterator iter = adjacent_objects.begin();
-      iter != adjacent_objects.end(); ++iter) {
-    unhighlight_adjacent_objects(iter->second);
-  }
-
-  adjacent_objects.clear();
-  ObjectSet::clear();
+HlObjectSet::HlObjectSet() : overlay(new HighlightOverlay()) {
 }
 
-void HlObjectSet::highlight(PlacedLogicModelObject::HIGHLIGHTING_STATE state) {
-  for(iterator it = begin(); it != end(); ++it)
-    (*it)->set_highlighted(state);
+void HlObjectSet::clear() {
+  overlay->clear();
+  highlighted_nets.clear();
+  ObjectSet::clear();
 }
 
-
 void HlObjectSet::add(std::tr1::shared_ptr<PlacedLogicModelObject> object) {
   ObjectSet::add(object);
-  object->set_highlighted(PlacedLogicModelObject::HLIGHTSTATE_DIRECT);
+  overlay->add_object(object->get_object_id());
 }
 
 void HlObjectSet::add(std::tr1::shared_ptr<PlacedLogicModelObject> object,
@@ -57,57 +46,26 @@ void HlObjectSet::add(std::tr1::shared_ptr<PlacedLogicModelObject> object,
 
   if(ConnectedLogicModelObject_shptr o =
      std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(object) ) {
-    // highlight adjacent objects
-    highlight_adjacent_objects(o, lmodel);
-  }
-}
-
 
-void HlObjectSet::highlight_adjacent_objects(ConnectedLogicModelObject_shptr o,
-					     LogicModel_shptr lmodel) {
-  Net_shptr net = o->get_net();
-  if(net == NULL) return;
-
-  // iterate over net
-  BOOST_FOREACH(object_id_t oid, *net) {
-    PlacedLogicModelObject_shptr plo = lmodel->get_object(oid);
-    ConnectedLogicModelObject_shptr clo =
-      std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(plo);
-    assert(clo != NULL);
-    // remember connnected objects in list
-    if(o != clo) {
-
-      clo->set_highlighted(PlacedLogicModelObject::HLIGHTSTATE_ADJACENT);
-
-      adjacent_objects[o].push_back(clo);
+    // highlight adjacent objects
+    Net_shptr net = o->get_net();
+    if(net != NULL && highlighted_nets.count(o->get_object_id()) == 0) {
+      overlay->add_net(net->get_object_id());
+      highlighted_nets[o->get_object_id()] = net->get_object_id();
     }
   }
 }
 
-void HlObjectSet::unhighlight_adjacent_objects(adjacent_objects_t::mapped_type & list) {
-  // iterate over list
-  BOOST_FOREACH(ConnectedLogicModelObject_shptr clo, list) {
-
-    adjacent_objects_t::iterator iter = adjacent_objects.find(clo);
-    if(iter == adjacent_objects.end())
-      clo->set_highlighted(PlacedLogicModelObject::HLIGHTSTATE_NOT);
-
-  }
-  list.clear();
-}
-
 void HlObjectSet::remove(std::tr1::shared_ptr<PlacedLogicModelObject> object) {
   ObjectSet::remove(object);
 
-  if(ConnectedLogicModelObject_shptr o =
-     std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(object) ) {
-  
-    adjacent_objects_t::iterator iter = adjacent_objects.find(o);
-    if(iter != adjacent_objects.end()) {
-      unhighlight_adjacent_objects((*iter).second);
-    }
-    adjacent_objects.erase(iter);
+  // The object might have been connected to another net in the meantime,
+  // therefore we remove the net, that was added.
+  DenseObjectMap<object_id_t>::iterator iter = highlighted_nets.find(object->get_object_id());
+  if(iter != highlighted_nets.end()) {
+    overlay->remove_net(iter->second);
+    highlighted_nets.erase(iter);
   }
 
-  object->set_highlighted(PlacedLogicModelObject::HLIGHTSTATE_NOT);
+  overlay->remove_object(object->get_object_id());
 }
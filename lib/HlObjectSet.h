@@ -28,33 +28,42 @@
 #include <map>
 #include <tr1/memory>
 #include <ObjectSet.h>
+#include <HighlightOverlay.h>
+#include <DenseObjectMap.h>
 
 namespace degate {
 
   /**
    * This class represents a collection of highlighted objects.
+   *
+   * The highlighting is not stored in the objects. It is recorded in a
+   * HighlightOverlay, that renderers query for the highlighting state.
    */
   class HlObjectSet : public ObjectSet {
 
   private:
-    typedef std::map<ConnectedLogicModelObject_shptr,
-		     std::list<ConnectedLogicModelObject_shptr> > adjacent_objects_t;
-    adjacent_objects_t adjacent_objects;
+    HighlightOverlay_shptr overlay;
 
-  private:
-    void highlight_adjacent_objects(ConnectedLogicModelObject_shptr o,
-				    LogicModel_shptr lmodel);
-
-    void unhighlight_adjacent_objects(adjacent_objects_t::mapped_type & list);
-
-    void highlight(PlacedLogicModelObject::HIGHLIGHTING_STATE state);
+    // object ID -> ID of the net, that was highlighted on behalf of the object
+    DenseObjectMap<object_id_t> highlighted_nets;
 
   public:
+    HlObjectSet();
+
     void clear();
     void add(degate::PlacedLogicModelObject_shptr object);
+
+    /**
+     * Add an object and highlight the objects on its net as adjacent objects.
+     */
     void add(degate::PlacedLogicModelObject_shptr object,
 	     LogicModel_shptr lmodel);
     void remove(degate::PlacedLogicModelObject_shptr object);
+
+    /**
+     * Get the overlay, that describes the highlighting.
+     */
+    HighlightOverlay_shptr get_overlay() const { return overlay; }
   };
 }
 
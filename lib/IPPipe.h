@@ -86,7 +86,10 @@ namespace degate {
 
 
     /**
-     * Start processing.
+     * Start processing. Each processor reports its progress into a subtask
+     * of the pipe and shares the pipe's cancellation token.
+     * @return Returns the processed image or a null pointer, if the
+     *   processing was canceled.
      */
     ImageBase_shptr run(ImageBase_shptr img_in) {
 
@@ -94,15 +97,24 @@ namespace degate {
 
       ImageBase_shptr last_img = img_in;
 
+      reset_progress();
+      get_progress_task()->set_total(processor_list.size());
+
       // iterate over list
       for(processor_list_type::iterator iter = processor_list.begin();
 	  iter != processor_list.end(); ++iter) {
 
+	if(is_canceled()) return ImageBase_shptr();
+
 	ImageProcessorBase_shptr ip = *iter;
+	ProgressTask_shptr task = create_progress_subtask(1);
+	ip->attach_progress(*this, task);
 
 	assert(last_img != NULL);
 	last_img = ip->run(last_img);
 	assert(last_img != NULL);
+
+	task->finish();
       }
 
       return last_img;
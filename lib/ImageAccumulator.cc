@@ -0,0 +1,109 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <ImageAccumulator.h>
+
+#include <math.h>
+#include <algorithm>
+
+using namespace degate;
+
+ImageAccumulator::ImageAccumulator(unsigned int _width, unsigned int _height,
+				   bool track_variance) :
+  width(_width),
+  height(_height),
+  num_images(0),
+  sums(num_channels * _width * _height, 0) {
+
+  if(track_variance) squares.resize(sums.size(), 0);
+}
+
+void ImageAccumulator::set_reference(ImageAccumulator const& reference, double max_deviation) {
+
+  if(reference.width != width || reference.height != height)
+    throw DegateRuntimeException("The reference accumulator differs in size.");
+  if(reference.squares.empty())
+    throw DegateRuntimeException("The reference accumulator does not track the variance.");
+
+  counts.assign(sums.size(), 0);
+  lower.resize(sums.size());
+  upper.resize(sums.size());
+  squares.clear();
+
+  for(unsigned int y = 0; y < height; y++)
+    for(unsigned int x = 0; x < width; x++)
+      for(unsigned int c = 0; c < num_channels; c++) {
+	double mean = reference.get_mean(x, y, c);
+	double range = max_deviation * reference.get_standard_deviation(x, y, c);
+	unsigned int offs = get_offset(x, y) + c;
+	lower[offs] = (unsigned char)std::max(0.0, ceil(mean - range));
+	upper[offs] = (unsigned char)std::min(255.0, floor(mean + range));
+
+	// keep at least the value next to the mean
+	if(lower[offs] > upper[offs]) lower[offs] = upper[offs] = lround(mean);
+      }
+}
+
+void ImageAccumulator::merge(ImageAccumulator const& other) {
+
+  if(other.width != width || other.height != height ||
+     other.squares.size() != squares.size() ||
+     other.counts.size() != counts.size())
+    throw DegateRuntimeException("Can't merge accumulators, that differ in size or mode.");
+
+  for(unsigned int i = 0; i < sums.size(); i++) sums[i] += other.sums[i];
+  for(unsigned int i = 0; i < squares.size(); i++) squares[i] += other.squares[i];
+  for(unsigned int i = 0; i < counts.size(); i++) counts[i] += other.counts[i];
+
+  num_images += other.num_images;
+}
+
+double ImageAccumulator::get_mean(unsigned int x, unsigned int y, unsigned int channel) const {
+
+  unsigned int offs = get_offset(x, y) + channel;
+
+  if(counts.empty())
+    return num_images == 0 ? 0 : sums[offs] / num_images;
+  else if(counts[offs] == 0) // all values were rejected
+    return (lower[offs] + upper[offs]) / 2.0;
+  else
+    return sums[offs] / counts[offs];
+}
+
+double ImageAccumulator::get_standard_deviation(unsigned int x, unsigned int y,
+						unsigned int channel) const {
+
+  if(squares.empty())
+    throw DegateRuntimeException("The accumulator does not track the variance.");
+  if(num_images == 0) return 0;
+
+  unsigned int offs = get_offset(x, y) + channel;
+  double mean = sums[offs] / num_images;
+  double variance = squares[offs] / num_images - mean * mean;
+  return variance > 0 ? sqrt(variance) : 0;
+}
+
+color_t ImageAccumulator::get_pixel(unsigned int x, unsigned int y) const {
+  return MERGE_CHANNELS(lround(get_mean(x, y, 0)),
+			lround(get_mean(x, y, 1)),
+			lround(get_mean(x, y, 2)),
+			lround(get_mean(x, y, 3)));
+}
@@ -0,0 +1,197 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __IMAGEACCUMULATOR_H__
+#define __IMAGEACCUMULATOR_H__
+
+#include <globals.h>
+#include <Image.h>
+
+#include <vector>
+#include <tr1/memory>
+
+namespace degate {
+
+  /**
+   * The ImageAccumulator averages images of the same size without keeping
+   * them in memory.
+   *
+   * Each image is folded into running per-channel sums, one pixel at a time.
+   * Pixels can be added in any order, therefore a caller may read images
+   * tile by tile or mirror them on the fly. Accumulators that were filled
+   * in different threads can be merged. Because the sums are sums of 8 bit
+   * values, they are exact and the result does not depend on the order in
+   * which images or accumulators were added.
+   *
+   * There is an optional outlier rejection, that works in two passes. The
+   * first pass collects the mean and the variance per pixel and channel. In
+   * the second pass the images are added again, but only values, that
+   * differ from the mean by at most a given number of standard deviations,
+   * are accumulated. Neither pass needs the images to be resident.
+   */
+
+  class ImageAccumulator {
+
+  private:
+
+    const static unsigned int num_channels = 4;
+
+    unsigned int width, height;
+    unsigned int num_images;
+
+    // Running sums, four channels per pixel.
+    std::vector<double> sums;
+
+    // Running sums of squared values. Only used, if the variance is tracked.
+    std::vector<double> squares;
+
+    // The number of accumulated values per channel and the accepted value
+    // range. Only used for the outlier rejection.
+    std::vector<unsigned int> counts;
+    std::vector<unsigned char> lower, upper;
+
+    unsigned int get_offset(unsigned int x, unsigned int y) const {
+      return num_channels * (y * width + x);
+    }
+
+    inline void add_value(unsigned int offs, unsigned int v) {
+      if(counts.empty()) {
+	sums[offs] += v;
+	if(!squares.empty()) squares[offs] += v * v;
+      }
+      else if(v >= lower[offs] && v <= upper[offs]) {
+	sums[offs] += v;
+	counts[offs]++;
+      }
+    }
+
+  public:
+
+    /**
+     * Create an empty accumulator.
+     * @param width The width of the accumulated images.
+     * @param height The height of the accumulated images.
+     * @param track_variance If true, the accumulator can serve as reference
+     *   for the outlier rejection.
+     */
+    ImageAccumulator(unsigned int width, unsigned int height, bool track_variance = false);
+
+    /**
+     * Enable the outlier rejection. Values, that differ by more than
+     * \p max_deviation standard deviations from the mean of the reference,
+     * are not accumulated. Channels, where all values were rejected, get the
+     * center of the accepted range. Call it before adding images.
+     * @exception DegateRuntimeException This exception is thrown, if the
+     *   reference has a different size or does not track the variance.
+     */
+    void set_reference(ImageAccumulator const& reference, double max_deviation);
+
+    unsigned int get_width() const { return width; }
+    unsigned int get_height() const { return height; }
+
+    /**
+     * Get the number of images, that were added.
+     */
+    unsigned int get_num_images() const { return num_images; }
+
+    /**
+     * Add a single pixel. Call begin_image() once per image before.
+     */
+    inline void add_pixel(unsigned int x, unsigned int y, color_t pix) {
+      unsigned int offs = get_offset(x, y);
+      add_value(offs, MASK_R(pix));
+      add_value(offs + 1, MASK_G(pix));
+      add_value(offs + 2, MASK_B(pix));
+      add_value(offs + 3, MASK_A(pix));
+    }
+
+    /**
+     * Count a new image, that is added with add_pixel(). Each pixel of
+     * an image must be added exactly once.
+     */
+    void begin_image() { num_images++; }
+
+    /**
+     * Add an image.
+     * @exception DegateRuntimeException This exception is thrown, if the
+     *   image size differs.
+     */
+    template<typename ImageType>
+    void add(std::tr1::shared_ptr<ImageType> img) {
+      if(img == NULL) throw InvalidPointerException("Invalid image pointer.");
+      if(img->get_width() != width || img->get_height() != height)
+	throw DegateRuntimeException("Can't accumulate the image, because it differs in size.");
+
+      begin_image();
+      for(unsigned int y = 0; y < height; y++)
+	for(unsigned int x = 0; x < width; x++)
+	  add_pixel(x, y, img->template get_pixel_as<color_t>(x, y));
+    }
+
+    /**
+     * Add the sums of another accumulator. Both accumulators must have
+     * the same size and the same mode.
+     * @exception DegateRuntimeException This exception is thrown, if the
+     *   accumulators are not compatible.
+     */
+    void merge(ImageAccumulator const& other);
+
+    /**
+     * Get the mean of a channel.
+     * @param x The x coordinate.
+     * @param y The y coordinate.
+     * @param channel The channel number. Channels are in the order R, G, B, A.
+     */
+    double get_mean(unsigned int x, unsigned int y, unsigned int channel) const;
+
+    /**
+     * Get the standard deviation of a channel. This requires, that
+     * the variance is tracked.
+     */
+    double get_standard_deviation(unsigned int x, unsigned int y, unsigned int channel) const;
+
+    /**
+     * Get the averaged pixel.
+     */
+    color_t get_pixel(unsigned int x, unsigned int y) const;
+
+    /**
+     * Create an image from the averaged pixels.
+     * @return Returns a NULL pointer, if no image was added.
+     */
+    template<typename ImageType>
+    std::tr1::shared_ptr<ImageType> get_image() const {
+      std::tr1::shared_ptr<ImageType> img;
+      if(num_images == 0) return img;
+
+      img = std::tr1::shared_ptr<ImageType>(new ImageType(width, height));
+      for(unsigned int y = 0; y < height; y++)
+	for(unsigned int x = 0; x < width; x++)
+	  img->template set_pixel_as<color_t>(x, y, get_pixel(x, y));
+      return img;
+    }
+  };
+
+  typedef std::tr1::shared_ptr<ImageAccumulator> ImageAccumulator_shptr;
+
+}
+
+#endif
@@ -0,0 +1,170 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <ImageArena.h>
+#include <Configuration.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+using namespace degate;
+
+ImageArena::ImageArena() :
+  cached_bytes(0),
+  num_allocated(0),
+  num_reused(0) {
+
+  Configuration const & conf = Configuration::get_instance();
+  spill_threshold = conf.get_temp_image_spill_threshold() << 20;
+  max_cached_bytes = conf.get_temp_image_pool_size() << 20;
+}
+
+ImageArena::~ImageArena() {
+  trim_locked(0);
+}
+
+unsigned int ImageArena::get_size_class(size_t bytes, size_t * block_size) {
+
+  // find the power of two, that is large enough
+  unsigned int exp = min_class_exp;
+  while((size_t(1) << exp) < bytes) exp++;
+
+  // split the range (2^(exp-1), 2^exp] into four classes
+  unsigned int sub = 3;
+  if(exp > min_class_exp) {
+    size_t step = size_t(1) << (exp - 3);
+    size_t base = size_t(1) << (exp - 1);
+    sub = (bytes - base + step - 1) / step - 1;
+  }
+
+  unsigned int size_class = (exp - min_class_exp) * 4 + sub;
+  *block_size = get_block_size(size_class);
+  return size_class;
+}
+
+size_t ImageArena::get_block_size(unsigned int size_class) {
+  unsigned int exp = min_class_exp + size_class / 4;
+  unsigned int sub = size_class % 4;
+  return (size_t(1) << (exp - 1)) + (size_t(sub + 1) << (exp - 3));
+}
+
+bool ImageArena::is_pooled_size(size_t bytes) const {
+  boost::mutex::scoped_lock lock(mtx);
+  return bytes > 0 && bytes <= spill_threshold;
+}
+
+void * ImageArena::acquire(size_t bytes) {
+
+  size_t block_size;
+  unsigned int size_class = get_size_class(bytes, &block_size);
+
+  {
+    boost::mutex::scoped_lock lock(mtx);
+
+    if(size_class < free_lists.size() && !free_lists[size_class].empty()) {
+      void * mem = free_lists[size_class].back();
+      free_lists[size_class].pop_back();
+      cached_bytes -= block_size;
+      num_reused++;
+
+      // A fresh temp image is zeroed. Only the requested size is in use.
+      memset(mem, 0, bytes);
+      return mem;
+    }
+
+    num_allocated++;
+  }
+
+  void * mem = calloc(1, block_size);
+  if(mem == NULL) throw std::bad_alloc();
+  return mem;
+}
+
+void ImageArena::release(void * mem, size_t bytes) {
+
+  if(mem == NULL) return;
+
+  size_t block_size;
+  unsigned int size_class = get_size_class(bytes, &block_size);
+
+  boost::mutex::scoped_lock lock(mtx);
+
+  if(cached_bytes + block_size > max_cached_bytes) {
+    free(mem);
+    return;
+  }
+
+  if(size_class >= free_lists.size()) free_lists.resize(size_class + 1);
+  free_lists[size_class].push_back(mem);
+  cached_bytes += block_size;
+}
+
+void ImageArena::set_spill_threshold(size_t bytes) {
+  boost::mutex::scoped_lock lock(mtx);
+  spill_threshold = bytes;
+}
+
+size_t ImageArena::get_spill_threshold() const {
+  boost::mutex::scoped_lock lock(mtx);
+  return spill_threshold;
+}
+
+void ImageArena::set_max_cached_bytes(size_t bytes) {
+  boost::mutex::scoped_lock lock(mtx);
+  max_cached_bytes = bytes;
+  trim_locked(bytes);
+}
+
+void ImageArena::trim() {
+  boost::mutex::scoped_lock lock(mtx);
+  trim_locked(0);
+}
+
+void ImageArena::trim_locked(size_t max_bytes) {
+
+  // Free large blocks first.
+  for(unsigned int c = free_lists.size(); c > 0 && cached_bytes > max_bytes; c--) {
+    std::vector<void *> & blocks = free_lists[c - 1];
+    size_t block_size = get_block_size(c - 1);
+
+    while(!blocks.empty() && cached_bytes > max_bytes) {
+      free(blocks.back());
+      blocks.pop_back();
+      cached_bytes -= block_size;
+    }
+  }
+}
+
+size_t ImageArena::get_cached_bytes() const {
+  boost::mutex::scoped_lock lock(mtx);
+  return cached_bytes;
+}
+
+unsigned long ImageArena::get_num_allocated() const {
+  boost::mutex::scoped_lock lock(mtx);
+  return num_allocated;
+}
+
+unsigned long ImageArena::get_num_reused() const {
+  boost::mutex::scoped_lock lock(mtx);
+  return num_reused;
+}
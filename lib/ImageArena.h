@@ -0,0 +1,153 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __IMAGEARENA_H__
+#define __IMAGEARENA_H__
+
+#include <SingletonBase.h>
+
+#include <vector>
+#include <stddef.h>
+#include <boost/thread/mutex.hpp>
+
+namespace degate {
+
+  /**
+   * The ImageArena provides in-memory storage for temporary images.
+   *
+   * Algorithms create many small, short-lived temporary images, e.g. a copy
+   * of each template in the template matching or an image per via in the
+   * via matching. Backing each of them with a temp file, that is mapped into
+   * memory, costs several system calls and a blocking msync(). Instead, temp
+   * images up to a size threshold take their memory from this arena. Larger
+   * images are still stored in temp files.
+   *
+   * Memory blocks are grouped into size classes. There are four classes per
+   * power of two, so a block is at most 25% larger than requested. Released
+   * blocks are kept in a free list per size class and are handed out again
+   * on the next request of the same class. The amount of memory, that is
+   * kept in free lists, is limited.
+   *
+   * The arena is thread-safe.
+   */
+
+  class ImageArena : public SingletonBase<ImageArena> {
+
+    friend class SingletonBase<ImageArena>;
+
+  private:
+
+    // smallest block size is 2^min_class_exp bytes
+    const static unsigned int min_class_exp = 8;
+
+    std::vector<std::vector<void *> > free_lists;
+
+    size_t spill_threshold;
+    size_t max_cached_bytes;
+    size_t cached_bytes;
+
+    unsigned long num_allocated;
+    unsigned long num_reused;
+
+    mutable boost::mutex mtx;
+
+    ImageArena();
+
+    /**
+     * Get the size class and the block size for a request.
+     */
+    static unsigned int get_size_class(size_t bytes, size_t * block_size);
+
+    /**
+     * Get the block size of a size class.
+     */
+    static size_t get_block_size(unsigned int size_class);
+
+    /**
+     * Free cached blocks until at most max_bytes are cached.
+     * The caller must hold the lock.
+     */
+    void trim_locked(size_t max_bytes);
+
+  public:
+
+    virtual ~ImageArena();
+
+    /**
+     * Check if a temp image with a size of \p bytes should be stored in the arena.
+     */
+    bool is_pooled_size(size_t bytes) const;
+
+    /**
+     * Get a zeroed memory block.
+     * @exception std::bad_alloc This exception is thrown, if there is no memory left.
+     */
+    void * acquire(size_t bytes);
+
+    /**
+     * Return a memory block to the arena.
+     * @param mem The memory as returned by acquire().
+     * @param bytes The size, that was passed to acquire().
+     */
+    void release(void * mem, size_t bytes);
+
+    /**
+     * Set the largest temp image size in bytes, that is stored in the arena.
+     * Larger temp images are stored in files. The default value is taken
+     * from the Configuration.
+     */
+    void set_spill_threshold(size_t bytes);
+
+    /**
+     * Get the largest temp image size in bytes, that is stored in the arena.
+     */
+    size_t get_spill_threshold() const;
+
+    /**
+     * Set the amount of released memory in bytes, that is kept for reuse.
+     */
+    void set_max_cached_bytes(size_t bytes);
+
+    /**
+     * Release all cached memory blocks.
+     */
+    void trim();
+
+    /**
+     * Get the amount of memory in bytes, that is kept for reuse.
+     */
+    size_t get_cached_bytes() const;
+
+    /**
+     * Get the number of blocks, that were allocated from the heap.
+     */
+    unsigned long get_num_allocated() const;
+
+    /**
+     * Get the number of blocks, that were taken from a free list.
+     */
+    unsigned long get_num_reused() const;
+
+  };
+
+}
+
+#endif
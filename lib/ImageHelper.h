@@ -29,6 +29,7 @@
 #include <PixelPolicies.h>
 #include <StoragePolicies.h>
 #include <Image.h>
+#include <ImageAccumulator.h>
 
 #include <set>
 #include <boost/foreach.hpp>
@@ -111,6 +112,31 @@ namespace degate {
     }
   }
 
+  /**
+   * Calculate a hash over the size and the pixels of an image. The hash
+   * is used to detect, if an image changed since it was written to a file.
+   * It is a 64 bit FNV-1a hash.
+   */
+  template<typename ImageType>
+  uint64_t get_image_hash(std::tr1::shared_ptr<ImageType> img) {
+
+    if(img == NULL) throw InvalidPointerException("invalid image pointer");
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const uint64_t prime = 0x100000001b3ULL;
+
+    uint32_t values[2] = { img->get_width(), img->get_height() };
+    for(unsigned int i = 0; i < 2; i++) hash = (hash ^ values[i]) * prime;
+
+    for(unsigned int y = 0; y < img->get_height(); y++)
+      for(unsigned int x = 0; x < img->get_width(); x++) {
+	rgba_pixel_t p = img->template get_pixel_as<rgba_pixel_t>(x, y);
+	hash = (hash ^ p) * prime;
+      }
+
+    return hash;
+  }
+
   /**
    * Save a part of an image.
    * @exception InvalidPointerException This exception is thrown, if parameter \p img represents an invalid pointer.
@@ -156,47 +182,21 @@ namespace degate {
   template<typename ImageType>
   std::tr1::shared_ptr<ImageType> merge_images(std::list<std::tr1::shared_ptr<ImageType> > const & images) {
 
-    std::tr1::shared_ptr<ImageType> new_img;
-    if(images.empty()) return new_img;
+    if(images.empty()) return std::tr1::shared_ptr<ImageType>();
 
     const std::tr1::shared_ptr<ImageType> img = images.front();
-
-    unsigned int w = img->get_width(), h = img->get_height();
-    std::vector<double> i_tmp(4 * w * h);
+    ImageAccumulator acc(img->get_width(), img->get_height());
 
     BOOST_FOREACH(const std::tr1::shared_ptr<ImageType> i, images) {
 
       // verify that all images have the same dimensions
-      if(w != i->get_width() || h != i->get_height()) 
+      if(acc.get_width() != i->get_width() || acc.get_height() != i->get_height())
 	throw DegateRuntimeException("merge_images() failed, because images differ in size.");
 
-      for(unsigned int y = 0; y < h; y++)
-      for(unsigned int x = 0; x < w; x++) {
-	color_t pix = i->template get_pixel_as<color_t>(x, y);
-	unsigned int offs = 4 * (y * w + x);
-	i_tmp[offs] += MASK_R(pix);
-	i_tmp[offs+1] += MASK_G(pix);
-	i_tmp[offs+2] += MASK_B(pix);
-	i_tmp[offs+3] += MASK_A(pix);
-      }
+      acc.add<ImageType>(i);
     }
 
-    const double elems = images.size();
-
-    new_img = std::tr1::shared_ptr<ImageType>(new GateTemplateImage(w, h));
-    assert(new_img != NULL);
-
-    for(unsigned int y = 0; y < h; y++)
-      for(unsigned int x = 0; x < w; x++) {
-	unsigned int offs = 4 * (y * w + x);
-	color_t pix = MERGE_CHANNELS(lround(i_tmp[offs] / elems),
-				     lround(i_tmp[offs+1] / elems),
-				     lround(i_tmp[offs+2] / elems),
-				     lround(i_tmp[offs+3] / elems));
-	new_img->set_pixel(x, y, pix);
-      }
-
-    return new_img;
+    return acc.get_image<ImageType>();
   }
 
 
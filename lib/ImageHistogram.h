@@ -28,17 +28,26 @@
 #include <ImageManipulation.h>
 
 #include <fstream>
+#include <vector>
+#include <math.h>
 #include <iostream>
 #include <boost/format.hpp>
 
 namespace degate {
 
+  /**
+   * A histogram over a pixel feature, e.g. the hue of a pixel.
+   *
+   * The range [from, to) is divided into classes of equal width. Class
+   * counts are stored in a flat array, so that the class of a value is
+   * computed and not searched. Values outside of the range are counted
+   * in the first or the last class.
+   */
   template<typename KeyType, typename ValueType>
   class ImageHistogram {
 
   private:
-    typedef std::map<KeyType, ValueType> map_type;
-    map_type histogram;
+    std::vector<unsigned int> histogram;
     unsigned int counts;
 
     double from, to, class_width;
@@ -60,56 +69,71 @@ namespace degate {
 	throw DegateRuntimeException("Bounding box has zero size");
     }
 
-    KeyType to_class(ValueType v, ValueType from, ValueType to, ValueType class_width) const {
-      //unsigned int classes = (to - from) / class_width;
-      //unsigned int class_num = v / class_width;
-      //KeyType cl = v * class_width;
-
-      unsigned int c = 0;
-      for(ValueType i = from; i < to; i+= class_width, c++) {
-	if(v >= (ValueType)c*class_width && v < (ValueType)(c+1)*class_width)
-	  return (ValueType)c*class_width;
-      }
-
-    }
-
   public:
 
     ImageHistogram(double _from, double _to, double _class_width) :
       counts(0),
       from(_from),
       to(_to),
-      class_width(_class_width) {}
+      class_width(_class_width) {
+
+      // The epsilon avoids an additional class for rounding errors, e.g. for 1 / 0.01.
+      unsigned int num_classes = (unsigned int)ceil((to - from) / class_width - 1e-9);
+      histogram.assign(std::max(num_classes, 1U), 0);
+    }
 
     virtual ~ImageHistogram() {}
 
+    /**
+     * Get the number of classes.
+     */
+    unsigned int get_num_classes() const { return histogram.size(); }
+
+    /**
+     * Get the class for a value.
+     */
+    inline unsigned int get_class(KeyType v) const {
+      double c = floor((v - from) / class_width);
+      if(c <= 0) return 0;
+      else if(c >= histogram.size()) return histogram.size() - 1;
+      else return (unsigned int)c;
+    }
+
+    /**
+     * Get the relative frequency of a class.
+     */
+    inline ValueType get_class_frequency(unsigned int c) const {
+      if(counts == 0) return 0;
+      else return histogram[c] / (double)counts;
+    }
+
     virtual void add(KeyType k) {
-      histogram[to_class(k, from, to, class_width)] += 1;
+      histogram[get_class(k)] += 1;
       counts++;
     }
 
     virtual ValueType get(KeyType k) const {
-      if(counts == 0) return 0;
-
-      else {
-	typename map_type::const_iterator found = histogram.find(to_class(k, from, to, class_width));
-	if(found == histogram.end()) return 0;
-	else return (*found).second / (double)counts;
-      }
+      return get_class_frequency(get_class(k));
     }
 
     virtual ValueType get_for_rgb(rgba_pixel_t) const = 0;
 
+    /**
+     * Get the class of the feature value of a pixel.
+     */
+    virtual unsigned int get_class_for_rgb(rgba_pixel_t) const = 0;
+
     virtual void save_histogram(std::string const& path) const {
 
       std::ofstream histogram_file;
       histogram_file.open(path.c_str());
 
       if(counts > 0)
-	for(typename map_type::const_iterator iter = histogram.begin(); iter != histogram.end(); ++iter) {
-	  double frequency = (*iter).second / (double)counts;
-	  histogram_file << (*iter).first << " " << frequency << std::endl;
-	}
+	for(unsigned int c = 0; c < histogram.size(); c++)
+	  if(histogram[c] > 0) {
+	    double frequency = histogram[c] / (double)counts;
+	    histogram_file << (from + c * class_width) << " " << frequency << std::endl;
+	  }
 
       histogram_file.close();
     }
@@ -141,6 +165,10 @@ namespace degate {
       return get(rgba_to_hue(pixel));
     }
 
+    virtual unsigned int get_class_for_rgb(rgba_pixel_t pixel) const {
+      return get_class(rgba_to_hue(pixel));
+    }
+
   };
 
 
@@ -166,13 +194,17 @@ namespace degate {
       return get(rgba_to_saturation(pixel));
     }
 
+    virtual unsigned int get_class_for_rgb(rgba_pixel_t pixel) const {
+      return get_class(rgba_to_saturation(pixel));
+    }
+
   };
 
   class LightnessImageHistogram : public ImageHistogram<double, double> {
 
   public:
 
-    LightnessImageHistogram() : ImageHistogram<double, double>(0, 255, 1) {}
+    LightnessImageHistogram() : ImageHistogram<double, double>(0, 256, 1) {}
 
     template<class ImageType>
     void add_area(std::tr1::shared_ptr<ImageType> img, BoundingBox const& bb) {
@@ -189,6 +221,10 @@ namespace degate {
       return get(rgba_to_lightness(pixel));
     }
 
+    virtual unsigned int get_class_for_rgb(rgba_pixel_t pixel) const {
+      return get_class(rgba_to_lightness(pixel));
+    }
+
   };
 
 
@@ -197,7 +233,7 @@ namespace degate {
 
   public:
 
-    RedChannelImageHistogram() : ImageHistogram<double, double>(0, 255, 1) {}
+    RedChannelImageHistogram() : ImageHistogram<double, double>(0, 256, 1) {}
 
     template<class ImageType>
     void add_area(std::tr1::shared_ptr<ImageType> img, BoundingBox const& bb) {
@@ -216,6 +252,10 @@ namespace degate {
       return get(MASK_R(pixel));
     }
 
+    virtual unsigned int get_class_for_rgb(rgba_pixel_t pixel) const {
+      return get_class(MASK_R(pixel));
+    }
+
   };
 
 
@@ -224,7 +264,7 @@ namespace degate {
 
   public:
 
-    GreenChannelImageHistogram() : ImageHistogram<double, double>(0, 255, 1) {}
+    GreenChannelImageHistogram() : ImageHistogram<double, double>(0, 256, 1) {}
 
     template<class ImageType>
     void add_area(std::tr1::shared_ptr<ImageType> img, BoundingBox const& bb) {
@@ -241,6 +281,10 @@ namespace degate {
       return get(MASK_G(pixel));
     }
 
+    virtual unsigned int get_class_for_rgb(rgba_pixel_t pixel) const {
+      return get_class(MASK_G(pixel));
+    }
+
   };
 
 
@@ -249,7 +293,7 @@ namespace degate {
 
   public:
 
-    BlueChannelImageHistogram() : ImageHistogram<double, double>(0, 255, 1) {}
+    BlueChannelImageHistogram() : ImageHistogram<double, double>(0, 256, 1) {}
 
     template<class ImageType>
     void add_area(std::tr1::shared_ptr<ImageType> img, BoundingBox const& bb) {
@@ -267,6 +311,10 @@ namespace degate {
       return get(MASK_B(pixel));
     }
 
+    virtual unsigned int get_class_for_rgb(rgba_pixel_t pixel) const {
+      return get_class(MASK_B(pixel));
+    }
+
 
   };
 
@@ -0,0 +1,146 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __LRUCACHE_H__
+#define __LRUCACHE_H__
+
+#include <list>
+#include <map>
+#include <utility>
+
+namespace degate {
+
+  /**
+   * A key-value cache with a fixed capacity, that evicts the least
+   * recently used entry.
+   *
+   * The cache does not own resources. If an entry is evicted, it is
+   * handed back to the caller, who is responsible for releasing it,
+   * e.g. for deleting an OpenGL texture.
+   */
+
+  template<typename KeyType, typename ValueType>
+  class LRUCache {
+
+  public:
+
+    typedef std::pair<KeyType, ValueType> value_type;
+    typedef std::list<value_type> list_type;
+    typedef typename list_type::iterator iterator;
+    typedef typename list_type::const_iterator const_iterator;
+
+  private:
+
+    // The most recently used entry is at the front.
+    list_type entries;
+    std::map<KeyType, iterator> index;
+    unsigned int capacity;
+
+  public:
+
+    /**
+     * Create a cache.
+     * @param capacity The maximum number of entries. Must be at least 1.
+     */
+    LRUCache(unsigned int capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+    unsigned int get_capacity() const { return capacity; }
+    unsigned int size() const { return index.size(); }
+    bool empty() const { return index.empty(); }
+
+    /**
+     * Iterate over entries from the most to the least recently used one.
+     */
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+    /**
+     * Check if there is an entry for a key. This does not mark the entry as used.
+     */
+    bool contains(KeyType const& key) const {
+      return index.find(key) != index.end();
+    }
+
+    /**
+     * Look up an entry and mark it as the most recently used one.
+     * @return Returns true, if the entry was found.
+     */
+    bool get(KeyType const& key, ValueType & value) {
+      typename std::map<KeyType, iterator>::iterator found = index.find(key);
+      if(found == index.end()) return false;
+
+      entries.splice(entries.begin(), entries, found->second);
+      value = found->second->second;
+      return true;
+    }
+
+    /**
+     * Insert or replace an entry. The entry becomes the most recently used one.
+     * @param evicted If an entry had to be dropped, it is stored here. If an
+     *   entry with the same key existed, the old entry is stored here.
+     * @return Returns true, if an entry was dropped.
+     */
+    bool insert(KeyType const& key, ValueType const& value, value_type & evicted) {
+      bool dropped = false;
+
+      typename std::map<KeyType, iterator>::iterator found = index.find(key);
+      if(found != index.end()) {
+	evicted = *found->second;
+	entries.erase(found->second);
+	index.erase(found);
+	dropped = true;
+      }
+      else if(index.size() >= capacity) {
+	evicted = entries.back();
+	index.erase(entries.back().first);
+	entries.pop_back();
+	dropped = true;
+      }
+
+      entries.push_front(value_type(key, value));
+      index[key] = entries.begin();
+      return dropped;
+    }
+
+    /**
+     * Remove an entry.
+     * @return Returns true, if there was an entry for the key.
+     */
+    bool erase(KeyType const& key) {
+      typename std::map<KeyType, iterator>::iterator found = index.find(key);
+      if(found == index.end()) return false;
+      entries.erase(found->second);
+      index.erase(found);
+      return true;
+    }
+
+    void clear() {
+      entries.clear();
+      index.clear();
+    }
+
+  };
+
+}
+
+#endif
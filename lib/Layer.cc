@@ -22,6 +22,7 @@
 #include <degate.h>
 #include <Layer.h>
 #include <boost/format.hpp>
+#include <boost/foreach.hpp>
 
 using namespace degate;
 
@@ -39,9 +40,14 @@ void Layer::add_object(std::tr1::shared_ptr<PlacedLogicModelObject> o) {
     throw DegateRuntimeException("Failed to insert object into quadtree.");
   }
   objects[o->get_object_id()] = o;
+
+  BOOST_FOREACH(LayerChangeListener * l, change_listeners) l->notify_object_added(o);
 }
 
 void Layer::remove_object(std::tr1::shared_ptr<PlacedLogicModelObject> o) {
+
+  BOOST_FOREACH(LayerChangeListener * l, change_listeners) l->notify_object_removed(o);
+
   if(RET_IS_NOT_OK(quadtree.remove(o))) {
     debug(TM, "Failed to remove object from quadtree.");
     throw std::runtime_error("Failed to remove object from quadtree.");
@@ -225,6 +231,27 @@ void Layer::notify_shape_change(object_id_t object_id) {
 				    "The object is not in the layer.");
 
   quadtree.notify_shape_change((*iter).second);
+
+  BOOST_FOREACH(LayerChangeListener * l, change_listeners) l->notify_object_changed((*iter).second);
+}
+
+void Layer::notify_appearance_change(object_id_t object_id) {
+
+  if(change_listeners.empty()) return;
+
+  object_collection::iterator iter = objects.find(object_id);
+  if(iter != objects.end()) {
+    BOOST_FOREACH(LayerChangeListener * l, change_listeners) l->notify_object_changed((*iter).second);
+  }
+}
+
+void Layer::add_change_listener(LayerChangeListener * listener) {
+  if(listener == NULL) throw InvalidPointerException("Invalid listener passed to add_change_listener().");
+  change_listeners.push_back(listener);
+}
+
+void Layer::remove_change_listener(LayerChangeListener * listener) {
+  change_listeners.remove(listener);
 }
 
 
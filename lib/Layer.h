@@ -30,12 +30,41 @@
 
 #include "Image.h"
 #include "ScalingManager.h"
+#include "DenseObjectMap.h"
 
 #include <set>
+#include <list>
 #include <stdexcept>
 
 namespace degate {
 
+  /**
+   * Interface for classes, that want to be informed about changes of
+   * logic model objects placed on a layer.
+   * @see Layer::add_change_listener()
+   */
+  class LayerChangeListener {
+  public:
+
+    virtual ~LayerChangeListener() {}
+
+    /**
+     * Called after an object was added to the layer.
+     */
+    virtual void notify_object_added(PlacedLogicModelObject_shptr o) = 0;
+
+    /**
+     * Called before an object is removed from the layer.
+     */
+    virtual void notify_object_removed(PlacedLogicModelObject_shptr o) = 0;
+
+    /**
+     * Called after the shape or the appearance of an object changed.
+     */
+    virtual void notify_object_changed(PlacedLogicModelObject_shptr o) = 0;
+  };
+
+
   /**
    * Representation of a chip layer.
    */
@@ -72,7 +101,7 @@ namespace degate {
     std::tr1::shared_ptr<ScalingManager<BackgroundImage> > scaling_manager;
 
     // store shared pointers to objects, that belong to the layer
-    typedef std::map<object_id_t, PlacedLogicModelObject_shptr> object_collection;
+    typedef DenseObjectMap<PlacedLogicModelObject_shptr> object_collection;
     object_collection objects;
 
     bool enabled;
@@ -80,6 +109,8 @@ namespace degate {
 
     layer_id_t layer_id;
 
+    std::list<LayerChangeListener *> change_listeners;
+
   protected:
 
     /**
@@ -292,6 +323,29 @@ namespace degate {
 
     void notify_shape_change(object_id_t object_id);
 
+    /**
+     * Notify the layer that the appearance of a logic model object changed,
+     * e.g. its highlighting or connection state. This does not touch the
+     * quadtree, it only informs the change listeners. Unknown object IDs are
+     * ignored.
+     */
+
+    void notify_appearance_change(object_id_t object_id);
+
+    /**
+     * Register a listener, that is informed about object changes on this layer.
+     * The layer does not take ownership of the listener. The listener must
+     * deregister itself, before it is destroyed.
+     */
+
+    void add_change_listener(LayerChangeListener * listener);
+
+    /**
+     * Deregister a change listener.
+     */
+
+    void remove_change_listener(LayerChangeListener * listener);
+
     /**
      * Get an object at a specific position.
      * If multiple objects are placed at coordinate \p x, \p y, then the first
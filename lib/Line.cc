@@ -31,9 +31,7 @@ Line::Line() :
   from_y(0),
   to_x(0),
   to_y(0),
-  diameter(0),
-  d_x(0),
-  d_y(0) {
+  diameter(0) {
   calculate_bounding_box();
 }
 
@@ -42,47 +40,25 @@ Line::Line(int _from_x, int _from_y, int _to_x, int _to_y, unsigned int _diamete
   from_y(_from_y),
   to_x(_to_x),
   to_y(_to_y),
-  diameter(_diameter),
-  d_x(_to_x - _from_x),
-  d_y(_to_y - _from_y) {
+  diameter(_diameter) {
   calculate_bounding_box();
 }
 
 bool Line::in_shape(int x, int y, int max_distance) const {
 
-  /*
-    How to check if a point is on a line:
-    y = m*x + n
-    m = dy / dx
-    n = y0 - m*x0
-    y' = m*x' + n
-
-    |y' - y| < epsilon?
-  */
-
   /*
     Check if it is a vertical line (dy ~~ 0). If it is true, the bounding box
     describes the line. The same applies to horiontal lines.
+
+    Otherwise the point must be within half of the diameter from the
+    center line.
   */
 
   if(is_vertical() || is_horizontal()) {
     return bounding_box.in_shape(x, y, max_distance);
   }
   else {
-
-    // check if x is outside the x-range
-    if(x < std::min(from_x,to_x) ||
-       x > std::max(from_x, to_x))
-       return false;
-
-    double m = d_y / d_x;
-    double n = (double)from_y - m * (double)from_x;
-    double y_dash = m * (double) x + n;
-
-    if(fabs(y_dash - y) <= diameter / 2 + max_distance)
-      return true;
-    else
-      return false;
+    return geo_distance_sq(get_geo_segment(), x, y) <= geo_sqr((double)(diameter / 2 + max_distance));
   }
 }
 
@@ -130,25 +106,21 @@ int Line::get_to_y() const {
 
 void Line::set_from_x(int from_x) {
   this->from_x = from_x;
-  d_x = to_x - from_x;
   calculate_bounding_box();
 }
 
 void Line::set_to_x(int to_x) {
   this->to_x = to_x;
-  d_x = to_x - from_x;
   calculate_bounding_box();
 }
 
 void Line::set_from_y(int from_y) {
   this->from_y = from_y;
-  d_y = to_y - from_y;
   calculate_bounding_box();
 }
 
 void Line::set_to_y(int to_y) {
   this->to_y = to_y;
-  d_y = to_y - from_y;
   calculate_bounding_box();
 }
 
@@ -25,6 +25,7 @@
 #include <BoundingBox.h>
 #include <Shape.h>
 #include <Point.h>
+#include <Geometry.h>
 
 namespace degate {
 
@@ -34,8 +35,6 @@ namespace degate {
     int from_x, from_y, to_x, to_y;
     unsigned int diameter;
 
-    double d_x, d_y;
-
     BoundingBox bounding_box;
 
   private:
@@ -89,6 +88,13 @@ namespace degate {
     virtual void set_p1(Point const& p);
     virtual void set_p2(Point const& p);
 
+    /**
+     * Get the line as a record for the geometry kernel.
+     */
+    GeoSegment get_geo_segment() const {
+      return make_geo_segment(from_x, from_y, to_x, to_y, diameter);
+    }
+
   };
 
 }
@@ -32,6 +32,8 @@
 #include <GateLibrary.h>
 
 #include <LogicModel.h>
+#include <NetlistGraph.h>
+#include <LogicModelIndex.h>
 
 #include <boost/foreach.hpp>
 
@@ -121,6 +123,8 @@ LogicModel::LogicModel(unsigned int width, unsigned int height, unsigned int lay
   if(layers > 0)
     set_current_layer(0);
 
+  index = LogicModelIndex_shptr(new LogicModelIndex(this));
+
 }
 
 LogicModel::~LogicModel() {
@@ -243,6 +247,14 @@ void LogicModel::add_object(int layer_pos, PlacedLogicModelObject_shptr o) {
   if(!o->has_valid_object_id()) o->set_object_id(get_new_object_id());
   object_id_t object_id = o->get_object_id();
 
+  // Check before the object is added to any collection.
+  if(objects.find(object_id) != objects.end()) {
+    std::ostringstream stm;
+    stm << "Logic model object with id " << object_id << " is already stored in the logic model.";
+    std::cout << stm.str() << std::endl;
+    throw DegateLogicException(stm.str());
+  }
+
   if(Gate_shptr gate = std::tr1::dynamic_pointer_cast<Gate>(o))
     add_gate(layer_pos, gate);
   else if(Wire_shptr wire = std::tr1::dynamic_pointer_cast<Wire>(o))
@@ -257,22 +269,18 @@ void LogicModel::add_object(int layer_pos, PlacedLogicModelObject_shptr o) {
 
   // if it is a RemoteObject, update remote-to-local-id mapping
   if(RemoteObject_shptr ro = std::tr1::dynamic_pointer_cast<RemoteObject>(o)) {
-    update_roid_mapping(ro->get_remote_object_id(), o->get_object_id());
+    if(ro->has_remote_object_id())
+      update_roid_mapping(ro->get_remote_object_id(), o->get_object_id());
+    else
+      unpushed_remote_oids.insert(o->get_object_id());
   }
 
-  if(objects.find(object_id) != objects.end()) {
-    std::ostringstream stm;
-    stm << "Logic model object with id " << object_id << " is already stored in the logic model.";
-    std::cout << stm.str() << std::endl;
-    throw DegateLogicException(stm.str());
-  }
-  else {
-    objects[object_id] = o;
-    Layer_shptr layer = get_create_layer(layer_pos);
-    assert(layer != NULL);
-    o->set_layer(layer);
-    layer->add_object(o);
-  }
+  objects[object_id] = o;
+  Layer_shptr layer = get_create_layer(layer_pos);
+  assert(layer != NULL);
+  o->set_layer(layer);
+  layer->add_object(o);
+
   assert(objects.find(object_id) != objects.end());
 
 }
@@ -284,33 +292,17 @@ void LogicModel::remove_remote_object(object_id_t remote_id) {
   if(remote_id == 0)
     throw InvalidObjectIDException("Parameter passed to remove_remote_object() is invalid.");
 
-  debug(TM, "Should remove object with remote ID %d from lmodel - 2.", remote_id);
+  object_id_t local_id = get_local_oid_for_roid(remote_id);
+  if(local_id == 0) return;
 
-  BOOST_FOREACH(object_collection::value_type const& p, objects) {
+  object_collection::iterator found = objects.find(local_id);
+  if(found == objects.end()) return;
 
-    PlacedLogicModelObject_shptr plo = p.second;
-    RemoteObject_shptr ro;
+  debug(TM, "Removed object with remote ID %d and local ID = %d from lmodel.",
+	remote_id, local_id);
+  remove_object(found->second, false);
 
-    if((ro = std::tr1::dynamic_pointer_cast<RemoteObject>(plo))) {
-
-      object_id_t local_id = plo->get_object_id();
-
-	debug(TM, "found remote object with remote ID %d and local ID = %d.",
-	      ro->get_remote_object_id(), local_id);
-
-	if(ro->get_remote_object_id() == remote_id) {
-
-	  debug(TM, "Removed object with remote ID %d and local ID = %d from lmodel.",
-		remote_id, local_id);
-	  remove_object(plo, false);
-
-	  object_collection::iterator found = objects.find(local_id);
-	  assert(found == objects.end());
-
-	  return;
-	}
-    }
-  }
+  assert(objects.find(local_id) == objects.end());
 }
 
 void LogicModel::remove_object(PlacedLogicModelObject_shptr o, bool add_to_remove_list) {
@@ -342,11 +334,14 @@ void LogicModel::remove_object(PlacedLogicModelObject_shptr o, bool add_to_remov
 
 
     if(RemoteObject_shptr ro = std::tr1::dynamic_pointer_cast<RemoteObject>(o)) {
-      // remember to send a was-removed-message to the collaboration server
-      if(add_to_remove_list) removed_remote_oids.push_back(ro->get_remote_object_id());
+      if(ro->has_remote_object_id()) {
+	// remember to send a was-removed-message to the collaboration server
+	if(add_to_remove_list) removed_remote_oids.push_back(ro->get_remote_object_id());
 
-      // remove entry from remote-to-local-id mapping
-      roid_mapping.erase(ro->get_remote_object_id());
+	// remove entry from remote-to-local-id mapping
+	roid_mapping.erase(ro->get_remote_object_id());
+      }
+      else unpushed_remote_oids.erase(o->get_object_id());
     }
 
     layer->remove_object(o);
@@ -385,14 +380,9 @@ void LogicModel::remove_gate_template(GateTemplate_shptr tmpl) {
 void LogicModel::remove_template_references(GateTemplate_shptr tmpl) {
   if(gate_library == NULL)
     throw DegateLogicException("You can't remove a gate template, if there is no gate library.");
-  for(gate_collection::iterator iter = gates_begin();
-      iter != gates.end(); ++iter) {
-    Gate_shptr gate = (*iter).second;
-    if(gate->get_gate_template() == tmpl) {
-      remove_gate_ports(gate);
-      gate->remove_template();
-    }
-
+  BOOST_FOREACH(Gate_shptr gate, index->get_gates_by_template(tmpl)) {
+    remove_gate_ports(gate);
+    gate->remove_template();
   }
 }
 
@@ -400,15 +390,7 @@ void LogicModel::remove_template_references(GateTemplate_shptr tmpl) {
 void LogicModel::remove_gates_by_template_type(GateTemplate_shptr tmpl) {
   if(tmpl == NULL) throw InvalidPointerException("The gate template pointer is invalid.");
 
-  std::list<Gate_shptr> gates_to_remove;
-
-  for(gate_collection::iterator iter = gates_begin();
-      iter != gates_end(); ++iter) {
-    Gate_shptr gate = (*iter).second;
-
-    if(gate->get_gate_template() == tmpl)
-      gates_to_remove.push_back(gate);
-  }
+  std::list<Gate_shptr> gates_to_remove = index->get_gates_by_template(tmpl);
 
   while(!gates_to_remove.empty()) {
     remove_object(gates_to_remove.front());
@@ -440,6 +422,9 @@ void LogicModel::update_ports(Gate_shptr gate) {
 
   debug(TM, "update ports on gate %d", gate->get_object_id());
 
+  // The template or the port directions might have changed.
+  if(netlist_graph != NULL) netlist_graph->invalidate();
+
   // in a first iteration over all template ports from the corresponding template
   // we check if there are gate ports to add
   if(gate->has_template()) {
@@ -524,17 +509,21 @@ void LogicModel::update_ports(GateTemplate_shptr gate_template) {
   if(gate_template == NULL)
     throw InvalidPointerException("Invalid parameter for update_ports()");
 
-  // iterate over all gates ...
-  for(gate_collection::iterator g_iter = gates.begin();
-      g_iter != gates.end(); ++g_iter) {
-    Gate_shptr gate = (*g_iter).second;
-    if(gate->get_gate_template() == gate_template) {
-      debug(TM, "update ports on gate with id %d", gate->get_object_id());
-      update_ports(gate);
-    }
+  // iterate over the gates, that use the template
+  BOOST_FOREACH(Gate_shptr gate, index->get_gates_by_template(gate_template)) {
+    debug(TM, "update ports on gate with id %d", gate->get_object_id());
+    update_ports(gate);
   }
 }
 
+void LogicModel::update_template(GateTemplate_shptr gate_template) {
+
+  if(gate_template == NULL)
+    throw InvalidPointerException("Invalid parameter for update_template()");
+
+  if(netlist_graph != NULL) netlist_graph->update_template(gate_template);
+}
+
 
 layer_id_t LogicModel::get_new_layer_id() {
   return get_new_object_id();
@@ -553,6 +542,10 @@ void LogicModel::add_layer(layer_position_t pos, Layer_shptr new_layer) {
     new_layer->set_layer_pos(pos);
   }
 
+  if(index != NULL) index->sync_layers();
+
+  if(netlist_graph != NULL) netlist_graph->invalidate();
+
   if(current_layer == NULL) current_layer = get_layer(0);
   if(current_layer == NULL) current_layer = new_layer;
 }
@@ -603,6 +596,10 @@ void LogicModel::set_layers(layer_collection layers) {
 
   // set new layers
   this->layers = layers;
+
+  if(index != NULL) index->sync_layers();
+
+  if(netlist_graph != NULL) netlist_graph->invalidate();
 }
 
 void LogicModel::remove_layer(layer_position_t pos) {
@@ -627,6 +624,10 @@ void LogicModel::remove_layer(Layer_shptr layer) {
   layers.erase(remove(layers.begin(), layers.end(), layer),
 	       layers.end());
 
+  if(index != NULL) index->sync_layers();
+
+  if(netlist_graph != NULL) netlist_graph->invalidate();
+
 }
 
 void LogicModel::set_current_layer(layer_position_t pos) {
@@ -658,6 +659,8 @@ void LogicModel::add_net(Net_shptr net) {
     throw DegateRuntimeException(f.str());
   }
   nets[net->get_object_id()] = net;
+
+  if(netlist_graph != NULL) netlist_graph->invalidate();
 }
 
 
@@ -705,9 +708,27 @@ void LogicModel::remove_net(Net_shptr net) {
     //nets[net->get_object_id()].reset();
     size_t n = nets.erase(net->get_object_id());
     assert(n == 1);
+
+    if(netlist_graph != NULL) netlist_graph->invalidate();
   }
 }
 
+std::vector<object_id_t> LogicModel::get_ordered_object_ids() const {
+  return objects.get_ordered_keys();
+}
+
+std::vector<object_id_t> LogicModel::get_ordered_gate_ids() const {
+  return gates.get_ordered_keys();
+}
+
+std::vector<object_id_t> LogicModel::get_ordered_emarker_ids() const {
+  return emarkers.get_ordered_keys();
+}
+
+std::vector<object_id_t> LogicModel::get_ordered_net_ids() const {
+  return nets.get_ordered_keys();
+}
+
 LogicModel::object_collection::iterator LogicModel::objects_begin() {
   return objects.begin();
 }
@@ -732,6 +753,14 @@ LogicModel::via_collection::iterator LogicModel::vias_end() {
   return vias.end();
 }
 
+LogicModel::emarker_collection::iterator LogicModel::emarkers_begin() {
+  return emarkers.begin();
+}
+
+LogicModel::emarker_collection::iterator LogicModel::emarkers_end() {
+  return emarkers.end();
+}
+
 LogicModel::layer_collection::iterator LogicModel::layers_begin() {
   return layers.begin();
 }
@@ -770,16 +799,36 @@ void LogicModel::set_main_module(Module_shptr main_module) {
   main_module->set_main_module(); // set the root-node-state
 }
 
+LogicModelIndex const& LogicModel::get_index() const {
+  return *index;
+}
+
+NetlistGraph_shptr LogicModel::get_netlist_graph() {
+  if(netlist_graph == NULL) netlist_graph = NetlistGraph_shptr(new NetlistGraph(this));
+  netlist_graph->update();
+  return netlist_graph;
+}
+
 void LogicModel::reset_removed_remote_objetcs_list() {
   removed_remote_oids.clear();
 }
 
+void LogicModel::pop_removed_remote_objects(size_t n) {
+  for(size_t i = 0; i < n && !removed_remote_oids.empty(); i++)
+    removed_remote_oids.pop_front();
+}
+
 std::list<object_id_t> const & LogicModel::get_removed_remote_objetcs_list() {
   return removed_remote_oids;
 }
 
 void LogicModel::update_roid_mapping(object_id_t remote_oid, object_id_t local_oid) {
   roid_mapping[remote_oid] = local_oid;
+  unpushed_remote_oids.erase(local_oid);
+}
+
+std::set<object_id_t> const & LogicModel::get_unpushed_remote_objects() const {
+  return unpushed_remote_oids;
 }
 
 object_id_t LogicModel::get_local_oid_for_roid(object_id_t remote_oid) {
@@ -40,6 +40,7 @@
 #include <GateLibrary.h>
 #include <Annotation.h>
 #include <Module.h>
+#include <DenseObjectMap.h>
 
 #include <tr1/memory>
 #include <set>
@@ -61,13 +62,20 @@ namespace degate {
 
   public:
 
-    typedef std::map<object_id_t, PlacedLogicModelObject_shptr> object_collection;
-    typedef std::map<object_id_t, Net_shptr> net_collection;
-    typedef std::map<object_id_t, Annotation_shptr> annotation_collection;
-    typedef std::map<object_id_t, Via_shptr > via_collection;
+    /*
+     * The object collections are hash maps. They are not sorted by
+     * object ID. Use get_ordered_object_ids() and friends, if you need
+     * a deterministic order.
+     */
+    typedef DenseObjectMap<PlacedLogicModelObject_shptr> object_collection;
+    typedef DenseObjectMap<Net_shptr> net_collection;
+    typedef DenseObjectMap<Annotation_shptr> annotation_collection;
+    typedef DenseObjectMap<Via_shptr> via_collection;
+    typedef DenseObjectMap<Wire_shptr> wire_collection;
+    typedef DenseObjectMap<EMarker_shptr> emarker_collection;
 
     typedef std::vector<Layer_shptr> layer_collection;
-    typedef std::map<object_id_t, Gate_shptr > gate_collection;
+    typedef DenseObjectMap<Gate_shptr> gate_collection;
 
   private:
 
@@ -79,9 +87,9 @@ namespace degate {
     std::tr1::shared_ptr<GateLibrary> gate_library; // x
 
     gate_collection gates;
-    std::map<object_id_t, Wire_shptr > wires;
+    wire_collection wires;
     via_collection vias;
-    std::map<object_id_t, EMarker_shptr > emarkers;
+    emarker_collection emarkers;
     annotation_collection annotations;
     net_collection nets;
     Module_shptr main_module;
@@ -110,8 +118,25 @@ namespace degate {
      */
     roid_mapping_t roid_mapping;
 
+    /**
+     * Local OIDs of remote objects, that were not pushed to the server yet.
+     */
+    std::set<object_id_t> unpushed_remote_oids;
+
     diameter_t port_diameter; 
 
+    /**
+     * The connectivity graph. It is created on demand. It is declared last,
+     * because it must be destroyed before the layers.
+     */
+    NetlistGraph_shptr netlist_graph;
+
+    /**
+     * Secondary indices for names, descriptions and gate templates.
+     * Like the connectivity graph, it must be destroyed before the layers.
+     */
+    LogicModelIndex_shptr index;
+
   private:
 
     /**
@@ -489,6 +514,28 @@ namespace degate {
     void remove_net(Net_shptr net);
 
 
+    /**
+     * Get the IDs of all placeable objects in ascending order. Iterate over
+     * them instead of the object collection, if the order must be stable,
+     * e.g. for exporting data.
+     */
+    std::vector<object_id_t> get_ordered_object_ids() const;
+
+    /**
+     * Get the IDs of all gates in ascending order.
+     */
+    std::vector<object_id_t> get_ordered_gate_ids() const;
+
+    /**
+     * Get the IDs of all emarkers in ascending order.
+     */
+    std::vector<object_id_t> get_ordered_emarker_ids() const;
+
+    /**
+     * Get the IDs of all nets in ascending order.
+     */
+    std::vector<object_id_t> get_ordered_net_ids() const;
+
     /**
      * Get a iterator to iterate over all placeable objects.
      */
@@ -528,6 +575,18 @@ namespace degate {
 
     via_collection::iterator vias_end();
 
+    /**
+     * Get a iterator to iterate over all emarkers.
+     */
+
+    emarker_collection::iterator emarkers_begin();
+
+    /**
+     * Get an end iterator for the iteration over all emarkers.
+     */
+
+    emarker_collection::iterator emarkers_end();
+
     /**
      * Get a iterator to iterate over all placeable objects.
      */
@@ -595,6 +654,15 @@ namespace degate {
 
     void update_ports(GateTemplate_shptr gate_template);
 
+    /**
+     * Make relevant updates in the logic model after the port types or
+     * the logic class of a gate template changed. Template objects are
+     * not placed on a layer, therefore such changes are not reported via
+     * the layers' change listeners.
+     */
+
+    void update_template(GateTemplate_shptr gate_template);
+
 
     /**
      * Get the main module.
@@ -607,15 +675,50 @@ namespace degate {
      */
     void set_main_module(Module_shptr main_module);
 
+    /**
+     * Get the connectivity graph of gates, gate ports and nets. The graph is
+     * created on the first call and rebuilt, if the netlist changed since the
+     * last call. Use it for netlist analyses instead of walking nets and
+     * looking up objects.
+     * @see NetlistGraph
+     */
+    NetlistGraph_shptr get_netlist_graph();
+
+    /**
+     * Get the secondary indices. Use them to look up objects by name or
+     * description or gates by their template instead of walking all objects.
+     * @see LogicModelIndex
+     */
+    LogicModelIndex const& get_index() const;
+
     /**
      *
      */
     void reset_removed_remote_objetcs_list();
 
+    /**
+     * Drop the first entries from the list of removed remote objects,
+     * because their removal was pushed to the server.
+     * @param n The number of entries. If there are less entries, the list
+     *   is cleared.
+     */
+    void pop_removed_remote_objects(size_t n);
+
     std::list<object_id_t> const & get_removed_remote_objetcs_list();
 
+    /**
+     * Map a remote OID to a local OID. The local object is considered
+     * as pushed to the server afterwards.
+     */
     void update_roid_mapping(object_id_t remote_oid, object_id_t local_oid);
 
+    /**
+     * Get the local OIDs of remote objects, that have no remote OID yet.
+     * The collection is maintained when objects are added or removed, so
+     * there is no need to walk all objects to find them.
+     */
+    std::set<object_id_t> const & get_unpushed_remote_objects() const;
+
     object_id_t get_local_oid_for_roid(object_id_t remote_oid);
 
 
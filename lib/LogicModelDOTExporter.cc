@@ -32,21 +32,55 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <fstream>
 #include <stdexcept>
 #include <list>
 #include <tr1/memory>
+#include <algorithm>
 
 using namespace std;
 using namespace degate;
 
+namespace {
+
+    /**
+     * Check if a connection is a likely source of a signal.
+     */
+    bool is_source_connection(std::string const& name) {
+        return name != "a"
+            && name != "b"
+            && name != "c"
+            && name != "d"
+            && name != "e"
+            && name != "f"
+            && name != "D"
+            && name != "1"
+            && name != "0"
+            && name != "rst"
+            && name != "";
+    }
+
+}
+
 void LogicModelDOTExporter::export_data(
     std::string const& filename
     , LogicModel_shptr lmodel
+) {
+    std::ofstream dot_file(filename.c_str(), std::ios::trunc | std::ios::out);
+    if (!dot_file)
+        throw InvalidPathException(std::string("Can't open file ") + filename + ".");
+
+    export_data(dot_file, lmodel, get_basename(filename));
+}
+
+void LogicModelDOTExporter::export_data(
+    std::ostream & os
+    , LogicModel_shptr lmodel
+    , std::string const& basename
 ) {
     if (lmodel == NULL)
         throw InvalidPointerException("Logic model pointer is NULL.");
 
-    string basename(get_basename(filename));
     std::ostringstream stm;
     stm << "time neato -v -Tsvg"
         << " -o " << basename << ".svg"
@@ -54,6 +88,7 @@ void LogicModelDOTExporter::export_data(
         ;
 
 
+    clear();
     add_header_line("");
     add_header_line("This is a logic model export.");
     add_header_line("");
@@ -64,144 +99,39 @@ void LogicModelDOTExporter::export_data(
     add_graph_setting("");
 
     try {
-        // iterate over logic model objects
-        for(LogicModel::object_collection::iterator
-            iter = lmodel->objects_begin()
-            ; iter != lmodel->objects_end()
-            ; ++iter
-        ) {
-            PlacedLogicModelObject_shptr o = (*iter).second;
-
-            if (Gate_shptr gate = std::tr1::dynamic_pointer_cast<Gate>(o)) {
-                add_gate(gate);
+        // The netlist graph enumerates gates and nets ordered by object ID.
+        NetlistGraph_shptr graph = lmodel->get_netlist_graph();
+
+        write_header(os);
+
+        std::vector<std::string> node_names;
+        write_gates(os, *graph, node_names);
+
+        // Intern the connection labels per template port.
+        std::list<ConnectionLabel> labels;
+        std::map<GateTemplatePort_shptr, ConnectionLabel const *> template_port_labels;
+        std::vector<ConnectionLabel const *> port_labels(graph->get_num_ports());
+
+        for(NetlistGraph::index_t p = 0; p < graph->get_num_ports(); p++) {
+            GateTemplatePort_shptr tmpl_port = graph->get_port(p)->get_template_port();
+            ConnectionLabel const *& label = template_port_labels[tmpl_port];
+            if (label == NULL) {
+                ConnectionLabel l;
+                l.name = tmpl_port != NULL ? tmpl_port->get_name() : "unknown";
+                l.is_source = is_source_connection(l.name);
+                l.is_clock = l.name == "clk";
+                labels.push_back(l);
+                label = &labels.back();
             }
+            port_labels[p] = label;
         }
 
-        for(std::map<object_id_t, std::vector<GateConn> >::const_iterator
-            it = via_to_gates.begin(), end = via_to_gates.end()
-            ; it != end
-            ; it++
-        ) {
-            object_id_t from_id = std::numeric_limits<object_id_t>::max();
-            std::string from_connection_name;
-            bool found_from = false;
-
-            const std::vector<GateConn>& gateConn = it->second;
-            for(vector<GateConn>::const_iterator
-                it2 = gateConn.begin(), end2 = gateConn.end()
-                ; it2 != end2
-                ; it2++
-            ) {
-                if (it2->connection_name != "a"
-                    && it2->connection_name != "b"
-                    && it2->connection_name != "c"
-                    && it2->connection_name != "d"
-                    && it2->connection_name != "e"
-                    && it2->connection_name != "f"
-                    && it2->connection_name != "D"
-                    && it2->connection_name != "1"
-                    && it2->connection_name != "0"
-                    && it2->connection_name != "rst"
-                    && it2->connection_name != ""
-                ) {
-                    from_id = it2->gate_id;
-                    from_connection_name = it2->connection_name;
-
-                    found_from = true;
-                    break;
-                }
-            }
-
-            if (!found_from
-                && it->first != std::numeric_limits<object_id_t>::max()
-            ) {
-                cout
-                << "Not found FROM and it's not UNKNOWN :( -- Skipping via"
-                << endl;
-
-                continue;
-            }
-
-            //It's not special 'unknown' node, so process normally
-            if (it->first != std::numeric_limits<object_id_t>::max()) {
-                string from_name = oid_to_str("G", from_id);
-
-                for(vector<GateConn>::const_iterator
-                    it2 = gateConn.begin(), end2 = gateConn.end()
-                    ; it2 != end2
-                    ; it2++
-                ) {
-                    //Skip gate the connection is coming from
-                    if (it2->gate_id == from_id)
-                        continue;
-
-                    //skip clk
-                    if (it2->connection_name == "clk"
-                        || from_connection_name == "clk"
-                    )
-                        continue;
-
-                    string to_name(oid_to_str("G", it2->gate_id));
-                    DOTAttributes edge_attrs;
-                    edge_attrs.add("headlabel", it2->connection_name);
-                    edge_attrs.add("taillabel", from_connection_name);
-                    add_edge(from_name, to_name, edge_attrs.get_string());
-                }
-            } else {
-                size_t num = 0;
-                //Special 'unknown' node, process specially
-                for(vector<GateConn>::const_iterator
-                    it2 = gateConn.begin(), end2 = gateConn.end()
-                    ; it2 != end2
-                    ; it2++
-                ) {
-                    //skip clk
-                    if (it2->connection_name == "clk")
-                        continue;
-
-                    bool from = false;
-                    if (it2->connection_name != "a"
-                        && it2->connection_name != "b"
-                        && it2->connection_name != "c"
-                        && it2->connection_name != "d"
-                        && it2->connection_name != "e"
-                        && it2->connection_name != "f"
-                        && it2->connection_name != "D"
-                        && it2->connection_name != "1"
-                        && it2->connection_name != "0"
-                        && it2->connection_name != "rst"
-                        && it2->connection_name != ""
-                    ) {
-                        from = true;
-                    }
-
-                    string gate_name(oid_to_str("G", it2->gate_id));
-
-                    DOTAttributes attrs;
-                    attrs.add("shape", "box");
-                    attrs.add("label", "9999.9999\\n01-Unknown");
-                    std::ostringstream ss;
-                    ss << "unknown" << num;
-                    num++;
-                    add_node(ss.str(), attrs.get_string());
-
-                    DOTAttributes edge_attrs;
-                    if (from) {
-                        edge_attrs.add("headlabel", "?");
-                        edge_attrs.add("taillabel", it2->connection_name);
-                        add_edge(gate_name, ss.str(), edge_attrs.get_string());
-                    } else {
-                        edge_attrs.add("taillabel", "?");
-                        edge_attrs.add("headlabel", it2->connection_name);
-                        add_edge(ss.str(), gate_name, edge_attrs.get_string());
-                    }
-
-                }
-            }
-        }
+        for(NetlistGraph::index_t n = 0; n < graph->get_num_nets(); n++)
+            write_net_edges(os, *graph, n, node_names, port_labels);
 
-        dump_to_file(filename);
+        write_unconnected_ports(os, *graph, node_names, port_labels);
 
+        write_footer(os);
     }
     catch(const std::exception& ex)
     {
@@ -220,64 +150,112 @@ std::string LogicModelDOTExporter::oid_to_str(
     return stm.str();
 }
 
-void LogicModelDOTExporter::add_gate(Gate_shptr gate)
-{
-    object_id_t gate_id = gate->get_object_id();
-    string node_name(oid_to_str("G", gate_id));
+void LogicModelDOTExporter::write_gates(
+    std::ostream & os
+    , NetlistGraph const& graph
+    , std::vector<std::string> & node_names
+) {
+    node_names.resize(graph.get_num_gates());
 
-    std::ostringstream stm;
-    stm << (gate->has_name() ? gate->get_name() : node_name);
+    for(NetlistGraph::index_t g = 0; g < graph.get_num_gates(); g++) {
+        Gate_shptr const& gate = graph.get_gate(g);
+        node_names[g] = oid_to_str("G", gate->get_object_id());
+
+        std::ostringstream stm;
+        stm << (gate->has_name() ? gate->get_name() : node_names[g]);
+
+        //Gate has a template (i.e. is it recognized?)
+        if (gate->has_template()) {
+            const GateTemplate_shptr tmpl = gate->get_gate_template();
+            stm << "\\n" << tmpl->get_name();
+        }
 
-    //Gate has a template (i.e. is it recognized?)
-    if (gate->has_template()) {
-        const GateTemplate_shptr tmpl = gate->get_gate_template();
-        stm << "\\n" << tmpl->get_name();
+        DOTAttributes attrs;
+        attrs.add("shape", "box");
+        attrs.add("label", stm.str());
+        write_node(os, node_names[g], attrs.get_string());
     }
+}
 
-    DOTAttributes attrs;
-    attrs.add("shape", "box");
-    attrs.add("label", stm.str());
-    add_node(node_name, attrs.get_string());
-
-    //Edges
-    for(Gate::port_iterator
-        piter = gate->ports_begin()
-        ; piter != gate->ports_end()
-        ; ++piter
-    ) {
-        GatePort_shptr gate_port = *piter;
-
-        //To fill up with data
-        object_id_t via_id;
-        std::string conn_name;
-
-        //other end available?
-        if (gate_port->get_net()) {
-            via_id = gate_port->get_net()->get_object_id();
-        } else {
-            via_id = std::numeric_limits<object_id_t>::max();
-            conn_name = "unknown";
+void LogicModelDOTExporter::write_net_edges(
+    std::ostream & os
+    , NetlistGraph const& graph
+    , NetlistGraph::index_t n
+    , std::vector<std::string> const& node_names
+    , std::vector<ConnectionLabel const *> const& port_labels
+) {
+    NetlistGraph::index_range ports = graph.get_net_ports(n);
+    if (ports.first == ports.second) return;
 
-        }
+    // The first likely source is the gate the connection is coming from.
+    NetlistGraph::index_t const * from = ports.first;
+    while (from != ports.second && !port_labels[*from]->is_source) ++from;
 
-        //Name available?
-        if (gate_port->get_template_port()) {
-            conn_name = gate_port->get_template_port()->get_name();
-        } else {
-            conn_name = "unknown";
-        }
-        //Name of the connection (i.e. 'a', 'b', 'sel', 'clk', etc.)
+    if (from == ports.second) {
+        cout
+        << "Not found FROM and it's not UNKNOWN :( -- Skipping via"
+        << endl;
+
+        return;
+    }
+
+    //skip clk
+    ConnectionLabel const& from_label = *port_labels[*from];
+    if (from_label.is_clock) return;
+
+    NetlistGraph::index_t from_gate = graph.get_port_gate(*from);
+
+    for(NetlistGraph::index_t const * p = ports.first; p != ports.second; ++p) {
+
+        NetlistGraph::index_t to_gate = graph.get_port_gate(*p);
+
+        //Skip gate the connection is coming from
+        if (to_gate == from_gate || port_labels[*p]->is_clock)
+            continue;
+
+        DOTAttributes edge_attrs;
+        edge_attrs.add("headlabel", port_labels[*p]->name);
+        edge_attrs.add("taillabel", from_label.name);
+        write_edge(os, node_names[from_gate], node_names[to_gate], edge_attrs.get_string());
+    }
+}
+
+void LogicModelDOTExporter::write_unconnected_ports(
+    std::ostream & os
+    , NetlistGraph const& graph
+    , std::vector<std::string> const& node_names
+    , std::vector<ConnectionLabel const *> const& port_labels
+) {
+    size_t num = 0;
+
+    //Special 'unknown' node for each port without a net
+    for(NetlistGraph::index_t p = 0; p < graph.get_num_ports(); p++) {
+
+        ConnectionLabel const& label = *port_labels[p];
+
+        //skip clk
+        if (graph.get_port_net(p) != NetlistGraph::no_index || label.is_clock)
+            continue;
 
+        std::string const& gate_name = node_names[graph.get_port_gate(p)];
 
-        std::map<object_id_t, std::vector<GateConn> >::iterator it =
-            via_to_gates.find(via_id);
+        DOTAttributes attrs;
+        attrs.add("shape", "box");
+        attrs.add("label", "9999.9999\\n01-Unknown");
+        std::ostringstream ss;
+        ss << "unknown" << num;
+        num++;
+        write_node(os, ss.str(), attrs.get_string());
 
-        if (it == via_to_gates.end()) {
-            std::vector<GateConn> tmp;
-            tmp.push_back(GateConn(gate_id, conn_name));
-            via_to_gates[via_id] = tmp;
+        DOTAttributes edge_attrs;
+        if (label.is_source) {
+            edge_attrs.add("headlabel", "?");
+            edge_attrs.add("taillabel", label.name);
+            write_edge(os, gate_name, ss.str(), edge_attrs.get_string());
         } else {
-            it->second.push_back(GateConn(gate_id, conn_name));
+            edge_attrs.add("taillabel", "?");
+            edge_attrs.add("headlabel", label.name);
+            write_edge(os, ss.str(), gate_name, edge_attrs.get_string());
         }
     }
 }
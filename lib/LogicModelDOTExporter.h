@@ -27,6 +27,7 @@
 #include "DOTExporter.h"
 #include "ObjectIDRewriter.h"
 #include "Layer.h"
+#include "NetlistGraph.h"
 
 #include <stdexcept>
 
@@ -35,37 +36,52 @@ namespace degate {
 /**
  * The LogicModelDOTExporter exports the logic model or a part
  * of the logic model as a dot graph.
+ *
+ * Nodes and edges are written directly into the output stream
+ * in the order of the netlist graph.
  */
 
 class LogicModelDOTExporter : public DOTExporter {
 
 protected:
 
-    void add_gate(Gate_shptr gate);
     std::string oid_to_str(std::string const& prefix, object_id_t oid);
 
 
 private:
 
-    struct GateConn {
-        GateConn(
-            const object_id_t _gate_id
-            , const std::string& _connection_name
-        ) :
-            gate_id(_gate_id)
-            , connection_name(_connection_name)
-        {}
-
-        object_id_t gate_id;
-        std::string connection_name;
+    /**
+     * The name of a gate port connection (i.e. 'a', 'b', 'sel', 'clk', etc.)
+     * Labels are shared by all gate ports with the same template port.
+     */
+    struct ConnectionLabel {
+        std::string name;
+        bool is_source;
+        bool is_clock;
     };
 
-    std::map<object_id_t /* net id */, int> implicit_net_counter;
-
     ObjectIDRewriter_shptr oid_rewriter;
 
-    //VIA <--> gates
-    std::map<object_id_t, std::vector<GateConn> > via_to_gates;
+    void write_gates(
+        std::ostream & os
+        , NetlistGraph const& graph
+        , std::vector<std::string> & node_names
+    );
+
+    void write_net_edges(
+        std::ostream & os
+        , NetlistGraph const& graph
+        , NetlistGraph::index_t n
+        , std::vector<std::string> const& node_names
+        , std::vector<ConnectionLabel const *> const& port_labels
+    );
+
+    void write_unconnected_ports(
+        std::ostream & os
+        , NetlistGraph const& graph
+        , std::vector<std::string> const& node_names
+        , std::vector<ConnectionLabel const *> const& port_labels
+    );
 
 public:
 
@@ -84,6 +100,17 @@ public:
      */
     void export_data(std::string const& filename, LogicModel_shptr lmodel);
 
+    /**
+     * Export the logic model as DOT graph into a stream.
+     * @param os The output stream.
+     * @param lmodel The logic model.
+     * @param basename The file name without extension, that is used in
+     *   the hint for rendering the graph.
+     * @excpetion InvalidPointerException
+     * @excpetion std::runtime_error
+     */
+    void export_data(std::ostream & os, LogicModel_shptr lmodel, std::string const& basename);
+
 };
 
 }
@@ -34,6 +34,8 @@
 #include <list>
 #include <tr1/memory>
 
+#include <boost/foreach.hpp>
+
 using namespace std;
 using namespace degate;
 
@@ -43,9 +45,9 @@ void LogicModelExporter::export_data(std::string const& filename, LogicModel_shp
 
   try {
 
-    xmlpp::Document doc;
+    XMLDocument_shptr doc(new xmlpp::Document());
 
-    xmlpp::Element * root_elem = doc.create_root_node("logic-model");
+    xmlpp::Element * root_elem = doc->create_root_node("logic-model");
     assert(root_elem != NULL);
 
     xmlpp::Element* gates_elem = root_elem->add_child("gates");
@@ -66,49 +68,45 @@ void LogicModelExporter::export_data(std::string const& filename, LogicModel_shp
     xmlpp::Element* annotations_elem = root_elem->add_child("annotations");
     if(annotations_elem == NULL) throw(std::runtime_error("Failed to create node."));
 
-    for(LogicModel::layer_collection::iterator layer_iter = lmodel->layers_begin();
-	layer_iter != lmodel->layers_end(); ++layer_iter) {
-
-      Layer_shptr layer = *layer_iter;
-
-      for(Layer::object_iterator iter = layer->objects_begin();
-	  iter != layer->objects_end(); ++iter) {
+    // The object collection is a hash map. Export objects ordered by ID to get a stable file.
+    BOOST_FOREACH(object_id_t object_id, lmodel->get_ordered_object_ids()) {
 
-	layer_position_t layer_pos = layer->get_layer_pos();
+      PlacedLogicModelObject_shptr o = lmodel->get_object(object_id);
+      assert(o != NULL);
 
-	PlacedLogicModelObject_shptr o = (*iter);
+      Layer_shptr layer = o->get_layer();
+      if(layer == NULL) continue;
 
-	if(Gate_shptr gate = std::tr1::dynamic_pointer_cast<Gate>(o))
-	  add_gate(gates_elem, gate, layer_pos);
+      layer_position_t layer_pos = layer->get_layer_pos();
 
-	else if(Via_shptr via = std::tr1::dynamic_pointer_cast<Via>(o))
-	  add_via(vias_elem, via, layer_pos);
+      if(Gate_shptr gate = std::tr1::dynamic_pointer_cast<Gate>(o))
+	add_gate(gates_elem, gate, layer_pos);
 
-	else if(EMarker_shptr emarker = std::tr1::dynamic_pointer_cast<EMarker>(o))
-	  add_emarker(emarkers_elem, emarker, layer_pos);
+      else if(Via_shptr via = std::tr1::dynamic_pointer_cast<Via>(o))
+	add_via(vias_elem, via, layer_pos);
 
-	else if(Wire_shptr wire = std::tr1::dynamic_pointer_cast<Wire>(o))
-	  add_wire(wires_elem, wire, layer_pos);
+      else if(EMarker_shptr emarker = std::tr1::dynamic_pointer_cast<EMarker>(o))
+	add_emarker(emarkers_elem, emarker, layer_pos);
 
-	else if(Annotation_shptr annotation = std::tr1::dynamic_pointer_cast<Annotation>(o))
-	  add_annotation(annotations_elem, annotation, layer_pos);
+      else if(Wire_shptr wire = std::tr1::dynamic_pointer_cast<Wire>(o))
+	add_wire(wires_elem, wire, layer_pos);
 
-      }
+      else if(Annotation_shptr annotation = std::tr1::dynamic_pointer_cast<Annotation>(o))
+	add_annotation(annotations_elem, annotation, layer_pos);
     }
 
     add_nets(nets_elem, lmodel);
 
     // actually we have only one main module
     
-    // First update the module ports.
-    determine_module_ports_for_root(lmodel); // Update main module itself.
-    lmodel->get_main_module()->determine_module_ports_recursive(); // Update all of main module's children.
+    // First update the module ports of the main module and all of its children.
+    determine_module_ports_for_hierarchy(lmodel);
 
     xmlpp::Element* modules_elem = root_elem->add_child("modules");
     if(modules_elem == NULL) throw(std::runtime_error("Failed to create node."));
     else add_module(modules_elem, lmodel, lmodel->get_main_module());
 
-    doc.write_to_file_formatted(filename, "ISO-8859-1");
+    write_document(doc, filename);
 
   }
   catch(const std::exception& ex) {
@@ -120,12 +118,12 @@ void LogicModelExporter::export_data(std::string const& filename, LogicModel_shp
 
 void LogicModelExporter::add_nets(xmlpp::Element* nets_elem, LogicModel_shptr lmodel) {
 
-  for(LogicModel::net_collection::iterator net_iter = lmodel->nets_begin();
-      net_iter != lmodel->nets_end(); ++net_iter) {
+  // The net collection is a hash map. Export nets ordered by ID to get a stable file.
+  BOOST_FOREACH(object_id_t net_id, lmodel->get_ordered_net_ids()) {
 
     xmlpp::Element* net_elem = nets_elem->add_child("net");
 
-    Net_shptr net = net_iter->second;
+    Net_shptr net = lmodel->get_net(net_id);
     assert(net != NULL);
 
     object_id_t old_net_id = net->get_object_id();
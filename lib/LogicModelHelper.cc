@@ -22,11 +22,16 @@
 #include <globals.h>
 #include <degate.h>
 #include <LogicModelHelper.h>
+#include <LogicModelIndex.h>
 #include <LogicModelObjectBase.h>
+#include <ImageAccumulator.h>
 #include <TangencyCheck.h>
 
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
 
 using namespace degate;
 
@@ -66,10 +71,8 @@ Layer_shptr degate::get_first_logic_layer(LogicModel_shptr lmodel) {
 
 Gate_shptr degate::get_gate_by_name(LogicModel_shptr lmodel,
 				    std::string const& gate_name) {
-  for(LogicModel::gate_collection::iterator iter = lmodel->gates_begin();
-      iter != lmodel->gates_end(); ++iter) {
-    Gate_shptr gate = (*iter).second;
-    if(gate->get_name() == gate_name) return gate;
+  BOOST_FOREACH(PlacedLogicModelObject_shptr o, lmodel->get_index().find_by_name(gate_name)) {
+    if(Gate_shptr gate = std::tr1::dynamic_pointer_cast<Gate>(o)) return gate;
   }
 
   return Gate_shptr();
@@ -209,6 +212,16 @@ void degate::load_background_image(Layer_shptr layer,
 
   debug(TM, "Set image to layer.");
   layer->set_image(bg_image);
+
+  // Scanned images are written once and read often. Compressing them
+  // reduces the disk usage and the amount of data read on loading tiles.
+  if(Configuration::get_instance().use_tile_compression()) {
+    debug(TM, "Compress image tiles.");
+    ScalingManager_shptr smgr = layer->get_scaling_manager();
+    BOOST_FOREACH(double step, smgr->get_zoom_steps())
+      smgr->get_image(step).second->compress_tiles();
+  }
+
   debug(TM, "Done.");
 }
 
@@ -218,15 +231,20 @@ void degate::clear_logic_model(LogicModel_shptr lmodel, Layer_shptr layer) {
     throw InvalidPointerException("Error: you passed an invalid pointer to clear_logc_model()");
 
   // iterate over all objects that are placed on a specific layer and remove them
+  // in a second step, because removing invalidates the iterators
+
+  std::list<PlacedLogicModelObject_shptr> remove_list;
 
   for(LogicModel::object_collection::iterator iter = lmodel->objects_begin();
       iter != lmodel->objects_end(); ++iter) {
     PlacedLogicModelObject_shptr lmo = (*iter).second;
-    if(lmo->get_layer() == layer) {
-      lmodel->remove_object(lmo);
-    }
+    // Gate ports are removed together with their gate.
+    if(lmo->get_layer() == layer && std::tr1::dynamic_pointer_cast<GatePort>(lmo) == NULL)
+      remove_list.push_back(lmo);
   }
 
+  BOOST_FOREACH(PlacedLogicModelObject_shptr lmo, remove_list) lmodel->remove_object(lmo);
+
 }
 
 Layer_shptr degate::get_first_enabled_layer(LogicModel_shptr lmodel) {
@@ -415,48 +433,301 @@ void degate::apply_port_color_settings(LogicModel_shptr lmodel, PortColorManager
 }
 
 
-void degate::merge_gate_images(LogicModel_shptr lmodel,
-			       Layer_shptr layer,
-			       GateTemplate_shptr tmpl,
-			       std::list<Gate_shptr> const& gates) {
+namespace {
 
-  if(gates.empty()) return;
+  /**
+   * A template image for one layer, that is merged from gate instances.
+   */
+  struct MergeJob {
+    GateTemplate_shptr tmpl;
+    Layer_shptr layer;
+    BackgroundImage_shptr image;
+    unsigned int width, height;
+  };
+
+  /**
+   * A gate instance, that is added to the image of a merge job.
+   */
+  struct MergeItem {
+    unsigned int job;
+    unsigned int image; // position of the layer in the list of merged layers
+    unsigned int tile_x, tile_y; // tile of the upper left corner
+    Gate_shptr gate;
+
+    // Order items by position, so that workers process neighbouring gates.
+    bool operator<(MergeItem const& other) const {
+      if(image != other.image) return image < other.image;
+      if(tile_y != other.tile_y) return tile_y < other.tile_y;
+      if(tile_x != other.tile_x) return tile_x < other.tile_x;
+      return job < other.job;
+    }
+  };
 
-  std::list<GateTemplateImage_shptr> images;
+  /**
+   * Loads tiles of background images with the thread-safe read_tile().
+   * The last tiles are kept, because neighbouring gates share tiles.
+   */
+  class TileReader {
 
-  BOOST_FOREACH(const Gate_shptr g, gates) {
+  private:
 
-    GateTemplateImage_shptr tmpl_img =
-      grab_image<GateTemplateImage>(lmodel, layer, g->get_bounding_box());
-    assert(tmpl_img != NULL);
+    struct Tile {
+      BackgroundImage const * image;
+      unsigned int x, y;
+      unsigned int last_use;
+      std::vector<rgba_pixel_t> data;
+    };
 
-    // flip
-    switch(g->get_orientation()) {
-    case Gate::ORIENTATION_FLIPPED_UP_DOWN:
-      flip_up_down<GateTemplateImage>(tmpl_img);
-      break;
-    case Gate::ORIENTATION_FLIPPED_LEFT_RIGHT:
-      flip_left_right<GateTemplateImage>(tmpl_img);
-      break;
-    case Gate::ORIENTATION_FLIPPED_BOTH:
-      flip_up_down<GateTemplateImage>(tmpl_img);
-      flip_left_right<GateTemplateImage>(tmpl_img);
-      break;
-    default:
-      // do nothing
-      break;
+    std::vector<Tile> tiles;
+    unsigned int clock;
+
+  public:
+
+    TileReader(unsigned int num_tiles = 4) : tiles(num_tiles), clock(0) {
+      BOOST_FOREACH(Tile & t, tiles) {
+	t.image = NULL;
+	t.last_use = 0;
+      }
+    }
+
+    /**
+     * Get the tile, that has its upper left corner at x, y.
+     */
+    rgba_pixel_t const * get_tile(BackgroundImage_shptr img, unsigned int x, unsigned int y) {
+
+      Tile * victim = &tiles[0];
+      clock++;
+
+      BOOST_FOREACH(Tile & t, tiles) {
+	if(t.image == img.get() && t.x == x && t.y == y) {
+	  t.last_use = clock;
+	  return &t.data[0];
+	}
+	if(t.last_use < victim->last_use) victim = &t;
+      }
+
+      victim->data.resize(img->get_tile_size() * img->get_tile_size());
+      img->read_tile(&victim->data[0], x, y);
+      victim->image = img.get();
+      victim->x = x;
+      victim->y = y;
+      victim->last_use = clock;
+      return &victim->data[0];
+    }
+  };
+
+  /**
+   * Add the region of a gate to an accumulator. The region is mirrored
+   * according to the gate orientation. Pixels outside of the background
+   * image are added as zero.
+   */
+  void add_gate_image(ImageAccumulator & acc, TileReader & reader,
+		      BackgroundImage_shptr img, Gate_shptr gate) {
+
+    BoundingBox const& bbox = gate->get_bounding_box();
+    unsigned int min_x = bbox.get_min_x(), max_x = bbox.get_max_x();
+    unsigned int min_y = bbox.get_min_y(), max_y = bbox.get_max_y();
+
+    Gate::ORIENTATION orientation = gate->get_orientation();
+    bool flip_x = orientation == Gate::ORIENTATION_FLIPPED_LEFT_RIGHT ||
+      orientation == Gate::ORIENTATION_FLIPPED_BOTH;
+    bool flip_y = orientation == Gate::ORIENTATION_FLIPPED_UP_DOWN ||
+      orientation == Gate::ORIENTATION_FLIPPED_BOTH;
+
+    unsigned int tile_size = img->get_tile_size();
+    unsigned int img_w = img->get_width(), img_h = img->get_height();
+
+    acc.begin_image();
+
+    for(unsigned int ty = min_y & ~(tile_size - 1); ty < max_y; ty += tile_size)
+      for(unsigned int tx = min_x & ~(tile_size - 1); tx < max_x; tx += tile_size) {
+
+	rgba_pixel_t const * tile =
+	  tx < img_w && ty < img_h ? reader.get_tile(img, tx, ty) : NULL;
+
+	for(unsigned int y = std::max(ty, min_y); y < std::min(ty + tile_size, max_y); y++) {
+	  unsigned int dst_y = flip_y ? max_y - 1 - y : y - min_y;
+
+	  for(unsigned int x = std::max(tx, min_x); x < std::min(tx + tile_size, max_x); x++) {
+	    unsigned int dst_x = flip_x ? max_x - 1 - x : x - min_x;
+	    color_t pix = tile != NULL && x < img_w && y < img_h ?
+	      tile[(y - ty) * tile_size + (x - tx)] : 0;
+	    acc.add_pixel(dst_x, dst_y, pix);
+	  }
+	}
+      }
+  }
+
+  /**
+   * Accumulates a contiguous range of merge items in a worker thread. Each
+   * worker has its own accumulator per job, so that no locking is needed.
+   */
+  struct MergeWorker {
+
+    std::vector<MergeJob> const * jobs;
+    std::vector<MergeItem> const * items;
+    std::vector<ImageAccumulator_shptr> const * references;
+    bool track_variance;
+    double max_deviation;
+    std::vector<ImageAccumulator_shptr> * results;
+    size_t begin, end;
+
+    void operator()() {
+      TileReader reader;
+
+      for(size_t i = begin; i < end; i++) {
+	MergeItem const& item = (*items)[i];
+	MergeJob const& job = (*jobs)[item.job];
+	ImageAccumulator_shptr & acc = (*results)[item.job];
+
+	if(acc == NULL) {
+	  acc = ImageAccumulator_shptr(new ImageAccumulator(job.width, job.height, track_variance));
+	  if(references != NULL) acc->set_reference(*(*references)[item.job], max_deviation);
+	}
+
+	add_gate_image(*acc, reader, job.image, item.gate);
+      }
+    }
+  };
+
+  /**
+   * Run one pass over all merge items.
+   * @return Returns an accumulator per job.
+   */
+  std::vector<ImageAccumulator_shptr>
+  accumulate_gate_images(std::vector<MergeJob> const& jobs,
+			 std::vector<MergeItem> const& items,
+			 std::vector<ImageAccumulator_shptr> const * references,
+			 bool track_variance, double max_deviation,
+			 unsigned int num_threads) {
+
+    std::vector<std::vector<ImageAccumulator_shptr> >
+      results(num_threads, std::vector<ImageAccumulator_shptr>(jobs.size()));
+
+    size_t chunk = (items.size() + num_threads - 1) / num_threads;
+
+    boost::thread_group threads;
+    for(unsigned int t = 0; t < num_threads; t++) {
+      MergeWorker w;
+      w.jobs = &jobs;
+      w.items = &items;
+      w.references = references;
+      w.track_variance = track_variance;
+      w.max_deviation = max_deviation;
+      w.results = &results[t];
+      w.begin = std::min(items.size(), t * chunk);
+      w.end = std::min(items.size(), (t + 1) * chunk);
+
+      if(num_threads == 1) w();
+      else threads.create_thread(w);
+    }
+    threads.join_all();
+
+    // merge the per worker results
+    std::vector<ImageAccumulator_shptr> merged(jobs.size());
+    for(unsigned int j = 0; j < jobs.size(); j++)
+      for(unsigned int t = 0; t < num_threads; t++) {
+	ImageAccumulator_shptr acc = results[t][j];
+	if(acc == NULL) continue;
+	if(merged[j] == NULL) merged[j] = acc;
+	else merged[j]->merge(*acc);
+      }
+
+    return merged;
+  }
+
+  /**
+   * Add a merge job for a gate template and a layer.
+   */
+  void add_merge_job(std::vector<MergeJob> & jobs, std::vector<MergeItem> & items,
+		     Layer_shptr layer, unsigned int layer_num,
+		     GateTemplate_shptr tmpl, std::list<Gate_shptr> const& gates) {
+
+    if(gates.empty()) return;
+
+    MergeJob job;
+    job.tmpl = tmpl;
+    job.layer = layer;
+    job.image = layer->get_image();
+    if(job.image == NULL) throw DegateLogicException("The layer has no background image");
+
+    BoundingBox const& first_bbox = gates.front()->get_bounding_box();
+    job.width = first_bbox.get_width();
+    job.height = first_bbox.get_height();
+
+    BOOST_FOREACH(const Gate_shptr g, gates) {
+
+      BoundingBox const& bbox = g->get_bounding_box();
+
+      // verify that all gates have the same dimensions
+      if(bbox.get_width() != job.width || bbox.get_height() != job.height)
+	throw DegateRuntimeException("merge_gate_images() failed, because gates differ in size.");
+      if(bbox.get_min_x() < 0 || bbox.get_min_y() < 0)
+	throw DegateRuntimeException("merge_gate_images() failed, because a gate has "
+				     "negative coordinates.");
+
+      MergeItem item;
+      item.job = jobs.size();
+      item.image = layer_num;
+      item.tile_x = bbox.get_min_x() / job.image->get_tile_size();
+      item.tile_y = bbox.get_min_y() / job.image->get_tile_size();
+      item.gate = g;
+      items.push_back(item);
+    }
+
+    jobs.push_back(job);
+  }
+
+  /**
+   * Accumulate the gate images for all jobs and set the merged template images.
+   */
+  void run_merge_jobs(std::vector<MergeJob> const& jobs, std::vector<MergeItem> & items,
+		      double max_deviation, unsigned int num_threads) {
+
+    if(items.empty()) return;
+
+    if(num_threads == 0) num_threads = std::max(boost::thread::hardware_concurrency(), 1U);
+    num_threads = std::min<unsigned int>(num_threads, items.size());
+
+    std::sort(items.begin(), items.end());
+
+    std::vector<ImageAccumulator_shptr> accs;
+
+    if(max_deviation > 0) {
+      std::vector<ImageAccumulator_shptr> references =
+	accumulate_gate_images(jobs, items, NULL, true, 0, num_threads);
+      accs = accumulate_gate_images(jobs, items, &references, false, max_deviation, num_threads);
     }
+    else
+      accs = accumulate_gate_images(jobs, items, NULL, false, 0, num_threads);
 
-    images.push_back(tmpl_img);
+    for(unsigned int j = 0; j < jobs.size(); j++) {
+      assert(accs[j] != NULL);
+      jobs[j].tmpl->set_image(jobs[j].layer->get_layer_type(),
+			      accs[j]->get_image<GateTemplateImage>());
+    }
   }
 
-  GateTemplateImage_shptr merged_img = merge_images<GateTemplateImage>(images);
+}
 
-  tmpl->set_image(layer->get_layer_type(), merged_img);
+void degate::merge_gate_images(LogicModel_shptr lmodel,
+			       Layer_shptr layer,
+			       GateTemplate_shptr tmpl,
+			       std::list<Gate_shptr> const& gates,
+			       double max_deviation,
+			       unsigned int num_threads) {
+
+  std::vector<MergeJob> jobs;
+  std::vector<MergeItem> items;
+
+  add_merge_job(jobs, items, layer, 0, tmpl, gates);
+  run_merge_jobs(jobs, items, max_deviation, num_threads);
 }
 
 void degate::merge_gate_images(LogicModel_shptr lmodel,
-			       ObjectSet gates) {
+			       ObjectSet gates,
+			       double max_deviation,
+			       unsigned int num_threads) {
 
   /*
    * Classify gates by their standard cell object ID.
@@ -473,23 +744,28 @@ void degate::merge_gate_images(LogicModel_shptr lmodel,
   }
 
   /*
-   * Iterate over layers.
+   * Collect a job for each layer and standard cell class. All jobs
+   * are processed at once, so that layers are read in parallel.
    */
 
+  std::vector<MergeJob> jobs;
+  std::vector<MergeItem> items;
+  unsigned int layer_num = 0;
+
   BOOST_FOREACH(Layer_shptr layer, get_available_standard_layers(lmodel)) {
 
-    /*
-     * Iterate over standard cell classes.
-     */
     for(gate_sets_type::iterator iter = gate_sets.begin(); iter != gate_sets.end(); ++iter) {
 
       Gate_shptr g = iter->second.front();
       assert(g != NULL);
 
-      merge_gate_images(lmodel, layer, g->get_gate_template(), iter->second);
+      add_merge_job(jobs, items, layer, layer_num, g->get_gate_template(), iter->second);
     }
+
+    layer_num++;
   }
 
+  run_merge_jobs(jobs, items, max_deviation, num_threads);
 }
 
 
@@ -523,13 +799,16 @@ void degate::autoconnect_objects(LogicModel_shptr lmodel, Layer_shptr layer,
   if(lmodel == NULL || layer == NULL)
     throw InvalidPointerException("You passed an invalid shared pointer.");
 
+  GeoShape s1, s2;
+
   // iterate over connectable objects
   for(Layer::qt_region_iterator iter = layer->region_begin(search_bbox);
       iter != layer->region_end(); ++iter) {
 
     ConnectedLogicModelObject_shptr clmo1;
 
-    if((clmo1 = std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(*iter)) != NULL) {
+    if((clmo1 = std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(*iter)) != NULL &&
+       get_geo_shape(*iter, s1)) {
 
       BoundingBox const& bb = clmo1->get_bounding_box();
 
@@ -546,8 +825,8 @@ void degate::autoconnect_objects(LogicModel_shptr lmodel, Layer_shptr layer,
 	  if((clmo1->get_net() == NULL ||
 	      clmo2->get_net() == NULL ||
 	      clmo1->get_net() != clmo2->get_net()) && // excludes identical objects, too
-	     check_object_tangency(std::tr1::dynamic_pointer_cast<PlacedLogicModelObject>(clmo1),
-				   std::tr1::dynamic_pointer_cast<PlacedLogicModelObject>(clmo2)))
+	     get_geo_shape(*siter, s2) &&
+	     geo_touches(s1, s2))
 
 	    connect_objects(lmodel, clmo1, clmo2);
 
@@ -558,60 +837,49 @@ void degate::autoconnect_objects(LogicModel_shptr lmodel, Layer_shptr layer,
   }
 }
 
-void autoconnect_interlayer_objects_via_via(LogicModel_shptr lmodel,
-					    Layer_shptr adjacent_layer,
-					    BoundingBox const& search_bbox,
-					    Via_shptr v1,
-					    Via::DIRECTION v1_dir_criteria,
-					    Via::DIRECTION v2_dir_criteria) {
+/**
+ * Connect a via with objects in the adjacent layer, that are tangent. The
+ * candidates are collected first and then tested in a batch.
+ */
+template<typename ObjectType>
+void autoconnect_interlayer_objects_via(LogicModel_shptr lmodel,
+					Layer_shptr adjacent_layer,
+					BoundingBox const& search_bbox,
+					Via_shptr v1,
+					Via::DIRECTION v1_dir_criteria,
+					bool (*accept)(std::tr1::shared_ptr<ObjectType>)) {
 
-  Via_shptr v2;
+  if(v1->get_direction() != v1_dir_criteria) return;
+
+  std::vector<std::tr1::shared_ptr<ObjectType> > candidates;
+  GeoCircleBatch batch;
 
   for(Layer::qt_region_iterator siter = adjacent_layer->region_begin(search_bbox);
       siter != adjacent_layer->region_end(); ++siter) {
 
-    if((v2 = std::tr1::dynamic_pointer_cast<Via>(*siter)) != NULL) {
-
-      if((v1->get_net() == NULL || v2->get_net() == NULL ||
-	  v1->get_net() != v2->get_net()) &&
-	 v1->get_direction() == v1_dir_criteria &&
-	 v2->get_direction() == v2_dir_criteria &&
-	 check_object_tangency(std::tr1::dynamic_pointer_cast<Circle>(v1),
-			       std::tr1::dynamic_pointer_cast<Circle>(v2)))
-	connect_objects(lmodel,
-			std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(v1),
-			std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(v2));
+    std::tr1::shared_ptr<ObjectType> v2 = std::tr1::dynamic_pointer_cast<ObjectType>(*siter);
+    if(v2 != NULL && accept(v2)) {
+      candidates.push_back(v2);
+      batch.push_back(v2->get_geo_circle());
     }
   }
 
-}
+  std::vector<unsigned int> hits;
+  geo_find_touching(v1->get_geo_circle(), batch, hits);
 
-void autoconnect_interlayer_objects_via_gport(LogicModel_shptr lmodel,
-					      Layer_shptr adjacent_layer,
-					      BoundingBox const& search_bbox,
-					      Via_shptr v1,
-					      Via::DIRECTION v1_dir_criteria) {
-
-  GatePort_shptr v2;
-
-  for(Layer::qt_region_iterator siter = adjacent_layer->region_begin(search_bbox);
-      siter != adjacent_layer->region_end(); ++siter) {
-
-    if((v2 = std::tr1::dynamic_pointer_cast<GatePort>(*siter)) != NULL) {
-
-      if((v1->get_net() == NULL || v2->get_net() == NULL ||
-	  v1->get_net() != v2->get_net()) &&
-	 v1->get_direction() == v1_dir_criteria &&
-	 check_object_tangency(std::tr1::dynamic_pointer_cast<Circle>(v1),
-			       std::tr1::dynamic_pointer_cast<Circle>(v2)))
-	connect_objects(lmodel,
-			std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(v1),
-			std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(v2));
-    }
+  BOOST_FOREACH(unsigned int i, hits) {
+    std::tr1::shared_ptr<ObjectType> v2 = candidates[i];
+    if(v1->get_net() == NULL || v2->get_net() == NULL || v1->get_net() != v2->get_net())
+      connect_objects(lmodel,
+		      std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(v1),
+		      std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(v2));
   }
-
 }
 
+static bool is_via_up(Via_shptr v) { return v->get_direction() == Via::DIRECTION_UP; }
+static bool is_via_down(Via_shptr v) { return v->get_direction() == Via::DIRECTION_DOWN; }
+static bool is_gate_port(GatePort_shptr) { return true; }
+
 void degate::autoconnect_interlayer_objects(LogicModel_shptr lmodel,
 					    Layer_shptr layer,
 					    BoundingBox const& search_bbox) {
@@ -636,14 +904,14 @@ void degate::autoconnect_interlayer_objects(LogicModel_shptr lmodel,
 	 in the region identified by bounding box bb. */
 
       if(layer_above != NULL)
-	autoconnect_interlayer_objects_via_via(lmodel, layer_above, bb, v1,
-					       Via::DIRECTION_UP, Via::DIRECTION_DOWN);
+	autoconnect_interlayer_objects_via(lmodel, layer_above, bb, v1,
+					   Via::DIRECTION_UP, is_via_down);
 
       if(layer_below != NULL) {
-	autoconnect_interlayer_objects_via_via(lmodel, layer_below, bb, v1,
-					       Via::DIRECTION_DOWN, Via::DIRECTION_UP);
-	autoconnect_interlayer_objects_via_gport(lmodel, layer_below, bb, v1,
-						 Via::DIRECTION_DOWN);
+	autoconnect_interlayer_objects_via(lmodel, layer_below, bb, v1,
+					   Via::DIRECTION_DOWN, is_via_up);
+	autoconnect_interlayer_objects_via(lmodel, layer_below, bb, v1,
+					   Via::DIRECTION_DOWN, is_gate_port);
       }
 
     }
@@ -106,19 +106,45 @@ namespace degate {
   }
 
   /**
-   * Merge images.
+   * Merge the images of gates with the same template into a template image.
+   *
+   * The gate regions are read from the background image in worker threads
+   * and averaged with an ImageAccumulator. The gate images are not kept in
+   * memory.
+   *
+   * @param lmodel The logic model.
+   * @param layer The layer, that provides the background image.
+   * @param tmpl The gate template, that gets the merged image.
+   * @param gates Gate instances of the template.
+   * @param max_deviation If this value is larger than zero, pixel values,
+   *   that differ by more than \p max_deviation standard deviations from the
+   *   mean, are treated as outliers and are not averaged. This needs a second
+   *   pass over the background image.
+   * @param num_threads The number of worker threads. Use 0 for the number of
+   *   available processors.
+   * @exception DegateLogicException Is thrown if the layer has no
+   *   background image set.
+   * @exception DegateRuntimeException Is thrown if gates differ in size.
    */
   void merge_gate_images(LogicModel_shptr lmodel,
 			 Layer_shptr layer,
-			 GateTemplate_shptr tmpl, std::list<Gate_shptr> const& gates);
+			 GateTemplate_shptr tmpl, std::list<Gate_shptr> const& gates,
+			 double max_deviation = 0,
+			 unsigned int num_threads = 0);
 
   /**
-   * Merge images.
+   * Merge images for all gate templates and standard layers. The
+   * background images of all layers are read in parallel.
    * @param lmodel
    * @param gates A set of objects. It can contain non-gate types too.
+   * @param max_deviation The threshold for the outlier rejection.
+   * @param num_threads The number of worker threads.
+   * @see merge_gate_images()
    */
   void merge_gate_images(LogicModel_shptr lmodel,
-			 ObjectSet gates);
+			 ObjectSet gates,
+			 double max_deviation = 0,
+			 unsigned int num_threads = 0);
 
   /**
    * Extract a partial image from the background images for several layers
@@ -0,0 +1,160 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <LogicModelIndex.h>
+#include <LogicModel.h>
+
+#include <algorithm>
+#include <boost/foreach.hpp>
+
+using namespace degate;
+
+LogicModelIndex::LogicModelIndex(LogicModel * _lmodel) : lmodel(_lmodel) {
+  if(lmodel == NULL) throw InvalidPointerException("Invalid pointer for parameter lmodel.");
+  sync_layers();
+}
+
+LogicModelIndex::~LogicModelIndex() {
+  BOOST_FOREACH(Layer_shptr layer, registered_layers) layer->remove_change_listener(this);
+}
+
+void LogicModelIndex::sync_layers() {
+
+  std::vector<Layer_shptr> current;
+  for(LogicModel::layer_collection::iterator iter = lmodel->layers_begin();
+      iter != lmodel->layers_end(); ++iter)
+    if(*iter != NULL) current.push_back(*iter);
+
+  BOOST_FOREACH(Layer_shptr layer, registered_layers)
+    if(std::find(current.begin(), current.end(), layer) == current.end()) {
+      layer->remove_change_listener(this);
+      for(Layer::object_iterator iter = layer->objects_begin(); iter != layer->objects_end(); ++iter)
+	remove((*iter)->get_object_id());
+    }
+
+  BOOST_FOREACH(Layer_shptr layer, current)
+    if(std::find(registered_layers.begin(), registered_layers.end(), layer) == registered_layers.end()) {
+      layer->add_change_listener(this);
+      for(Layer::object_iterator iter = layer->objects_begin(); iter != layer->objects_end(); ++iter)
+	insert(*iter);
+    }
+
+  registered_layers = current;
+}
+
+void LogicModelIndex::insert(PlacedLogicModelObject_shptr o) {
+
+  object_id_t id = o->get_object_id();
+  remove(id);
+
+  Record r;
+  r.object = o;
+  r.name = names.insert(o->get_name(), id);
+  r.description = descriptions.insert(o->get_description(), id);
+  r.gate_template = NULL;
+
+  if(Gate_shptr gate = std::tr1::dynamic_pointer_cast<Gate>(o)) {
+    if(gate->has_template()) {
+      r.gate_template = gate->get_gate_template().get();
+      template_gates[r.gate_template][id] = gate;
+    }
+  }
+
+  records[id] = r;
+}
+
+void LogicModelIndex::remove(object_id_t id) {
+
+  DenseObjectMap<Record>::iterator found = records.find(id);
+  if(found == records.end()) return;
+
+  Record const& r = found->second;
+  names.remove(r.name, id);
+  descriptions.remove(r.description, id);
+
+  if(r.gate_template != NULL) {
+    template_map::iterator t = template_gates.find(r.gate_template);
+    if(t != template_gates.end()) {
+      t->second.erase(id);
+      if(t->second.empty()) template_gates.erase(t);
+    }
+  }
+
+  records.erase(found);
+}
+
+LogicModelIndex::object_list LogicModelIndex::lookup(TextIndex const& index,
+						     std::string const& pattern,
+						     TextIndex::MATCH_MODE mode) const {
+  TextIndex::id_list ids;
+  index.find(pattern, mode, ids);
+
+  object_list result;
+  BOOST_FOREACH(object_id_t id, ids) {
+    DenseObjectMap<Record>::const_iterator found = records.find(id);
+    if(found != records.end()) result.push_back(found->second.object);
+  }
+  return result;
+}
+
+LogicModelIndex::gate_list LogicModelIndex::get_gates_by_template(GateTemplate_shptr tmpl) const {
+
+  gate_list result;
+  template_map::const_iterator t = template_gates.find(tmpl.get());
+  if(t != template_gates.end())
+    for(DenseObjectMap<Gate_shptr>::const_iterator iter = t->second.begin();
+	iter != t->second.end(); ++iter)
+      result.push_back(iter->second);
+  return result;
+}
+
+unsigned int LogicModelIndex::get_num_gates_by_template(GateTemplate_shptr tmpl) const {
+  template_map::const_iterator t = template_gates.find(tmpl.get());
+  return t != template_gates.end() ? t->second.size() : 0;
+}
+
+void LogicModelIndex::notify_object_added(PlacedLogicModelObject_shptr o) {
+  insert(o);
+}
+
+void LogicModelIndex::notify_object_removed(PlacedLogicModelObject_shptr o) {
+  remove(o->get_object_id());
+}
+
+void LogicModelIndex::notify_object_changed(PlacedLogicModelObject_shptr o) {
+
+  // Shape changes are irrelevant. Only reindex, if an indexed property changed.
+  DenseObjectMap<Record>::const_iterator found = records.find(o->get_object_id());
+  if(found != records.end()) {
+    Record const& r = found->second;
+
+    GateTemplate const * tmpl = NULL;
+    if(Gate_shptr gate = std::tr1::dynamic_pointer_cast<Gate>(o))
+      if(gate->has_template()) tmpl = gate->get_gate_template().get();
+
+    if((r.name == NULL ? o->get_name().empty() : *r.name == o->get_name()) &&
+       (r.description == NULL ? o->get_description().empty() : *r.description == o->get_description()) &&
+       r.gate_template == tmpl)
+      return;
+  }
+
+  insert(o);
+}
@@ -0,0 +1,144 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef __LOGICMODELINDEX_H__
+#define __LOGICMODELINDEX_H__
+
+#include <globals.h>
+#include <Layer.h>
+#include <DenseObjectMap.h>
+#include <TextIndex.h>
+
+#include <list>
+#include <map>
+#include <vector>
+#include <tr1/memory>
+#include <boost/utility.hpp>
+
+namespace degate {
+
+  /**
+   * Secondary indices for the placed objects of a LogicModel.
+   *
+   * The index maps names and descriptions to objects and gate templates to
+   * the gates, that use them. Lookups are O(log n + result) instead of a
+   * walk over all objects.
+   *
+   * The index registers itself as change listener on all layers of the
+   * logic model and is updated incrementally. Renaming an object, changing
+   * its description or the template of a gate is reported by the objects
+   * via the layer. The index keeps the indexed state of each object and
+   * compares it on a change notification, like the NetlistGraph does.
+   *
+   * The LogicModel owns an index. Use LogicModel::get_index() to access it.
+   */
+
+  class LogicModelIndex : public LayerChangeListener, boost::noncopyable {
+
+  public:
+
+    typedef std::list<PlacedLogicModelObject_shptr> object_list;
+    typedef std::list<Gate_shptr> gate_list;
+
+  private:
+
+    struct Record {
+      PlacedLogicModelObject_shptr object;
+      TextIndex::handle_type name;
+      TextIndex::handle_type description;
+      GateTemplate const * gate_template;
+    };
+
+    LogicModel * lmodel;
+    std::vector<Layer_shptr> registered_layers;
+
+    DenseObjectMap<Record> records;
+    TextIndex names;
+    TextIndex descriptions;
+
+    typedef std::map<GateTemplate const *, DenseObjectMap<Gate_shptr> > template_map;
+    template_map template_gates;
+
+    void insert(PlacedLogicModelObject_shptr o);
+    void remove(object_id_t id);
+
+    object_list lookup(TextIndex const& index, std::string const& pattern,
+		       TextIndex::MATCH_MODE mode) const;
+
+  public:
+
+    /**
+     * Create an index for a logic model and index the objects on its layers.
+     */
+    LogicModelIndex(LogicModel * lmodel);
+
+    /**
+     * Deregister the index from the layers.
+     */
+    virtual ~LogicModelIndex();
+
+    /**
+     * Register the index on layers, that were added to the logic model, and
+     * deregister it from layers, that were removed. The LogicModel calls this
+     * method, when its layers change.
+     */
+    void sync_layers();
+
+    /**
+     * Find objects by name.
+     */
+    object_list find_by_name(std::string const& pattern,
+			     TextIndex::MATCH_MODE mode = TextIndex::MATCH_EXACT) const {
+      return lookup(names, pattern, mode);
+    }
+
+    /**
+     * Find objects by description.
+     */
+    object_list find_by_description(std::string const& pattern,
+				    TextIndex::MATCH_MODE mode = TextIndex::MATCH_EXACT) const {
+      return lookup(descriptions, pattern, mode);
+    }
+
+    /**
+     * Get the gates, that use a gate template.
+     */
+    gate_list get_gates_by_template(GateTemplate_shptr tmpl) const;
+
+    /**
+     * Get the number of gates, that use a gate template.
+     */
+    unsigned int get_num_gates_by_template(GateTemplate_shptr tmpl) const;
+
+    /**
+     * Get the number of indexed objects.
+     */
+    unsigned int size() const { return records.size(); }
+
+    virtual void notify_object_added(PlacedLogicModelObject_shptr o);
+    virtual void notify_object_removed(PlacedLogicModelObject_shptr o);
+    virtual void notify_object_changed(PlacedLogicModelObject_shptr o);
+  };
+
+}
+
+#endif
@@ -27,50 +27,77 @@
 
 using namespace degate;
 
+static const std::string empty_string;
+
 LogicModelObjectBase::LogicModelObjectBase(object_id_t oid) :
-  object_id(oid) {
+  object_id(oid),
+  text(NULL) {
 }
 
 LogicModelObjectBase::LogicModelObjectBase(std::string const& object_name,
 					   std::string const& object_description) :
   object_id(0),
-  name(object_name),
-  description(object_description) {
+  text(NULL) {
+  set_name(object_name);
+  set_description(object_description);
 }
 
 LogicModelObjectBase::LogicModelObjectBase(object_id_t oid,
 					   std::string const& object_name,
 					   std::string const& object_description) :
   object_id(oid),
-  name(object_name),
-  description(object_description) {
+  text(NULL) {
+  set_name(object_name);
+  set_description(object_description);
+}
+
+LogicModelObjectBase::LogicModelObjectBase(LogicModelObjectBase const& other) :
+  object_id(other.object_id),
+  text(other.text == NULL ? NULL : new Text(*other.text)) {
+}
+
+LogicModelObjectBase & LogicModelObjectBase::operator=(LogicModelObjectBase const& other) {
+  if(this != &other) {
+    Text * copy = other.text == NULL ? NULL : new Text(*other.text);
+    delete text;
+    text = copy;
+    object_id = other.object_id;
+  }
+  return *this;
 }
 
 LogicModelObjectBase::~LogicModelObjectBase() {
+  delete text;
+}
+
+LogicModelObjectBase::Text & LogicModelObjectBase::get_text() {
+  if(text == NULL) text = new Text();
+  return *text;
 }
 
 void LogicModelObjectBase::set_name(std::string const& name) {
-  this->name = name;
+  // Don't allocate the text record for empty strings.
+  if(text != NULL || !name.empty()) get_text().name = name;
 }
 
 void LogicModelObjectBase::set_description(std::string const & description) {
-  this->description = description;
+  if(text != NULL || !description.empty()) get_text().description = description;
 }
 
 std::string const & LogicModelObjectBase::get_name() const {
-  return name;
+  return text == NULL ? empty_string : text->name;
 }
 
 std::string const & LogicModelObjectBase::get_description() const {
-  return description;
+  return text == NULL ? empty_string : text->description;
 }
 
 bool LogicModelObjectBase::has_name() const {
-  return !name.empty();
+  return text != NULL && !text->name.empty();
 }
 
 bool LogicModelObjectBase::has_description() const {
-  return !description.empty();
+  return text != NULL && !text->description.empty();
 }
 
 
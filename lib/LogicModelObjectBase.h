@@ -35,10 +35,21 @@ namespace degate {
 
   private:
 
+    /**
+     * Most wires, vias and ports have neither a name nor a description.
+     * Both strings are kept in a separate record, that is only allocated,
+     * if one of them is set.
+     */
+    struct Text {
+      std::string name;
+      std::string description;
+    };
+
     object_id_t object_id;
 
-    std::string name;
-    std::string description;
+    Text * text;
+
+    Text & get_text();
 
   public:
 
@@ -63,6 +74,14 @@ namespace degate {
 			 std::string const& object_name,
 			 std::string const& object_description);
 
+    /**
+     * The copy constructor.
+     */
+
+    LogicModelObjectBase(LogicModelObjectBase const& other);
+
+    LogicModelObjectBase & operator=(LogicModelObjectBase const& other);
+
     /**
      * The dtor.
      */
@@ -0,0 +1,136 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <LogicModelSnapshot.h>
+#include <Gate.h>
+
+#include <algorithm>
+#include <boost/format.hpp>
+
+using namespace degate;
+
+LogicModelSnapshot::LogicModelSnapshot(LogicModel_shptr lmodel, unsigned int _cell_size) :
+  cell_size(std::max(_cell_size, 1U)) {
+
+  if(lmodel == NULL) throw InvalidPointerException("Invalid pointer for parameter lmodel.");
+
+  layers.resize(lmodel->get_num_layers());
+
+  for(layer_position_t pos = 0; pos < layers.size(); pos++) {
+
+    LayerIndex & index = layers[pos];
+    Layer_shptr layer = lmodel->get_layer(pos);
+
+    unsigned int width = layer != NULL ? layer->get_width() : 0;
+    unsigned int height = layer != NULL ? layer->get_height() : 0;
+
+    index.cells_x = std::max((width + cell_size - 1) / cell_size, 1U);
+    index.cells_y = std::max((height + cell_size - 1) / cell_size, 1U);
+    index.cells.resize(index.cells_x * index.cells_y);
+
+    if(layer == NULL) continue;
+
+    for(Layer::object_iterator iter = layer->objects_begin();
+	iter != layer->objects_end(); ++iter) {
+      PlacedLogicModelObject_shptr o = *iter;
+      insert(index, o->get_bounding_box(), o);
+    }
+  }
+}
+
+LogicModelSnapshot::LayerIndex const&
+LogicModelSnapshot::get_layer_index(layer_position_t layer_pos) const {
+  if(layer_pos >= layers.size()) {
+    boost::format f("There is no layer at position %1% in the snapshot.");
+    f % layer_pos;
+    throw DegateRuntimeException(f.str());
+  }
+  return layers[layer_pos];
+}
+
+void LogicModelSnapshot::get_cell_range(LayerIndex const& index, BoundingBox const& bbox,
+					unsigned int & min_cx, unsigned int & max_cx,
+					unsigned int & min_cy, unsigned int & max_cy) const {
+
+  // Objects outside of the layer are kept in the border cells.
+  min_cx = std::min<unsigned int>(std::max(bbox.get_min_x(), 0) / cell_size, index.cells_x - 1);
+  max_cx = std::min<unsigned int>(std::max(bbox.get_max_x(), 0) / cell_size, index.cells_x - 1);
+  min_cy = std::min<unsigned int>(std::max(bbox.get_min_y(), 0) / cell_size, index.cells_y - 1);
+  max_cy = std::min<unsigned int>(std::max(bbox.get_max_y(), 0) / cell_size, index.cells_y - 1);
+}
+
+void LogicModelSnapshot::insert(LayerIndex & index, BoundingBox const& bbox,
+				PlacedLogicModelObject_shptr o) {
+
+  Entry e;
+  e.bbox = bbox;
+  e.object = o;
+  index.entries.push_back(e);
+
+  unsigned int entry_pos = index.entries.size() - 1;
+
+  unsigned int min_cx, max_cx, min_cy, max_cy;
+  get_cell_range(index, bbox, min_cx, max_cx, min_cy, max_cy);
+
+  for(unsigned int cy = min_cy; cy <= max_cy; cy++)
+    for(unsigned int cx = min_cx; cx <= max_cx; cx++)
+      index.cells[cy * index.cells_x + cx].push_back(entry_pos);
+}
+
+unsigned int LogicModelSnapshot::get_distance_to_gate_boundary(layer_position_t layer_pos,
+							       unsigned int x, unsigned int y,
+							       bool query_horizontal_distance,
+							       unsigned int width,
+							       unsigned int height) const {
+
+  LayerIndex const& index = get_layer_index(layer_pos);
+  BoundingBox region(x, x + width, y, y + height);
+
+  unsigned int min_cx, max_cx, min_cy, max_cy;
+  get_cell_range(index, region, min_cx, max_cx, min_cy, max_cy);
+
+  unsigned int dist = 0;
+
+  for(unsigned int cy = min_cy; cy <= max_cy; cy++)
+    for(unsigned int cx = min_cx; cx <= max_cx; cx++) {
+      std::vector<unsigned int> const& cell = index.cells[cy * index.cells_x + cx];
+      for(std::vector<unsigned int>::const_iterator iter = cell.begin(); iter != cell.end(); ++iter) {
+
+	Entry const& e = index.entries[*iter];
+
+	if(e.bbox.intersects(region) &&
+	   std::tr1::dynamic_pointer_cast<Gate>(e.object) != NULL) {
+
+	  unsigned int d = query_horizontal_distance ?
+	    e.bbox.get_max_x() - x : e.bbox.get_max_y() - y;
+	  dist = std::max(dist, d);
+	}
+      }
+    }
+
+  return dist;
+}
+
+void LogicModelSnapshot::add_object(layer_position_t layer_pos, PlacedLogicModelObject_shptr o) {
+  if(o == NULL) throw InvalidPointerException("Invalid pointer for parameter o.");
+  get_layer_index(layer_pos); // check the layer position
+  insert(layers[layer_pos], o->get_bounding_box(), o);
+}
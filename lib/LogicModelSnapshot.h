@@ -0,0 +1,184 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef __LOGICMODELSNAPSHOT_H__
+#define __LOGICMODELSNAPSHOT_H__
+
+#include <globals.h>
+#include <LogicModel.h>
+#include <BoundingBox.h>
+
+#include <vector>
+#include <tr1/memory>
+
+namespace degate {
+
+  /**
+   * A read-only copy of the spatial structure of a logic model.
+   *
+   * Matching algorithms run in a worker thread, while the editor keeps
+   * changing the logic model. The layer quadtrees and the object maps are
+   * not thread-safe, therefore workers must not query them. Instead a
+   * snapshot is taken in the thread that owns the logic model and is then
+   * handed to the worker.
+   *
+   * The snapshot stores the bounding box and a pointer for each placed object.
+   * It does not copy the objects themselves. Taking a snapshot is a single
+   * pass over the layers. The bounding boxes are copies, so later changes of
+   * object positions in the editor do not affect queries on the snapshot.
+   *
+   * Objects are indexed in a uniform grid of square cells. An object is
+   * registered in each cell, that it overlaps.
+   *
+   * Algorithms add their own results with add_object(), so that queries
+   * see them, but the logic model is not touched. The results are applied
+   * to the logic model with a LogicModelTransaction.
+   */
+
+  class LogicModelSnapshot {
+
+  public:
+
+    /**
+     * A placed object and its bounding box at the time the snapshot was taken.
+     */
+    struct Entry {
+      BoundingBox bbox;
+      PlacedLogicModelObject_shptr object;
+    };
+
+    typedef std::vector<Entry> entry_list;
+
+  private:
+
+    struct LayerIndex {
+      unsigned int cells_x, cells_y;
+      entry_list entries;
+      std::vector<std::vector<unsigned int> > cells;
+    };
+
+    std::vector<LayerIndex> layers;
+    unsigned int cell_size;
+
+    LayerIndex const& get_layer_index(layer_position_t layer_pos) const;
+
+    void get_cell_range(LayerIndex const& index, BoundingBox const& bbox,
+			unsigned int & min_cx, unsigned int & max_cx,
+			unsigned int & min_cy, unsigned int & max_cy) const;
+
+    void insert(LayerIndex & index, BoundingBox const& bbox, PlacedLogicModelObject_shptr o);
+
+  public:
+
+    /**
+     * Take a snapshot of all layers of a logic model.
+     * @param lmodel The logic model.
+     * @param cell_size The edge length of a grid cell in pixel.
+     * @exception InvalidPointerException This exception is thrown, if \p lmodel
+     *   is a NULL pointer.
+     */
+    LogicModelSnapshot(LogicModel_shptr lmodel, unsigned int cell_size = 256);
+
+    /**
+     * Get the number of layers.
+     */
+    unsigned int get_num_layers() const { return layers.size(); }
+
+    /**
+     * Get the number of objects on a layer.
+     * @exception DegateRuntimeException This exception is thrown, if there
+     *   is no layer at \p layer_pos.
+     */
+    unsigned int get_num_objects(layer_position_t layer_pos) const {
+      return get_layer_index(layer_pos).entries.size();
+    }
+
+    /**
+     * Get all objects on a layer.
+     * @exception DegateRuntimeException This exception is thrown, if there
+     *   is no layer at \p layer_pos.
+     */
+    entry_list const& get_entries(layer_position_t layer_pos) const {
+      return get_layer_index(layer_pos).entries;
+    }
+
+    /**
+     * Check for objects in a region of the type given by the template parameter.
+     * This is the counterpart of Layer::exists_type_in_region().
+     * @return Returns true, if there is an object of the specified type,
+     *   whose bounding box intersects the region.
+     */
+    template<typename LogicModelObjectType>
+    bool exists_type_in_region(layer_position_t layer_pos,
+			       unsigned int min_x, unsigned int max_x,
+			       unsigned int min_y, unsigned int max_y) const {
+
+      LayerIndex const& index = get_layer_index(layer_pos);
+      BoundingBox region(min_x, max_x, min_y, max_y);
+
+      unsigned int min_cx, max_cx, min_cy, max_cy;
+      get_cell_range(index, region, min_cx, max_cx, min_cy, max_cy);
+
+      for(unsigned int cy = min_cy; cy <= max_cy; cy++)
+	for(unsigned int cx = min_cx; cx <= max_cx; cx++) {
+	  std::vector<unsigned int> const& cell = index.cells[cy * index.cells_x + cx];
+	  for(std::vector<unsigned int>::const_iterator iter = cell.begin(); iter != cell.end(); ++iter) {
+	    Entry const& e = index.entries[*iter];
+	    if(e.bbox.intersects(region) &&
+	       std::tr1::dynamic_pointer_cast<LogicModelObjectType>(e.object) != NULL)
+	      return true;
+	  }
+	}
+
+      return false;
+    }
+
+    /**
+     * Check for gates in a region and return the distance to their boundary.
+     * This is the counterpart of Layer::get_distance_to_gate_boundary().
+     * If there is more than one gate in the region, the largest distance is
+     * returned.
+     * @return Returns the distance from \p x to the right boundary or
+     *   from \p y to the bottom boundary depending on \p query_horizontal_distance.
+     *   If there is no gate, this method returns 0.
+     */
+    unsigned int get_distance_to_gate_boundary(layer_position_t layer_pos,
+					       unsigned int x, unsigned int y,
+					       bool query_horizontal_distance = true,
+					       unsigned int width = 0,
+					       unsigned int height = 0) const;
+
+    /**
+     * Add an object to the snapshot. The logic model is not changed.
+     * @exception DegateRuntimeException This exception is thrown, if there
+     *   is no layer at \p layer_pos.
+     * @exception InvalidPointerException This exception is thrown, if \p o
+     *   is a NULL pointer.
+     */
+    void add_object(layer_position_t layer_pos, PlacedLogicModelObject_shptr o);
+
+  };
+
+  typedef std::tr1::shared_ptr<LogicModelSnapshot> LogicModelSnapshot_shptr;
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <LogicModelTransaction.h>
+
+#include <typeinfo>
+#include <boost/foreach.hpp>
+
+using namespace degate;
+
+void LogicModelTransaction::add_object(layer_position_t layer_pos, PlacedLogicModelObject_shptr o,
+				       CONFLICT_POLICY policy) {
+  if(o == NULL) throw InvalidPointerException("Invalid pointer for parameter o.");
+
+  Operation op;
+  op.layer_pos = layer_pos;
+  op.object = o;
+  op.policy = policy;
+  operations.push_back(op);
+}
+
+void LogicModelTransaction::add_gate(layer_position_t layer_pos, Gate_shptr gate,
+				     GateTemplate_shptr tmpl, CONFLICT_POLICY policy) {
+  if(gate == NULL) throw InvalidPointerException("Invalid pointer for parameter gate.");
+  if(tmpl == NULL) throw InvalidPointerException("Invalid pointer for parameter tmpl.");
+
+  Operation op;
+  op.layer_pos = layer_pos;
+  op.object = gate;
+  op.gate_template = tmpl;
+  op.policy = policy;
+  operations.push_back(op);
+}
+
+bool LogicModelTransaction::is_occupied(LogicModel_shptr lmodel, Operation const& op) const {
+
+  if(op.layer_pos >= lmodel->get_num_layers()) return false;
+  Layer_shptr layer = lmodel->get_layer(op.layer_pos);
+  if(layer == NULL) return false;
+
+  PlacedLogicModelObject const& o = *op.object;
+
+  for(Layer::qt_region_iterator iter = layer->region_begin(o.get_bounding_box());
+      iter != layer->region_end(); ++iter)
+    if(typeid(**iter) == typeid(o)) return true;
+
+  return false;
+}
+
+unsigned int LogicModelTransaction::commit(LogicModel_shptr lmodel) {
+
+  if(lmodel == NULL) throw InvalidPointerException("Invalid pointer for parameter lmodel.");
+
+  std::vector<PlacedLogicModelObject_shptr> applied;
+  std::vector<Gate_shptr> templated;
+  num_skipped = 0;
+
+  try {
+    BOOST_FOREACH(Operation const& op, operations) {
+
+      if(op.policy == SKIP_IF_OCCUPIED && is_occupied(lmodel, op)) {
+	num_skipped++;
+	continue;
+      }
+
+      Gate_shptr gate = std::tr1::dynamic_pointer_cast<Gate>(op.object);
+      if(gate != NULL && op.gate_template != NULL) {
+	gate->set_gate_template(op.gate_template);
+	templated.push_back(gate);
+      }
+
+      lmodel->add_object(op.layer_pos, op.object);
+      applied.push_back(op.object);
+
+      if(gate != NULL && op.gate_template != NULL)
+	lmodel->update_ports(gate);
+    }
+  }
+  catch(...) {
+    // undo in reverse order
+    for(std::vector<PlacedLogicModelObject_shptr>::reverse_iterator iter = applied.rbegin();
+	iter != applied.rend(); ++iter)
+      lmodel->remove_object(*iter);
+
+    // Release the templates, including the one of a gate, that was not inserted.
+    BOOST_FOREACH(Gate_shptr gate, templated) gate->remove_template();
+    throw;
+  }
+
+  operations.clear();
+  return applied.size();
+}
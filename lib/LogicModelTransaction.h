@@ -0,0 +1,132 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef __LOGICMODELTRANSACTION_H__
+#define __LOGICMODELTRANSACTION_H__
+
+#include <globals.h>
+#include <LogicModel.h>
+#include <Gate.h>
+
+#include <vector>
+#include <tr1/memory>
+
+namespace degate {
+
+  /**
+   * A batch of insertions into a logic model, that is applied as a whole.
+   *
+   * A worker thread collects its results in a transaction instead of
+   * changing the logic model directly. The thread that owns the logic model
+   * applies the transaction with commit(). Either all operations are applied
+   * or, if an operation fails, the operations applied so far are undone.
+   *
+   * Because the logic model may have changed since the worker took its
+   * snapshot, an operation can be made conditional: with SKIP_IF_OCCUPIED the
+   * object is not inserted, if an object of the same type already intersects
+   * its bounding box.
+   */
+
+  class LogicModelTransaction {
+
+  public:
+
+    enum CONFLICT_POLICY {
+      INSERT_ALWAYS = 0,
+      SKIP_IF_OCCUPIED = 1
+    };
+
+  private:
+
+    struct Operation {
+      layer_position_t layer_pos;
+      PlacedLogicModelObject_shptr object;
+      GateTemplate_shptr gate_template;
+      CONFLICT_POLICY policy;
+    };
+
+    std::vector<Operation> operations;
+    unsigned int num_skipped;
+
+    bool is_occupied(LogicModel_shptr lmodel, Operation const& op) const;
+
+  public:
+
+    LogicModelTransaction() : num_skipped(0) {}
+
+    /**
+     * Record the insertion of an object.
+     * @exception InvalidPointerException This exception is thrown, if \p o
+     *   is a NULL pointer.
+     */
+    void add_object(layer_position_t layer_pos, PlacedLogicModelObject_shptr o,
+		    CONFLICT_POLICY policy = INSERT_ALWAYS);
+
+    /**
+     * Record the insertion of a gate. The gate template is set on commit,
+     * because setting it changes the template's reference counter. The
+     * gate ports are updated after the insertion.
+     * @exception InvalidPointerException This exception is thrown, if \p gate
+     *   or \p tmpl is a NULL pointer.
+     */
+    void add_gate(layer_position_t layer_pos, Gate_shptr gate, GateTemplate_shptr tmpl,
+		  CONFLICT_POLICY policy = SKIP_IF_OCCUPIED);
+
+    /**
+     * Get the number of recorded operations.
+     */
+    unsigned int size() const { return operations.size(); }
+
+    /**
+     * Check if there are no recorded operations.
+     */
+    bool empty() const { return operations.empty(); }
+
+    /**
+     * Drop all recorded operations.
+     */
+    void clear() { operations.clear(); }
+
+    /**
+     * Apply the recorded operations to a logic model. Call this method
+     * from the thread that owns the logic model. Afterwards the transaction
+     * is empty.
+     * @return Returns the number of inserted objects.
+     * @exception InvalidPointerException This exception is thrown, if \p lmodel
+     *   is a NULL pointer.
+     * @exception DegateRuntimeException Exceptions from the logic model are passed
+     *   through after the operations applied so far are undone.
+     */
+    unsigned int commit(LogicModel_shptr lmodel);
+
+    /**
+     * Get the number of objects, that were skipped by the last commit(),
+     * because their region was occupied.
+     */
+    unsigned int get_num_skipped() const { return num_skipped; }
+
+  };
+
+  typedef std::tr1::shared_ptr<LogicModelTransaction> LogicModelTransaction_shptr;
+}
+
+#endif
@@ -0,0 +1,427 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <LookupSubcircuit.h>
+#include <Module.h>
+#include <DenseObjectMap.h>
+
+#include <boost/foreach.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <map>
+
+using namespace degate;
+
+namespace {
+
+  typedef NetlistGraph::index_t index_t;
+
+  /**
+   * A pattern, that is prepared for matching against a netlist graph.
+   */
+  struct CompiledPattern {
+
+    struct Port {
+      index_t name;        // port name ID
+      unsigned int net;    // pattern net
+    };
+
+    unsigned int num_gates, num_nets;
+
+    // matching order of the pattern gates
+    std::vector<unsigned int> order;
+
+    // For order[k]: a port, that is connected to a pattern net of an earlier
+    // gate in the matching order. Candidates are taken from that net only.
+    std::vector<bool> has_anchor;
+    std::vector<Port> anchor;
+
+    std::vector<std::vector<Port> > gate_ports;
+    std::vector<std::vector<bool> > class_masks;
+    std::vector<unsigned int> net_sizes;
+
+    // port index -> port name ID or no_index, if the name is not used in the pattern
+    std::vector<index_t> host_port_names;
+
+    // false, if a pattern port name does not exist in the logic model
+    bool satisfiable;
+
+    CompiledPattern(SubcircuitPattern const& pattern, NetlistGraph const& graph);
+
+    /**
+     * Find the port of a host gate with a port name ID.
+     */
+    index_t find_port(NetlistGraph const& graph, index_t g, index_t name) const {
+      for(index_t p = graph.get_first_port(g); p < graph.get_end_port(g); p++)
+	if(host_port_names[p] == name) return p;
+      return NetlistGraph::no_index;
+    }
+
+  };
+
+  CompiledPattern::CompiledPattern(SubcircuitPattern const& pattern, NetlistGraph const& graph) :
+    num_gates(pattern.get_num_gates()),
+    num_nets(pattern.get_num_nets()),
+    gate_ports(pattern.get_num_gates()),
+    class_masks(pattern.get_num_gates()),
+    satisfiable(true) {
+
+    // intern the port names of the pattern
+    std::map<std::string, index_t> names;
+    for(unsigned int g = 0; g < num_gates; g++) {
+      graph.match_logic_class(pattern.get_gate(g).logic_class, class_masks[g]);
+
+      BOOST_FOREACH(SubcircuitPattern::PatternPort const& pp, pattern.get_gate(g).ports) {
+	Port p;
+	p.name = names.insert(std::make_pair(pp.name, (index_t)names.size())).first->second;
+	p.net = pp.net;
+	gate_ports[g].push_back(p);
+      }
+    }
+
+    for(unsigned int n = 0; n < num_nets; n++) net_sizes.push_back(pattern.get_net_size(n));
+
+    std::vector<bool> name_found(names.size(), false);
+    host_port_names.resize(graph.get_num_ports(), NetlistGraph::no_index);
+
+    // Ports of the same template port share the name. Resolve each template port once.
+    DenseObjectMap<index_t> template_port_names;
+
+    for(index_t p = 0; p < graph.get_num_ports(); p++) {
+      GatePort_shptr const& gport = graph.get_port(p);
+      if(!gport->has_template_port()) continue;
+
+      GateTemplatePort_shptr tmpl_port = gport->get_template_port();
+      DenseObjectMap<index_t>::const_iterator cached = template_port_names.find(tmpl_port->get_object_id());
+
+      if(cached == template_port_names.end()) {
+	std::map<std::string, index_t>::const_iterator found = names.find(tmpl_port->get_name());
+	index_t name = found != names.end() ? found->second : NetlistGraph::no_index;
+	cached = template_port_names.insert(std::make_pair(tmpl_port->get_object_id(), name)).first;
+      }
+
+      host_port_names[p] = cached->second;
+      if(cached->second != NetlistGraph::no_index) name_found[cached->second] = true;
+    }
+
+    if(std::find(name_found.begin(), name_found.end(), false) != name_found.end())
+      satisfiable = false;
+
+    // Determine the matching order. Gates, that share a net with already
+    // ordered gates, come first.
+    std::vector<bool> ordered(num_gates, false), net_reached(num_nets, false);
+
+    while(order.size() < num_gates) {
+
+      unsigned int next = num_gates;
+      Port next_anchor;
+
+      for(unsigned int g = 0; g < num_gates && next == num_gates; g++) {
+	if(ordered[g]) continue;
+	BOOST_FOREACH(Port const& p, gate_ports[g])
+	  if(net_reached[p.net]) {
+	    next = g;
+	    next_anchor = p;
+	    break;
+	  }
+      }
+
+      if(next == num_gates) { // start a new connected part
+	next = std::find(ordered.begin(), ordered.end(), false) - ordered.begin();
+	has_anchor.push_back(false);
+	anchor.push_back(Port());
+      }
+      else {
+	has_anchor.push_back(true);
+	anchor.push_back(next_anchor);
+      }
+
+      order.push_back(next);
+      ordered[next] = true;
+      BOOST_FOREACH(Port const& p, gate_ports[next]) net_reached[p.net] = true;
+    }
+  }
+
+
+  /**
+   * The backtracking search for one or more seeds.
+   */
+  class Matcher {
+
+  private:
+
+    NetlistGraph const& graph;
+    CompiledPattern const& cp;
+
+    std::vector<index_t> core_gate; // pattern gate -> gate
+    std::vector<index_t> core_net;  // pattern net -> net
+
+    std::vector<std::vector<index_t> > & results;
+
+    bool is_gate_used(index_t h, unsigned int depth) const {
+      for(unsigned int k = 0; k < depth; k++)
+	if(core_gate[cp.order[k]] == h) return true;
+      return false;
+    }
+
+    bool is_net_used(index_t n) const {
+      return std::find(core_net.begin(), core_net.end(), n) != core_net.end();
+    }
+
+    /**
+     * Check if a gate is feasible for a pattern gate. If it is, the
+     * pattern nets of the gate are mapped.
+     * @param new_nets Pattern nets, that were mapped by this call.
+     */
+    bool assign(unsigned int pg, index_t h, std::vector<unsigned int> & new_nets) {
+
+      if(!cp.class_masks[pg][graph.get_logic_class(h)]) return false;
+
+      BOOST_FOREACH(CompiledPattern::Port const& pp, cp.gate_ports[pg]) {
+
+	index_t p = cp.find_port(graph, h, pp.name);
+	if(p == NetlistGraph::no_index) return false;
+
+	index_t n = graph.get_port_net(p);
+	if(n == NetlistGraph::no_index) return false;
+
+	if(core_net[pp.net] != NetlistGraph::no_index) {
+	  if(core_net[pp.net] != n) return false;
+	}
+	else {
+	  NetlistGraph::index_range ports = graph.get_net_ports(n);
+	  if((unsigned int)(ports.second - ports.first) < cp.net_sizes[pp.net] || is_net_used(n))
+	    return false;
+	  core_net[pp.net] = n;
+	  new_nets.push_back(pp.net);
+	}
+      }
+
+      return true;
+    }
+
+    void try_candidate(unsigned int depth, index_t h) {
+
+      unsigned int pg = cp.order[depth];
+      if(is_gate_used(h, depth)) return;
+
+      std::vector<unsigned int> new_nets;
+
+      if(assign(pg, h, new_nets)) {
+	core_gate[pg] = h;
+	match(depth + 1);
+	core_gate[pg] = NetlistGraph::no_index;
+      }
+
+      BOOST_FOREACH(unsigned int n, new_nets) core_net[n] = NetlistGraph::no_index;
+    }
+
+    void match(unsigned int depth) {
+
+      if(depth == cp.num_gates) {
+	results.push_back(core_gate);
+	return;
+      }
+
+      if(cp.has_anchor[depth]) {
+	CompiledPattern::Port const& a = cp.anchor[depth];
+	NetlistGraph::index_range ports = graph.get_net_ports(core_net[a.net]);
+
+	for(index_t const * p = ports.first; p != ports.second; ++p)
+	  if(cp.host_port_names[*p] == a.name) try_candidate(depth, graph.get_port_gate(*p));
+      }
+      else {
+	for(index_t h = 0; h < graph.get_num_gates(); h++) try_candidate(depth, h);
+      }
+    }
+
+  public:
+
+    Matcher(NetlistGraph const& _graph, CompiledPattern const& _cp,
+	    std::vector<std::vector<index_t> > & _results) :
+      graph(_graph),
+      cp(_cp),
+      core_gate(_cp.num_gates, NetlistGraph::no_index),
+      core_net(_cp.num_nets, NetlistGraph::no_index),
+      results(_results) {
+    }
+
+    /**
+     * Find all matches, that map the first pattern gate in matching order to \p h.
+     */
+    void run_seed(index_t h) {
+      try_candidate(0, h);
+    }
+  };
+
+
+  /**
+   * Searches a part of the seeds in a worker thread. Worker i handles
+   * the seeds i, i + step, i + 2 * step, ...
+   */
+  struct SearchWorker {
+
+    NetlistGraph const * graph;
+    CompiledPattern const * cp;
+    std::vector<index_t> const * seeds;
+    std::vector<std::vector<index_t> > * results;
+    unsigned int first, step;
+
+    void operator()() {
+      Matcher m(*graph, *cp, *results);
+      for(unsigned int i = first; i < seeds->size(); i += step) m.run_seed((*seeds)[i]);
+    }
+  };
+
+}
+
+
+LookupSubcircuit::LookupSubcircuit(LogicModel_shptr _lmodel) : lmodel(_lmodel) {
+  if(lmodel == NULL)
+    throw InvalidPointerException("Invalid logic model passed to LookupSubcircuit().");
+}
+
+
+LookupSubcircuit::match_list LookupSubcircuit::search(SubcircuitPattern const& pattern,
+						      unsigned int num_threads) const {
+
+  match_list matches;
+  if(pattern.get_num_gates() == 0) return matches;
+
+  // The graph must be up to date, before it is shared with the workers.
+  NetlistGraph_shptr graph = lmodel->get_netlist_graph();
+
+  CompiledPattern cp(pattern, *graph);
+  if(!cp.satisfiable) return matches;
+
+  std::vector<index_t> seeds;
+  std::vector<bool> const& seed_mask = cp.class_masks[cp.order[0]];
+  for(index_t g = 0; g < graph->get_num_gates(); g++)
+    if(seed_mask[graph->get_logic_class(g)]) seeds.push_back(g);
+
+  if(num_threads == 0) num_threads = std::max(boost::thread::hardware_concurrency(), 1U);
+  num_threads = std::min<unsigned int>(num_threads, std::max<size_t>(seeds.size(), 1));
+
+  std::vector<std::vector<std::vector<index_t> > > results(num_threads);
+
+  if(num_threads == 1) {
+    Matcher m(*graph, cp, results[0]);
+    BOOST_FOREACH(index_t g, seeds) m.run_seed(g);
+  }
+  else {
+    boost::thread_group threads;
+    for(unsigned int t = 0; t < num_threads; t++) {
+      SearchWorker w;
+      w.graph = graph.get();
+      w.cp = &cp;
+      w.seeds = &seeds;
+      w.results = &results[t];
+      w.first = t;
+      w.step = num_threads;
+      threads.create_thread(w);
+    }
+    threads.join_all();
+  }
+
+  // Merge the results. Gate indices are ordered by object ID, therefore sorting
+  // makes the result independent from the number of threads. Symmetric patterns
+  // match the same gates multiple times. Keep the first of these matches.
+  std::vector<std::vector<index_t> > all;
+  BOOST_FOREACH(std::vector<std::vector<index_t> > const& r, results)
+    all.insert(all.end(), r.begin(), r.end());
+  std::sort(all.begin(), all.end());
+
+  std::set<std::vector<index_t> > seen;
+  BOOST_FOREACH(std::vector<index_t> const& r, all) {
+    std::vector<index_t> key(r);
+    std::sort(key.begin(), key.end());
+    if(!seen.insert(key).second) continue;
+
+    match m;
+    BOOST_FOREACH(index_t g, r) m.push_back(graph->get_gate(g));
+    matches.push_back(m);
+  }
+
+  return matches;
+}
+
+
+Module_shptr LookupSubcircuit::create_module(match const& m,
+					     std::string const& module_name,
+					     std::string const& entity_name) const {
+
+  Module_shptr main_module = lmodel->get_main_module();
+
+  Module_shptr module(new Module(module_name, entity_name));
+  module->set_object_id(lmodel->get_new_object_id());
+
+  BOOST_FOREACH(Gate_shptr gate, m) {
+    main_module->remove_gate(gate);
+    module->add_gate(gate, false);
+  }
+
+  main_module->add_module(module);
+  module->determine_module_ports();
+
+  return module;
+}
+
+
+std::set<Gate_shptr> LookupSubcircuit::filter_connected_gates(Gate_shptr gate,
+							      GateTemplatePort::PORT_TYPE src_port_type,
+							      std::string const& src_port_name,
+							      std::string const& logic_class,
+							      GateTemplatePort::PORT_TYPE dst_port_type,
+							      std::string const& dst_port_name) const {
+
+  std::set<Gate_shptr> connected;
+
+  NetlistGraph_shptr graph = lmodel->get_netlist_graph();
+  NetlistGraph::index_t g = graph->get_gate_index(gate->get_object_id());
+  if(g == NetlistGraph::no_index) return connected;
+
+  std::vector<bool> class_mask;
+  graph->match_logic_class(logic_class, class_mask);
+
+  for(NetlistGraph::index_t p = graph->get_first_port(g); p < graph->get_end_port(g); p++) {
+
+    NetlistGraph::index_t n = graph->get_port_net(p);
+    if(graph->get_port_type(p) != src_port_type || n == NetlistGraph::no_index) continue;
+
+    if(!src_port_name.empty() &&
+       src_port_name != get_template_port_name(graph->get_port(p))) continue;
+
+    NetlistGraph::index_range others = graph->get_net_ports(n);
+    for(NetlistGraph::index_t const * q = others.first; q != others.second; ++q) {
+
+      NetlistGraph::index_t other_gate = graph->get_port_gate(*q);
+
+      if(*q != p &&
+	 class_mask[graph->get_logic_class(other_gate)] &&
+	 graph->get_port_type(*q) == dst_port_type &&
+	 (dst_port_name.empty() ||
+	  dst_port_name == get_template_port_name(graph->get_port(*q))))
+	connected.insert(graph->get_gate(other_gate));
+    }
+  }
+  return connected;
+}
@@ -23,150 +23,97 @@
 #define __LOOKUPSUBCIRCUIT_H__
 
 #include <set>
+#include <vector>
 #include <tr1/memory>
 #include <string>
 
 #include <degate.h>
 #include <LogicModelHelper.h>
-
-#include <boost/foreach.hpp>
+#include <NetlistGraph.h>
+#include <SubcircuitPattern.h>
 
 namespace degate {
 
+  /**
+   * Search for instances of a subcircuit pattern in a logic model.
+   *
+   * The search is a VF2-style backtracking search on the netlist graph of
+   * the logic model. Pattern gates are matched in an order, in which each
+   * gate is connected to an already matched gate, if possible. Candidates
+   * for the next pattern gate are then taken from a single net only. Candidates
+   * are pruned by logic class, port names and net sizes, before the search
+   * descends.
+   *
+   * Each gate, that matches the first pattern gate, is a seed for an
+   * independent search. Seeds are distributed over worker threads. The logic
+   * model must not be modified during a search.
+   */
 
   class LookupSubcircuit {
 
-  private:
-
-    LogicModel_shptr lmodel;
-    std::list<Gate_shptr> openlist;
+  public:
 
-  protected:
+    /**
+     * A match is a list of gates. The n-th gate corresponds to the
+     * n-th pattern gate.
+     */
+    typedef std::vector<Gate_shptr> match;
+    typedef std::vector<match> match_list;
 
-    virtual void initialize_openlist() {
-      // initialize openlist
-      for(LogicModel::gate_collection::const_iterator iter = lmodel->gates_begin();
-	  iter != lmodel->gates_end(); ++iter) {
-	Gate_shptr gate = iter->second;
-	assert(gate != NULL);
+  private:
 
-	if(is_logic_class(gate, "flipflop") ||
-	   is_logic_class(gate, "xor") ||
-	   is_logic_class(gate, "xnor")) openlist.push_back(gate);
-      }
-    }
+    LogicModel_shptr lmodel;
 
   public:
 
 
     /**
-     * Construct a new net.
+     * Create a lookup for a logic model.
      */
 
-    LookupSubcircuit(LogicModel_shptr _lmodel) : lmodel(_lmodel) {
-    }
+    LookupSubcircuit(LogicModel_shptr _lmodel);
 
     /**
      * Destroy.
      */
     virtual ~LookupSubcircuit() {}
 
-    virtual void search() {
-
-      initialize_openlist();
-
-
-      Gate_shptr g = openlist.front();
-      openlist.pop_front();
-
-      /*
-      trace_recursive(g);
-
-      BOOST_FOREACH(Gate_shptr gate, openlist) {
-
-
-      }
-      */
-    }
-
-    void trace_recursive(Gate_shptr start_gate, std::set<Gate_shptr> & closed_list) {
-      std::cout << "Gate " << start_gate->get_descriptive_identifier() << " connected with: " << std::endl;
-
-      std::set<Gate_shptr> other_gates;
-
-      BOOST_FOREACH(Gate_shptr g,
-		    filter_connected_gates(start_gate, GateTemplatePort::PORT_TYPE_OUT, "Q",
-					   "flipflop", GateTemplatePort::PORT_TYPE_IN, "D"))
-	if(closed_list.find(g) != closed_list.end()) {
-	  other_gates.insert(g);
-	  closed_list.insert(g);
-	}
-
-      BOOST_FOREACH(Gate_shptr g,
-		    filter_connected_gates(start_gate, GateTemplatePort::PORT_TYPE_IN, "D",
-					   "flipflop", GateTemplatePort::PORT_TYPE_OUT, "Q"))
-	if(closed_list.find(g) != closed_list.end()) {
-	  other_gates.insert(g);
-	  closed_list.insert(g);
-	}
-
-      BOOST_FOREACH(Gate_shptr g2, other_gates) {
-	std::cout << "\tGate " << g2->get_descriptive_identifier() << std::endl;
-
-	trace_recursive(g2, closed_list);
-      }
-    }
+    /**
+     * Find all instances of a pattern.
+     *
+     * If a pattern is symmetric, the same set of gates matches multiple
+     * times. Only one of these matches is reported.
+     *
+     * @param pattern The pattern. It should be connected. Otherwise each
+     *   unconnected part multiplies the search space.
+     * @param num_threads The number of worker threads. Use 0 for the
+     *   number of available processors.
+     * @return Returns the matches ordered by the object IDs of the gates.
+     */
+    match_list search(SubcircuitPattern const& pattern, unsigned int num_threads = 0) const;
 
+    /**
+     * Move the gates of a match into a new module. The module is added
+     * to the main module and its ports are determined.
+     * @return Returns the new module.
+     */
+    Module_shptr create_module(match const& m,
+			       std::string const& module_name,
+			       std::string const& entity_name = "") const;
 
     /**
      * Check if there is a port on \p gate of type \p src_port_type
      * that shares a net with another gate of type \p logic_class.
      *
+     * The lookup walks the netlist graph of the logic model. Only
+     * ports of the nets are visited, not the other net members.
      */
     std::set<Gate_shptr> filter_connected_gates(Gate_shptr gate,
 						GateTemplatePort::PORT_TYPE src_port_type,
 						std::string const& src_port_name,
 						std::string const& logic_class,
 						GateTemplatePort::PORT_TYPE dst_port_type,
-						std::string const& dst_port_name) const {
-
-      std::set<Gate_shptr> connected;
-
-      for(Gate::port_iterator iter = gate->ports_begin();
-	  iter != gate->ports_end(); ++iter) {
-
-	GatePort_shptr gport = *iter;
-	if(get_port_type(gport) == src_port_type) {
-	  Net_shptr net = gport->get_net();
-	  if(net != NULL) {
-	    BOOST_FOREACH(object_id_t oid, *net) {
-	      if(oid != gport->get_object_id()) {
-		PlacedLogicModelObject_shptr plmo = lmodel->get_object(oid);
-		assert(plmo != NULL);
-		if(GatePort_shptr other_port = std::tr1::dynamic_pointer_cast<GatePort>(plmo)) {
-		  Gate_shptr other_gate = other_port->get_gate();
-
-		  if(is_logic_class(other_gate, logic_class) &&
-		     get_port_type(other_port) == dst_port_type) {
-
-
-
-		    if((src_port_name.empty() && dst_port_name.empty()) ||
-		       (src_port_name.empty() && dst_port_name == get_template_port_name(other_port)) ||
-		       (dst_port_name.empty() && src_port_name == get_template_port_name(gport)) ||
-		       (src_port_name == get_template_port_name(gport) &&
-			dst_port_name == get_template_port_name(other_port)))
-		      connected.insert(other_gate);
-		  }
-		}
-	      }
-
-	    }
-	  }
-	}
-      }
-      return connected;
-    }
+						std::string const& dst_port_name) const;
 
   };
 
@@ -23,6 +23,7 @@
 #define __MEMORYMAP_H__
 
 #include "globals.h"
+#include "ImageArena.h"
 #include <string>
 
 #include <stdio.h>
@@ -46,6 +47,8 @@ namespace degate {
     MAP_STORAGE_TYPE_MEM = 0,
     MAP_STORAGE_TYPE_PERSISTENT_FILE = 1,
     MAP_STORAGE_TYPE_TEMP_FILE = 2,
+    MAP_STORAGE_TYPE_VIEW = 3,
+    MAP_STORAGE_TYPE_POOL = 4
   };
 
 
@@ -87,6 +90,10 @@ namespace degate {
       return storage_type == MAP_STORAGE_TYPE_MEM;
     }
 
+    size_t get_size() const {
+      return (size_t)width * height * sizeof(T);
+    }
+
   public:
 
 
@@ -103,11 +110,24 @@ namespace degate {
      * @param width The width of a 2D map.
      * @param height The height of a 2D map.
      * @param mode Is either MAP_STORAGE_TYPE_PERSISTENT_FILE or MAP_STORAGE_TYPE_TEMP_FILE.
-     * @param file_to_map The name of the file, which should be mmap().
+     *   For MAP_STORAGE_TYPE_POOL the memory is taken from the ImageArena
+     *   and returned to it on destruction.
+     * @param file_to_map The name of the file, which should be mmap(). It is
+     *   ignored for MAP_STORAGE_TYPE_POOL.
      */
     MemoryMap(unsigned int width, unsigned int height,
 	      MAP_STORAGE_TYPE mode, std::string const & file_to_map);
 
+    /**
+     * Create a memory map for memory, that is owned by someone else,
+     * e.g. a region of a TilePackFile. The memory is not released on
+     * destruction.
+     * @param width The width of a 2D map.
+     * @param height The height of a 2D map.
+     * @param external_mem The memory. It must stay valid for the lifetime of the map.
+     */
+    MemoryMap(unsigned int width, unsigned int height, T * external_mem);
+
     /**
      * The destructor.
      */
@@ -140,6 +160,12 @@ namespace degate {
      */
     void raw_copy(void * buf) const;
 
+    /**
+     * Get a pointer to the memory. The memory holds get_width() * get_height()
+     * elements in row-major order.
+     */
+    T * get_data_ptr() { return mem; }
+
     /**
      * Get the name of the mapped file.
      * @returns Returns a string with the mapped file. If the memory
@@ -174,13 +200,18 @@ namespace degate {
     filesize(0) {
 
     assert(mode == MAP_STORAGE_TYPE_PERSISTENT_FILE ||
-	   mode == MAP_STORAGE_TYPE_TEMP_FILE);
+	   mode == MAP_STORAGE_TYPE_TEMP_FILE ||
+	   mode == MAP_STORAGE_TYPE_POOL);
 
     assert(width > 0 && height > 0);
 
     ret_t ret;
 
-    if(mode == MAP_STORAGE_TYPE_TEMP_FILE) {
+    if(mode == MAP_STORAGE_TYPE_POOL) {
+      filename.clear();
+      mem = (T *) ImageArena::get_instance().acquire(get_size());
+    }
+    else if(mode == MAP_STORAGE_TYPE_TEMP_FILE) {
       ret = map_temp_file(file_to_map);
       if(RET_IS_NOT_OK(ret))
 	debug(TM, "Can't open a temp file with pattern %s", file_to_map.c_str());
@@ -195,10 +226,29 @@ namespace degate {
   }
 
 
+  template <typename T>
+  MemoryMap<T>::MemoryMap(unsigned int _width, unsigned int _height, T * external_mem) :
+    width(_width), height(_height),
+    storage_type(MAP_STORAGE_TYPE_VIEW),
+    mem(external_mem),
+    fd(-1),
+    filesize(0) {
+
+    assert(width > 0 && height > 0);
+    assert(mem != NULL);
+  }
+
   template <typename T>
   MemoryMap<T>::~MemoryMap() {
 
     switch(storage_type) {
+    case MAP_STORAGE_TYPE_VIEW:
+      mem = NULL;
+      break;
+    case MAP_STORAGE_TYPE_POOL:
+      ImageArena::get_instance().release(mem, get_size());
+      mem = NULL;
+      break;
     case MAP_STORAGE_TYPE_MEM:
       if(mem != NULL) free(mem);
       mem = NULL;
@@ -21,9 +21,13 @@
 
 #include <degate.h>
 #include <Module.h>
+#include <NetlistGraph.h>
 #include <boost/foreach.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+#include <vector>
+
 using namespace degate;
 
 
@@ -200,26 +204,25 @@ void Module::automove_gates() {
 }
 
 
-bool Module::net_completely_internal(Net_shptr net) const {
+bool Module::net_completely_internal(Net_shptr net, gate_port_index const& index) const {
   for(Net::connection_iterator c_iter = net->begin(); c_iter != net->end(); ++c_iter) {
     
     object_id_t oid = *c_iter;   
-    GatePort_shptr gport = lookup_gate_port_recursive(oid);
-    if(gport == NULL) { // external entity
+    if(index.find(oid) == index.end()) { // external entity
       return false;
     }
   }
   return true;
 }
 
-bool Module::net_feeded_internally(Net_shptr net) const {
+bool Module::net_feeded_internally(Net_shptr net, gate_port_index const& index) const {
   for(Net::connection_iterator c_iter = net->begin(); c_iter != net->end(); ++c_iter) {
     
     object_id_t oid = *c_iter;   
-    GatePort_shptr gport = lookup_gate_port_recursive(oid);
+    gate_port_index::const_iterator found = index.find(oid);
     
-    if(gport != NULL) { // internal entity
-      GateTemplatePort_shptr tmpl_port = gport->get_template_port();
+    if(found != index.end()) { // internal entity
+      GateTemplatePort_shptr tmpl_port = found->second->get_template_port();
       if(tmpl_port->is_outport()) return true;
     }
   }
@@ -245,6 +248,9 @@ void Module::determine_module_ports() {
   port_collection new_ports;
   std::set<Net_shptr> known_net;
 
+  gate_port_index member_ports;
+  index_gate_ports_recursive(member_ports);
+
   for(gate_collection::iterator g_iter = gates_begin(); g_iter != gates_end(); ++g_iter) {
 
     Gate_shptr gate = *g_iter;
@@ -259,7 +265,7 @@ void Module::determine_module_ports() {
       std::cout << "Check net for object gate port " << gate_port->get_descriptive_identifier() << "?\n";
 
       bool net_already_processed = known_net.find(net) != known_net.end();
-      if((net != NULL) && !net_already_processed && !net_completely_internal(net)) {
+      if((net != NULL) && !net_already_processed && !net_completely_internal(net, member_ports)) {
 
 	bool is_a_port = false;
  
@@ -267,7 +273,7 @@ void Module::determine_module_ports() {
 
 	  object_id_t oid = *c_iter;
 
-	  if(!exists_gate_port_recursive(oid)) { // outbound connection
+	  if(member_ports.find(oid) == member_ports.end()) { // outbound connection
 
 	    // Now we check, whether the connection is feeded by an outside entity or feeded
 	    // from this module.
@@ -280,7 +286,7 @@ void Module::determine_module_ports() {
 	    GateTemplatePort_shptr tmpl_port = gate_port->get_template_port();
 	    assert(tmpl_port != NULL); // if a gate has no standard cell type, the gate cannot have a port
 	    
-	    if(net_feeded_internally(net) && tmpl_port->is_inport()) {
+	    if(net_feeded_internally(net, member_ports) && tmpl_port->is_inport()) {
 	      std::cout << "  Net feeded internally, but port is inport. Will check where the net is driven.\n";	
 	    }
 	    else {
@@ -327,7 +333,7 @@ void Module::determine_module_ports() {
 
       bool net_already_processed = known_net.find(net) != known_net.end();
       
-      if(net != NULL && !net_already_processed && !net_completely_internal(net)) { // outbound connection
+      if(net != NULL && !net_already_processed && !net_completely_internal(net, member_ports)) { // outbound connection
 	new_ports[mod_port_name] = gate_port;
       }    
     }
@@ -371,6 +377,23 @@ GatePort_shptr Module::lookup_gate_port_recursive(object_id_t oid) const {
   return GatePort_shptr();
 }
 
+void Module::index_gate_ports_recursive(gate_port_index & index) const {
+
+  for(gate_collection::const_iterator g_iter = gates.begin();
+      g_iter != gates.end(); ++g_iter) {
+
+    Gate_shptr gate = *g_iter;
+
+    for(Gate::port_const_iterator p_iter = gate->ports_begin();
+	p_iter != gate->ports_end(); ++p_iter)
+      index[(*p_iter)->get_object_id()] = *p_iter;
+  }
+
+  for(module_collection::const_iterator iter = modules.begin();
+      iter != modules.end(); ++iter)
+    (*iter)->index_gate_ports_recursive(index);
+}
+
 
 
 
@@ -385,6 +408,7 @@ void degate::determine_module_ports_for_root(LogicModel_shptr lmodel) {
    */
 
   Module_shptr main_module = lmodel->get_main_module();
+  NetlistGraph_shptr graph = lmodel->get_netlist_graph();
 
   main_module->ports.clear(); // reset ports
 
@@ -399,32 +423,26 @@ void degate::determine_module_ports_for_root(LogicModel_shptr lmodel) {
       GatePort_shptr gate_port = *p_iter;
       assert(gate_port != NULL);
 
-      Net_shptr net = gate_port->get_net();
-      bool is_a_port = false;
+      // Only the emarkers of a net are of interest. The graph lists them per net,
+      // so that large nets are not scanned for each of their ports.
+      NetlistGraph::index_t p = graph->get_port_index(gate_port->get_object_id());
+      if(p == NetlistGraph::no_index || graph->get_port_net(p) == NetlistGraph::no_index) continue;
 
-      if(net != NULL) {
+      NetlistGraph::index_range em_range = graph->get_net_emarkers(graph->get_port_net(p));
+      for(NetlistGraph::index_t const * e = em_range.first; e != em_range.second; ++e) {
 
-	for(Net::connection_iterator c_iter = net->begin(); c_iter != net->end() && !is_a_port; ++c_iter) {
+	EMarker_shptr em = graph->get_emarker(*e);
+	debug(TM, "Connected with emarker");
+
+	if(em->get_description() == "module-port") {
 	  
-	  object_id_t oid = *c_iter;
-	  assert(oid != 0);
+	  GateTemplatePort_shptr tmpl_port = gate_port->get_template_port();
+	  assert(tmpl_port != NULL); // if a gate has no standard cell type, the gate cannot have a port
 	  
-	  PlacedLogicModelObject_shptr lmo = lmodel->get_object(oid);
-	  if(EMarker_shptr em = std::tr1::dynamic_pointer_cast<EMarker>(lmo)) {
-	    debug(TM, "Connected with emarker");
-
-	    if(em->get_description() == "module-port") {
-	      
-	      GateTemplatePort_shptr tmpl_port = gate_port->get_template_port();
-	      assert(tmpl_port != NULL); // if a gate has no standard cell type, the gate cannot have a port
-	      
-	      main_module->ports[em->get_name()] = gate_port;
-	      is_a_port = true;
-	    }
-	  }
-	} 
-	    
-      } // end of net-object-iteration
+	  main_module->ports[em->get_name()] = gate_port;
+	  break;
+	}
+      } // end of net-emarker-iteration
     } // end of gate-portiteration
   } // end of gate-iteration
 
@@ -432,6 +450,238 @@ void degate::determine_module_ports_for_root(LogicModel_shptr lmodel) {
 
 
 
+namespace {
+
+  /*
+   * Helper types for determine_module_ports_for_hierarchy(). Modules are
+   * numbered in pre-order. Then the modules of a subtree have consecutive
+   * numbers and membership in a subtree is a range check.
+   */
+
+  struct ModuleRange {
+    Module_shptr module;
+    unsigned int first, end; // module numbers of the subtree: [first, end)
+  };
+
+  void number_modules(Module_shptr module, std::vector<ModuleRange> & modules) {
+
+    unsigned int pos = modules.size();
+    ModuleRange r;
+    r.module = module;
+    r.first = pos;
+    r.end = pos + 1;
+    modules.push_back(r);
+
+    for(Module::module_collection::const_iterator iter = module->modules_begin();
+	iter != module->modules_end(); ++iter)
+      number_modules(*iter, modules);
+
+    modules[pos].end = modules.size();
+  }
+
+  /*
+   * Per-net summary of the module numbers of connected gate ports.
+   */
+  class NetModuleSummary {
+
+  public:
+
+    typedef NetlistGraph::index_t index_t;
+
+    static const unsigned int no_module = ~0U;
+
+  private:
+
+    std::vector<unsigned int> min_module, max_module;
+    std::vector<bool> has_foreign;
+
+    // module numbers of driving ports, sorted per net
+    std::vector<index_t> driver_offsets;
+    std::vector<unsigned int> driver_modules;
+
+  public:
+
+    NetModuleSummary(NetlistGraph const& graph, std::vector<unsigned int> const& gate_module) :
+      min_module(graph.get_num_nets(), no_module),
+      max_module(graph.get_num_nets(), 0),
+      has_foreign(graph.get_num_nets(), false),
+      driver_offsets(graph.get_num_nets() + 1, 0) {
+
+      for(index_t n = 0; n < graph.get_num_nets(); n++) {
+
+	driver_offsets[n] = driver_modules.size();
+	unsigned int members = 0;
+
+	NetlistGraph::index_range ports = graph.get_net_ports(n);
+	for(index_t const * p = ports.first; p != ports.second; ++p) {
+	  unsigned int m = gate_module[graph.get_port_gate(*p)];
+	  if(m == no_module) continue;
+
+	  members++;
+	  min_module[n] = std::min(min_module[n], m);
+	  max_module[n] = std::max(max_module[n], m);
+	  if(graph.is_driver(*p)) driver_modules.push_back(m);
+	}
+
+	// Vias, wires, emarkers and ports of gates outside the hierarchy are
+	// external entities for every module.
+	has_foreign[n] = members != graph.get_net_size(n);
+
+	std::sort(driver_modules.begin() + driver_offsets[n], driver_modules.end());
+      }
+
+      driver_offsets[graph.get_num_nets()] = driver_modules.size();
+    }
+
+    /*
+     * Same as Module::net_completely_internal().
+     */
+    bool is_internal(index_t n, ModuleRange const& r) const {
+      return !has_foreign[n] && min_module[n] >= r.first && max_module[n] < r.end;
+    }
+
+    /*
+     * Same as Module::net_feeded_internally().
+     */
+    bool is_feeded(index_t n, ModuleRange const& r) const {
+      std::vector<unsigned int>::const_iterator
+	begin = driver_modules.begin() + driver_offsets[n],
+	end = driver_modules.begin() + driver_offsets[n + 1],
+	found = std::lower_bound(begin, end, r.first);
+      return found != end && *found < r.end;
+    }
+  };
+
+  const unsigned int NetModuleSummary::no_module;
+
+}
+
+void degate::determine_module_ports_for_hierarchy(LogicModel_shptr lmodel) {
+
+  if(lmodel == NULL)
+    throw InvalidPointerException("Invalid parameter for determine_module_ports_for_hierarchy()");
+
+  typedef NetlistGraph::index_t index_t;
+
+  NetlistGraph_shptr graph = lmodel->get_netlist_graph();
+  Module_shptr main_module = lmodel->get_main_module();
+
+  std::vector<ModuleRange> modules;
+  number_modules(main_module, modules);
+
+  // gate index -> module number
+  std::vector<unsigned int> gate_module(graph->get_num_gates(), NetModuleSummary::no_module);
+
+  for(unsigned int m = 0; m < modules.size(); m++) {
+    for(Module::gate_collection::const_iterator g_iter = modules[m].module->gates_begin();
+	g_iter != modules[m].module->gates_end(); ++g_iter) {
+      index_t g = graph->get_gate_index((*g_iter)->get_object_id());
+      if(g != NetlistGraph::no_index && gate_module[g] == NetModuleSummary::no_module)
+	gate_module[g] = m;
+    }
+  }
+
+  NetModuleSummary summary(*graph, gate_module);
+
+
+  // The main module's ports are defined by emarkers.
+
+  main_module->ports.clear();
+
+  for(Module::gate_collection::iterator g_iter = main_module->gates_begin();
+      g_iter != main_module->gates_end(); ++g_iter) {
+
+    for(Gate::port_const_iterator p_iter = (*g_iter)->ports_begin();
+	p_iter != (*g_iter)->ports_end(); ++p_iter) {
+
+      index_t p = graph->get_port_index((*p_iter)->get_object_id());
+      if(p == NetlistGraph::no_index || graph->get_port_net(p) == NetlistGraph::no_index) continue;
+
+      NetlistGraph::index_range em_range = graph->get_net_emarkers(graph->get_port_net(p));
+      for(index_t const * e = em_range.first; e != em_range.second; ++e) {
+	EMarker_shptr em = graph->get_emarker(*e);
+	if(em->get_description() == "module-port") {
+	  main_module->ports[em->get_name()] = *p_iter;
+	  break;
+	}
+      }
+    }
+  }
+
+
+  // The sub-modules are processed in the order of determine_module_ports_recursive().
+  // As there, a module sees the ports of its sub-modules before they are updated.
+
+  // net index -> number of the module, that has processed the net
+  std::vector<unsigned int> known_net(graph->get_num_nets(), NetModuleSummary::no_module);
+
+  for(unsigned int m = 1; m < modules.size(); m++) {
+
+    Module_shptr module = modules[m].module;
+    Module::port_collection new_ports;
+    int pnum = 0;
+
+    // Existing port names are kept. If a gate port has multiple names,
+    // the first one is used, as in gate_port_already_named().
+    DenseObjectMap<std::string> port_names;
+    for(Module::port_collection::const_iterator iter = module->ports.begin();
+	iter != module->ports.end(); ++iter)
+      port_names.insert(std::make_pair(iter->second->get_object_id(), iter->first));
+
+    for(Module::gate_collection::iterator g_iter = module->gates_begin();
+	g_iter != module->gates_end(); ++g_iter) {
+
+      for(Gate::port_const_iterator p_iter = (*g_iter)->ports_begin();
+	  p_iter != (*g_iter)->ports_end(); ++p_iter) {
+
+	GatePort_shptr gate_port = *p_iter;
+
+	index_t p = graph->get_port_index(gate_port->get_object_id());
+	if(p == NetlistGraph::no_index) continue;
+
+	index_t n = graph->get_port_net(p);
+	if(n == NetlistGraph::no_index || known_net[n] == m ||
+	   summary.is_internal(n, modules[m])) continue;
+
+	// An in-port is not a module port, if the net is driven from within the module.
+	if(summary.is_feeded(n, modules[m]) && graph->is_load(p)) continue;
+
+	std::string mod_port_name;
+	DenseObjectMap<std::string>::const_iterator found = port_names.find(gate_port->get_object_id());
+	if(found != port_names.end()) mod_port_name = found->second;
+	else {
+	  do {
+	    pnum++;
+	    boost::format f("p%1%");
+	    f % pnum;
+	    mod_port_name = f.str();
+	  } while(module->ports.find(mod_port_name) != module->ports.end());
+	}
+
+	new_ports[mod_port_name] = gate_port;
+	known_net[n] = m;
+      }
+    }
+
+    for(Module::module_collection::const_iterator iter = module->modules_begin();
+	iter != module->modules_end(); ++iter) {
+
+      BOOST_FOREACH(Module::port_collection::value_type const& v, (*iter)->ports) {
+
+	index_t p = graph->get_port_index(v.second->get_object_id());
+	if(p == NetlistGraph::no_index) continue;
+
+	index_t n = graph->get_port_net(p);
+	if(n != NetlistGraph::no_index && known_net[n] != m && !summary.is_internal(n, modules[m]))
+	  new_ports[v.first] = v.second;
+      }
+    }
+
+    module->ports = new_ports;
+  }
+}
+
+
 Module_shptr Module::lookup_module(std::string const& module_path) const {
 
 
@@ -27,6 +27,7 @@
 
 #include <LogicModelObjectBase.h>
 #include <LogicModel.h>
+#include <DenseObjectMap.h>
 #include <boost/optional.hpp>
 
 namespace degate {
@@ -39,6 +40,7 @@ namespace degate {
   class Module : public LogicModelObjectBase {
 
     friend void determine_module_ports_for_root(LogicModel_shptr lmodel);
+    friend void determine_module_ports_for_hierarchy(LogicModel_shptr lmodel);
     friend class LogicModelImporter;
 
   public:
@@ -56,6 +58,9 @@ namespace degate {
 
   private:
 
+    // gate port object ID -> gate port
+    typedef DenseObjectMap<GatePort_shptr> gate_port_index;
+
     module_collection modules;
     gate_collection gates;
     port_collection ports;
@@ -79,11 +84,16 @@ namespace degate {
     bool exists_gate_port_recursive(object_id_t oid) const;
     GatePort_shptr lookup_gate_port_recursive(object_id_t oid) const;
 
+    /**
+     * Collect the gate ports of the current module and of all child modules.
+     * Use the index instead of lookup_gate_port_recursive(), if there are many lookups.
+     */
+    void index_gate_ports_recursive(gate_port_index & index) const;
     
     void add_module_port(std::string const& module_port_name, GatePort_shptr adjacent_gate_port);
 
-    bool net_feeded_internally(Net_shptr net) const;
-    bool net_completely_internal(Net_shptr net) const;
+    bool net_feeded_internally(Net_shptr net, gate_port_index const& index) const;
+    bool net_completely_internal(Net_shptr net, gate_port_index const& index) const;
 
   public:
 
@@ -247,6 +257,19 @@ namespace degate {
    */
   void determine_module_ports_for_root(LogicModel_shptr lmodel);
 
+  /**
+   * Determine the ports of the main module and of all its sub-modules.
+   *
+   * The result is the same as calling determine_module_ports_for_root() and
+   * determine_module_ports_recursive() on the main module, but the work is done
+   * in a single pass. Module membership of gate ports and per-net summaries
+   * (drivers, module-port emarkers) are computed once from the netlist graph.
+   * The run time is linear in the number of objects and connections, instead of
+   * rescanning a net for each of its ports and searching the module tree for
+   * each connection.
+   */
+  void determine_module_ports_for_hierarchy(LogicModel_shptr lmodel);
+
 
 }
 
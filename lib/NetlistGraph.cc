@@ -0,0 +1,408 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <NetlistGraph.h>
+#include <LogicModel.h>
+#include <Gate.h>
+#include <GatePort.h>
+#include <GateTemplate.h>
+#include <Net.h>
+#include <EMarker.h>
+#include <ConnectedLogicModelObject.h>
+
+#include <boost/foreach.hpp>
+
+#include <algorithm>
+#include <map>
+
+using namespace degate;
+
+const NetlistGraph::index_t NetlistGraph::no_index;
+const NetlistGraph::index_t NetlistGraph::no_logic_class;
+
+
+NetlistGraph::NetlistGraph(LogicModel * _lmodel) :
+  lmodel(_lmodel),
+  dirty(true),
+  rebuild_count(0) {
+
+  if(lmodel == NULL)
+    throw InvalidPointerException("Invalid logic model passed to NetlistGraph().");
+}
+
+NetlistGraph::~NetlistGraph() {
+  BOOST_FOREACH(Layer_shptr layer, registered_layers) layer->remove_change_listener(this);
+}
+
+void NetlistGraph::update() {
+  if(dirty) rebuild();
+}
+
+void NetlistGraph::clear() {
+
+  gates.clear();
+  gate_port_offsets.clear();
+  gate_logic_class.clear();
+  fanout_offsets.clear();
+  fanout.clear();
+  fanin_offsets.clear();
+  fanin.clear();
+
+  ports.clear();
+  port_gate.clear();
+  port_net.clear();
+  port_type.clear();
+
+  nets.clear();
+  net_size.clear();
+  net_port_offsets.clear();
+  net_ports.clear();
+  net_driver_offsets.clear();
+  net_drivers.clear();
+  net_load_offsets.clear();
+  net_loads.clear();
+  net_emarker_offsets.clear();
+  net_emarkers.clear();
+  emarkers.clear();
+
+  logic_classes.clear();
+  logic_class_ids.clear();
+
+  gate_index.clear();
+  port_index.clear();
+  net_index.clear();
+  object_nets.clear();
+}
+
+void NetlistGraph::sync_layers() {
+
+  std::vector<Layer_shptr> current;
+  for(LogicModel::layer_collection::iterator iter = lmodel->layers_begin();
+      iter != lmodel->layers_end(); ++iter)
+    if(*iter != NULL) current.push_back(*iter);
+
+  BOOST_FOREACH(Layer_shptr layer, registered_layers)
+    if(std::find(current.begin(), current.end(), layer) == current.end())
+      layer->remove_change_listener(this);
+
+  BOOST_FOREACH(Layer_shptr layer, current)
+    if(std::find(registered_layers.begin(), registered_layers.end(), layer) == registered_layers.end())
+      layer->add_change_listener(this);
+
+  registered_layers = current;
+}
+
+void NetlistGraph::rebuild() {
+
+  clear();
+  sync_layers();
+
+  build_gates();
+  build_nets();
+  build_net_directions();
+  build_fan_lists();
+
+  dirty = false;
+  rebuild_count++;
+}
+
+void NetlistGraph::build_gates() {
+
+  std::vector<object_id_t> const gate_ids = lmodel->get_ordered_gate_ids();
+
+  logic_classes.push_back("");
+
+  gates.reserve(gate_ids.size());
+  gate_port_offsets.reserve(gate_ids.size() + 1);
+  gate_logic_class.reserve(gate_ids.size());
+  gate_index.reserve(gate_ids.size());
+
+  BOOST_FOREACH(object_id_t gate_id, gate_ids) {
+
+    Gate_shptr gate = std::tr1::static_pointer_cast<Gate>(lmodel->get_object(gate_id));
+    index_t g = gates.size();
+
+    gates.push_back(gate);
+    gate_index[gate_id] = g;
+    gate_port_offsets.push_back(ports.size());
+
+    gate_logic_class.push_back(gate->has_template() ?
+			       intern_logic_class(gate->get_gate_template()->get_logic_class()) :
+			       no_logic_class);
+
+    for(Gate::port_iterator p_iter = gate->ports_begin(); p_iter != gate->ports_end(); ++p_iter) {
+      GatePort_shptr gport = *p_iter;
+
+      port_index[gport->get_object_id()] = ports.size();
+      ports.push_back(gport);
+      port_gate.push_back(g);
+      port_net.push_back(no_index);
+      port_type.push_back(gport->has_template_port() ?
+			  gport->get_template_port()->get_port_type() :
+			  GateTemplatePort::PORT_TYPE_UNDEFINED);
+    }
+  }
+
+  gate_port_offsets.push_back(ports.size());
+}
+
+void NetlistGraph::build_nets() {
+
+  DenseObjectMap<index_t> emarker_index;
+  BOOST_FOREACH(object_id_t emarker_id, lmodel->get_ordered_emarker_ids()) {
+    emarker_index[emarker_id] = emarkers.size();
+    emarkers.push_back(std::tr1::static_pointer_cast<EMarker>(lmodel->get_object(emarker_id)));
+  }
+
+  std::vector<object_id_t> const net_ids = lmodel->get_ordered_net_ids();
+
+  nets.reserve(net_ids.size());
+  net_index.reserve(net_ids.size());
+
+  BOOST_FOREACH(object_id_t net_id, net_ids) {
+
+    Net_shptr net = lmodel->get_net(net_id);
+    index_t n = nets.size();
+
+    nets.push_back(net);
+    net_index[net_id] = n;
+    net_size.push_back(net->size());
+
+    net_port_offsets.push_back(net_ports.size());
+    net_emarker_offsets.push_back(net_emarkers.size());
+
+    size_t first_port = net_ports.size();
+    size_t first_emarker = net_emarkers.size();
+
+    for(Net::connection_iterator c_iter = net->begin(); c_iter != net->end(); ++c_iter) {
+      object_id_t oid = *c_iter;
+      object_nets[oid] = net_id;
+
+      index_t p = get_port_index(oid);
+      if(p != no_index) {
+	net_ports.push_back(p);
+	port_net[p] = n;
+      }
+      else {
+	DenseObjectMap<index_t>::const_iterator e = emarker_index.find(oid);
+	if(e != emarker_index.end()) net_emarkers.push_back(e->second);
+      }
+    }
+
+    std::sort(net_ports.begin() + first_port, net_ports.end());
+    std::sort(net_emarkers.begin() + first_emarker, net_emarkers.end());
+  }
+
+  net_port_offsets.push_back(net_ports.size());
+  net_emarker_offsets.push_back(net_emarkers.size());
+}
+
+void NetlistGraph::build_net_directions() {
+
+  net_driver_offsets.clear();
+  net_drivers.clear();
+  net_load_offsets.clear();
+  net_loads.clear();
+
+  net_driver_offsets.reserve(nets.size() + 1);
+  net_load_offsets.reserve(nets.size() + 1);
+
+  for(index_t n = 0; n < nets.size(); n++) {
+
+    net_driver_offsets.push_back(net_drivers.size());
+    net_load_offsets.push_back(net_loads.size());
+
+    index_range ports = get_net_ports(n);
+    for(index_t const * p = ports.first; p != ports.second; ++p) {
+      if(is_driver(*p)) net_drivers.push_back(*p);
+      if(is_load(*p)) net_loads.push_back(*p);
+    }
+  }
+
+  net_driver_offsets.push_back(net_drivers.size());
+  net_load_offsets.push_back(net_loads.size());
+}
+
+void NetlistGraph::build_fan_lists() {
+
+  index_t num_gates = gates.size();
+
+  fanout_offsets.clear();
+  fanout.clear();
+  fanin_offsets.clear();
+  fanin.clear();
+
+  // The mark prevents duplicate entries, if a gate is connected multiple times.
+  std::vector<index_t> mark(num_gates, no_index);
+  std::vector<index_t> fanin_count(num_gates, 0);
+
+  fanout_offsets.reserve(num_gates + 1);
+
+  for(index_t g = 0; g < num_gates; g++) {
+
+    fanout_offsets.push_back(fanout.size());
+    size_t first = fanout.size();
+
+    for(index_t p = get_first_port(g); p < get_end_port(g); p++) {
+      if(!is_driver(p) || port_net[p] == no_index) continue;
+
+      index_range loads = get_net_loads(port_net[p]);
+      for(index_t const * q = loads.first; q != loads.second; ++q) {
+	index_t h = port_gate[*q];
+	if(*q != p && mark[h] != g) {
+	  mark[h] = g;
+	  fanout.push_back(h);
+	  fanin_count[h]++;
+	}
+      }
+    }
+
+    std::sort(fanout.begin() + first, fanout.end());
+  }
+
+  fanout_offsets.push_back(fanout.size());
+
+  // The fan-in lists are the transposed fan-out lists. Walking the gates in
+  // order keeps each fan-in list sorted.
+  fanin_offsets.resize(num_gates + 1);
+  fanin_offsets[0] = 0;
+  for(index_t g = 0; g < num_gates; g++) fanin_offsets[g + 1] = fanin_offsets[g] + fanin_count[g];
+
+  fanin.resize(fanout.size());
+  std::vector<index_t> fill(fanin_offsets.begin(), fanin_offsets.end() - 1);
+
+  for(index_t g = 0; g < num_gates; g++) {
+    index_range out = get_fanout(g);
+    for(index_t const * h = out.first; h != out.second; ++h)
+      fanin[fill[*h]++] = g;
+  }
+}
+
+NetlistGraph::index_t NetlistGraph::intern_logic_class(std::string const& logic_class) {
+
+  std::map<std::string, index_t>::const_iterator found = logic_class_ids.find(logic_class);
+  if(found != logic_class_ids.end()) return found->second;
+
+  index_t i = logic_classes.size();
+  logic_class_ids[logic_class] = i;
+  logic_classes.push_back(logic_class);
+  return i;
+}
+
+void NetlistGraph::update_template(GateTemplate_shptr gate_template) {
+
+  if(dirty) return;
+
+  bool retyped = false;
+
+  for(index_t g = 0; g < gates.size(); g++) {
+    Gate_shptr const& gate = gates[g];
+    if(gate->get_gate_template() != gate_template) continue;
+
+    gate_logic_class[g] = intern_logic_class(gate_template->get_logic_class());
+
+    index_t p = get_first_port(g);
+    for(Gate::port_iterator p_iter = gate->ports_begin(); p_iter != gate->ports_end(); ++p_iter, ++p) {
+
+      if(p == get_end_port(g) || ports[p] != *p_iter) {
+	dirty = true;
+	return;
+      }
+
+      GateTemplatePort::PORT_TYPE t = (*p_iter)->has_template_port() ?
+	(*p_iter)->get_template_port()->get_port_type() : GateTemplatePort::PORT_TYPE_UNDEFINED;
+      if(t != port_type[p]) {
+	port_type[p] = t;
+	retyped = true;
+      }
+    }
+
+    if(p != get_end_port(g)) {
+      dirty = true;
+      return;
+    }
+  }
+
+  if(retyped) {
+    build_net_directions();
+    build_fan_lists();
+  }
+}
+
+NetlistGraph::index_range NetlistGraph::make_range(std::vector<index_t> const& offsets,
+						   std::vector<index_t> const& values,
+						   index_t i) {
+  index_t const * base = values.empty() ? NULL : &values[0];
+  return index_range(base + offsets[i], base + offsets[i + 1]);
+}
+
+NetlistGraph::index_t NetlistGraph::get_gate_index(object_id_t oid) const {
+  DenseObjectMap<index_t>::const_iterator found = gate_index.find(oid);
+  return found == gate_index.end() ? no_index : found->second;
+}
+
+NetlistGraph::index_t NetlistGraph::get_port_index(object_id_t oid) const {
+  DenseObjectMap<index_t>::const_iterator found = port_index.find(oid);
+  return found == port_index.end() ? no_index : found->second;
+}
+
+NetlistGraph::index_t NetlistGraph::get_net_index(object_id_t oid) const {
+  DenseObjectMap<index_t>::const_iterator found = net_index.find(oid);
+  return found == net_index.end() ? no_index : found->second;
+}
+
+void NetlistGraph::match_logic_class(std::string const& logic_class, std::vector<bool> & mask) const {
+
+  mask.assign(logic_classes.size(), false);
+
+  for(index_t i = no_logic_class + 1; i < logic_classes.size(); i++)
+    mask[i] = logic_classes[i].compare(0, logic_class.size(), logic_class) == 0;
+}
+
+bool NetlistGraph::is_netlist_object(PlacedLogicModelObject_shptr o) const {
+  return std::tr1::dynamic_pointer_cast<Gate>(o) != NULL ||
+    std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(o) != NULL;
+}
+
+void NetlistGraph::notify_object_added(PlacedLogicModelObject_shptr o) {
+  if(!dirty && is_netlist_object(o)) dirty = true;
+}
+
+void NetlistGraph::notify_object_removed(PlacedLogicModelObject_shptr o) {
+  if(!dirty && is_netlist_object(o)) dirty = true;
+}
+
+void NetlistGraph::notify_object_changed(PlacedLogicModelObject_shptr o) {
+
+  if(dirty) return;
+
+  // Shape and highlighting changes are irrelevant. Only a changed net matters.
+  if(ConnectedLogicModelObject_shptr co = std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(o)) {
+    Net_shptr net = co->get_net();
+    object_id_t current = net != NULL ? net->get_object_id() : 0;
+
+    DenseObjectMap<object_id_t>::const_iterator found = object_nets.find(o->get_object_id());
+    object_id_t recorded = found != object_nets.end() ? found->second : 0;
+
+    if(current != recorded) dirty = true;
+  }
+}
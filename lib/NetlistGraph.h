@@ -0,0 +1,307 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef __NETLISTGRAPH_H__
+#define __NETLISTGRAPH_H__
+
+#include <globals.h>
+#include <Layer.h>
+#include <GateTemplatePort.h>
+#include <DenseObjectMap.h>
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <map>
+#include <tr1/memory>
+#include <boost/utility.hpp>
+
+namespace degate {
+
+  /**
+   * A read-only connectivity graph of gates, gate ports and nets, that is
+   * derived from a LogicModel.
+   *
+   * Netlist analyses should not walk nets via object IDs, look up each
+   * object in the logic model and dynamic_cast it. The graph assigns dense
+   * indices to gates, ports and nets and stores the relations in compressed
+   * sparse row (CSR) arrays:
+   * - The ports of a gate have consecutive indices.
+   * - For each net there is a list of all ports, of the driving ports and
+   *   of the loading ports. Inout ports are drivers and loads.
+   * - For each gate there is a list of gates it drives (fan-out) and a
+   *   list of gates it is driven by (fan-in).
+   *
+   * Gates are indexed in ascending order of their object ID, ports in the
+   * order of their gate and then in the gate's port order, nets in ascending
+   * order of their object ID. All lists are sorted by index. Therefore the
+   * iteration order is deterministic.
+   *
+   * Gates are tagged with their logic class. Logic classes are stored as
+   * small integers. Use match_logic_class() to test for a logic class the
+   * way is_logic_class() does.
+   *
+   * The graph registers itself as change listener on all layers of the
+   * logic model. Notifications, that affect the netlist, mark the graph
+   * dirty. It is rebuilt on the next call to update(). Usually you get the
+   * graph via LogicModel::get_netlist_graph(), which calls update() for you.
+   * Indices are only valid until the next rebuild.
+   *
+   * A rebuild costs O(gates + ports + net members) and an object lookup
+   * per gate, emarker and net. Edits are coalesced, i.e. a batch of edits
+   * costs one rebuild on the next update(). Net membership changes always
+   * trigger a rebuild, because they shift the CSR rows of all following
+   * nets. Template edits are patched in place by update_template().
+   */
+
+  class NetlistGraph : public LayerChangeListener, boost::noncopyable {
+
+  public:
+
+    typedef unsigned int index_t;
+
+    /**
+     * A range of indices in a CSR array.
+     */
+    typedef std::pair<index_t const *, index_t const *> index_range;
+
+    /**
+     * The index returned for objects, that are not in the graph.
+     */
+    static const index_t no_index = ~0U;
+
+  private:
+
+    LogicModel * lmodel;
+    bool dirty;
+    unsigned int rebuild_count;
+
+    std::vector<Layer_shptr> registered_layers;
+
+    // gates
+    std::vector<Gate_shptr> gates;
+    std::vector<index_t> gate_port_offsets; // ports of gate g: [offsets[g], offsets[g+1])
+    std::vector<index_t> gate_logic_class;
+    std::vector<index_t> fanout_offsets, fanout;
+    std::vector<index_t> fanin_offsets, fanin;
+
+    // ports
+    std::vector<GatePort_shptr> ports;
+    std::vector<index_t> port_gate;
+    std::vector<index_t> port_net;
+    std::vector<GateTemplatePort::PORT_TYPE> port_type;
+
+    // nets
+    std::vector<Net_shptr> nets;
+    std::vector<index_t> net_size;
+    std::vector<index_t> net_port_offsets, net_ports;
+    std::vector<index_t> net_driver_offsets, net_drivers;
+    std::vector<index_t> net_load_offsets, net_loads;
+    std::vector<index_t> net_emarker_offsets, net_emarkers;
+    std::vector<EMarker_shptr> emarkers;
+
+    std::vector<std::string> logic_classes;
+    std::map<std::string, index_t> logic_class_ids;
+
+    // object ID -> index
+    DenseObjectMap<index_t> gate_index, port_index, net_index;
+
+    // object ID -> net object ID for all connected objects in the graph
+    DenseObjectMap<object_id_t> object_nets;
+
+    void clear();
+    void sync_layers();
+    void rebuild();
+    void build_gates();
+    void build_nets();
+    void build_net_directions();
+    void build_fan_lists();
+
+    index_t intern_logic_class(std::string const& logic_class);
+
+    static index_range make_range(std::vector<index_t> const& offsets,
+				  std::vector<index_t> const& values, index_t i);
+
+    bool is_netlist_object(PlacedLogicModelObject_shptr o) const;
+
+  public:
+
+    /**
+     * Create a graph for a logic model. The graph is built on the first
+     * call to update().
+     */
+    NetlistGraph(LogicModel * lmodel);
+
+    /**
+     * Deregister the graph from the layers.
+     */
+    virtual ~NetlistGraph();
+
+    /**
+     * Rebuild the graph, if it is dirty.
+     */
+    void update();
+
+    /**
+     * Mark the graph as dirty. Call this, if the logic model changed in a way
+     * the layers do not report, e.g. if the direction of a template port changed.
+     */
+    void invalidate() { dirty = true; }
+
+    /**
+     * Check if the graph must be rebuilt.
+     */
+    bool is_dirty() const { return dirty; }
+
+    /**
+     * Patch the graph after the port types or the logic class of a gate
+     * template changed. The nets are not affected. Therefore only the
+     * logic classes and port types of the template's gates, the driver
+     * and load lists and the fan lists are updated. If the ports of a
+     * gate changed, the graph is marked dirty instead.
+     */
+    void update_template(GateTemplate_shptr gate_template);
+
+    /**
+     * Get the number of rebuilds. This is mainly useful for testing.
+     */
+    unsigned int get_rebuild_count() const { return rebuild_count; }
+
+
+    unsigned int get_num_gates() const { return gates.size(); }
+    unsigned int get_num_ports() const { return ports.size(); }
+    unsigned int get_num_nets() const { return nets.size(); }
+
+    Gate_shptr const& get_gate(index_t g) const { return gates[g]; }
+    GatePort_shptr const& get_port(index_t p) const { return ports[p]; }
+    Net_shptr const& get_net(index_t n) const { return nets[n]; }
+
+    /**
+     * Get the index of a gate, port or net by its object ID.
+     * @return Returns no_index, if the object is not in the graph.
+     */
+    index_t get_gate_index(object_id_t oid) const;
+    index_t get_port_index(object_id_t oid) const;
+    index_t get_net_index(object_id_t oid) const;
+
+    /**
+     * Get the first port of a gate.
+     */
+    index_t get_first_port(index_t g) const { return gate_port_offsets[g]; }
+
+    /**
+     * Get the index behind the last port of a gate.
+     */
+    index_t get_end_port(index_t g) const { return gate_port_offsets[g + 1]; }
+
+    /**
+     * The logic class of gates without a template. It is always
+     * present and never matched by match_logic_class().
+     */
+    const static index_t no_logic_class = 0;
+
+    /**
+     * Get the logic class of a gate.
+     */
+    index_t get_logic_class(index_t g) const { return gate_logic_class[g]; }
+
+    std::string const& get_logic_class_name(index_t logic_class) const {
+      return logic_classes[logic_class];
+    }
+
+    /**
+     * Determine the logic classes, that match a logic class name with
+     * the semantics of is_logic_class(), i.e. "flipflop" matches
+     * "flipflop-async-rst", too.
+     * @param logic_class The logic class name.
+     * @param mask The mask is resized. It is indexed by logic class.
+     */
+    void match_logic_class(std::string const& logic_class, std::vector<bool> & mask) const;
+
+    /**
+     * Get the gates that are driven by a gate.
+     */
+    index_range get_fanout(index_t g) const { return make_range(fanout_offsets, fanout, g); }
+
+    /**
+     * Get the gates that drive a gate.
+     */
+    index_range get_fanin(index_t g) const { return make_range(fanin_offsets, fanin, g); }
+
+
+    index_t get_port_gate(index_t p) const { return port_gate[p]; }
+
+    /**
+     * Get the net of a port.
+     * @return Returns no_index, if the port has no net.
+     */
+    index_t get_port_net(index_t p) const { return port_net[p]; }
+
+    /**
+     * Get the type of the template port. Ports without a template
+     * port have an undefined type.
+     */
+    GateTemplatePort::PORT_TYPE get_port_type(index_t p) const { return port_type[p]; }
+
+    bool is_driver(index_t p) const {
+      return port_type[p] == GateTemplatePort::PORT_TYPE_OUT ||
+	port_type[p] == GateTemplatePort::PORT_TYPE_INOUT;
+    }
+
+    bool is_load(index_t p) const {
+      return port_type[p] == GateTemplatePort::PORT_TYPE_IN ||
+	port_type[p] == GateTemplatePort::PORT_TYPE_INOUT;
+    }
+
+    /**
+     * Check if a port is electrically connected with any other object.
+     * This is the same as ConnectedLogicModelObject::is_connected().
+     */
+    bool is_connected(index_t p) const {
+      return port_net[p] != no_index && net_size[port_net[p]] >= 2;
+    }
+
+    /**
+     * Get the number of objects in a net. This includes wires, vias and emarkers.
+     */
+    unsigned int get_net_size(index_t n) const { return net_size[n]; }
+
+    index_range get_net_ports(index_t n) const { return make_range(net_port_offsets, net_ports, n); }
+    index_range get_net_drivers(index_t n) const { return make_range(net_driver_offsets, net_drivers, n); }
+    index_range get_net_loads(index_t n) const { return make_range(net_load_offsets, net_loads, n); }
+
+    /**
+     * Get the emarkers of a net. The range contains indices for get_emarker().
+     */
+    index_range get_net_emarkers(index_t n) const { return make_range(net_emarker_offsets, net_emarkers, n); }
+
+    EMarker_shptr const& get_emarker(index_t e) const { return emarkers[e]; }
+
+
+    virtual void notify_object_added(PlacedLogicModelObject_shptr o);
+    virtual void notify_object_removed(PlacedLogicModelObject_shptr o);
+    virtual void notify_object_changed(PlacedLogicModelObject_shptr o);
+  };
+
+}
+
+#endif
@@ -42,8 +42,25 @@ bool PlacedLogicModelObject::is_highlighted() const {
   return highlight_state != PlacedLogicModelObject::HLIGHTSTATE_NOT;
 }
 
+void PlacedLogicModelObject::set_name(std::string const& name) {
+  if(name != get_name()) {
+    LogicModelObjectBase::set_name(name);
+    notify_appearance_change();
+  }
+}
+
+void PlacedLogicModelObject::set_description(std::string const& description) {
+  if(description != get_description()) {
+    LogicModelObjectBase::set_description(description);
+    notify_appearance_change();
+  }
+}
+
 void PlacedLogicModelObject::set_highlighted(PlacedLogicModelObject::HIGHLIGHTING_STATE state) {
-  highlight_state = state;
+  if(highlight_state != state) {
+    highlight_state = state;
+    notify_appearance_change();
+  }
 }
 
 
@@ -61,3 +78,10 @@ void PlacedLogicModelObject::notify_shape_change() {
     layer->notify_shape_change(get_object_id());
   }
 }
+
+void PlacedLogicModelObject::notify_appearance_change() {
+
+  if(layer != NULL && has_valid_object_id()) {
+    layer->notify_appearance_change(get_object_id());
+  }
+}
@@ -63,6 +63,12 @@ namespace degate {
 
     void notify_shape_change();
 
+    /**
+     * Inform the layer's change listeners, that the appearance changed.
+     */
+
+    void notify_appearance_change();
+
   public:
 
     /**
@@ -77,6 +83,19 @@ namespace degate {
 
     virtual ~PlacedLogicModelObject();
 
+    /**
+     * Set the name. The layer's change listeners are informed, e.g. to
+     * update the name index of the logic model.
+     */
+
+    virtual void set_name(std::string const& name);
+
+    /**
+     * Set the description. The layer's change listeners are informed.
+     */
+
+    virtual void set_description(std::string const& description);
+
     /**
      * A placed object is highlightable. You can ask for its
      * state with this method.
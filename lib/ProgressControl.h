@@ -24,87 +24,98 @@
 
 #include <tr1/memory>
 #include <time.h>
-#include <boost/thread.hpp>
+#include <math.h>
+#include <ProgressTracker.h>
 
 namespace degate {
 
   /**
+   * Base class for long running operations, that report their progress
+   * and that can be canceled.
+   *
+   * The state is kept in a ProgressTracker. Objects, that work on behalf of
+   * another operation, can share its tracker or report into a subtask of it.
+   * Worker threads should use their own subtask from create_progress_subtask()
+   * and poll the token from get_cancellation_token().
    */
 
   class ProgressControl {
 
   private:
 
-    const static int averaging_buf_size = 5;
+    ProgressTracker_shptr tracker;
 
-    double progress;
-    bool canceled;
-
-    double step_size;
-    time_t time_started;
-
-    time_t estimated[averaging_buf_size];
-    int estimated_idx;
-
-    std::string log_message;
-    bool log_message_set;
-
-    boost::recursive_mutex mtx;
-
-  private:
-
-    time_t get_time_left_averaged() {
-      estimated[estimated_idx++] = get_time_left();
-      estimated_idx %= averaging_buf_size;
-
-      unsigned int sum = 0, valid_values = 0;
-      for(int i = 0; i < averaging_buf_size; i++)
-	if(estimated[i] != -1) {
-	  sum += estimated[i];
-	  valid_values++;
-	}
-
-      return valid_values > 0 ? sum / valid_values : get_time_left_averaged();
-    }
+    // The task, that the step based methods below report to.
+    ProgressTask_shptr task;
 
   protected:
 
     /**
      * Set progress.
+     * @param progress A value between 0 and 1.
      */
     virtual void set_progress(double progress) {
-      boost::recursive_mutex::scoped_lock(mtx);
-      this->progress = progress;
+      task->set_done(lrint(progress * task->get_total()));
     }
 
     /**
      * Set step size.
      */
     virtual void set_progress_step_size(double step_size) {
-      boost::recursive_mutex::scoped_lock(mtx);
-      this->step_size = step_size;
+      task->set_total(lrint(1.0 / step_size));
     }
 
     /**
      * Increase progress.
      */
     virtual void progress_step_done() {
-      boost::recursive_mutex::scoped_lock(mtx);
-      progress += step_size;
+      task->advance();
     }
 
     /**
-     * Reset progress and cancel state.
+     * Reset progress and cancel state. If the object reports into a
+     * subtask of another object, only the subtask is reset.
      */
     virtual void reset_progress() {
-      boost::recursive_mutex::scoped_lock(mtx);
-      time_started = time(NULL);
-      canceled = false;
-      progress = 0;
+      if(task != tracker->get_root_task()) task->set_done(0);
+      else {
+	tracker->reset();
+	task = tracker->get_root_task();
+      }
+    }
+
+    /**
+     * Get the task, that this object reports to.
+     */
+    ProgressTask_shptr get_progress_task() const {
+      return task;
+    }
+
+    /**
+     * Create a subtask, e.g. for a worker thread.
+     * @param units The number of steps of this object, the subtask stands for.
+     * @param total The number of work units of the subtask.
+     */
+    ProgressTask_shptr create_progress_subtask(unsigned long units, unsigned long total = 1) {
+      return task->create_subtask(units, total);
+    }
 
-      for(int i = 0; i < averaging_buf_size; i++) estimated[i] = -1;
+    /**
+     * Use the tracker of another object. Cancel requests, log messages and
+     * progress are shared afterwards.
+     */
+    void share_progress(ProgressControl const& other) {
+      tracker = other.tracker;
+      task = other.task;
+    }
 
-      estimated_idx = 0;
+    /**
+     * Report the progress into a subtask of another object. Cancel requests
+     * and log messages are shared.
+     */
+    void attach_progress(ProgressControl const& parent, ProgressTask_shptr subtask) {
+      tracker = parent.tracker;
+      task = subtask;
     }
 
   public:
@@ -113,8 +124,8 @@ namespace degate {
      * The constructor
      */
 
-    ProgressControl() : log_message_set(false) {
-      reset_progress();
+    ProgressControl() : tracker(new ProgressTracker()) {
+      task = tracker->get_root_task();
     }
 
     /**
@@ -123,13 +134,27 @@ namespace degate {
 
     virtual ~ProgressControl() {}
 
+    /**
+     * Get the progress tracker.
+     */
+    ProgressTracker_shptr get_progress_tracker() const {
+      return tracker;
+    }
+
+    /**
+     * Get the cancellation token. Inner loops should poll the token
+     * instead of calling is_canceled().
+     */
+    CancellationToken_shptr get_cancellation_token() const {
+      return tracker->get_cancellation_token();
+    }
+
     /**
      * Check if the process is canceled.
      */
 
     virtual bool is_canceled() const {
-      boost::recursive_mutex::scoped_lock(mtx);
-      return canceled;
+      return tracker->get_cancellation_token()->is_canceled();
     }
 
     /**
@@ -137,27 +162,24 @@ namespace degate {
      */
 
     virtual void cancel() {
-      boost::recursive_mutex::scoped_lock(mtx);
-      canceled = true;
+      tracker->get_cancellation_token()->cancel();
     }
 
 
     /**
      * Get progress.
-     * @return Returns a value between 0 and 100 percent.
+     * @return Returns a value between 0 and 1.
      */
 
     virtual double get_progress() const {
-      boost::recursive_mutex::scoped_lock(mtx);
-      return progress;
+      return tracker->get_progress();
     }
 
     /**
      * Get (real) time since the progress counter was resetted.
      */
     virtual time_t get_time_passed() const {
-      boost::mutex::scoped_lock(m_mutex);
-      return time(NULL) - time_started;
+      return tracker->get_time_passed();
     }
 
     /**
@@ -166,46 +188,24 @@ namespace degate {
      *   that time cannot be calculated.
      */
     virtual time_t get_time_left() const {
-      boost::recursive_mutex::scoped_lock(mtx);
-      if(progress < 1.0)
-	return progress > 0 ? (1.0 - progress) * get_time_passed() / progress : -1;
-      return 0;
+      return tracker->get_time_left();
     }
 
-    virtual std::string get_time_left_as_string() {
-      boost::recursive_mutex::scoped_lock(mtx);
-      time_t time_left = get_time_left_averaged();
-      if(time_left == -1) return std::string("-");
-      else {
-	char buf[100];
-	if(time_left < 60)
-	  snprintf(buf, sizeof(buf), "%d s", (int)time_left);
-	else if(time_left < 60*60)
-	  snprintf(buf, sizeof(buf), "%d:%02d m", (int)time_left / 60, (int)time_left % 60);
-	else {
-	  unsigned int minutes = (int)time_left / 60;
-	  snprintf(buf, sizeof(buf), "%d:%02d h", minutes / 60, (int)time_left % 60);
-	}
-	return std::string(buf);
-      }
-
+    virtual std::string get_time_left_as_string() const {
+      return tracker->get_time_left_as_string();
     }
 
 
     virtual void set_log_message(std::string const& msg) {
-      boost::recursive_mutex::scoped_lock(mtx);
-      log_message = msg;
-      log_message_set = true;
+      tracker->set_log_message(msg);
     }
 
     virtual std::string get_log_message() const {
-      boost::recursive_mutex::scoped_lock(mtx);
-      return log_message;
+      return tracker->get_log_message();
     }
 
     virtual bool has_log_message() const {
-      boost::recursive_mutex::scoped_lock(mtx);
-      return log_message_set;
+      return tracker->has_log_message();
     }
   };
 
@@ -213,4 +213,3 @@ namespace degate {
 }
 
 #endif
-
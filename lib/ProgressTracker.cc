@@ -0,0 +1,170 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <ProgressTracker.h>
+
+#include <sys/time.h>
+#include <stdio.h>
+#include <boost/foreach.hpp>
+
+using namespace degate;
+
+/*
+ * ProgressTask
+ */
+
+ProgressTask::ProgressTask(unsigned long _total, unsigned long _weight) :
+  done(0),
+  total(_total > 0 ? _total : 1),
+  weight(_weight) {
+}
+
+void ProgressTask::finish() {
+  boost::mutex::scoped_lock lock(children_mtx);
+  set_done(get_total());
+  children.clear();
+}
+
+ProgressTask_shptr ProgressTask::create_subtask(unsigned long units, unsigned long total) {
+  ProgressTask_shptr task(new ProgressTask(total, units));
+  boost::mutex::scoped_lock lock(children_mtx);
+  children.push_back(task);
+  return task;
+}
+
+double ProgressTask::get_fraction() const {
+
+  double units = done.load(boost::memory_order_relaxed);
+
+  {
+    boost::mutex::scoped_lock lock(children_mtx);
+    BOOST_FOREACH(ProgressTask_shptr const& child, children)
+      units += child->get_weight() * child->get_fraction();
+  }
+
+  double fraction = units / get_total();
+  return fraction < 1.0 ? fraction : 1.0;
+}
+
+
+/*
+ * ProgressTracker
+ */
+
+// Time between two samples of the throughput in seconds.
+static const double sample_interval = 1.0;
+
+// Weight of a new sample in the smoothed throughput.
+static const double sample_weight = 0.3;
+
+ProgressTracker::ProgressTracker() :
+  token(new CancellationToken()),
+  log_message_set(false) {
+  reset();
+}
+
+double ProgressTracker::get_current_time() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+void ProgressTracker::reset() {
+  boost::mutex::scoped_lock lock(mtx);
+  root = ProgressTask_shptr(new ProgressTask());
+  token->reset();
+  time_started = last_sample_time = get_current_time();
+  last_sample_fraction = 0;
+  rate = -1;
+}
+
+ProgressTask_shptr ProgressTracker::get_root_task() const {
+  boost::mutex::scoped_lock lock(mtx);
+  return root;
+}
+
+double ProgressTracker::get_progress() const {
+  return get_root_task()->get_fraction();
+}
+
+time_t ProgressTracker::get_time_passed() const {
+  boost::mutex::scoped_lock lock(mtx);
+  return (time_t)(get_current_time() - time_started);
+}
+
+time_t ProgressTracker::get_time_left() const {
+
+  double fraction = get_progress();
+  if(fraction >= 1.0) return 0;
+
+  boost::mutex::scoped_lock lock(mtx);
+  double now = get_current_time();
+
+  if(rate < 0) {
+    // The first estimation is based on the average throughput.
+    if(fraction > 0 && now > time_started) {
+      rate = fraction / (now - time_started);
+      last_sample_time = now;
+      last_sample_fraction = fraction;
+    }
+  }
+  else if(now - last_sample_time >= sample_interval) {
+    double current_rate = (fraction - last_sample_fraction) / (now - last_sample_time);
+    rate = (1 - sample_weight) * rate + sample_weight * current_rate;
+    last_sample_time = now;
+    last_sample_fraction = fraction;
+  }
+
+  if(rate <= 0) return -1;
+  return (time_t)((1.0 - fraction) / rate);
+}
+
+std::string ProgressTracker::get_time_left_as_string() const {
+  time_t time_left = get_time_left();
+  if(time_left == -1) return std::string("-");
+
+  char buf[100];
+  if(time_left < 60)
+    snprintf(buf, sizeof(buf), "%d s", (int)time_left);
+  else if(time_left < 60*60)
+    snprintf(buf, sizeof(buf), "%d:%02d m", (int)time_left / 60, (int)time_left % 60);
+  else {
+    unsigned int minutes = (int)time_left / 60;
+    snprintf(buf, sizeof(buf), "%d:%02d h", minutes / 60, minutes % 60);
+  }
+  return std::string(buf);
+}
+
+void ProgressTracker::set_log_message(std::string const& msg) {
+  boost::mutex::scoped_lock lock(mtx);
+  log_message = msg;
+  log_message_set = true;
+}
+
+std::string ProgressTracker::get_log_message() const {
+  boost::mutex::scoped_lock lock(mtx);
+  return log_message;
+}
+
+bool ProgressTracker::has_log_message() const {
+  boost::mutex::scoped_lock lock(mtx);
+  return log_message_set;
+}
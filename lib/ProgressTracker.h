@@ -0,0 +1,241 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __PROGRESSTRACKER_H__
+#define __PROGRESSTRACKER_H__
+
+#include <string>
+#include <vector>
+#include <time.h>
+#include <tr1/memory>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/utility.hpp>
+
+namespace degate {
+
+  /**
+   * A flag, that tells long running algorithms to stop.
+   *
+   * Polling the flag is a single relaxed atomic load, so inner loops
+   * can check it often.
+   */
+
+  class CancellationToken : boost::noncopyable {
+
+  private:
+    boost::atomic<bool> canceled;
+
+  public:
+
+    CancellationToken() : canceled(false) {}
+
+    /**
+     * Request the cancellation.
+     */
+    void cancel() { canceled.store(true, boost::memory_order_relaxed); }
+
+    /**
+     * Check if the cancellation was requested.
+     */
+    bool is_canceled() const { return canceled.load(boost::memory_order_relaxed); }
+
+    /**
+     * Clear the cancellation request.
+     */
+    void reset() { canceled.store(false, boost::memory_order_relaxed); }
+  };
+
+  typedef std::tr1::shared_ptr<CancellationToken> CancellationToken_shptr;
+
+
+  class ProgressTask;
+  typedef std::tr1::shared_ptr<ProgressTask> ProgressTask_shptr;
+
+  /**
+   * A node in a tree of progress counters.
+   *
+   * A task consists of a number of work units. Units are either done by the
+   * task itself, which is recorded with advance(), or they are delegated to
+   * subtasks. A worker thread should get its own subtask, so that threads
+   * do not write to the same counter.
+   *
+   * Counters are atomic and writes are lock-free. The progress of the
+   * whole tree is aggregated, when it is read.
+   */
+
+  class ProgressTask : boost::noncopyable {
+
+  private:
+
+    boost::atomic<unsigned long> done;
+    boost::atomic<unsigned long> total;
+
+    // The number of units of the parent task, that this task represents.
+    const unsigned long weight;
+
+    mutable boost::mutex children_mtx;
+    std::vector<ProgressTask_shptr> children;
+
+  public:
+
+    /**
+     * Create a task.
+     * @param total The number of work units.
+     * @param weight The number of units of the parent task, this task stands for.
+     */
+    ProgressTask(unsigned long total = 1, unsigned long weight = 1);
+
+    /**
+     * Set the number of work units.
+     */
+    void set_total(unsigned long total) {
+      this->total.store(total > 0 ? total : 1, boost::memory_order_relaxed);
+    }
+
+    /**
+     * Get the number of work units.
+     */
+    unsigned long get_total() const { return total.load(boost::memory_order_relaxed); }
+
+    /**
+     * Mark work units as done.
+     */
+    void advance(unsigned long units = 1) {
+      done.fetch_add(units, boost::memory_order_relaxed);
+    }
+
+    /**
+     * Set the number of done work units.
+     */
+    void set_done(unsigned long units) {
+      done.store(units, boost::memory_order_relaxed);
+    }
+
+    /**
+     * Mark all work units as done. This includes the work of subtasks.
+     */
+    void finish();
+
+    /**
+     * Create a subtask.
+     * @param units The number of units of this task, that are delegated
+     *   to the subtask.
+     * @param total The number of work units of the subtask.
+     */
+    ProgressTask_shptr create_subtask(unsigned long units, unsigned long total = 1);
+
+    /**
+     * Get the weight in units of the parent task.
+     */
+    unsigned long get_weight() const { return weight; }
+
+    /**
+     * Get the progress of the task and its subtasks.
+     * @return Returns a value between 0 and 1.
+     */
+    double get_fraction() const;
+  };
+
+
+  /**
+   * The ProgressTracker holds the state of a long running operation:
+   * a tree of progress tasks, a cancellation token, a log message
+   * and a time-left estimation.
+   *
+   * The estimation is based on the aggregated throughput of all tasks.
+   * It is smoothed over time, so that bursts of a single worker do not
+   * let it jump.
+   */
+
+  class ProgressTracker : boost::noncopyable {
+
+  private:
+
+    ProgressTask_shptr root;
+    CancellationToken_shptr token;
+
+    mutable boost::mutex mtx;
+
+    double time_started;
+
+    // state of the throughput estimation
+    mutable double last_sample_time;
+    mutable double last_sample_fraction;
+    mutable double rate;
+
+    std::string log_message;
+    bool log_message_set;
+
+    static double get_current_time();
+
+  public:
+
+    ProgressTracker();
+
+    /**
+     * Start over with a new root task and clear the cancellation request.
+     */
+    void reset();
+
+    /**
+     * Get the root task.
+     */
+    ProgressTask_shptr get_root_task() const;
+
+    /**
+     * Get the cancellation token. The token stays the same, if the tracker is reset.
+     */
+    CancellationToken_shptr get_cancellation_token() const { return token; }
+
+    /**
+     * Get the progress.
+     * @return Returns a value between 0 and 1.
+     */
+    double get_progress() const;
+
+    /**
+     * Get the time in seconds since the tracker was reset.
+     */
+    time_t get_time_passed() const;
+
+    /**
+     * Get estimated time left in seconds.
+     * @return Returns the time to go in seconds or -1, if
+     *   that time cannot be calculated.
+     */
+    time_t get_time_left() const;
+
+    /**
+     * Get estimated time left as human readable string.
+     */
+    std::string get_time_left_as_string() const;
+
+    void set_log_message(std::string const& msg);
+    std::string get_log_message() const;
+    bool has_log_message() const;
+  };
+
+  typedef std::tr1::shared_ptr<ProgressTracker> ProgressTracker_shptr;
+
+}
+
+#endif
@@ -23,6 +23,7 @@
 
 #include <globals.h>
 #include <ProjectArchiver.h>
+#include <TilePackFile.h>
 #include <list>
 #include <tr1/memory>
 
@@ -30,6 +31,7 @@
 #include <boost/filesystem/path.hpp>
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
 
 
 using namespace std;
@@ -40,31 +42,40 @@ void ProjectArchiver::add_single_file(struct zip * zip_archive,
 				      path const& archive_file,
 				      path const& base_dir_path,
 				      path const& file,
-				      path const& prepend_dir) const {
+				      path const& prepend_dir,
+				      path const& source_file,
+				      bool store_uncompressed) const {
 
   assert(zip_archive != NULL);
   struct zip_source *source;
 
   path stripped = prepend_dir / strip_path(file, base_dir_path);
+  path src = source_file.empty() ? file : source_file;
 
   debug(TM, "Add file %s as %s to zip archive.",
-	file.string().c_str(), stripped.string().c_str());
+	src.string().c_str(), stripped.string().c_str());
 
   if((source = zip_source_file(zip_archive,
-                               file.string().c_str(), 0, 0)) == NULL) {
+                               src.string().c_str(), 0, 0)) == NULL) {
     boost::format f("Cannot add file %1% to zip archive %2%: %3%");
     f % file % archive_file % zip_strerror(zip_archive);
     throw ZipException(f.str());
   }
 
-  if(zip_add(zip_archive,
-             stripped.string().c_str(),
-             source) < 0) {
+  int idx;
+  if((idx = zip_add(zip_archive,
+		    stripped.string().c_str(),
+		    source)) < 0) {
 
     boost::format f("Cannot add file %1% to zip archive %2%: %3%");
     f % file % archive_file % zip_strerror(zip_archive);
     throw ZipException(f.str());
   }
+
+#ifdef LIBZIP_VERSION_MAJOR
+  // Compressed data does not get smaller. Do not waste time on deflating it again.
+  if(store_uncompressed) zip_set_file_compression(zip_archive, idx, ZIP_CM_STORE, 0);
+#endif
 }
 
 
@@ -72,10 +83,28 @@ void ProjectArchiver::add_directory(struct zip * zip_archive,
 				    path const& archive_file,
 				    path const& base_dir_path,
 				    path const& dir,
-				    path const& prepend_dir) const {
+				    path const& prepend_dir,
+				    std::string const& temp_dir) const {
 
   directory_iterator end_iter;
 
+  // Background images with uncompressed tiles are compressed into a temporary
+  // pack file, that is added to the archive instead of the original one.
+  path pack_source;
+  if(TilePackFile::exists(dir.string()) && !TilePackFile::is_compressed(dir.string())) {
+    pack_source = join_pathes(temp_dir,
+			      boost::lexical_cast<std::string>(read_directory(temp_dir).size()) + ".pack");
+    debug(TM, "Compress tiles of %s.", dir.string().c_str());
+    try {
+      TilePackFile::write_compressed(dir.string(), pack_source.string());
+    }
+    catch(DegateRuntimeException const& ex) {
+      boost::format f("Cannot compress tiles of %1%: %2%");
+      f % dir % ex.what();
+      throw ZipException(f.str());
+    }
+  }
+
   for(directory_iterator iter(dir); iter != end_iter; ++iter) {
 
     path stripped = prepend_dir / strip_path(iter->path(), base_dir_path);
@@ -100,10 +129,15 @@ void ProjectArchiver::add_directory(struct zip * zip_archive,
 
 	add_directory(zip_archive, archive_file, base_dir_path, 
 		      iter->path(), // already prefixed with dir
-		      prepend_dir);
+		      prepend_dir, temp_dir);
       }
 
     }
+    else if(get_filename_from_path(iter->path().string()) == TilePackFile::pack_filename &&
+	    TilePackFile::exists(dir.string())) {
+      add_single_file(zip_archive, archive_file, base_dir_path, iter->path(), prepend_dir,
+		      pack_source, true);
+    }
     else {
       add_single_file(zip_archive, archive_file, base_dir_path, iter->path(), prepend_dir);
     }
@@ -131,19 +165,26 @@ void ProjectArchiver::export_data(path const& project_dir,
     throw ZipException(f.str());
   }
 
+  // Compressed copies of tile pack files must exist until the archive is closed.
+  std::string temp_dir = create_temp_directory();
+
   try {
-    add_directory(zip_archive, archive_file, project_dir, project_dir, prepend_dir);
+    add_directory(zip_archive, archive_file, project_dir, project_dir, prepend_dir, temp_dir);
   }
   catch(ZipException const& ex) {
     // rethrow exception, but free zip_archive resource first
     if(zip_archive != NULL) zip_close(zip_archive);
+    remove_directory(temp_dir);
     throw;
   }
 
   if(zip_archive != NULL && zip_close(zip_archive) < 0) {
     boost::format f("Cannot write zip archive %1%: %2%");
     f % archive_file % zip_strerror(zip_archive);
+    remove_directory(temp_dir);
     throw ZipException(f.str());
   }
 
+  remove_directory(temp_dir);
+
 }
@@ -32,6 +32,10 @@ namespace degate {
   /**
    * Export a project directory as a ZIP archive.
    *
+   * Tile pack files of background images are added in compressed form.
+   * If a pack file contains uncompressed tiles, a compressed copy is
+   * created in a temporary directory, using all processors. Compressed
+   * pack files are stored in the archive without further compression.
    */
 
   class ProjectArchiver {
@@ -42,14 +46,17 @@ namespace degate {
 			 boost::filesystem::path const& archive_file,
 			 boost::filesystem::path const& base_dir_path,
 			 boost::filesystem::path const& file,
-			 boost::filesystem::path const& prepend_dir) const;
+			 boost::filesystem::path const& prepend_dir,
+			 boost::filesystem::path const& source_file = boost::filesystem::path(),
+			 bool store_uncompressed = false) const;
 
 
       void add_directory(struct zip * zip_archive,
 			 boost::filesystem::path const& archive_file,
 			 boost::filesystem::path const& base_dir_path,
 			 boost::filesystem::path const& dir,
-			 boost::filesystem::path const& prepend_dir) const;
+			 boost::filesystem::path const& prepend_dir,
+			 std::string const& temp_dir) const;
 
   public:
     ProjectArchiver() {}
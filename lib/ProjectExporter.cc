@@ -63,17 +63,20 @@ void ProjectExporter::export_all(std::string const& project_directory, Project_s
 
     if(lmodel != NULL) {
       LogicModelExporter lm_exporter(oid_rewriter);
+      lm_exporter.set_export_buffer(get_export_buffer());
       string lm_filename(join_pathes(project_directory, lmodel_file));
       lm_exporter.export_data(lm_filename, lmodel);
 
 
       RCVBlacklistExporter rcv_exporter(oid_rewriter);
+      rcv_exporter.set_export_buffer(get_export_buffer());
       rcv_exporter.export_data(join_pathes(project_directory, rcbl_file), prj->get_rcv_blacklist());
 
       GateLibrary_shptr glib = lmodel->get_gate_library();
       if(glib != NULL) {
 
 	GateLibraryExporter gl_exporter(oid_rewriter);
+	gl_exporter.set_export_buffer(get_export_buffer());
 	gl_exporter.export_data(join_pathes(project_directory, gatelib_file), glib);
       }
     }
@@ -86,9 +89,9 @@ void ProjectExporter::export_data(std::string const& filename, Project_shptr prj
 
   try {
 
-    xmlpp::Document doc;
+    XMLDocument_shptr doc(new xmlpp::Document());
 
-    xmlpp::Element * root_elem = doc.create_root_node("project");
+    xmlpp::Element * root_elem = doc->create_root_node("project");
     assert(root_elem != NULL);
     set_project_node_attributes(root_elem, prj);
 
@@ -97,7 +100,7 @@ void ProjectExporter::export_data(std::string const& filename, Project_shptr prj
     add_colors(root_elem, prj);
     add_port_colors(root_elem, prj->get_port_color_manager());
 
-    doc.write_to_file_formatted(filename, "ISO-8859-1");
+    write_document(doc, filename);
 
   }
   catch(const std::exception& ex) {
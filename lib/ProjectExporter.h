@@ -73,6 +73,9 @@ namespace degate {
     void export_data(std::string const& filename, Project_shptr prj);
 
     /**
+     * Export the project, the logic model, the rule checker blacklist and
+     * the gate library. If the exporter has an export buffer, it is passed
+     * to the exporters of the project parts.
      * @exception InvalidPathException
      * @exception InvalidPointerException
      * @exception std::runtime_error
@@ -41,8 +41,12 @@
 #include <sstream>
 #include <stdexcept>
 #include <list>
+#include <algorithm>
 
 #include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <libxml/parser.h>
 
 using namespace std;
 using namespace degate;
@@ -55,65 +59,253 @@ std::string ProjectImporter::get_project_filename(std::string const& dir) const
     return dir;
 }
 
-Project_shptr ProjectImporter::import_all(std::string const& directory) {
-  Project_shptr prj = import(directory);
+/*
+ * Template images are decoded in chunks. Each chunk is a task.
+ */
+static const unsigned int template_images_per_task = 16;
 
-  if(prj != NULL) {
+/*
+ * Resources for the task graph. Tasks, that use the same resource,
+ * do not run concurrently.
+ */
 
-      GateLibraryImporter gl_importer;
+// The logic model import and setting template images both modify gate templates.
+static const char * resource_gate_library = "gate library";
 
-      GateLibrary_shptr gate_lib;
+// Background images and their scalings share the global tile cache, that is
+// not thread-safe.
+static const char * resource_tile_cache = "tile cache";
 
-      std::string gate_lib_file(get_basedir(directory) + "/gate_library.xml");
-      std::string rcbl_file(get_basedir(directory) + "/rc_blacklist.xml");
+/*
+ * The state of import_all(), that is shared between the tasks.
+ */
+struct ProjectImporter::ImportContext {
 
-      if(file_exists(gate_lib_file))
-	gate_lib = gl_importer.import(gate_lib_file);
-      else gate_lib = GateLibrary_shptr(new GateLibrary());
+  std::string directory;
+  Project_shptr prj;
 
-      LogicModelImporter lm_importer(prj->get_width(), prj->get_height(), gate_lib);
+  GateLibraryImporter gl_importer;
+  GateLibrary_shptr gate_lib;
 
-      lm_importer.import_into(prj->get_logic_model(),
-			      get_basedir(directory) + "/lmodel.xml");
+  TaskGraph graph;
+  TaskGraph::task_id apply_template_images_task;
 
-      LogicModel_shptr lmodel = prj->get_logic_model();
-      lmodel->set_default_gate_port_diameter(prj->get_default_port_diameter());
+  ProgressTask_shptr gate_lib_progress;
+  ProgressTask_shptr template_images_progress;
+  ProgressTask_shptr lmodel_progress;
+  ProgressTask_shptr rcbl_progress;
+  ProgressTask_shptr legacy_progress;
 
-      if(file_exists(rcbl_file)) {
-	RCVBlacklistImporter rcvbl_importer(lmodel);
-	rcvbl_importer.import_into(rcbl_file, prj->get_rcv_blacklist());
-      }
-      
-      /*
-	For degate projects that were exported with degate 0.0.6 the gate templates
-	were expressed in terms of an image region. This is bad. Here is a part of the fix:
-	We have loaded the project with the background images and we have the gate
-	library. We iterate over the gate library, extract the template image from the
-	background image and put it into the gate library. We do it for the first
-	transistor, the first logic and the first metal layer.
-      */
-
-      debug(TM, "Check if we have template images.");
-      for(GateLibrary::template_iterator iter = gate_lib->begin();
-	  iter != gate_lib->end(); ++iter) {
-
-	debug(TM, "Will grab template image for gate template ID: %d", iter->first);
-	GateTemplate_shptr tmpl = iter->second;
-	assert(tmpl != NULL);
-
-	BoundingBox const& bbox = tmpl->get_bounding_box();
-	if(bbox.get_min_x() != 0 && bbox.get_min_y() != 0 &&
-	   bbox.get_max_x() != 0 && bbox.get_max_y() != 0) { // a heuristic
-	  debug(TM, "Grab template images from the background for template %s.", tmpl->get_name().c_str());
-	  grab_template_images(lmodel, tmpl, bbox);
-	}
+  ImportContext() : gl_importer(false) {}
+};
 
-      }
-      debug(TM, "Project loaded.");
-      //prj->print_all(cout);
 
+void ProjectImporter::import_gate_library(ImportContext * ctx) {
+
+  set_log_message("Loading the gate library.");
+
+  std::string gate_lib_file(get_basedir(ctx->directory) + "/gate_library.xml");
+
+  if(file_exists(gate_lib_file))
+    ctx->gate_lib = ctx->gl_importer.import(gate_lib_file);
+  else ctx->gate_lib = GateLibrary_shptr(new GateLibrary());
+
+  ctx->gate_lib_progress->finish();
+
+  /*
+    The template images are decoded in parallel. They are set to the
+    templates in a separate task, because the logic model import works
+    on the templates meanwhile.
+  */
+
+  GateLibraryImporter::template_image_list const& images = ctx->gl_importer.get_deferred_images();
+  ctx->template_images_progress->set_total(images.size());
+
+  for(unsigned int i = 0; i < images.size(); i += template_images_per_task) {
+    TaskGraph::task_id t =
+      ctx->graph.add_task("load template images",
+			  boost::bind(&ProjectImporter::load_template_images, this, ctx, i,
+				      std::min<unsigned int>(i + template_images_per_task,
+							     images.size())));
+    ctx->graph.add_dependency(ctx->apply_template_images_task, t);
+  }
+}
+
+void ProjectImporter::load_template_images(ImportContext * ctx,
+					   unsigned int begin, unsigned int end) {
+
+  GateLibraryImporter::template_image_list & images = ctx->gl_importer.get_deferred_images();
+  CancellationToken_shptr token = get_cancellation_token();
+
+  for(unsigned int i = begin; i < end && !token->is_canceled(); i++) {
+    GateLibraryImporter::load_template_image(images[i]);
+    ctx->template_images_progress->advance();
+  }
+}
+
+void ProjectImporter::apply_template_images(ImportContext * ctx) {
+
+  BOOST_FOREACH(GateLibraryImporter::TemplateImage const& tmpl_image,
+		ctx->gl_importer.get_deferred_images())
+    GateLibraryImporter::apply_template_image(tmpl_image);
+
+  ctx->template_images_progress->finish();
+}
+
+void ProjectImporter::import_logic_model(ImportContext * ctx) {
+
+  set_log_message("Loading the logic model.");
+
+  LogicModelImporter lm_importer(ctx->prj->get_width(), ctx->prj->get_height(), ctx->gate_lib);
+
+  lm_importer.import_into(ctx->prj->get_logic_model(),
+			  get_basedir(ctx->directory) + "/lmodel.xml");
+
+  LogicModel_shptr lmodel = ctx->prj->get_logic_model();
+  lmodel->set_default_gate_port_diameter(ctx->prj->get_default_port_diameter());
+
+  ctx->lmodel_progress->finish();
+}
+
+void ProjectImporter::import_rcv_blacklist(ImportContext * ctx) {
+
+  std::string rcbl_file(get_basedir(ctx->directory) + "/rc_blacklist.xml");
+
+  if(file_exists(rcbl_file)) {
+    RCVBlacklistImporter rcvbl_importer(ctx->prj->get_logic_model());
+    rcvbl_importer.import_into(rcbl_file, ctx->prj->get_rcv_blacklist());
   }
 
+  ctx->rcbl_progress->finish();
+}
+
+void ProjectImporter::import_background_image(ImportContext * ctx, Layer_shptr layer,
+					      std::string image_filename,
+					      ProgressTask_shptr progress) {
+
+  set_log_message("Loading background images.");
+  load_background_image(layer, image_filename, ctx->prj);
+  progress->finish();
+}
+
+void ProjectImporter::grab_legacy_template_images(ImportContext * ctx) {
+
+  /*
+    For degate projects that were exported with degate 0.0.6 the gate templates
+    were expressed in terms of an image region. This is bad. Here is a part of the fix:
+    We have loaded the project with the background images and we have the gate
+    library. We iterate over the gate library, extract the template image from the
+    background image and put it into the gate library. We do it for the first
+    transistor, the first logic and the first metal layer.
+  */
+
+  LogicModel_shptr lmodel = ctx->prj->get_logic_model();
+
+  debug(TM, "Check if we have template images.");
+  for(GateLibrary::template_iterator iter = ctx->gate_lib->begin();
+      iter != ctx->gate_lib->end(); ++iter) {
+
+    debug(TM, "Will grab template image for gate template ID: %d", iter->first);
+    GateTemplate_shptr tmpl = iter->second;
+    assert(tmpl != NULL);
+
+    BoundingBox const& bbox = tmpl->get_bounding_box();
+    if(bbox.get_min_x() != 0 && bbox.get_min_y() != 0 &&
+       bbox.get_max_x() != 0 && bbox.get_max_y() != 0) { // a heuristic
+      debug(TM, "Grab template images from the background for template %s.", tmpl->get_name().c_str());
+      grab_template_images(lmodel, tmpl, bbox);
+    }
+
+  }
+
+  ctx->legacy_progress->finish();
+}
+
+Project_shptr ProjectImporter::import_all(std::string const& directory, unsigned int num_threads) {
+
+  reset_progress();
+  set_log_message("Loading the project file.");
+
+  // libxml2 must be initialized once, before documents are parsed in several threads.
+  xmlInitParser();
+
+  // Parse project.xml. The layers are created, but their images are loaded later.
+  defer_background_images = true;
+  deferred_background_images.clear();
+
+  Project_shptr prj;
+  try {
+    prj = import(directory);
+  }
+  catch(...) {
+    defer_background_images = false;
+    throw;
+  }
+  defer_background_images = false;
+
+  if(prj == NULL) return prj;
+
+  ImportContext ctx;
+  ctx.directory = directory;
+  ctx.prj = prj;
+
+  /*
+    Set up the task graph. Tasks are preferred in the order they are added,
+    therefore the logic model comes first.
+  */
+
+  ProgressTask_shptr progress = get_progress_task();
+  progress->set_total(9 + 2 * deferred_background_images.size());
+  ctx.gate_lib_progress = create_progress_subtask(1);
+  ctx.lmodel_progress = create_progress_subtask(4);
+  ctx.rcbl_progress = create_progress_subtask(1);
+  ctx.template_images_progress = create_progress_subtask(2);
+  ctx.legacy_progress = create_progress_subtask(1);
+  // the project file counts as done
+
+  TaskGraph & g = ctx.graph;
+
+  TaskGraph::task_id gate_lib_task =
+    g.add_task("gate library", boost::bind(&ProjectImporter::import_gate_library, this, &ctx));
+
+  TaskGraph::task_id lmodel_task =
+    g.add_task("logic model", boost::bind(&ProjectImporter::import_logic_model, this, &ctx),
+	       resource_gate_library);
+  g.add_dependency(lmodel_task, gate_lib_task);
+
+  TaskGraph::task_id rcbl_task =
+    g.add_task("rc blacklist", boost::bind(&ProjectImporter::import_rcv_blacklist, this, &ctx));
+  g.add_dependency(rcbl_task, lmodel_task);
+
+  ctx.apply_template_images_task =
+    g.add_task("template images", boost::bind(&ProjectImporter::apply_template_images, this, &ctx),
+	       resource_gate_library);
+  g.add_dependency(ctx.apply_template_images_task, gate_lib_task);
+
+  TaskGraph::task_id legacy_task =
+    g.add_task("legacy template images",
+	       boost::bind(&ProjectImporter::grab_legacy_template_images, this, &ctx),
+	       resource_tile_cache);
+  g.add_dependency(legacy_task, lmodel_task);
+  g.add_dependency(legacy_task, ctx.apply_template_images_task);
+
+  typedef std::pair<Layer_shptr, std::string> layer_image;
+  BOOST_FOREACH(layer_image const& l, deferred_background_images) {
+    TaskGraph::task_id t =
+      g.add_task("background image",
+		 boost::bind(&ProjectImporter::import_background_image, this, &ctx,
+			     l.first, l.second, create_progress_subtask(2)),
+		 resource_tile_cache);
+    g.add_dependency(legacy_task, t);
+  }
+  deferred_background_images.clear();
+
+  if(!g.run(num_threads, get_cancellation_token()))
+    throw DegateRuntimeException("Loading the project was canceled.");
+
+  progress->finish();
+  debug(TM, "Project loaded.");
+
   return prj;
 }
 
@@ -194,7 +386,10 @@ void ProjectImporter::parse_layers_element(const xmlpp::Element * const layers_e
 
       lmodel->add_layer(position, new_layer);
 
-      load_background_image(new_layer, image_filename, prj);
+      if(defer_background_images)
+	deferred_background_images.push_back(std::make_pair(new_layer, image_filename));
+      else
+	load_background_image(new_layer, image_filename, prj);
 
     }
   }
@@ -25,8 +25,12 @@
 #include "globals.h"
 #include "Project.h"
 #include "XMLImporter.h"
+#include "ProgressControl.h"
+#include "TaskGraph.h"
 
 #include <stdexcept>
+#include <list>
+#include <utility>
 
 namespace degate {
 
@@ -37,11 +41,24 @@ namespace degate {
  * file project.xml, that is present in every degate project directory.
  * The ProjectImporter loads associated files, e.g. the logic model file and
  * the gate library, as well.
+ *
+ * import_all() loads the parts of a project in a TaskGraph. Parts, that do
+ * not depend on each other, are loaded concurrently: the logic model, the
+ * gate library images and the background images of the layers. The progress
+ * is reported via the ProgressControl interface and the import can be
+ * canceled.
  */
-class ProjectImporter : public XMLImporter {
+class ProjectImporter : public XMLImporter, public ProgressControl {
 
 private:
 
+  struct ImportContext;
+
+  // If set, background images are not loaded while parsing the layers.
+  // The layers are collected for import_all() instead.
+  bool defer_background_images;
+  std::list<std::pair<Layer_shptr, std::string> > deferred_background_images;
+
   void parse_project_element(Project_shptr parent_prj, const xmlpp::Element * const project_node);
   void parse_grids_element(const xmlpp::Element * const project_node, Project_shptr prj);
   void parse_layers_element(const xmlpp::Element * const layers_node, Project_shptr prj);
@@ -60,8 +77,20 @@ private:
 			     std::string const& image_filename,
 			     Project_shptr prj);
 
+  /*
+   * Tasks of import_all().
+   */
+  void import_gate_library(ImportContext * ctx);
+  void load_template_images(ImportContext * ctx, unsigned int begin, unsigned int end);
+  void apply_template_images(ImportContext * ctx);
+  void import_logic_model(ImportContext * ctx);
+  void import_rcv_blacklist(ImportContext * ctx);
+  void import_background_image(ImportContext * ctx, Layer_shptr layer, std::string image_filename,
+			       ProgressTask_shptr progress);
+  void grab_legacy_template_images(ImportContext * ctx);
+
 public:
-  ProjectImporter() {}
+  ProjectImporter() : defer_background_images(false) {}
   ~ProjectImporter() {}
 
   /**
@@ -78,13 +107,18 @@ public:
    * Import a complete degate project, including the default gate library and the logic model.
    * @param path The parameter path specifies the project directory
    *             or the path to the project.xml file. It is determined automatically.
-   * @exception std::runtime_error If there are parsing problems.
+   * @param num_threads The number of loader threads. Use 0 for the number of
+   *             available processors.
+   * @exception std::runtime_error If there are parsing problems or if the
+   *             import was canceled.
    * @return Returns a pointer to a project object.
    */
-  Project_shptr import_all(std::string const& path);
+  Project_shptr import_all(std::string const& path, unsigned int num_threads = 0);
 
 };
 
+typedef std::tr1::shared_ptr<ProjectImporter> ProjectImporter_shptr;
+
 }
 
 #endif
@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <list>
+#include <algorithm>
 #include <assert.h>
 #include "globals.h"
 #include <iostream>
@@ -82,7 +83,11 @@ namespace degate {
 
     BoundingBox box;
     std::vector<QuadTree<T> > subtree_nodes;
-    std::list<T> children;
+
+    // A vector needs less memory per object than a list. The number of
+    // objects per node is small, so removing from the middle is cheap.
+    typedef std::vector<T> children_collection;
+    children_collection children;
 
     QuadTree * parent;
 
@@ -312,11 +317,10 @@ namespace degate {
   template <typename T>
   ret_t QuadTree<T>::reinsert_objects() {
 
-    typename std::list<T> children_copy = children;
-
-    children.clear();
+    children_collection children_copy;
+    children_copy.swap(children);
 
-    for(typename std::list<T>::iterator it = children_copy.begin();
+    for(typename children_collection::iterator it = children_copy.begin();
 	it != children_copy.end();
 	++it) {
       insert(*it);
@@ -366,7 +370,8 @@ namespace degate {
     QuadTree<T> * found = traverse_downto_bounding_box(bbox);
     assert(found != NULL);
     if(found != NULL) {
-      found->children.remove(object);
+      found->children.erase(std::remove(found->children.begin(), found->children.end(), object),
+			    found->children.end());
 
       if(!found->is_leave() &&
 	 found->subtree_nodes[NW].children.size() == 0 &&
@@ -496,7 +501,7 @@ namespace degate {
 
     if(parent == NULL /* || children.size() < 5 */ ) {
 
-      for(typename std::list<T>::iterator c_iter = children.begin();
+      for(typename children_collection::iterator c_iter = children.begin();
 	  c_iter != children.end(); ++c_iter) {
 
 	const BoundingBox & e_bb =
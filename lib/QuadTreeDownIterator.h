@@ -33,8 +33,8 @@ class down_iterator : public std::iterator<std::forward_iterator_tag, T> {
   QuadTree<T> * node;
   bool done;
 
-  typename std::list<T>::iterator children_iter;
-  typename std::list<T>::iterator children_iter_end;
+  typename QuadTree<T>::children_collection::iterator children_iter;
+  typename QuadTree<T>::children_collection::iterator children_iter_end;
 
   std::list<QuadTree<T> *> open_list;
 
@@ -35,8 +35,8 @@ namespace degate {
     QuadTree<T> * node;
     bool done;
 
-    typename std::list<T>::iterator children_iter;
-    typename std::list<T>::iterator children_iter_end;
+    typename QuadTree<T>::children_collection::iterator children_iter;
+    typename QuadTree<T>::children_collection::iterator children_iter_end;
 
     std::list<QuadTree<T> *> open_list;
 
@@ -26,6 +26,7 @@
 #include <tr1/memory>
 #include <list>
 #include <LogicModel.h>
+#include <NetlistGraph.h>
 #include <RCVContainer.h>
 
 namespace degate {
@@ -40,8 +41,23 @@ namespace degate {
   };
 
 
+  /**
+   * An enum that describes the objects a Rule Check inspects independently
+   * of each other.
+   */
+  enum RC_SCOPE {
+    RC_SCOPE_MODEL = 0, /**< The check needs the whole logic model. */
+    RC_SCOPE_NET = 1,   /**< Each net is checked separately. */
+    RC_SCOPE_GATE = 2   /**< Each gate is checked separately. */
+  };
+
   /**
    * Base class for Rule Checks.
+   *
+   * Checks with a net or gate scope implement check() and report the scope
+   * via get_scope(). The RuleChecker partitions their input across threads
+   * and re-checks only nets and gates that were touched since the last run.
+   * Checks with a model scope implement run() instead.
    */
 
   class RCBase {
@@ -78,13 +94,43 @@ namespace degate {
     virtual ~RCBase() {}
 
     /**
-     * The run method is abstract and must be implemented in derived
-     * classes. The implementation should check for design rule violations.
+     * The run method must be implemented in derived classes with a model
+     * scope. The implementation should check for design rule violations.
      * Each RC violation must be stored via method add_rc_violation().
      * Note: Because run() can be called multiple times, at the beginning of
      * run() you must clear the list of detected violations.
+     *
+     * The default implementation serially calls check() for all nets or
+     * gates of a check with a net or gate scope.
      */
-    virtual void run(LogicModel_shptr lmodel) = 0;
+    virtual void run(LogicModel_shptr lmodel) {
+      clear_rc_violations();
+
+      if(lmodel == NULL || get_scope() == RC_SCOPE_MODEL) return;
+
+      NetlistGraph_shptr graph = lmodel->get_netlist_graph();
+      unsigned int n = get_scope() == RC_SCOPE_NET ? graph->get_num_nets() : graph->get_num_gates();
+      for(NetlistGraph::index_t i = 0; i < n; i++) check(*graph, i, rc_violations);
+    }
+
+    /**
+     * Get the scope of the check.
+     */
+    virtual RC_SCOPE get_scope() const {
+      return RC_SCOPE_MODEL;
+    }
+
+    /**
+     * Check a single net or gate. This method is called concurrently from
+     * multiple threads and therefore must not modify the check or the logic
+     * model. Violations should be created with a lazily formatted description.
+     * @param graph The netlist graph.
+     * @param i The net index for a net scope or the gate index for a gate scope.
+     * @param violations Violations are appended to this container.
+     */
+    virtual void check(NetlistGraph const& graph, NetlistGraph::index_t i,
+		       container_type & violations) const {
+    }
 
     /**
      * Get the list of RC violations.
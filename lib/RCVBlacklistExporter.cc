@@ -48,16 +48,16 @@ void RCVBlacklistExporter::export_data(std::string const& filename,
 
   try {
 
-    xmlpp::Document doc;
+    XMLDocument_shptr doc(new xmlpp::Document());
 
-    xmlpp::Element * root_elem = doc.create_root_node("rc-blacklist");
+    xmlpp::Element * root_elem = doc->create_root_node("rc-blacklist");
     assert(root_elem != NULL);
 
     BOOST_FOREACH(RCViolation_shptr rcv, violations) {
       add_rcv(root_elem, rcv);
     }
 
-    doc.write_to_file_formatted(filename, "ISO-8859-1");
+    write_document(doc, filename);
 
   }
   catch(const std::exception& ex) {
@@ -34,6 +34,14 @@ void RCVContainer::push_back(RCViolation_shptr rcv) {
   violations.push_back(rcv);
 }
 
+void RCVContainer::append(RCVContainer const& other) {
+  violations.insert(violations.end(), other.violations.begin(), other.violations.end());
+}
+
+void RCVContainer::reserve(size_t n) {
+  violations.reserve(n);
+}
+
 RCVContainer::iterator RCVContainer::begin() { 
   return violations.begin(); 
 }
@@ -24,7 +24,7 @@
 
 #include <boost/foreach.hpp>
 #include <tr1/memory>
-#include <list>
+#include <vector>
 #include <RCBase.h>
 
 namespace degate {
@@ -39,7 +39,7 @@ namespace degate {
    */
   class RCVContainer {
   public:
-    typedef std::list<RCViolation_shptr> container_type;
+    typedef std::vector<RCViolation_shptr> container_type;
     typedef container_type::iterator iterator;
     typedef container_type::const_iterator const_iterator;
 
@@ -61,6 +61,16 @@ namespace degate {
      * Add a RC violation to the container.
      */
     void push_back(RCViolation_shptr rcv);
+
+    /**
+     * Add all RC violations from another container.
+     */
+    void append(RCVContainer const& other);
+
+    /**
+     * Reserve space for RC violations.
+     */
+    void reserve(size_t n);
     
     /**
      * Get an iterator to the start of the list.
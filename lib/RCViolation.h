@@ -23,21 +23,36 @@
 #define __RCVIOLATION_H__
 
 #include <boost/foreach.hpp>
+#include <boost/format.hpp>
 #include <tr1/memory>
 #include <list>
+#include <string.h>
 #include <LogicModel.h>
 #include <RCBase.h>
 
 namespace degate {
 
+  /**
+   * A Rule Check violation.
+   *
+   * Rule checks may report many violations and most of the descriptions are
+   * never looked at. Therefore a violation can be created with a message
+   * format instead of a description. The description is formatted on the
+   * first call to get_problem_description(). This is not thread-safe.
+   */
+
   class RCViolation {
   private:
 
     PlacedLogicModelObject_shptr _obj;
-    std::string _problem_description;
+    mutable std::string _problem_description;
     std::string _rc_violation_class;
     RC_SEVERITY _severity;
 
+    // If set, the problem description is formatted lazily.
+    char const * _message_format;
+    unsigned int _message_arg;
+
   public:
 
     /** Create a new Rule Check violation.
@@ -57,10 +72,42 @@ namespace degate {
       _obj(obj),
       _problem_description(problem_description),
       _rc_violation_class(rc_violation_class),
-      _severity(severity) {
+      _severity(severity),
+      _message_format(NULL),
+      _message_arg(0) {
+    }
+
+    /** Create a new Rule Check violation with a lazily formatted description.
+     * @param obj The object, which is affected from the violation.
+     * @param message_format A boost::format string. The placeholder %1% is
+     *   replaced with the descriptive identifier of the object and %2% with
+     *   \p message_arg. The string must be a literal or at least outlive
+     *   the violation, because only the pointer is stored.
+     * @param message_arg A number for the description.
+     * @param rc_violation_class This is a unique technical name for
+     *   a rc violation, that indicates the problem class.
+     * @param severity Indicates the type of problem.
+     */
+
+    RCViolation(PlacedLogicModelObject_shptr obj,
+		char const * message_format,
+		unsigned int message_arg,
+		std::string const& rc_violation_class,
+		RC_SEVERITY severity = RC_ERROR) :
+      _obj(obj),
+      _rc_violation_class(rc_violation_class),
+      _severity(severity),
+      _message_format(message_format),
+      _message_arg(message_arg) {
     }
 
     std::string get_problem_description() const {
+      if(_message_format != NULL && _problem_description.empty()) {
+	boost::format f(_message_format);
+	f.exceptions(boost::io::all_error_bits ^ boost::io::too_many_args_bit);
+	f % _obj->get_descriptive_identifier() % _message_arg;
+	_problem_description = f.str();
+      }
       return _problem_description;
     }
 
@@ -102,11 +149,17 @@ namespace degate {
      * Check if two rc violations are conceptually equal.
      */
     bool equals(RCViolation_shptr rcv) const {
-      return 
-	_obj == rcv->_obj &&
-	_problem_description == rcv->_problem_description &&
-	_rc_violation_class == rcv->_rc_violation_class &&
-	_severity == rcv->_severity;
+      if(_obj != rcv->_obj ||
+	 _severity != rcv->_severity ||
+	 _rc_violation_class != rcv->_rc_violation_class) return false;
+
+      // Avoid formatting, if both descriptions are lazy.
+      if(_message_format != NULL && rcv->_message_format != NULL)
+	return _message_arg == rcv->_message_arg &&
+	  (_message_format == rcv->_message_format ||
+	   strcmp(_message_format, rcv->_message_format) == 0);
+
+      return get_problem_description() == rcv->get_problem_description();
     }
 
 
@@ -26,37 +26,23 @@
 
 using namespace degate;
 
-Rectangle::Rectangle() :
-  min_x(0),
-  max_x(0),
-  min_y(0),
-  max_y(0) {
-  calculate_bounding_box();
+Rectangle::Rectangle() {
 }
 
-Rectangle::Rectangle(int min_x, int max_x, int min_y, int max_y) {
-
-  this->min_x = std::min(min_x, max_x);
-  this->max_x = std::max(min_x, max_x);
-  this->min_y = std::min(min_y, max_y);
-  this->max_y = std::max(min_y, max_y);
-  calculate_bounding_box();
+Rectangle::Rectangle(int min_x, int max_x, int min_y, int max_y) :
+  bounding_box(min_x, max_x, min_y, max_y) {
 }
 
-Rectangle::Rectangle(const Rectangle& o) {
-  this->min_x = o.min_x;
-  this->max_x = o.max_x;
-  this->min_y = o.min_y;
-  this->max_y = o.max_y;
-  calculate_bounding_box();
+Rectangle::Rectangle(const Rectangle& o) :
+  bounding_box(o.bounding_box) {
 }
 
 Rectangle::~Rectangle() {
 }
 
 bool Rectangle::in_shape(int x, int y, int max_distance) const {
-  return (x >= min_x - max_distance && x <= max_x + max_distance &&
-	  y >= min_y - max_distance && y <= max_y + max_distance) ? true : false;
+  return geo_in_rect(make_geo_rect(get_min_x() - max_distance, get_max_x() + max_distance,
+				   get_min_y() - max_distance, get_max_y() + max_distance), x, y);
 }
 
 BoundingBox const& Rectangle::get_bounding_box() const {
@@ -65,10 +51,7 @@ BoundingBox const& Rectangle::get_bounding_box() const {
 
 
 bool Rectangle::operator==(const Rectangle& other) const {
-  return (min_x == other.min_x &&
-	  max_x == other.max_x &&
-	  min_y == other.min_y &&
-	  max_y == other.max_y);
+  return bounding_box == other.bounding_box;
 }
 
 bool Rectangle::operator!=(const Rectangle& other) const {
@@ -81,18 +64,14 @@ bool Rectangle::operator!=(const Rectangle& other) const {
 
 bool Rectangle::in_bounding_box(BoundingBox const& bbox) const {
 
-  return ( bbox.get_min_x() <= min_x ||
-	   bbox.get_max_x() >= max_x ||
-	   bbox.get_min_y() <= min_y ||
-	   bbox.get_max_y() >= max_y);
+  return ( bbox.get_min_x() <= get_min_x() ||
+	   bbox.get_max_x() >= get_max_x() ||
+	   bbox.get_min_y() <= get_min_y() ||
+	   bbox.get_max_y() >= get_max_y());
 }
 
 bool Rectangle::intersects(Rectangle const & rect) const {
-
-  return !( rect.min_x > max_x ||
-	    rect.max_x < min_x ||
-	    rect.min_y > max_y ||
-	    rect.max_y < min_y);
+  return bounding_box.intersects(rect.bounding_box);
 }
 
 
@@ -102,89 +81,69 @@ bool Rectangle::intersects(Rectangle const & rect) const {
 
 bool Rectangle::complete_within(Rectangle const & rect) const {
 
-  return (min_x <= rect.min_x &&
-	  max_x >= rect.max_x &&
-	  min_y <= rect.min_y &&
-	  max_y >= rect.max_y);
+  return (get_min_x() <= rect.get_min_x() &&
+	  get_max_x() >= rect.get_max_x() &&
+	  get_min_y() <= rect.get_min_y() &&
+	  get_max_y() >= rect.get_max_y());
 }
 
 unsigned int Rectangle::get_width() const {
-  return max_x - min_x;
+  return bounding_box.get_width();
 }
 
 unsigned int Rectangle::get_height() const {
-  return max_y - min_y;
+  return bounding_box.get_height();
 }
 
 int Rectangle::get_min_x() const {
-  return min_x;
+  return bounding_box.get_min_x();
 }
 
 int Rectangle::get_max_x() const {
-  return max_x;
+  return bounding_box.get_max_x();
 }
 
 int Rectangle::get_min_y() const {
-  return min_y;
+  return bounding_box.get_min_y();
 }
 
 int Rectangle::get_max_y() const {
-  return max_y;
+  return bounding_box.get_max_y();
 }
 
 void Rectangle::set_min_x(int min_x) {
-  this->min_x = std::min(min_x, max_x);
-  this->max_x = std::max(min_x, max_x);
-  calculate_bounding_box();
+  bounding_box.set_min_x(min_x);
 }
 
 void Rectangle::set_min_y(int min_y) {
-  this->min_y = std::min(min_y, max_y);
-  this->max_y = std::max(min_y, max_y);
-  calculate_bounding_box();
+  bounding_box.set_min_y(min_y);
 }
 
 void Rectangle::set_max_x(int max_x) {
-  this->min_x = std::min(min_x, max_x);
-  this->max_x = std::max(min_x, max_x);
-  calculate_bounding_box();
+  bounding_box.set_max_x(max_x);
 }
 
 void Rectangle::set_max_y(int max_y) {
-  this->min_y = std::min(min_y, max_y);
-  this->max_y = std::max(min_y, max_y);
-  calculate_bounding_box();
+  bounding_box.set_max_y(max_y);
 }
 
 void Rectangle::shift_y(int delta_y) {
-  min_y += delta_y;
-  max_y += delta_y;
-  calculate_bounding_box();
+  bounding_box.shift_y(delta_y);
 }
 
 void Rectangle::shift_x(int delta_x) {
-  min_x += delta_x;
-  max_x += delta_x;
-  calculate_bounding_box();
+  bounding_box.shift_x(delta_x);
 }
 
 
 int Rectangle::get_center_x() const {
-  return min_x + get_width() / 2;
+  return get_min_x() + get_width() / 2;
 }
 
 int Rectangle::get_center_y() const {
-  return min_y + get_height() / 2;
+  return get_min_y() + get_height() / 2;
 }
 
 void Rectangle::set_position(int min_x, int max_x, int min_y, int max_y) {
-  this->min_x = std::min(min_x, max_x);
-  this->max_x = std::max(min_x, max_x);
-  this->min_y = std::min(min_y, max_y);
-  this->max_y = std::max(min_y, max_y);
-  calculate_bounding_box();
-}
-
-void Rectangle::calculate_bounding_box() {
   bounding_box = BoundingBox(min_x, max_x, min_y, max_y);
 }
@@ -24,18 +24,17 @@
 
 #include "BoundingBox.h"
 #include "Shape.h"
+#include "Geometry.h"
 
 namespace degate {
 
   class Rectangle : public AbstractShape {
 
   private:
-    int min_x, max_x, min_y, max_y;
 
+    // The bounding box is the rectangle itself.
     BoundingBox bounding_box;
 
-    void calculate_bounding_box();
-
   public:
 
     Rectangle();
@@ -76,6 +75,14 @@ namespace degate {
     virtual void shift_x(int delta_x);
     virtual void shift_y(int delta_y);
 
+    /**
+     * Get the rectangle as a record for the geometry kernel.
+     */
+    GeoRect get_geo_rect() const {
+      return make_geo_rect(bounding_box.get_min_x(), bounding_box.get_max_x(),
+			   bounding_box.get_min_y(), bounding_box.get_max_y());
+    }
+
   };
 
 }
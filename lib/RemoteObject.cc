@@ -22,6 +22,26 @@
 
 #include <degate.h>
 #include <RemoteObject.h>
+#include <XmlRpc.h>
 
 using namespace degate;
 
+object_id_t RemoteObject::push(std::string const& server_url) {
+
+  if(has_remote_object_id()) {
+    debug(TM, "RemoteObject::push(): object is already pushed to server.");
+    return 0;
+  }
+
+  std::vector<xmlrpc_c::value> command;
+  get_push_command(command);
+
+  std::vector<std::vector<xmlrpc_c::value> > commands(1, command);
+  std::vector<transaction_id_t> tids;
+  push_commands(get_xmlrpc_connection(server_url), commands, tids);
+
+  set_remote_object_id(tids[0]);
+  debug(TM, "RemoteObject::push(): pushed object to server. remote id is: %d", tids[0]);
+  return tids[0];
+}
+
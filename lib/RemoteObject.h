@@ -25,21 +25,27 @@
 
 #include <cstdlib>
 #include <string>
+#include <vector>
 #include <iostream>
 #include <assert.h>
 
+namespace xmlrpc_c {
+  class value;
+}
+
 namespace degate {
 
+  /**
+   * Base class for logic model objects, that can be synchronized with
+   * a collaboration server.
+   */
+
   class RemoteObject {
 
   private:
 
     object_id_t remote_oid;
 
-  protected:
-
-    virtual object_id_t push_object_to_server(std::string const& server_url) = 0;
-
   public:
 
     RemoteObject() : remote_oid(0) {
@@ -61,17 +67,20 @@ namespace degate {
       remote_oid = oid;
     }
 
-
-    virtual object_id_t push(std::string const& server_url) {
-      if(remote_oid == 0) {
-	debug(TM, "RemoteObject::push(): push object to server.");
-	return push_object_to_server(server_url);
-      }
-      else {
-	debug(TM, "RemoteObject::push(): object is already pushed to server.");
-	return 0;
-      }
-    }
+    /**
+     * Get the command, that adds this object on the server, e.g.
+     * ("add", "wire", layer ID, ...). The command is sent as parameter
+     * list of a degate.push call or as an element of a batch.
+     */
+    virtual void get_push_command(std::vector<xmlrpc_c::value> & command) = 0;
+
+    /**
+     * Push the object to the server with a single request. Prefer
+     * push_changes_to_server() for many objects, because it batches commands.
+     * @return Returns the remote object ID or 0, if the object was already pushed.
+     * @exception XMLRPCException This exception is thrown, if the XMLRPC fails.
+     */
+    virtual object_id_t push(std::string const& server_url);
 
   };
 
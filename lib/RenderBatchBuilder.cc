@@ -0,0 +1,763 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <degate.h>
+#include <RenderBatchBuilder.h>
+
+#include <boost/foreach.hpp>
+
+#include <math.h>
+#include <algorithm>
+
+using namespace degate;
+
+/*
+ * Color helpers.
+ */
+
+static inline color_t highlight_color(color_t col) {
+  uint8_t r = MASK_R(col);
+  uint8_t g = MASK_G(col);
+  uint8_t b = MASK_B(col);
+  uint8_t a = MASK_A(col);
+
+  return MERGE_CHANNELS((((255-r)>>1) + r),
+			(((255-g)>>1) + g),
+			(((255-b)>>1) + b), (a < 128 ? 128 : a));
+}
+
+static inline color_t highlight_color_by_state(color_t col,
+					       PlacedLogicModelObject::HIGHLIGHTING_STATE state) {
+  switch(state) {
+  case PlacedLogicModelObject::HLIGHTSTATE_DIRECT:
+    return highlight_color(highlight_color(col));
+  case PlacedLogicModelObject::HLIGHTSTATE_ADJACENT:
+    return highlight_color(col);
+  case PlacedLogicModelObject::HLIGHTSTATE_NOT:
+  default:
+    return col;
+  }
+}
+
+/*
+ * Geometry helpers. They produce the same shapes as the immediate mode
+ * drawing functions of the GUI renderer.
+ */
+
+static inline void add_vertex(RenderBatchBuilder::vertex_array & v, float x, float y, color_t col) {
+  RenderBatchBuilder::Vertex vertex;
+  vertex.x = x;
+  vertex.y = y;
+  vertex.color = col;
+  v.push_back(vertex);
+}
+
+static inline void add_triangle(RenderBatchBuilder::vertex_array & v,
+				int x1, int y1, int x2, int y2, int x3, int y3, color_t col) {
+  add_vertex(v, x1, y1, col);
+  add_vertex(v, x2, y2, col);
+  add_vertex(v, x3, y3, col);
+}
+
+static inline void add_line(RenderBatchBuilder::vertex_array & v,
+			    int x1, int y1, int x2, int y2, color_t col) {
+  add_vertex(v, x1, y1, col);
+  add_vertex(v, x2, y2, col);
+}
+
+static void add_quad(RenderBatchBuilder::vertex_array & v,
+		     int min_x, int min_y, int max_x, int max_y, color_t col) {
+  add_triangle(v, min_x, min_y, max_x, min_y, max_x, max_y, col);
+  add_triangle(v, min_x, min_y, max_x, max_y, min_x, max_y, col);
+}
+
+static void add_frame(RenderBatchBuilder::vertex_array & v,
+		      int min_x, int min_y, int max_x, int max_y, color_t col) {
+  add_line(v, min_x, min_y, max_x, min_y, col);
+  add_line(v, max_x, min_y, max_x, max_y, col);
+  add_line(v, max_x, max_y, min_x, max_y, col);
+  add_line(v, min_x, max_y, min_x, min_y, col);
+}
+
+static void add_circle(RenderBatchBuilder::vertex_array & v,
+		       int x, int y, unsigned int diameter, color_t col) {
+  const unsigned int segments = 10;
+  float r = diameter >> 1;
+  for(unsigned int i = 0; i < segments; i++) {
+    float a1 = 2 * M_PI * i / segments;
+    float a2 = 2 * M_PI * (i + 1) / segments;
+    add_vertex(v, x, y, col);
+    add_vertex(v, x + r * cos(a1), y + r * sin(a1), col);
+    add_vertex(v, x + r * cos(a2), y + r * sin(a2), col);
+  }
+}
+
+/**
+ * Add a square, optionally with noses left and/or right as used for gate ports.
+ */
+static void add_square(RenderBatchBuilder::PrimitiveSet & p,
+		       int x, int y, unsigned int diameter, color_t col,
+		       bool outline, bool nose_left = false, bool nose_right = false) {
+  int r = diameter >> 1;
+  int min_x = x - r, min_y = y - r, max_x = x + r, max_y = y + r;
+
+  if(nose_left || nose_right) {
+    add_triangle(p.triangles, min_x, min_y, max_x, min_y, max_x, max_y, col);
+    add_triangle(p.triangles, x, y, max_x, max_y, min_x, max_y, col);
+    if(nose_right)
+      add_triangle(p.triangles, max_x, min_y, max_x, max_y, max_x + r, y, col);
+  }
+  else
+    add_quad(p.triangles, min_x, min_y, max_x, max_y, col);
+
+  if(outline) {
+    const int d = 3;
+    add_frame(p.lines, min_x - d, min_y - d, max_x + d, max_y + d, col);
+  }
+}
+
+/*
+ * LOD helpers.
+ */
+
+/**
+ * Accumulates color channels weighted by an area.
+ */
+struct ColorAccumulator {
+  double area, r, g, b, a;
+
+  ColorAccumulator() : area(0), r(0), g(0), b(0), a(0) {}
+
+  void add(color_t col, double weight) {
+    area += weight;
+    r += weight * MASK_R(col);
+    g += weight * MASK_G(col);
+    b += weight * MASK_B(col);
+    a += weight * MASK_A(col);
+  }
+
+  void add(ColorAccumulator const& other) {
+    area += other.area;
+    r += other.r;
+    g += other.g;
+    b += other.b;
+    a += other.a;
+  }
+
+  /**
+   * Get the average color. The alpha channel is scaled down by the
+   * coverage, but kept at a quarter, so that sparse cells remain visible.
+   * It is quantized, so that neighbouring cells with a similar coverage
+   * can be merged.
+   */
+  color_t get_color(double coverage = 1) const {
+    if(area <= 0) return 0;
+    double alpha = a / area * std::min(1.0, std::max(0.25, coverage));
+    return MERGE_CHANNELS(lrint(r / area), lrint(g / area), lrint(b / area),
+			  lrint(alpha) & 0xe0);
+  }
+};
+
+/**
+ * A sparse area of cells, that records how much of each cell is
+ * covered by objects.
+ */
+class DensityRaster {
+
+private:
+
+  int cell_size;
+  int min_cx, min_cy, cells_x, cells_y;
+  std::vector<ColorAccumulator> cells;
+
+public:
+
+  DensityRaster(BoundingBox const& bounds, unsigned int _cell_size) :
+    cell_size(_cell_size),
+    min_cx(bounds.get_min_x() / cell_size),
+    min_cy(bounds.get_min_y() / cell_size),
+    cells_x(bounds.get_max_x() / cell_size - min_cx + 1),
+    cells_y(bounds.get_max_y() / cell_size - min_cy + 1),
+    cells(cells_x * cells_y) {}
+
+  void add(double x, double y, double area, color_t col) {
+    int cx = std::max(0, std::min((int)floor(x / cell_size) - min_cx, cells_x - 1));
+    int cy = std::max(0, std::min((int)floor(y / cell_size) - min_cy, cells_y - 1));
+    cells[cy * cells_x + cx].add(col, area);
+  }
+
+  /**
+   * Distribute the area of a line along the cells it passes.
+   */
+  void add_line(int x1, int y1, int x2, int y2, diameter_t diameter, color_t col) {
+    double len = sqrt(pow(x2 - x1, 2) + pow(y2 - y1, 2));
+    unsigned int samples = std::max(1U, (unsigned int)ceil(2 * len / cell_size));
+    double area = std::max(len, 1.0) * std::max(diameter, (diameter_t)1) / samples;
+
+    for(unsigned int i = 0; i < samples; i++) {
+      double t = (i + 0.5) / samples;
+      add(x1 + t * (x2 - x1), y1 + t * (y2 - y1), area, col);
+    }
+  }
+
+  /**
+   * Emit a quad for each run of non-empty cells in a row, that have the same color.
+   */
+  void emit(RenderBatchBuilder::vertex_array & v) const {
+    double cell_area = (double)cell_size * cell_size;
+
+    for(int cy = 0; cy < cells_y; cy++) {
+      int run_start = 0;
+      color_t run_col = 0;
+
+      for(int cx = 0; cx <= cells_x; cx++) {
+	color_t col = 0;
+	if(cx < cells_x) {
+	  ColorAccumulator const& c = cells[cy * cells_x + cx];
+	  col = c.get_color(c.area / cell_area);
+	}
+
+	if(cx == cells_x || col != run_col) {
+	  if(run_col != 0)
+	    add_quad(v, (min_cx + run_start) * cell_size, (min_cy + cy) * cell_size,
+		     (min_cx + cx) * cell_size, (min_cy + cy + 1) * cell_size, run_col);
+	  run_start = cx;
+	  run_col = col;
+	}
+      }
+    }
+  }
+};
+
+/**
+ * A horizontal run of gates.
+ */
+struct GateAggregate {
+  int row, min_x, max_x, min_y, max_y;
+  ColorAccumulator fill, frame;
+
+  bool operator<(GateAggregate const& other) const {
+    return row < other.row || (row == other.row && min_x < other.min_x);
+  }
+};
+
+/*
+ * PrimitiveSet
+ */
+
+void RenderBatchBuilder::PrimitiveSet::clear() {
+  triangles.clear();
+  lines.clear();
+  wide_lines.clear();
+}
+
+bool RenderBatchBuilder::PrimitiveSet::empty() const {
+  return get_num_vertices() == 0;
+}
+
+unsigned int RenderBatchBuilder::PrimitiveSet::get_num_vertices() const {
+  unsigned int n = triangles.size() + lines.size();
+  for(std::map<diameter_t, vertex_array>::const_iterator iter = wide_lines.begin();
+      iter != wide_lines.end(); ++iter)
+    n += iter->second.size();
+  return n;
+}
+
+/*
+ * RenderChunk
+ */
+
+void RenderBatchBuilder::RenderChunk::extend(BoundingBox const& bbox) {
+  if(!has_extent) {
+    extent = bbox;
+    has_extent = true;
+  }
+  else
+    extent.set(std::min(extent.get_min_x(), bbox.get_min_x()),
+	       std::max(extent.get_max_x(), bbox.get_max_x()),
+	       std::min(extent.get_min_y(), bbox.get_min_y()),
+	       std::max(extent.get_max_y(), bbox.get_max_y()));
+}
+
+void RenderBatchBuilder::RenderChunk::invalidate() {
+  dirty = true;
+  lod.clear();
+}
+
+RenderBatchBuilder::PrimitiveSet const&
+RenderBatchBuilder::RenderChunk::get_primitives(RENDER_GROUP group, unsigned int lod_cell_size) const {
+  if(lod_cell_size == 0) return groups[group];
+
+  std::map<unsigned int, LODPrimitives>::const_iterator found = lod.find(lod_cell_size);
+  if(found == lod.end())
+    throw DegateLogicException("There are no aggregated primitives for this cell size.");
+  return found->second.groups[group];
+}
+
+/*
+ * RenderBatchBuilder
+ */
+
+RenderBatchBuilder::RenderBatchBuilder(Layer_shptr _layer, unsigned int _chunk_size) :
+  layer(_layer),
+  chunk_size(_chunk_size),
+  highlight_epoch(0) {
+
+  if(layer == NULL) throw InvalidPointerException("Invalid layer passed to RenderBatchBuilder.");
+  if(chunk_size == 0) throw DegateLogicException("The chunk size must not be zero.");
+
+  chunks_x = std::max((layer->get_width() + chunk_size - 1) / chunk_size, 1U);
+  chunks_y = std::max((layer->get_height() + chunk_size - 1) / chunk_size, 1U);
+  chunks.resize(chunks_x * chunks_y);
+
+  for(Layer::object_iterator iter = layer->objects_begin();
+      iter != layer->objects_end(); ++iter)
+    insert(*iter);
+
+  layer->add_change_listener(this);
+}
+
+RenderBatchBuilder::~RenderBatchBuilder() {
+  layer->remove_change_listener(this);
+}
+
+unsigned int RenderBatchBuilder::get_chunk_index(BoundingBox const& bbox) const {
+  int cx = bbox.get_center_x() / (int)chunk_size;
+  int cy = bbox.get_center_y() / (int)chunk_size;
+  cx = std::max(0, std::min(cx, (int)chunks_x - 1));
+  cy = std::max(0, std::min(cy, (int)chunks_y - 1));
+  return cy * chunks_x + cx;
+}
+
+void RenderBatchBuilder::insert(PlacedLogicModelObject_shptr o) {
+  BoundingBox const& bbox = o->get_bounding_box();
+  unsigned int idx = get_chunk_index(bbox);
+  RenderChunk & chunk = chunks[idx];
+
+  chunk.objects[o->get_object_id()] = o;
+  chunk.invalidate();
+
+  // Until the chunk is rebuilt, use the bounding box plus a margin for
+  // outlines and highlighted vias as a conservative estimate.
+  int margin = std::max(bbox.get_width(), bbox.get_height()) * 2 + 4;
+  chunk.extend(BoundingBox(bbox.get_min_x() - margin, bbox.get_max_x() + margin,
+			   bbox.get_min_y() - margin, bbox.get_max_y() + margin));
+
+  object_chunks[o->get_object_id()] = idx;
+}
+
+void RenderBatchBuilder::remove(PlacedLogicModelObject_shptr o) {
+  DenseObjectMap<unsigned int>::iterator found = object_chunks.find(o->get_object_id());
+  if(found != object_chunks.end()) {
+    RenderChunk & chunk = chunks[found->second];
+    chunk.objects.erase(o->get_object_id());
+    chunk.invalidate();
+    object_chunks.erase(found);
+  }
+}
+
+void RenderBatchBuilder::notify_object_added(PlacedLogicModelObject_shptr o) {
+  insert(o);
+}
+
+void RenderBatchBuilder::notify_object_removed(PlacedLogicModelObject_shptr o) {
+  remove(o);
+}
+
+void RenderBatchBuilder::notify_object_changed(PlacedLogicModelObject_shptr o) {
+  // The object might have moved into another chunk.
+  remove(o);
+  insert(o);
+}
+
+void RenderBatchBuilder::set_default_colors(default_colors_t const& default_colors) {
+  this->default_colors = default_colors;
+  invalidate_all();
+}
+
+void RenderBatchBuilder::invalidate_all() {
+  for(std::vector<RenderChunk>::iterator iter = chunks.begin(); iter != chunks.end(); ++iter)
+    if(!iter->objects.empty() || iter->has_extent) iter->invalidate();
+}
+
+void RenderBatchBuilder::set_highlight_overlay(HighlightOverlay_shptr overlay) {
+  this->overlay = overlay;
+  if(overlay != NULL) highlight_epoch = overlay->get_epoch();
+  invalidate_all();
+}
+
+unsigned int RenderBatchBuilder::get_num_dirty_chunks() const {
+  unsigned int n = 0;
+  for(std::vector<RenderChunk>::const_iterator iter = chunks.begin(); iter != chunks.end(); ++iter)
+    if(iter->dirty) n++;
+  return n;
+}
+
+color_t RenderBatchBuilder::get_default_color(ENTITY_COLOR c) const {
+  default_colors_t::const_iterator found = default_colors.find(c);
+  return found == default_colors.end() ? 0 : found->second;
+}
+
+PlacedLogicModelObject::HIGHLIGHTING_STATE
+RenderBatchBuilder::get_highlight_state(PlacedLogicModelObject_shptr o) const {
+  if(overlay != NULL) {
+    PlacedLogicModelObject::HIGHLIGHTING_STATE state = overlay->get_state(o);
+    if(state != PlacedLogicModelObject::HLIGHTSTATE_NOT) return state;
+  }
+  return o->get_highlighted();
+}
+
+void RenderBatchBuilder::update_highlighting() {
+
+  if(overlay == NULL || highlight_epoch == overlay->get_epoch()) return;
+
+  std::vector<object_id_t> oids, net_ids;
+  bool cleared = false;
+
+  if(!overlay->get_changes(highlight_epoch, oids, net_ids, cleared)) {
+    invalidate_all();
+    highlight_epoch = overlay->get_epoch();
+    return;
+  }
+
+  highlight_epoch = overlay->get_epoch();
+
+  BOOST_FOREACH(object_id_t oid, oids) {
+    DenseObjectMap<unsigned int>::const_iterator found = object_chunks.find(oid);
+    if(found != object_chunks.end()) chunks[found->second].invalidate();
+  }
+
+  if(!cleared && net_ids.empty()) return;
+
+  std::sort(net_ids.begin(), net_ids.end());
+  net_ids.erase(std::unique(net_ids.begin(), net_ids.end()), net_ids.end());
+
+  for(std::vector<RenderChunk>::iterator iter = chunks.begin(); iter != chunks.end(); ++iter) {
+    RenderChunk & chunk = *iter;
+    if(cleared && chunk.has_highlights) chunk.invalidate();
+    else if(!chunk.nets.empty() && !net_ids.empty()) {
+      std::vector<object_id_t> const& smaller = chunk.nets.size() < net_ids.size() ? chunk.nets : net_ids;
+      std::vector<object_id_t> const& larger = chunk.nets.size() < net_ids.size() ? net_ids : chunk.nets;
+      BOOST_FOREACH(object_id_t net_id, smaller) {
+	if(std::binary_search(larger.begin(), larger.end(), net_id)) {
+	  chunk.invalidate();
+	  break;
+	}
+      }
+    }
+  }
+}
+
+void RenderBatchBuilder::update_nets(RenderChunk & chunk) {
+
+  chunk.nets.clear();
+
+  for(DenseObjectMap<PlacedLogicModelObject_shptr>::iterator iter = chunk.objects.begin();
+      iter != chunk.objects.end(); ++iter) {
+    if(ConnectedLogicModelObject * clo = dynamic_cast<ConnectedLogicModelObject *>(iter->second.get())) {
+      Net_shptr net = clo->get_net();
+      if(net != NULL) chunk.nets.push_back(net->get_object_id());
+    }
+  }
+
+  std::sort(chunk.nets.begin(), chunk.nets.end());
+  chunk.nets.erase(std::unique(chunk.nets.begin(), chunk.nets.end()), chunk.nets.end());
+}
+
+void RenderBatchBuilder::get_chunks(BoundingBox const& region, chunk_list & visible_chunks,
+				    unsigned int lod_cell_size) {
+
+  visible_chunks.clear();
+  update_highlighting();
+
+  for(std::vector<RenderChunk>::iterator iter = chunks.begin(); iter != chunks.end(); ++iter) {
+    RenderChunk & chunk = *iter;
+    if(chunk.has_extent && chunk.extent.intersects(region)) {
+
+      if(lod_cell_size == 0) {
+	if(chunk.dirty) rebuild(chunk);
+      }
+      else if(!chunk.has_lod(lod_cell_size)) rebuild_lod(chunk, lod_cell_size);
+
+      if(!chunk.objects.empty()) visible_chunks.push_back(&chunk);
+    }
+  }
+}
+
+unsigned int RenderBatchBuilder::get_lod_cell_size(double scaling, double threshold) const {
+  if(scaling <= threshold) return 0;
+
+  unsigned int cell_size = 1;
+  while(cell_size < 2 * scaling && cell_size < chunk_size) cell_size <<= 1;
+  return std::min(cell_size, chunk_size);
+}
+
+void RenderBatchBuilder::rebuild(RenderChunk & chunk) {
+
+  for(unsigned int i = 0; i < num_groups; i++) chunk.groups[i].clear();
+
+  chunk.has_highlights = false;
+  update_nets(chunk);
+
+  for(DenseObjectMap<PlacedLogicModelObject_shptr>::iterator iter = chunk.objects.begin();
+      iter != chunk.objects.end(); ++iter) {
+    PlacedLogicModelObject::HIGHLIGHTING_STATE hl_state = get_highlight_state(iter->second);
+    if(hl_state != PlacedLogicModelObject::HLIGHTSTATE_NOT) chunk.has_highlights = true;
+    add_object_primitives(chunk.groups, iter->second, hl_state);
+  }
+
+  // recalculate the extent from the vertices
+  chunk.has_extent = false;
+  float min_x = 0, max_x = 0, min_y = 0, max_y = 0;
+  bool first = true;
+
+  for(unsigned int i = 0; i < num_groups; i++) {
+    PrimitiveSet const& p = chunk.groups[i];
+    std::vector<vertex_array const *> arrays;
+    arrays.push_back(&p.triangles);
+    arrays.push_back(&p.lines);
+    for(std::map<diameter_t, vertex_array>::const_iterator iter = p.wide_lines.begin();
+	iter != p.wide_lines.end(); ++iter) arrays.push_back(&iter->second);
+
+    for(std::vector<vertex_array const *>::const_iterator a = arrays.begin(); a != arrays.end(); ++a) {
+      for(vertex_array::const_iterator v = (*a)->begin(); v != (*a)->end(); ++v) {
+	if(first) {
+	  min_x = max_x = v->x;
+	  min_y = max_y = v->y;
+	  first = false;
+	}
+	else {
+	  min_x = std::min(min_x, v->x);
+	  max_x = std::max(max_x, v->x);
+	  min_y = std::min(min_y, v->y);
+	  max_y = std::max(max_y, v->y);
+	}
+      }
+    }
+  }
+
+  // Wires have a width. Add the largest wire diameter as margin.
+  int margin = 1;
+  std::map<diameter_t, vertex_array> const& wires = chunk.groups[GROUP_CONNECTIONS].wide_lines;
+  if(!wires.empty()) margin += wires.rbegin()->first;
+
+  if(!first)
+    chunk.extend(BoundingBox((int)floor(min_x) - margin, (int)ceil(max_x) + margin,
+			     (int)floor(min_y) - margin, (int)ceil(max_y) + margin));
+
+  chunk.dirty = false;
+  chunk.rebuild_count++;
+}
+
+void RenderBatchBuilder::rebuild_lod(RenderChunk & chunk, unsigned int lod_cell_size) {
+
+  LODPrimitives & lod = chunk.lod[lod_cell_size];
+  std::vector<GateAggregate> gates;
+  std::vector<PlacedLogicModelObject_shptr> connections;
+  BoundingBox connection_bounds;
+
+  chunk.has_highlights = false;
+  update_nets(chunk);
+
+  // Highlighted objects and annotations are rendered in full detail, the
+  // others are collected for aggregation.
+  for(DenseObjectMap<PlacedLogicModelObject_shptr>::iterator iter = chunk.objects.begin();
+      iter != chunk.objects.end(); ++iter) {
+
+    PlacedLogicModelObject_shptr o = iter->second;
+    PlacedLogicModelObject::HIGHLIGHTING_STATE hl_state = get_highlight_state(o);
+
+    if(hl_state != PlacedLogicModelObject::HLIGHTSTATE_NOT) {
+      chunk.has_highlights = true;
+      add_object_primitives(lod.groups, o, hl_state);
+    }
+    else if(Gate_shptr gate = std::tr1::dynamic_pointer_cast<Gate>(o)) {
+      color_t fill_col = gate->has_template() ? gate->get_gate_template()->get_fill_color() : 0;
+      color_t frame_col = gate->has_template() ? gate->get_gate_template()->get_frame_color() : 0;
+
+      if(fill_col == 0) fill_col = get_default_color(DEFAULT_COLOR_GATE);
+      if(frame_col == 0) frame_col = fill_col;
+
+      GateAggregate g;
+      g.row = gate->get_bounding_box().get_center_y() / (int)lod_cell_size;
+      g.min_x = gate->get_min_x();
+      g.max_x = gate->get_max_x();
+      g.min_y = gate->get_min_y();
+      g.max_y = gate->get_max_y();
+      g.fill.add(fill_col, gate->get_width() * gate->get_height());
+      g.frame.add(frame_col, gate->get_width() * gate->get_height());
+      gates.push_back(g);
+    }
+    else if(std::tr1::dynamic_pointer_cast<GatePort>(o) != NULL) {
+      // Ports are smaller than a cell. They are not visible at this scaling.
+    }
+    else if(std::tr1::dynamic_pointer_cast<Annotation>(o) != NULL)
+      add_object_primitives(lod.groups, o, hl_state);
+    else {
+      BoundingBox const& bbox = o->get_bounding_box();
+      if(connections.empty()) connection_bounds = bbox;
+      else
+	connection_bounds.set(std::min(connection_bounds.get_min_x(), bbox.get_min_x()),
+			      std::max(connection_bounds.get_max_x(), bbox.get_max_x()),
+			      std::min(connection_bounds.get_min_y(), bbox.get_min_y()),
+			      std::max(connection_bounds.get_max_y(), bbox.get_max_y()));
+      connections.push_back(o);
+    }
+  }
+
+  // Merge gates, that are in the same row and that are separated by less than a cell.
+  std::sort(gates.begin(), gates.end());
+  PrimitiveSet & p = lod.groups[GROUP_GATES];
+
+  for(std::vector<GateAggregate>::const_iterator iter = gates.begin(); iter != gates.end(); ) {
+    GateAggregate g = *iter;
+    for(++iter; iter != gates.end() && iter->row == g.row &&
+	  iter->min_x <= g.max_x + (int)lod_cell_size; ++iter) {
+      g.max_x = std::max(g.max_x, iter->max_x);
+      g.min_y = std::min(g.min_y, iter->min_y);
+      g.max_y = std::max(g.max_y, iter->max_y);
+      g.fill.add(iter->fill);
+      g.frame.add(iter->frame);
+    }
+
+    add_quad(p.triangles, g.min_x, g.min_y, g.max_x, g.max_y, g.fill.get_color());
+    add_frame(p.lines, g.min_x, g.min_y, g.max_x, g.max_y, g.frame.get_color());
+    chunk.extend(BoundingBox(g.min_x, g.max_x, g.min_y, g.max_y));
+  }
+
+  // Accumulate wires, vias and emarkers into a density raster.
+  if(!connections.empty()) {
+    DensityRaster raster(connection_bounds, lod_cell_size);
+
+    BOOST_FOREACH(PlacedLogicModelObject_shptr o, connections) {
+      if(Via_shptr via = std::tr1::dynamic_pointer_cast<Via>(o))
+	raster.add(via->get_x(), via->get_y(), pow(via->get_diameter(), 2),
+		   via->get_direction() == Via::DIRECTION_UP ?
+		   get_default_color(DEFAULT_COLOR_VIA_UP) : get_default_color(DEFAULT_COLOR_VIA_DOWN));
+      else if(EMarker_shptr emarker = std::tr1::dynamic_pointer_cast<EMarker>(o))
+	raster.add(emarker->get_x(), emarker->get_y(), pow(emarker->get_diameter(), 2),
+		   get_default_color(DEFAULT_COLOR_EMARKER));
+      else if(Wire_shptr wire = std::tr1::dynamic_pointer_cast<Wire>(o))
+	raster.add_line(wire->get_from_x(), wire->get_from_y(), wire->get_to_x(), wire->get_to_y(),
+			wire->get_diameter(),
+			wire->has_frame_color() ? wire->get_frame_color() : get_default_color(DEFAULT_COLOR_WIRE));
+    }
+
+    raster.emit(lod.groups[GROUP_CONNECTIONS].triangles);
+
+    // Cells are aligned to the cell grid and might exceed the objects.
+    int min_x = connection_bounds.get_min_x() / (int)lod_cell_size * (int)lod_cell_size;
+    int min_y = connection_bounds.get_min_y() / (int)lod_cell_size * (int)lod_cell_size;
+    chunk.extend(BoundingBox(min_x, connection_bounds.get_max_x() + lod_cell_size,
+			     min_y, connection_bounds.get_max_y() + lod_cell_size));
+  }
+}
+
+void RenderBatchBuilder::add_object_primitives(PrimitiveSet * groups, PlacedLogicModelObject_shptr o,
+					       PlacedLogicModelObject::HIGHLIGHTING_STATE hl_state) {
+
+  bool highlighted = hl_state != PlacedLogicModelObject::HLIGHTSTATE_NOT;
+
+  if(Gate_shptr gate = std::tr1::dynamic_pointer_cast<Gate>(o)) {
+    PrimitiveSet & p = groups[GROUP_GATES];
+
+    color_t fill_col = gate->has_template() ? gate->get_gate_template()->get_fill_color() : 0;
+    color_t frame_col = gate->has_template() ? gate->get_gate_template()->get_frame_color() : 0;
+
+    if(fill_col == 0) fill_col = get_default_color(DEFAULT_COLOR_GATE);
+    if(frame_col == 0) frame_col = fill_col;
+
+    add_quad(p.triangles, gate->get_min_x(), gate->get_min_y(), gate->get_max_x(), gate->get_max_y(),
+	     highlight_color_by_state(fill_col, hl_state));
+    add_frame(p.lines, gate->get_min_x(), gate->get_min_y(), gate->get_max_x(), gate->get_max_y(),
+	      highlight_color_by_state(frame_col, hl_state));
+  }
+  else if(GatePort_shptr port = std::tr1::dynamic_pointer_cast<GatePort>(o)) {
+
+    Gate_shptr gate = port->get_gate();
+    GateTemplatePort_shptr tmpl_port = port->get_template_port();
+
+    if(gate != NULL && gate->has_template() && gate->has_orientation() &&
+       tmpl_port != NULL && tmpl_port->get_x() != 0 && tmpl_port->get_y() != 0) {
+
+      unsigned int port_size = port->get_diameter();
+      color_t port_color = tmpl_port->get_fill_color() == 0 ?
+	get_default_color(DEFAULT_COLOR_GATE_PORT) : tmpl_port->get_fill_color();
+
+      if(highlighted) {
+	port_color = highlight_color_by_state(port_color, hl_state);
+	port_size *= 2;
+      }
+
+      GateTemplatePort::PORT_TYPE t = tmpl_port->get_port_type();
+      add_square(groups[GROUP_GATES], port->get_x(), port->get_y(), port_size, port_color,
+		 port->is_connected(),
+		 t == GateTemplatePort::PORT_TYPE_IN || t == GateTemplatePort::PORT_TYPE_INOUT,
+		 t == GateTemplatePort::PORT_TYPE_OUT || t == GateTemplatePort::PORT_TYPE_INOUT);
+    }
+  }
+  else if(Annotation_shptr a = std::tr1::dynamic_pointer_cast<Annotation>(o)) {
+    PrimitiveSet & p = groups[GROUP_ANNOTATIONS];
+
+    color_t fill_col = a->get_fill_color();
+    color_t frame_col = a->get_frame_color();
+
+    if(fill_col == 0) fill_col = get_default_color(DEFAULT_COLOR_ANNOTATION);
+    if(frame_col == 0) frame_col = fill_col;
+
+    add_quad(p.triangles, a->get_min_x(), a->get_min_y(), a->get_max_x(), a->get_max_y(),
+	     highlight_color_by_state(fill_col, hl_state));
+    add_frame(p.lines, a->get_min_x(), a->get_min_y(), a->get_max_x(), a->get_max_y(),
+	      highlight_color_by_state(frame_col, hl_state));
+  }
+  else if(Via_shptr via = std::tr1::dynamic_pointer_cast<Via>(o)) {
+    unsigned int diameter = via->get_diameter();
+    color_t col = via->get_direction() == Via::DIRECTION_UP ?
+      get_default_color(DEFAULT_COLOR_VIA_UP) : get_default_color(DEFAULT_COLOR_VIA_DOWN);
+
+    if(highlighted) {
+      col = highlight_color_by_state(col, hl_state);
+      diameter <<= 2;
+    }
+
+    add_square(groups[GROUP_CONNECTIONS], via->get_x(), via->get_y(), diameter, col,
+	       via->is_connected());
+  }
+  else if(EMarker_shptr emarker = std::tr1::dynamic_pointer_cast<EMarker>(o)) {
+    unsigned int diameter = emarker->get_diameter();
+    color_t col = get_default_color(DEFAULT_COLOR_EMARKER);
+
+    if(highlighted) {
+      col = highlight_color_by_state(col, hl_state);
+      diameter <<= 2;
+    }
+
+    add_circle(groups[GROUP_CONNECTIONS].triangles, emarker->get_x(), emarker->get_y(),
+	       diameter, col);
+  }
+  else if(Wire_shptr wire = std::tr1::dynamic_pointer_cast<Wire>(o)) {
+    color_t col = wire->has_frame_color() ? wire->get_frame_color() : get_default_color(DEFAULT_COLOR_WIRE);
+
+    add_line(groups[GROUP_CONNECTIONS].wide_lines[wire->get_diameter()],
+	     wire->get_from_x(), wire->get_from_y(), wire->get_to_x(), wire->get_to_y(),
+	     highlight_color_by_state(col, hl_state));
+  }
+}
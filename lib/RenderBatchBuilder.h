@@ -0,0 +1,315 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __RENDERBATCHBUILDER_H__
+#define __RENDERBATCHBUILDER_H__
+
+#include <globals.h>
+#include <Layer.h>
+#include <BoundingBox.h>
+#include <DenseObjectMap.h>
+#include <HighlightOverlay.h>
+
+#include <vector>
+#include <map>
+#include <tr1/memory>
+
+namespace degate {
+
+  /**
+   * The RenderBatchBuilder prepares vertex arrays for the logic model objects
+   * of a layer, so that a renderer does not need to walk the layer on every
+   * update.
+   *
+   * The layer is partitioned into square chunks. Each object belongs to
+   * exactly one chunk, the chunk that contains the center of its bounding box.
+   * For each chunk the builder keeps vertex arrays, that are only rebuilt,
+   * if an object in that chunk was added, removed or changed. The builder
+   * registers itself as a LayerChangeListener to learn about changes.
+   *
+   * The builder does not depend on OpenGL. A renderer asks for the chunks
+   * that intersect the viewport and submits their vertex arrays.
+   *
+   * Changes that are not reported by the layer (e.g. a new gate template color)
+   * require a call to invalidate_all().
+   *
+   * The highlighting state is taken from a HighlightOverlay, if one is set.
+   * When the overlay changes, the builder asks it for the changed objects and
+   * nets and invalidates only the chunks, that contain them. Each chunk
+   * keeps the IDs of the nets of its objects for that purpose.
+   *
+   * For zoomed out views the builder prepares aggregated primitives
+   * (level of detail). Objects are binned into square cells. Wires, vias
+   * and emarkers are accumulated into a density raster, that is emitted as
+   * rectangles, where neighbouring cells of a row with the same color are
+   * merged. Gates are merged into one rectangle per row of cells, as long as
+   * the gap between them is smaller than a cell. Gate ports are omitted.
+   * Highlighted objects and annotations are not aggregated. The number of
+   * primitives per chunk is therefore bounded by the number of cells and
+   * not by the number of objects. Aggregates are cached per cell size
+   * and are dropped together with the vertex arrays of a chunk.
+   */
+
+  class RenderBatchBuilder : public LayerChangeListener {
+
+  public:
+
+    /**
+     * Objects are grouped, because a renderer may render groups differently.
+     */
+    enum RENDER_GROUP {
+      GROUP_GATES = 0,       /**< gates and gate ports */
+      GROUP_ANNOTATIONS = 1, /**< annotations */
+      GROUP_CONNECTIONS = 2  /**< wires, vias and emarkers */
+    };
+
+    const static unsigned int num_groups = 3;
+
+    /**
+     * A vertex with a color. The color is stored as color_t, which has
+     * the memory layout R, G, B, A.
+     */
+    struct Vertex {
+      float x, y;
+      color_t color;
+    };
+
+    typedef std::vector<Vertex> vertex_array;
+
+    /**
+     * Vertex arrays for one render group.
+     */
+    struct PrimitiveSet {
+
+      /** Filled shapes, to be rendered as GL_TRIANGLES. */
+      vertex_array triangles;
+
+      /** Outlines with a line width of 1, to be rendered as GL_LINES. */
+      vertex_array lines;
+
+      /**
+       * Wires, to be rendered as GL_LINES. They are grouped by their diameter,
+       * because the line width depends on the diameter and the current scaling.
+       */
+      std::map<diameter_t, vertex_array> wide_lines;
+
+      void clear();
+      bool empty() const;
+      unsigned int get_num_vertices() const;
+    };
+
+    /**
+     * Aggregated vertex arrays for all render groups of a chunk.
+     */
+    struct LODPrimitives {
+      PrimitiveSet groups[num_groups];
+    };
+
+    /**
+     * A spatial chunk of a layer.
+     */
+    class RenderChunk {
+
+      friend class RenderBatchBuilder;
+
+    private:
+
+      BoundingBox extent;
+      bool has_extent;
+      bool dirty;
+      unsigned int rebuild_count;
+
+      // Whether the chunk contained highlighted objects at the last rebuild.
+      bool has_highlights;
+
+      // The sorted IDs of the nets of the objects at the last rebuild.
+      std::vector<object_id_t> nets;
+
+      DenseObjectMap<PlacedLogicModelObject_shptr> objects;
+      PrimitiveSet groups[num_groups];
+
+      // LOD cell size -> aggregated primitives
+      std::map<unsigned int, LODPrimitives> lod;
+
+      void extend(BoundingBox const& bbox);
+
+      /**
+       * Mark the chunk as dirty and drop the aggregated primitives.
+       */
+      void invalidate();
+
+    public:
+
+      RenderChunk() : has_extent(false), dirty(false), rebuild_count(0),
+	has_highlights(false) {}
+
+      /**
+       * Get the area covered by the rendered primitives of this chunk.
+       */
+      BoundingBox const& get_extent() const { return extent; }
+
+      /**
+       * Get the vertex arrays for a render group.
+       * @param group The render group.
+       * @param lod_cell_size The cell size, that was passed to get_chunks().
+       *   Use 0 for the vertex arrays in full detail.
+       */
+      PrimitiveSet const& get_primitives(RENDER_GROUP group, unsigned int lod_cell_size = 0) const;
+
+      /**
+       * Check if aggregated primitives for a cell size are prepared.
+       */
+      bool has_lod(unsigned int lod_cell_size) const { return lod.find(lod_cell_size) != lod.end(); }
+
+      /**
+       * Get the number of objects in this chunk.
+       */
+      unsigned int get_num_objects() const { return objects.size(); }
+
+      /**
+       * Check if the chunk must be rebuilt.
+       */
+      bool is_dirty() const { return dirty; }
+
+      /**
+       * Get the number of rebuilds. This is mainly useful for testing.
+       */
+      unsigned int get_rebuild_count() const { return rebuild_count; }
+    };
+
+    typedef std::vector<RenderChunk const *> chunk_list;
+
+  private:
+
+    Layer_shptr layer;
+    unsigned int chunk_size;
+    unsigned int chunks_x, chunks_y;
+
+    std::vector<RenderChunk> chunks;
+
+    // object ID -> chunk index
+    DenseObjectMap<unsigned int> object_chunks;
+
+    default_colors_t default_colors;
+
+    HighlightOverlay_shptr overlay;
+
+    // The overlay epoch, that the chunks were checked against.
+    unsigned int highlight_epoch;
+
+    unsigned int get_chunk_index(BoundingBox const& bbox) const;
+
+    void insert(PlacedLogicModelObject_shptr o);
+    void remove(PlacedLogicModelObject_shptr o);
+    void rebuild(RenderChunk & chunk);
+    void rebuild_lod(RenderChunk & chunk, unsigned int lod_cell_size);
+
+    color_t get_default_color(ENTITY_COLOR c) const;
+
+    PlacedLogicModelObject::HIGHLIGHTING_STATE
+    get_highlight_state(PlacedLogicModelObject_shptr o) const;
+
+    void update_highlighting();
+    void update_nets(RenderChunk & chunk);
+
+    void add_object_primitives(PrimitiveSet * groups, PlacedLogicModelObject_shptr o,
+			       PlacedLogicModelObject::HIGHLIGHTING_STATE hl_state);
+
+  public:
+
+    /**
+     * Create a builder for a layer and register it as change listener.
+     * @param layer The layer.
+     * @param chunk_size The edge length of a chunk in pixel.
+     */
+    RenderBatchBuilder(Layer_shptr layer, unsigned int chunk_size = 1024);
+
+    /**
+     * Deregister the builder from the layer.
+     */
+    virtual ~RenderBatchBuilder();
+
+    /**
+     * Set the default colors. This invalidates all chunks.
+     */
+    void set_default_colors(default_colors_t const& default_colors);
+
+    /**
+     * Set the overlay, that defines the highlighting state of objects.
+     * Without an overlay, the highlighting state of the objects is used.
+     */
+    void set_highlight_overlay(HighlightOverlay_shptr overlay);
+
+    /**
+     * Mark all chunks as dirty.
+     */
+    void invalidate_all();
+
+    /**
+     * Get chunks that intersect a region. Dirty chunks in that region are
+     * rebuilt. Dirty chunks outside of the region are not touched.
+     * @param region Usually the viewport.
+     * @param visible_chunks The chunk list is cleared and then filled with
+     *   non-empty chunks, that intersect the region.
+     * @param lod_cell_size If not 0, aggregated primitives for this cell size
+     *   are prepared instead of the vertex arrays in full detail. Use
+     *   get_lod_cell_size() to calculate it.
+     */
+    void get_chunks(BoundingBox const& region, chunk_list & visible_chunks,
+		    unsigned int lod_cell_size = 0);
+
+    /**
+     * Calculate the LOD cell size for a scaling. A cell covers about
+     * two screen pixel. The cell size is a power of two and at most
+     * the chunk size.
+     * @param scaling The number of layer pixel per screen pixel.
+     * @param threshold Objects are rendered in full detail up to this scaling.
+     * @return Returns the cell size or 0, if the scaling is below
+     *   the threshold.
+     */
+    unsigned int get_lod_cell_size(double scaling, double threshold) const;
+
+    /**
+     * Get the number of chunks.
+     */
+    unsigned int get_num_chunks() const { return chunks.size(); }
+
+    /**
+     * Get the number of dirty chunks.
+     */
+    unsigned int get_num_dirty_chunks() const;
+
+    /**
+     * Get the layer.
+     */
+    Layer_shptr get_layer() { return layer; }
+
+    virtual void notify_object_added(PlacedLogicModelObject_shptr o);
+    virtual void notify_object_removed(PlacedLogicModelObject_shptr o);
+    virtual void notify_object_changed(PlacedLogicModelObject_shptr o);
+
+  };
+
+  typedef std::tr1::shared_ptr<RenderBatchBuilder> RenderBatchBuilder_shptr;
+
+}
+
+#endif
@@ -0,0 +1,380 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <RuleChecker.h>
+#include <GateLibrary.h>
+
+#include <algorithm>
+#include <boost/foreach.hpp>
+#include <boost/thread.hpp>
+
+using namespace degate;
+
+namespace {
+
+  typedef NetlistGraph::index_t index_t;
+
+  /**
+   * A part of the work for one check: a range of nets or gates, or the
+   * complete run of a check with a model scope.
+   */
+  struct RCTask {
+    RCBase * check;
+    unsigned int check_pos;
+    index_t const * begin, * end;
+
+    // violations of the partition and for each net or gate with violations
+    // its object ID and the end position in the violation list
+    RCVContainer violations;
+    std::vector<std::pair<object_id_t, size_t> > unit_ends;
+  };
+
+  void run_task(RCTask & task, NetlistGraph const& graph, LogicModel_shptr lmodel) {
+
+    if(task.check->get_scope() == RC_SCOPE_MODEL) {
+      task.check->run(lmodel);
+      return;
+    }
+
+    bool nets = task.check->get_scope() == RC_SCOPE_NET;
+
+    for(index_t const * i = task.begin; i != task.end; ++i) {
+      size_t before = task.violations.size();
+      task.check->check(graph, *i, task.violations);
+      if(task.violations.size() != before)
+	task.unit_ends.push_back(std::make_pair(nets ?
+						graph.get_net(*i)->get_object_id() :
+						graph.get_gate(*i)->get_object_id(),
+						task.violations.size()));
+    }
+  }
+
+  /**
+   * Runs a part of the tasks in a worker thread. Worker i handles
+   * the tasks i, i + step, i + 2 * step, ...
+   */
+  struct RCWorker {
+    std::vector<RCTask> * tasks;
+    NetlistGraph const * graph;
+    LogicModel_shptr lmodel;
+    unsigned int first, step;
+
+    void operator()() {
+      for(size_t t = first; t < tasks->size(); t += step)
+	run_task((*tasks)[t], *graph, lmodel);
+    }
+  };
+
+  void sort_unique(std::vector<object_id_t> & v) {
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+  }
+}
+
+
+RuleChecker::RuleChecker(unsigned int _num_threads) :
+  RCBase("rc-all", "A collection of all RCs."),
+  num_threads(_num_threads),
+  complete_run_required(true),
+  num_checked(0) {
+
+  add_check(RCBase_shptr(new ERCOpenPorts()));
+  add_check(RCBase_shptr(new ERCNet()));
+}
+
+RuleChecker::~RuleChecker() {
+  BOOST_FOREACH(Layer_shptr layer, registered_layers) layer->remove_change_listener(this);
+}
+
+void RuleChecker::add_check(RCBase_shptr check) {
+  if(check == NULL)
+    throw InvalidPointerException("Invalid check passed to add_check().");
+
+  CheckState state;
+  state.check = check;
+  checks.push_back(state);
+  complete_run_required = true;
+}
+
+bool RuleChecker::sync_layers() {
+
+  std::vector<Layer_shptr> current;
+  for(LogicModel::layer_collection::iterator iter = lmodel->layers_begin();
+      iter != lmodel->layers_end(); ++iter)
+    if(*iter != NULL) current.push_back(*iter);
+
+  if(current == registered_layers) return false;
+
+  BOOST_FOREACH(Layer_shptr layer, registered_layers)
+    if(std::find(current.begin(), current.end(), layer) == current.end())
+      layer->remove_change_listener(this);
+
+  BOOST_FOREACH(Layer_shptr layer, current)
+    if(std::find(registered_layers.begin(), registered_layers.end(), layer) == registered_layers.end())
+      layer->add_change_listener(this);
+
+  registered_layers = current;
+  return true;
+}
+
+bool RuleChecker::sync_template_ports() {
+
+  // Port directions are not reported by the layers, but they matter for the checks.
+  std::vector<std::pair<object_id_t, int> > current;
+
+  GateLibrary_shptr glib = lmodel->get_gate_library();
+  if(glib != NULL) {
+    for(GateLibrary::template_iterator iter = glib->begin(); iter != glib->end(); ++iter)
+      for(GateTemplate::port_iterator p_iter = iter->second->ports_begin();
+	  p_iter != iter->second->ports_end(); ++p_iter)
+	current.push_back(std::make_pair((*p_iter)->get_object_id(), (int)(*p_iter)->get_port_type()));
+  }
+
+  std::sort(current.begin(), current.end());
+  if(current == template_ports) return false;
+
+  template_ports.swap(current);
+  return true;
+}
+
+void RuleChecker::record_nets() {
+
+  object_nets.clear();
+  object_nets.reserve(lmodel->objects_end() - lmodel->objects_begin());
+
+  for(LogicModel::object_collection::iterator iter = lmodel->objects_begin();
+      iter != lmodel->objects_end(); ++iter) {
+
+    if(ConnectedLogicModelObject_shptr co =
+       std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(iter->second)) {
+      object_nets[iter->first] = co->get_net();
+    }
+  }
+}
+
+void RuleChecker::touch(PlacedLogicModelObject_shptr o) {
+
+  if(std::tr1::dynamic_pointer_cast<Gate>(o) != NULL) {
+    touched_gates.push_back(o->get_object_id());
+  }
+  else if(ConnectedLogicModelObject_shptr co =
+	  std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(o)) {
+
+    Net_shptr current = co->get_net();
+    Net_shptr & recorded = object_nets[o->get_object_id()];
+
+    // The net the object was removed from must be checked, too.
+    if(recorded != NULL) touched_nets.push_back(recorded);
+    if(current != NULL && current != recorded) touched_nets.push_back(current);
+    recorded = current;
+
+    if(GatePort_shptr port = std::tr1::dynamic_pointer_cast<GatePort>(o)) {
+      Gate_shptr gate = port->get_gate();
+      if(gate != NULL) touched_gates.push_back(gate->get_object_id());
+    }
+  }
+}
+
+void RuleChecker::notify_object_added(PlacedLogicModelObject_shptr o) {
+  touch(o);
+}
+
+void RuleChecker::notify_object_removed(PlacedLogicModelObject_shptr o) {
+  touch(o);
+  object_nets.erase(o->get_object_id());
+}
+
+void RuleChecker::notify_object_changed(PlacedLogicModelObject_shptr o) {
+
+  // Only a changed net matters for connected objects, not the shape.
+  if(ConnectedLogicModelObject_shptr co =
+     std::tr1::dynamic_pointer_cast<ConnectedLogicModelObject>(o)) {
+
+    DenseObjectMap<Net_shptr>::const_iterator found = object_nets.find(o->get_object_id());
+    if(found != object_nets.end() && found->second == co->get_net()) return;
+  }
+
+  touch(o);
+}
+
+void RuleChecker::check_units(NetlistGraph const& graph,
+			      std::vector<std::vector<index_t> > const& units) {
+
+  unsigned int threads_to_use = num_threads;
+  if(threads_to_use == 0) threads_to_use = std::max(boost::thread::hardware_concurrency(), 1U);
+
+  std::vector<RCTask> tasks;
+
+  for(unsigned int c = 0; c < checks.size(); c++) {
+
+    RCTask task;
+    task.check = checks[c].check.get();
+    task.check_pos = c;
+    task.begin = task.end = NULL;
+
+    RC_SCOPE scope = task.check->get_scope();
+    if(scope == RC_SCOPE_MODEL) {
+      tasks.push_back(task);
+      continue;
+    }
+
+    std::vector<index_t> const& u = units[scope];
+    size_t chunk = std::max<size_t>(256, u.size() / (4 * threads_to_use) + 1);
+
+    for(size_t i = 0; i < u.size(); i += chunk) {
+      task.begin = &u[0] + i;
+      task.end = &u[0] + std::min(i + chunk, u.size());
+      tasks.push_back(task);
+    }
+  }
+
+  threads_to_use = std::min<unsigned int>(threads_to_use, std::max<size_t>(tasks.size(), 1));
+
+  if(threads_to_use == 1) {
+    BOOST_FOREACH(RCTask & task, tasks) run_task(task, graph, lmodel);
+  }
+  else {
+    boost::thread_group threads;
+    for(unsigned int t = 0; t < threads_to_use; t++) {
+      RCWorker w;
+      w.tasks = &tasks;
+      w.graph = &graph;
+      w.lmodel = lmodel;
+      w.first = t;
+      w.step = threads_to_use;
+      threads.create_thread(w);
+    }
+    threads.join_all();
+  }
+
+  // merge the partitions
+  BOOST_FOREACH(RCTask & task, tasks) {
+    DenseObjectMap<std::vector<RCViolation_shptr> > & violations = checks[task.check_pos].violations;
+    size_t start = 0;
+    for(size_t i = 0; i < task.unit_ends.size(); i++) {
+      violations[task.unit_ends[i].first].assign(task.violations.begin() + start,
+						 task.violations.begin() + task.unit_ends[i].second);
+      start = task.unit_ends[i].second;
+    }
+  }
+}
+
+void RuleChecker::run(LogicModel_shptr lmodel) {
+
+  debug(TM, "run RC");
+
+  clear_rc_violations();
+  num_checked = 0;
+
+  if(lmodel == NULL) return;
+
+  bool same_model = lmodel == this->lmodel;
+  bool complete = complete_run_required || !same_model;
+  this->lmodel = lmodel;
+  if(sync_layers()) complete = true;
+
+  bool ports_changed = sync_template_ports();
+  if(ports_changed) complete = true;
+
+  // The graph must be up to date, before it is shared with the workers.
+  NetlistGraph_shptr graph = lmodel->get_netlist_graph();
+
+  // The graph caches the port directions, too.
+  if(ports_changed && same_model) {
+    graph->invalidate();
+    graph->update();
+  }
+
+  std::vector<std::vector<index_t> > units(3);
+  std::vector<index_t> & net_units = units[RC_SCOPE_NET];
+  std::vector<index_t> & gate_units = units[RC_SCOPE_GATE];
+
+  if(complete) {
+    record_nets();
+
+    BOOST_FOREACH(CheckState & state, checks) state.violations.clear();
+
+    net_units.resize(graph->get_num_nets());
+    for(index_t n = 0; n < graph->get_num_nets(); n++) net_units[n] = n;
+    gate_units.resize(graph->get_num_gates());
+    for(index_t g = 0; g < graph->get_num_gates(); g++) gate_units[g] = g;
+  }
+  else {
+    std::vector<object_id_t> net_ids;
+    BOOST_FOREACH(Net_shptr const& net, touched_nets)
+      if(net->has_valid_object_id()) net_ids.push_back(net->get_object_id());
+    sort_unique(net_ids);
+
+    // Gates on a touched net must be checked, too.
+    BOOST_FOREACH(object_id_t oid, net_ids) {
+      index_t n = graph->get_net_index(oid);
+      if(n == NetlistGraph::no_index) continue;
+      net_units.push_back(n);
+
+      NetlistGraph::index_range r = graph->get_net_ports(n);
+      for(index_t const * p = r.first; p != r.second; ++p)
+	touched_gates.push_back(graph->get_gate(graph->get_port_gate(*p))->get_object_id());
+    }
+
+    sort_unique(touched_gates);
+
+    BOOST_FOREACH(object_id_t oid, touched_gates) {
+      index_t g = graph->get_gate_index(oid);
+      if(g != NetlistGraph::no_index) gate_units.push_back(g);
+    }
+
+    std::sort(net_units.begin(), net_units.end());
+    std::sort(gate_units.begin(), gate_units.end());
+
+    // Drop old violations. This covers removed nets and gates, too.
+    BOOST_FOREACH(CheckState & state, checks) {
+      if(state.check->get_scope() == RC_SCOPE_NET) {
+	BOOST_FOREACH(object_id_t oid, net_ids) state.violations.erase(oid);
+      }
+      else if(state.check->get_scope() == RC_SCOPE_GATE) {
+	BOOST_FOREACH(object_id_t oid, touched_gates) state.violations.erase(oid);
+      }
+    }
+  }
+
+  touched_nets.clear();
+  touched_gates.clear();
+  complete_run_required = false;
+  num_checked = net_units.size() + gate_units.size();
+
+  check_units(*graph, units);
+
+  BOOST_FOREACH(CheckState & state, checks) {
+
+    if(state.check->get_scope() == RC_SCOPE_MODEL) {
+      BOOST_FOREACH(RCViolation_shptr violation, state.check->get_rc_violations())
+	add_rc_violation(violation);
+    }
+    else {
+      BOOST_FOREACH(object_id_t oid, state.violations.get_ordered_keys())
+	BOOST_FOREACH(RCViolation_shptr violation, state.violations.find(oid)->second)
+	  add_rc_violation(violation);
+    }
+  }
+
+  debug(TM, "found %d rc violations.", get_rc_violations().size());
+}
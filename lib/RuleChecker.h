@@ -25,38 +25,117 @@
 #include <RCBase.h>
 #include <ERCOpenPorts.h>
 #include <ERCNet.h>
+#include <Layer.h>
+#include <DenseObjectMap.h>
+
+#include <vector>
+#include <boost/utility.hpp>
 
 namespace degate {
 
-  class RuleChecker : public RCBase {
+  /**
+   * The RuleChecker runs all registered Rule Checks and collects their
+   * violations.
+   *
+   * Checks are executed concurrently. The nets or gates of a check with a
+   * net or gate scope are partitioned across the threads. Each partition
+   * collects its violations locally, the results are merged afterwards.
+   *
+   * The RuleChecker registers itself as change listener on the layers of the
+   * logic model. On the next run only nets and gates, that were touched since
+   * the last run, are checked again. Checks with a model scope are always run
+   * completely. A complete run is done, if the logic model, its layers or the
+   * port directions of the gate templates changed, or if invalidate() was
+   * called.
+   *
+   * The violations are ordered by check, then by the object ID of the checked
+   * net or gate. Therefore the result does not depend on the number of threads
+   * and an incremental run has the same result as a complete run.
+   */
+
+  class RuleChecker : public RCBase, public LayerChangeListener, boost::noncopyable {
 
   private:
 
-    std::list<RCBase_shptr> checks;
+    struct CheckState {
+      RCBase_shptr check;
 
-  public:
+      // object ID of a net or gate -> violations
+      DenseObjectMap<std::vector<RCViolation_shptr> > violations;
+    };
+
+    std::vector<CheckState> checks;
+    unsigned int num_threads;
 
-    RuleChecker() : RCBase("rc-all", "A collection of all RCs.") {
-      checks.push_back(RCBase_shptr(new ERCOpenPorts()));
-      checks.push_back(RCBase_shptr(new ERCNet()));
-    }
+    LogicModel_shptr lmodel;
+    std::vector<Layer_shptr> registered_layers;
+    bool complete_run_required;
+    unsigned int num_checked;
 
-    void run(LogicModel_shptr lmodel) {
+    // object ID -> net for connected objects, as seen by notifications. Nets
+    // are stored as pointers, because a new net gets its object ID after the
+    // objects were connected.
+    DenseObjectMap<Net_shptr> object_nets;
 
-      debug(TM, "run RC");
+    // port object ID and port direction of all gate template ports
+    std::vector<std::pair<object_id_t, int> > template_ports;
 
-      clear_rc_violations();
+    std::vector<Net_shptr> touched_nets;
+    std::vector<object_id_t> touched_gates;
 
-      BOOST_FOREACH(RCBase_shptr check, checks) {
-	std::cout << "RC: " << check->get_rc_class_name() << std::endl;
-	check->run(lmodel);
-	BOOST_FOREACH(RCViolation_shptr violation, check->get_rc_violations()) {
-	  add_rc_violation(violation);
-	}
-      }
+    bool sync_layers();
+    bool sync_template_ports();
+    void record_nets();
+    void touch(PlacedLogicModelObject_shptr o);
+
+    void check_units(NetlistGraph const& graph,
+		     std::vector<std::vector<NetlistGraph::index_t> > const& units);
+
+  public:
 
-      debug(TM, "found %d rc violations.", get_rc_violations().size());
-    }
+    /**
+     * Create a RuleChecker with the default checks.
+     * @param num_threads The number of threads. Use 0 for the number of
+     *   available processors.
+     */
+    RuleChecker(unsigned int num_threads = 0);
+
+    /**
+     * Deregister the RuleChecker from the layers.
+     */
+    virtual ~RuleChecker();
+
+    /**
+     * Register a Rule Check. The next run is a complete run.
+     */
+    void add_check(RCBase_shptr check);
+
+    /**
+     * Set the number of threads. Use 0 for the number of available processors.
+     */
+    void set_num_threads(unsigned int num_threads) { this->num_threads = num_threads; }
+
+    /**
+     * Force a complete run. Call this, if the logic model changed in a way
+     * the layers do not report.
+     */
+    void invalidate() { complete_run_required = true; }
+
+    /**
+     * Get the number of nets and gates, that were checked during the last
+     * run. This is mainly useful for testing.
+     */
+    unsigned int get_num_checked() const { return num_checked; }
+
+    /**
+     * Run all checks. If the RuleChecker was run on the same logic model
+     * before, only touched nets and gates are checked.
+     */
+    void run(LogicModel_shptr lmodel);
+
+    virtual void notify_object_added(PlacedLogicModelObject_shptr o);
+    virtual void notify_object_removed(PlacedLogicModelObject_shptr o);
+    virtual void notify_object_changed(PlacedLogicModelObject_shptr o);
   };
 
 }
@@ -24,6 +24,7 @@
 
 #include "globals.h"
 #include "MemoryMap.h"
+#include "ImageArena.h"
 #include "Configuration.h"
 #include "FileSystem.h"
 #include "Image.h"
@@ -124,6 +125,18 @@ namespace degate {
 		 filename) {
     }
 
+    /**
+     * Create a temporary storage with an explicit storage type, that is
+     * either MAP_STORAGE_TYPE_TEMP_FILE or MAP_STORAGE_TYPE_POOL.
+     */
+    StoragePolicy_File(unsigned int _width,
+		       unsigned int _height,
+		       MAP_STORAGE_TYPE mode) :
+      memory_map(_width, _height, mode,
+		 mode == MAP_STORAGE_TYPE_TEMP_FILE ?
+		 generate_temp_file_pattern(get_temp_directory()) : std::string()) {
+    }
+
     virtual ~StoragePolicy_File() {}
 
     inline typename PixelPolicy::pixel_type get_pixel(unsigned int x,
@@ -140,7 +153,11 @@ namespace degate {
 
 
   /**
-   * Storage policy for image objects that are stored in a temporary file.
+   * Storage policy for temporary image objects.
+   *
+   * Images up to the spill threshold of the ImageArena are stored in
+   * memory, that is recycled by the arena. Larger images are stored in
+   * a temporary file.
    */
   template<class PixelPolicy>
   class StoragePolicy_TempFile : public StoragePolicy_File<PixelPolicy> {
@@ -148,9 +165,16 @@ namespace degate {
   public:
     StoragePolicy_TempFile(unsigned int _width,
 			   unsigned int _height) :
-      StoragePolicy_File<PixelPolicy>(_width, _height,
-				      generate_temp_file_pattern(get_temp_directory()),
-				      false) {}
+      StoragePolicy_File<PixelPolicy>(_width, _height, get_storage_type(_width, _height)) {}
+
+    /**
+     * Get the storage type for a temporary image of a given size.
+     */
+    static MAP_STORAGE_TYPE get_storage_type(unsigned int width, unsigned int height) {
+      size_t bytes = (size_t)width * height * sizeof(typename PixelPolicy::pixel_type);
+      return ImageArena::get_instance().is_pooled_size(bytes) ?
+	MAP_STORAGE_TYPE_POOL : MAP_STORAGE_TYPE_TEMP_FILE;
+    }
 
     virtual ~StoragePolicy_TempFile() {}
   };
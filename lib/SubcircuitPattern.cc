@@ -0,0 +1,66 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <SubcircuitPattern.h>
+#include <degate_exceptions.h>
+
+#include <boost/format.hpp>
+#include <boost/foreach.hpp>
+
+using namespace degate;
+
+unsigned int SubcircuitPattern::add_gate(std::string const& logic_class) {
+  PatternGate g;
+  g.logic_class = logic_class;
+  gates.push_back(g);
+  return gates.size() - 1;
+}
+
+unsigned int SubcircuitPattern::add_net() {
+  net_sizes.push_back(0);
+  return net_sizes.size() - 1;
+}
+
+void SubcircuitPattern::connect(unsigned int net, unsigned int gate, std::string const& port_name) {
+
+  if(gate >= gates.size() || net >= net_sizes.size())
+    throw DegateLogicException("Invalid pattern gate or net in SubcircuitPattern::connect().");
+
+  BOOST_FOREACH(PatternPort const& p, gates[gate].ports)
+    if(p.name == port_name)
+      throw DegateLogicException(boost::str(boost::format("The port %1% of pattern gate %2% "
+							  "is already connected.") % port_name % gate));
+
+  PatternPort p;
+  p.name = port_name;
+  p.net = net;
+  gates[gate].ports.push_back(p);
+  net_sizes[net]++;
+}
+
+unsigned int SubcircuitPattern::connect(unsigned int gate_a, std::string const& port_name_a,
+					unsigned int gate_b, std::string const& port_name_b) {
+  unsigned int net = add_net();
+  connect(net, gate_a, port_name_a);
+  connect(net, gate_b, port_name_b);
+  return net;
+}
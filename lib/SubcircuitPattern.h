@@ -0,0 +1,118 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef __SUBCIRCUITPATTERN_H__
+#define __SUBCIRCUITPATTERN_H__
+
+#include <string>
+#include <vector>
+#include <tr1/memory>
+
+namespace degate {
+
+  /**
+   * A subcircuit pattern is a small netlist, that describes a structure,
+   * which should be found in a logic model, e.g. an adder slice or a LFSR tap.
+   *
+   * Pattern gates are described by a logic class. The logic class is matched
+   * with the semantics of is_logic_class(), i.e. a pattern gate of the class
+   * "flipflop" matches gates of the class "flipflop-async-rst", too. Pattern nets
+   * connect gate ports, that are described by the name of the template port.
+   *
+   * A pattern matches, if each pattern gate can be mapped to a different gate
+   * and each pattern net can be mapped to a different net, so that all pattern
+   * connections exist. Nets in the logic model may have further connections.
+   * Ports of a pattern gate, that are not mentioned in the pattern, are ignored.
+   */
+
+  class SubcircuitPattern {
+
+  public:
+
+    struct PatternPort {
+      std::string name;
+      unsigned int net;
+    };
+
+    struct PatternGate {
+      std::string logic_class;
+      std::vector<PatternPort> ports;
+    };
+
+  private:
+
+    std::vector<PatternGate> gates;
+    std::vector<unsigned int> net_sizes;
+
+  public:
+
+    /**
+     * Create an empty pattern.
+     */
+    SubcircuitPattern() {}
+
+    /**
+     * Add a gate.
+     * @param logic_class The logic class of the gate.
+     * @return Returns the number of the pattern gate.
+     */
+    unsigned int add_gate(std::string const& logic_class);
+
+    /**
+     * Add a net.
+     * @return Returns the number of the pattern net.
+     */
+    unsigned int add_net();
+
+    /**
+     * Connect a port of a gate with a net.
+     * @exception DegateLogicException This exception is thrown, if the gate or the
+     *   net does not exist or if the gate port is already connected.
+     */
+    void connect(unsigned int net, unsigned int gate, std::string const& port_name);
+
+    /**
+     * Connect two gate ports with a new net.
+     * @return Returns the number of the new pattern net.
+     * @see connect()
+     */
+    unsigned int connect(unsigned int gate_a, std::string const& port_name_a,
+			 unsigned int gate_b, std::string const& port_name_b);
+
+    unsigned int get_num_gates() const { return gates.size(); }
+
+    unsigned int get_num_nets() const { return net_sizes.size(); }
+
+    PatternGate const& get_gate(unsigned int gate) const { return gates.at(gate); }
+
+    /**
+     * Get the number of gate ports, that are connected with a pattern net.
+     */
+    unsigned int get_net_size(unsigned int net) const { return net_sizes.at(net); }
+
+  };
+
+  typedef std::tr1::shared_ptr<SubcircuitPattern> SubcircuitPattern_shptr;
+
+}
+
+#endif
@@ -28,9 +28,17 @@
 #include <Line.h>
 #include <Rectangle.h>
 #include <PlacedLogicModelObject.h>
+#include <Geometry.h>
 
 namespace degate {
 
+  /**
+   * Get the shape of a logic model object as a record for the geometry kernel.
+   * @return Returns false, if the object is neither a circle, a line nor
+   *   a rectangle.
+   */
+  bool get_geo_shape(PlacedLogicModelObject_shptr o, GeoShape & shape);
+
   /**
    * Check if two objects are tangent. It is assumed that both
    * objects are on the same layer.
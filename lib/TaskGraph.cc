@@ -0,0 +1,177 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <TaskGraph.h>
+#include <degate_exceptions.h>
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/thread.hpp>
+
+using namespace degate;
+
+TaskGraph::TaskGraph() :
+  num_running(0),
+  num_done(0),
+  failed(false) {
+}
+
+TaskGraph::task_id TaskGraph::add_task(std::string const& name, task_function function,
+				       std::string const& resource) {
+
+  boost::lock_guard<boost::mutex> lock(mtx);
+
+  Task t;
+  t.name = name;
+  t.function = function;
+  t.resource = resource;
+  t.state = TASK_WAITING;
+  t.num_pending = 0;
+  tasks.push_back(t);
+
+  cond.notify_all();
+  return tasks.size() - 1;
+}
+
+void TaskGraph::add_dependency(task_id task, task_id prerequisite) {
+
+  boost::lock_guard<boost::mutex> lock(mtx);
+
+  if(task >= tasks.size() || prerequisite >= tasks.size())
+    throw DegateLogicException("Invalid task ID.");
+  if(tasks[task].state != TASK_WAITING)
+    throw DegateLogicException("Can't add a dependency to a task, that was already started.");
+
+  if(tasks[prerequisite].state != TASK_DONE) {
+    tasks[task].num_pending++;
+    tasks[prerequisite].dependents.push_back(task);
+  }
+}
+
+unsigned int TaskGraph::size() const {
+  boost::lock_guard<boost::mutex> lock(mtx);
+  return tasks.size();
+}
+
+unsigned int TaskGraph::get_num_done() const {
+  boost::lock_guard<boost::mutex> lock(mtx);
+  return num_done;
+}
+
+bool TaskGraph::find_ready_task(task_id & id) const {
+  for(id = 0; id < tasks.size(); id++) {
+    Task const& t = tasks[id];
+    if(t.state == TASK_WAITING && t.num_pending == 0 &&
+       (t.resource.empty() || busy_resources.find(t.resource) == busy_resources.end()))
+      return true;
+  }
+  return false;
+}
+
+void TaskGraph::work() {
+
+  boost::unique_lock<boost::mutex> lock(mtx);
+
+  for(;;) {
+
+    if(failed || num_done == tasks.size() || (token != NULL && token->is_canceled())) break;
+
+    task_id id;
+    if(!find_ready_task(id)) {
+      if(num_running == 0) {
+	// Nothing runs, that could make a task ready.
+	failed = true;
+	error = "The task graph has cyclic dependencies.";
+	break;
+      }
+      cond.wait(lock);
+      continue;
+    }
+
+    // The vector may grow while the task runs, therefore copy what is needed.
+    tasks[id].state = TASK_RUNNING;
+    task_function function = tasks[id].function;
+    std::string resource = tasks[id].resource;
+    if(!resource.empty()) busy_resources.insert(resource);
+    num_running++;
+
+    lock.unlock();
+
+    bool ok = true;
+    std::string task_error;
+    try {
+      if(function) function();
+    }
+    catch(std::exception const& ex) {
+      ok = false;
+      task_error = ex.what();
+    }
+    catch(...) {
+      ok = false;
+      task_error = "unknown exception";
+    }
+
+    lock.lock();
+
+    num_running--;
+    if(!resource.empty()) busy_resources.erase(resource);
+
+    Task & t = tasks[id];
+    t.state = TASK_DONE;
+    num_done++;
+
+    BOOST_FOREACH(task_id d, t.dependents) tasks[d].num_pending--;
+
+    if(!ok && !failed) {
+      failed = true;
+      boost::format f("Task '%1%' failed: %2%");
+      f % t.name % task_error;
+      error = f.str();
+    }
+
+    cond.notify_all();
+  }
+
+  cond.notify_all();
+}
+
+bool TaskGraph::run(unsigned int num_threads, CancellationToken_shptr _token) {
+
+  {
+    boost::lock_guard<boost::mutex> lock(mtx);
+    token = _token;
+  }
+
+  if(num_threads == 0) num_threads = std::max(boost::thread::hardware_concurrency(), 1U);
+
+  boost::thread_group threads;
+  for(unsigned int t = 1; t < num_threads; t++)
+    threads.create_thread(boost::bind(&TaskGraph::work, this));
+
+  work();
+  threads.join_all();
+
+  boost::lock_guard<boost::mutex> lock(mtx);
+  if(failed) throw DegateRuntimeException(error);
+  return num_done == tasks.size();
+}
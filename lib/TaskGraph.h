@@ -0,0 +1,143 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __TASKGRAPH_H__
+#define __TASKGRAPH_H__
+
+#include <ProgressTracker.h>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/utility.hpp>
+
+namespace degate {
+
+  /**
+   * A set of tasks with dependencies, that are run by a group of threads.
+   *
+   * A task starts, when all its prerequisites are done. Among the tasks,
+   * that can start, the task that was added first is preferred. So callers
+   * should add tasks on the critical path first.
+   *
+   * Tasks may name a resource. Tasks with the same resource never run at
+   * the same time. Use it for data structures, that are not thread-safe.
+   *
+   * A running task may add new tasks and dependencies, e.g. after it found
+   * out how much work there is. A dependency can only be added to a task,
+   * that has not started yet.
+   *
+   * If a task throws an exception, no further tasks are started. The error
+   * is reported by run() after the running tasks are finished.
+   */
+
+  class TaskGraph : boost::noncopyable {
+
+  public:
+
+    typedef unsigned int task_id;
+    typedef boost::function<void ()> task_function;
+
+  private:
+
+    enum TASK_STATE {
+      TASK_WAITING,
+      TASK_RUNNING,
+      TASK_DONE
+    };
+
+    struct Task {
+      std::string name;
+      task_function function;
+      std::string resource;
+      TASK_STATE state;
+      unsigned int num_pending; // prerequisites, that are not done
+      std::vector<task_id> dependents;
+    };
+
+    std::vector<Task> tasks;
+    std::set<std::string> busy_resources;
+    unsigned int num_running, num_done;
+
+    bool failed;
+    std::string error;
+
+    CancellationToken_shptr token;
+
+    mutable boost::mutex mtx;
+    boost::condition_variable cond;
+
+    bool find_ready_task(task_id & id) const;
+    void work();
+
+  public:
+
+    TaskGraph();
+
+    /**
+     * Add a task.
+     * @param name A name, that is used in error messages.
+     * @param function The function to run. An empty function can be used
+     *   as a barrier, that other tasks depend on.
+     * @param resource Tasks with the same non-empty resource name do not
+     *   run concurrently.
+     * @return Returns the ID of the new task.
+     */
+    task_id add_task(std::string const& name, task_function function,
+		     std::string const& resource = "");
+
+    /**
+     * Let a task wait for another task. If the prerequisite is already
+     * done, the call has no effect.
+     * @exception DegateLogicException This exception is thrown, if an ID
+     *   is invalid or if \p task was already started.
+     */
+    void add_dependency(task_id task, task_id prerequisite);
+
+    /**
+     * Run the tasks. The calling thread works on tasks, too.
+     * @param num_threads The number of threads. Use 0 for the number of
+     *   available processors.
+     * @param token The graph stops starting tasks, if the token is canceled.
+     * @return Returns false, if the run was canceled.
+     * @exception DegateRuntimeException This exception is thrown, if a task
+     *   failed or if the dependencies are cyclic.
+     */
+    bool run(unsigned int num_threads = 0,
+	     CancellationToken_shptr token = CancellationToken_shptr());
+
+    /**
+     * Get the number of tasks.
+     */
+    unsigned int size() const;
+
+    /**
+     * Get the number of finished tasks.
+     */
+    unsigned int get_num_done() const;
+  };
+
+}
+
+#endif
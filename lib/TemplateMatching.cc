@@ -96,6 +96,8 @@ void TemplateMatching::init(BoundingBox const& bounding_box, Project_shptr proje
   this->project = project;
   this->bounding_box = bounding_box;
 
+  begin_transaction(project->get_logic_model());
+
   // limit bounding box
   if(this->bounding_box.get_max_x() + 1 > (int)project->get_width())
     this->bounding_box.set_max_x(LENGTH_TO_MAX(project->get_width()));
@@ -110,6 +112,16 @@ void TemplateMatching::init(BoundingBox const& bounding_box, Project_shptr proje
   debug(TM, "Prepare sum tabes.");
   prepare_sum_tables(gs_img_normal, gs_img_scaled);
 
+  // run() must not read the template images, because they might be
+  // replaced in the GUI thread meanwhile.
+  tmpl_images.clear();
+  BOOST_FOREACH(GateTemplate_shptr tmpl, tmpl_set) {
+    GateTemplateImage_shptr img = tmpl->get_image(layer_matching->get_layer_type());
+    GateTemplateImage_shptr img_copy(new GateTemplateImage(img->get_width(), img->get_height()));
+    copy_image(img_copy, img);
+    tmpl_images[tmpl] = img_copy;
+  }
+
   reset_progress();
 }
 
@@ -255,7 +267,7 @@ void TemplateMatching::run() {
   std::list<match_found> matches;
 
   stats.reset();
-  set_progress_step_size(1.0/(tmpl_set.size() * tmpl_orientations.size()));
+  get_progress_task()->set_total(tmpl_set.size() * tmpl_orientations.size());
 
   /*
   BOOST_FOREACH(GateTemplate_shptr tmpl, tmpl_set) {
@@ -286,10 +298,7 @@ void TemplateMatching::run() {
       matches.insert(matches.end(), m.begin(), m.end());
 
       progress_step_done();
-      if(is_canceled()) {
-	reset_progress();
-	return;
-      }
+      if(is_canceled()) return;
     }
 
   }
@@ -304,6 +313,7 @@ void TemplateMatching::run() {
       std::cout << "\tInserted gate of type " << m.tmpl->get_name() << std::endl;
   }
 
+  end_transaction(project->get_logic_model());
   reset_progress();
 }
 
@@ -338,8 +348,10 @@ TemplateMatching::prepared_template TemplateMatching::prepare_template(GateTempl
   prep.gate_template = tmpl;
   prep.orientation = orientation;
 
-  // get image from template
-  GateTemplateImage_shptr tmpl_img_orig = tmpl->get_image(layer_matching->get_layer_type());
+  // get the copy of the template image, that was taken in init()
+  std::map<GateTemplate_shptr, GateTemplateImage_shptr>::const_iterator found = tmpl_images.find(tmpl);
+  GateTemplateImage_shptr tmpl_img_orig = found != tmpl_images.end() ?
+    found->second : tmpl->get_image(layer_matching->get_layer_type());
 
   unsigned int
     w = tmpl_img_orig->get_width(),
@@ -437,8 +449,11 @@ bool TemplateMatching::add_gate(unsigned int x, unsigned int y,
 				Gate::ORIENTATION orientation,
 				double corr_val, double threshold_hc) {
 
-  if(!layer_insert->exists_type_in_region<Gate>(x, x + tmpl->get_width(),
-						y, y + tmpl->get_height())) {
+  layer_position_t layer_pos = layer_insert->get_layer_pos();
+
+  if(!get_snapshot()->exists_type_in_region<Gate>(layer_pos,
+						  x, x + tmpl->get_width(),
+						  y, y + tmpl->get_height())) {
 
     Gate_shptr gate(new Gate(x, x + tmpl->get_width(),
 			     y, y + tmpl->get_height(),
@@ -448,11 +463,8 @@ bool TemplateMatching::add_gate(unsigned int x, unsigned int y,
     snprintf(dsc, sizeof(dsc), "matched with corr=%.2f t_hc=%.2f", corr_val, threshold_hc);
     gate->set_description(dsc);
 
-    gate->set_gate_template(tmpl);
-
-    LogicModel_shptr lmodel = project->get_logic_model();
-    lmodel->add_object(layer_insert, gate);
-    lmodel->update_ports(gate);
+    get_transaction()->add_gate(layer_pos, gate, tmpl);
+    get_snapshot()->add_object(layer_pos, gate);
 
     stats.hits++;
     return true;
@@ -472,6 +484,7 @@ TemplateMatching::match_single_template(struct prepared_template & tmpl,
   state.step_size_search = get_max_step_size();
   state.search_area = bounding_box;
   std::list<match_found> matches;
+  CancellationToken_shptr token = get_cancellation_token();
 
   double max_corr_for_search = -1;
 
@@ -514,7 +527,7 @@ TemplateMatching::match_single_template(struct prepared_template & tmpl,
 
     }
 
-  } while(get_next_pos(&state, tmpl) && !is_canceled());
+  } while(get_next_pos(&state, tmpl) && !token->is_canceled());
 
   std::cout << "The maximum correlation value for the current template and orientation is " << max_corr_for_search << std::endl;
 
@@ -691,9 +704,10 @@ bool TemplateMatchingNormal::get_next_pos(struct search_state * state,
     }
 
     unsigned int dist_x =
-      layer_insert->get_distance_to_gate_boundary(state->x + state->search_area.get_min_x(),
-						  state->y + state->search_area.get_min_y(),
-						  true, tmpl_w, tmpl_h);
+      get_snapshot()->get_distance_to_gate_boundary(layer_insert->get_layer_pos(),
+						    state->x + state->search_area.get_min_x(),
+						    state->y + state->search_area.get_min_y(),
+						    true, tmpl_w, tmpl_h);
 
     if(dist_x > 0) {
       /*
@@ -816,9 +830,10 @@ bool TemplateMatchingInRows::get_next_pos(struct search_state * state,
 
     }
 
-    unsigned int dist_x = layer_insert->get_distance_to_gate_boundary(state->x + state->search_area.get_min_x(),
-								      state->y + state->search_area.get_min_y(),
-								      true, tmpl_w, tmpl_h);
+    unsigned int dist_x = get_snapshot()->get_distance_to_gate_boundary(layer_insert->get_layer_pos(),
+								        state->x + state->search_area.get_min_x(),
+								        state->y + state->search_area.get_min_y(),
+								        true, tmpl_w, tmpl_h);
 
     if(dist_x > 0) {
       debug(TM, "In the window starting at %d,%d there is already a gate. Skipping %d horizontal pixels",
@@ -880,9 +895,10 @@ bool TemplateMatchingInCols::get_next_pos(struct search_state * state,
 
     }
 
-    unsigned int dist_y = layer_insert->get_distance_to_gate_boundary(state->x + state->search_area.get_min_x(),
-								      state->y + state->search_area.get_min_y(),
-								      false, tmpl_w, tmpl_h);
+    unsigned int dist_y = get_snapshot()->get_distance_to_gate_boundary(layer_insert->get_layer_pos(),
+								        state->x + state->search_area.get_min_x(),
+								        state->y + state->search_area.get_min_y(),
+								        false, tmpl_w, tmpl_h);
 
     if(dist_y > 0) {
       debug(TM, "In the window starting at %d,%d there is already a gate. Skipping %d vertical pixels",
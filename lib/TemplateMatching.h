@@ -26,6 +26,11 @@
 #include <Project.h>
 #include <Layer.h>
 #include <ProgressControl.h>
+#include <LogicModelSnapshot.h>
+#include <LogicModelTransaction.h>
+
+#include <list>
+#include <map>
 
 namespace degate {
 
@@ -45,14 +50,95 @@ namespace degate {
 
   /**
    * Base class for matching alorithms.
+   *
+   * Matching algorithms do not query or change the logic model in run().
+   * They read from a LogicModelSnapshot and record their results in a
+   * LogicModelTransaction. By default the transaction is committed at the
+   * end of run(). If run() is executed in a worker thread, the caller
+   * should take the snapshot with set_snapshot() and enable the deferred
+   * commit. The results are then applied with commit() in the thread, that
+   * owns the logic model.
    */
   class Matching : public ProgressControl {
+
+  private:
+
+    LogicModelSnapshot_shptr next_snapshot, snapshot;
+    LogicModelTransaction_shptr transaction;
+    bool deferred_commit;
+
+  protected:
+
+    /**
+     * Prepare the snapshot and an empty transaction. Derived classes call
+     * this method in init(). If a snapshot was passed with set_snapshot(),
+     * it is used. Else a snapshot is taken from \p lmodel.
+     */
+    void begin_transaction(LogicModel_shptr lmodel) {
+      snapshot = next_snapshot != NULL ?
+	next_snapshot : LogicModelSnapshot_shptr(new LogicModelSnapshot(lmodel));
+      next_snapshot.reset();
+      transaction = LogicModelTransaction_shptr(new LogicModelTransaction());
+    }
+
+    /**
+     * Release the snapshot and commit the transaction, if the commit is
+     * not deferred. Derived classes call this method at the end of run().
+     */
+    void end_transaction(LogicModel_shptr lmodel) {
+      snapshot.reset();
+      if(!deferred_commit) commit(lmodel);
+    }
+
+    LogicModelSnapshot_shptr get_snapshot() const { return snapshot; }
+    LogicModelTransaction_shptr get_transaction() const { return transaction; }
+
   public:
+
+    Matching() : deferred_commit(false) {}
     virtual ~Matching() {}
     virtual void init(BoundingBox const& bounding_box, Project_shptr project) = 0;
     virtual void run() = 0;
+
+    /**
+     * Set the snapshot for the next init().
+     */
+    void set_snapshot(LogicModelSnapshot_shptr snapshot) { next_snapshot = snapshot; }
+
+    /**
+     * Control whether run() commits its results or leaves them for commit().
+     */
+    void set_deferred_commit(bool state) { deferred_commit = state; }
+
+    /**
+     * Check if there are results, that are not committed.
+     */
+    bool has_pending_changes() const {
+      return transaction != NULL && !transaction->empty();
+    }
+
+    /**
+     * Apply the results to the logic model.
+     * @return Returns the number of inserted objects.
+     * @see LogicModelTransaction::commit()
+     */
+    unsigned int commit(LogicModel_shptr lmodel) {
+      if(transaction == NULL) return 0;
+      LogicModelTransaction_shptr t = transaction;
+      transaction.reset();
+      return t->commit(lmodel);
+    }
+
+    /**
+     * Drop results, that are not committed.
+     */
+    void discard_pending_changes() {
+      transaction.reset();
+    }
   };
 
+  typedef std::tr1::shared_ptr<Matching> Matching_shptr;
+
 
   /**
    * This class implements the matching of gate representing images on
@@ -126,6 +212,7 @@ namespace degate {
     BoundingBox bounding_box; // bounding box on original unscaled background image
 
     std::list<GateTemplate_shptr> tmpl_set; // templates to match
+    std::map<GateTemplate_shptr, GateTemplateImage_shptr> tmpl_images; // copies taken in init()
     std::list<Gate::ORIENTATION> tmpl_orientations; // template orientations to match
 
     clock_t start, finish;
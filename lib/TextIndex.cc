@@ -0,0 +1,110 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <TextIndex.h>
+
+#include <algorithm>
+
+using namespace degate;
+
+TextIndex::handle_type TextIndex::insert(std::string const& text, object_id_t id) {
+
+  if(text.empty()) return NULL;
+
+  std::pair<key_map::iterator, bool> r = keys.insert(std::make_pair(text, id_list()));
+  r.first->second.push_back(id);
+
+  handle_type handle = &r.first->first;
+
+  if(r.second)
+    for(size_t pos = 0; pos + 3 <= text.size(); pos++)
+      trigrams[get_trigram(text, pos)].insert(handle);
+
+  return handle;
+}
+
+void TextIndex::remove(handle_type handle, object_id_t id) {
+
+  if(handle == NULL) return;
+
+  key_map::iterator found = keys.find(*handle);
+  if(found == keys.end()) return;
+
+  id_list & ids = found->second;
+  id_list::iterator i = std::find(ids.begin(), ids.end(), id);
+  if(i == ids.end()) return;
+
+  *i = ids.back();
+  ids.pop_back();
+
+  if(ids.empty()) {
+
+    std::string const& text = found->first;
+
+    for(size_t pos = 0; pos + 3 <= text.size(); pos++) {
+      trigram_map::iterator t = trigrams.find(get_trigram(text, pos));
+      if(t != trigrams.end()) {
+	t->second.erase(handle);
+	if(t->second.empty()) trigrams.erase(t);
+      }
+    }
+
+    keys.erase(found);
+  }
+}
+
+void TextIndex::find(std::string const& pattern, MATCH_MODE mode, id_list & ids) const {
+
+  if(mode == MATCH_EXACT) {
+    key_map::const_iterator found = keys.find(pattern);
+    if(found != keys.end()) append(found->second, ids);
+  }
+  else if(mode == MATCH_PREFIX) {
+    for(key_map::const_iterator iter = keys.lower_bound(pattern);
+	iter != keys.end() && iter->first.compare(0, pattern.size(), pattern) == 0; ++iter)
+      append(iter->second, ids);
+  }
+  else if(pattern.size() < 3) {
+    for(key_map::const_iterator iter = keys.begin(); iter != keys.end(); ++iter)
+      if(iter->first.find(pattern) != std::string::npos) append(iter->second, ids);
+  }
+  else {
+
+    // Take the trigram with the shortest list of candidates.
+    handle_set const * candidates = NULL;
+
+    for(size_t pos = 0; pos + 3 <= pattern.size(); pos++) {
+      trigram_map::const_iterator t = trigrams.find(get_trigram(pattern, pos));
+      if(t == trigrams.end()) return;
+      if(candidates == NULL || t->second.size() < candidates->size())
+	candidates = &t->second;
+    }
+
+    for(handle_set::const_iterator iter = candidates->begin(); iter != candidates->end(); ++iter)
+      if((*iter)->find(pattern) != std::string::npos)
+	append(keys.find(**iter)->second, ids);
+  }
+}
+
+void TextIndex::clear() {
+  keys.clear();
+  trigrams.clear();
+}
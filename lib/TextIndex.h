@@ -0,0 +1,114 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef __TEXTINDEX_H__
+#define __TEXTINDEX_H__
+
+#include <globals.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+namespace degate {
+
+  /**
+   * An index from strings, e.g. object names, to object IDs.
+   *
+   * The distinct strings are kept in a sorted map. Exact and prefix lookups
+   * are O(log n + result). For substring lookups there is an additional
+   * index from trigrams (three consecutive bytes) to the distinct strings,
+   * that contain the trigram. A lookup takes the rarest trigram of the
+   * pattern and checks only the strings, that contain it. Patterns shorter
+   * than three bytes are checked against all distinct strings.
+   *
+   * Matching is case sensitive. Empty strings are not indexed.
+   *
+   * insert() returns a handle to the stored string, that stays valid until
+   * the last ID is removed from the string. Callers keep the handle instead
+   * of a copy of the string, so that they can remove the ID later on.
+   */
+
+  class TextIndex {
+
+  public:
+
+    enum MATCH_MODE {
+      MATCH_EXACT = 0,
+      MATCH_PREFIX = 1,
+      MATCH_SUBSTRING = 2
+    };
+
+    typedef std::string const * handle_type;
+    typedef std::vector<object_id_t> id_list;
+
+  private:
+
+    typedef std::map<std::string, id_list> key_map;
+    typedef std::set<handle_type> handle_set;
+    typedef std::map<unsigned int, handle_set> trigram_map;
+
+    key_map keys;
+    trigram_map trigrams;
+
+    static unsigned int get_trigram(std::string const& s, size_t pos) {
+      return
+	((unsigned int)(unsigned char)s[pos] << 16) |
+	((unsigned int)(unsigned char)s[pos + 1] << 8) |
+	(unsigned int)(unsigned char)s[pos + 2];
+    }
+
+    static void append(id_list const& src, id_list & dst) {
+      dst.insert(dst.end(), src.begin(), src.end());
+    }
+
+  public:
+
+    /**
+     * Add an ID for a string.
+     * @return Returns a handle for remove() or NULL, if \p text is empty.
+     */
+    handle_type insert(std::string const& text, object_id_t id);
+
+    /**
+     * Remove an ID, that was added with insert().
+     * @param handle The handle, that insert() returned. NULL is ignored.
+     */
+    void remove(handle_type handle, object_id_t id);
+
+    /**
+     * Look up IDs. The IDs are appended to \p ids.
+     */
+    void find(std::string const& pattern, MATCH_MODE mode, id_list & ids) const;
+
+    /**
+     * Get the number of distinct strings.
+     */
+    unsigned int get_num_keys() const { return keys.size(); }
+
+    void clear();
+  };
+
+}
+
+#endif
@@ -25,6 +25,7 @@
 #include <MemoryMap.h>
 #include <FileSystem.h>
 #include <Configuration.h>
+#include <TilePackFile.h>
 
 #include <string>
 #include <map>
@@ -243,7 +244,8 @@ namespace degate {
   private:
 
     typedef std::tr1::shared_ptr<MemoryMap<typename PixelPolicy::pixel_type> > MemoryMap_shptr;
-    typedef std::map< std::string, // filename
+    typedef std::pair<unsigned int, unsigned int> tile_key_type; // tile column and row
+    typedef std::map< tile_key_type,
 		      std::pair<MemoryMap_shptr, struct timespec> > cache_type;
 
     const std::string directory;
@@ -252,11 +254,17 @@ namespace degate {
 
     cache_type cache;
 
+    // If set, tiles are stored in a single pack file instead of a file per tile.
+    TilePackFile_shptr pack;
+
     // Used for caching the working tile.
     mutable MemoryMap_shptr current_tile;
     mutable unsigned curr_tile_num_x;
     mutable unsigned curr_tile_num_y;
 
+    // False, if the working tile is a decoded copy of a compressed tile.
+    mutable bool curr_tile_writable;
+
 
   public:
 
@@ -273,7 +281,8 @@ namespace degate {
 	      unsigned int _min_cache_tiles = 4) :
       directory(_directory),
       tile_width_exp(_tile_width_exp),
-      persistent(_persistent) {}
+      persistent(_persistent),
+      curr_tile_writable(false) {}
 
     /**
      * Destroy a TileCache object.
@@ -286,12 +295,45 @@ namespace degate {
       }
     }
 
+    /**
+     * Use a pack file as storage for tiles. This must be set before the first tile is loaded.
+     */
+    void set_pack_file(TilePackFile_shptr pack) {
+      assert(cache.empty());
+      this->pack = pack;
+    }
+
+    /**
+     * Check if tiles are stored in a pack file.
+     */
+    bool is_packed() const { return pack != NULL; }
+
+    /**
+     * Compress all tiles of the pack file. Cached tiles are dropped before,
+     * because the pack file is rewritten. Tile pointers obtained via
+     * get_tile() must not be used afterwards.
+     * @param num_threads The number of encoder threads. Use 0 for the
+     *   number of available processors.
+     */
+    void compress(unsigned int num_threads = 0) {
+      if(pack == NULL) return;
+
+      current_tile.reset();
+      if(cache.size() > 0) {
+	GlobalTileCache & gtc = GlobalTileCache::get_instance();
+	gtc.release_cache_memory(this, cache.size() * get_image_size());
+	cache.clear();
+      }
+
+      pack->compress(num_threads);
+    }
+
     void print() const {
       for(typename cache_type::const_iterator iter = cache.begin();
 	  iter != cache.end(); ++iter) {
 	std::cout << "\t+ "
 		  << directory << "/"
-		  << (*iter).first << " "
+		  << (*iter).first.first << "_" << (*iter).first.second << " "
 		  << (*iter).second.second.tv_sec
 		  << "/"
 		  << (*iter).second.second.tv_nsec
@@ -302,28 +344,32 @@ namespace degate {
     /**
      * Get a tile. If the tile is not in the cache, the tile is loaded.
      *
+     * Compressed tiles of a pack file are decoded into memory on load. Such
+     * a copy is not written back. If you want to modify the tile, set
+     * \p for_write. Then the tile is converted into an uncompressed tile
+     * of the pack file.
+     *
      * @param x Absolut pixel coordinate.
      * @param y Absolut pixel coordinate.
+     * @param for_write Set this, if you intend to modify the tile.
      * @return Returns a shared pointer to a MemoryMap object.
      */
 
     std::tr1::shared_ptr<MemoryMap<typename PixelPolicy::pixel_type> >
-    inline get_tile(unsigned int x, unsigned int y) {
+    inline get_tile(unsigned int x, unsigned int y, bool for_write = false) {
 
       unsigned int tile_num_x = x >> tile_width_exp;
       unsigned int tile_num_y = y >> tile_width_exp;
 
       if(!(current_tile != NULL &&
 	   tile_num_x == curr_tile_num_x &&
-	   tile_num_y == curr_tile_num_y)) {
+	   tile_num_y == curr_tile_num_y &&
+	   (curr_tile_writable || !for_write))) {
 
-	// create a file name from tile number
-	char filename[PATH_MAX];
-	snprintf(filename, sizeof(filename), "%d_%d.dat", tile_num_x, tile_num_y);
-	//debug(TM, "filename is: [%s]", filename);
+	tile_key_type key(tile_num_x, tile_num_y);
 
-	// if filename/ object is not in cache, load the tile
-	typename cache_type::const_iterator iter = cache.find(filename);
+	// if the tile is not in cache, load the tile
+	typename cache_type::const_iterator iter = cache.find(key);
 
 	if(iter == cache.end()) {
 	  //cleanup_cache();
@@ -333,15 +379,20 @@ namespace degate {
 	  struct timespec now;
 	  GET_CLOCK(now);
 
-	  cache[filename] = std::make_pair(load(filename), now);
+	  cache[key] = std::make_pair(load(tile_num_x, tile_num_y, for_write), now);
 #ifdef TILECACHE_DEBUG
 	  gtc.print_table();
 #endif
 	}
+	else if(for_write && pack != NULL && pack->is_compressed(tile_num_x, tile_num_y)) {
+	  // Replace the decoded copy by an uncompressed tile.
+	  cache[key].first = load(tile_num_x, tile_num_y, true);
+	}
 
-	current_tile = cache[filename].first;
+	current_tile = cache[key].first;
 	curr_tile_num_x = tile_num_x;
 	curr_tile_num_y = tile_num_y;
+	curr_tile_writable = pack == NULL || !pack->is_compressed(tile_num_x, tile_num_y);
 
       }
 
@@ -375,6 +426,7 @@ namespace degate {
 
       assert(oldest != cache.end());
       (*oldest).second.first.reset(); // explicit reset of smart pointer
+      if(pack != NULL) pack->release_tile((*oldest).first.first, (*oldest).first.second);
       cache.erase(oldest);
 #ifdef TILECACHE_DEBUG
       debug(TM, "local cache: %d entries after remove\n", cache.size());
@@ -395,14 +447,35 @@ namespace degate {
     }
 
     /**
-     * Load a tile from an image file.
-     * @param filename Just the name of the file to load. The filename is
-     *     relative to the \p directory.
+     * Load a tile from the pack file or from an image file.
+     * @param tile_num_x The tile column.
+     * @param tile_num_y The tile row.
+     * @param for_write If not set, compressed tiles are decoded into memory.
+     *   Otherwise they are converted into uncompressed tiles.
      */
     std::tr1::shared_ptr<MemoryMap<typename PixelPolicy::pixel_type> >
-    load(std::string const& filename) const {
+    load(unsigned int tile_num_x, unsigned int tile_num_y, bool for_write) const {
+
+      if(pack != NULL && !for_write && pack->is_compressed(tile_num_x, tile_num_y)) {
+	MemoryMap_shptr mem(new MemoryMap<typename PixelPolicy::pixel_type>
+			    (1 << tile_width_exp, 1 << tile_width_exp));
+	pack->read_tile(tile_num_x, tile_num_y, mem->get_data_ptr());
+	return mem;
+      }
+
+      if(pack != NULL) {
+	return MemoryMap_shptr(new MemoryMap<typename PixelPolicy::pixel_type>
+			       (1 << tile_width_exp,
+				1 << tile_width_exp,
+				static_cast<typename PixelPolicy::pixel_type *>
+				(pack->get_tile(tile_num_x, tile_num_y))));
+      }
+
+      // create a file name from tile number
+      char filename[PATH_MAX];
+      snprintf(filename, sizeof(filename), "%d_%d.dat", tile_num_x, tile_num_y);
 
-      //debug(TM, "directory: [%s] file: [%s]", directory.c_str(), filename.c_str());
+      //debug(TM, "directory: [%s] file: [%s]", directory.c_str(), filename);
       MemoryMap_shptr mem(new MemoryMap<typename PixelPolicy::pixel_type>
 			  (1 << tile_width_exp,
 			   1 << tile_width_exp,
@@ -0,0 +1,132 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <TileCodec.h>
+#include <degate_exceptions.h>
+
+#include <boost/format.hpp>
+
+#include <zlib.h>
+#include <string.h>
+
+using namespace degate;
+
+/*
+ * The memory layout of an RGBA pixel is R, G, B, A on all platforms
+ * (see color_t), so grey detection can work on bytes.
+ */
+
+bool TileCodec::is_grey(void const * src, size_t tile_bytes) {
+  uint8_t const * p = static_cast<uint8_t const *>(src);
+  uint8_t const * end = p + tile_bytes - tile_bytes % 4;
+
+  for(; p != end; p += 4)
+    if(p[0] != p[1] || p[0] != p[2] || p[3] != 0xff) return false;
+
+  return true;
+}
+
+void TileCodec::encode(void const * src, size_t tile_bytes, size_t pixel_size,
+		       std::vector<uint8_t> & dst, int level) {
+
+  if(pixel_size == 0 || tile_bytes % pixel_size != 0)
+    throw DegateRuntimeException("The tile size is not a multiple of the pixel size.");
+
+  uint8_t const * in = static_cast<uint8_t const *>(src);
+  size_t num_pixels = tile_bytes / pixel_size;
+
+  TILE_CODEC_METHOD method = pixel_size == 4 && is_grey(src, tile_bytes) ?
+    TILE_CODEC_GREY : TILE_CODEC_PLANAR;
+  unsigned int num_planes = method == TILE_CODEC_GREY ? 1 : pixel_size;
+
+  // Split pixels into planes and replace each byte by the difference to its predecessor.
+  std::vector<uint8_t> planes(num_planes * num_pixels);
+  for(unsigned int plane = 0; plane < num_planes; plane++) {
+    uint8_t * out = &planes[plane * num_pixels];
+    uint8_t prev = 0;
+    for(size_t i = 0; i < num_pixels; i++) {
+      uint8_t v = in[i * pixel_size + plane];
+      out[i] = v - prev;
+      prev = v;
+    }
+  }
+
+  uLongf compressed_bytes = compressBound(planes.size());
+  dst.resize(header_size + compressed_bytes);
+
+  dst[0] = method;
+  dst[1] = pixel_size;
+  dst[2] = dst[3] = 0;
+  for(unsigned int i = 0; i < 4; i++) dst[4 + i] = (tile_bytes >> (8 * i)) & 0xff;
+
+  if(compress2(&dst[header_size], &compressed_bytes, &planes[0], planes.size(), level) != Z_OK)
+    throw DegateRuntimeException("zlib failed to compress a tile.");
+
+  dst.resize(header_size + compressed_bytes);
+}
+
+void TileCodec::decode(void const * src, size_t src_bytes,
+		       void * dst, size_t tile_bytes) {
+
+  uint8_t const * in = static_cast<uint8_t const *>(src);
+  if(src_bytes < header_size)
+    throw DegateRuntimeException("The encoded tile is truncated.");
+
+  unsigned int method = in[0];
+  size_t pixel_size = in[1];
+  size_t decoded_bytes = 0;
+  for(unsigned int i = 0; i < 4; i++) decoded_bytes |= (size_t)in[4 + i] << (8 * i);
+
+  if(decoded_bytes != tile_bytes || pixel_size == 0 || tile_bytes % pixel_size != 0 ||
+     (method == TILE_CODEC_GREY && pixel_size != 4) ||
+     (method != TILE_CODEC_GREY && method != TILE_CODEC_PLANAR))
+    throw DegateRuntimeException(boost::str(boost::format("The encoded tile does not match the "
+							   "expected tile size of %1% bytes.") % tile_bytes));
+
+  size_t num_pixels = tile_bytes / pixel_size;
+  unsigned int num_planes = method == TILE_CODEC_GREY ? 1 : pixel_size;
+
+  std::vector<uint8_t> planes(num_planes * num_pixels);
+  uLongf planes_bytes = planes.size();
+
+  if(uncompress(&planes[0], &planes_bytes, in + header_size, src_bytes - header_size) != Z_OK ||
+     planes_bytes != planes.size())
+    throw DegateRuntimeException("The encoded tile is corrupted.");
+
+  uint8_t * out = static_cast<uint8_t *>(dst);
+
+  for(unsigned int plane = 0; plane < num_planes; plane++) {
+    uint8_t const * p = &planes[plane * num_pixels];
+    uint8_t v = 0;
+    for(size_t i = 0; i < num_pixels; i++) {
+      v += p[i];
+      out[i * pixel_size + plane] = v;
+    }
+  }
+
+  if(method == TILE_CODEC_GREY) {
+    for(size_t i = 0; i < num_pixels; i++) {
+      out[i * 4 + 1] = out[i * 4 + 2] = out[i * 4];
+      out[i * 4 + 3] = 0xff;
+    }
+  }
+}
@@ -0,0 +1,97 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef __TILECODEC_H__
+#define __TILECODEC_H__
+
+#include <globals.h>
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace degate {
+
+  /**
+   * A lossless codec for image tiles.
+   *
+   * Scanned background images compress well, if the bytes of a pixel are
+   * separated into planes and each plane is delta coded, because neighbouring
+   * pixels are similar. Tiles with a pixel size of four bytes are treated as
+   * RGBA. If all pixels of such a tile are grey and opaque, only a single
+   * plane is stored. The planes are compressed with zlib.
+   *
+   * The encoded data starts with a small header:
+   * - byte 0: the method (TILE_CODEC_PLANAR or TILE_CODEC_GREY)
+   * - byte 1: the pixel size in bytes
+   * - bytes 2-3: reserved, zero
+   * - bytes 4-7: the size of the decoded tile in bytes, little endian
+   *
+   * Encoding and decoding do not share state and can be used from multiple
+   * threads.
+   */
+
+  class TileCodec {
+
+  public:
+
+    enum TILE_CODEC_METHOD {
+      TILE_CODEC_PLANAR = 0, /**< each byte of a pixel in its own plane */
+      TILE_CODEC_GREY = 1    /**< a single plane for grey and opaque RGBA pixels */
+    };
+
+    const static size_t header_size = 8;
+
+    /**
+     * Encode a tile.
+     * @param src The raw tile data.
+     * @param tile_bytes The size of the tile in bytes.
+     * @param pixel_size The size of a pixel in bytes.
+     * @param dst The encoded data is written into this vector. It is resized.
+     * @param level The zlib compression level from 1 (fast) to 9 (small).
+     * @exception DegateRuntimeException This exception is thrown, if
+     *   the tile size is not a multiple of the pixel size or if zlib fails.
+     */
+    static void encode(void const * src, size_t tile_bytes, size_t pixel_size,
+		       std::vector<uint8_t> & dst, int level = 6);
+
+    /**
+     * Decode a tile.
+     * @param src The encoded data.
+     * @param src_bytes The size of the encoded data.
+     * @param dst A buffer for the decoded tile.
+     * @param tile_bytes The size of the buffer. It must match the size of the encoded tile.
+     * @exception DegateRuntimeException This exception is thrown, if the
+     *   data is corrupted or if the size does not match.
+     */
+    static void decode(void const * src, size_t src_bytes,
+		       void * dst, size_t tile_bytes);
+
+    /**
+     * Check if all pixels of an RGBA tile are grey and opaque.
+     */
+    static bool is_grey(void const * src, size_t tile_bytes);
+  };
+
+}
+
+#endif
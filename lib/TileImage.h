@@ -111,6 +111,13 @@ namespace degate {
 
       if(!file_exists(_directory)) create_directory(_directory);
 
+      // Images, that were stored with a file per tile, keep that layout.
+      if(TilePackFile::exists(_directory) ||
+	 (!TilePackFile::has_tile_files(_directory) &&
+	  Configuration::get_instance().use_packed_tile_store()))
+	tile_cache.set_pack_file(TilePackFile_shptr
+				 (new TilePackFile(_directory, _width, _height, _tile_width_exp,
+						   sizeof(typename PixelPolicy::pixel_type))));
     }
 
     /**
@@ -153,6 +160,60 @@ namespace degate {
       mem->raw_copy(dst_buf);
     }
 
+    /**
+     * Check if the tiles are stored in a single pack file.
+     */
+    bool is_packed() const { return tile_cache.is_packed(); }
+
+    /**
+     * Compress the tiles. This works only for images, that are stored in a
+     * pack file. Compressed tiles are decoded when they are loaded into the
+     * tile cache. Tiles that are modified afterwards are stored uncompressed
+     * until the next call.
+     * @param num_threads The number of encoder threads. Use 0 for the
+     *   number of available processors.
+     */
+    void compress_tiles(unsigned int num_threads = 0) {
+      tile_cache.compress(num_threads);
+    }
+
+    /**
+     * Copy the raw data from an image tile that has its upper left corner at x,y into a buffer.
+     * Unlike raw_copy() this method reads the tile file directly and does not use the
+     * tile cache. The tile cache is not thread-safe, this method is. Use it to load tiles
+     * in worker threads. Tiles that were never written are returned as zeroed memory.
+     */
+    void read_tile(void * dst_buf, unsigned int src_x, unsigned int src_y) const {
+
+      size_t tile_bytes = sizeof(typename PixelPolicy::pixel_type) * get_tile_size() * get_tile_size();
+
+      if(is_packed()) {
+	TilePackFile::read_tile(directory, src_x >> tile_width_exp, src_y >> tile_width_exp,
+				dst_buf, tile_bytes);
+	return;
+      }
+
+      char filename[PATH_MAX];
+      snprintf(filename, sizeof(filename), "%d_%d.dat",
+	       src_x >> tile_width_exp, src_y >> tile_width_exp);
+
+      std::string path = join_pathes(directory, filename);
+      size_t read_bytes = 0;
+
+      int fd = open(path.c_str(), O_RDONLY);
+      if(fd != -1) {
+	while(read_bytes < tile_bytes) {
+	  ssize_t n = pread(fd, (char *)dst_buf + read_bytes, tile_bytes - read_bytes, read_bytes);
+	  if(n <= 0) break;
+	  read_bytes += n;
+	}
+	close(fd);
+      }
+
+      if(read_bytes < tile_bytes)
+	memset((char *)dst_buf + read_bytes, 0, tile_bytes - read_bytes);
+    }
+
 
   };
 
@@ -169,7 +230,7 @@ namespace degate {
   StoragePolicy_Tile<PixelPolicy>::set_pixel(unsigned int x, unsigned int y,
 					     typename PixelPolicy::pixel_type new_val) {
 
-    MemoryMap_shptr mem = tile_cache.get_tile(x, y);
+    MemoryMap_shptr mem = tile_cache.get_tile(x, y, true);
     mem->set(x & offset_bitmask, y & offset_bitmask, new_val);
   }
 
@@ -0,0 +1,601 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <TilePackFile.h>
+#include <TileCodec.h>
+#include <FileSystem.h>
+#include <degate_exceptions.h>
+
+#include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace degate;
+
+const char * const TilePackFile::pack_filename = "tiles.pack";
+
+static const char pack_magic[8] = { 'D', 'G', 'T', 'P', 'A', 'C', 'K', '1' };
+static const uint32_t pack_version = 2;
+
+// Segments of the data area are mapped in chunks of this size.
+static const size_t max_segment_bytes = 64 * 1024 * 1024;
+
+// Bit 0 of an index entry marks a compressed tile.
+static const uint64_t compressed_flag = 1;
+
+// Compressed tiles are encoded in batches of this many tiles per thread.
+static const unsigned int tiles_per_thread_batch = 4;
+
+
+static uint64_t round_up(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool pread_fully(int fd, void * dst, size_t n, off_t offset) {
+  size_t done = 0;
+  while(done < n) {
+    ssize_t r = pread(fd, (char *)dst + done, n - done, offset + done);
+    if(r <= 0) return false;
+    done += r;
+  }
+  return true;
+}
+
+static bool pwrite_fully(int fd, void const * src, size_t n, off_t offset) {
+  size_t done = 0;
+  while(done < n) {
+    ssize_t r = pwrite(fd, (char const *)src + done, n - done, offset + done);
+    if(r <= 0) return false;
+    done += r;
+  }
+  return true;
+}
+
+
+namespace {
+
+  /**
+   * Encodes a part of a batch of tiles in a worker thread. Worker i handles
+   * the tiles i, i + step, i + 2 * step, ... Tiles, that are already
+   * compressed, are copied as they are.
+   */
+  struct EncodeWorker {
+
+    int fd;
+    size_t tile_bytes;
+    size_t pixel_size;
+    int level;
+    std::vector<uint64_t> const * offsets;
+    std::vector<std::vector<uint8_t> > * results;
+    unsigned int first, step;
+    std::string * error;
+
+    void operator()() {
+      try {
+	std::vector<uint8_t> raw(tile_bytes);
+
+	for(unsigned int i = first; i < offsets->size(); i += step) {
+	  uint64_t offset = (*offsets)[i];
+	  std::vector<uint8_t> & out = (*results)[i];
+
+	  if(offset & compressed_flag) {
+	    uint32_t size;
+	    offset &= ~compressed_flag;
+	    if(!pread_fully(fd, &size, sizeof(size), offset))
+	      throw DegateRuntimeException("Can't read a compressed tile.");
+	    out.resize(size);
+	    if(!pread_fully(fd, &out[0], size, offset + sizeof(size)))
+	      throw DegateRuntimeException("Can't read a compressed tile.");
+	  }
+	  else {
+	    if(!pread_fully(fd, &raw[0], tile_bytes, offset))
+	      throw DegateRuntimeException("Can't read a tile.");
+	    TileCodec::encode(&raw[0], tile_bytes, pixel_size, out, level);
+	  }
+	}
+      }
+      catch(std::exception const& ex) {
+	*error = ex.what();
+      }
+    }
+  };
+
+}
+
+
+TilePackFile::TilePackFile(std::string const& directory,
+			   unsigned int width, unsigned int height,
+			   unsigned int tile_width_exp, size_t pixel_size) :
+  directory(directory),
+  filename(join_pathes(directory, pack_filename)),
+  fd(-1),
+  header_mem(NULL),
+  header(NULL),
+  index(NULL) {
+
+  unsigned int tile_size = 1 << tile_width_exp;
+  tile_bytes = pixel_size * tile_size * tile_size;
+  tiles_x = std::max((width + tile_size - 1) / tile_size, 1U);
+  tiles_y = std::max((height + tile_size - 1) / tile_size, 1U);
+  header_size = get_header_size(tiles_x, tiles_y, tile_bytes);
+
+  // Do not map more than the whole image at once.
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t image_bytes = (size_t)tiles_x * tiles_y * tile_bytes;
+  size_t tiles_per_segment = std::max(std::min(max_segment_bytes, image_bytes) / tile_bytes, (size_t)1);
+  segment_bytes = round_up(tiles_per_segment * tile_bytes, page_size);
+
+  if((fd = open(filename.c_str(), O_RDWR | O_CREAT, 0600)) == -1)
+    throw DegateRuntimeException(boost::str(boost::format("Can't open tile pack file %1%: %2%") %
+					    filename % strerror(errno)));
+
+  try {
+    struct stat st;
+    if(fstat(fd, &st) == -1) throw DegateRuntimeException("fstat() failed for tile pack file.");
+
+    if(st.st_size == 0) create(tile_width_exp, pixel_size);
+    else check_header(tile_width_exp, pixel_size);
+
+    map_header();
+  }
+  catch(...) {
+    close(fd);
+    throw;
+  }
+}
+
+TilePackFile::~TilePackFile() {
+  unmap();
+  close(fd);
+}
+
+void TilePackFile::unmap() {
+
+  BOOST_FOREACH(void * seg, segments)
+    if(seg != NULL) munmap(seg, segment_bytes);
+  segments.clear();
+
+  if(header_mem != NULL) munmap(header_mem, header_size);
+  header_mem = NULL;
+  header = NULL;
+  index = NULL;
+}
+
+size_t TilePackFile::get_header_size(unsigned int tiles_x, unsigned int tiles_y, size_t tile_bytes) {
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t raw_size = sizeof(header_type) + (size_t)tiles_x * tiles_y * sizeof(uint64_t);
+
+  // The data area starts at an offset, that is page- and tile-aligned.
+  return round_up(raw_size, std::max(page_size, tile_bytes));
+}
+
+void TilePackFile::create(unsigned int tile_width_exp, size_t pixel_size) {
+
+  if(ftruncate(fd, header_size) == -1)
+    throw DegateRuntimeException(boost::str(boost::format("Can't create tile pack file %1%: %2%") %
+					    filename % strerror(errno)));
+
+  header_type h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, pack_magic, sizeof(pack_magic));
+  h.version = pack_version;
+  h.tile_width_exp = tile_width_exp;
+  h.pixel_size = pixel_size;
+  h.tiles_x = tiles_x;
+  h.tiles_y = tiles_y;
+  h.num_allocated = 0;
+  h.data_offset = header_size;
+  h.data_end = header_size;
+
+  if(pwrite(fd, &h, sizeof(h), 0) != sizeof(h))
+    throw DegateRuntimeException(boost::str(boost::format("Can't write header of tile pack file %1%.") %
+					    filename));
+}
+
+void TilePackFile::read_header(int fd, std::string const& filename, header_type & h) {
+
+  if(!pread_fully(fd, &h, sizeof(h), 0) || memcmp(h.magic, pack_magic, sizeof(pack_magic)) != 0)
+    throw DegateRuntimeException(boost::str(boost::format("%1% is not a tile pack file.") % filename));
+
+  if(h.version != pack_version)
+    throw DegateRuntimeException(boost::str(boost::format("Unsupported version %1% of tile pack file %2%.") %
+					    h.version % filename));
+}
+
+void TilePackFile::check_header(unsigned int tile_width_exp, size_t pixel_size) const {
+
+  header_type h;
+  read_header(fd, filename, h);
+
+  if(h.tile_width_exp != tile_width_exp || h.pixel_size != pixel_size ||
+     h.tiles_x != tiles_x || h.tiles_y != tiles_y || h.data_offset != header_size)
+    throw DegateRuntimeException(boost::str(boost::format("The tile pack file %1% does not match the image parameters.") %
+					    filename));
+}
+
+void TilePackFile::map_header() {
+
+  header_mem = mmap(NULL, header_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if(header_mem == MAP_FAILED) {
+    header_mem = NULL;
+    throw DegateRuntimeException(boost::str(boost::format("Can't map header of tile pack file %1%.") %
+					    filename));
+  }
+
+  header = static_cast<header_type *>(header_mem);
+  index = reinterpret_cast<uint64_t *>(static_cast<char *>(header_mem) + sizeof(header_type));
+}
+
+void * TilePackFile::map_segment(unsigned int segment) {
+
+  if(segment >= segments.size()) segments.resize(segment + 1, NULL);
+  if(segments[segment] != NULL) return segments[segment];
+
+  off_t offset = header->data_offset + (off_t)segment * segment_bytes;
+
+  // Grow the file segment-wise. The file is sparse, until tiles are written.
+  struct stat st;
+  if(fstat(fd, &st) == -1)
+    throw DegateRuntimeException("fstat() failed for tile pack file.");
+
+  if(st.st_size < offset + (off_t)segment_bytes &&
+     ftruncate(fd, offset + segment_bytes) == -1)
+    throw DegateRuntimeException(boost::str(boost::format("Can't extend tile pack file %1%: %2%") %
+					    filename % strerror(errno)));
+
+  void * mem = mmap(NULL, segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+  if(mem == MAP_FAILED)
+    throw DegateRuntimeException(boost::str(boost::format("Can't map segment %1% of tile pack file %2%.") %
+					    segment % filename));
+  segments[segment] = mem;
+  return mem;
+}
+
+uint64_t TilePackFile::allocate_tile(unsigned int tile_x, unsigned int tile_y) {
+
+  // The data area starts tile-aligned and segments are a multiple of the
+  // tile size. Therefore an aligned tile never crosses a segment boundary.
+  uint64_t offset = round_up(std::max(header->data_end, header->data_offset),
+			     std::max(tile_bytes, (size_t)8));
+
+  header->data_end = offset + tile_bytes;
+  return offset;
+}
+
+void * TilePackFile::get_tile(unsigned int tile_x, unsigned int tile_y) {
+
+  if(tile_x >= tiles_x || tile_y >= tiles_y)
+    throw DegateRuntimeException(boost::str(boost::format("Tile %1%/%2% is out of range.") %
+					    tile_x % tile_y));
+
+  uint64_t & entry = index[tile_y * tiles_x + tile_x];
+  uint64_t offset = entry;
+
+  if(offset == 0 || (offset & compressed_flag)) {
+    offset = allocate_tile(tile_x, tile_y);
+    uint64_t rel = offset - header->data_offset;
+    void * mem = static_cast<char *>(map_segment(rel / segment_bytes)) + rel % segment_bytes;
+
+    if(entry == 0) header->num_allocated++;
+    else read_compressed(fd, entry & ~compressed_flag, mem, tile_bytes);
+
+    entry = offset;
+    return mem;
+  }
+
+  uint64_t rel = offset - header->data_offset;
+  return static_cast<char *>(map_segment(rel / segment_bytes)) + rel % segment_bytes;
+}
+
+bool TilePackFile::is_compressed(unsigned int tile_x, unsigned int tile_y) const {
+  return tile_x < tiles_x && tile_y < tiles_y &&
+    (index[tile_y * tiles_x + tile_x] & compressed_flag) != 0;
+}
+
+void TilePackFile::read_tile(unsigned int tile_x, unsigned int tile_y, void * dst) const {
+
+  if(tile_x >= tiles_x || tile_y >= tiles_y)
+    throw DegateRuntimeException(boost::str(boost::format("Tile %1%/%2% is out of range.") %
+					    tile_x % tile_y));
+
+  uint64_t offset = index[tile_y * tiles_x + tile_x];
+
+  if(offset == 0) memset(dst, 0, tile_bytes);
+  else if(offset & compressed_flag) read_compressed(fd, offset & ~compressed_flag, dst, tile_bytes);
+  else if(!pread_fully(fd, dst, tile_bytes, offset))
+    throw DegateRuntimeException(boost::str(boost::format("Can't read tile %1%/%2% from %3%.") %
+					    tile_x % tile_y % filename));
+}
+
+void TilePackFile::read_compressed(int fd, uint64_t offset, void * dst, size_t tile_bytes) {
+
+  uint32_t size;
+  if(!pread_fully(fd, &size, sizeof(size), offset))
+    throw DegateRuntimeException("Can't read a compressed tile.");
+
+  std::vector<uint8_t> encoded(size);
+  if(size == 0 || !pread_fully(fd, &encoded[0], size, offset + sizeof(size)))
+    throw DegateRuntimeException("Can't read a compressed tile.");
+
+  TileCodec::decode(&encoded[0], size, dst, tile_bytes);
+}
+
+unsigned int TilePackFile::get_num_compressed() const {
+  unsigned int n = 0;
+  for(size_t i = 0; i < (size_t)tiles_x * tiles_y; i++)
+    if(index[i] & compressed_flag) n++;
+  return n;
+}
+
+void TilePackFile::release_tile(unsigned int tile_x, unsigned int tile_y) {
+
+  if(tile_x >= tiles_x || tile_y >= tiles_y) return;
+
+  uint64_t offset = index[tile_y * tiles_x + tile_x];
+  if(offset == 0 || (offset & compressed_flag)) return;
+
+  uint64_t rel = offset - header->data_offset;
+  unsigned int segment = rel / segment_bytes;
+  if(segment >= segments.size() || segments[segment] == NULL) return;
+
+  // msync() and madvise() require page-aligned addresses.
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t start = rel % segment_bytes / page_size * page_size;
+  size_t len = round_up(rel % segment_bytes + tile_bytes, page_size) - start;
+  char * addr = static_cast<char *>(segments[segment]) + start;
+
+  // Schedule write-back, but do not wait. For shared file mappings the dropped
+  // pages stay in the page cache. Later accesses fault them back in.
+  msync(addr, len, MS_ASYNC);
+  madvise(addr, len, MADV_DONTNEED);
+}
+
+void TilePackFile::sync() {
+
+  BOOST_FOREACH(void * seg, segments)
+    if(seg != NULL && msync(seg, segment_bytes, MS_SYNC) == -1)
+      debug(TM, "msync() failed for %s", filename.c_str());
+
+  if(msync(header_mem, header_size, MS_SYNC) == -1)
+    debug(TM, "msync() failed for %s", filename.c_str());
+}
+
+void TilePackFile::compress(unsigned int num_threads, int level) {
+
+  sync();
+
+  std::string tmp_filename = filename + ".tmp";
+  write_compressed(directory, tmp_filename, num_threads, level);
+
+  unmap();
+  close(fd);
+
+  if(rename(tmp_filename.c_str(), filename.c_str()) == -1) {
+    int err = errno;
+    remove_file(tmp_filename);
+    fd = open(filename.c_str(), O_RDWR);
+    if(fd != -1) map_header();
+    throw DegateRuntimeException(boost::str(boost::format("Can't replace tile pack file %1%: %2%") %
+					    filename % strerror(err)));
+  }
+
+  if((fd = open(filename.c_str(), O_RDWR)) == -1)
+    throw DegateRuntimeException(boost::str(boost::format("Can't open tile pack file %1%: %2%") %
+					    filename % strerror(errno)));
+  map_header();
+}
+
+void TilePackFile::write_compressed(std::string const& src_directory,
+				    std::string const& dst_filename,
+				    unsigned int num_threads, int level) {
+
+  std::string src_filename = join_pathes(src_directory, pack_filename);
+
+  if(num_threads == 0) num_threads = std::max(boost::thread::hardware_concurrency(), 1U);
+
+  int src = open(src_filename.c_str(), O_RDONLY);
+  if(src == -1)
+    throw DegateRuntimeException(boost::str(boost::format("Can't open tile pack file %1%: %2%") %
+					    src_filename % strerror(errno)));
+
+  int dst = -1;
+
+  try {
+    header_type h;
+    read_header(src, src_filename, h);
+
+    size_t tile_bytes = (size_t)h.pixel_size << (2 * h.tile_width_exp);
+    size_t num_tiles = (size_t)h.tiles_x * h.tiles_y;
+
+    std::vector<uint64_t> src_index(num_tiles);
+    if(!pread_fully(src, &src_index[0], num_tiles * sizeof(uint64_t), sizeof(header_type)))
+      throw DegateRuntimeException(boost::str(boost::format("Can't read the index of %1%.") %
+					      src_filename));
+
+    if((dst = open(dst_filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600)) == -1)
+      throw DegateRuntimeException(boost::str(boost::format("Can't create %1%: %2%") %
+					      dst_filename % strerror(errno)));
+
+    std::vector<uint64_t> dst_index(num_tiles, 0);
+    std::vector<size_t> tiles;
+    for(size_t i = 0; i < num_tiles; i++)
+      if(src_index[i] != 0) tiles.push_back(i);
+
+    // Encode batches in parallel and write them in order, so that the
+    // memory for encoded tiles is bounded.
+    uint64_t pos = h.data_offset;
+    size_t batch_size = num_threads * tiles_per_thread_batch;
+
+    for(size_t start = 0; start < tiles.size(); start += batch_size) {
+
+      size_t end = std::min(start + batch_size, tiles.size());
+      std::vector<uint64_t> offsets;
+      for(size_t i = start; i < end; i++) offsets.push_back(src_index[tiles[i]]);
+
+      std::vector<std::vector<uint8_t> > results(offsets.size());
+      std::vector<std::string> errors(num_threads);
+      boost::thread_group threads;
+
+      for(unsigned int t = 0; t < num_threads && t < offsets.size(); t++) {
+	EncodeWorker w;
+	w.fd = src;
+	w.tile_bytes = tile_bytes;
+	w.pixel_size = h.pixel_size;
+	w.level = level;
+	w.offsets = &offsets;
+	w.results = &results;
+	w.first = t;
+	w.step = num_threads;
+	w.error = &errors[t];
+	threads.create_thread(w);
+      }
+      threads.join_all();
+
+      BOOST_FOREACH(std::string const& e, errors)
+	if(!e.empty())
+	  throw DegateRuntimeException(boost::str(boost::format("Can't compress %1%: %2%") %
+						  src_filename % e));
+
+      for(size_t i = 0; i < results.size(); i++) {
+	pos = round_up(pos, 8);
+	uint32_t size = results[i].size();
+	if(!pwrite_fully(dst, &size, sizeof(size), pos) ||
+	   !pwrite_fully(dst, &results[i][0], size, pos + sizeof(size)))
+	  throw DegateRuntimeException(boost::str(boost::format("Can't write %1%: %2%") %
+						  dst_filename % strerror(errno)));
+	dst_index[tiles[start + i]] = pos | compressed_flag;
+	pos += sizeof(size) + size;
+      }
+    }
+
+    h.num_allocated = tiles.size();
+    h.data_end = pos;
+
+    if(ftruncate(dst, pos) == -1 ||
+       !pwrite_fully(dst, &h, sizeof(h), 0) ||
+       !pwrite_fully(dst, &dst_index[0], num_tiles * sizeof(uint64_t), sizeof(header_type)) ||
+       fsync(dst) == -1)
+      throw DegateRuntimeException(boost::str(boost::format("Can't write %1%: %2%") %
+					      dst_filename % strerror(errno)));
+  }
+  catch(...) {
+    close(src);
+    if(dst != -1) {
+      close(dst);
+      remove_file(dst_filename);
+    }
+    throw;
+  }
+
+  close(src);
+  close(dst);
+}
+
+bool TilePackFile::is_compressed(std::string const& directory) {
+
+  std::string path = join_pathes(directory, pack_filename);
+  bool compressed = false;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if(fd == -1) return false;
+
+  try {
+    header_type h;
+    read_header(fd, path, h);
+
+    std::vector<uint64_t> index((size_t)h.tiles_x * h.tiles_y);
+    if(pread_fully(fd, &index[0], index.size() * sizeof(uint64_t), sizeof(header_type))) {
+      compressed = true;
+      BOOST_FOREACH(uint64_t offset, index)
+	if(offset != 0 && !(offset & compressed_flag)) compressed = false;
+    }
+  }
+  catch(DegateRuntimeException const& ex) {
+    compressed = false;
+  }
+
+  close(fd);
+  return compressed;
+}
+
+bool TilePackFile::exists(std::string const& directory) {
+  return file_exists(join_pathes(directory, pack_filename));
+}
+
+bool TilePackFile::has_tile_files(std::string const& directory) {
+  if(!file_exists(directory)) return false;
+
+  BOOST_FOREACH(std::string const& f, read_directory(directory)) {
+    unsigned int x, y;
+    char c;
+    if(sscanf(f.c_str(), "%u_%u.da%c", &x, &y, &c) == 3 && c == 't' &&
+       get_file_suffix(f) == "dat") return true;
+  }
+
+  return false;
+}
+
+void TilePackFile::read_tile(std::string const& directory,
+			     unsigned int tile_x, unsigned int tile_y,
+			     void * dst, size_t tile_bytes) {
+
+  std::string path = join_pathes(directory, pack_filename);
+  bool ok = false;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if(fd != -1) {
+    header_type h;
+    uint64_t offset = 0;
+
+    if(pread_fully(fd, &h, sizeof(h), 0) &&
+       memcmp(h.magic, pack_magic, sizeof(pack_magic)) == 0 &&
+       h.version == pack_version &&
+       tile_x < h.tiles_x && tile_y < h.tiles_y &&
+       pread_fully(fd, &offset, sizeof(offset),
+		   sizeof(header_type) + ((off_t)tile_y * h.tiles_x + tile_x) * sizeof(uint64_t)) &&
+       offset != 0) {
+
+      if(offset & compressed_flag) {
+	try {
+	  read_compressed(fd, offset & ~compressed_flag, dst, tile_bytes);
+	  ok = true;
+	}
+	catch(DegateRuntimeException const& ex) {
+	  debug(TM, "Can't decode tile %d/%d in %s: %s", tile_x, tile_y, path.c_str(), ex.what());
+	}
+      }
+      else ok = pread_fully(fd, dst, tile_bytes, offset);
+    }
+
+    close(fd);
+  }
+
+  if(!ok) memset(dst, 0, tile_bytes);
+}
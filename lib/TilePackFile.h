@@ -0,0 +1,248 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __TILEPACKFILE_H__
+#define __TILEPACKFILE_H__
+
+#include <globals.h>
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <tr1/memory>
+#include <boost/utility.hpp>
+
+namespace degate {
+
+  /**
+   * Storage for the tiles of an image in a single file.
+   *
+   * The older layout stores each tile in its own file. For large images
+   * this results in many files and in one mmap() per loaded tile. A
+   * TilePackFile stores all tiles of an image in one file named "tiles.pack"
+   * in the image directory. The file starts with a header and an index,
+   * that maps a tile to the offset of its data. Tiles are allocated on
+   * first access and appended at tile-aligned offsets. The data area is
+   * mapped in large segments, so that there are only few mappings.
+   *
+   * Released tiles are written back asynchronously. The kernel flushes
+   * dirty pages in the background. The file is only synced, if you call
+   * sync().
+   *
+   * Tiles can be stored compressed with the TileCodec. Compressed tiles are
+   * not mapped. They are decoded into memory that is owned by the caller.
+   * If a compressed tile is requested via get_tile(), e.g. because it is
+   * modified, it is decoded into a newly allocated uncompressed tile.
+   *
+   * The file layout is:
+   * - header: magic "DGTPACK1", version, tile width exponent, pixel size,
+   *   number of tiles in x and y direction, number of allocated tiles,
+   *   offset of the data area, end of the used data area
+   * - index: a 64 bit offset for each tile in row-major order, 0 for
+   *   tiles that were not allocated yet. If bit 0 is set, the tile is
+   *   compressed.
+   * - data area: uncompressed tiles, each at an offset that is a multiple
+   *   of the tile size, and compressed tiles, each at an 8 byte aligned
+   *   offset, starting with the 32 bit size of the encoded data
+   */
+
+  class TilePackFile : boost::noncopyable {
+
+  public:
+
+    /**
+     * The name of the pack file within an image directory.
+     */
+    static const char * const pack_filename;
+
+  private:
+
+    struct header_type {
+      char magic[8];
+      uint32_t version;
+      uint32_t tile_width_exp;
+      uint32_t pixel_size;
+      uint32_t tiles_x;
+      uint32_t tiles_y;
+      uint32_t num_allocated;
+      uint64_t data_offset;
+      uint64_t data_end;
+    };
+
+    std::string directory;
+    std::string filename;
+    int fd;
+
+    size_t tile_bytes;
+    unsigned int tiles_x, tiles_y;
+
+    void * header_mem;
+    size_t header_size;
+    header_type * header;
+    uint64_t * index;
+
+    size_t segment_bytes;
+    std::vector<void *> segments;
+
+    static size_t get_header_size(unsigned int tiles_x, unsigned int tiles_y, size_t tile_bytes);
+
+    void create(unsigned int tile_width_exp, size_t pixel_size);
+    void check_header(unsigned int tile_width_exp, size_t pixel_size) const;
+    void map_header();
+    void unmap();
+    void * map_segment(unsigned int segment);
+    uint64_t allocate_tile(unsigned int tile_x, unsigned int tile_y);
+
+    static void read_header(int fd, std::string const& filename, header_type & h);
+    static void read_compressed(int fd, uint64_t offset, void * dst, size_t tile_bytes);
+
+  public:
+
+    /**
+     * Open or create a pack file.
+     * @param directory The image directory.
+     * @param width The image width in pixel.
+     * @param height The image height in pixel.
+     * @param tile_width_exp The tile width as exponent to the base 2.
+     * @param pixel_size The size of a pixel in bytes.
+     * @exception DegateRuntimeException This exception is thrown, if the file
+     *   can't be created or if an existing file does not match the parameters.
+     */
+    TilePackFile(std::string const& directory,
+		 unsigned int width, unsigned int height,
+		 unsigned int tile_width_exp, size_t pixel_size);
+
+    /**
+     * Unmap the file. Dirty pages are written back by the kernel.
+     */
+    ~TilePackFile();
+
+    /**
+     * Check if there is a pack file in an image directory.
+     */
+    static bool exists(std::string const& directory);
+
+    /**
+     * Check if an image directory contains tiles in the older one-file-per-tile layout.
+     */
+    static bool has_tile_files(std::string const& directory);
+
+    /**
+     * Get a pointer to the data of a tile. The tile is allocated, if
+     * necessary. A compressed tile is decoded into a new uncompressed tile.
+     * The pointer stays valid until the object is destroyed or until
+     * compress() is called.
+     * @param tile_x The tile column.
+     * @param tile_y The tile row.
+     */
+    void * get_tile(unsigned int tile_x, unsigned int tile_y);
+
+    /**
+     * Check if a tile is stored compressed.
+     */
+    bool is_compressed(unsigned int tile_x, unsigned int tile_y) const;
+
+    /**
+     * Copy a tile into a buffer. Compressed tiles are decoded. Tiles, that
+     * were not allocated, are returned as zeroed memory.
+     * @param tile_x The tile column.
+     * @param tile_y The tile row.
+     * @param dst A buffer of the size of a tile.
+     */
+    void read_tile(unsigned int tile_x, unsigned int tile_y, void * dst) const;
+
+    /**
+     * Tell the pack file, that a tile is not used anymore. Modified data is
+     * scheduled for write-back and the memory is returned to the system.
+     */
+    void release_tile(unsigned int tile_x, unsigned int tile_y);
+
+    /**
+     * Write all modified data to disk and wait for completion.
+     */
+    void sync();
+
+    /**
+     * Get the number of allocated tiles.
+     */
+    unsigned int get_num_allocated() const { return header->num_allocated; }
+
+    /**
+     * Get the number of compressed tiles.
+     */
+    unsigned int get_num_compressed() const;
+
+    /**
+     * Get the size of the used data area in bytes.
+     */
+    uint64_t get_data_size() const { return header->data_end - header->data_offset; }
+
+    /**
+     * Compress all tiles. The file is rewritten, which also frees the space
+     * of tiles that were decompressed on modification. All pointers returned
+     * by get_tile() become invalid.
+     * @param num_threads The number of threads used for encoding. Use 0 for
+     *   the number of available processors.
+     * @param level The zlib compression level.
+     */
+    void compress(unsigned int num_threads = 0, int level = 6);
+
+    /**
+     * Write a compressed copy of a pack file. The source file is only read,
+     * so this is safe while the image is in use, as long as the source is
+     * synced. Tiles are encoded in parallel.
+     * @param src_directory The image directory with the pack file to copy.
+     * @param dst_filename The name of the file to write.
+     * @param num_threads The number of threads used for encoding. Use 0 for
+     *   the number of available processors.
+     * @param level The zlib compression level.
+     * @exception DegateRuntimeException This exception is thrown, if the
+     *   source is not a pack file or if a file operation fails.
+     */
+    static void write_compressed(std::string const& src_directory,
+				 std::string const& dst_filename,
+				 unsigned int num_threads = 0, int level = 6);
+
+    /**
+     * Check if all allocated tiles of a pack file are compressed.
+     */
+    static bool is_compressed(std::string const& directory);
+
+    /**
+     * Read a tile from a pack file without mapping it. This method does not
+     * depend on the state of a TilePackFile object and is thread-safe.
+     * Compressed tiles are decoded. Tiles, that were not allocated or can't
+     * be read, are returned as zeroed memory.
+     * @param directory The image directory.
+     * @param tile_x The tile column.
+     * @param tile_y The tile row.
+     * @param dst A buffer for the tile.
+     * @param tile_bytes The size of a tile in bytes.
+     */
+    static void read_tile(std::string const& directory,
+			  unsigned int tile_x, unsigned int tile_y,
+			  void * dst, size_t tile_bytes);
+  };
+
+  typedef std::tr1::shared_ptr<TilePackFile> TilePackFile_shptr;
+}
+
+#endif
@@ -0,0 +1,363 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <TileStreamer.h>
+#include <degate_exceptions.h>
+
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+
+using namespace degate;
+
+
+/*
+ * BackgroundImageTileSource
+ */
+
+BackgroundImageTileSource::BackgroundImageTileSource(ScalingManager_shptr smgr) {
+  assert(smgr != NULL);
+
+  ScalingManager<BackgroundImage>::zoom_step_list steps = smgr->get_zoom_steps();
+  BOOST_FOREACH(double step, steps) {
+    images[lrint(step)] = smgr->get_image(step).second;
+  }
+}
+
+unsigned int BackgroundImageTileSource::get_tile_size() const {
+  assert(!images.empty());
+  return images.begin()->second->get_tile_size();
+}
+
+std::list<unsigned int> BackgroundImageTileSource::get_levels() const {
+  std::list<unsigned int> levels;
+  for(std::map<unsigned int, BackgroundImage_shptr>::const_iterator iter = images.begin();
+      iter != images.end(); ++iter)
+    levels.push_back(iter->first);
+  return levels;
+}
+
+unsigned int BackgroundImageTileSource::get_width(unsigned int level) const {
+  std::map<unsigned int, BackgroundImage_shptr>::const_iterator found = images.find(level);
+  return found == images.end() ? 0 : found->second->get_width();
+}
+
+unsigned int BackgroundImageTileSource::get_height(unsigned int level) const {
+  std::map<unsigned int, BackgroundImage_shptr>::const_iterator found = images.find(level);
+  return found == images.end() ? 0 : found->second->get_height();
+}
+
+void BackgroundImageTileSource::load_tile(TileKey const& key, rgba_pixel_t * dst) {
+  std::map<unsigned int, BackgroundImage_shptr>::const_iterator found = images.find(key.level);
+  unsigned int tile_size = get_tile_size();
+
+  if(found == images.end())
+    memset(dst, 0, tile_size * tile_size * sizeof(rgba_pixel_t));
+  else
+    found->second->read_tile(dst, key.col * tile_size, key.row * tile_size);
+}
+
+
+/*
+ * TileStreamer
+ */
+
+TileStreamer::TileStreamer(TileSource_shptr _source,
+			   unsigned int max_resident,
+			   unsigned int num_threads,
+			   unsigned int num_staging_buffers) :
+  source(_source),
+  stop(false),
+  num_loaded(0),
+  resident(max_resident),
+  have_last_viewport(false),
+  last_level(0) {
+
+  if(source == NULL) throw InvalidPointerException("The tile source is a NULL pointer.");
+
+  tile_size = source->get_tile_size();
+  levels = source->get_levels();
+
+  if(num_staging_buffers == 0) num_staging_buffers = 1;
+  staging_buffers.resize(num_staging_buffers);
+  for(unsigned int i = 0; i < num_staging_buffers; i++) {
+    staging_buffers[i].resize(tile_size * tile_size);
+    free_buffers.push_back(i);
+  }
+
+  if(num_threads == 0) num_threads = 1;
+  for(unsigned int i = 0; i < num_threads; i++)
+    workers.create_thread(boost::bind(&TileStreamer::worker, this));
+}
+
+TileStreamer::~TileStreamer() {
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+    stop = true;
+  }
+  work_available.notify_all();
+  workers.join_all();
+}
+
+void TileStreamer::worker() {
+
+  for(;;) {
+    TileKey key;
+    unsigned int buffer;
+
+    {
+      boost::unique_lock<boost::mutex> lock(mutex);
+      while(!stop && (request_queue.empty() || free_buffers.empty()))
+	work_available.wait(lock);
+
+      if(stop) return;
+
+      key = request_queue.front();
+      request_queue.pop_front();
+      buffer = free_buffers.front();
+      free_buffers.pop_front();
+      loading.insert(key);
+    }
+
+    rgba_pixel_t * data = &staging_buffers[buffer][0];
+
+    try {
+      source->load_tile(key, data);
+    }
+    catch(std::exception const& ex) {
+      // Stage an empty tile. Otherwise the tile would be requested again and again.
+      debug(TM, "Failed to load tile %d/%d on level %d: %s", key.col, key.row, key.level, ex.what());
+      memset(data, 0, tile_size * tile_size * sizeof(rgba_pixel_t));
+    }
+
+    {
+      boost::lock_guard<boost::mutex> lock(mutex);
+      loading.erase(key);
+      num_loaded++;
+
+      StagedTile t;
+      t.key = key;
+      t.data = data;
+      t.buffer = buffer;
+      ready.push_back(t);
+    }
+  }
+}
+
+bool TileStreamer::has_level(unsigned int level) const {
+  return std::find(levels.begin(), levels.end(), level) != levels.end();
+}
+
+unsigned int TileStreamer::get_coarser_level(unsigned int level) const {
+  BOOST_FOREACH(unsigned int l, levels) if(l > level) return l;
+  return level;
+}
+
+unsigned int TileStreamer::get_finer_level(unsigned int level) const {
+  unsigned int finer = level;
+  BOOST_FOREACH(unsigned int l, levels) if(l < level) finer = l;
+  return finer;
+}
+
+std::list<TileKey> TileStreamer::get_tiles(BoundingBox const& region, unsigned int level) const {
+
+  std::list<TileKey> tiles;
+  if(!has_level(level) || region.get_max_x() < 0 || region.get_max_y() < 0) return tiles;
+
+  unsigned int cols = (source->get_width(level) + tile_size - 1) / tile_size;
+  unsigned int rows = (source->get_height(level) + tile_size - 1) / tile_size;
+  if(cols == 0 || rows == 0) return tiles;
+
+  unsigned int span = tile_size * level;
+  unsigned int min_col = std::max(region.get_min_x(), 0) / span;
+  unsigned int min_row = std::max(region.get_min_y(), 0) / span;
+  unsigned int max_col = std::min((unsigned int)region.get_max_x() / span, cols - 1);
+  unsigned int max_row = std::min((unsigned int)region.get_max_y() / span, rows - 1);
+
+  for(unsigned int row = min_row; row <= max_row; row++)
+    for(unsigned int col = min_col; col <= max_col; col++)
+      tiles.push_back(TileKey(level, col, row));
+
+  return tiles;
+}
+
+BoundingBox TileStreamer::get_tile_bbox(TileKey const& key) const {
+  unsigned int span = tile_size * key.level;
+  return BoundingBox(key.col * span, (key.col + 1) * span,
+		     key.row * span, (key.row + 1) * span);
+}
+
+void TileStreamer::update(BoundingBox const& viewport, unsigned int level) {
+
+  std::set<TileKey> wanted;
+  std::list<TileKey> requests;
+
+  // visible tiles first
+  std::list<TileKey> visible = get_tiles(viewport, level);
+  BOOST_FOREACH(TileKey const& key, visible) {
+    resident_handle_t h;
+    wanted.insert(key);
+    if(!resident.get(key, h)) requests.push_back(key);
+  }
+
+  // Prefetch at most as many tiles as there are visible tiles.
+  std::list<TileKey> prefetch;
+
+  if(have_last_viewport && last_level == level) {
+    int dx = viewport.get_center_x() - last_viewport.get_center_x();
+    int dy = viewport.get_center_y() - last_viewport.get_center_y();
+    int span = tile_size * level;
+
+    if(dx != 0 || dy != 0) {
+      BoundingBox ahead(viewport.get_min_x() + (dx > 0 ? span : dx < 0 ? -span : 0),
+			viewport.get_max_x() + (dx > 0 ? span : dx < 0 ? -span : 0),
+			viewport.get_min_y() + (dy > 0 ? span : dy < 0 ? -span : 0),
+			viewport.get_max_y() + (dy > 0 ? span : dy < 0 ? -span : 0));
+      std::list<TileKey> l = get_tiles(ahead, level);
+      prefetch.splice(prefetch.end(), l);
+    }
+  }
+
+  // the next zoom level in the direction the user zooms, coarser by default
+  unsigned int next_level = have_last_viewport && level < last_level ?
+    get_finer_level(level) : get_coarser_level(level);
+
+  if(next_level != level) {
+    // for a finer level only prefetch tiles around the center
+    BoundingBox region = viewport;
+    if(next_level < level) {
+      int w = viewport.get_width() / 4, h = viewport.get_height() / 4;
+      region.set(viewport.get_center_x() - w, viewport.get_center_x() + w,
+		 viewport.get_center_y() - h, viewport.get_center_y() + h);
+    }
+    std::list<TileKey> l = get_tiles(region, next_level);
+    prefetch.splice(prefetch.end(), l);
+  }
+
+  unsigned int num_prefetch = 0;
+  BOOST_FOREACH(TileKey const& key, prefetch) {
+    if(num_prefetch >= std::max(visible.size(), (size_t)1)) break;
+    if(wanted.insert(key).second && !resident.contains(key)) {
+      requests.push_back(key);
+      num_prefetch++;
+    }
+  }
+
+  last_viewport = viewport;
+  last_level = level;
+  have_last_viewport = true;
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    // Staged tiles, that are neither visible nor prefetched, are dropped.
+    for(std::list<StagedTile>::iterator iter = ready.begin(); iter != ready.end(); ) {
+      if(wanted.find(iter->key) == wanted.end()) {
+	free_buffers.push_back(iter->buffer);
+	iter = ready.erase(iter);
+      }
+      else ++iter;
+    }
+
+    std::set<TileKey> in_flight(loading);
+    BOOST_FOREACH(StagedTile const& t, ready) in_flight.insert(t.key);
+
+    // Replace the queue. Requests from earlier updates are dropped.
+    request_queue.clear();
+    BOOST_FOREACH(TileKey const& key, requests)
+      if(in_flight.find(key) == in_flight.end()) request_queue.push_back(key);
+  }
+
+  work_available.notify_all();
+}
+
+void TileStreamer::collect(unsigned int max_tiles, std::list<StagedTile> & tiles) {
+  boost::lock_guard<boost::mutex> lock(mutex);
+  while(max_tiles > 0 && !ready.empty()) {
+    tiles.push_back(ready.front());
+    ready.pop_front();
+    max_tiles--;
+  }
+}
+
+void TileStreamer::release(StagedTile const& tile) {
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+    free_buffers.push_back(tile.buffer);
+  }
+  work_available.notify_one();
+}
+
+void TileStreamer::make_resident(StagedTile const& tile, resident_handle_t handle,
+				 std::list<resident_handle_t> & evicted) {
+
+  LRUCache<TileKey, resident_handle_t>::value_type dropped;
+  if(resident.insert(tile.key, handle, dropped) && dropped.second != handle)
+    evicted.push_back(dropped.second);
+
+  release(tile);
+}
+
+bool TileStreamer::find_resident(TileKey const& key, ResidentTile & found) {
+
+  TileKey k = key;
+  float min_x = 0, min_y = 0, max_x = 1, max_y = 1;
+
+  for(;;) {
+    if(resident.get(k, found.handle)) {
+      found.key = k;
+      found.tex_min_x = min_x;
+      found.tex_min_y = min_y;
+      found.tex_max_x = max_x;
+      found.tex_max_y = max_y;
+      return true;
+    }
+
+    // Each coarser level halves the image size. Then four tiles map to one.
+    if(get_coarser_level(k.level) != 2 * k.level) return false;
+
+    min_x = ((k.col & 1) + min_x) / 2;
+    max_x = ((k.col & 1) + max_x) / 2;
+    min_y = ((k.row & 1) + min_y) / 2;
+    max_y = ((k.row & 1) + max_y) / 2;
+    k = TileKey(2 * k.level, k.col >> 1, k.row >> 1);
+  }
+}
+
+void TileStreamer::clear_resident(std::list<resident_handle_t> & evicted) {
+  for(LRUCache<TileKey, resident_handle_t>::iterator iter = resident.begin();
+      iter != resident.end(); ++iter)
+    evicted.push_back(iter->second);
+  resident.clear();
+}
+
+bool TileStreamer::has_pending_work() {
+  boost::lock_guard<boost::mutex> lock(mutex);
+  return !request_queue.empty() || !loading.empty() || !ready.empty();
+}
+
+unsigned long TileStreamer::get_num_loaded() {
+  boost::lock_guard<boost::mutex> lock(mutex);
+  return num_loaded;
+}
@@ -0,0 +1,312 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __TILESTREAMER_H__
+#define __TILESTREAMER_H__
+
+#include <globals.h>
+#include <BoundingBox.h>
+#include <LRUCache.h>
+#include <ScalingManager.h>
+
+#include <list>
+#include <set>
+#include <map>
+#include <vector>
+#include <tr1/memory>
+
+#include <boost/thread.hpp>
+
+namespace degate {
+
+  /**
+   * Identifies an image tile on a scaling level.
+   */
+  struct TileKey {
+
+    unsigned int level;  /**< The scaling factor: 1, 2, 4, ... */
+    unsigned int col;    /**< Tile column within the scaled image. */
+    unsigned int row;    /**< Tile row within the scaled image. */
+
+    TileKey(unsigned int level = 1, unsigned int col = 0, unsigned int row = 0) :
+      level(level), col(col), row(row) {}
+
+    bool operator<(TileKey const& other) const {
+      if(level != other.level) return level < other.level;
+      if(row != other.row) return row < other.row;
+      return col < other.col;
+    }
+
+    bool operator==(TileKey const& other) const {
+      return level == other.level && col == other.col && row == other.row;
+    }
+  };
+
+
+  /**
+   * Interface for a source of RGBA image tiles, that are available in
+   * several scaling levels.
+   */
+  class TileSource {
+
+  public:
+
+    virtual ~TileSource() {}
+
+    /**
+     * Get the edge length of a tile in pixel.
+     */
+    virtual unsigned int get_tile_size() const = 0;
+
+    /**
+     * Get the available scaling levels in ascending order.
+     */
+    virtual std::list<unsigned int> get_levels() const = 0;
+
+    /**
+     * Get the width of the image for a scaling level in pixel.
+     */
+    virtual unsigned int get_width(unsigned int level) const = 0;
+
+    /**
+     * Get the height of the image for a scaling level in pixel.
+     */
+    virtual unsigned int get_height(unsigned int level) const = 0;
+
+    /**
+     * Load a tile into a buffer of get_tile_size()^2 pixels. This method
+     * is called from worker threads and must be thread-safe.
+     */
+    virtual void load_tile(TileKey const& key, rgba_pixel_t * dst) = 0;
+  };
+
+  typedef std::tr1::shared_ptr<TileSource> TileSource_shptr;
+
+
+  /**
+   * A tile source for the background image of a layer and its prescaled images.
+   */
+  class BackgroundImageTileSource : public TileSource {
+
+  private:
+
+    std::map<unsigned int, BackgroundImage_shptr> images;
+
+  public:
+
+    /**
+     * Create a tile source. This constructor must be called from the
+     * thread that owns the scaling manager.
+     */
+    BackgroundImageTileSource(ScalingManager_shptr smgr);
+
+    virtual ~BackgroundImageTileSource() {}
+
+    virtual unsigned int get_tile_size() const;
+    virtual std::list<unsigned int> get_levels() const;
+    virtual unsigned int get_width(unsigned int level) const;
+    virtual unsigned int get_height(unsigned int level) const;
+    virtual void load_tile(TileKey const& key, rgba_pixel_t * dst);
+  };
+
+
+  /**
+   * The TileStreamer loads image tiles in background threads, so that a
+   * viewer does not block on disk I/O.
+   *
+   * For each frame the viewer calls update() with the viewport. The streamer
+   * schedules loads for visible tiles, that are not resident, followed by
+   * prefetch requests for tiles in the direction the viewport moved and for
+   * the adjacent scaling level. Requests from earlier frames, that are no
+   * longer wanted, are dropped.
+   *
+   * Worker threads copy tiles into a fixed pool of staging buffers. The
+   * viewer fetches a bounded number of staged tiles per frame with
+   * collect(), uploads them, e.g. into textures, and passes the resulting
+   * handle back with make_resident(). Resident handles are kept in an LRU
+   * cache. Handles, that fall out of the cache, are returned to the viewer,
+   * which must release them.
+   *
+   * All methods except the worker threads are meant to be called from a
+   * single thread, usually the GUI thread.
+   */
+  class TileStreamer {
+
+  public:
+
+    typedef unsigned int resident_handle_t;
+
+    /**
+     * A loaded tile in a staging buffer.
+     */
+    struct StagedTile {
+      TileKey key;
+      rgba_pixel_t const * data;
+      unsigned int buffer;
+    };
+
+    /**
+     * A resident tile, that can be used to draw a requested tile. If the
+     * requested tile is not resident, a coarser tile may be used. Then
+     * the texture coordinates describe the part of the coarser tile, that
+     * covers the requested tile.
+     */
+    struct ResidentTile {
+      TileKey key;
+      resident_handle_t handle;
+      float tex_min_x, tex_min_y, tex_max_x, tex_max_y;
+    };
+
+  private:
+
+    TileSource_shptr source;
+    unsigned int tile_size;
+    std::list<unsigned int> levels;
+
+    std::vector<std::vector<rgba_pixel_t> > staging_buffers;
+
+    // State shared with the worker threads. Guarded by mutex.
+    boost::mutex mutex;
+    boost::condition_variable work_available;
+    bool stop;
+    std::list<TileKey> request_queue;
+    std::set<TileKey> loading;
+    std::list<StagedTile> ready;
+    std::list<unsigned int> free_buffers;
+    unsigned long num_loaded;
+
+    boost::thread_group workers;
+
+    // State of the viewer thread.
+    LRUCache<TileKey, resident_handle_t> resident;
+    bool have_last_viewport;
+    BoundingBox last_viewport;
+    unsigned int last_level;
+
+    void worker();
+
+    void add_request(TileKey const& key, std::set<TileKey> & wanted);
+    void add_tiles(BoundingBox const& region, unsigned int level, std::set<TileKey> & wanted);
+
+    bool has_level(unsigned int level) const;
+    unsigned int get_coarser_level(unsigned int level) const;
+    unsigned int get_finer_level(unsigned int level) const;
+
+  public:
+
+    /**
+     * Create a streamer and start the worker threads.
+     * @param source The tile source.
+     * @param max_resident The capacity of the LRU cache for resident tiles.
+     * @param num_threads The number of worker threads.
+     * @param num_staging_buffers The number of staging buffers. This limits the
+     *   number of tiles, that are loaded, but not yet collected.
+     */
+    TileStreamer(TileSource_shptr source,
+		 unsigned int max_resident = 64,
+		 unsigned int num_threads = 2,
+		 unsigned int num_staging_buffers = 8);
+
+    /**
+     * Stop the worker threads.
+     */
+    ~TileStreamer();
+
+    /**
+     * Get the edge length of a tile in pixel.
+     */
+    unsigned int get_tile_size() const { return tile_size; }
+
+    /**
+     * Get the tiles that intersect a region.
+     * @param region A region in unscaled pixel coordinates.
+     * @param level The scaling level.
+     */
+    std::list<TileKey> get_tiles(BoundingBox const& region, unsigned int level) const;
+
+    /**
+     * Get the area a tile covers in unscaled pixel coordinates.
+     */
+    BoundingBox get_tile_bbox(TileKey const& key) const;
+
+    /**
+     * Schedule tile loads for a viewport.
+     * @param viewport The viewport in unscaled pixel coordinates.
+     * @param level The scaling level, that should be used for the viewport.
+     */
+    void update(BoundingBox const& viewport, unsigned int level);
+
+    /**
+     * Fetch tiles that were loaded by the worker threads. You must either
+     * pass each collected tile to make_resident() or to release().
+     * @param max_tiles The maximum number of tiles to fetch.
+     * @param tiles The list is filled with staged tiles.
+     */
+    void collect(unsigned int max_tiles, std::list<StagedTile> & tiles);
+
+    /**
+     * Return a staging buffer to the pool without making the tile resident.
+     */
+    void release(StagedTile const& tile);
+
+    /**
+     * Make a tile resident and return its staging buffer to the pool.
+     * @param handle A handle for the uploaded tile.
+     * @param evicted Handles, that were dropped from the cache, are appended to this list.
+     */
+    void make_resident(StagedTile const& tile, resident_handle_t handle,
+		       std::list<resident_handle_t> & evicted);
+
+    /**
+     * Look up a resident tile for drawing a tile. If the tile itself is
+     * not resident, resident tiles of coarser levels are used.
+     * @return Returns true, if a resident tile was found.
+     */
+    bool find_resident(TileKey const& key, ResidentTile & found);
+
+    /**
+     * Drop all resident tiles.
+     * @param evicted The handles of all resident tiles are appended to this list.
+     */
+    void clear_resident(std::list<resident_handle_t> & evicted);
+
+    /**
+     * Check if there are tile loads in flight or staged tiles, that were
+     * not collected yet.
+     */
+    bool has_pending_work();
+
+    /**
+     * Get the number of tiles loaded since the streamer was created.
+     */
+    unsigned long get_num_loaded();
+
+    /**
+     * Get the number of resident tiles.
+     */
+    unsigned int get_num_resident() const { return resident.size(); }
+  };
+
+  typedef std::tr1::shared_ptr<TileStreamer> TileStreamer_shptr;
+
+}
+
+#endif
@@ -20,18 +20,126 @@
 */
 
 
+
 #include <VerilogModuleGenerator.h>
-#include <boost/format.hpp>
+#include <DenseObjectMap.h>
 #include <boost/foreach.hpp>
-#include <boost/algorithm/string/join.hpp>
+#include <boost/thread.hpp>
+
+#include <sstream>
 
 using namespace boost;
 using namespace degate;
 
-VerilogModuleGenerator::VerilogModuleGenerator(Module_shptr module, bool do_not_output_gates /* = false */) :
+namespace {
+
+  /**
+   * Collect the templates of the gates in a module hierarchy in pre-order
+   * and the sub-modules in post-order, that is sub-modules before the
+   * modules, that contain them.
+   */
+  void collect_hierarchy(Module_shptr module, bool with_gates,
+			 std::vector<GateTemplate_shptr> & templates,
+			 std::set<GateTemplate_shptr> & already_collected,
+			 std::vector<Module_shptr> & submodules) {
+
+    if(with_gates) {
+      for(Module::gate_collection::const_iterator iter = module->gates_begin();
+	  iter != module->gates_end(); ++iter)
+	if(GateTemplate_shptr gtmpl = (*iter)->get_gate_template())
+	  if(already_collected.insert(gtmpl).second) templates.push_back(gtmpl);
+    }
+
+    for(Module::module_collection::const_iterator iter = module->modules_begin();
+	iter != module->modules_end(); ++iter) {
+      collect_hierarchy(*iter, with_gates, templates, already_collected, submodules);
+      submodules.push_back(*iter);
+    }
+  }
+
+
+  /**
+   * The name of a net within a module. Names are either a module port name,
+   * a sub-module port name or a numbered wire. Port names are not copied,
+   * they point into the port collection of the module.
+   */
+  struct NetName {
+    std::string const * name;
+    unsigned int wire;
+    bool is_module_port;
+
+    std::string str() const {
+      if(name != NULL) return *name;
+      std::ostringstream s;
+      s << 'w' << wire;
+      return s.str();
+    }
+  };
+
+  std::ostream & operator<<(std::ostream & os, NetName const& n) {
+    if(n.name != NULL) return os << *n.name;
+    return os << 'w' << n.wire;
+  }
+
+
+  /**
+   * Buffers for sub-module definitions, that are generated in worker threads.
+   * The writer waits for the buffers in order and releases each buffer as soon
+   * as it is written.
+   */
+  struct DefinitionBuffers {
+    std::vector<std::string> code;
+    std::vector<std::string> errors;
+    std::vector<bool> done;
+    bool abort;
+
+    boost::mutex mutex;
+    boost::condition_variable cond;
+  };
+
+
+  /**
+   * Generates a part of the sub-module definitions in a worker thread.
+   * Worker i handles the modules i, i + step, i + 2 * step, ...
+   */
+  struct DefinitionWorker {
+    std::vector<Module_shptr> const * modules;
+    DefinitionBuffers * buffers;
+    unsigned int first, step;
+
+    void operator()() {
+      for(size_t i = first; i < modules->size(); i += step) {
+
+	std::ostringstream code;
+	std::string error;
+
+	try {
+	  VerilogModuleGenerator codegen((*modules)[i], true, 1);
+	  codegen.generate_definition(code);
+	}
+	catch(std::exception const& ex) {
+	  error = ex.what();
+	}
+
+	boost::mutex::scoped_lock lock(buffers->mutex);
+	buffers->code[i] = code.str();
+	buffers->errors[i] = error;
+	buffers->done[i] = true;
+	buffers->cond.notify_all();
+	if(buffers->abort) return;
+      }
+    }
+  };
+
+}
+
+
+VerilogModuleGenerator::VerilogModuleGenerator(Module_shptr module, bool do_not_output_gates /* = false */,
+					       unsigned int _num_threads /* = 0 */) :
   VerilogCodeTemplateGenerator(module->get_name(), module->get_entity_name()), 
   mod(module),
-  no_gates(do_not_output_gates) {
+  no_gates(do_not_output_gates),
+  num_threads(_num_threads) {
 
   // set module ports
   for(Module::port_collection::const_iterator iter = module->ports_begin();
@@ -51,61 +159,118 @@ VerilogModuleGenerator::~VerilogModuleGenerator() {
 }
 
 
-std::string VerilogModuleGenerator::generate_common_code_for_gates(Module_shptr module,
-								   std::set<GateTemplate_shptr> & already_dumped) const {
-  std::string common_code;
+void VerilogModuleGenerator::generate(std::ostream & os) const {
+  write_common(os);
+  generate_definition(os);
+}
 
-  if(!no_gates) {
-    for(Module::gate_collection::const_iterator iter = module->gates_begin();
-	iter != module->gates_end(); ++iter) {
-      Gate_shptr gate = *iter;
-      
-      if(GateTemplate_shptr gtmpl = gate->get_gate_template()) {
-	
-	if(already_dumped.find(gtmpl) == already_dumped.end()) {
-	  
-	  try {
-	    common_code += gtmpl->get_implementation(GateTemplate::VERILOG);
-	  }
-	  catch(CollectionLookupException const& ex) {
-	    // maybe we should pass the exception?
-	    common_code += "// Error: failed to lookup Verilog implementation for module " + gtmpl->get_name() + ".\n\n";
-	  }
-	  already_dumped.insert(gtmpl);
-	}
-      }
+void VerilogModuleGenerator::generate_definition(std::ostream & os) const {
+  os << generate_header()
+     << generate_module(entity_name, generate_port_list())
+     << generate_port_definition();
+  write_impl(os);
+  os << "\n\nendmodule\n\n";
+}
+
+std::string VerilogModuleGenerator::generate_common() const {
+  std::ostringstream code;
+  write_common(code);
+  return code.str();
+}
+
+std::string VerilogModuleGenerator::generate_impl(std::string const& logic_class /* unused parameter */ ) const {
+  std::ostringstream code;
+  write_impl(code);
+  return code.str();
+}
+
+
+void VerilogModuleGenerator::write_common(std::ostream & os) const {
+
+  std::vector<GateTemplate_shptr> templates;
+  std::set<GateTemplate_shptr> already_collected;
+  std::vector<Module_shptr> submodules;
+  collect_hierarchy(mod, !no_gates, templates, already_collected, submodules);
+
+  BOOST_FOREACH(GateTemplate_shptr gtmpl, templates) {
+    try {
+      os << gtmpl->get_implementation(GateTemplate::VERILOG);
+    }
+    catch(CollectionLookupException const& ex) {
+      // maybe we should pass the exception?
+      os << "// Error: failed to lookup Verilog implementation for module " << gtmpl->get_name() << ".\n\n";
     }
   }
 
-  // traverse sub-modules
-  for(Module::module_collection::const_iterator iter = module->modules_begin();
-      iter != module->modules_end(); ++iter) {
+  write_submodule_definitions(os, submodules);
+}
 
-    Module_shptr sub = *iter;
-    common_code += generate_common_code_for_gates(sub, already_dumped);
 
-    VerilogModuleGenerator codegen(sub, true);   
-    common_code += codegen.generate();
-    
+void VerilogModuleGenerator::write_submodule_definitions(std::ostream & os,
+							 std::vector<Module_shptr> const& modules) const {
+
+  unsigned int threads_to_use = num_threads;
+  if(threads_to_use == 0) threads_to_use = std::max(boost::thread::hardware_concurrency(), 1U);
+  threads_to_use = std::min<unsigned int>(threads_to_use, std::max<size_t>(modules.size(), 1));
+
+  if(threads_to_use == 1) {
+    BOOST_FOREACH(Module_shptr sub, modules) {
+      VerilogModuleGenerator codegen(sub, true, 1);
+      codegen.generate_definition(os);
+    }
+    return;
   }
 
-  return common_code;
-}
+  DefinitionBuffers buffers;
+  buffers.code.resize(modules.size());
+  buffers.errors.resize(modules.size());
+  buffers.done.resize(modules.size(), false);
+  buffers.abort = false;
+
+  boost::thread_group threads;
+  for(unsigned int t = 0; t < threads_to_use; t++) {
+    DefinitionWorker w;
+    w.modules = &modules;
+    w.buffers = &buffers;
+    w.first = t;
+    w.step = threads_to_use;
+    threads.create_thread(w);
+  }
 
-std::string VerilogModuleGenerator::generate_common() const {
-  std::set<GateTemplate_shptr> already_dumped;
-  return generate_common_code_for_gates(mod, already_dumped);
+  std::string error;
+
+  for(size_t i = 0; i < modules.size() && error.empty(); i++) {
+    std::string code;
+    {
+      boost::mutex::scoped_lock lock(buffers.mutex);
+      while(!buffers.done[i]) buffers.cond.wait(lock);
+      code.swap(buffers.code[i]);
+      error = buffers.errors[i];
+      if(!error.empty()) buffers.abort = true;
+    }
+    os << code;
+  }
+
+  threads.join_all();
+
+  if(!error.empty()) throw DegateRuntimeException(error);
 }
 
-std::string VerilogModuleGenerator::generate_impl(std::string const& logic_class /* unused parameter */ ) const {
-  
-  std::string impl;
-  std::string wire_definitions;
+
+void VerilogModuleGenerator::write_impl(std::ostream & os) const {
 
   unsigned int wire_counter = 0;
 
-  typedef std::map<object_id_t /* net */, std::string> net_names_table;
-  net_names_table nets;
+  // net object ID -> name
+  DenseObjectMap<NetName> nets;
+
+  // Index the module ports by their gate port, so that there is no need to
+  // search the module ports for each gate port. If a gate port is adjacent to
+  // multiple module ports, the first name wins as in lookup_module_port_name().
+  DenseObjectMap<std::string const *> module_port_names;
+  for(Module::port_collection::const_iterator iter = mod->ports_begin();
+      iter != mod->ports_end(); ++iter)
+    module_port_names.insert(std::make_pair(iter->second->get_object_id(), &iter->first));
 
 
   // generate signal names
@@ -113,21 +278,24 @@ std::string VerilogModuleGenerator::generate_impl(std::string const& logic_class
       iter != mod->gates_end(); ++iter) {
 
     Gate_shptr gate = *iter;
-    GateTemplate_shptr gate_tmpl = gate->get_gate_template();
     for(Gate::port_const_iterator p_iter = gate->ports_begin(); p_iter != gate->ports_end(); ++p_iter) {
       const GatePort_shptr gport = *p_iter;
       if(gport->is_connected()) {
-	const Net_shptr net = gport->get_net();
+	const object_id_t net_id = gport->get_net()->get_object_id();
 	
 	// first, check if the gate port is directly adjacent to a module port
-	boost::optional<std::string> is_module_port = mod->lookup_module_port_name(gport);
-	if(is_module_port) {
-	  nets[net->get_object_id()] = *is_module_port;
+	DenseObjectMap<std::string const *>::const_iterator is_module_port =
+	  module_port_names.find(gport->get_object_id());
+	if(is_module_port != module_port_names.end()) {
+	  NetName & n = nets[net_id];
+	  n.name = is_module_port->second;
+	  n.is_module_port = true;
 	}
-	else if(nets.find(net->get_object_id()) == nets.end()) {
-	  boost::format f("w%1%");
-	  f % (wire_counter++);
-	  nets[net->get_object_id()] = f.str();
+	else if(nets.find(net_id) == nets.end()) {
+	  NetName & n = nets[net_id];
+	  n.name = NULL;
+	  n.wire = wire_counter++;
+	  n.is_module_port = false;
 	}
       }
     }
@@ -138,68 +306,76 @@ std::string VerilogModuleGenerator::generate_impl(std::string const& logic_class
       iter != mod->modules_end(); ++iter) {
 
     Module_shptr sub = *iter;
-    std::list<std::string> ports;
 
     // iterate over its module ports
     for(Module::port_collection::const_iterator p_iter = sub->ports_begin();
 	p_iter != sub->ports_end(); ++p_iter) {
 
-      std::string const& submod_port_name= p_iter->first;
       const GatePort_shptr gport = p_iter->second;
 
       if(gport->is_connected()) {
-	const Net_shptr net = gport->get_net();
-
-	nets[net->get_object_id()] = submod_port_name;
+	NetName & n = nets[gport->get_net()->get_object_id()];
+	n.name = &p_iter->first;
+	n.is_module_port = false;
       }
     }
   }
 
 
-  // genereate wire definitions
-  BOOST_FOREACH(net_names_table::value_type const& v, nets) {
-    if(!mod->exists_module_port_name(v.second)) 
-      wire_definitions += "  wire " + v.second + ";\n";
+  // genereate wire definitions in the order of the net object IDs
+  std::ostringstream wire_definitions;
+  BOOST_FOREACH(object_id_t net_id, nets.get_ordered_keys()) {
+    NetName const& n = nets.find(net_id)->second;
+    if(!n.is_module_port && !mod->exists_module_port_name(n.str()))
+      wire_definitions << "  wire " << n << ";\n";
   }
 
+  if(wire_definitions.tellp() > 0)
+    os << "  // net definitions\n" << wire_definitions.str();
+  os << "\n"
+     << "  // sub-modules\n\n";
+
 
-  
   // place single standard cells
 
+  // Identifiers depend on the gate template and the template port only.
+  std::map<GateTemplate_shptr, std::string> template_identifiers;
+  std::map<GateTemplatePort_shptr, std::string> port_identifiers;
+
   for(Module::gate_collection::const_iterator iter = mod->gates_begin();
       iter != mod->gates_end(); ++iter) {
 
     Gate_shptr gate = *iter;
     GateTemplate_shptr gate_tmpl = gate->get_gate_template();
-    
-    std::list<std::string> ports;
+    if(gate_tmpl == NULL)
+      throw DegateRuntimeException("Failed to generate code for gate " + gate->get_descriptive_identifier() +
+				   ", because it has no template.");
+
+    std::string & tmpl_identifier = template_identifiers[gate_tmpl];
+    if(tmpl_identifier.empty()) tmpl_identifier = generate_identifier(gate_tmpl->get_name(), "dg_");
 
+    os << "  " << tmpl_identifier << " " << generate_identifier(gate->get_name()) << " (\n";
+
+    bool first = true;
     for(Gate::port_const_iterator p_iter = gate->ports_begin(); p_iter != gate->ports_end(); ++p_iter) {
       const GatePort_shptr gport = *p_iter;
-      const GateTemplatePort_shptr tmpl_port = gport->get_template_port();
 
       if(gport->is_connected()) {
-	const Net_shptr net = gport->get_net();
-      
-	std::string port_name = generate_identifier(tmpl_port->get_name());
-	std::transform(port_name.begin(), port_name.end(), port_name.begin(), ::tolower);
-	
-	boost::format f("    .%1% (%2%)");
-	f % port_name
-	  % nets[net->get_object_id()];
-	ports.push_back(f.str());
-      }
-    }
+	const GateTemplatePort_shptr tmpl_port = gport->get_template_port();
 
+	std::string & port_name = port_identifiers[tmpl_port];
+	if(port_name.empty()) {
+	  port_name = generate_identifier(tmpl_port->get_name());
+	  std::transform(port_name.begin(), port_name.end(), port_name.begin(), ::tolower);
+	}
 
-    boost::format gate_placement("  %1% %2% (\n"
-				 "%3% );\n\n");
-    gate_placement 
-      % generate_identifier(gate_tmpl->get_name(), "dg_")
-      % generate_identifier(gate->get_name())
-      % boost::algorithm::join(ports, ",\n");
+	os << (first ? "" : ",\n")
+	   << "    ." << port_name << " (" << nets[gport->get_net()->get_object_id()] << ")";
+	first = false;
+      }
+    }
 
-    impl += gate_placement.str();
+    os << " );\n\n";
   }
 
 
@@ -208,42 +384,26 @@ std::string VerilogModuleGenerator::generate_impl(std::string const& logic_class
       iter != mod->modules_end(); ++iter) {
 
     Module_shptr sub = *iter;
-    std::list<std::string> ports;
+
+    os << "  "
+       << generate_identifier(sub->get_entity_name() != "" ? sub->get_entity_name() : sub->get_name() , "dg_")
+       << " " << generate_identifier(sub->get_name()) << " (\n";
+
+    bool first = true;
 
     // iterate over its module ports
     for(Module::port_collection::const_iterator p_iter = sub->ports_begin();
 	p_iter != sub->ports_end(); ++p_iter) {
 
-      std::string const& submod_port_name= p_iter->first;
       const GatePort_shptr gport = p_iter->second;
 
       if(gport->is_connected()) {
-	const Net_shptr net = gport->get_net();
-      
-	boost::format f("    .%1% (%2%)");
-	f % submod_port_name
-	  % nets[net->get_object_id()];
-	ports.push_back(f.str());
+	os << (first ? "" : ",\n")
+	   << "    ." << p_iter->first << " (" << nets[gport->get_net()->get_object_id()] << ")";
+	first = false;
       }
     }
 
-    
-    boost::format gate_placement("  %1% %2% (\n"
-				 "%3% );\n\n");
-    gate_placement 
-      % generate_identifier(sub->get_entity_name() != "" ? sub->get_entity_name() : sub->get_name() , "dg_")
-      % generate_identifier(sub->get_name())
-      % boost::algorithm::join(ports, ",\n");
-
-    impl += gate_placement.str();
-    
+    os << " );\n\n";
   }
-
-
-  // place sub-modules
-  return 
-    (wire_definitions != "" ? "  // net definitions\n" : "") +
-    wire_definitions + "\n" + 
-    "  // sub-modules\n\n" +
-    impl;
 }
@@ -29,18 +29,57 @@
 
 namespace degate {
 
+  /**
+   * Generates Verilog code for a module, its sub-modules and the gates
+   * that are used in the module hierarchy.
+   *
+   * The code can be written directly into a stream, e.g. a file, so that
+   * large modules do not have to be assembled in memory. The definitions
+   * of sub-modules are independent from each other. They are generated in
+   * parallel and written in a fixed order, therefore the output does not
+   * depend on the number of threads.
+   */
+
   class VerilogModuleGenerator : public VerilogCodeTemplateGenerator {
     
   private:
 
     Module_shptr mod;
     bool no_gates;
+    unsigned int num_threads;
 
   public:
     
-    VerilogModuleGenerator(Module_shptr module, bool do_not_output_gates = false);
+    /**
+     * Create a code generator for a module.
+     * @param module The module.
+     * @param do_not_output_gates If true, the Verilog implementations of the
+     *   gate templates are not part of the generated code.
+     * @param num_threads The number of threads, that generate sub-module
+     *   definitions. Use 0 for the number of available processors.
+     */
+    VerilogModuleGenerator(Module_shptr module, bool do_not_output_gates = false,
+			   unsigned int num_threads = 0);
     
     virtual ~VerilogModuleGenerator();
+
+    using VerilogCodeTemplateGenerator::generate;
+
+    /**
+     * Write the code into a stream. This is the same code, that generate() returns.
+     */
+    void generate(std::ostream & os) const;
+
+    /**
+     * Write the definition of the module into a stream. In contrast to generate(),
+     * gate implementations and sub-module definitions are not written.
+     */
+    void generate_definition(std::ostream & os) const;
+
+    /**
+     * Set the number of threads, that generate sub-module definitions.
+     */
+    void set_num_threads(unsigned int n) { num_threads = n; }
     
   protected:
     
@@ -50,7 +89,11 @@ namespace degate {
 
   private:
 
-    std::string generate_common_code_for_gates(Module_shptr module, std::set<GateTemplate_shptr> & already_dumped) const;
+    void write_common(std::ostream & os) const;
+
+    void write_impl(std::ostream & os) const;
+
+    void write_submodule_definitions(std::ostream & os, std::vector<Module_shptr> const& modules) const;
   };
 
 
@@ -142,9 +142,7 @@ namespace degate {
       return Circle::in_shape(x, y, max_distance);
     }
 
-  protected:
-
-    virtual object_id_t push_object_to_server(std::string const& server_url);
+    virtual void get_push_command(std::vector<xmlrpc_c::value> & command);
 
   };
 
@@ -29,7 +29,9 @@
 using namespace degate;
 
 ViaMatching::ViaMatching() :
-  threshold_match(0.9) {
+  threshold_match(0.9),
+  via_diameter(0),
+  merge_n_vias(0) {
 }
 
 
@@ -47,6 +49,8 @@ void ViaMatching::init(BoundingBox const& bounding_box, Project_shptr project) {
   if(layer == NULL)
     throw DegateRuntimeException("No current layer in project.");
 
+  layer_pos = layer->get_layer_pos();
+
 
   ScalingManager_shptr sm = layer->get_scaling_manager();
   assert(sm != NULL);
@@ -54,44 +58,27 @@ void ViaMatching::init(BoundingBox const& bounding_box, Project_shptr project) {
   img = sm->get_image(1).second;
   assert(img != NULL);
 
-  reset_progress();
-}
-
-
-void ViaMatching::set_diameter(unsigned int diameter) {
-  via_diameter = diameter;
-}
-
-void ViaMatching::set_threshold_match(double threshold_match) {
-  this->threshold_match = threshold_match;
-}
-
-void ViaMatching::set_merge_n_vias(unsigned int merge_n_vias) {
-  this->merge_n_vias = merge_n_vias;
-}
+  begin_transaction(lmodel);
 
-double ViaMatching::get_threshold_match() const {
-  return threshold_match;
-}
+  grab_via_images();
 
-unsigned int ViaMatching::get_merge_n_vias() const {
-  return merge_n_vias;
+  reset_progress();
 }
 
-void ViaMatching::run() {
-
-  if(via_diameter == 0) throw DegateLogicException("Parameter via diameter was not set.");
+void ViaMatching::grab_via_images() {
 
   unsigned int max_r = 0;
 
-  // lists for images of vias on the current layer
-  std::list<MemoryImage_shptr> vias_up, vias_down;
+  vias_up.clear();
+  vias_down.clear();
+
+  LogicModelSnapshot::entry_list const& entries =
+    get_snapshot()->get_entries(layer_pos);
 
   // iterate over all placed vias (current layer) and determine their size
-  for(LogicModel::via_collection::iterator viter = lmodel->vias_begin();
-      viter != lmodel->vias_end(); ++viter) {
-    Via_shptr via = viter->second;
-    if(via->get_layer() == layer && via->get_diameter() > max_r) 
+  BOOST_FOREACH(LogicModelSnapshot::Entry const& e, entries) {
+    Via_shptr via = std::tr1::dynamic_pointer_cast<Via>(e.object);
+    if(via != NULL && via->get_diameter() > max_r)
       max_r = via->get_diameter();
   }
   
@@ -100,16 +87,15 @@ void ViaMatching::run() {
   int max_count_up = merge_n_vias, max_count_down = merge_n_vias;
   max_r = (max_r + 1) / 2;
 
-  // iterate over all placed vias (current layer) and calculate a mean-image
-  for(LogicModel::via_collection::iterator viter = lmodel->vias_begin();
-      viter != lmodel->vias_end(); ++viter) {
-    Via_shptr via = viter->second;
+  // iterate over all placed vias (current layer) and grab their images
+  BOOST_FOREACH(LogicModelSnapshot::Entry const& e, entries) {
+    Via_shptr via = std::tr1::dynamic_pointer_cast<Via>(e.object);
 
-    if(via->get_layer() == layer) {
+    if(via != NULL) {
       
-      // calculate new bounding box
-      BoundingBox bb(via->get_x() - max_r, via->get_x() + max_r,
-		     via->get_y() - max_r, via->get_y() + max_r);
+      // calculate new bounding box, the snapshot's box is centered on the via
+      BoundingBox bb(e.bbox.get_center_x() - max_r, e.bbox.get_center_x() + max_r,
+		     e.bbox.get_center_y() - max_r, e.bbox.get_center_y() + max_r);
 
       if(layer->get_bounding_box().complete_within(bb)) {
 
@@ -129,6 +115,32 @@ void ViaMatching::run() {
       else debug(TM, "via out of region");
     }
   }
+}
+
+
+void ViaMatching::set_diameter(unsigned int diameter) {
+  via_diameter = diameter;
+}
+
+void ViaMatching::set_threshold_match(double threshold_match) {
+  this->threshold_match = threshold_match;
+}
+
+void ViaMatching::set_merge_n_vias(unsigned int merge_n_vias) {
+  this->merge_n_vias = merge_n_vias;
+}
+
+double ViaMatching::get_threshold_match() const {
+  return threshold_match;
+}
+
+unsigned int ViaMatching::get_merge_n_vias() const {
+  return merge_n_vias;
+}
+
+void ViaMatching::run() {
+
+  if(via_diameter == 0) throw DegateLogicException("Parameter via diameter was not set.");
 
   debug(TM, "via matching: size of vias_down=%d vias_up=%d", vias_down.size(), vias_up.size());
 
@@ -157,15 +169,19 @@ void ViaMatching::run() {
   if(via_up_gs) save_image(join_pathes("/tmp", "02_via_up_gs.tif"), via_up_gs);
   if(via_down_gs) save_image(join_pathes("/tmp", "02_via_down_gs.tif"), via_down_gs);
 
-  // set progress step size
+  // each scan is a subtask
   int substeps = 0;
   if(via_up_gs) substeps++;
   if(via_down_gs) substeps++;
-  if(substeps > 0) set_progress_step_size(1.0/( substeps * (bounding_box.get_height()-max_r*2) ));
+  if(substeps > 0) get_progress_task()->set_total(substeps);
 
   // run via matching
-  if(via_up_gs) scan(bounding_box, img, via_up_gs, Via::DIRECTION_UP);
-  if(via_down_gs) scan(bounding_box, img, via_down_gs, Via::DIRECTION_DOWN);
+  if(via_up_gs)
+    scan(bounding_box, img, via_up_gs, Via::DIRECTION_UP, create_progress_subtask(1));
+  if(via_down_gs && !is_canceled())
+    scan(bounding_box, img, via_down_gs, Via::DIRECTION_DOWN, create_progress_subtask(1));
+
+  end_transaction(lmodel);
 
 }
 
@@ -203,8 +219,9 @@ bool ViaMatching::add_via(unsigned int x, unsigned int y,
 			  Via::DIRECTION direction,
 			  double corr_val, double threshold_hc) {
 
-  if(!layer->exists_type_in_region<Via>(x, x + diameter,
-					y, y + diameter)) {
+  if(!get_snapshot()->exists_type_in_region<Via>(layer_pos,
+						 x, x + diameter,
+						 y, y + diameter)) {
 
     Via_shptr via(new Via(x + diameter/2, y + diameter/2, diameter, direction));
 
@@ -212,16 +229,19 @@ bool ViaMatching::add_via(unsigned int x, unsigned int y,
     snprintf(dsc, sizeof(dsc), "matched with corr=%.2f t_hc=%.2f", corr_val, threshold_hc);
     via->set_description(dsc);
 
-    lmodel->add_object(layer, via);
+    get_transaction()->add_object(layer_pos, via, LogicModelTransaction::SKIP_IF_OCCUPIED);
+    get_snapshot()->add_object(layer_pos, via);
     return true;
   }
   return false;
 }
 
 void ViaMatching::scan(BoundingBox const& bbox, BackgroundImage_shptr bg_img,
-		       MemoryImage_GS_BYTE_shptr tmpl_img, Via::DIRECTION direction) {
+		       MemoryImage_GS_BYTE_shptr tmpl_img, Via::DIRECTION direction,
+		       ProgressTask_shptr task) {
 
   std::list<match_found> matches;
+  CancellationToken_shptr token = get_cancellation_token();
   
   debug(TM, "run scanning");
   double f_avg, sigma_f;
@@ -238,6 +258,8 @@ void ViaMatching::scan(BoundingBox const& bbox, BackgroundImage_shptr bg_img,
   int max_y = static_cast<unsigned int>(bbox.get_max_y()) > tmpl_img->get_height() ? 
     bbox.get_max_y() - tmpl_img->get_height() : bbox.get_min_y();
 
+  task->set_total(max_y > bbox.get_min_y() ? max_y - bbox.get_min_y() : 1);
+
   for(int y = bbox.get_min_y(); y < max_y; y++) {
     for(int x = bbox.get_min_x(); x < max_x; x++) {
 
@@ -261,13 +283,10 @@ void ViaMatching::scan(BoundingBox const& bbox, BackgroundImage_shptr bg_img,
     }
 
     // update progress
-    progress_step_done();
+    task->advance();
 
     // check if scanning was canceled
-    if(is_canceled()) {
-      reset_progress();
-      return;
-    }
+    if(token->is_canceled()) return;
 
   }
 
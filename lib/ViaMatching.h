@@ -27,6 +27,8 @@
 #include <TemplateMatching.h>
 #include <Via.h>
 
+#include <list>
+
 namespace degate {
 
   class ViaMatching : public Matching {
@@ -34,6 +36,7 @@ namespace degate {
   private:
 
     Layer_shptr layer;
+    layer_position_t layer_pos;
     LogicModel_shptr lmodel;
 
     double threshold_match;
@@ -42,6 +45,9 @@ namespace degate {
 
     BoundingBox bounding_box;
 
+    // images of the placed vias, that are averaged to via templates
+    std::list<MemoryImage_shptr> vias_up, vias_down;
+
   public:
 
     typedef struct {
@@ -62,7 +68,8 @@ namespace degate {
     virtual void init(BoundingBox const& bounding_box, Project_shptr project);
 
     /**
-     * Run the algorithm.
+     * Run the algorithm. It does not read from the logic model or the
+     * layers, except for the background image.
      * @exception DegateLogicException This exception is thrown, if the diameter was not set.
      */
     virtual void run();
@@ -78,8 +85,20 @@ namespace degate {
     void set_diameter(unsigned int diameter);
 
   private:
+
+    /**
+     * Grab the images of the placed vias on the current layer. This is
+     * done in init(), because it reads the vias and the layer.
+     */
+    void grab_via_images();
+
+    /**
+     * Scan a region for vias.
+     * @param task The scan reports a work unit per scanned row to this task.
+     */
     void scan(BoundingBox const& bbox, BackgroundImage_shptr bg_img, 
-	      MemoryImage_GS_BYTE_shptr tmpl_img, Via::DIRECTION direction);
+	      MemoryImage_GS_BYTE_shptr tmpl_img, Via::DIRECTION direction,
+	      ProgressTask_shptr task);
 
     bool add_via(unsigned int x, unsigned int y,
 		 unsigned int diameter,
@@ -56,38 +56,18 @@ const std::string Wire::get_object_type_name() const {
 void Wire::print(std::ostream & os, int n_tabs) const {
 }
 
-object_id_t Wire::push_object_to_server(std::string const& server_url) {
+void Wire::get_push_command(std::vector<xmlrpc_c::value> & command) {
 
-  try {
+  command.push_back(xmlrpc_c::value_string("add"));
+  command.push_back(xmlrpc_c::value_string("wire"));
 
-    xmlrpc_c::paramList params;
-    params.add(xmlrpc_c::value_string("add"));
-    params.add(xmlrpc_c::value_string("wire"));
-
-    Layer_shptr layer = get_layer();
-    assert(layer != NULL);
-    params.add(xmlrpc_c::value_int(layer->get_layer_id()));
-
-    params.add(xmlrpc_c::value_int(get_from_x()));
-    params.add(xmlrpc_c::value_int(get_from_y()));
-    params.add(xmlrpc_c::value_int(get_to_x()));
-    params.add(xmlrpc_c::value_int(get_to_y()));
-    params.add(xmlrpc_c::value_int(get_diameter()));
-
-    int const transaction_id =
-      xmlrpc_c::value_int(remote_method_call(server_url, "degate.push", params));
-
-    set_remote_object_id(transaction_id);
-    std::cout << "Pushed wire to server. remote id is: " << transaction_id << std::endl;
-    return transaction_id;
-  }
-  catch(std::exception const& e) {
-    std::cerr << "Client threw error: " << e.what() << std::endl;
-    throw XMLRPCException(e.what());
-  }
-  catch(...) {
-    std::cerr << "Client threw unexpected error." << std::endl;
-    throw XMLRPCException("Client threw unexpected error.");
-  }
+  Layer_shptr layer = get_layer();
+  assert(layer != NULL);
+  command.push_back(xmlrpc_c::value_int(layer->get_layer_id()));
 
+  command.push_back(xmlrpc_c::value_int(get_from_x()));
+  command.push_back(xmlrpc_c::value_int(get_from_y()));
+  command.push_back(xmlrpc_c::value_int(get_to_x()));
+  command.push_back(xmlrpc_c::value_int(get_to_y()));
+  command.push_back(xmlrpc_c::value_int(get_diameter()));
 }
@@ -96,9 +96,7 @@ namespace degate {
       return Line::in_shape(x, y, max_distance);
     }
 
-  protected:
-
-    virtual object_id_t push_object_to_server(std::string const& server_url);
+    virtual void get_push_command(std::vector<xmlrpc_c::value> & command);
 
   };
 
@@ -55,6 +55,8 @@ void WireMatching::init(BoundingBox const& bounding_box, Project_shptr project)
 
   img = sm->get_image(1).second;
   assert(img != NULL);
+
+  begin_transaction(lmodel);
 }
 
 
@@ -105,8 +107,10 @@ void WireMatching::run() {
 			  bounding_box.get_min_y() + ls->get_to_y(),
 			  wire_diameter));
 
-    lmodel->add_object(layer->get_layer_pos(), w);
+    get_transaction()->add_object(layer->get_layer_pos(), w);
   }
 
+  end_transaction(lmodel);
+
 }
 
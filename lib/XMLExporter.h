@@ -24,6 +24,7 @@
 
 #include "globals.h"
 #include "Exporter.h"
+#include "ExportBuffer.h"
 #include <libxml++/libxml++.h>
 
 namespace degate {
@@ -33,6 +34,23 @@ namespace degate {
    */
   class XMLExporter : public Exporter {
 
+  private:
+
+    ExportBuffer_shptr export_buffer;
+
+  protected:
+
+    /**
+     * Write a document to a file. If there is an export buffer, the
+     * document is handed over to the buffer instead.
+     */
+    void write_document(XMLDocument_shptr doc, std::string const& filename) {
+      if(export_buffer != NULL)
+	export_buffer->add_document(filename, doc);
+      else
+	doc->write_to_file_formatted(filename, "ISO-8859-1");
+    }
+
   public:
     /**
      * The ctor.
@@ -43,6 +61,18 @@ namespace degate {
      * The dtor.
      */
     virtual ~XMLExporter() {};
+
+    /**
+     * Collect the output in a buffer instead of writing files.
+     * @see ExportBuffer
+     */
+    void set_export_buffer(ExportBuffer_shptr buffer) { export_buffer = buffer; }
+
+    /**
+     * Get the export buffer.
+     * @return Returns a NULL pointer, if files are written directly.
+     */
+    ExportBuffer_shptr get_export_buffer() const { return export_buffer; }
   };
 
 }
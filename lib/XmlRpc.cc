@@ -22,61 +22,222 @@
 #include <XmlRpc.h>
 #include <Wire.h>
 #include <Via.h>
+#include <EMarker.h>
 
 #include <boost/foreach.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <algorithm>
+#include <map>
 
 using namespace degate;
 using namespace std;
 
+namespace {
 
-xmlrpc_c::value degate::remote_method_call(std::string const& server_url,
-					   std::string const& method_name,
+  /**
+   * The maximum number of commands, that are sent with a single request.
+   */
+  const size_t max_batch_size = 500;
+
+  boost::mutex connections_mtx;
+  std::map<std::string, XmlRpcConnection_shptr> connections;
+
+  xmlrpc_c::paramList make_param_list(xmlrpc_command const& command) {
+    xmlrpc_c::paramList params;
+    BOOST_FOREACH(xmlrpc_c::value const& v, command) params.add(v);
+    return params;
+  }
+
+  /**
+   * Send a range of commands with a single degate.push_batch request.
+   */
+  void push_batch(XmlRpcConnection_shptr conn,
+		  xmlrpc_command_list const& commands, size_t begin, size_t end,
+		  std::vector<transaction_id_t> & tids) {
+
+    std::vector<xmlrpc_c::value> batch;
+    batch.reserve(end - begin);
+    for(size_t i = begin; i < end; i++) batch.push_back(xmlrpc_c::value_array(commands[i]));
+
+    xmlrpc_c::paramList params;
+    params.add(xmlrpc_c::value_array(batch));
+
+    std::vector<xmlrpc_c::value> ret =
+      xmlrpc_c::value_array(conn->call("degate.push_batch", params)).vectorValueValue();
+
+    if(ret.size() != end - begin)
+      throw XMLRPCException("The server returned an unexpected number of transaction IDs.");
+
+    BOOST_FOREACH(xmlrpc_c::value const& v, ret)
+      tids.push_back(xmlrpc_c::value_int(v));
+  }
+}
+
+
+CurlXmlRpcConnection::CurlXmlRpcConnection(std::string const& server_url) :
+  client(&transport),
+  carriage_param(server_url) {
+}
+
+xmlrpc_c::value CurlXmlRpcConnection::call(std::string const& method_name,
 					   xmlrpc_c::paramList const& params) {
 
-  xmlrpc_c::clientXmlTransport_curl myTransport;
-  xmlrpc_c::client_xml myClient(&myTransport);
+  boost::lock_guard<boost::mutex> lock(mtx);
 
   xmlrpc_c::rpcPtr myRpcP(method_name, params);
-  xmlrpc_c::carriageParm_curl0 myCarriageParam(server_url);
-
-  myRpcP->call(&myClient, &myCarriageParam);
+  myRpcP->call(&client, &carriage_param);
 
   assert(myRpcP->isFinished());
 
+  if(!myRpcP->isSuccessful()) {
+    xmlrpc_c::fault const f = myRpcP->getFault();
+
+    // xmlrpc-c servers report unknown methods with code -506,
+    // Frontier::RPC2 as used by tools/xmlrpc-server-cgi with code 3.
+    if(f.getCode() == xmlrpc_c::fault::CODE_NO_SUCH_METHOD || f.getCode() == 3)
+      throw XMLRPCNoSuchMethodException(f.getDescription());
+    throw XMLRPCException(f.getDescription());
+  }
+
   return myRpcP->getResult();
 }
 
 
-void degate::push_changes_to_server(std::string const& server_url, LogicModel_shptr lmodel) {
+XmlRpcConnection_shptr degate::get_xmlrpc_connection(std::string const& server_url) {
+
+  boost::lock_guard<boost::mutex> lock(connections_mtx);
+
+  XmlRpcConnection_shptr & conn = connections[server_url];
+  if(conn == NULL) conn = XmlRpcConnection_shptr(new CurlXmlRpcConnection(server_url));
+  return conn;
+}
+
+
+xmlrpc_c::value degate::remote_method_call(std::string const& server_url,
+					   std::string const& method_name,
+					   xmlrpc_c::paramList const& params) {
+
+  return get_xmlrpc_connection(server_url)->call(method_name, params);
+}
 
-  // iterate over gates
-  for(LogicModel::object_collection::iterator iter = lmodel->objects_begin();
-      iter != lmodel->objects_end(); ++iter) {
 
-    object_id_t local_oid = iter->second->get_object_id();
+void degate::push_commands(XmlRpcConnection_shptr conn,
+			   xmlrpc_command_list const& commands,
+			   std::vector<transaction_id_t> & tids) {
 
-    if(RemoteObject_shptr ro = std::tr1::dynamic_pointer_cast<RemoteObject>((*iter).second)) {
+  if(conn == NULL) throw InvalidPointerException("Invalid connection.");
 
-      if(!ro->has_remote_object_id()) {
-	std::cout << "Push object to server." << std::endl;
-	object_id_t remote_oid = ro->push(server_url);
+  tids.reserve(tids.size() + commands.size());
 
-	lmodel->update_roid_mapping(remote_oid, local_oid);
+  try {
+    size_t pos = 0;
+    while(pos < commands.size()) {
+
+      if(conn->supports_batches() && commands.size() - pos > 1) {
+	size_t end = std::min(pos + max_batch_size, commands.size());
+	try {
+	  push_batch(conn, commands, pos, end, tids);
+	  pos = end;
+	}
+	catch(XMLRPCNoSuchMethodException const& e) {
+	  // Older servers do not implement degate.push_batch. The server
+	  // rejected the request, so it is safe to send the commands again.
+	  debug(TM, "XMLRPC: batch push not supported (%s). Falling back to single commands.", e.what());
+	  conn->disable_batches();
+	}
+      }
+      else {
+	tids.push_back(xmlrpc_c::value_int(conn->call("degate.push", make_param_list(commands[pos]))));
+	pos++;
       }
     }
   }
+  catch(XMLRPCException const& e) {
+    throw;
+  }
+  catch(exception const& e) {
+    cerr << "Client threw error: " << e.what() << endl;
+    throw XMLRPCException(e.what());
+  }
+  catch(...) {
+    cerr << "Client threw unexpected error." << endl;
+    throw XMLRPCException("Client threw unexpected error.");
+  }
+}
 
-  BOOST_FOREACH(object_id_t id, lmodel->get_removed_remote_objetcs_list()) {
-    xmlrpc_c::paramList params;
-    params.add(xmlrpc_c::value_string("remove"));
-    params.add(xmlrpc_c::value_int(id));
 
-    remote_method_call(server_url, "degate.push", params);
+/**
+ * Record the transaction IDs, that the server returned for pushed changes.
+ * @param local_oids The local object IDs for the first commands.
+ * @param tids The transaction IDs for the confirmed commands. Commands
+ *   for removals follow the commands for objects.
+ */
+static void apply_push_results(LogicModel_shptr lmodel,
+			       std::vector<object_id_t> const& local_oids,
+			       std::vector<transaction_id_t> const& tids) {
+
+  size_t num_adds = std::min(local_oids.size(), tids.size());
+
+  for(size_t i = 0; i < num_adds; i++) {
+    RemoteObject_shptr ro =
+      std::tr1::dynamic_pointer_cast<RemoteObject>(lmodel->get_object(local_oids[i]));
+    ro->set_remote_object_id(tids[i]);
+    lmodel->update_roid_mapping(tids[i], local_oids[i]);
+  }
+
+  lmodel->pop_removed_remote_objects(tids.size() - num_adds);
+}
+
+void degate::push_changes_to_server(XmlRpcConnection_shptr conn, LogicModel_shptr lmodel) {
+
+  if(lmodel == NULL) throw InvalidPointerException("Invalid logic model.");
+
+  // Collect the commands first. Pushing changes the list of unpushed objects.
+  std::vector<object_id_t> local_oids;
+  xmlrpc_command_list commands;
+
+  BOOST_FOREACH(object_id_t local_oid, lmodel->get_unpushed_remote_objects()) {
+    RemoteObject_shptr ro =
+      std::tr1::dynamic_pointer_cast<RemoteObject>(lmodel->get_object(local_oid));
+    assert(ro != NULL);
+
+    commands.push_back(xmlrpc_command());
+    ro->get_push_command(commands.back());
+    local_oids.push_back(local_oid);
+  }
+
+  size_t num_adds = commands.size();
+
+  BOOST_FOREACH(object_id_t id, lmodel->get_removed_remote_objetcs_list()) {
+    xmlrpc_command command;
+    command.push_back(xmlrpc_c::value_string("remove"));
+    command.push_back(xmlrpc_c::value_int(id));
+    commands.push_back(command);
 
     debug(TM, "Send remove message for object with remote ID %d", id);
   }
 
-  lmodel->reset_removed_remote_objetcs_list();
+  if(commands.empty()) return;
+
+  debug(TM, "Push %d objects and %d removals to server.", num_adds, commands.size() - num_adds);
+
+  std::vector<transaction_id_t> tids;
+
+  try {
+    push_commands(conn, commands, tids);
+  }
+  catch(XMLRPCException const&) {
+    // Earlier batches are stored on the server. Don't send them again.
+    apply_push_results(lmodel, local_oids, tids);
+    throw;
+  }
+
+  apply_push_results(lmodel, local_oids, tids);
+}
+
+void degate::push_changes_to_server(std::string const& server_url, LogicModel_shptr lmodel) {
+  push_changes_to_server(get_xmlrpc_connection(server_url), lmodel);
 }
 
 
@@ -98,7 +259,7 @@ void degate::process_changelog_command(LogicModel_shptr lmodel,
     throw XMLRPCException("Command parameter is not a string");
 
   const std::string command_str = xmlrpc_c::value_string(command[0]);
-  std::cout << " cmd: " << command_str << std::endl;
+  debug(TM, "XMLRPC: command %s", command_str.c_str());
 
   if(!command_str.compare("remove")) {
     if(command.size() < 2)
@@ -142,6 +303,20 @@ void degate::process_changelog_command(LogicModel_shptr lmodel,
       Layer_shptr layer = lmodel->get_layer_by_id(layer_id);
       lmodel->add_object(layer, v);
     }
+    else if(!obj_type_str.compare("emarker")) {
+      if(command.size() < 6)
+	throw XMLRPCException("Command emarker add has less then 6 parameters.");
+
+      int layer_id = xmlrpc_c::value_int(command[2]);
+      int x = xmlrpc_c::value_int(command[3]);
+      int y = xmlrpc_c::value_int(command[4]);
+      unsigned int diameter = xmlrpc_c::value_int(command[5]);
+
+      EMarker_shptr e(new EMarker(x, y, diameter));
+      e->set_remote_object_id(transaction_id);
+      Layer_shptr layer = lmodel->get_layer_by_id(layer_id);
+      lmodel->add_object(layer, e);
+    }
   }
 
   /*
@@ -153,15 +328,19 @@ void degate::process_changelog_command(LogicModel_shptr lmodel,
 
 }
 
-transaction_id_t degate::pull_changes_from_server(std::string const& server_url,
+transaction_id_t degate::pull_changes_from_server(XmlRpcConnection_shptr conn,
 						  LogicModel_shptr lmodel,
 						  transaction_id_t start_tid) {
+
+  if(conn == NULL) throw InvalidPointerException("Invalid connection.");
+
   try {
     xmlrpc_c::paramList params;
     params.add(xmlrpc_c::value_int(start_tid));
-    xmlrpc_c::value_array ret(remote_method_call(server_url, "degate.pull", params));
 
-    std::vector<xmlrpc_c::value> v(ret.vectorValueValue());
+    // The server sends all changes since start_tid with a single response.
+    std::vector<xmlrpc_c::value> v =
+      xmlrpc_c::value_array(conn->call("degate.pull", params)).vectorValueValue();
 
     if(start_tid == 0) ++start_tid;
 
@@ -196,3 +375,8 @@ transaction_id_t degate::pull_changes_from_server(std::string const& server_url,
   return start_tid;
 }
 
+transaction_id_t degate::pull_changes_from_server(std::string const& server_url,
+						  LogicModel_shptr lmodel,
+						  transaction_id_t start_tid) {
+  return pull_changes_from_server(get_xmlrpc_connection(server_url), lmodel, start_tid);
+}
@@ -27,8 +27,92 @@
 #include <xmlrpc-c/base.hpp>
 #include <xmlrpc-c/client_simple.hpp>
 
+#include <boost/thread/mutex.hpp>
+
+#include <vector>
+#include <tr1/memory>
+
 namespace degate {
 
+  typedef std::vector<xmlrpc_c::value> xmlrpc_command;
+  typedef std::vector<xmlrpc_command> xmlrpc_command_list;
+
+  /**
+   * A connection to a collaboration server.
+   *
+   * Implementations keep their transport alive between calls. Use
+   * get_xmlrpc_connection() to get a shared connection for a server URL.
+   * Tests can derive from this class to provide a local stand-in server.
+   */
+
+  class XmlRpcConnection {
+
+  private:
+
+    bool batches_supported;
+
+  public:
+
+    XmlRpcConnection() : batches_supported(true) {}
+
+    virtual ~XmlRpcConnection() {}
+
+    /**
+     * Call a remote method.
+     * @exception XMLRPCNoSuchMethodException Implementations throw this exception,
+     *   if the server answered, that it does not know the method.
+     * @exception std::exception Implementations throw an exception derived
+     *   from std::exception, if the call fails otherwise.
+     */
+    virtual xmlrpc_c::value call(std::string const& method_name,
+				 xmlrpc_c::paramList const& params) = 0;
+
+    /**
+     * Check if the server is assumed to understand degate.push_batch.
+     */
+    bool supports_batches() const { return batches_supported; }
+
+    /**
+     * Remember, that the server does not understand degate.push_batch.
+     */
+    void disable_batches() { batches_supported = false; }
+  };
+
+  typedef std::tr1::shared_ptr<XmlRpcConnection> XmlRpcConnection_shptr;
+
+
+  /**
+   * A connection via HTTP. The curl transport and the client are created
+   * once, so that the HTTP connection can be reused between calls.
+   */
+
+  class CurlXmlRpcConnection : public XmlRpcConnection {
+
+  private:
+
+    xmlrpc_c::clientXmlTransport_curl transport;
+    xmlrpc_c::client_xml client;
+    xmlrpc_c::carriageParm_curl0 carriage_param;
+    boost::mutex mtx;
+
+  public:
+
+    CurlXmlRpcConnection(std::string const& server_url);
+
+    virtual ~CurlXmlRpcConnection() {}
+
+    virtual xmlrpc_c::value call(std::string const& method_name,
+				 xmlrpc_c::paramList const& params);
+  };
+
+
+  /**
+   * Get a connection for a server URL. Connections are created on the
+   * first request and reused afterwards.
+   */
+
+  XmlRpcConnection_shptr get_xmlrpc_connection(std::string const& server_url);
+
   /**
    * Convinience method to call remote methods.
    */
@@ -37,8 +121,36 @@ namespace degate {
 				     std::string const& method_name,
 				     xmlrpc_c::paramList const& params);
 
+  /**
+   * Send commands to the server. Commands are sent in batches via
+   * degate.push_batch. If the server does not know this method, the
+   * commands are sent one by one via degate.push. Other errors are not
+   * retried, because the server might have applied the commands.
+   * @param conn The connection.
+   * @param commands The commands.
+   * @param tids The transaction IDs of the commands are appended to this
+   *   list as soon as the server confirmed them. If an exception is thrown,
+   *   the list holds the IDs of the commands, that were applied before.
+   * @exception XMLRPCException This exception is thrown, if the XMLRPC fails.
+   */
+
+  void push_commands(XmlRpcConnection_shptr conn,
+		     xmlrpc_command_list const& commands,
+		     std::vector<transaction_id_t> & tids);
+
+  /**
+   * Push objects from the logic model to a remote server. Only objects from
+   * the logic model's list of unpushed remote objects and removals are sent.
+   * If the push fails, the changes, that the server confirmed before, are
+   * recorded anyway, so that they are not sent again.
+   * @exception XMLRPCException This exception is thrown, if the XMLRPC fails for some reason.
+   */
+
+  void push_changes_to_server(XmlRpcConnection_shptr conn, LogicModel_shptr lmodel);
+
   /**
    * Push objects from the logic model to a remote server.
+   * @see push_changes_to_server(XmlRpcConnection_shptr, LogicModel_shptr)
    */
 
   void push_changes_to_server(std::string const& server_url, LogicModel_shptr lmodel);
@@ -48,6 +160,14 @@ namespace degate {
    * @exception XMLRPCException This exception is thrown, if the XMLRPC fails for some reason.
    */
 
+  transaction_id_t pull_changes_from_server(XmlRpcConnection_shptr conn, LogicModel_shptr lmodel,
+					    transaction_id_t start_tid);
+
+  /**
+   * Pull objects from a remote server into the logic model.
+   * @see pull_changes_from_server(XmlRpcConnection_shptr, LogicModel_shptr, transaction_id_t)
+   */
+
   transaction_id_t pull_changes_from_server(std::string const& server_url, LogicModel_shptr lmodel,
 					    transaction_id_t start_tid);
 
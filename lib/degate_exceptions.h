@@ -201,6 +201,15 @@ namespace degate {
     XMLRPCException(std::string const & str) : DegateRuntimeException(str) {}
   };
 
+  /**
+   * Exception for XMLRPC calls to methods, that the server does not implement.
+   */
+  class XMLRPCNoSuchMethodException : public XMLRPCException {
+  public:
+    XMLRPCNoSuchMethodException() : XMLRPCException("The XMLRPC server does not know the method." ) {}
+    XMLRPCNoSuchMethodException(std::string const & str) : XMLRPCException(str) {}
+  };
+
 
 }
 
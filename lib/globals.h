@@ -102,7 +102,14 @@ namespace degate {
   class Net;
   typedef std::tr1::shared_ptr<Net> Net_shptr;
 
+  class NetlistGraph;
+  typedef std::tr1::shared_ptr<NetlistGraph> NetlistGraph_shptr;
+
+  class LogicModelIndex;
+  typedef std::tr1::shared_ptr<LogicModelIndex> LogicModelIndex_shptr;
+
   class Gate;
+  typedef std::tr1::shared_ptr<Gate> Gate_shptr;
 
   class GatePort;
   typedef std::tr1::shared_ptr<GatePort> GatePort_shptr;
@@ -0,0 +1,164 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <Autosaver.h>
+#include <FileSystem.h>
+#include <ImageHelper.h>
+#include <DegateHelper.h>
+#include "AutosaverTest.h"
+
+#include <sys/stat.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (AutosaverTest);
+
+using namespace std;
+using namespace degate;
+
+namespace {
+
+  bool is_same_file(std::string const& path1, std::string const& path2) {
+    struct stat s1, s2;
+    return stat(path1.c_str(), &s1) == 0 && stat(path2.c_str(), &s2) == 0 &&
+      s1.st_dev == s2.st_dev && s1.st_ino == s2.st_ino;
+  }
+
+  Project_shptr create_project() {
+    return Project_shptr(new Project(100, 100, create_temp_directory(), 1));
+  }
+}
+
+void AutosaverTest::setUp(void) {
+}
+
+void AutosaverTest::tearDown(void) {
+}
+
+void AutosaverTest::test_prefix(void) {
+  std::string prefix = Autosaver::get_prefix(time(NULL));
+  CPPUNIT_ASSERT(prefix.size() == 16);
+  CPPUNIT_ASSERT(Autosaver::is_prefix(prefix));
+  CPPUNIT_ASSERT(Autosaver::is_prefix("2010-05-23_1742_"));
+  CPPUNIT_ASSERT(!Autosaver::is_prefix("2010-05-23_1742"));
+  CPPUNIT_ASSERT(!Autosaver::is_prefix("my-notes-lmodel_"));
+}
+
+void AutosaverTest::test_autosave(void) {
+
+  Project_shptr project = create_project();
+  std::string dir = project->get_project_directory();
+  time_t t = time(NULL);
+
+  Autosaver autosaver(5);
+  CPPUNIT_ASSERT(autosaver.start(project, t));
+  autosaver.wait();
+  CPPUNIT_ASSERT(!autosaver.is_running());
+
+  std::string prefix1 = Autosaver::get_prefix(t);
+  CPPUNIT_ASSERT(is_file(join_pathes(dir, prefix1 + "lmodel.xml")));
+  CPPUNIT_ASSERT(is_symlink(join_pathes(dir, ".lmodel.xml")));
+  CPPUNIT_ASSERT(is_same_file(join_pathes(dir, ".lmodel.xml"),
+			      join_pathes(dir, prefix1 + "lmodel.xml")));
+
+  // Unchanged files are hard linked.
+  std::string prefix2 = Autosaver::get_prefix(t + 60);
+  CPPUNIT_ASSERT(autosaver.start(project, t + 60));
+  autosaver.wait();
+
+  CPPUNIT_ASSERT(is_same_file(join_pathes(dir, prefix1 + "lmodel.xml"),
+			      join_pathes(dir, prefix2 + "lmodel.xml")));
+  CPPUNIT_ASSERT(is_same_file(join_pathes(dir, ".lmodel.xml"),
+			      join_pathes(dir, prefix2 + "lmodel.xml")));
+  CPPUNIT_ASSERT(!file_exists(join_pathes(dir, prefix2 + "lmodel.xml.tmp")));
+
+  remove_directory(dir);
+}
+
+void AutosaverTest::test_history(void) {
+
+  Project_shptr project = create_project();
+  std::string dir = project->get_project_directory();
+
+  // a version from an older session and an unrelated file
+  write_string_to_file(join_pathes(dir, "2000-01-01_0000_lmodel.xml"), "old");
+  write_string_to_file(join_pathes(dir, "2000-01-01_0000_project.xml"), "old");
+  write_string_to_file(join_pathes(dir, "notes_lmodel.xml"), "keep");
+
+  time_t t = time(NULL);
+  Autosaver autosaver(2);
+
+  for(unsigned int i = 0; i < 3; i++) {
+    CPPUNIT_ASSERT(autosaver.start(project, t + i * 60));
+    autosaver.wait();
+  }
+
+  CPPUNIT_ASSERT(!file_exists(join_pathes(dir, "2000-01-01_0000_lmodel.xml")));
+  CPPUNIT_ASSERT(!file_exists(join_pathes(dir, "2000-01-01_0000_project.xml")));
+  CPPUNIT_ASSERT(file_exists(join_pathes(dir, "notes_lmodel.xml")));
+
+  CPPUNIT_ASSERT(!file_exists(join_pathes(dir, Autosaver::get_prefix(t) + "lmodel.xml")));
+  CPPUNIT_ASSERT(file_exists(join_pathes(dir, Autosaver::get_prefix(t + 60) + "lmodel.xml")));
+  CPPUNIT_ASSERT(file_exists(join_pathes(dir, Autosaver::get_prefix(t + 120) + "lmodel.xml")));
+  CPPUNIT_ASSERT(file_exists(join_pathes(dir, ".lmodel.xml")));
+
+  remove_directory(dir);
+}
+
+void AutosaverTest::test_template_images(void) {
+
+  Project_shptr project = create_project();
+  std::string dir = project->get_project_directory();
+
+  GateTemplateImage_shptr img(new GateTemplateImage(8, 8));
+  GateTemplate_shptr tmpl(new GateTemplate(8, 8));
+  tmpl->set_image(Layer::LOGIC, img);
+  project->get_logic_model()->add_gate_template(tmpl);
+
+  time_t t = time(NULL);
+  Autosaver autosaver(5);
+
+  CPPUNIT_ASSERT(autosaver.start(project, t));
+
+  // The autosave works on a copy of the image.
+  img->set_pixel(0, 0, MERGE_CHANNELS(255, 0, 0, 255));
+
+  autosaver.wait();
+
+  GateTemplate::ImageFile file1;
+  CPPUNIT_ASSERT(tmpl->get_image_file(Layer::LOGIC, file1));
+  CPPUNIT_ASSERT(is_file(file1.path));
+  CPPUNIT_ASSERT(file1.hash != get_image_hash<GateTemplateImage>(img));
+
+  // The changed image is written again, an unchanged image is not.
+  CPPUNIT_ASSERT(autosaver.start(project, t + 60));
+  autosaver.wait();
+
+  GateTemplate::ImageFile file2;
+  CPPUNIT_ASSERT(tmpl->get_image_file(Layer::LOGIC, file2));
+  CPPUNIT_ASSERT(file2.hash == get_image_hash<GateTemplateImage>(img));
+
+  remove_file(file2.path);
+  CPPUNIT_ASSERT(autosaver.start(project, t + 120));
+  autosaver.wait();
+  CPPUNIT_ASSERT(is_file(file2.path));
+
+  remove_directory(dir);
+}
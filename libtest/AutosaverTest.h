@@ -0,0 +1,50 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __AUTOSAVERTEST_H__
+#define __AUTOSAVERTEST_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class AutosaverTest : public CPPUNIT_NS :: TestFixture {
+
+  CPPUNIT_TEST_SUITE(AutosaverTest);
+
+  CPPUNIT_TEST(test_prefix);
+  CPPUNIT_TEST(test_autosave);
+  CPPUNIT_TEST(test_history);
+  CPPUNIT_TEST(test_template_images);
+
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp(void);
+  void tearDown(void);
+
+ protected:
+  void test_prefix(void);
+  void test_autosave(void);
+  void test_history(void);
+  void test_template_images(void);
+};
+
+#endif
@@ -0,0 +1,181 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <boost/foreach.hpp>
+#include <ImageHistogram.h>
+#include <BackgroundClassifier.h>
+
+#include "BackgroundClassifierTest.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (BackgroundClassifierTest);
+
+using namespace degate;
+
+void BackgroundClassifierTest::setUp(void) {
+}
+
+void BackgroundClassifierTest::tearDown(void) {
+}
+
+
+/*
+ * An image with horizontal reddish wires on a noisy bluish background.
+ */
+static TempImage_RGBA_shptr create_image(unsigned int width, unsigned int height) {
+
+  TempImage_RGBA_shptr img(new TempImage_RGBA(width, height));
+  unsigned int state = 42;
+
+  for(unsigned int y = 0; y < height; y++)
+    for(unsigned int x = 0; x < width; x++) {
+      state = state * 1103515245 + 12345;
+      unsigned int noise = (state >> 16) % 60;
+      bool wire = (y % 20) < 8;
+      img->set_pixel(x, y, wire ?
+		     MERGE_CHANNELS(170 + noise, 90 + noise / 2, 40, 255) :
+		     MERGE_CHANNELS(40, 60 + noise / 2, 120 + noise, 255));
+    }
+  return img;
+}
+
+static std::list<BoundingBox> create_areas(bool wire) {
+  std::list<BoundingBox> areas;
+  if(wire) {
+    areas.push_back(BoundingBox(10, 100, 41, 46));
+    areas.push_back(BoundingBox(150, 250, 101, 106));
+  }
+  else {
+    areas.push_back(BoundingBox(10, 100, 50, 58));
+    areas.push_back(BoundingBox(150, 250, 130, 138));
+  }
+  return areas;
+}
+
+
+/*
+ * The window vote, as the classifier calculated it pixel by pixel.
+ */
+template<typename HistogramType>
+static int reference_vote(TempImage_RGBA_shptr img, HistogramType const& fg, HistogramType const& bg,
+			  unsigned int width, unsigned int threshold, int x, int y) {
+  unsigned int sum = 0;
+  int radius = width >> 1;
+
+  if((x > radius && x < (int)img->get_width() - radius) &&
+     (y > radius && y < (int)img->get_height() - radius)) {
+
+    for(int _y = -radius; _y < radius; _y++)
+      for(int _x = -radius; _x < radius; _x++) {
+	rgba_pixel_t p = img->get_pixel(x + _x, y + _y);
+	if(fg.get_for_rgb(p) > bg.get_for_rgb(p)) sum++;
+      }
+  }
+
+  return sum >= threshold ? 1 : -1;
+}
+
+template<typename HistogramType>
+static void check_recognize(TempImage_RGBA_shptr img, unsigned int width, unsigned int threshold) {
+
+  HistogramType fg, bg;
+  BOOST_FOREACH(BoundingBox const& bb, create_areas(true)) fg.add_area(img, bb);
+  BOOST_FOREACH(BoundingBox const& bb, create_areas(false)) bg.add_area(img, bb);
+
+  BackgroundClassifier<TempImage_RGBA, HistogramType> classifier(img, width, threshold, "test");
+  classifier.add_foreground_areas(create_areas(true));
+  classifier.add_background_areas(create_areas(false));
+
+  unsigned int fg_votes = 0;
+  for(unsigned int y = 0; y < img->get_height(); y += 3)
+    for(unsigned int x = 0; x < img->get_width(); x += 7) {
+      coord_type c(x, y);
+      int vote = classifier.recognize(c);
+      CPPUNIT_ASSERT_EQUAL(reference_vote(img, fg, bg, width, threshold, x, y), vote);
+      if(vote == 1) fg_votes++;
+    }
+
+  // There is something to separate.
+  CPPUNIT_ASSERT(fg_votes > 0);
+}
+
+
+void BackgroundClassifierTest::test_histogram_classes(void) {
+
+  RedChannelImageHistogram red;
+  CPPUNIT_ASSERT(red.get_num_classes() == 256);
+  CPPUNIT_ASSERT(red.get_class(0) == 0);
+  CPPUNIT_ASSERT(red.get_class(255) == 255);
+
+  SaturationImageHistogram sat;
+  CPPUNIT_ASSERT(sat.get_num_classes() == 100);
+  CPPUNIT_ASSERT(sat.get_class(0.075) == 7);
+  CPPUNIT_ASSERT(sat.get_class(1.0) == 99);
+
+  HueImageHistogram hue;
+  CPPUNIT_ASSERT(hue.get_num_classes() == 360);
+  CPPUNIT_ASSERT(hue.get_class(-1) == 0);
+  CPPUNIT_ASSERT(hue.get_class(359.5) == 359);
+
+  red.add(10);
+  red.add(10);
+  red.add(200);
+  CPPUNIT_ASSERT(red.get(10.5) == 2 / 3.0);
+  CPPUNIT_ASSERT(red.get(200) == 1 / 3.0);
+  CPPUNIT_ASSERT(red.get(11) == 0);
+  CPPUNIT_ASSERT(red.get_for_rgb(MERGE_CHANNELS(200, 0, 0, 255)) == 1 / 3.0);
+}
+
+
+void BackgroundClassifierTest::test_recognize(void) {
+
+  // larger than a block of the summed-area tables
+  TempImage_RGBA_shptr img = create_image(300, 200);
+
+  check_recognize<RedChannelImageHistogram>(img, 10, 50);
+  check_recognize<BlueChannelImageHistogram>(img, 10, 50);
+  check_recognize<HueImageHistogram>(img, 10, 50);
+  check_recognize<SaturationImageHistogram>(img, 7, 20);
+  check_recognize<LightnessImageHistogram>(img, 4, 0);
+}
+
+
+void BackgroundClassifierTest::test_classify(void) {
+
+  TempImage_RGBA_shptr img = create_image(300, 200);
+
+  BackgroundClassifier<TempImage_RGBA, HueImageHistogram> classifier(img, 10, 50, "hue");
+  classifier.add_foreground_areas(create_areas(true));
+  classifier.add_background_areas(create_areas(false));
+
+  TempImage_GS_BYTE_shptr result(new TempImage_GS_BYTE(img->get_width(), img->get_height()));
+  classifier.classify(result, 255, 0);
+
+  for(unsigned int y = 0; y < img->get_height(); y++)
+    for(unsigned int x = 0; x < img->get_width(); x++) {
+      coord_type c(x, y);
+      CPPUNIT_ASSERT(result->get_pixel(x, y) == (classifier.recognize(c) == 1 ? 255 : 0));
+    }
+
+  // the center of a wire and the center of the background between two wires
+  CPPUNIT_ASSERT(result->get_pixel(150, 64) == 255);
+  CPPUNIT_ASSERT(result->get_pixel(150, 74) == 0);
+}
@@ -0,0 +1,154 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <ExternalMatching.h>
+#include <DegateHelper.h>
+
+#include "ExternalMatchingTest.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (ExternalMatchingTest);
+
+using namespace degate;
+
+
+static Project_shptr create_project(std::string const& dir) {
+
+  Project_shptr prj(new Project(100, 100, dir, 1));
+  LogicModel_shptr lmodel = prj->get_logic_model();
+  lmodel->set_current_layer(0);
+
+  BackgroundImage_shptr img(new BackgroundImage(100, 100, 5));
+  img->set_pixel(20, 30, 0xffffffff);
+  lmodel->get_current_layer()->set_image(img);
+  return prj;
+}
+
+static std::string create_script(std::string const& dir, std::string const& name,
+				 std::string const& body) {
+  std::string path = join_pathes(dir, name);
+  write_string_to_file(path,
+		       "#!/bin/sh\n"
+		       "while [ $# -gt 0 ]; do\n"
+		       "  case $1 in\n"
+		       "    --results) results=$2; shift;;\n"
+		       "    --buffer) buffer=$2; shift;;\n"
+		       "    --start-x) x=$2; shift;;\n"
+		       "    --start-y) y=$2; shift;;\n"
+		       "  esac\n"
+		       "  shift\n"
+		       "done\n" + body);
+  return "/bin/sh " + path;
+}
+
+static void count_objects(LogicModel_shptr lmodel, unsigned int & vias, unsigned int & wires) {
+  vias = wires = 0;
+  for(LogicModel::object_collection::iterator iter = lmodel->objects_begin();
+      iter != lmodel->objects_end(); ++iter) {
+    if(std::tr1::dynamic_pointer_cast<Via>(iter->second)) vias++;
+    if(std::tr1::dynamic_pointer_cast<Wire>(iter->second)) wires++;
+  }
+}
+
+
+void ExternalMatchingTest::test_protocol_v1(void) {
+
+  Project_shptr prj = create_project(temp_dir);
+
+  ExternalMatching matching;
+  matching.set_command(create_script(temp_dir, "v1.sh",
+				     "echo '# a comment' > $results\n"
+				     "echo 'via 5 6 3 up' >> $results\n"
+				     "echo 'wire 0 10 99 10 2' >> $results\n"));
+  matching.init(BoundingBox(100, 100), prj);
+  matching.run();
+
+  unsigned int vias, wires;
+  count_objects(prj->get_logic_model(), vias, wires);
+  CPPUNIT_ASSERT(matching.get_exit_code() == 0);
+  CPPUNIT_ASSERT(vias == 1 && wires == 1);
+}
+
+
+void ExternalMatchingTest::test_protocol_v2(void) {
+
+  std::string cmd =
+    create_script(temp_dir, "v2.sh",
+		  "[ \"$(head -c 8 $buffer)\" = DGREGION ] || exit 3\n"
+		  // the greyscale value of pixel (20, 30) at 64 + 30 * 100 + 20
+		  "if [ $(od -An -tu1 -j 3084 -N1 $buffer) = 255 ]; then echo 'via 20 30 3 up'; fi\n"
+		  // every tile reports the same objects
+		  "echo 'via 50 50 3 down'\n"
+		  "echo 'wire 0 10 99 10 2'\n");
+
+  for(unsigned int num_workers = 1; num_workers <= 4; num_workers *= 4) {
+
+    Project_shptr prj = create_project(temp_dir);
+
+    ExternalMatching matching;
+    matching.set_command(cmd);
+    matching.set_protocol_version(ExternalMatching::PROTOCOL_V2);
+    matching.set_num_workers(num_workers);
+    matching.set_tile_size(32, 8);
+    matching.set_greyscale(true);
+    matching.init(BoundingBox(100, 100), prj);
+    matching.run();
+
+    // The objects are added once, although 16 tiles report them.
+    unsigned int vias, wires;
+    count_objects(prj->get_logic_model(), vias, wires);
+    CPPUNIT_ASSERT(matching.get_exit_code() == 0);
+    CPPUNIT_ASSERT(vias == 2);
+    CPPUNIT_ASSERT(wires == 1);
+  }
+
+  // an RGBA buffer has another header
+  Project_shptr prj = create_project(temp_dir);
+  ExternalMatching matching;
+  matching.set_command(create_script(temp_dir, "v2_rgba.sh",
+				     "[ $(od -An -tu4 -j 20 -N4 $buffer) = 4 ] || exit 3\n"
+				     "echo \"via $((x + 8)) $((y + 8)) 3 up\"\n"));
+  matching.set_protocol_version(ExternalMatching::PROTOCOL_V2);
+  matching.set_tile_size(64, 8);
+  matching.init(BoundingBox(100, 100), prj);
+  matching.run();
+
+  unsigned int vias, wires;
+  count_objects(prj->get_logic_model(), vias, wires);
+  CPPUNIT_ASSERT(matching.get_exit_code() == 0);
+  CPPUNIT_ASSERT(vias == 4);
+}
+
+
+void ExternalMatchingTest::test_parse_error(void) {
+
+  Project_shptr prj = create_project(temp_dir);
+
+  ExternalMatching matching;
+  matching.set_command(create_script(temp_dir, "error.sh", "echo 'via 1 2'\n"));
+  matching.set_protocol_version(ExternalMatching::PROTOCOL_V2);
+  matching.init(BoundingBox(100, 100), prj);
+  CPPUNIT_ASSERT_THROW(matching.run(), DegateRuntimeException);
+
+  unsigned int vias, wires;
+  count_objects(prj->get_logic_model(), vias, wires);
+  CPPUNIT_ASSERT(vias == 0);
+}
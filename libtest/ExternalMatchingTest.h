@@ -0,0 +1,48 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#ifndef __EXTERNALMATCHINGTEST_H__
+#define __EXTERNALMATCHINGTEST_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "TestHelper.h"
+
+class ExternalMatchingTest : public TempDirectoryTestFixture {
+
+  CPPUNIT_TEST_SUITE(ExternalMatchingTest);
+
+  CPPUNIT_TEST (test_protocol_v1);
+  CPPUNIT_TEST (test_protocol_v2);
+  CPPUNIT_TEST (test_parse_error);
+
+  CPPUNIT_TEST_SUITE_END ();
+
+ protected:
+  void test_protocol_v1 (void);
+  void test_protocol_v2 (void);
+  void test_parse_error (void);
+
+};
+
+#endif
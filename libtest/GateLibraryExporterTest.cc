@@ -71,3 +71,45 @@ void GateLibraryExporterTest::test_export(void) {
   
 }
 
+void GateLibraryExporterTest::test_skip_unchanged_images(void) {
+
+  GateTemplateImage_shptr img(new GateTemplateImage(8, 8));
+  for(unsigned int y = 0; y < 8; y++)
+    for(unsigned int x = 0; x < 8; x++)
+      img->set_pixel(x, y, MERGE_CHANNELS(x * 10, y * 10, 0, 255));
+
+  GateTemplate_shptr tmpl(new GateTemplate(8, 8));
+  tmpl->set_object_id(1);
+  tmpl->set_image(Layer::LOGIC, img);
+
+  GateLibrary_shptr glib(new GateLibrary());
+  glib->add_template(tmpl);
+
+  string directory = create_temp_directory();
+  string out_filename = join_pathes(directory, "gate_library.xml");
+
+  GateLibraryExporter exporter(ObjectIDRewriter_shptr(new ObjectIDRewriter()));
+  exporter.export_data(out_filename, glib);
+  CPPUNIT_ASSERT(exporter.get_num_images_written() == 1);
+  CPPUNIT_ASSERT(exporter.get_num_images_skipped() == 0);
+
+  // nothing changed
+  exporter.export_data(out_filename, glib);
+  CPPUNIT_ASSERT(exporter.get_num_images_written() == 0);
+  CPPUNIT_ASSERT(exporter.get_num_images_skipped() == 1);
+
+  // the content changed
+  img->set_pixel(0, 0, MERGE_CHANNELS(255, 255, 255, 255));
+  exporter.export_data(out_filename, glib);
+  CPPUNIT_ASSERT(exporter.get_num_images_written() == 1);
+
+  // the file was removed
+  GateTemplate::ImageFile file;
+  CPPUNIT_ASSERT(tmpl->get_image_file(Layer::LOGIC, file));
+  remove_file(file.path);
+  exporter.export_data(out_filename, glib);
+  CPPUNIT_ASSERT(exporter.get_num_images_written() == 1);
+  CPPUNIT_ASSERT(file_exists(file.path));
+
+  remove_directory(directory);
+}
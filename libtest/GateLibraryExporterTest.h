@@ -31,6 +31,7 @@ class GateLibraryExporterTest : public CPPUNIT_NS :: TestFixture {
 	CPPUNIT_TEST_SUITE(GateLibraryExporterTest);
 	
 	CPPUNIT_TEST (test_export);
+	CPPUNIT_TEST (test_skip_unchanged_images);
 	
 	CPPUNIT_TEST_SUITE_END ();
 	
@@ -40,6 +41,7 @@ public:
 	
 protected:
 	void test_export(void);
+	void test_skip_unchanged_images(void);
 
 };
 
@@ -0,0 +1,160 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <Geometry.h>
+#include <TangencyCheck.h>
+
+#include "GeometryTest.h"
+
+#include <stdlib.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (GeometryTest);
+
+using namespace degate;
+
+void GeometryTest::setUp(void) {
+}
+
+void GeometryTest::tearDown(void) {
+}
+
+void GeometryTest::test_distances(void) {
+
+  GeoSegment s = make_geo_segment(0, 0, 10, 0, 2);
+  CPPUNIT_ASSERT(geo_distance_sq(s, 5, 3) == 9);
+  CPPUNIT_ASSERT(geo_distance_sq(s, -3, 4) == 25);
+  CPPUNIT_ASSERT(geo_distance_sq(s, 13, 4) == 25);
+
+  // a degenerated segment is a point
+  GeoSegment p = make_geo_segment(1, 1, 1, 1, 0);
+  CPPUNIT_ASSERT(geo_distance_sq(p, 4, 5) == 25);
+
+  GeoRect r = make_geo_rect(0, 10, 0, 10);
+  CPPUNIT_ASSERT(geo_distance_sq(r, 5, 5) == 0);
+  CPPUNIT_ASSERT(geo_distance_sq(r, 13, 14) == 25);
+  CPPUNIT_ASSERT(geo_distance_sq(r, 5, -2) == 4);
+
+  // crossing, touching, collinear and parallel segments
+  CPPUNIT_ASSERT(geo_intersects(make_geo_segment(0, 0, 10, 10, 0), make_geo_segment(0, 10, 10, 0, 0)));
+  CPPUNIT_ASSERT(geo_intersects(make_geo_segment(0, 0, 10, 0, 0), make_geo_segment(5, 0, 5, 10, 0)));
+  CPPUNIT_ASSERT(geo_intersects(make_geo_segment(0, 0, 10, 0, 0), make_geo_segment(10, 0, 20, 0, 0)));
+  CPPUNIT_ASSERT(!geo_intersects(make_geo_segment(0, 0, 10, 0, 0), make_geo_segment(11, 0, 20, 0, 0)));
+  CPPUNIT_ASSERT(!geo_intersects(make_geo_segment(0, 0, 10, 0, 0), make_geo_segment(0, 1, 10, 1, 0)));
+  CPPUNIT_ASSERT(geo_distance_sq(make_geo_segment(0, 0, 10, 0, 0), make_geo_segment(0, 3, 10, 3, 0)) == 9);
+
+  // a segment through a rectangle without an end point in it
+  CPPUNIT_ASSERT(geo_distance_sq(make_geo_segment(-5, 5, 15, 5, 0), r) == 0);
+  CPPUNIT_ASSERT(geo_distance_sq(make_geo_segment(-5, 12, 15, 12, 0), r) == 4);
+}
+
+void GeometryTest::test_touches(void) {
+
+  GeoCircle c1 = make_geo_circle(0, 0, 10);
+  CPPUNIT_ASSERT(geo_touches(c1, make_geo_circle(10, 0, 10)));
+  CPPUNIT_ASSERT(!geo_touches(c1, make_geo_circle(11, 0, 10)));
+  CPPUNIT_ASSERT(geo_touches(c1, make_geo_circle(0, -9, 8)));
+
+  // wires have a width
+  GeoSegment w1 = make_geo_segment(0, 0, 100, 0, 4);
+  CPPUNIT_ASSERT(geo_touches(w1, make_geo_segment(50, 4, 50, 100, 4)));
+  CPPUNIT_ASSERT(!geo_touches(w1, make_geo_segment(50, 5, 50, 100, 4)));
+  CPPUNIT_ASSERT(!geo_touches(w1, make_geo_circle(104, 4, 4)));
+  CPPUNIT_ASSERT(geo_touches(make_geo_circle(102, 2, 4), w1));
+  CPPUNIT_ASSERT(!geo_touches(w1, make_geo_circle(105, 5, 4)));
+
+  GeoRect r = make_geo_rect(0, 10, 0, 10);
+  CPPUNIT_ASSERT(geo_touches(r, make_geo_rect(10, 20, 10, 20)));
+  CPPUNIT_ASSERT(!geo_touches(r, make_geo_rect(11, 20, 0, 20)));
+  CPPUNIT_ASSERT(geo_touches(r, make_geo_circle(13, 5, 6)));
+  CPPUNIT_ASSERT(!geo_touches(r, make_geo_circle(14, 14, 6)));
+  CPPUNIT_ASSERT(geo_touches(make_geo_segment(-10, 12, 20, 12, 4), r));
+  CPPUNIT_ASSERT(!geo_touches(make_geo_segment(-10, 13, 20, 13, 4), r));
+
+  GeoShape s1, s2;
+  s1.type = GeoShape::GEO_CIRCLE;
+  s1.circle = c1;
+  s2.type = GeoShape::GEO_SEGMENT;
+  s2.segment = make_geo_segment(-10, 5, 10, 5, 0);
+  CPPUNIT_ASSERT(geo_touches(s1, s2) && geo_touches(s2, s1));
+  s2.type = GeoShape::GEO_NONE;
+  CPPUNIT_ASSERT(!geo_touches(s1, s2));
+}
+
+void GeometryTest::test_batch(void) {
+
+  srand(7);
+  GeoCircleBatch batch;
+  for(unsigned int i = 0; i < 1001; i++)
+    batch.push_back(make_geo_circle(rand() % 200, rand() % 200, rand() % 30));
+
+  for(unsigned int j = 0; j < 50; j++) {
+
+    GeoCircle probe = make_geo_circle(rand() % 200, rand() % 200, rand() % 30);
+
+    std::vector<unsigned int> hits, expected;
+    geo_find_touching(probe, batch, hits);
+    for(unsigned int i = 0; i < batch.size(); i++)
+      if(geo_touches(probe, batch.get(i))) expected.push_back(i);
+
+    CPPUNIT_ASSERT(hits == expected);
+
+    // the generic version
+    hits.clear();
+    GeoRect r = make_geo_rect(probe.x, probe.x + 20, probe.y, probe.y + 20);
+    geo_find_touching(r, batch, hits);
+    for(unsigned int k = 0; k < hits.size(); k++)
+      CPPUNIT_ASSERT(geo_touches(r, batch.get(hits[k])));
+  }
+}
+
+void GeometryTest::test_shape_dispatch(void) {
+
+  // in_shape
+  Line l(10, 10, 90, 90, 2);
+  CPPUNIT_ASSERT(l.in_shape(10, 10));
+  CPPUNIT_ASSERT(l.in_shape(50, 51));
+  CPPUNIT_ASSERT(!l.in_shape(9, 9));
+  CPPUNIT_ASSERT(!l.in_shape(50, 53));
+  CPPUNIT_ASSERT(l.in_shape(50, 53, 2));
+
+  Circle c(10, 10, 5);
+  CPPUNIT_ASSERT(c.in_shape(8, 8));
+  CPPUNIT_ASSERT(!c.in_shape(100, 100));
+
+  Rectangle rect(10, 90, 10, 90);
+  CPPUNIT_ASSERT(rect.in_shape(10, 10) && rect.in_shape(90, 90));
+  CPPUNIT_ASSERT(!rect.in_shape(50, 9));
+  CPPUNIT_ASSERT(rect.in_shape(8, 8, 2));
+
+  // tangency of logic model objects
+  PlacedLogicModelObject_shptr via(new Via(100, 10, 6));
+  PlacedLogicModelObject_shptr wire(new Wire(0, 10, 97, 10, 2));
+  PlacedLogicModelObject_shptr wire2(new Wire(0, 20, 100, 20, 2));
+  CPPUNIT_ASSERT(check_object_tangency(via, wire));
+  CPPUNIT_ASSERT(check_object_tangency(wire, via));
+  CPPUNIT_ASSERT(!check_object_tangency(wire, wire2));
+  CPPUNIT_ASSERT(!check_object_tangency(via, wire2));
+
+  GeoShape s;
+  CPPUNIT_ASSERT(get_geo_shape(via, s) && s.type == GeoShape::GEO_CIRCLE && s.circle.diameter == 6);
+  CPPUNIT_ASSERT(get_geo_shape(wire, s) && s.type == GeoShape::GEO_SEGMENT && s.segment.to_x == 97);
+}
@@ -0,0 +1,235 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <HighlightOverlay.h>
+#include <HlObjectSet.h>
+#include <RenderBatchBuilder.h>
+
+#include <boost/foreach.hpp>
+#include <vector>
+
+#include "HighlightOverlayTest.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (HighlightOverlayTest);
+
+using namespace degate;
+
+void HighlightOverlayTest::setUp(void) {
+}
+
+void HighlightOverlayTest::tearDown(void) {
+}
+
+/*
+ * A net with a row of vias. The vias are spread over many render chunks.
+ */
+static Net_shptr create_net(LogicModel_shptr lmodel, std::vector<Via_shptr> & vias, unsigned int n) {
+  Net_shptr net(new Net());
+  for(unsigned int i = 0; i < n; i++) {
+    Via_shptr via(new Via(50 + 100 * (i % 10), 50 + 100 * (i / 10), 5));
+    lmodel->add_object(0, via);
+    via->set_net(net);
+    vias.push_back(via);
+  }
+  lmodel->add_net(net);
+  return net;
+}
+
+void HighlightOverlayTest::test_overlay(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+  std::vector<Via_shptr> vias;
+  Net_shptr net = create_net(lmodel, vias, 20);
+
+  Via_shptr single(new Via(500, 500, 5));
+  lmodel->add_object(0, single);
+
+  HighlightOverlay overlay;
+  CPPUNIT_ASSERT(overlay.empty());
+  unsigned int epoch = overlay.get_epoch();
+
+  overlay.add_object(vias[0]->get_object_id());
+  overlay.add_net(net->get_object_id());
+  CPPUNIT_ASSERT(overlay.get_epoch() != epoch);
+
+  CPPUNIT_ASSERT(overlay.get_state(vias[0]) == PlacedLogicModelObject::HLIGHTSTATE_DIRECT);
+  CPPUNIT_ASSERT(overlay.get_state(vias[19]) == PlacedLogicModelObject::HLIGHTSTATE_ADJACENT);
+  CPPUNIT_ASSERT(overlay.get_state(single) == PlacedLogicModelObject::HLIGHTSTATE_NOT);
+
+  // nets are reference counted
+  overlay.add_net(net->get_object_id());
+  overlay.remove_net(net->get_object_id());
+  CPPUNIT_ASSERT(overlay.is_net_highlighted(net->get_object_id()));
+  overlay.remove_net(net->get_object_id());
+  CPPUNIT_ASSERT(!overlay.is_net_highlighted(net->get_object_id()));
+  CPPUNIT_ASSERT(overlay.get_state(vias[19]) == PlacedLogicModelObject::HLIGHTSTATE_NOT);
+
+  // the overlay does not modify objects
+  CPPUNIT_ASSERT(!vias[0]->is_highlighted());
+
+  epoch = overlay.get_epoch();
+  overlay.clear();
+  CPPUNIT_ASSERT(overlay.empty());
+  CPPUNIT_ASSERT(overlay.get_epoch() != epoch);
+  CPPUNIT_ASSERT(overlay.get_state(vias[0]) == PlacedLogicModelObject::HLIGHTSTATE_NOT);
+
+  // clearing an empty overlay is not a modification
+  epoch = overlay.get_epoch();
+  overlay.clear();
+  CPPUNIT_ASSERT(overlay.get_epoch() == epoch);
+}
+
+void HighlightOverlayTest::test_hl_object_set(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+  std::vector<Via_shptr> vias;
+  create_net(lmodel, vias, 20);
+
+  HlObjectSet hl;
+  HighlightOverlay_shptr overlay = hl.get_overlay();
+
+  hl.add(vias[0], lmodel);
+  hl.add(vias[1], lmodel);
+  CPPUNIT_ASSERT(hl.size() == 2);
+  CPPUNIT_ASSERT(overlay->get_state(vias[1]) == PlacedLogicModelObject::HLIGHTSTATE_DIRECT);
+  CPPUNIT_ASSERT(overlay->get_state(vias[2]) == PlacedLogicModelObject::HLIGHTSTATE_ADJACENT);
+
+  // the net stays highlighted, as long as a selected object is on it
+  hl.remove(vias[0]);
+  CPPUNIT_ASSERT(overlay->get_state(vias[0]) == PlacedLogicModelObject::HLIGHTSTATE_ADJACENT);
+  hl.remove(vias[1]);
+  CPPUNIT_ASSERT(overlay->empty());
+
+  // adding without a logic model does not highlight the net
+  hl.add(vias[0]);
+  CPPUNIT_ASSERT(overlay->get_state(vias[2]) == PlacedLogicModelObject::HLIGHTSTATE_NOT);
+
+  hl.add(vias[5], lmodel);
+  hl.clear();
+  CPPUNIT_ASSERT(hl.empty());
+  CPPUNIT_ASSERT(overlay->empty());
+
+  BOOST_FOREACH(Via_shptr via, vias) CPPUNIT_ASSERT(!via->is_highlighted());
+}
+
+void HighlightOverlayTest::test_render_batch_builder(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+  Layer_shptr layer = lmodel->get_layer(0);
+  std::vector<Via_shptr> vias;
+  create_net(lmodel, vias, 20);
+
+  Via_shptr single(new Via(550, 550, 5));
+  lmodel->add_object(0, single);
+
+  HlObjectSet hl;
+  RenderBatchBuilder builder(layer, 100);
+  builder.set_highlight_overlay(hl.get_overlay());
+
+  RenderBatchBuilder::chunk_list chunks;
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  CPPUNIT_ASSERT(chunks.size() == 21);
+
+  // Highlighting does not notify the layer.
+  hl.add(vias[0], lmodel);
+  CPPUNIT_ASSERT(builder.get_num_dirty_chunks() == 0);
+
+  // Only the chunks of the highlighted net are rebuilt.
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * c, chunks) {
+    bool on_net = !c->get_extent().in_shape(550, 550);
+    CPPUNIT_ASSERT(c->get_rebuild_count() == (on_net ? 2 : 1));
+
+    // a highlighted via is drawn larger
+    if(on_net) CPPUNIT_ASSERT(c->get_extent().get_width() > 20);
+  }
+
+  hl.clear();
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * c, chunks) {
+    bool on_net = !c->get_extent().in_shape(550, 550);
+    CPPUNIT_ASSERT(c->get_rebuild_count() == (on_net ? 3 : 1));
+  }
+
+  // an unchanged overlay does not cause rebuilds
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * c, chunks)
+    CPPUNIT_ASSERT(c->get_rebuild_count() <= 3);
+
+  // Highlighting an object, that is not on a net, rebuilds only its chunk.
+  hl.add(single, lmodel);
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * c, chunks) {
+    bool on_net = !c->get_extent().in_shape(550, 550);
+    CPPUNIT_ASSERT(c->get_rebuild_count() == (on_net ? 3 : 2));
+  }
+  hl.clear();
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+
+  // A via, that joins the net later, is highlighted with the net.
+  Net_shptr net = vias[0]->get_net();
+  single->set_net(net);
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  hl.add(vias[1], lmodel);
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * c, chunks) {
+    bool on_net = !c->get_extent().in_shape(550, 550);
+    CPPUNIT_ASSERT(c->get_rebuild_count() == (on_net ? 4 : 5));
+  }
+}
+
+void HighlightOverlayTest::test_overlay_changes(void) {
+
+  HighlightOverlay overlay;
+  unsigned int epoch = overlay.get_epoch();
+
+  overlay.add_object(1);
+  overlay.add_net(2);
+  overlay.add_net(2); // no modification
+  overlay.remove_object(3); // no modification
+
+  std::vector<object_id_t> oids, net_ids;
+  bool cleared = true;
+  CPPUNIT_ASSERT(overlay.get_changes(epoch, oids, net_ids, cleared));
+  CPPUNIT_ASSERT(oids.size() == 1 && oids[0] == 1);
+  CPPUNIT_ASSERT(net_ids.size() == 1 && net_ids[0] == 2);
+  CPPUNIT_ASSERT(!cleared);
+
+  epoch = overlay.get_epoch();
+  oids.clear();
+  net_ids.clear();
+  overlay.clear();
+  overlay.add_object(4);
+  CPPUNIT_ASSERT(overlay.get_changes(epoch, oids, net_ids, cleared));
+  CPPUNIT_ASSERT(oids.size() == 1 && oids[0] == 4);
+  CPPUNIT_ASSERT(net_ids.empty());
+  CPPUNIT_ASSERT(cleared);
+
+  // The log is limited. Old epochs are not covered after many changes.
+  epoch = overlay.get_epoch();
+  for(object_id_t oid = 10; oid < 10010; oid++) overlay.add_object(oid);
+  oids.clear();
+  CPPUNIT_ASSERT(!overlay.get_changes(epoch, oids, net_ids, cleared));
+  CPPUNIT_ASSERT(oids.empty());
+  CPPUNIT_ASSERT(overlay.get_changes(overlay.get_epoch() - 10, oids, net_ids, cleared));
+  CPPUNIT_ASSERT(oids.size() == 10);
+}
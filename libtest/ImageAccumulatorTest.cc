@@ -0,0 +1,150 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <ImageAccumulator.h>
+#include <ImageHelper.h>
+#include <LogicModelHelper.h>
+
+#include "ImageAccumulatorTest.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (ImageAccumulatorTest);
+
+using namespace degate;
+
+
+static MemoryImage_shptr create_image(unsigned int w, unsigned int h, color_t pix) {
+  MemoryImage_shptr img(new MemoryImage(w, h));
+  for(unsigned int y = 0; y < h; y++)
+    for(unsigned int x = 0; x < w; x++)
+      img->set_pixel(x, y, pix);
+  return img;
+}
+
+void ImageAccumulatorTest::test_mean(void) {
+
+  ImageAccumulator acc1(3, 2), acc2(3, 2);
+  acc1.add(create_image(3, 2, MERGE_CHANNELS(10, 20, 30, 255)));
+  acc1.add(create_image(3, 2, MERGE_CHANNELS(20, 20, 31, 255)));
+  acc2.add(create_image(3, 2, MERGE_CHANNELS(30, 20, 32, 255)));
+
+  CPPUNIT_ASSERT_THROW(acc1.add(create_image(2, 2, 0)), DegateRuntimeException);
+
+  acc1.merge(acc2);
+  CPPUNIT_ASSERT(acc1.get_num_images() == 3);
+  CPPUNIT_ASSERT(acc1.get_mean(2, 1, 0) == 20);
+  CPPUNIT_ASSERT(acc1.get_pixel(0, 0) == MERGE_CHANNELS(20, 20, 31, 255));
+
+  MemoryImage_shptr img = acc1.get_image<MemoryImage>();
+  CPPUNIT_ASSERT(img != NULL && img->get_width() == 3 && img->get_height() == 2);
+  CPPUNIT_ASSERT(img->get_pixel(2, 1) == MERGE_CHANNELS(20, 20, 31, 255));
+
+  // merge_images() uses the accumulator
+  std::list<MemoryImage_shptr> images;
+  images.push_back(create_image(3, 2, MERGE_CHANNELS(0, 0, 0, 0)));
+  images.push_back(create_image(3, 2, MERGE_CHANNELS(3, 4, 5, 6)));
+  img = merge_images(images);
+  CPPUNIT_ASSERT(img->get_pixel(1, 1) == MERGE_CHANNELS(2, 2, 3, 3));
+
+  CPPUNIT_ASSERT(ImageAccumulator(3, 2).get_image<MemoryImage>() == NULL);
+}
+
+void ImageAccumulatorTest::test_outlier_rejection(void) {
+
+  std::list<MemoryImage_shptr> images;
+  for(unsigned int i = 0; i < 9; i++)
+    images.push_back(create_image(2, 2, MERGE_CHANNELS(100 + i % 3, 50, 50, 255)));
+  images.push_back(create_image(2, 2, MERGE_CHANNELS(250, 50, 50, 255)));
+
+  ImageAccumulator reference(2, 2, true);
+  BOOST_FOREACH(MemoryImage_shptr img, images) reference.add(img);
+  CPPUNIT_ASSERT(fabs(reference.get_mean(0, 0, 0) - 115.9) < 1e-9);
+  CPPUNIT_ASSERT(reference.get_standard_deviation(0, 0, 1) == 0);
+
+  ImageAccumulator clipped(2, 2);
+  CPPUNIT_ASSERT_THROW(clipped.set_reference(ImageAccumulator(2, 2), 2), DegateRuntimeException);
+
+  clipped.set_reference(reference, 2);
+  BOOST_FOREACH(MemoryImage_shptr img, images) clipped.add(img);
+  CPPUNIT_ASSERT(clipped.get_mean(1, 1, 0) == 101);
+  CPPUNIT_ASSERT(clipped.get_pixel(1, 1) == MERGE_CHANNELS(101, 50, 50, 255));
+}
+
+void ImageAccumulatorTest::test_merge_gate_images(void) {
+
+  // 16x16 pixel tiles, so that gates cross tile borders
+  Project_shptr prj(new Project(64, 64, temp_dir, 2));
+  LogicModel_shptr lmodel = prj->get_logic_model();
+  Layer_shptr transistor = lmodel->get_layer(0), metal = lmodel->get_layer(1);
+  transistor->set_layer_type(Layer::TRANSISTOR);
+  metal->set_layer_type(Layer::METAL);
+
+  BackgroundImage_shptr img(new BackgroundImage(64, 64, 4));
+  BackgroundImage_shptr metal_img(new BackgroundImage(64, 64, 4));
+
+  // a gate with a gradient from left to right, instances are mirrored
+  for(unsigned int y = 0; y < 6; y++)
+    for(unsigned int x = 0; x < 10; x++) {
+      img->set_pixel(12 + x, 14 + y, MERGE_CHANNELS(x * 10, y, 0, 255));
+      img->set_pixel(40 + 9 - x, 50 + y, MERGE_CHANNELS(x * 10 + 2, y, 0, 255));
+      metal_img->set_pixel(12 + x, 14 + y, 0xffffffff);
+    }
+  transistor->set_image(img);
+  metal->set_image(metal_img);
+
+  GateTemplate_shptr tmpl(new GateTemplate(10, 6));
+  lmodel->add_gate_template(tmpl);
+
+  Gate_shptr g1(new Gate(12, 22, 14, 20, Gate::ORIENTATION_NORMAL));
+  Gate_shptr g2(new Gate(40, 50, 50, 56, Gate::ORIENTATION_FLIPPED_LEFT_RIGHT));
+  g1->set_gate_template(tmpl);
+  g2->set_gate_template(tmpl);
+  lmodel->add_object(0, g1);
+  lmodel->add_object(0, g2);
+
+  std::list<Gate_shptr> gates;
+  gates.push_back(g1);
+  gates.push_back(g2);
+
+  merge_gate_images(lmodel, transistor, tmpl, gates, 0, 2);
+
+  GateTemplateImage_shptr merged = tmpl->get_image(Layer::TRANSISTOR);
+  CPPUNIT_ASSERT(merged != NULL);
+  CPPUNIT_ASSERT(merged->get_width() == 10 && merged->get_height() == 6);
+  CPPUNIT_ASSERT(merged->get_pixel(0, 0) == MERGE_CHANNELS(1, 0, 0, 255));
+  CPPUNIT_ASSERT(merged->get_pixel(9, 5) == MERGE_CHANNELS(91, 5, 0, 255));
+
+  // all standard layers at once
+  ObjectSet objects;
+  objects.add(g1);
+  objects.add(g2);
+  merge_gate_images(lmodel, objects);
+
+  merged = tmpl->get_image(Layer::METAL);
+  CPPUNIT_ASSERT(merged != NULL);
+  CPPUNIT_ASSERT(merged->get_pixel(3, 3) == MERGE_CHANNELS(128, 128, 128, 128));
+  CPPUNIT_ASSERT(tmpl->get_image(Layer::TRANSISTOR)->get_pixel(5, 2) ==
+		 MERGE_CHANNELS(51, 2, 0, 255));
+
+  // gates of a template must have the same size
+  gates.push_back(Gate_shptr(new Gate(0, 5, 0, 5, Gate::ORIENTATION_NORMAL)));
+  CPPUNIT_ASSERT_THROW(merge_gate_images(lmodel, transistor, tmpl, gates), DegateRuntimeException);
+}
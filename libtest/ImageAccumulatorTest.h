@@ -0,0 +1,47 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __IMAGEACCUMULATORTEST_H__
+#define __IMAGEACCUMULATORTEST_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "TestHelper.h"
+
+class ImageAccumulatorTest : public TempDirectoryTestFixture {
+
+  CPPUNIT_TEST_SUITE(ImageAccumulatorTest);
+
+  CPPUNIT_TEST (test_mean);
+  CPPUNIT_TEST (test_outlier_rejection);
+  CPPUNIT_TEST (test_merge_gate_images);
+
+  CPPUNIT_TEST_SUITE_END ();
+
+ protected:
+
+  void test_mean(void);
+  void test_outlier_rejection(void);
+  void test_merge_gate_images(void);
+};
+
+#endif
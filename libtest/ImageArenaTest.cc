@@ -0,0 +1,112 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <ImageArena.h>
+
+#include "ImageArenaTest.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (ImageArenaTest);
+
+using namespace degate;
+
+void ImageArenaTest::setUp(void) {
+  spill_threshold = ImageArena::get_instance().get_spill_threshold();
+}
+
+void ImageArenaTest::tearDown(void) {
+  ImageArena::get_instance().set_spill_threshold(spill_threshold);
+}
+
+void ImageArenaTest::test_recycling(void) {
+
+  ImageArena & arena = ImageArena::get_instance();
+  arena.trim();
+  CPPUNIT_ASSERT(arena.get_cached_bytes() == 0);
+
+  unsigned char * mem = (unsigned char *)arena.acquire(1000);
+  CPPUNIT_ASSERT(mem != NULL);
+  memset(mem, 0xff, 1000);
+  arena.release(mem, 1000);
+  CPPUNIT_ASSERT(arena.get_cached_bytes() >= 1000);
+  CPPUNIT_ASSERT(arena.get_cached_bytes() <= 1250);
+
+  // a request of the same size class gets the block back, zeroed
+  unsigned long reused = arena.get_num_reused();
+  unsigned char * mem2 = (unsigned char *)arena.acquire(990);
+  CPPUNIT_ASSERT(arena.get_num_reused() == reused + 1);
+  CPPUNIT_ASSERT(mem2 == mem);
+  for(unsigned int i = 0; i < 990; i++) CPPUNIT_ASSERT(mem2[i] == 0);
+
+  // another size class
+  void * mem3 = arena.acquire(5000);
+  CPPUNIT_ASSERT(arena.get_num_reused() == reused + 1);
+
+  arena.release(mem2, 990);
+  arena.release(mem3, 5000);
+
+  arena.trim();
+  CPPUNIT_ASSERT(arena.get_cached_bytes() == 0);
+}
+
+void ImageArenaTest::test_temp_images(void) {
+
+  ImageArena & arena = ImageArena::get_instance();
+  CPPUNIT_ASSERT(StoragePolicy_TempFile<PixelPolicy_GS_BYTE>::get_storage_type(64, 64) ==
+		 MAP_STORAGE_TYPE_POOL);
+
+  unsigned long reused = arena.get_num_reused();
+
+  for(unsigned int i = 0; i < 100; i++) {
+    TempImage_GS_DOUBLE_shptr img(new TempImage_GS_DOUBLE(32, 48));
+    CPPUNIT_ASSERT(img->get_pixel(31, 47) == 0);
+    img->set_pixel(31, 47, i + 0.5);
+    CPPUNIT_ASSERT(img->get_pixel(31, 47) == i + 0.5);
+  }
+
+  // temporaries are recycled
+  CPPUNIT_ASSERT(arena.get_num_reused() >= reused + 99);
+}
+
+void ImageArenaTest::test_spill_threshold(void) {
+
+  ImageArena & arena = ImageArena::get_instance();
+  arena.set_spill_threshold(64 * 64);
+
+  CPPUNIT_ASSERT(StoragePolicy_TempFile<PixelPolicy_GS_BYTE>::get_storage_type(64, 64) ==
+		 MAP_STORAGE_TYPE_POOL);
+  CPPUNIT_ASSERT(StoragePolicy_TempFile<PixelPolicy_GS_BYTE>::get_storage_type(65, 64) ==
+		 MAP_STORAGE_TYPE_TEMP_FILE);
+  CPPUNIT_ASSERT(StoragePolicy_TempFile<PixelPolicy_RGBA>::get_storage_type(64, 64) ==
+		 MAP_STORAGE_TYPE_TEMP_FILE);
+
+  // file backed temp images work as before
+  unsigned long allocated = arena.get_num_allocated();
+  unsigned long reused = arena.get_num_reused();
+
+  TempImage_RGBA_shptr img(new TempImage_RGBA(100, 100));
+  img->set_pixel(99, 99, 0x12345678);
+  CPPUNIT_ASSERT(img->get_pixel(99, 99) == 0x12345678);
+  CPPUNIT_ASSERT(img->get_pixel(0, 0) == 0);
+
+  CPPUNIT_ASSERT(arena.get_num_allocated() == allocated);
+  CPPUNIT_ASSERT(arena.get_num_reused() == reused);
+}
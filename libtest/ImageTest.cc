@@ -28,6 +28,9 @@
 #include "TileImage.h"
 #include "ImageReaderBase.h"
 #include "ImageManipulation.h"
+#include "TilePackFile.h"
+#include "TileCodec.h"
+#include "FileSystem.h"
 
 #include "globals.h"
 #include <stdlib.h>
@@ -191,3 +194,194 @@ void ImageTest::test_copy_pixel(void) {
 
   img1->get_pixel_as<gs_byte_pixel_t>(5, 5);
 }
+
+void ImageTest::test_tile_pack_file(void) {
+
+  std::string dir = create_temp_directory();
+
+  {
+    // 3x2 tiles of 16x16 RGBA pixels
+    TilePackFile pack(dir, 40, 20, 4, sizeof(rgba_pixel_t));
+    CPPUNIT_ASSERT(pack.get_num_allocated() == 0);
+
+    rgba_pixel_t * t1 = static_cast<rgba_pixel_t *>(pack.get_tile(2, 1));
+    rgba_pixel_t * t2 = static_cast<rgba_pixel_t *>(pack.get_tile(0, 0));
+    CPPUNIT_ASSERT(pack.get_num_allocated() == 2);
+    CPPUNIT_ASSERT(t1 != t2);
+
+    t1[5] = 0x12345678;
+    t2[0] = 0x9abcdef0;
+
+    // released tiles keep their data
+    pack.release_tile(2, 1);
+    CPPUNIT_ASSERT(static_cast<rgba_pixel_t *>(pack.get_tile(2, 1))[5] == 0x12345678);
+    CPPUNIT_ASSERT(pack.get_num_allocated() == 2);
+
+    CPPUNIT_ASSERT_THROW(pack.get_tile(3, 0), DegateRuntimeException);
+  }
+
+  CPPUNIT_ASSERT(TilePackFile::exists(dir));
+  CPPUNIT_ASSERT(!TilePackFile::has_tile_files(dir));
+
+  // reopen
+  {
+    TilePackFile pack(dir, 40, 20, 4, sizeof(rgba_pixel_t));
+    CPPUNIT_ASSERT(pack.get_num_allocated() == 2);
+    CPPUNIT_ASSERT(static_cast<rgba_pixel_t *>(pack.get_tile(0, 0))[0] == 0x9abcdef0);
+
+    // a mismatch of the image parameters is detected
+    CPPUNIT_ASSERT_THROW(TilePackFile(dir, 80, 20, 4, sizeof(rgba_pixel_t)), DegateRuntimeException);
+  }
+
+  // read without mapping
+  std::vector<rgba_pixel_t> buf(16 * 16, 0xffffffff);
+  TilePackFile::read_tile(dir, 2, 1, &buf[0], buf.size() * sizeof(rgba_pixel_t));
+  CPPUNIT_ASSERT(buf[5] == 0x12345678 && buf[0] == 0);
+
+  TilePackFile::read_tile(dir, 1, 1, &buf[0], buf.size() * sizeof(rgba_pixel_t));
+  CPPUNIT_ASSERT(buf[5] == 0);
+
+  remove_directory(dir);
+}
+
+void ImageTest::test_tile_image_layouts(void) {
+
+  std::string dir_packed = join_pathes(create_temp_directory(), "packed.dimg");
+  std::string dir_files = join_pathes(create_temp_directory(), "files.dimg");
+
+  {
+    TileImage_RGBA img(100, 100, dir_packed, true, 4);
+    CPPUNIT_ASSERT(img.is_packed());
+    img.set_pixel(99, 99, 0x11223344);
+    img.set_pixel(0, 0, 0x55667788);
+  }
+
+  // images with a file per tile keep their layout
+  setenv("DEGATE_TILE_STORE", "files", 1);
+  {
+    TileImage_RGBA img(100, 100, dir_files, true, 4);
+    CPPUNIT_ASSERT(!img.is_packed());
+    img.set_pixel(99, 99, 0x11223344);
+  }
+  unsetenv("DEGATE_TILE_STORE");
+
+  CPPUNIT_ASSERT(TilePackFile::exists(dir_packed));
+  CPPUNIT_ASSERT(!TilePackFile::has_tile_files(dir_packed));
+  CPPUNIT_ASSERT(!TilePackFile::exists(dir_files));
+  CPPUNIT_ASSERT(TilePackFile::has_tile_files(dir_files));
+
+  {
+    TileImage_RGBA img(100, 100, dir_packed, true, 4);
+    CPPUNIT_ASSERT(img.is_packed());
+    CPPUNIT_ASSERT(img.get_pixel(99, 99) == 0x11223344);
+    CPPUNIT_ASSERT(img.get_pixel(0, 0) == 0x55667788);
+    CPPUNIT_ASSERT(img.get_pixel(50, 50) == 0);
+  }
+
+  {
+    TileImage_RGBA img(100, 100, dir_files, true, 4);
+    CPPUNIT_ASSERT(!img.is_packed());
+    CPPUNIT_ASSERT(img.get_pixel(99, 99) == 0x11223344);
+  }
+
+  remove_directory(get_basedir(dir_packed));
+  remove_directory(get_basedir(dir_files));
+}
+
+void ImageTest::test_tile_codec(void) {
+
+  const size_t n = 64 * 64;
+  std::vector<rgba_pixel_t> tile(n), decoded(n);
+  std::vector<uint8_t> encoded;
+
+  // a grey gradient with noise, as in a scanned image
+  srand(42);
+  for(size_t i = 0; i < n; i++) {
+    unsigned int v = (i % 64 + i / 64 + rand() % 4) & 0xff;
+    tile[i] = MERGE_CHANNELS(v, v, v, 0xff);
+  }
+
+  CPPUNIT_ASSERT(TileCodec::is_grey(&tile[0], n * sizeof(rgba_pixel_t)));
+  TileCodec::encode(&tile[0], n * sizeof(rgba_pixel_t), sizeof(rgba_pixel_t), encoded);
+  CPPUNIT_ASSERT(encoded[0] == TileCodec::TILE_CODEC_GREY);
+  CPPUNIT_ASSERT(encoded.size() < n); // less than one byte per pixel
+
+  TileCodec::decode(&encoded[0], encoded.size(), &decoded[0], n * sizeof(rgba_pixel_t));
+  CPPUNIT_ASSERT(tile == decoded);
+
+  // colored pixels are stored in planes
+  tile[17] = MERGE_CHANNELS(10, 20, 30, 0xff);
+  CPPUNIT_ASSERT(!TileCodec::is_grey(&tile[0], n * sizeof(rgba_pixel_t)));
+  TileCodec::encode(&tile[0], n * sizeof(rgba_pixel_t), sizeof(rgba_pixel_t), encoded);
+  CPPUNIT_ASSERT(encoded[0] == TileCodec::TILE_CODEC_PLANAR);
+
+  std::fill(decoded.begin(), decoded.end(), 0);
+  TileCodec::decode(&encoded[0], encoded.size(), &decoded[0], n * sizeof(rgba_pixel_t));
+  CPPUNIT_ASSERT(tile == decoded);
+
+  // the tile size must match and corrupted data is detected
+  CPPUNIT_ASSERT_THROW(TileCodec::decode(&encoded[0], encoded.size(), &decoded[0], n),
+		       DegateRuntimeException);
+  encoded.resize(encoded.size() / 2);
+  CPPUNIT_ASSERT_THROW(TileCodec::decode(&encoded[0], encoded.size(), &decoded[0],
+					 n * sizeof(rgba_pixel_t)),
+		       DegateRuntimeException);
+}
+
+void ImageTest::test_tile_compression(void) {
+
+  std::string dir = create_temp_directory();
+  std::string copy_dir = create_temp_directory();
+
+  {
+    TileImage_RGBA img(100, 100, dir, true, 4);
+    CPPUNIT_ASSERT(img.is_packed());
+    for(unsigned int y = 0; y < 100; y++)
+      for(unsigned int x = 0; x < 100; x++)
+	img.set_pixel(x, y, MERGE_CHANNELS(x, x, x, 0xff));
+
+    img.compress_tiles(2);
+    CPPUNIT_ASSERT(TilePackFile::is_compressed(dir));
+
+    // compressed tiles are decoded on load
+    CPPUNIT_ASSERT(img.get_pixel(42, 99) == MERGE_CHANNELS(42, 42, 42, 0xff));
+
+    // a modified tile is stored uncompressed
+    img.set_pixel(42, 99, 0x12345678);
+    CPPUNIT_ASSERT(img.get_pixel(42, 99) == 0x12345678);
+    CPPUNIT_ASSERT(img.get_pixel(43, 99) == MERGE_CHANNELS(43, 43, 43, 0xff));
+    CPPUNIT_ASSERT(!TilePackFile::is_compressed(dir));
+  }
+
+  {
+    TilePackFile pack(dir, 100, 100, 4, sizeof(rgba_pixel_t));
+    CPPUNIT_ASSERT(pack.get_num_allocated() == 7 * 7);
+    CPPUNIT_ASSERT(pack.get_num_compressed() == 7 * 7 - 1);
+    CPPUNIT_ASSERT(!pack.is_compressed(2, 6));
+    uint64_t data_size = pack.get_data_size();
+
+    // recompressing frees the space of the modified tile
+    pack.compress(2);
+    CPPUNIT_ASSERT(pack.get_num_compressed() == 7 * 7);
+    CPPUNIT_ASSERT(pack.get_data_size() < data_size);
+    CPPUNIT_ASSERT(pack.get_data_size() < 7 * 7 * 16 * 16 * sizeof(rgba_pixel_t) / 2);
+  }
+
+  // compressed copies and thread-safe reads
+  std::string copy = join_pathes(copy_dir, TilePackFile::pack_filename);
+  TilePackFile::write_compressed(dir, copy, 3);
+
+  std::vector<rgba_pixel_t> buf(16 * 16);
+  TilePackFile::read_tile(copy_dir, 2, 6, &buf[0], buf.size() * sizeof(rgba_pixel_t));
+  CPPUNIT_ASSERT(buf[(99 % 16) * 16 + 42 % 16] == 0x12345678);
+  CPPUNIT_ASSERT(buf[(99 % 16) * 16 + 43 % 16] == MERGE_CHANNELS(43, 43, 43, 0xff));
+
+  {
+    TileImage_RGBA img(100, 100, copy_dir, true, 4);
+    CPPUNIT_ASSERT(img.get_pixel(99, 0) == MERGE_CHANNELS(99, 99, 99, 0xff));
+    CPPUNIT_ASSERT(img.get_pixel(42, 99) == 0x12345678);
+  }
+
+  remove_directory(dir);
+  remove_directory(copy_dir);
+}
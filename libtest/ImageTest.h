@@ -40,6 +40,10 @@ class ImageTest : public CPPUNIT_NS :: TestFixture {
   CPPUNIT_TEST (test_image_reader);
   CPPUNIT_TEST (test_convert_pixel);
   CPPUNIT_TEST (test_copy_pixel);
+  CPPUNIT_TEST (test_tile_pack_file);
+  CPPUNIT_TEST (test_tile_image_layouts);
+  CPPUNIT_TEST (test_tile_codec);
+  CPPUNIT_TEST (test_tile_compression);
   
   CPPUNIT_TEST_SUITE_END ();
   
@@ -54,6 +58,10 @@ protected:
   void test_image_reader(void);
   void test_convert_pixel(void);
   void test_copy_pixel(void);
+  void test_tile_pack_file(void);
+  void test_tile_image_layouts(void);
+  void test_tile_codec(void);
+  void test_tile_compression(void);
   
   
   
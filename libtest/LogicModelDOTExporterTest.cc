@@ -32,6 +32,9 @@
 #include <sys/param.h>
 #include <stdlib.h>
 #include <stdexcept>
+#include <sstream>
+
+#include "TestHelper.h"
 
 
 CPPUNIT_TEST_SUITE_REGISTRATION (LogicModelDOTExporterTest);
@@ -89,3 +92,58 @@ void LogicModelDOTExporterTest::test_export(void) {
 
 }
 
+
+
+void LogicModelDOTExporterTest::test_stream(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(100, 100, 1));
+
+  GateTemplate_shptr tmpl(new GateTemplate(10, 10));
+  tmpl->set_name("inv");
+  GateTemplatePort_shptr in_port(new GateTemplatePort(2, 5, GateTemplatePort::PORT_TYPE_IN));
+  GateTemplatePort_shptr out_port(new GateTemplatePort(8, 5, GateTemplatePort::PORT_TYPE_OUT));
+  in_port->set_name("a");
+  out_port->set_name("y");
+  in_port->set_object_id(lmodel->get_new_object_id());
+  out_port->set_object_id(lmodel->get_new_object_id());
+  tmpl->add_template_port(in_port);
+  tmpl->add_template_port(out_port);
+  lmodel->add_gate_template(tmpl);
+
+  // a chain of three inverters, the outer ports are not connected
+  GatePort_shptr prev_out;
+  for(unsigned int i = 0; i < 3; i++) {
+    Gate_shptr gate(new Gate(i * 20, i * 20 + 10, 0, 10, Gate::ORIENTATION_NORMAL));
+    gate->set_gate_template(tmpl);
+    lmodel->add_object(0, gate);
+    lmodel->update_ports(gate);
+
+    if(prev_out != NULL) {
+      Net_shptr net(new Net());
+      prev_out->set_net(net);
+      gate->get_port_by_template_port(in_port)->set_net(net);
+      lmodel->add_net(net);
+    }
+    prev_out = gate->get_port_by_template_port(out_port);
+  }
+
+  LogicModelDOTExporter exporter(std::tr1::shared_ptr<ObjectIDRewriter>(new ObjectIDRewriter(true)));
+  std::ostringstream os;
+  exporter.export_data(os, lmodel, "chain");
+  std::string dot = os.str();
+
+  CPPUNIT_ASSERT(dot.find("# time neato -v -Tsvg -o chain.svg chain.dot\n") != string::npos);
+  CPPUNIT_ASSERT(dot.find("digraph LogicModel {") != string::npos);
+  CPPUNIT_ASSERT(count_occurrences(dot, " [shape=\"box\", label=\"G") == 3);
+  CPPUNIT_ASSERT(count_occurrences(dot, " -> G") == 3);
+  CPPUNIT_ASSERT(count_occurrences(dot, "[headlabel=\"a\", taillabel=\"y\"];\n") == 2);
+  CPPUNIT_ASSERT(count_occurrences(dot, "unknown0 -> G") == 1);
+  CPPUNIT_ASSERT(count_occurrences(dot, " -> unknown1[headlabel=\"?\", taillabel=\"y\"];\n") == 1);
+  CPPUNIT_ASSERT(dot.find("unknown2") == string::npos);
+  CPPUNIT_ASSERT(dot.substr(dot.size() - 2) == "}\n");
+
+  // exporting again yields the same graph
+  std::ostringstream os2;
+  exporter.export_data(os2, lmodel, "chain");
+  CPPUNIT_ASSERT(os2.str() == dot);
+}
@@ -31,6 +31,7 @@ class LogicModelDOTExporterTest : public CPPUNIT_NS :: TestFixture {
 	CPPUNIT_TEST_SUITE(LogicModelDOTExporterTest);
 	
 	CPPUNIT_TEST (test_export);
+	CPPUNIT_TEST (test_stream);
 	
 	CPPUNIT_TEST_SUITE_END ();
 	
@@ -40,6 +41,7 @@ public:
 	
 protected:
 	void test_export(void);
+	void test_stream(void);
 
 };
 
@@ -0,0 +1,175 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <LogicModelIndex.h>
+#include <LogicModelHelper.h>
+
+#include <algorithm>
+
+#include "LogicModelIndexTest.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (LogicModelIndexTest);
+
+using namespace degate;
+
+void LogicModelIndexTest::setUp(void) {
+}
+
+void LogicModelIndexTest::tearDown(void) {
+}
+
+static bool contains(TextIndex::id_list const& ids, object_id_t id) {
+  return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+void LogicModelIndexTest::test_text_index(void) {
+
+  TextIndex index;
+  TextIndex::handle_type h1 = index.insert("nand2_x1", 1);
+  TextIndex::handle_type h2 = index.insert("nand2_x1", 2);
+  TextIndex::handle_type h3 = index.insert("nor2_x1", 3);
+  index.insert("inv", 4);
+  CPPUNIT_ASSERT(index.insert("", 5) == NULL);
+  CPPUNIT_ASSERT(h1 == h2);
+  CPPUNIT_ASSERT(index.get_num_keys() == 3);
+
+  TextIndex::id_list ids;
+  index.find("nand2_x1", TextIndex::MATCH_EXACT, ids);
+  CPPUNIT_ASSERT(ids.size() == 2);
+
+  ids.clear();
+  index.find("n", TextIndex::MATCH_PREFIX, ids);
+  CPPUNIT_ASSERT(ids.size() == 3);
+  CPPUNIT_ASSERT(!contains(ids, 4));
+
+  ids.clear();
+  index.find("2_x", TextIndex::MATCH_SUBSTRING, ids);
+  CPPUNIT_ASSERT(ids.size() == 3);
+
+  ids.clear();
+  index.find("nv", TextIndex::MATCH_SUBSTRING, ids);
+  CPPUNIT_ASSERT(ids.size() == 1 && ids[0] == 4);
+
+  ids.clear();
+  index.find("xyz", TextIndex::MATCH_SUBSTRING, ids);
+  CPPUNIT_ASSERT(ids.empty());
+
+  index.remove(h1, 1);
+  index.remove(h3, 3);
+  CPPUNIT_ASSERT(index.get_num_keys() == 2);
+
+  ids.clear();
+  index.find("2_x", TextIndex::MATCH_SUBSTRING, ids);
+  CPPUNIT_ASSERT(ids.size() == 1 && ids[0] == 2);
+}
+
+void LogicModelIndexTest::test_names(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 2));
+
+  Gate_shptr g1(new Gate(10, 20, 10, 20));
+  g1->set_name("U1");
+  g1->set_description("matched with corr=0.91");
+  lmodel->add_object(0, g1);
+
+  Gate_shptr g2(new Gate(30, 40, 10, 20));
+  g2->set_name("U12");
+  lmodel->add_object(0, g2);
+
+  Via_shptr via(new Via(500, 500, 5));
+  via->set_name("U1");
+  lmodel->add_object(1, via);
+
+  LogicModelIndex const& index = lmodel->get_index();
+  CPPUNIT_ASSERT(index.size() == 3);
+
+  CPPUNIT_ASSERT(index.find_by_name("U1").size() == 2);
+  CPPUNIT_ASSERT(index.find_by_name("U1", TextIndex::MATCH_PREFIX).size() == 3);
+  CPPUNIT_ASSERT(index.find_by_description("corr=0.9", TextIndex::MATCH_SUBSTRING).size() == 1);
+  CPPUNIT_ASSERT(get_gate_by_name(lmodel, "U1") == g1);
+  CPPUNIT_ASSERT(get_gate_by_name(lmodel, "U12") == g2);
+  CPPUNIT_ASSERT(get_gate_by_name(lmodel, "U3") == NULL);
+
+  lmodel->remove_object(g1);
+  CPPUNIT_ASSERT(index.find_by_name("U1").size() == 1);
+  CPPUNIT_ASSERT(get_gate_by_name(lmodel, "U1") == NULL);
+
+  lmodel->remove_object(via);
+  CPPUNIT_ASSERT(index.find_by_name("U1").empty());
+  CPPUNIT_ASSERT(index.size() == 1);
+}
+
+void LogicModelIndexTest::test_rename(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+
+  Gate_shptr gate(new Gate(10, 20, 10, 20));
+  gate->set_name("old");
+  lmodel->add_object(0, gate);
+
+  gate->set_name("new");
+  gate->set_description("checked");
+
+  LogicModelIndex const& index = lmodel->get_index();
+  CPPUNIT_ASSERT(index.find_by_name("old").empty());
+  CPPUNIT_ASSERT(index.find_by_name("new").size() == 1);
+  CPPUNIT_ASSERT(index.find_by_description("checked").size() == 1);
+
+  // a shape change keeps the index entries
+  gate->shift_x(100);
+  CPPUNIT_ASSERT(index.find_by_name("new").size() == 1);
+}
+
+void LogicModelIndexTest::test_templates(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+
+  GateTemplate_shptr inv(new GateTemplate(10, 10));
+  GateTemplate_shptr nand(new GateTemplate(10, 10));
+  lmodel->add_gate_template(inv);
+  lmodel->add_gate_template(nand);
+
+  for(unsigned int i = 0; i < 5; i++) {
+    Gate_shptr gate(new Gate(i * 20, i * 20 + 10, 0, 10, Gate::ORIENTATION_NORMAL));
+    gate->set_gate_template(i < 3 ? inv : nand);
+    lmodel->add_object(0, gate);
+  }
+
+  LogicModelIndex const& index = lmodel->get_index();
+  CPPUNIT_ASSERT(index.get_num_gates_by_template(inv) == 3);
+  CPPUNIT_ASSERT(index.get_num_gates_by_template(nand) == 2);
+
+  // changing the template of a placed gate
+  Gate_shptr gate = index.get_gates_by_template(nand).front();
+  gate->set_gate_template(inv);
+  CPPUNIT_ASSERT(index.get_num_gates_by_template(inv) == 4);
+  CPPUNIT_ASSERT(index.get_num_gates_by_template(nand) == 1);
+
+  lmodel->remove_template_references(nand);
+  CPPUNIT_ASSERT(index.get_num_gates_by_template(nand) == 0);
+  CPPUNIT_ASSERT(nand->get_reference_counter() == 0);
+
+  lmodel->remove_gates_by_template_type(inv);
+  CPPUNIT_ASSERT(index.get_num_gates_by_template(inv) == 0);
+  CPPUNIT_ASSERT(lmodel->gates_begin() != lmodel->gates_end()); // the gate without template
+  CPPUNIT_ASSERT(index.size() == 1);
+}
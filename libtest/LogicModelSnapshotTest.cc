@@ -0,0 +1,156 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <LogicModelSnapshot.h>
+#include <LogicModelTransaction.h>
+
+#include "LogicModelSnapshotTest.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (LogicModelSnapshotTest);
+
+using namespace degate;
+
+void LogicModelSnapshotTest::setUp(void) {
+}
+
+void LogicModelSnapshotTest::tearDown(void) {
+}
+
+void LogicModelSnapshotTest::test_region_queries(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+
+  lmodel->add_object(0, Gate_shptr(new Gate(100, 150, 100, 140, Gate::ORIENTATION_NORMAL)));
+  lmodel->add_object(0, Via_shptr(new Via(500, 500, 10)));
+  // a wire, that spans several grid cells
+  lmodel->add_object(0, Wire_shptr(new Wire(10, 900, 990, 900, 5)));
+
+  LogicModelSnapshot snapshot(lmodel, 100);
+  CPPUNIT_ASSERT(snapshot.get_num_layers() == 1);
+  CPPUNIT_ASSERT(snapshot.get_num_objects(0) == 3);
+
+  CPPUNIT_ASSERT(snapshot.exists_type_in_region<Gate>(0, 140, 160, 130, 135));
+  CPPUNIT_ASSERT(!snapshot.exists_type_in_region<Gate>(0, 151, 200, 100, 140));
+  CPPUNIT_ASSERT(!snapshot.exists_type_in_region<Via>(0, 140, 160, 130, 135));
+  CPPUNIT_ASSERT(snapshot.exists_type_in_region<Via>(0, 490, 495, 490, 495));
+  CPPUNIT_ASSERT(snapshot.exists_type_in_region<Wire>(0, 600, 610, 890, 910));
+
+  // same semantics as Layer::get_distance_to_gate_boundary()
+  CPPUNIT_ASSERT(snapshot.get_distance_to_gate_boundary(0, 120, 90, true, 20, 20) ==
+		 lmodel->get_layer(0)->get_distance_to_gate_boundary(120, 90, true, 20, 20));
+  CPPUNIT_ASSERT(snapshot.get_distance_to_gate_boundary(0, 120, 90, true, 20, 20) == 30);
+  CPPUNIT_ASSERT(snapshot.get_distance_to_gate_boundary(0, 120, 90, false, 20, 20) == 50);
+  CPPUNIT_ASSERT(snapshot.get_distance_to_gate_boundary(0, 300, 300, true, 20, 20) == 0);
+
+  CPPUNIT_ASSERT_THROW(snapshot.get_num_objects(1), DegateRuntimeException);
+}
+
+void LogicModelSnapshotTest::test_isolation(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+  Gate_shptr gate(new Gate(100, 150, 100, 140, Gate::ORIENTATION_NORMAL));
+  lmodel->add_object(0, gate);
+
+  LogicModelSnapshot snapshot(lmodel);
+
+  // changes of the logic model are not visible in the snapshot
+  lmodel->add_object(0, Gate_shptr(new Gate(500, 550, 500, 540, Gate::ORIENTATION_NORMAL)));
+  gate->shift_x(300);
+  CPPUNIT_ASSERT(!snapshot.exists_type_in_region<Gate>(0, 510, 520, 510, 520));
+  CPPUNIT_ASSERT(snapshot.exists_type_in_region<Gate>(0, 110, 120, 110, 120));
+  CPPUNIT_ASSERT(!snapshot.exists_type_in_region<Gate>(0, 410, 420, 110, 120));
+
+  // objects added to the snapshot are not visible in the logic model
+  snapshot.add_object(0, Gate_shptr(new Gate(700, 750, 700, 740, Gate::ORIENTATION_NORMAL)));
+  CPPUNIT_ASSERT(snapshot.exists_type_in_region<Gate>(0, 710, 720, 710, 720));
+  CPPUNIT_ASSERT(!lmodel->get_layer(0)->exists_type_in_region<Gate>(710, 720, 710, 720));
+  CPPUNIT_ASSERT(snapshot.get_num_objects(0) == 2);
+}
+
+void LogicModelSnapshotTest::test_commit(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+
+  GateTemplate_shptr tmpl(new GateTemplate(50, 40));
+  GateTemplatePort_shptr port(new GateTemplatePort(10, 10, GateTemplatePort::PORT_TYPE_IN));
+  port->set_object_id(lmodel->get_new_object_id());
+  tmpl->add_template_port(port);
+  lmodel->add_gate_template(tmpl);
+
+  LogicModelTransaction t;
+  t.add_gate(0, Gate_shptr(new Gate(100, 150, 100, 140, Gate::ORIENTATION_NORMAL)), tmpl);
+  t.add_gate(0, Gate_shptr(new Gate(300, 350, 100, 140, Gate::ORIENTATION_NORMAL)), tmpl);
+  t.add_object(0, Via_shptr(new Via(500, 500, 10)), LogicModelTransaction::SKIP_IF_OCCUPIED);
+  CPPUNIT_ASSERT(t.size() == 3);
+
+  // the editor placed a gate while the algorithm was running
+  lmodel->add_object(0, Gate_shptr(new Gate(320, 370, 120, 160, Gate::ORIENTATION_NORMAL)));
+
+  // the template is only referenced after the commit
+  CPPUNIT_ASSERT(tmpl->get_reference_counter() == 0);
+
+  CPPUNIT_ASSERT(t.commit(lmodel) == 2);
+  CPPUNIT_ASSERT(t.get_num_skipped() == 1);
+  CPPUNIT_ASSERT(t.empty());
+
+  CPPUNIT_ASSERT(tmpl->get_reference_counter() == 1);
+  CPPUNIT_ASSERT(lmodel->get_layer(0)->exists_type_in_region<Gate>(110, 120, 110, 120));
+  CPPUNIT_ASSERT(lmodel->get_layer(0)->exists_type_in_region<Via>(500, 501, 500, 501));
+  CPPUNIT_ASSERT(lmodel->get_layer(0)->exists_type_in_region<GatePort>(110, 110, 110, 110));
+}
+
+void LogicModelSnapshotTest::test_rollback(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+
+  Via_shptr existing(new Via(500, 500, 10));
+  lmodel->add_object(0, existing);
+
+  LogicModelTransaction t;
+  t.add_object(0, Wire_shptr(new Wire(10, 10, 90, 10, 5)));
+  // the same object again, the logic model rejects it
+  t.add_object(0, existing);
+
+  CPPUNIT_ASSERT_THROW(t.commit(lmodel), DegateLogicException);
+
+  // the wire was removed again
+  CPPUNIT_ASSERT(!lmodel->get_layer(0)->exists_type_in_region<Wire>(0, 100, 0, 20));
+  CPPUNIT_ASSERT(lmodel->get_layer(0)->exists_type_in_region<Via>(500, 501, 500, 501));
+
+  // A gate, that is not inserted, does not keep its template.
+  GateTemplate_shptr tmpl(new GateTemplate(10, 10));
+  lmodel->add_gate_template(tmpl);
+
+  Gate_shptr gate1(new Gate(100, 110, 100, 110));
+  Gate_shptr gate2(new Gate(200, 210, 200, 210));
+  gate2->set_object_id(existing->get_object_id()); // rejected by the logic model
+
+  LogicModelTransaction t2;
+  t2.add_gate(0, gate1, tmpl);
+  t2.add_gate(0, gate2, tmpl);
+
+  CPPUNIT_ASSERT_THROW(t2.commit(lmodel), DegateLogicException);
+  CPPUNIT_ASSERT(tmpl->get_reference_counter() == 0);
+  CPPUNIT_ASSERT(!gate1->has_template());
+  CPPUNIT_ASSERT(!gate2->has_template());
+  CPPUNIT_ASSERT(!lmodel->get_layer(0)->exists_type_in_region<Gate>(100, 210, 100, 210));
+}
@@ -27,6 +27,9 @@
 #include "QuadTree.h"
 #include "Wire.h"
 #include "Via.h"
+#include "DenseObjectMap.h"
+
+#include <map>
 
 CPPUNIT_TEST_SUITE_REGISTRATION (LogicModelTest);
 
@@ -144,3 +147,103 @@ void LogicModelTest::test_add_and_retrieve_wire(void) {
 }
 
 
+
+void LogicModelTest::test_remove_objects(void) {
+  LogicModel_shptr lmodel(new LogicModel(100, 100));
+
+  std::vector<Via_shptr> vias;
+  for(int j = 0; j < 100; j++) {
+    Via_shptr v(new Via(10 + j % 50, 10 + j / 50, 5));
+    lmodel->add_object(0, v);
+    vias.push_back(v);
+  }
+
+  // remove every second via, the others must still be found
+  for(int j = 0; j < 100; j += 2) lmodel->remove_object(vias[j]);
+
+  for(int j = 0; j < 100; j++) {
+    if(j % 2 == 0)
+      CPPUNIT_ASSERT_THROW(lmodel->get_object(vias[j]->get_object_id()), CollectionLookupException);
+    else
+      CPPUNIT_ASSERT(lmodel->get_object(vias[j]->get_object_id()) == vias[j]);
+  }
+
+  int n = 0;
+  for(LogicModel::via_collection::iterator iter = lmodel->vias_begin();
+      iter != lmodel->vias_end(); ++iter, n++)
+    CPPUNIT_ASSERT(iter->second->get_object_id() == iter->first);
+  CPPUNIT_ASSERT(n == 50);
+}
+
+void LogicModelTest::test_dense_object_map(void) {
+
+  DenseObjectMap<int> m;
+  std::map<object_id_t, int> reference;
+
+  // random operations, compare against std::map
+  srand(23);
+  for(int i = 0; i < 100000; i++) {
+    object_id_t key = rand() % 1000 + 1;
+    switch(rand() % 3) {
+    case 0:
+      m[key] = i;
+      reference[key] = i;
+      break;
+    case 1:
+      CPPUNIT_ASSERT(m.erase(key) == reference.erase(key));
+      break;
+    default:
+      CPPUNIT_ASSERT((m.find(key) != m.end()) == (reference.find(key) != reference.end()));
+      if(m.find(key) != m.end()) CPPUNIT_ASSERT(m.find(key)->second == reference[key]);
+    }
+    CPPUNIT_ASSERT(m.size() == reference.size());
+  }
+
+  // ordered keys must match the std::map order
+  std::vector<object_id_t> keys = m.get_ordered_keys();
+  CPPUNIT_ASSERT(keys.size() == reference.size());
+  int i = 0;
+  for(std::map<object_id_t, int>::iterator iter = reference.begin();
+      iter != reference.end(); ++iter, i++)
+    CPPUNIT_ASSERT(keys[i] == iter->first);
+
+  // erase while iterating
+  for(DenseObjectMap<int>::iterator iter = m.begin(); iter != m.end(); ) {
+    if(iter->second % 2) iter = m.erase(iter);
+    else ++iter;
+  }
+
+  for(DenseObjectMap<int>::iterator iter = m.begin(); iter != m.end(); ++iter) {
+    CPPUNIT_ASSERT(iter->second % 2 == 0);
+    CPPUNIT_ASSERT(m.find(iter->first) == iter);
+  }
+}
+
+void LogicModelTest::test_object_text(void) {
+
+  Via_shptr v1(new Via(10, 10, 5));
+  CPPUNIT_ASSERT(!v1->has_name());
+  CPPUNIT_ASSERT(!v1->has_description());
+  CPPUNIT_ASSERT(v1->get_name().empty());
+
+  v1->set_name("v1");
+  CPPUNIT_ASSERT(v1->has_name());
+  CPPUNIT_ASSERT(!v1->has_description());
+  CPPUNIT_ASSERT(v1->get_name() == "v1");
+
+  // copies do not share the name
+  Via v2(*v1);
+  v2.set_name("v2");
+  v2.set_description("copy");
+  CPPUNIT_ASSERT(v1->get_name() == "v1");
+  CPPUNIT_ASSERT(!v1->has_description());
+  CPPUNIT_ASSERT(v2.get_name() == "v2");
+
+  *v1 = v2;
+  CPPUNIT_ASSERT(v1->get_name() == "v2");
+  CPPUNIT_ASSERT(v1->get_description() == "copy");
+
+  v1->set_name("");
+  CPPUNIT_ASSERT(!v1->has_name());
+  CPPUNIT_ASSERT(v1->has_description());
+}
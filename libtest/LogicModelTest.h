@@ -37,6 +37,9 @@ class LogicModelTest : public CPPUNIT_NS::TestFixture {
   CPPUNIT_TEST (test_add_layer);
   CPPUNIT_TEST (test_add_and_retrieve_placed_lmo);
   CPPUNIT_TEST (test_add_and_retrieve_wire);
+  CPPUNIT_TEST (test_remove_objects);
+  CPPUNIT_TEST (test_dense_object_map);
+  CPPUNIT_TEST (test_object_text);
 
   CPPUNIT_TEST_SUITE_END ();
 	
@@ -53,6 +56,9 @@ protected:
   void test_add_layer(void);
   void test_add_and_retrieve_placed_lmo(void);
   void test_add_and_retrieve_wire(void);
+  void test_remove_objects(void);
+  void test_dense_object_map(void);
+  void test_object_text(void);
 
 };
 
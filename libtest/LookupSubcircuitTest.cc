@@ -21,7 +21,11 @@
 
 
 #include "LookupSubcircuitTest.h"
+#include "TestHelper.h"
 #include <ProjectImporter.h>
+#include <Module.h>
+
+#include <boost/foreach.hpp>
 
 #include "globals.h"
 #include <stdlib.h>
@@ -37,6 +41,165 @@ void LookupSubcircuitTest::setUp(void) {
 void LookupSubcircuitTest::tearDown(void) {
 }
 
+/*
+ * A logic model with xor gates, flipflops and inverters.
+ */
+struct TestModel {
+
+  LogicModel_shptr lmodel;
+  GateTemplate_shptr xor_tmpl, dff_tmpl, inv_tmpl;
+  unsigned int num_gates;
+
+  TestModel() : lmodel(new LogicModel(2000, 2000, 1)), num_gates(0) {
+    std::vector<std::string> in;
+    in.push_back("a");
+    inv_tmpl = create_test_template(lmodel, "inverter", in, "y");
+    in.push_back("b");
+    xor_tmpl = create_test_template(lmodel, "xor", in, "y");
+    in.clear();
+    in.push_back("D");
+    dff_tmpl = create_test_template(lmodel, "flipflop-async-rst", in, "Q");
+  }
+
+  Gate_shptr add_gate(GateTemplate_shptr tmpl) {
+    unsigned int x = (num_gates % 50) * 20, y = (num_gates / 50) * 20;
+    num_gates++;
+    return create_test_gate(lmodel, tmpl, x, y);
+  }
+
+  GatePort_shptr port(Gate_shptr gate, std::string const& name) {
+    return get_test_port(gate, name);
+  }
+
+  void connect(GatePort_shptr a, GatePort_shptr b) {
+    if(a->get_net() != NULL) b->set_net(a->get_net());
+    else {
+      Net_shptr net(new Net());
+      a->set_net(net);
+      b->set_net(net);
+      lmodel->add_net(net);
+    }
+  }
+
+  /*
+   * An LFSR tap: two flipflops feed a xor, that feeds a third flipflop.
+   * If \p shared_input is set, the xor inputs come from the first flipflop only.
+   * If \p inverter_output is set, the xor feeds an inverter instead.
+   */
+  void add_tap(bool shared_input = false, bool inverter_output = false) {
+    Gate_shptr ff1 = add_gate(dff_tmpl);
+    Gate_shptr ff2 = add_gate(dff_tmpl);
+    Gate_shptr x = add_gate(xor_tmpl);
+    Gate_shptr out = add_gate(inverter_output ? inv_tmpl : dff_tmpl);
+    connect(port(ff1, "Q"), port(x, "a"));
+    connect(port(shared_input ? ff1 : ff2, "Q"), port(x, "b"));
+    connect(port(x, "y"), port(out, inverter_output ? "a" : "D"));
+  }
+};
+
+static SubcircuitPattern create_tap_pattern() {
+  SubcircuitPattern pattern;
+  unsigned int ff1 = pattern.add_gate("flipflop");
+  unsigned int ff2 = pattern.add_gate("flipflop");
+  unsigned int x = pattern.add_gate("xor");
+  unsigned int ff3 = pattern.add_gate("flipflop");
+  pattern.connect(ff1, "Q", x, "a");
+  pattern.connect(ff2, "Q", x, "b");
+  pattern.connect(x, "y", ff3, "D");
+  return pattern;
+}
+
+void LookupSubcircuitTest::test_pattern(void) {
+
+  SubcircuitPattern pattern = create_tap_pattern();
+  CPPUNIT_ASSERT(pattern.get_num_gates() == 4);
+  CPPUNIT_ASSERT(pattern.get_num_nets() == 3);
+  CPPUNIT_ASSERT(pattern.get_net_size(0) == 2);
+  CPPUNIT_ASSERT(pattern.get_gate(2).ports.size() == 3);
+
+  unsigned int n = pattern.add_net();
+  pattern.connect(n, 0, "D");
+  CPPUNIT_ASSERT(pattern.get_net_size(n) == 1);
+
+  // a port can only be connected once
+  CPPUNIT_ASSERT_THROW(pattern.connect(n, 0, "Q"), DegateLogicException);
+  CPPUNIT_ASSERT_THROW(pattern.connect(n, 7, "Q"), DegateLogicException);
+}
+
+void LookupSubcircuitTest::test_search(void) {
+
+  TestModel m;
+  for(unsigned int i = 0; i < 5; i++) m.add_tap();
+  m.add_tap(true, false);
+  m.add_tap(false, true);
+
+  LookupSubcircuit lsc(m.lmodel);
+  LookupSubcircuit::match_list matches = lsc.search(create_tap_pattern(), 1);
+  CPPUNIT_ASSERT(matches.size() == 5);
+
+  BOOST_FOREACH(LookupSubcircuit::match const& match, matches) {
+    CPPUNIT_ASSERT(match.size() == 4);
+    CPPUNIT_ASSERT(match[2]->get_gate_template() == m.xor_tmpl);
+    CPPUNIT_ASSERT(match[0] != match[1]);
+    CPPUNIT_ASSERT(m.port(match[0], "Q")->get_net() == m.port(match[2], "a")->get_net());
+    CPPUNIT_ASSERT(m.port(match[2], "y")->get_net() == m.port(match[3], "D")->get_net());
+  }
+
+  // a port name, that does not exist
+  SubcircuitPattern pattern;
+  pattern.connect(pattern.add_gate("xor"), "y", pattern.add_gate("flipflop"), "CLK");
+  CPPUNIT_ASSERT(lsc.search(pattern).empty());
+}
+
+void LookupSubcircuitTest::test_symmetric_pattern(void) {
+
+  TestModel m;
+  Gate_shptr ff = m.add_gate(m.dff_tmpl);
+  for(unsigned int i = 0; i < 3; i++) m.connect(m.port(ff, "Q"), m.port(m.add_gate(m.xor_tmpl), "a"));
+
+  // two xor gates, that share an input net
+  SubcircuitPattern pattern;
+  pattern.connect(pattern.add_gate("xor"), "a", pattern.add_gate("xor"), "a");
+
+  LookupSubcircuit lsc(m.lmodel);
+  CPPUNIT_ASSERT(lsc.search(pattern, 1).size() == 3);
+}
+
+void LookupSubcircuitTest::test_parallel_search(void) {
+
+  TestModel m;
+  for(unsigned int i = 0; i < 100; i++) m.add_tap(i % 7 == 0, i % 11 == 0);
+
+  LookupSubcircuit lsc(m.lmodel);
+  LookupSubcircuit::match_list single = lsc.search(create_tap_pattern(), 1);
+  LookupSubcircuit::match_list parallel = lsc.search(create_tap_pattern(), 4);
+
+  CPPUNIT_ASSERT(single.size() > 50);
+  CPPUNIT_ASSERT(single == parallel);
+}
+
+void LookupSubcircuitTest::test_create_module(void) {
+
+  TestModel m;
+  m.add_tap();
+  m.add_tap();
+
+  LookupSubcircuit lsc(m.lmodel);
+  LookupSubcircuit::match_list matches = lsc.search(create_tap_pattern());
+  CPPUNIT_ASSERT(matches.size() == 2);
+
+  // chain the taps
+  m.connect(m.port(matches[0][3], "Q"), m.port(matches[1][0], "D"));
+
+  Module_shptr module = lsc.create_module(matches[0], "tap0", "lfsr_tap");
+  CPPUNIT_ASSERT(std::distance(module->gates_begin(), module->gates_end()) == 4);
+  CPPUNIT_ASSERT(m.lmodel->get_main_module()->lookup_module("main_module/tap0") == module);
+
+  // the output of the last flipflop leaves the module
+  CPPUNIT_ASSERT(std::distance(module->ports_begin(), module->ports_end()) == 1);
+  CPPUNIT_ASSERT(module->ports_begin()->second == m.port(matches[0][3], "Q"));
+}
+
 void LookupSubcircuitTest::test(void) {
 
   ProjectImporter importer;
@@ -49,5 +212,5 @@ void LookupSubcircuitTest::test(void) {
   assert(lmodel != NULL);
 
   LookupSubcircuit lsc(lmodel);
-  lsc.search();
+  lsc.search(create_tap_pattern());
 }
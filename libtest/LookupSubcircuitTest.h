@@ -30,6 +30,11 @@ class LookupSubcircuitTest : public CPPUNIT_NS :: TestFixture {
 
   CPPUNIT_TEST_SUITE(LookupSubcircuitTest);
 
+  CPPUNIT_TEST (test_pattern);
+  CPPUNIT_TEST (test_search);
+  CPPUNIT_TEST (test_symmetric_pattern);
+  CPPUNIT_TEST (test_parallel_search);
+  CPPUNIT_TEST (test_create_module);
   CPPUNIT_TEST (test);
 
   CPPUNIT_TEST_SUITE_END ();
@@ -40,6 +45,11 @@ class LookupSubcircuitTest : public CPPUNIT_NS :: TestFixture {
 
  protected:
 
+  void test_pattern(void);
+  void test_search(void);
+  void test_symmetric_pattern(void);
+  void test_parallel_search(void);
+  void test_create_module(void);
   void test(void);
 
 };
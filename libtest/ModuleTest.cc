@@ -0,0 +1,273 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <Module.h>
+#include <LogicModelImporter.h>
+#include <GateLibraryImporter.h>
+
+#include <boost/format.hpp>
+
+#include "ModuleTest.h"
+#include "TestHelper.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (ModuleTest);
+
+using namespace degate;
+
+void ModuleTest::setUp(void) {
+}
+
+void ModuleTest::tearDown(void) {
+}
+
+/*
+ * A small linear congruential generator, so that two models
+ * can be built with the same pseudo random structure.
+ */
+class TestRandom {
+  unsigned int state;
+public:
+  TestRandom(unsigned int seed) : state(seed) {}
+  unsigned int next(unsigned int n) {
+    state = state * 1103515245 + 12345;
+    return (state >> 16) % n;
+  }
+};
+
+/*
+ * Build a logic model with a module hierarchy and random nets:
+ *
+ *   main
+ *    +- m1
+ *    |   +- m11
+ *    |   +- m12
+ *    +- m2
+ *        +- m21
+ */
+static LogicModel_shptr create_model(unsigned int seed, std::vector<GatePort_shptr> & gate_ports) {
+
+  TestRandom rnd(seed);
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+
+  std::vector<std::string> in1(1, "a"), in2(in1);
+  in2.push_back("b");
+
+  GateTemplate_shptr templates[] = {
+    create_test_template(lmodel, "", in1, "y"),
+    create_test_template(lmodel, "", in2, "y"),
+    create_test_template(lmodel, "", in1, "y", GateTemplatePort::PORT_TYPE_INOUT)
+  };
+
+  Module_shptr main_module = lmodel->get_main_module();
+  std::vector<Module_shptr> modules;
+  modules.push_back(main_module);
+
+  const char * names[] = { "m1", "m11", "m12", "m2", "m21" };
+  const unsigned int parents[] = { 0, 1, 1, 0, 4 };
+  for(unsigned int i = 0; i < 5; i++)
+    modules.push_back(create_test_module(lmodel, modules[parents[i]], names[i]));
+
+  for(unsigned int i = 0; i < 80; i++) {
+    Gate_shptr gate = create_test_gate(lmodel, templates[rnd.next(3)], (i % 40) * 20, (i / 40) * 20);
+
+    unsigned int m = rnd.next(modules.size());
+    if(m != 0) {
+      main_module->remove_gate(gate);
+      modules[m]->add_gate(gate, false);
+    }
+
+    for(Gate::port_iterator iter = gate->ports_begin(); iter != gate->ports_end(); ++iter)
+      gate_ports.push_back(*iter);
+  }
+
+  // Connect most of the ports. Some nets have vias or module port emarkers.
+  unsigned int num_emarkers = 0;
+  for(unsigned int i = 0; i < 50; i++) {
+
+    Net_shptr net(new Net());
+    unsigned int size = 2 + rnd.next(6);
+
+    for(unsigned int j = 0; j < size; j++) {
+      GatePort_shptr gport = gate_ports[rnd.next(gate_ports.size())];
+      if(gport->get_net() == NULL) gport->set_net(net);
+    }
+
+    switch(rnd.next(4)) {
+    case 0: {
+      Via_shptr via(new Via(900, 10 * i, 4));
+      lmodel->add_object(0, via);
+      via->set_net(net);
+      break;
+    }
+    case 1: {
+      EMarker_shptr em(new EMarker(950, 10 * i));
+      em->set_name((boost::format("ext%1%") % num_emarkers++).str());
+      em->set_description("module-port");
+      lmodel->add_object(0, em);
+      em->set_net(net);
+      break;
+    }
+    }
+
+    lmodel->add_net(net);
+  }
+
+  return lmodel;
+}
+
+static void compare_ports(Module::port_collection const& expected, Module_shptr module) {
+
+  CPPUNIT_ASSERT(expected.size() == (size_t)std::distance(module->ports_begin(), module->ports_end()));
+
+  Module::port_collection::const_iterator e_iter = expected.begin();
+  for(Module::port_collection::const_iterator iter = module->ports_begin();
+      iter != module->ports_end(); ++iter, ++e_iter) {
+    CPPUNIT_ASSERT(e_iter->first == iter->first);
+    CPPUNIT_ASSERT(e_iter->second->get_object_id() == iter->second->get_object_id());
+  }
+}
+
+static void compare_module_ports(Module_shptr a, Module_shptr b) {
+
+  CPPUNIT_ASSERT(a->get_name() == b->get_name());
+  compare_ports(Module::port_collection(a->ports_begin(), a->ports_end()), b);
+
+  CPPUNIT_ASSERT(std::distance(a->modules_begin(), a->modules_end()) ==
+		 std::distance(b->modules_begin(), b->modules_end()));
+
+  for(Module::module_collection::const_iterator a_iter = a->modules_begin(), b_iter = b->modules_begin();
+      a_iter != a->modules_end(); ++a_iter, ++b_iter)
+    compare_module_ports(*a_iter, *b_iter);
+}
+
+static unsigned int count_module_ports(Module_shptr module) {
+  unsigned int n = std::distance(module->ports_begin(), module->ports_end());
+  for(Module::module_collection::const_iterator iter = module->modules_begin();
+      iter != module->modules_end(); ++iter)
+    n += count_module_ports(*iter);
+  return n;
+}
+
+/*
+ * The ports of the main module are the gate ports, whose net has an
+ * emarker described as 'module-port'. Look at every object of the nets.
+ * This is slow, but it does not depend on the netlist graph.
+ */
+static Module::port_collection determine_root_ports_reference(LogicModel_shptr lmodel) {
+
+  Module::port_collection ports;
+  Module_shptr main_module = lmodel->get_main_module();
+
+  for(Module::gate_collection::iterator g_iter = main_module->gates_begin();
+      g_iter != main_module->gates_end(); ++g_iter) {
+
+    for(Gate::port_const_iterator p_iter = (*g_iter)->ports_begin();
+	p_iter != (*g_iter)->ports_end(); ++p_iter) {
+
+      Net_shptr net = (*p_iter)->get_net();
+      if(net == NULL) continue;
+
+      for(Net::connection_iterator c_iter = net->begin(); c_iter != net->end(); ++c_iter) {
+	EMarker_shptr em = std::tr1::dynamic_pointer_cast<EMarker>(lmodel->get_object(*c_iter));
+	if(em != NULL && em->get_description() == "module-port") {
+	  ports[em->get_name()] = *p_iter;
+	  break;
+	}
+      }
+    }
+  }
+
+  return ports;
+}
+
+/*
+ * Check the ports, that determine_module_ports_for_hierarchy() found in
+ * \p lmodel. The expected ports of the main module are computed by brute
+ * force. The expected ports of the sub-modules are computed in \p reference,
+ * a copy of the logic model, with the per-module implementation.
+ */
+static void check_module_ports(LogicModel_shptr lmodel, LogicModel_shptr reference) {
+
+  determine_module_ports_for_hierarchy(lmodel);
+  reference->get_main_module()->determine_module_ports_recursive();
+
+  Module_shptr main_module = lmodel->get_main_module();
+  Module_shptr ref_main_module = reference->get_main_module();
+
+  compare_ports(determine_root_ports_reference(lmodel), main_module);
+
+  CPPUNIT_ASSERT(std::distance(ref_main_module->modules_begin(), ref_main_module->modules_end()) ==
+		 std::distance(main_module->modules_begin(), main_module->modules_end()));
+
+  for(Module::module_collection::const_iterator a_iter = ref_main_module->modules_begin(),
+	b_iter = main_module->modules_begin();
+      a_iter != ref_main_module->modules_end(); ++a_iter, ++b_iter)
+    compare_module_ports(*a_iter, *b_iter);
+}
+
+void ModuleTest::test_module_ports_for_hierarchy(void) {
+
+  unsigned int num_root_ports = 0;
+
+  for(unsigned int seed = 1; seed <= 5; seed++) {
+
+    std::vector<GatePort_shptr> ports_a, ports_b;
+    LogicModel_shptr lmodel_a = create_model(seed, ports_a);
+    LogicModel_shptr lmodel_b = create_model(seed, ports_b);
+
+    check_module_ports(lmodel_b, lmodel_a);
+    CPPUNIT_ASSERT(count_module_ports(lmodel_b->get_main_module()) > 0);
+    num_root_ports += std::distance(lmodel_b->get_main_module()->ports_begin(),
+				    lmodel_b->get_main_module()->ports_end());
+
+    // A second run reuses port names and sees the sub-module ports of the first run.
+    TestRandom rnd(seed);
+    for(unsigned int i = 0; i < 10; i++) {
+      unsigned int from = rnd.next(ports_a.size()), to = rnd.next(ports_a.size());
+      if(ports_a[to]->get_net() != NULL) {
+	ports_a[from]->set_net(ports_a[to]->get_net());
+	ports_b[from]->set_net(ports_b[to]->get_net());
+      }
+    }
+
+    check_module_ports(lmodel_b, lmodel_a);
+  }
+
+  CPPUNIT_ASSERT(num_root_ports > 0);
+}
+
+void ModuleTest::test_module_ports_for_hierarchy_project(void) {
+
+  GateLibraryImporter gate_library_importer;
+  std::string gl_filename("libtest/testfiles/testproject/gate_library.xml");
+  std::string lm_filename("libtest/testfiles/testproject/lmodel.xml");
+
+  GateLibrary_shptr glib_a(gate_library_importer.import(gl_filename));
+  GateLibrary_shptr glib_b(gate_library_importer.import(gl_filename));
+
+  LogicModelImporter lm_importer_a(10000, 10000, glib_a);
+  LogicModelImporter lm_importer_b(10000, 10000, glib_b);
+  LogicModel_shptr lmodel_a(lm_importer_a.import(lm_filename));
+  LogicModel_shptr lmodel_b(lm_importer_b.import(lm_filename));
+
+  check_module_ports(lmodel_b, lmodel_a);
+}
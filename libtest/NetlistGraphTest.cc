@@ -0,0 +1,242 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <NetlistGraph.h>
+#include <LookupSubcircuit.h>
+
+#include "NetlistGraphTest.h"
+#include "TestHelper.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (NetlistGraphTest);
+
+using namespace degate;
+
+void NetlistGraphTest::setUp(void) {
+}
+
+void NetlistGraphTest::tearDown(void) {
+}
+
+/*
+ * Two inverters and a flipflop:
+ *
+ *  n1: inv1.Y -> inv2.A, ff.D, emarker
+ *  n2: ff.Q -> inv1.A
+ *
+ * The fourth gate has no template.
+ */
+struct TestCircuit {
+
+  LogicModel_shptr lmodel;
+  Gate_shptr inv1, inv2, ff, other;
+  Net_shptr n1, n2;
+  EMarker_shptr em;
+
+  TestCircuit() : lmodel(new LogicModel(200, 100, 1)) {
+
+    GateTemplate_shptr inv = create_test_template(lmodel, "inverter", "A", "Y");
+    GateTemplate_shptr dff = create_test_template(lmodel, "flipflop-async-rst", "D", "Q");
+
+    inv1 = create_test_gate(lmodel, inv, 0);
+    inv2 = create_test_gate(lmodel, inv, 20);
+    ff = create_test_gate(lmodel, dff, 40);
+    other = create_test_gate(lmodel, GateTemplate_shptr(), 60);
+
+    em = EMarker_shptr(new EMarker(100, 50));
+    lmodel->add_object(0, em);
+
+    n1 = Net_shptr(new Net());
+    get_test_port(inv1, "Y")->set_net(n1);
+    get_test_port(inv2, "A")->set_net(n1);
+    get_test_port(ff, "D")->set_net(n1);
+    em->set_net(n1);
+    lmodel->add_net(n1);
+
+    n2 = Net_shptr(new Net());
+    get_test_port(ff, "Q")->set_net(n2);
+    get_test_port(inv1, "A")->set_net(n2);
+    lmodel->add_net(n2);
+  }
+};
+
+void NetlistGraphTest::test_build(void) {
+
+  TestCircuit c;
+  NetlistGraph_shptr graph = c.lmodel->get_netlist_graph();
+
+  CPPUNIT_ASSERT(graph->get_num_gates() == 4);
+  CPPUNIT_ASSERT(graph->get_num_ports() == 6);
+  CPPUNIT_ASSERT(graph->get_num_nets() == 2);
+  CPPUNIT_ASSERT(!graph->is_dirty());
+
+  // gates are ordered by object ID
+  NetlistGraph::index_t g_inv1 = graph->get_gate_index(c.inv1->get_object_id());
+  NetlistGraph::index_t g_ff = graph->get_gate_index(c.ff->get_object_id());
+  NetlistGraph::index_t g_other = graph->get_gate_index(c.other->get_object_id());
+  CPPUNIT_ASSERT(g_inv1 == 0);
+  CPPUNIT_ASSERT(g_ff == 2);
+  CPPUNIT_ASSERT(graph->get_gate(g_ff) == c.ff);
+  CPPUNIT_ASSERT(graph->get_gate_index(c.em->get_object_id()) == NetlistGraph::no_index);
+  CPPUNIT_ASSERT(graph->get_first_port(g_other) == graph->get_end_port(g_other));
+
+  // drivers and loads
+  NetlistGraph::index_t n1 = graph->get_net_index(c.n1->get_object_id());
+  CPPUNIT_ASSERT(graph->get_net(n1) == c.n1);
+  CPPUNIT_ASSERT(graph->get_net_size(n1) == 4);
+
+  NetlistGraph::index_range drivers = graph->get_net_drivers(n1);
+  CPPUNIT_ASSERT(drivers.second - drivers.first == 1);
+  CPPUNIT_ASSERT(graph->get_port(*drivers.first) == get_test_port(c.inv1, "Y"));
+
+  NetlistGraph::index_range loads = graph->get_net_loads(n1);
+  CPPUNIT_ASSERT(loads.second - loads.first == 2);
+  CPPUNIT_ASSERT(graph->get_port_gate(loads.first[1]) == g_ff);
+
+  NetlistGraph::index_range emarkers = graph->get_net_emarkers(n1);
+  CPPUNIT_ASSERT(emarkers.second - emarkers.first == 1);
+  CPPUNIT_ASSERT(graph->get_emarker(*emarkers.first) == c.em);
+
+  NetlistGraph::index_t p = graph->get_port_index(get_test_port(c.ff, "Q")->get_object_id());
+  CPPUNIT_ASSERT(graph->get_port_net(p) == graph->get_net_index(c.n2->get_object_id()));
+  CPPUNIT_ASSERT(graph->is_driver(p) && !graph->is_load(p) && graph->is_connected(p));
+
+  // logic classes
+  std::vector<bool> mask;
+  graph->match_logic_class("flipflop", mask);
+  CPPUNIT_ASSERT(mask[graph->get_logic_class(g_ff)]);
+  CPPUNIT_ASSERT(!mask[graph->get_logic_class(g_inv1)]);
+  CPPUNIT_ASSERT(graph->get_logic_class(g_other) == NetlistGraph::no_logic_class);
+
+  graph->match_logic_class("", mask);
+  CPPUNIT_ASSERT(mask[graph->get_logic_class(g_inv1)]);
+  CPPUNIT_ASSERT(!mask[graph->get_logic_class(g_other)]);
+}
+
+void NetlistGraphTest::test_fan_lists(void) {
+
+  TestCircuit c;
+  NetlistGraph_shptr graph = c.lmodel->get_netlist_graph();
+
+  NetlistGraph::index_t g_inv1 = graph->get_gate_index(c.inv1->get_object_id());
+  NetlistGraph::index_t g_inv2 = graph->get_gate_index(c.inv2->get_object_id());
+  NetlistGraph::index_t g_ff = graph->get_gate_index(c.ff->get_object_id());
+
+  NetlistGraph::index_range out = graph->get_fanout(g_inv1);
+  CPPUNIT_ASSERT(out.second - out.first == 2);
+  CPPUNIT_ASSERT(out.first[0] == g_inv2 && out.first[1] == g_ff);
+
+  out = graph->get_fanout(g_inv2);
+  CPPUNIT_ASSERT(out.first == out.second);
+
+  NetlistGraph::index_range in = graph->get_fanin(g_inv1);
+  CPPUNIT_ASSERT(in.second - in.first == 1 && in.first[0] == g_ff);
+
+  in = graph->get_fanin(g_ff);
+  CPPUNIT_ASSERT(in.second - in.first == 1 && in.first[0] == g_inv1);
+
+  // the subcircuit lookup is based on the graph
+  LookupSubcircuit lsc(c.lmodel);
+  std::set<Gate_shptr> connected =
+    lsc.filter_connected_gates(c.inv1, GateTemplatePort::PORT_TYPE_OUT, "Y",
+			       "flipflop", GateTemplatePort::PORT_TYPE_IN, "D");
+  CPPUNIT_ASSERT(connected.size() == 1 && *connected.begin() == c.ff);
+
+  connected = lsc.filter_connected_gates(c.inv1, GateTemplatePort::PORT_TYPE_OUT, "",
+					 "inverter", GateTemplatePort::PORT_TYPE_IN, "");
+  CPPUNIT_ASSERT(connected.size() == 1 && *connected.begin() == c.inv2);
+}
+
+void NetlistGraphTest::test_change_notification(void) {
+
+  TestCircuit c;
+  NetlistGraph_shptr graph = c.lmodel->get_netlist_graph();
+  CPPUNIT_ASSERT(graph->get_rebuild_count() == 1);
+
+  // highlighting does not change the netlist
+  c.inv1->set_highlighted(PlacedLogicModelObject::HLIGHTSTATE_DIRECT);
+  get_test_port(c.inv1, "Y")->set_highlighted(PlacedLogicModelObject::HLIGHTSTATE_DIRECT);
+  CPPUNIT_ASSERT(!graph->is_dirty());
+
+  // moving a port into another net does
+  get_test_port(c.inv2, "A")->set_net(c.n2);
+  CPPUNIT_ASSERT(graph->is_dirty());
+
+  graph = c.lmodel->get_netlist_graph();
+  CPPUNIT_ASSERT(graph->get_rebuild_count() == 2);
+
+  NetlistGraph::index_t g_inv2 = graph->get_gate_index(c.inv2->get_object_id());
+  NetlistGraph::index_t g_ff = graph->get_gate_index(c.ff->get_object_id());
+  NetlistGraph::index_range in = graph->get_fanin(g_inv2);
+  CPPUNIT_ASSERT(in.second - in.first == 1 && in.first[0] == g_ff);
+
+  // adding and removing gates
+  Gate_shptr gate = create_test_gate(c.lmodel, GateTemplate_shptr(), 80);
+  CPPUNIT_ASSERT(graph->is_dirty());
+  graph->update();
+  CPPUNIT_ASSERT(graph->get_num_gates() == 5);
+
+  c.lmodel->remove_object(gate);
+  CPPUNIT_ASSERT(graph->is_dirty());
+  graph->update();
+  CPPUNIT_ASSERT(graph->get_num_gates() == 4);
+}
+
+void NetlistGraphTest::test_template_change(void) {
+
+  TestCircuit c;
+  NetlistGraph_shptr graph = c.lmodel->get_netlist_graph();
+
+  // The flipflop's input becomes an output. It drives n1 together with inv1.
+  get_test_port(c.ff, "D")->get_template_port()->set_port_type(GateTemplatePort::PORT_TYPE_OUT);
+  c.ff->get_gate_template()->set_logic_class("buffer");
+  c.lmodel->update_template(c.ff->get_gate_template());
+
+  // The graph is patched in place.
+  CPPUNIT_ASSERT(!graph->is_dirty());
+  graph = c.lmodel->get_netlist_graph();
+  CPPUNIT_ASSERT(graph->get_rebuild_count() == 1);
+
+  NetlistGraph::index_t g_inv1 = graph->get_gate_index(c.inv1->get_object_id());
+  NetlistGraph::index_t g_inv2 = graph->get_gate_index(c.inv2->get_object_id());
+  NetlistGraph::index_t g_ff = graph->get_gate_index(c.ff->get_object_id());
+
+  NetlistGraph::index_range drivers = graph->get_net_drivers(graph->get_net_index(c.n1->get_object_id()));
+  CPPUNIT_ASSERT(drivers.second - drivers.first == 2);
+
+  NetlistGraph::index_range out = graph->get_fanout(g_ff);
+  CPPUNIT_ASSERT(out.second - out.first == 2 && out.first[0] == g_inv1 && out.first[1] == g_inv2);
+
+  out = graph->get_fanout(g_inv1);
+  CPPUNIT_ASSERT(out.second - out.first == 1 && out.first[0] == g_inv2);
+
+  NetlistGraph::index_range in = graph->get_fanin(g_inv2);
+  CPPUNIT_ASSERT(in.second - in.first == 2 && in.first[0] == g_inv1 && in.first[1] == g_ff);
+
+  in = graph->get_fanin(g_ff);
+  CPPUNIT_ASSERT(in.first == in.second);
+
+  std::vector<bool> mask;
+  graph->match_logic_class("buffer", mask);
+  CPPUNIT_ASSERT(mask[graph->get_logic_class(g_ff)]);
+  graph->match_logic_class("flipflop", mask);
+  CPPUNIT_ASSERT(!mask[graph->get_logic_class(g_ff)]);
+}
@@ -0,0 +1,165 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <ProgressControl.h>
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <math.h>
+
+#include "ProgressTrackerTest.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (ProgressTrackerTest);
+
+using namespace degate;
+
+void ProgressTrackerTest::setUp(void) {
+}
+
+void ProgressTrackerTest::tearDown(void) {
+}
+
+void ProgressTrackerTest::test_cancellation(void) {
+
+  ProgressTracker tracker;
+  CancellationToken_shptr token = tracker.get_cancellation_token();
+  CPPUNIT_ASSERT(!token->is_canceled());
+
+  token->cancel();
+  CPPUNIT_ASSERT(tracker.get_cancellation_token()->is_canceled());
+
+  // a reset keeps the token, but clears the request
+  tracker.reset();
+  CPPUNIT_ASSERT(tracker.get_cancellation_token() == token);
+  CPPUNIT_ASSERT(!token->is_canceled());
+}
+
+void ProgressTrackerTest::test_subtasks(void) {
+
+  ProgressTracker tracker;
+  CPPUNIT_ASSERT(tracker.get_progress() == 0);
+  CPPUNIT_ASSERT(tracker.get_time_left() == -1);
+
+  ProgressTask_shptr root = tracker.get_root_task();
+  root->set_total(4);
+  root->advance();
+  CPPUNIT_ASSERT(fabs(tracker.get_progress() - 0.25) < 1e-9);
+
+  // a subtask for two units of the root task
+  ProgressTask_shptr sub = root->create_subtask(2, 10);
+  sub->advance(5);
+  CPPUNIT_ASSERT(fabs(tracker.get_progress() - 0.5) < 1e-9);
+
+  ProgressTask_shptr subsub = sub->create_subtask(5, 2);
+  subsub->advance();
+  CPPUNIT_ASSERT(fabs(sub->get_fraction() - 0.75) < 1e-9);
+  CPPUNIT_ASSERT(fabs(tracker.get_progress() - 0.625) < 1e-9);
+  CPPUNIT_ASSERT(tracker.get_time_left() >= 0);
+
+  sub->finish();
+  CPPUNIT_ASSERT(fabs(tracker.get_progress() - 0.75) < 1e-9);
+
+  // progress does not exceed 100%
+  root->advance(10);
+  CPPUNIT_ASSERT(tracker.get_progress() == 1.0);
+  CPPUNIT_ASSERT(tracker.get_time_left() == 0);
+}
+
+static void worker(ProgressTask_shptr task, CancellationToken_shptr token, unsigned long n) {
+  for(unsigned long i = 0; i < n && !token->is_canceled(); i++) task->advance();
+}
+
+void ProgressTrackerTest::test_concurrent_workers(void) {
+
+  const unsigned int num_threads = 4;
+  const unsigned long n = 100000;
+
+  ProgressTracker tracker;
+  ProgressTask_shptr root = tracker.get_root_task();
+  root->set_total(num_threads);
+
+  boost::thread_group threads;
+  for(unsigned int i = 0; i < num_threads; i++)
+    threads.create_thread(boost::bind(worker, root->create_subtask(1, n),
+				      tracker.get_cancellation_token(), n));
+  threads.join_all();
+
+  CPPUNIT_ASSERT(tracker.get_progress() == 1.0);
+
+  // shared counter
+  tracker.reset();
+  root = tracker.get_root_task();
+  root->set_total(num_threads * n);
+  for(unsigned int i = 0; i < num_threads; i++)
+    threads.create_thread(boost::bind(worker, root, tracker.get_cancellation_token(), n));
+  threads.join_all();
+
+  CPPUNIT_ASSERT(root->get_fraction() == 1.0);
+}
+
+
+class TestOperation : public ProgressControl {
+public:
+
+  void run(unsigned int steps) {
+    reset_progress();
+    set_progress_step_size(1.0 / steps);
+    for(unsigned int i = 0; i < steps / 2; i++) progress_step_done();
+  }
+
+  void run_as_part_of(TestOperation const& parent, ProgressTask_shptr task) {
+    attach_progress(parent, task);
+    run(4);
+  }
+
+  void share(TestOperation const& other) { share_progress(other); }
+
+  ProgressTask_shptr subtask(unsigned long units) { return create_progress_subtask(units); }
+};
+
+void ProgressTrackerTest::test_progress_control(void) {
+
+  TestOperation op;
+  op.run(10);
+  CPPUNIT_ASSERT(fabs(op.get_progress() - 0.5) < 1e-9);
+
+  op.set_log_message("half way");
+  CPPUNIT_ASSERT(op.has_log_message() && op.get_log_message() == "half way");
+
+  // an operation, that reports into a subtask
+  TestOperation parent, child;
+  parent.run(2); // 1 of 2 steps done
+  child.run_as_part_of(parent, parent.subtask(1));
+  CPPUNIT_ASSERT(fabs(parent.get_progress() - 0.75) < 1e-9);
+
+  // cancellation is shared
+  child.cancel();
+  CPPUNIT_ASSERT(parent.is_canceled());
+
+  // a GUI object, that shares the tracker
+  TestOperation gui;
+  gui.share(op);
+  CPPUNIT_ASSERT(gui.get_progress() == op.get_progress());
+  gui.cancel();
+  CPPUNIT_ASSERT(op.is_canceled());
+  CPPUNIT_ASSERT(gui.get_progress_tracker() == op.get_progress_tracker());
+}
@@ -0,0 +1,230 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <RenderBatchBuilder.h>
+
+#include <boost/foreach.hpp>
+
+#include "RenderBatchBuilderTest.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (RenderBatchBuilderTest);
+
+using namespace degate;
+
+void RenderBatchBuilderTest::setUp(void) {
+}
+
+void RenderBatchBuilderTest::tearDown(void) {
+}
+
+void RenderBatchBuilderTest::test_partitioning(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+  Layer_shptr layer = lmodel->get_layer(0);
+
+  // one via per chunk in the upper left 2x2 chunks
+  lmodel->add_object(0, Via_shptr(new Via(50, 50, 5)));
+  lmodel->add_object(0, Via_shptr(new Via(150, 50, 5)));
+  lmodel->add_object(0, Via_shptr(new Via(50, 150, 5)));
+  lmodel->add_object(0, Via_shptr(new Via(150, 150, 5)));
+
+  RenderBatchBuilder builder(layer, 100);
+  CPPUNIT_ASSERT(builder.get_num_chunks() == 100);
+  CPPUNIT_ASSERT(builder.get_num_dirty_chunks() == 4);
+
+  RenderBatchBuilder::chunk_list chunks;
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  CPPUNIT_ASSERT(chunks.size() == 4);
+  CPPUNIT_ASSERT(builder.get_num_dirty_chunks() == 0);
+
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * c, chunks) {
+    CPPUNIT_ASSERT(c->get_num_objects() == 1);
+    // a via is a quad made of two triangles
+    CPPUNIT_ASSERT(c->get_primitives(RenderBatchBuilder::GROUP_CONNECTIONS).triangles.size() == 6);
+    CPPUNIT_ASSERT(c->get_primitives(RenderBatchBuilder::GROUP_GATES).empty());
+  }
+}
+
+void RenderBatchBuilderTest::test_viewport_culling(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+  Layer_shptr layer = lmodel->get_layer(0);
+  RenderBatchBuilder builder(layer, 100);
+
+  lmodel->add_object(0, Wire_shptr(new Wire(10, 10, 90, 10, 5)));
+  lmodel->add_object(0, Wire_shptr(new Wire(910, 910, 990, 910, 5)));
+
+  RenderBatchBuilder::chunk_list chunks;
+  builder.get_chunks(BoundingBox(0, 200, 0, 200), chunks);
+  CPPUNIT_ASSERT(chunks.size() == 1);
+
+  // the chunk outside the viewport is not rebuilt
+  CPPUNIT_ASSERT(builder.get_num_dirty_chunks() == 1);
+
+  RenderBatchBuilder::PrimitiveSet const& p =
+    chunks.front()->get_primitives(RenderBatchBuilder::GROUP_CONNECTIONS);
+  CPPUNIT_ASSERT(p.wide_lines.size() == 1);
+  CPPUNIT_ASSERT(p.wide_lines.find(5) != p.wide_lines.end());
+  CPPUNIT_ASSERT(p.wide_lines.find(5)->second.size() == 2);
+
+  builder.get_chunks(BoundingBox(300, 400, 300, 400), chunks);
+  CPPUNIT_ASSERT(chunks.empty());
+}
+
+void RenderBatchBuilderTest::test_incremental_rebuild(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+  Layer_shptr layer = lmodel->get_layer(0);
+
+  Via_shptr v1(new Via(50, 50, 5));
+  Via_shptr v2(new Via(550, 550, 5));
+  lmodel->add_object(0, v1);
+  lmodel->add_object(0, v2);
+
+  RenderBatchBuilder builder(layer, 100);
+  RenderBatchBuilder::chunk_list chunks;
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  CPPUNIT_ASSERT(chunks.size() == 2);
+  CPPUNIT_ASSERT(builder.get_num_dirty_chunks() == 0);
+
+  // highlighting marks only the chunk of the via dirty
+  v1->set_highlighted(PlacedLogicModelObject::HLIGHTSTATE_DIRECT);
+  CPPUNIT_ASSERT(builder.get_num_dirty_chunks() == 1);
+
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * c, chunks)
+    CPPUNIT_ASSERT(c->get_rebuild_count() == (c->get_extent().in_shape(50, 50) ? 2 : 1));
+
+  // moving a via to another chunk
+  v2->set_x(150);
+  v2->set_y(50);
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  CPPUNIT_ASSERT(chunks.size() == 2);
+
+  // removing an object
+  lmodel->remove_object(v1);
+  builder.get_chunks(layer->get_bounding_box(), chunks);
+  CPPUNIT_ASSERT(chunks.size() == 1);
+  CPPUNIT_ASSERT(chunks.front()->get_num_objects() == 1);
+}
+
+void RenderBatchBuilderTest::test_lod_cell_size(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+  RenderBatchBuilder builder(lmodel->get_layer(0), 128);
+
+  CPPUNIT_ASSERT(builder.get_lod_cell_size(1, 8) == 0);
+  CPPUNIT_ASSERT(builder.get_lod_cell_size(8, 8) == 0);
+  CPPUNIT_ASSERT(builder.get_lod_cell_size(9, 8) == 32);
+  CPPUNIT_ASSERT(builder.get_lod_cell_size(16, 8) == 32);
+  // the cell size is limited by the chunk size
+  CPPUNIT_ASSERT(builder.get_lod_cell_size(1000, 8) == 128);
+}
+
+void RenderBatchBuilderTest::test_lod_aggregation(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1024, 1024, 1));
+  Layer_shptr layer = lmodel->get_layer(0);
+
+  // a row of adjacent gates and many short wires in the same area
+  for(int x = 0; x < 1000; x += 10)
+    lmodel->add_object(0, Gate_shptr(new Gate(x, x + 9, 100, 120)));
+  for(int y = 500; y < 564; y += 2)
+    for(int x = 0; x < 1000; x += 10)
+      lmodel->add_object(0, Wire_shptr(new Wire(x, y, x + 5, y, 1)));
+
+  RenderBatchBuilder builder(layer, 1024);
+  default_colors_t colors;
+  colors[DEFAULT_COLOR_GATE] = MERGE_CHANNELS(0, 0, 255, 128);
+  colors[DEFAULT_COLOR_WIRE] = MERGE_CHANNELS(255, 0, 0, 255);
+  builder.set_default_colors(colors);
+
+  RenderBatchBuilder::chunk_list chunks;
+  builder.get_chunks(layer->get_bounding_box(), chunks, 64);
+  CPPUNIT_ASSERT(chunks.size() == 1);
+  RenderBatchBuilder::RenderChunk const * c = chunks.front();
+  CPPUNIT_ASSERT(c->has_lod(64));
+
+  // all gates are merged into one rectangle
+  RenderBatchBuilder::PrimitiveSet const& gates = c->get_primitives(RenderBatchBuilder::GROUP_GATES, 64);
+  CPPUNIT_ASSERT(gates.triangles.size() == 6);
+  CPPUNIT_ASSERT(gates.lines.size() == 8);
+  CPPUNIT_ASSERT(gates.triangles[0].x == 0);
+  CPPUNIT_ASSERT(gates.triangles[1].x == 999);
+
+  // The wires are covered by a row of cells with the same density.
+  // They are merged into a single quad.
+  RenderBatchBuilder::PrimitiveSet const& wires = c->get_primitives(RenderBatchBuilder::GROUP_CONNECTIONS, 64);
+  CPPUNIT_ASSERT(wires.wide_lines.empty());
+  CPPUNIT_ASSERT(wires.triangles.size() > 0);
+  CPPUNIT_ASSERT(wires.triangles.size() <= 6 * (1024 / 64));
+  CPPUNIT_ASSERT(wires.triangles.size() < c->get_num_objects());
+
+  // the full detail arrays were not built
+  CPPUNIT_ASSERT(c->is_dirty());
+  CPPUNIT_ASSERT(c->get_rebuild_count() == 0);
+}
+
+void RenderBatchBuilderTest::test_lod_incremental_rebuild(void) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+  Layer_shptr layer = lmodel->get_layer(0);
+
+  Via_shptr v1(new Via(50, 50, 5));
+  Via_shptr v2(new Via(550, 550, 5));
+  lmodel->add_object(0, v1);
+  lmodel->add_object(0, v2);
+
+  RenderBatchBuilder builder(layer, 100);
+  default_colors_t colors;
+  colors[DEFAULT_COLOR_VIA_UP] = MERGE_CHANNELS(255, 0, 0, 255);
+  colors[DEFAULT_COLOR_VIA_DOWN] = MERGE_CHANNELS(0, 255, 0, 255);
+  builder.set_default_colors(colors);
+
+  RenderBatchBuilder::chunk_list chunks;
+  builder.get_chunks(layer->get_bounding_box(), chunks, 32);
+  CPPUNIT_ASSERT(chunks.size() == 2);
+
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * c, chunks) {
+    CPPUNIT_ASSERT(c->has_lod(32));
+    CPPUNIT_ASSERT(!c->has_lod(64));
+    CPPUNIT_ASSERT(c->get_primitives(RenderBatchBuilder::GROUP_CONNECTIONS, 32).triangles.size() == 6);
+  }
+
+  // aggregates for another cell size are kept separately
+  builder.get_chunks(layer->get_bounding_box(), chunks, 64);
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * c, chunks)
+    CPPUNIT_ASSERT(c->has_lod(32) && c->has_lod(64));
+
+  // a change drops the aggregates of that chunk only
+  v1->set_x(60);
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * c, chunks)
+    CPPUNIT_ASSERT(c->has_lod(32) == !c->get_extent().in_shape(60, 50));
+
+  // highlighted objects are rendered in full detail
+  v2->set_highlighted(PlacedLogicModelObject::HLIGHTSTATE_DIRECT);
+  builder.get_chunks(layer->get_bounding_box(), chunks, 32);
+  BOOST_FOREACH(RenderBatchBuilder::RenderChunk const * c, chunks) {
+    RenderBatchBuilder::PrimitiveSet const& p = c->get_primitives(RenderBatchBuilder::GROUP_CONNECTIONS, 32);
+    if(c->get_extent().in_shape(550, 550)) CPPUNIT_ASSERT(p.triangles[0].x == 550 - 10);
+  }
+}
@@ -0,0 +1,55 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __RENDERBATCHBUILDERTEST_H__
+#define __RENDERBATCHBUILDERTEST_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class RenderBatchBuilderTest : public CPPUNIT_NS::TestFixture {
+
+  CPPUNIT_TEST_SUITE(RenderBatchBuilderTest);
+
+  CPPUNIT_TEST (test_partitioning);
+  CPPUNIT_TEST (test_viewport_culling);
+  CPPUNIT_TEST (test_incremental_rebuild);
+  CPPUNIT_TEST (test_lod_cell_size);
+  CPPUNIT_TEST (test_lod_aggregation);
+  CPPUNIT_TEST (test_lod_incremental_rebuild);
+
+  CPPUNIT_TEST_SUITE_END ();
+
+ public:
+  void setUp (void);
+  void tearDown (void);
+
+ protected:
+
+  void test_partitioning(void);
+  void test_viewport_culling(void);
+  void test_incremental_rebuild(void);
+  void test_lod_cell_size(void);
+  void test_lod_aggregation(void);
+  void test_lod_incremental_rebuild(void);
+};
+
+#endif
@@ -0,0 +1,208 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <RuleChecker.h>
+
+#include "RuleCheckerTest.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (RuleCheckerTest);
+
+using namespace degate;
+
+void RuleCheckerTest::setUp(void) {
+}
+
+void RuleCheckerTest::tearDown(void) {
+}
+
+static GateTemplatePort_shptr add_port(LogicModel_shptr lmodel, GateTemplate_shptr tmpl,
+				       std::string const& name, GateTemplatePort::PORT_TYPE type, int x) {
+  GateTemplatePort_shptr port(new GateTemplatePort(x, 5, type));
+  port->set_name(name);
+  port->set_object_id(lmodel->get_new_object_id());
+  tmpl->add_template_port(port);
+  return port;
+}
+
+/*
+ * A chain of inverters. The input of the first and the output of the last
+ * inverter are open. Additionally there is a net with two drivers and a net
+ * without a driver.
+ */
+struct TestChain {
+
+  LogicModel_shptr lmodel;
+  GateTemplate_shptr tmpl;
+  GateTemplatePort_shptr in_port, out_port;
+  std::vector<Gate_shptr> gates;
+
+  TestChain(unsigned int n) : lmodel(new LogicModel(20 * n + 20, 100, 1)), tmpl(new GateTemplate(10, 10)) {
+
+    tmpl->set_logic_class("inverter");
+    in_port = add_port(lmodel, tmpl, "A", GateTemplatePort::PORT_TYPE_IN, 2);
+    out_port = add_port(lmodel, tmpl, "Y", GateTemplatePort::PORT_TYPE_OUT, 8);
+    lmodel->add_gate_template(tmpl);
+
+    for(unsigned int i = 0; i < n; i++) {
+      Gate_shptr gate(new Gate(20 * i, 20 * i + 10, 0, 10, Gate::ORIENTATION_NORMAL));
+      gate->set_gate_template(tmpl);
+      lmodel->add_object(0, gate);
+      lmodel->update_ports(gate);
+      gates.push_back(gate);
+      if(i > 0) connect(gates[i - 1]->get_port_by_template_port(out_port),
+			gate->get_port_by_template_port(in_port));
+    }
+
+    Gate_shptr a = add_gate(), b = add_gate();
+    connect(a->get_port_by_template_port(out_port), b->get_port_by_template_port(out_port));
+    connect(a->get_port_by_template_port(in_port), b->get_port_by_template_port(in_port));
+  }
+
+  Gate_shptr add_gate() {
+    Gate_shptr gate(new Gate(0, 10, 50, 60, Gate::ORIENTATION_NORMAL));
+    gate->set_gate_template(tmpl);
+    lmodel->add_object(0, gate);
+    lmodel->update_ports(gate);
+    return gate;
+  }
+
+  Net_shptr connect(GatePort_shptr p1, GatePort_shptr p2) {
+    Net_shptr net(new Net());
+    p1->set_net(net);
+    p2->set_net(net);
+    lmodel->add_net(net);
+    return net;
+  }
+};
+
+static RCVContainer run_checks_serially(LogicModel_shptr lmodel) {
+  RCVContainer violations;
+  ERCOpenPorts open_ports;
+  open_ports.run(lmodel);
+  violations.append(open_ports.get_rc_violations());
+  ERCNet net;
+  net.run(lmodel);
+  violations.append(net.get_rc_violations());
+  return violations;
+}
+
+static unsigned int count_equal(RCVContainer const& a, RCVContainer const& b) {
+  unsigned int found = 0;
+  BOOST_FOREACH(RCViolation_shptr v, a) if(b.contains(v)) found++;
+  return found;
+}
+
+static bool same_sequence(RCVContainer const& a, RCVContainer const& b) {
+  if(a.size() != b.size()) return false;
+  for(RCVContainer::const_iterator i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j)
+    if(!(*i)->equals(*j)) return false;
+  return true;
+}
+
+
+void RuleCheckerTest::test_run(void) {
+
+  TestChain c(1000);
+  RCVContainer expected = run_checks_serially(c.lmodel);
+
+  // two open ports, two connected outputs, two unfeeded inputs
+  CPPUNIT_ASSERT(expected.size() == 6);
+
+  RuleChecker rc(4);
+  rc.run(c.lmodel);
+  RCVContainer violations = rc.get_rc_violations();
+  CPPUNIT_ASSERT(violations.size() == expected.size());
+  CPPUNIT_ASSERT(count_equal(violations, expected) == expected.size());
+  CPPUNIT_ASSERT(rc.get_num_checked() == c.lmodel->get_netlist_graph()->get_num_gates() +
+		 c.lmodel->get_netlist_graph()->get_num_nets());
+
+  // the result does not depend on the number of threads
+  RuleChecker rc_serial(1);
+  rc_serial.run(c.lmodel);
+  CPPUNIT_ASSERT(same_sequence(violations, rc_serial.get_rc_violations()));
+}
+
+void RuleCheckerTest::test_lazy_description(void) {
+
+  TestChain c(3);
+  GatePort_shptr port = c.gates[0]->get_port_by_template_port(c.in_port);
+
+  RCViolation_shptr lazy(new RCViolation(port, "Port %1% is unconnected.", 0, "open_port", RC_WARNING));
+  boost::format f("Port %1% is unconnected.");
+  f % port->get_descriptive_identifier();
+  RCViolation_shptr eager(new RCViolation(port, f.str(), "open_port", RC_WARNING));
+
+  CPPUNIT_ASSERT(lazy->equals(eager));
+  CPPUNIT_ASSERT(eager->equals(lazy));
+  CPPUNIT_ASSERT(lazy->get_problem_description() == f.str());
+
+  RCViolation_shptr other(new RCViolation(port, "Out-Port %1% is connected with %2% other out-ports.",
+					  2, "net.outputs_connected"));
+  CPPUNIT_ASSERT(!other->equals(lazy));
+  CPPUNIT_ASSERT(other->get_problem_description().find("with 2 other") != std::string::npos);
+  CPPUNIT_ASSERT(other->matches_filter("with 2"));
+}
+
+void RuleCheckerTest::test_incremental(void) {
+
+  TestChain c(500);
+  RuleChecker rc(2);
+  rc.run(c.lmodel);
+
+  // nothing changed
+  rc.run(c.lmodel);
+  CPPUNIT_ASSERT(rc.get_num_checked() == 0);
+  CPPUNIT_ASSERT(rc.get_rc_violations().size() == 6);
+
+  // close the chain: both open ports are connected now
+  Net_shptr loop = c.connect(c.gates.back()->get_port_by_template_port(c.out_port),
+			     c.gates.front()->get_port_by_template_port(c.in_port));
+  rc.run(c.lmodel);
+  CPPUNIT_ASSERT(rc.get_num_checked() > 0 && rc.get_num_checked() < 10);
+  CPPUNIT_ASSERT(rc.get_rc_violations().size() == 4);
+  CPPUNIT_ASSERT(same_sequence(rc.get_rc_violations(), run_checks_serially(c.lmodel)));
+
+  // remove a gate in the middle of the chain: this opens two ports and
+  // leaves an input without a driver
+  c.lmodel->remove_object(c.gates[250]);
+  rc.run(c.lmodel);
+  CPPUNIT_ASSERT(rc.get_num_checked() < 10);
+  RuleChecker fresh;
+  fresh.run(c.lmodel);
+  CPPUNIT_ASSERT(fresh.get_rc_violations().size() == 7);
+  CPPUNIT_ASSERT(same_sequence(rc.get_rc_violations(), fresh.get_rc_violations()));
+
+  // move a port from one net to another
+  c.gates[10]->get_port_by_template_port(c.in_port)->set_net(loop);
+  rc.run(c.lmodel);
+  fresh.run(c.lmodel);
+  CPPUNIT_ASSERT(fresh.get_num_checked() < 10);
+  CPPUNIT_ASSERT(same_sequence(rc.get_rc_violations(), fresh.get_rc_violations()));
+  CPPUNIT_ASSERT(same_sequence(rc.get_rc_violations(), run_checks_serially(c.lmodel)));
+
+  // port directions are not reported by the layers
+  c.in_port->set_port_type(GateTemplatePort::PORT_TYPE_OUT);
+  rc.run(c.lmodel);
+  NetlistGraph_shptr graph = c.lmodel->get_netlist_graph();
+  CPPUNIT_ASSERT(rc.get_num_checked() == graph->get_num_gates() + graph->get_num_nets());
+  CPPUNIT_ASSERT(same_sequence(rc.get_rc_violations(), run_checks_serially(c.lmodel)));
+}
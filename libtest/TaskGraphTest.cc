@@ -0,0 +1,180 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <TaskGraph.h>
+
+#include "TaskGraphTest.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TaskGraphTest);
+
+using namespace degate;
+
+/**
+ * Records the order, in which tasks finish, and the maximum number
+ * of tasks, that ran at the same time.
+ */
+struct TaskLog {
+
+  boost::mutex mtx;
+  std::vector<unsigned int> order;
+  unsigned int running, max_running;
+
+  TaskLog() : running(0), max_running(0) {}
+
+  void run(unsigned int n) {
+    {
+      boost::lock_guard<boost::mutex> lock(mtx);
+      running++;
+      max_running = std::max(max_running, running);
+    }
+
+    boost::this_thread::sleep(boost::posix_time::millisec(5));
+
+    boost::lock_guard<boost::mutex> lock(mtx);
+    running--;
+    order.push_back(n);
+  }
+
+  unsigned int position(unsigned int n) {
+    return std::find(order.begin(), order.end(), n) - order.begin();
+  }
+};
+
+static void fail() {
+  throw DegateRuntimeException("broken");
+}
+
+static void add_followers(TaskGraph * g, TaskLog * log, TaskGraph::task_id barrier) {
+  for(unsigned int i = 10; i < 14; i++)
+    g->add_dependency(barrier, g->add_task("follower", boost::bind(&TaskLog::run, log, i)));
+}
+
+void TaskGraphTest::setUp(void) {
+}
+
+void TaskGraphTest::tearDown(void) {
+}
+
+void TaskGraphTest::test_dependencies(void) {
+
+  TaskLog log;
+  TaskGraph g;
+
+  // a diamond: 0 -> (1, 2) -> 3, and an independent task 4
+  TaskGraph::task_id t0 = g.add_task("t0", boost::bind(&TaskLog::run, &log, 0));
+  TaskGraph::task_id t1 = g.add_task("t1", boost::bind(&TaskLog::run, &log, 1));
+  TaskGraph::task_id t2 = g.add_task("t2", boost::bind(&TaskLog::run, &log, 2));
+  TaskGraph::task_id t3 = g.add_task("t3", boost::bind(&TaskLog::run, &log, 3));
+  g.add_task("t4", boost::bind(&TaskLog::run, &log, 4));
+
+  g.add_dependency(t1, t0);
+  g.add_dependency(t2, t0);
+  g.add_dependency(t3, t1);
+  g.add_dependency(t3, t2);
+
+  CPPUNIT_ASSERT(g.run(4));
+  CPPUNIT_ASSERT(g.get_num_done() == 5);
+  CPPUNIT_ASSERT(log.order.size() == 5);
+  CPPUNIT_ASSERT(log.position(0) < log.position(1));
+  CPPUNIT_ASSERT(log.position(0) < log.position(2));
+  CPPUNIT_ASSERT(log.position(1) < log.position(3));
+  CPPUNIT_ASSERT(log.position(2) < log.position(3));
+
+  CPPUNIT_ASSERT_THROW(g.add_dependency(t0, 17), DegateLogicException);
+  CPPUNIT_ASSERT_THROW(g.add_dependency(t3, t0), DegateLogicException);
+}
+
+void TaskGraphTest::test_resources(void) {
+
+  TaskLog log;
+  TaskGraph g;
+
+  for(unsigned int i = 0; i < 6; i++)
+    g.add_task("exclusive", boost::bind(&TaskLog::run, &log, i), "resource");
+
+  CPPUNIT_ASSERT(g.run(4));
+  CPPUNIT_ASSERT(log.order.size() == 6);
+  CPPUNIT_ASSERT(log.max_running == 1);
+
+  // tasks, that share a resource, run in the order they were added
+  for(unsigned int i = 0; i < 6; i++)
+    CPPUNIT_ASSERT(log.order[i] == i);
+}
+
+void TaskGraphTest::test_dynamic_tasks(void) {
+
+  TaskLog log;
+  TaskGraph g;
+
+  TaskGraph::task_id first = g.add_task("first", TaskGraph::task_function());
+  TaskGraph::task_id barrier = g.add_task("barrier", TaskGraph::task_function());
+  TaskGraph::task_id last = g.add_task("last", boost::bind(&TaskLog::run, &log, 20));
+  g.add_dependency(last, barrier);
+  g.add_dependency(barrier, first);
+
+  // the first task adds followers, that the barrier waits for
+  g.add_dependency(first, g.add_task("spawn", boost::bind(&add_followers, &g, &log, barrier)));
+
+  CPPUNIT_ASSERT(g.run(3));
+  CPPUNIT_ASSERT(g.size() == 8);
+  CPPUNIT_ASSERT(log.order.size() == 5);
+  CPPUNIT_ASSERT(log.order.back() == 20);
+}
+
+void TaskGraphTest::test_errors(void) {
+
+  TaskLog log;
+  TaskGraph g;
+
+  TaskGraph::task_id broken = g.add_task("broken", &fail);
+  TaskGraph::task_id dependent = g.add_task("dependent", boost::bind(&TaskLog::run, &log, 1));
+  g.add_dependency(dependent, broken);
+
+  CPPUNIT_ASSERT_THROW(g.run(2), DegateRuntimeException);
+  CPPUNIT_ASSERT(log.order.empty());
+
+  TaskGraph cyclic;
+  TaskGraph::task_id a = cyclic.add_task("a", TaskGraph::task_function());
+  TaskGraph::task_id b = cyclic.add_task("b", TaskGraph::task_function());
+  cyclic.add_dependency(a, b);
+  cyclic.add_dependency(b, a);
+  CPPUNIT_ASSERT_THROW(cyclic.run(2), DegateRuntimeException);
+}
+
+void TaskGraphTest::test_cancel(void) {
+
+  TaskLog log;
+  TaskGraph g;
+  CancellationToken_shptr token(new CancellationToken());
+
+  g.add_task("cancel", boost::bind(&CancellationToken::cancel, token.get()));
+  for(unsigned int i = 0; i < 4; i++)
+    g.add_task("work", boost::bind(&TaskLog::run, &log, i), "resource");
+
+  CPPUNIT_ASSERT(!g.run(1, token));
+  CPPUNIT_ASSERT(log.order.empty());
+  CPPUNIT_ASSERT(g.get_num_done() == 1);
+}
@@ -0,0 +1,53 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __TASKGRAPHTEST_H__
+#define __TASKGRAPHTEST_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class TaskGraphTest : public CPPUNIT_NS::TestFixture {
+
+  CPPUNIT_TEST_SUITE(TaskGraphTest);
+
+  CPPUNIT_TEST (test_dependencies);
+  CPPUNIT_TEST (test_resources);
+  CPPUNIT_TEST (test_dynamic_tasks);
+  CPPUNIT_TEST (test_errors);
+  CPPUNIT_TEST (test_cancel);
+
+  CPPUNIT_TEST_SUITE_END ();
+
+ public:
+  void setUp (void);
+  void tearDown (void);
+
+ protected:
+
+  void test_dependencies(void);
+  void test_resources(void);
+  void test_dynamic_tasks(void);
+  void test_errors(void);
+  void test_cancel(void);
+};
+
+#endif
@@ -0,0 +1,149 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __TESTHELPER_H__
+#define __TESTHELPER_H__
+
+#include <degate.h>
+#include <Module.h>
+
+#include <cppunit/TestFixture.h>
+
+#include <string>
+#include <vector>
+
+/*
+ * Factories for logic models, that are built in test cases.
+ */
+
+/**
+ * Create a 10x10 gate template with input ports and an output port and
+ * add it to the logic model. The ports are placed in a row.
+ * @param in_type The port type for the input ports.
+ */
+inline degate::GateTemplate_shptr
+create_test_template(degate::LogicModel_shptr lmodel,
+		     std::string const& logic_class,
+		     std::vector<std::string> const& in_ports,
+		     std::string const& out_port,
+		     degate::GateTemplatePort::PORT_TYPE in_type =
+		     degate::GateTemplatePort::PORT_TYPE_IN) {
+
+  using namespace degate;
+
+  GateTemplate_shptr tmpl(new GateTemplate(10, 10));
+  tmpl->set_logic_class(logic_class);
+
+  for(unsigned int i = 0; i <= in_ports.size(); i++) {
+    GateTemplatePort_shptr port(new GateTemplatePort(1 + i, 5, i < in_ports.size() ?
+						      in_type : GateTemplatePort::PORT_TYPE_OUT));
+    port->set_name(i < in_ports.size() ? in_ports[i] : out_port);
+    port->set_object_id(lmodel->get_new_object_id());
+    tmpl->add_template_port(port);
+  }
+
+  lmodel->add_gate_template(tmpl);
+  return tmpl;
+}
+
+/**
+ * Create a gate template with a single input port.
+ */
+inline degate::GateTemplate_shptr
+create_test_template(degate::LogicModel_shptr lmodel,
+		     std::string const& logic_class,
+		     std::string const& in_port,
+		     std::string const& out_port) {
+  return create_test_template(lmodel, logic_class, std::vector<std::string>(1, in_port), out_port);
+}
+
+/**
+ * Create a 10x10 gate on layer 0 and add it with its ports to the logic model.
+ * @param tmpl The gate template. It might be NULL.
+ */
+inline degate::Gate_shptr create_test_gate(degate::LogicModel_shptr lmodel,
+					   degate::GateTemplate_shptr tmpl,
+					   int x, int y = 0) {
+
+  using namespace degate;
+
+  Gate_shptr gate(new Gate(x, x + 10, y, y + 10, Gate::ORIENTATION_NORMAL));
+  if(tmpl != NULL) gate->set_gate_template(tmpl);
+  lmodel->add_object(0, gate);
+  lmodel->update_ports(gate);
+  return gate;
+}
+
+/**
+ * Look up a gate port by the name of its template port.
+ * @return Returns a NULL pointer, if there is no such port.
+ */
+inline degate::GatePort_shptr get_test_port(degate::Gate_shptr gate, std::string const& name) {
+
+  for(degate::Gate::port_iterator iter = gate->ports_begin(); iter != gate->ports_end(); ++iter)
+    if((*iter)->get_template_port()->get_name() == name) return *iter;
+  return degate::GatePort_shptr();
+}
+
+/**
+ * Create a module and add it as sub-module to a parent module.
+ */
+inline degate::Module_shptr create_test_module(degate::LogicModel_shptr lmodel,
+					       degate::Module_shptr parent,
+					       std::string const& name) {
+
+  degate::Module_shptr module(new degate::Module(name));
+  module->set_object_id(lmodel->get_new_object_id());
+  parent->add_module(module);
+  return module;
+}
+
+/**
+ * Count how often a string occurs in another string.
+ */
+inline unsigned int count_occurrences(std::string const& haystack, std::string const& needle) {
+  unsigned int n = 0;
+  for(size_t pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1))
+    n++;
+  return n;
+}
+
+/**
+ * Base class for test fixtures, that need a scratch directory. The
+ * directory is created before and removed after each test case.
+ */
+class TempDirectoryTestFixture : public CPPUNIT_NS :: TestFixture {
+
+ protected:
+  std::string temp_dir;
+
+ public:
+  void setUp(void) {
+    temp_dir = degate::create_temp_directory();
+  }
+
+  void tearDown(void) {
+    degate::remove_directory(temp_dir);
+  }
+};
+
+#endif
+
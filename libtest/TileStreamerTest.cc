@@ -0,0 +1,246 @@
+/*
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <TileStreamer.h>
+#include <LRUCache.h>
+
+#include "TileStreamerTest.h"
+
+#include <boost/foreach.hpp>
+#include <boost/thread.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TileStreamerTest);
+
+using namespace degate;
+
+/**
+ * A tile source with 16x16 pixel tiles. Each pixel of a tile
+ * encodes the tile key. Loads are counted.
+ */
+class FakeTileSource : public TileSource {
+
+private:
+  boost::mutex mutex;
+  std::map<TileKey, unsigned int> loads;
+
+public:
+
+  unsigned int get_tile_size() const { return 16; }
+
+  std::list<unsigned int> get_levels() const {
+    std::list<unsigned int> l;
+    l.push_back(1);
+    l.push_back(2);
+    l.push_back(4);
+    return l;
+  }
+
+  // 8x8 tiles on level 1
+  unsigned int get_width(unsigned int level) const { return 128 / level; }
+  unsigned int get_height(unsigned int level) const { return 128 / level; }
+
+  void load_tile(TileKey const& key, rgba_pixel_t * dst) {
+    for(unsigned int i = 0; i < 16*16; i++)
+      dst[i] = (key.level << 16) | (key.row << 8) | key.col;
+
+    boost::lock_guard<boost::mutex> lock(mutex);
+    loads[key]++;
+  }
+
+  unsigned int get_loads(TileKey const& key) {
+    boost::lock_guard<boost::mutex> lock(mutex);
+    return loads[key];
+  }
+};
+
+typedef std::tr1::shared_ptr<FakeTileSource> FakeTileSource_shptr;
+
+/**
+ * Wait until the streamer is idle, making all collected tiles resident.
+ * The tile key is used as handle.
+ */
+static unsigned int stream_until_idle(TileStreamer & streamer) {
+  unsigned int n = 0;
+
+  for(unsigned int i = 0; i < 2000; i++) {
+    std::list<TileStreamer::StagedTile> tiles;
+    streamer.collect(100, tiles);
+
+    BOOST_FOREACH(TileStreamer::StagedTile const& t, tiles) {
+      std::list<TileStreamer::resident_handle_t> evicted;
+      CPPUNIT_ASSERT(t.data[0] == ((t.key.level << 16) | (t.key.row << 8) | t.key.col));
+      streamer.make_resident(t, t.data[0], evicted);
+      n++;
+    }
+
+    if(!streamer.has_pending_work()) return n;
+    boost::this_thread::sleep(boost::posix_time::millisec(1));
+  }
+
+  CPPUNIT_ASSERT(false);
+  return n;
+}
+
+void TileStreamerTest::setUp(void) {
+}
+
+void TileStreamerTest::tearDown(void) {
+}
+
+void TileStreamerTest::test_lru_cache(void) {
+
+  LRUCache<int, int> cache(2);
+  LRUCache<int, int>::value_type evicted;
+  int v;
+
+  CPPUNIT_ASSERT(!cache.insert(1, 10, evicted));
+  CPPUNIT_ASSERT(!cache.insert(2, 20, evicted));
+
+  // touch 1, so that 2 is the least recently used entry
+  CPPUNIT_ASSERT(cache.get(1, v) && v == 10);
+
+  CPPUNIT_ASSERT(cache.insert(3, 30, evicted));
+  CPPUNIT_ASSERT(evicted.first == 2 && evicted.second == 20);
+  CPPUNIT_ASSERT(cache.size() == 2);
+  CPPUNIT_ASSERT(cache.contains(1) && cache.contains(3) && !cache.contains(2));
+
+  // replacing an entry hands back the old value
+  CPPUNIT_ASSERT(cache.insert(3, 31, evicted));
+  CPPUNIT_ASSERT(evicted.first == 3 && evicted.second == 30);
+  CPPUNIT_ASSERT(cache.get(3, v) && v == 31);
+
+  CPPUNIT_ASSERT(cache.erase(1));
+  CPPUNIT_ASSERT(!cache.erase(1));
+  CPPUNIT_ASSERT(cache.size() == 1);
+}
+
+void TileStreamerTest::test_load_visible_tiles(void) {
+
+  FakeTileSource_shptr source(new FakeTileSource());
+  TileStreamer streamer(source, 64, 2, 4);
+
+  // a viewport covering 2x2 tiles
+  BoundingBox viewport(0, 31, 0, 31);
+  CPPUNIT_ASSERT(streamer.get_tiles(viewport, 1).size() == 4);
+
+  streamer.update(viewport, 1);
+  stream_until_idle(streamer);
+
+  BOOST_FOREACH(TileKey const& key, streamer.get_tiles(viewport, 1)) {
+    CPPUNIT_ASSERT(source->get_loads(key) == 1);
+    TileStreamer::ResidentTile r;
+    CPPUNIT_ASSERT(streamer.find_resident(key, r));
+    CPPUNIT_ASSERT(r.key == key);
+  }
+
+  // resident tiles are not loaded again
+  unsigned long loaded = streamer.get_num_loaded();
+  streamer.update(viewport, 1);
+  stream_until_idle(streamer);
+  CPPUNIT_ASSERT(streamer.get_num_loaded() == loaded);
+}
+
+void TileStreamerTest::test_bounded_collect(void) {
+
+  FakeTileSource_shptr source(new FakeTileSource());
+  TileStreamer streamer(source, 64, 1, 2);
+
+  streamer.update(BoundingBox(0, 127, 0, 127), 1);
+
+  for(unsigned int i = 0; i < 2000 && streamer.get_num_loaded() < 2; i++)
+    boost::this_thread::sleep(boost::posix_time::millisec(1));
+
+  // Only two staging buffers. The workers stall until tiles are collected.
+  boost::this_thread::sleep(boost::posix_time::millisec(20));
+  CPPUNIT_ASSERT(streamer.get_num_loaded() == 2);
+
+  std::list<TileStreamer::StagedTile> tiles;
+  streamer.collect(1, tiles);
+  CPPUNIT_ASSERT(tiles.size() == 1);
+
+  streamer.release(tiles.front());
+  stream_until_idle(streamer);
+  CPPUNIT_ASSERT(streamer.get_num_resident() == 64);
+}
+
+void TileStreamerTest::test_prefetch_in_pan_direction(void) {
+
+  FakeTileSource_shptr source(new FakeTileSource());
+  TileStreamer streamer(source, 64, 2, 4);
+
+  // Pan to the right. Column 3 is right of the viewport and should be prefetched.
+  streamer.update(BoundingBox(0, 31, 0, 15), 1);
+  stream_until_idle(streamer);
+  CPPUNIT_ASSERT(source->get_loads(TileKey(1, 3, 0)) == 0);
+
+  streamer.update(BoundingBox(16, 47, 0, 15), 1);
+  stream_until_idle(streamer);
+  CPPUNIT_ASSERT(source->get_loads(TileKey(1, 2, 0)) == 1);
+  CPPUNIT_ASSERT(source->get_loads(TileKey(1, 3, 0)) == 1);
+
+  // nothing is prefetched to the left
+  CPPUNIT_ASSERT(source->get_loads(TileKey(1, 0, 1)) == 0);
+
+  // The coarser level is prefetched, too.
+  CPPUNIT_ASSERT(source->get_loads(TileKey(2, 0, 0)) == 1);
+}
+
+void TileStreamerTest::test_coarser_fallback(void) {
+
+  FakeTileSource_shptr source(new FakeTileSource());
+  TileStreamer streamer(source, 64, 1, 4);
+
+  // load the only tile of the coarsest level
+  streamer.update(BoundingBox(0, 31, 0, 31), 4);
+  CPPUNIT_ASSERT(stream_until_idle(streamer) == 1);
+
+  TileStreamer::ResidentTile r;
+  CPPUNIT_ASSERT(!streamer.find_resident(TileKey(1, 4, 0), r)); // outside of coarse tile
+  CPPUNIT_ASSERT(streamer.find_resident(TileKey(1, 3, 1), r));
+  CPPUNIT_ASSERT(r.handle == (4 << 16));
+  CPPUNIT_ASSERT(r.key == TileKey(4, 0, 0));
+  CPPUNIT_ASSERT(r.tex_min_x == 0.75 && r.tex_max_x == 1);
+  CPPUNIT_ASSERT(r.tex_min_y == 0.25 && r.tex_max_y == 0.5);
+
+  std::list<TileStreamer::resident_handle_t> evicted;
+  streamer.clear_resident(evicted);
+  CPPUNIT_ASSERT(evicted.size() == 1 && evicted.front() == (4 << 16));
+  CPPUNIT_ASSERT(!streamer.find_resident(TileKey(1, 3, 1), r));
+}
+
+void TileStreamerTest::test_read_tile(void) {
+
+  BackgroundImage_shptr img(new BackgroundImage(64, 64, 4));
+  unsigned int tile_size = img->get_tile_size();
+  CPPUNIT_ASSERT(tile_size == 16);
+
+  img->set_pixel(17, 33, 0x11223344);
+
+  std::vector<rgba_pixel_t> buf(tile_size * tile_size, 0xffffffff);
+  img->read_tile(&buf[0], 16, 32);
+  CPPUNIT_ASSERT(buf[1 * tile_size + 1] == 0x11223344);
+  CPPUNIT_ASSERT(buf[0] == 0);
+
+  // a tile that was never written
+  img->read_tile(&buf[0], 48, 48);
+  CPPUNIT_ASSERT(buf[0] == 0);
+}
@@ -0,0 +1,133 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <Module.h>
+#include <VerilogModuleGenerator.h>
+#include <boost/format.hpp>
+#include <sstream>
+
+#include "VerilogModuleGeneratorTest.h"
+#include "TestHelper.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (VerilogModuleGeneratorTest);
+
+using namespace degate;
+
+void VerilogModuleGeneratorTest::setUp(void) {
+}
+
+void VerilogModuleGeneratorTest::tearDown(void) {
+}
+
+
+/*
+ * Build a chain of inverters, that runs through a module hierarchy:
+ *
+ *   main
+ *    +- m0
+ *    |   +- m0_inner
+ *    +- m1
+ *    |   +- m1_inner
+ *    ...
+ */
+static LogicModel_shptr create_model(unsigned int num_submodules) {
+
+  LogicModel_shptr lmodel(new LogicModel(1000, 1000, 1));
+
+  GateTemplate_shptr tmpl = create_test_template(lmodel, "", "A", "Y");
+  tmpl->set_name("inv");
+
+  Module_shptr main_module = lmodel->get_main_module();
+  std::vector<Module_shptr> modules;
+
+  for(unsigned int i = 0; i < num_submodules; i++) {
+    Module_shptr outer = create_test_module(lmodel, main_module, (boost::format("m%1%") % i).str());
+    Module_shptr inner = create_test_module(lmodel, outer, (boost::format("m%1%_inner") % i).str());
+    modules.push_back(outer);
+    modules.push_back(inner);
+  }
+
+  GatePort_shptr prev_out;
+
+  for(unsigned int i = 0; i < 4 * num_submodules; i++) {
+    Gate_shptr gate = create_test_gate(lmodel, tmpl, (i % 40) * 20, (i / 40) * 20);
+    gate->set_name((boost::format("g%1%") % i).str());
+
+    main_module->remove_gate(gate);
+    modules[(i / 2) % modules.size()]->add_gate(gate, false);
+
+    if(prev_out != NULL) {
+      Net_shptr net(new Net());
+      prev_out->set_net(net);
+      get_test_port(gate, "A")->set_net(net);
+      lmodel->add_net(net);
+    }
+    prev_out = get_test_port(gate, "Y");
+  }
+
+  determine_module_ports_for_hierarchy(lmodel);
+  return lmodel;
+}
+
+
+void VerilogModuleGeneratorTest::test_hierarchy(void) {
+
+  LogicModel_shptr lmodel = create_model(3);
+
+  VerilogModuleGenerator codegen(lmodel->get_main_module(), false, 1);
+  std::string code = codegen.generate();
+
+  // Each module is defined once, nested modules before their parents.
+  CPPUNIT_ASSERT(count_occurrences(code, "\nmodule dg_m0_inner (") == 1);
+  CPPUNIT_ASSERT(count_occurrences(code, "\nmodule dg_m0 (") == 1);
+  CPPUNIT_ASSERT(code.find("\nmodule dg_m0_inner (") < code.find("\nmodule dg_m0 ("));
+  CPPUNIT_ASSERT(count_occurrences(code, "endmodule") == 7);
+
+  // The implementation of the gate template is emitted once.
+  CPPUNIT_ASSERT(count_occurrences(code, "failed to lookup Verilog implementation") == 1);
+
+  // gates and sub-modules are placed
+  CPPUNIT_ASSERT(code.find("  dg_inv g1 (\n    .a (") != std::string::npos);
+  CPPUNIT_ASSERT(code.find("  dg_m0_inner m0_inner (\n") != std::string::npos);
+
+  // without gates there is no gate template code
+  VerilogModuleGenerator codegen_no_gates(lmodel->get_main_module(), true, 1);
+  CPPUNIT_ASSERT(count_occurrences(codegen_no_gates.generate(), "failed to lookup") == 0);
+}
+
+
+void VerilogModuleGeneratorTest::test_stream(void) {
+
+  LogicModel_shptr lmodel = create_model(20);
+
+  VerilogModuleGenerator codegen(lmodel->get_main_module(), false, 1);
+  std::string reference = codegen.generate();
+
+  // The output does not depend on the sink and on the number of threads.
+  for(unsigned int num_threads = 1; num_threads <= 8; num_threads *= 2) {
+    codegen.set_num_threads(num_threads);
+    std::ostringstream os;
+    codegen.generate(os);
+    CPPUNIT_ASSERT(os.str() == reference);
+    CPPUNIT_ASSERT(codegen.generate() == reference);
+  }
+}
@@ -0,0 +1,271 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <degate.h>
+#include <XmlRpc.h>
+#include <Wire.h>
+#include <Via.h>
+#include "XmlRpcTest.h"
+
+#include <stdexcept>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (XmlRpcTest);
+
+using namespace std;
+using namespace degate;
+
+namespace {
+
+  /**
+   * A local stand-in for tools/xmlrpc-server-cgi. It stores commands as
+   * transactions and counts requests.
+   */
+  class LocalServer : public XmlRpcConnection {
+
+  public:
+
+    std::vector<xmlrpc_command> transactions;
+    bool batch_support;
+    unsigned int num_requests;
+    unsigned int fail_at_request; // simulate a lost connection, 0 for none
+
+    LocalServer(bool _batch_support = true) :
+      transactions(1), // transaction IDs start at 1
+      batch_support(_batch_support),
+      num_requests(0),
+      fail_at_request(0) {}
+
+    xmlrpc_c::value call(std::string const& method_name,
+			 xmlrpc_c::paramList const& params) {
+      num_requests++;
+
+      if(num_requests == fail_at_request)
+	throw std::runtime_error("Connection timed out.");
+
+      if(method_name == "degate.push") {
+	xmlrpc_command command;
+	for(unsigned int i = 0; i < params.size(); i++) command.push_back(params[i]);
+	transactions.push_back(command);
+	return xmlrpc_c::value_int(transactions.size() - 1);
+      }
+      else if(method_name == "degate.push_batch" && batch_support) {
+	std::vector<xmlrpc_c::value> tids;
+	std::vector<xmlrpc_c::value> batch = xmlrpc_c::value_array(params[0]).vectorValueValue();
+	for(unsigned int i = 0; i < batch.size(); i++) {
+	  transactions.push_back(xmlrpc_c::value_array(batch[i]).vectorValueValue());
+	  tids.push_back(xmlrpc_c::value_int(transactions.size() - 1));
+	}
+	return xmlrpc_c::value_array(tids);
+      }
+      else if(method_name == "degate.pull") {
+	unsigned int start_tid = xmlrpc_c::value_int(params[0]);
+	if(start_tid == 0) start_tid = 1;
+	std::vector<xmlrpc_c::value> result;
+	for(unsigned int i = start_tid; i < transactions.size(); i++)
+	  result.push_back(xmlrpc_c::value_array(transactions[i]));
+	return xmlrpc_c::value_array(result);
+      }
+
+      throw XMLRPCNoSuchMethodException("Unknown method " + method_name);
+    }
+  };
+
+  typedef std::tr1::shared_ptr<LocalServer> LocalServer_shptr;
+
+  template<typename T>
+  std::vector<std::tr1::shared_ptr<T> > get_objects(LogicModel_shptr lmodel) {
+    std::vector<std::tr1::shared_ptr<T> > result;
+    for(LogicModel::object_collection::iterator iter = lmodel->objects_begin();
+	iter != lmodel->objects_end(); ++iter)
+      if(std::tr1::shared_ptr<T> o = std::tr1::dynamic_pointer_cast<T>(iter->second))
+	result.push_back(o);
+    return result;
+  }
+
+  LogicModel_shptr create_lmodel(unsigned int num_wires, unsigned int num_vias) {
+    LogicModel_shptr lmodel(new LogicModel(1000, 1000, 2));
+    for(unsigned int i = 0; i < num_wires; i++)
+      lmodel->add_object(0, Wire_shptr(new Wire(i, 10, i, 20, 3)));
+    for(unsigned int i = 0; i < num_vias; i++)
+      lmodel->add_object(1, Via_shptr(new Via(i, 30, 5, Via::DIRECTION_UP)));
+    return lmodel;
+  }
+}
+
+void XmlRpcTest::setUp(void) {
+}
+
+void XmlRpcTest::tearDown(void) {
+}
+
+void XmlRpcTest::test_unpushed_objects(void) {
+
+  LogicModel_shptr lmodel = create_lmodel(3, 2);
+  CPPUNIT_ASSERT(lmodel->get_unpushed_remote_objects().size() == 5);
+
+  // Removing an unpushed object does not need a remove message.
+  object_id_t oid = *lmodel->get_unpushed_remote_objects().begin();
+  lmodel->remove_object(lmodel->get_object(oid));
+  CPPUNIT_ASSERT(lmodel->get_unpushed_remote_objects().size() == 4);
+  CPPUNIT_ASSERT(lmodel->get_removed_remote_objetcs_list().empty());
+
+  // Objects with a remote ID are not queued.
+  Wire_shptr w(new Wire(1, 1, 2, 2, 3));
+  w->set_remote_object_id(42);
+  lmodel->add_object(0, w);
+  CPPUNIT_ASSERT(lmodel->get_unpushed_remote_objects().size() == 4);
+  CPPUNIT_ASSERT(lmodel->get_local_oid_for_roid(42) == w->get_object_id());
+}
+
+void XmlRpcTest::test_batched_push(void) {
+
+  LocalServer_shptr server(new LocalServer());
+  LogicModel_shptr lmodel = create_lmodel(1000, 200);
+
+  push_changes_to_server(server, lmodel);
+
+  // 1200 commands are sent with three requests.
+  CPPUNIT_ASSERT(server->num_requests == 3);
+  CPPUNIT_ASSERT(server->transactions.size() == 1201);
+  CPPUNIT_ASSERT(lmodel->get_unpushed_remote_objects().empty());
+
+  for(LogicModel::object_collection::iterator iter = lmodel->objects_begin();
+      iter != lmodel->objects_end(); ++iter) {
+    RemoteObject_shptr ro = std::tr1::dynamic_pointer_cast<RemoteObject>(iter->second);
+    CPPUNIT_ASSERT(ro != NULL);
+    CPPUNIT_ASSERT(ro->has_remote_object_id());
+    CPPUNIT_ASSERT(lmodel->get_local_oid_for_roid(ro->get_remote_object_id()) ==
+		   iter->second->get_object_id());
+  }
+
+  // nothing to push
+  push_changes_to_server(server, lmodel);
+  CPPUNIT_ASSERT(server->num_requests == 3);
+}
+
+void XmlRpcTest::test_push_removals(void) {
+
+  LocalServer_shptr server(new LocalServer());
+  LogicModel_shptr lmodel = create_lmodel(5, 0);
+  push_changes_to_server(server, lmodel);
+  CPPUNIT_ASSERT(server->num_requests == 1);
+
+  std::vector<object_id_t> oids;
+  for(LogicModel::object_collection::iterator iter = lmodel->objects_begin();
+      iter != lmodel->objects_end(); ++iter)
+    oids.push_back(iter->first);
+
+  lmodel->remove_object(lmodel->get_object(oids[0]));
+  lmodel->remove_object(lmodel->get_object(oids[1]));
+  lmodel->add_object(0, Wire_shptr(new Wire(1, 1, 2, 2, 3)));
+
+  push_changes_to_server(server, lmodel);
+
+  // one add and two removals with a single request
+  CPPUNIT_ASSERT(server->num_requests == 2);
+  CPPUNIT_ASSERT(server->transactions.size() == 9);
+  std::string const command = xmlrpc_c::value_string(server->transactions[7][0]);
+  CPPUNIT_ASSERT(command == "remove");
+  CPPUNIT_ASSERT(lmodel->get_removed_remote_objetcs_list().empty());
+}
+
+void XmlRpcTest::test_fallback_to_single_push(void) {
+
+  LocalServer_shptr server(new LocalServer(false));
+  LogicModel_shptr lmodel = create_lmodel(2, 1);
+
+  push_changes_to_server(server, lmodel);
+
+  // a failed batch request and three single requests
+  CPPUNIT_ASSERT(server->num_requests == 4);
+  CPPUNIT_ASSERT(!server->supports_batches());
+  CPPUNIT_ASSERT(server->transactions.size() == 4);
+  CPPUNIT_ASSERT(lmodel->get_unpushed_remote_objects().empty());
+}
+
+void XmlRpcTest::test_partial_push(void) {
+
+  LocalServer_shptr server(new LocalServer());
+  server->fail_at_request = 2;
+  LogicModel_shptr lmodel = create_lmodel(700, 0);
+
+  CPPUNIT_ASSERT_THROW(push_changes_to_server(server, lmodel), XMLRPCException);
+
+  // The first batch is recorded, the failed batch is not sent again.
+  CPPUNIT_ASSERT(server->num_requests == 2);
+  CPPUNIT_ASSERT(server->supports_batches());
+  CPPUNIT_ASSERT(server->transactions.size() == 501);
+  CPPUNIT_ASSERT(lmodel->get_unpushed_remote_objects().size() == 200);
+
+  // The next push only sends the remaining objects.
+  push_changes_to_server(server, lmodel);
+  CPPUNIT_ASSERT(server->num_requests == 3);
+  CPPUNIT_ASSERT(server->transactions.size() == 701);
+  CPPUNIT_ASSERT(lmodel->get_unpushed_remote_objects().empty());
+}
+
+void XmlRpcTest::test_partial_push_removals(void) {
+
+  LocalServer_shptr server(new LocalServer(false));
+  LogicModel_shptr lmodel = create_lmodel(3, 0);
+  push_changes_to_server(server, lmodel);
+  CPPUNIT_ASSERT(server->num_requests == 4);
+
+  std::vector<Wire_shptr> wires = get_objects<Wire>(lmodel);
+  for(unsigned int i = 0; i < wires.size(); i++) lmodel->remove_object(wires[i]);
+  CPPUNIT_ASSERT(lmodel->get_removed_remote_objetcs_list().size() == 3);
+
+  // The second removal fails.
+  server->fail_at_request = 6;
+  CPPUNIT_ASSERT_THROW(push_changes_to_server(server, lmodel), XMLRPCException);
+  CPPUNIT_ASSERT(lmodel->get_removed_remote_objetcs_list().size() == 2);
+
+  push_changes_to_server(server, lmodel);
+  CPPUNIT_ASSERT(server->transactions.size() == 7);
+  CPPUNIT_ASSERT(lmodel->get_removed_remote_objetcs_list().empty());
+}
+
+void XmlRpcTest::test_pull(void) {
+
+  LocalServer_shptr server(new LocalServer());
+  LogicModel_shptr lmodel1 = create_lmodel(10, 5);
+  LogicModel_shptr lmodel2 = create_lmodel(0, 0);
+
+  push_changes_to_server(server, lmodel1);
+
+  transaction_id_t tid1 = pull_changes_from_server(server, lmodel1, 0);
+  transaction_id_t tid2 = pull_changes_from_server(server, lmodel2, 0);
+  CPPUNIT_ASSERT(tid1 == 16);
+  CPPUNIT_ASSERT(tid2 == 16);
+
+  // The own changes are known, the other model received them.
+  CPPUNIT_ASSERT(get_objects<Wire>(lmodel1).size() == 10);
+  CPPUNIT_ASSERT(get_objects<Wire>(lmodel2).size() == 10);
+  CPPUNIT_ASSERT(get_objects<Via>(lmodel2).size() == 5);
+  CPPUNIT_ASSERT(lmodel2->get_unpushed_remote_objects().empty());
+
+  // A removal is propagated.
+  lmodel1->remove_object(get_objects<Wire>(lmodel1)[0]);
+  push_changes_to_server(server, lmodel1);
+  tid2 = pull_changes_from_server(server, lmodel2, tid2);
+  CPPUNIT_ASSERT(tid2 == 17);
+  CPPUNIT_ASSERT(get_objects<Wire>(lmodel2).size() == 9);
+}
@@ -0,0 +1,56 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __XMLRPCTEST_H__
+#define __XMLRPCTEST_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class XmlRpcTest : public CPPUNIT_NS :: TestFixture {
+
+  CPPUNIT_TEST_SUITE(XmlRpcTest);
+
+  CPPUNIT_TEST(test_unpushed_objects);
+  CPPUNIT_TEST(test_batched_push);
+  CPPUNIT_TEST(test_push_removals);
+  CPPUNIT_TEST(test_fallback_to_single_push);
+  CPPUNIT_TEST(test_partial_push);
+  CPPUNIT_TEST(test_partial_push_removals);
+  CPPUNIT_TEST(test_pull);
+
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp(void);
+  void tearDown(void);
+
+ protected:
+  void test_unpushed_objects(void);
+  void test_batched_push(void);
+  void test_push_removals(void);
+  void test_fallback_to_single_push(void);
+  void test_partial_push(void);
+  void test_partial_push_removals(void);
+  void test_pull(void);
+};
+
+#endif
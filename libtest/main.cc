@@ -43,6 +43,24 @@
 #include "ScalingManagerTest.h"
 #include "ImageProcessingTest.h"
 #include "LookupSubcircuitTest.h"
+#include "RenderBatchBuilderTest.h"
+#include "NetlistGraphTest.h"
+#include "ModuleTest.h"
+#include "TileStreamerTest.h"
+#include "RuleCheckerTest.h"
+#include "GeometryTest.h"
+#include "VerilogModuleGeneratorTest.h"
+#include "ExternalMatchingTest.h"
+#include "BackgroundClassifierTest.h"
+#include "HighlightOverlayTest.h"
+#include "ImageArenaTest.h"
+#include "ProgressTrackerTest.h"
+#include "LogicModelSnapshotTest.h"
+#include "LogicModelIndexTest.h"
+#include "ImageAccumulatorTest.h"
+#include "TaskGraphTest.h"
+#include "XmlRpcTest.h"
+#include "AutosaverTest.h"
 
 using namespace degate;
 
@@ -88,6 +106,24 @@ int main(void) {
   */
 
   testrunner.addTest(LookupSubcircuitTest::suite());
+  testrunner.addTest(RenderBatchBuilderTest::suite());
+  testrunner.addTest(NetlistGraphTest::suite());
+  testrunner.addTest(ModuleTest::suite());
+  testrunner.addTest(TileStreamerTest::suite());
+  testrunner.addTest(RuleCheckerTest::suite());
+  testrunner.addTest(GeometryTest::suite());
+  testrunner.addTest(VerilogModuleGeneratorTest::suite());
+  testrunner.addTest(ExternalMatchingTest::suite());
+  testrunner.addTest(BackgroundClassifierTest::suite());
+  testrunner.addTest(HighlightOverlayTest::suite());
+  testrunner.addTest(ImageArenaTest::suite());
+  testrunner.addTest(ProgressTrackerTest::suite());
+  testrunner.addTest(LogicModelSnapshotTest::suite());
+  testrunner.addTest(LogicModelIndexTest::suite());
+  testrunner.addTest(ImageAccumulatorTest::suite());
+  testrunner.addTest(TaskGraphTest::suite());
+  testrunner.addTest(XmlRpcTest::suite());
+  testrunner.addTest(AutosaverTest::suite());
 
   testrunner.run(testresult);
 
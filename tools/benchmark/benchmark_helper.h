@@ -0,0 +1,104 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __BENCHMARK_HELPER_H__
+#define __BENCHMARK_HELPER_H__
+
+#include <sys/time.h>
+#include <malloc.h>
+#include <string>
+#include <iostream>
+#include <iomanip>
+
+/**
+ * Simple wall clock stop watch for the benchmark tools.
+ */
+class StopWatch {
+
+private:
+  struct timeval started;
+
+public:
+
+  StopWatch() { reset(); }
+
+  void reset() { gettimeofday(&started, NULL); }
+
+  /**
+   * Get elapsed time in milliseconds.
+   */
+  double elapsed_ms() const {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (now.tv_sec - started.tv_sec) * 1000.0 +
+      (now.tv_usec - started.tv_usec) / 1000.0;
+  }
+
+  /**
+   * Print elapsed time with a label and restart the watch.
+   */
+  void report(std::string const& label, unsigned long n_ops = 0) {
+    double ms = elapsed_ms();
+    std::cout << std::setw(48) << std::left << label
+	      << std::setw(12) << std::right << std::fixed << std::setprecision(2) << ms << " ms";
+    if(n_ops > 0)
+      std::cout << "  (" << std::setprecision(1) << (ms * 1000000.0 / n_ops) << " ns/op)";
+    std::cout << std::endl;
+    reset();
+  }
+
+};
+
+/**
+ * Measures the heap memory, that is allocated between two calls.
+ */
+class HeapMeter {
+
+private:
+  size_t started;
+
+  static size_t get_heap_size() {
+    struct mallinfo mi = mallinfo();
+    // The fields are ints. Read them as unsigned to measure up to 4 GB.
+    return (size_t)(unsigned int)mi.uordblks + (size_t)(unsigned int)mi.hblkhd;
+  }
+
+public:
+
+  HeapMeter() { reset(); }
+
+  void reset() { started = get_heap_size(); }
+
+  /**
+   * Print the number of allocated bytes per object with a label and restart the meter.
+   */
+  void report(std::string const& label, unsigned long n_objects) {
+    size_t now = get_heap_size();
+    double per_object = now > started ? (double)(now - started) / n_objects : 0;
+    std::cout << std::setw(48) << std::left << label
+	      << std::setw(12) << std::right << std::fixed << std::setprecision(1) << per_object
+	      << " bytes/object" << std::endl;
+    reset();
+  }
+
+};
+
+#endif
@@ -0,0 +1,426 @@
+/* -*-c++-*-
+
+ This file is part of the IC reverse engineering tool degate.
+
+ Copyright 2008, 2009, 2010 by Martin Schobert
+
+ Degate is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ any later version.
+
+ Degate is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with degate. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <degate.h>
+#include <LogicModel.h>
+#include <DenseObjectMap.h>
+#include <NetlistGraph.h>
+#include <ERCNet.h>
+#include <RuleChecker.h>
+#include <LookupSubcircuit.h>
+#include <VerilogModuleGenerator.h>
+#include <LogicModelDOTExporter.h>
+#include <ImageArena.h>
+
+#include "benchmark_helper.h"
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <stdlib.h>
+
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+
+using namespace boost::program_options;
+using namespace degate;
+
+
+/**
+ * Compare the object storage against a std::map with the
+ * access pattern of the logic model.
+ */
+
+template<typename MapType>
+void benchmark_map(std::string const& name, unsigned long n) {
+
+  std::vector<object_id_t> keys(n);
+  for(unsigned long i = 0; i < n; i++) keys[i] = i + 1;
+
+  std::vector<object_id_t> probes(keys);
+  std::random_shuffle(probes.begin(), probes.end());
+
+  MapType m;
+  PlacedLogicModelObject_shptr dummy;
+  StopWatch sw;
+
+  for(unsigned long i = 0; i < n; i++) m[keys[i]] = dummy;
+  sw.report(name + ": insert", n);
+
+  unsigned long found = 0;
+  for(unsigned long i = 0; i < n; i++) found += m.find(probes[i]) != m.end() ? 1 : 0;
+  sw.report(name + ": random lookup", n);
+
+  unsigned long visited = 0;
+  for(typename MapType::iterator iter = m.begin(); iter != m.end(); ++iter) visited++;
+  sw.report(name + ": iterate", n);
+
+  for(unsigned long i = 0; i < n / 10; i++) m.erase(probes[i]);
+  sw.report(name + ": erase 10%", n / 10);
+
+  assert(found == n && visited == n);
+}
+
+
+/**
+ * Build a logic model with vias, connect them into small nets and walk the nets.
+ */
+
+void benchmark_logic_model(unsigned long n, unsigned int net_size) {
+
+  unsigned int edge = 1;
+  while((unsigned long)edge * edge < n) edge++;
+
+  LogicModel_shptr lmodel(new LogicModel(edge * 10 + 10, edge * 10 + 10, 1));
+  std::vector<Via_shptr> vias;
+  vias.reserve(n);
+
+  StopWatch sw;
+
+  for(unsigned long i = 0; i < n; i++) {
+    Via_shptr via(new Via((i % edge) * 10 + 5, (i / edge) * 10 + 5, 4));
+    lmodel->add_object(0, via);
+    vias.push_back(via);
+  }
+  sw.report("LogicModel: add_object", n);
+
+  for(unsigned long i = 0; i < n; i += net_size) {
+    Net_shptr net(new Net());
+    for(unsigned long j = i; j < i + net_size && j < n; j++) vias[j]->set_net(net);
+    lmodel->add_net(net);
+  }
+  sw.report("LogicModel: build nets", n);
+
+  std::vector<object_id_t> probes(n);
+  for(unsigned long i = 0; i < n; i++) probes[i] = vias[i]->get_object_id();
+  std::random_shuffle(probes.begin(), probes.end());
+  sw.reset();
+
+  unsigned long found = 0;
+  for(unsigned long i = 0; i < n; i++)
+    if(lmodel->get_object(probes[i]) != NULL) found++;
+  sw.report("LogicModel: get_object (random)", n);
+
+  unsigned long walked = 0;
+  for(LogicModel::net_collection::iterator iter = lmodel->nets_begin();
+      iter != lmodel->nets_end(); ++iter) {
+    Net_shptr net = iter->second;
+    for(Net::connection_iterator c_iter = net->begin(); c_iter != net->end(); ++c_iter) {
+      if(lmodel->get_object(*c_iter) != NULL) walked++;
+    }
+  }
+  sw.report("LogicModel: net walk with get_object", walked);
+
+  for(unsigned long i = 0; i < n / 10; i++)
+    lmodel->remove_object(lmodel->get_object(probes[i]));
+  sw.report("LogicModel: remove_object 10%", n / 10);
+
+  assert(found == n && walked == n);
+}
+
+
+/**
+ * Measure the heap memory per object for the most frequent object types.
+ * The numbers include the objects and the logic model's indices.
+ */
+
+template<typename ObjectType>
+void benchmark_memory_for_type(std::string const& name, unsigned long n,
+			       std::tr1::shared_ptr<ObjectType> (*create)(int x, int y)) {
+
+  unsigned int edge = 1;
+  while((unsigned long)edge * edge < n) edge++;
+
+  LogicModel_shptr lmodel(new LogicModel(edge * 10 + 10, edge * 10 + 10, 1));
+  HeapMeter hm;
+
+  for(unsigned long i = 0; i < n; i++)
+    lmodel->add_object(0, create((i % edge) * 10, (i / edge) * 10));
+
+  std::cout << std::setw(48) << std::left << (name + ": sizeof")
+	    << std::setw(12) << std::right << sizeof(ObjectType) << " bytes" << std::endl;
+  hm.report(name + ": heap in logic model", n);
+}
+
+static Via_shptr create_via(int x, int y) { return Via_shptr(new Via(x + 5, y + 5, 4)); }
+static Wire_shptr create_wire(int x, int y) { return Wire_shptr(new Wire(x + 1, y + 5, x + 8, y + 5, 2)); }
+static Gate_shptr create_gate(int x, int y) { return Gate_shptr(new Gate(x + 1, x + 8, y + 1, y + 8)); }
+
+void benchmark_memory(unsigned long n) {
+  benchmark_memory_for_type<Via>("Via", n, create_via);
+  benchmark_memory_for_type<Wire>("Wire", n, create_wire);
+  benchmark_memory_for_type<Gate>("Gate", n, create_gate);
+}
+
+
+/**
+ * Build a chain of inverters and run netlist passes on it.
+ */
+
+void benchmark_netlist_graph(unsigned long n) {
+
+  unsigned int edge = 1;
+  while((unsigned long)edge * edge < n) edge++;
+
+  LogicModel_shptr lmodel(new LogicModel(edge * 20 + 20, edge * 20 + 20, 1));
+
+  GateTemplate_shptr tmpl(new GateTemplate(10, 10));
+  tmpl->set_logic_class("inverter");
+  GateTemplatePort_shptr in_port(new GateTemplatePort(2, 5, GateTemplatePort::PORT_TYPE_IN));
+  GateTemplatePort_shptr out_port(new GateTemplatePort(8, 5, GateTemplatePort::PORT_TYPE_OUT));
+  in_port->set_object_id(lmodel->get_new_object_id());
+  out_port->set_object_id(lmodel->get_new_object_id());
+  tmpl->add_template_port(in_port);
+  tmpl->add_template_port(out_port);
+  lmodel->add_gate_template(tmpl);
+
+  StopWatch sw;
+  GatePort_shptr prev_out;
+
+  for(unsigned long i = 0; i < n; i++) {
+    unsigned int x = (i % edge) * 20, y = (i / edge) * 20;
+    Gate_shptr gate(new Gate(x, x + 10, y, y + 10, Gate::ORIENTATION_NORMAL));
+    gate->set_gate_template(tmpl);
+    lmodel->add_object(0, gate);
+    lmodel->update_ports(gate);
+
+    if(prev_out != NULL) {
+      Net_shptr net(new Net());
+      prev_out->set_net(net);
+      gate->get_port_by_template_port(in_port)->set_net(net);
+      lmodel->add_net(net);
+    }
+    prev_out = gate->get_port_by_template_port(out_port);
+  }
+  sw.report("NetlistGraph: build model", n);
+
+  NetlistGraph_shptr graph = lmodel->get_netlist_graph();
+  sw.report("NetlistGraph: build graph", n);
+
+  unsigned long edges = 0;
+  for(NetlistGraph::index_t g = 0; g < graph->get_num_gates(); g++) {
+    NetlistGraph::index_range out = graph->get_fanout(g);
+    edges += out.second - out.first;
+  }
+  sw.report("NetlistGraph: fan-out walk", n);
+
+  ERCNet erc;
+  erc.run(lmodel);
+  sw.report("NetlistGraph: ERCNet", n);
+
+  RuleChecker rc;
+  rc.run(lmodel);
+  sw.report("RuleChecker: complete run", n);
+
+  Net_shptr net(new Net());
+  prev_out->set_net(net);
+  lmodel->add_net(net);
+  sw.reset();
+  rc.run(lmodel);
+  sw.report("RuleChecker: incremental run with graph rebuild", n);
+  assert(rc.get_num_checked() == 2);
+
+  // three inverters in a row
+  SubcircuitPattern pattern;
+  in_port->set_name("a");
+  out_port->set_name("y");
+  unsigned int g0 = pattern.add_gate("inverter");
+  unsigned int g1 = pattern.add_gate("inverter");
+  unsigned int g2 = pattern.add_gate("inverter");
+  pattern.connect(g0, "y", g1, "a");
+  pattern.connect(g1, "y", g2, "a");
+
+  LookupSubcircuit lsc(lmodel);
+  sw.reset();
+  unsigned long matches = lsc.search(pattern, 1).size();
+  sw.report("LookupSubcircuit: search, 1 thread", n);
+  lsc.search(pattern);
+  sw.report("LookupSubcircuit: search, all processors", n);
+
+  assert(edges == n - 1 && matches == n - 2);
+}
+
+
+/**
+ * Build a chain of inverters, that runs through a two level module hierarchy,
+ * and export it as Verilog and DOT.
+ */
+
+void benchmark_exporters(unsigned long n, unsigned int num_modules) {
+
+  unsigned int edge = 1;
+  while((unsigned long)edge * edge < n) edge++;
+
+  LogicModel_shptr lmodel(new LogicModel(edge * 20 + 20, edge * 20 + 20, 1));
+
+  GateTemplate_shptr tmpl(new GateTemplate(10, 10));
+  tmpl->set_name("inv");
+  tmpl->set_logic_class("inverter");
+  GateTemplatePort_shptr in_port(new GateTemplatePort(2, 5, GateTemplatePort::PORT_TYPE_IN));
+  GateTemplatePort_shptr out_port(new GateTemplatePort(8, 5, GateTemplatePort::PORT_TYPE_OUT));
+  in_port->set_name("a");
+  out_port->set_name("y");
+  in_port->set_object_id(lmodel->get_new_object_id());
+  out_port->set_object_id(lmodel->get_new_object_id());
+  tmpl->add_template_port(in_port);
+  tmpl->add_template_port(out_port);
+  lmodel->add_gate_template(tmpl);
+
+  // Each top level module contains four modules.
+  Module_shptr main_module = lmodel->get_main_module();
+  std::vector<Module_shptr> modules;
+  for(unsigned int i = 0; i < num_modules; i++) {
+    Module_shptr module(new Module((boost::format("m%1%") % i).str()));
+    module->set_object_id(lmodel->get_new_object_id());
+    if(i % 5 == 0) main_module->add_module(module);
+    else modules[i - i % 5]->add_module(module);
+    modules.push_back(module);
+  }
+
+  StopWatch sw;
+  GatePort_shptr prev_out;
+  unsigned long gates_per_module = n / num_modules + 1;
+
+  for(unsigned long i = 0; i < n; i++) {
+    unsigned int x = (i % edge) * 20, y = (i / edge) * 20;
+    Gate_shptr gate(new Gate(x, x + 10, y, y + 10, Gate::ORIENTATION_NORMAL));
+    gate->set_gate_template(tmpl);
+    gate->set_name((boost::format("g%1%") % i).str());
+    lmodel->add_object(0, gate);
+    lmodel->update_ports(gate);
+    main_module->remove_gate(gate);
+    modules[i / gates_per_module]->add_gate(gate, false);
+
+    if(prev_out != NULL) {
+      Net_shptr net(new Net());
+      prev_out->set_net(net);
+      gate->get_port_by_template_port(in_port)->set_net(net);
+      lmodel->add_net(net);
+    }
+    prev_out = gate->get_port_by_template_port(out_port);
+  }
+  sw.report("Exporters: build model", n);
+
+  determine_module_ports_for_hierarchy(lmodel);
+  sw.report("Exporters: determine module ports", n);
+
+  VerilogModuleGenerator codegen(main_module, false, 1);
+  unsigned long size = codegen.generate().size();
+  sw.report("VerilogModuleGenerator: generate() string, 1 thread", n);
+
+  std::ofstream null_sink("/dev/null");
+  codegen.generate(null_sink);
+  sw.report("VerilogModuleGenerator: stream, 1 thread", n);
+
+  codegen.set_num_threads(0);
+  codegen.generate(null_sink);
+  sw.report("VerilogModuleGenerator: stream, all processors", n);
+
+  LogicModelDOTExporter dot_exporter(ObjectIDRewriter_shptr(new ObjectIDRewriter(true)));
+  dot_exporter.export_data(null_sink, lmodel, "hierarchy");
+  sw.report("LogicModelDOTExporter: stream", n);
+
+  assert(size > n);
+}
+
+
+/**
+ * Create and fill many small temporary images, as the template and via
+ * matching do. Compare temp files against the in-memory image arena.
+ */
+
+void benchmark_temp_images(unsigned long n) {
+
+  ImageArena & arena = ImageArena::get_instance();
+  size_t spill_threshold = arena.get_spill_threshold();
+
+  for(int pass = 0; pass < 2; pass++) {
+
+    arena.set_spill_threshold(pass == 0 ? 0 : spill_threshold);
+    StopWatch sw;
+
+    for(unsigned long i = 0; i < n; i++) {
+      TempImage_GS_DOUBLE_shptr img(new TempImage_GS_DOUBLE(40, 40));
+      for(unsigned int y = 0; y < img->get_height(); y++)
+	for(unsigned int x = 0; x < img->get_width(); x++)
+	  img->set_pixel(x, y, x * y);
+    }
+
+    sw.report(pass == 0 ? "TempImage: temp files" : "TempImage: image arena", n);
+  }
+
+  arena.set_spill_threshold(spill_threshold);
+}
+
+
+/**
+ * Main program.
+ */
+
+int main(int argc, char ** argv) {
+
+  options_description desc("Options");
+  desc.add_options()
+    ("help", "Show help message.")
+    ("objects", value<unsigned long>()->default_value(1000000), "Number of objects.")
+    ("net-size", value<unsigned int>()->default_value(8), "Number of objects per net.")
+    ("gates", value<unsigned long>()->default_value(100000), "Number of gates for the netlist passes.")
+    ("hierarchy-gates", value<unsigned long>()->default_value(200000), "Number of gates for the exporters.")
+    ("temp-images", value<unsigned long>()->default_value(5000), "Number of temporary images.")
+    ;
+
+  variables_map vm;
+  store(parse_command_line(argc, argv, desc), vm);
+  notify(vm);
+
+  if(vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 1;
+  }
+
+  unsigned long n = vm["objects"].as<unsigned long>();
+  srand(42);
+
+  std::cout << "Netlist with " << vm["gates"].as<unsigned long>() << " gates:" << std::endl;
+  benchmark_netlist_graph(vm["gates"].as<unsigned long>());
+
+  std::cout << std::endl << "Module hierarchy with " << vm["hierarchy-gates"].as<unsigned long>()
+	    << " gates:" << std::endl;
+  benchmark_exporters(vm["hierarchy-gates"].as<unsigned long>(), 250);
+
+  std::cout << std::endl << "Temporary images:" << std::endl;
+  benchmark_temp_images(vm["temp-images"].as<unsigned long>());
+
+  std::cout << std::endl << "Object storage with " << n << " objects:" << std::endl;
+  benchmark_map<std::map<object_id_t, PlacedLogicModelObject_shptr> >("std::map", n);
+  benchmark_map<DenseObjectMap<PlacedLogicModelObject_shptr> >("DenseObjectMap", n);
+
+  std::cout << std::endl << "Logic model with " << n << " vias:" << std::endl;
+  benchmark_logic_model(n, vm["net-size"].as<unsigned int>());
+
+  std::cout << std::endl << "Memory for " << n << " objects per type:" << std::endl;
+  benchmark_memory(n);
+
+
+  return 0;
+}
@@ -21,6 +21,7 @@ my $serializer = Data::Serializer->new(serializer => 'Storable');
 
 
 process_cgi_call({'degate.push' => \&push,
+		  'degate.push_batch' => \&push_batch,
 		  'degate.pull' => \&pull});
 
 
@@ -43,6 +44,32 @@ sub push {
     return $tid;
 }
 
+# Store a list of commands with a single request. Each command is
+# stored as its own transaction. Returns the list of transaction IDs.
+sub push_batch {
+    my ($commands) = shift;
+    print STDERR "push-batch-request: " . scalar(@$commands) . " commands\n";
+
+    my @transactions;
+    my $o = tie @transactions, 'Tie::File', $filename or 
+	die "Can't open channel file '$filename': $!\n";
+    $o->flock();
+
+    my @tids;
+    foreach my $command (@$commands) {
+	my $tid = $#transactions + 1;
+	$tid = 1 if($tid == 0);
+
+	$transactions[$tid] = $serializer->serialize($command);
+	push @tids, $tid;
+    }
+    untie @transactions;
+
+    print STDERR "push-batch-response: @tids\n";
+
+    return \@tids;
+}
+
 sub pull {
     my ($start_tid) = shift || 1;
     print STDERR "pull-request: " . Dumper(\@_);